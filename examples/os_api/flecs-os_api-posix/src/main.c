@@ -52,6 +52,26 @@ int32_t posix_adec(int32_t *count) {
 #endif
 }
 
+static
+int32_t posix_aload(const int32_t *value) {
+#ifdef __GNUC__
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#else
+    /* Unsupported */
+    abort();
+#endif
+}
+
+static
+void posix_astore(int32_t *value, int32_t desired) {
+#ifdef __GNUC__
+    __atomic_store_n(value, desired, __ATOMIC_SEQ_CST);
+#else
+    /* Unsupported */
+    abort();
+#endif
+}
+
 static
 ecs_os_mutex_t posix_mutex_new(void) {
     pthread_mutex_t *mutex = ecs_os_malloc(sizeof(pthread_mutex_t));
@@ -136,6 +156,8 @@ void posix_set_os_api(void) {
     api.thread_join_ = posix_thread_join;
     api.ainc_ = posix_ainc;
     api.adec_ = posix_adec;
+    api.aload_ = posix_aload;
+    api.astore_ = posix_astore;
     api.mutex_new_ = posix_mutex_new;
     api.mutex_free_ = posix_mutex_free;
     api.mutex_lock_ = posix_mutex_lock;
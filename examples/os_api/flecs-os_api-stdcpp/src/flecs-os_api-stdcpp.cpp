@@ -47,6 +47,26 @@ int32_t stdcpp_adec(int32_t *count) {
 #endif
 }
 
+static
+int32_t stdcpp_aload(const int32_t *value) {
+#ifdef __GNUC__
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#else
+    /* Unsupported */
+    abort();
+#endif
+}
+
+static
+void stdcpp_astore(int32_t *value, int32_t desired) {
+#ifdef __GNUC__
+    __atomic_store_n(value, desired, __ATOMIC_SEQ_CST);
+#else
+    /* Unsupported */
+    abort();
+#endif
+}
+
 static
 ecs_os_mutex_t stdcpp_mutex_new(void) {
     std::mutex *mutex = new std::mutex;
@@ -111,6 +131,8 @@ void stdcpp_set_os_api(void) {
     api.thread_join_ = stdcpp_thread_join;
     api.ainc_ = stdcpp_ainc;
     api.adec_ = stdcpp_adec;
+    api.aload_ = stdcpp_aload;
+    api.astore_ = stdcpp_astore;
     api.mutex_new_ = stdcpp_mutex_new;
     api.mutex_free_ = stdcpp_mutex_free;
     api.mutex_lock_ = stdcpp_mutex_lock;
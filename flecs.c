@@ -73,6 +73,31 @@ extern "C" {
 
 #define ECS_MAX_JOBS_PER_WORKER (16)
 
+/* Minimum number of entities in a job when the job size is derived from the
+ * number of matched entities. Prevents splitting small tables in fragments that
+ * are too small to offset the cost of scheduling them. */
+#define ECS_MIN_JOB_CHUNK_SIZE (64)
+
+/* Number of times a thread polls a sync point before it parks on a condition
+ * variable. Spinning avoids a futex round trip when all threads arrive at a
+ * merge point at roughly the same time, which is the common case. */
+#define ECS_DEFAULT_SYNC_SPIN_COUNT (10000)
+
+/* Number of consecutive entity ids assigned to the same thread when component
+ * values are copied in parallel during a merge */
+#define ECS_MERGE_PARTITION_SIZE (64)
+
+/* Size of the memory chunks from which payloads of deferred operations are
+ * allocated. Payloads that are larger get a chunk of their own. */
+#define ECS_ARENA_CHUNK_SIZE (64 * 1024)
+
+/* Alignment of payloads allocated from an arena */
+#define ECS_ARENA_ALIGNMENT (16)
+
+/* Maximum alignment of table columns that can be set for a world. Column
+ * buffers are over-allocated by twice the alignment. */
+#define ECS_MAX_COLUMN_ALIGNMENT (4096)
+
 /** These values are used to verify validity of the pointers passed into the API
  * and to allow for passing a thread as a world to some API calls (this allows
  * for transparently passing thread context to API functions) */
@@ -109,6 +134,8 @@ typedef struct ecs_c_info_t {
     ecs_vector_t *on_remove;    /* Systems ran after removing this component */
     EcsComponentLifecycle lifecycle; /* Component lifecycle callbacks */
     bool lifecycle_set;
+    ecs_entity_t cold;          /* Cold part that is added with the component */
+    ecs_entity_t hot;           /* Component of which this is the cold part */
 } ecs_c_info_t;
 
 /* Table event type for notifying tables of world events */
@@ -186,6 +213,8 @@ typedef struct ecs_table_leaf_t {
 #define EcsTableHasMonitors         32768u
 #define EcsTableHasSwitch           65536u
 #define EcsTableHasDisabled         131072u
+#define EcsTableHasName             262144u /**< Does the table have EcsName */
+#define EcsTableHasColdParts        524288u /**< Does the table have components with a cold part */
 
 /* Composite constants */
 #define EcsTableHasLifecycle        (EcsTableHasCtors | EcsTableHasDtors)
@@ -193,12 +222,51 @@ typedef struct ecs_table_leaf_t {
 #define EcsTableHasAddActions       (EcsTableHasBase | EcsTableHasSwitch | EcsTableHasCtors | EcsTableHasOnAdd | EcsTableHasOnSet | EcsTableHasMonitors)
 #define EcsTableHasRemoveActions    (EcsTableHasBase | EcsTableHasDtors | EcsTableHasOnRemove | EcsTableHasUnSet | EcsTableHasMonitors)
 
+/** Entities in the name index with the same scope & name hash */
+typedef struct ecs_name_bucket_t {
+    ecs_entity_t first;
+    ecs_vector_t *more;
+} ecs_name_bucket_t;
+
+/** Keys under which an entity is stored in the name index */
+typedef struct ecs_name_entry_t {
+    ecs_entity_t scope;
+    uint64_t name_hash;
+    uint64_t symbol_hash;            /**< 0 if no symbol or same as name */
+} ecs_name_entry_t;
+
+/** Mapping between the columns of two tables. This allows moving an entity
+ * between tables without comparing their types. Columns without data (tags) are
+ * not included. The columns array stores, in order:
+ *  - source and destination column of each column in both tables
+ *  - destination columns that are not in the source (to construct)
+ *  - source columns that are not in the destination (to destruct) */
+typedef struct ecs_move_map_t {
+    int32_t move_count;             /**< Number of columns in both tables */
+    int32_t ctor_count;             /**< Number of columns only in destination */
+    int32_t dtor_count;             /**< Number of columns only in source */
+    int32_t *columns;               /**< Column indices */
+} ecs_move_map_t;
+
 /** Edge used for traversing the table graph. */
 typedef struct ecs_edge_t {
     ecs_table_t *add;               /**< Edges traversed when adding */
     ecs_table_t *remove;            /**< Edges traversed when removing */
+    ecs_move_map_t *add_map;        /**< Column mapping to add table (lazy) */
+    ecs_move_map_t *remove_map;     /**< Column mapping to remove table (lazy) */
 } ecs_edge_t;
 
+/** Number of recently used edges cached inline on a table. Must be a power of
+ * two, as the component id is used to index the cache. */
+#define ECS_EDGE_CACHE_SIZE (4)
+
+/** Cached pointer to an edge in the edge map of a table. Pointers are
+ * invalidated when an edge is inserted into or removed from the map. */
+typedef struct ecs_edge_cache_t {
+    ecs_entity_t id;                /**< Component of edge, 0 if empty */
+    ecs_edge_t *edge;               /**< Edge stored in table edge map */
+} ecs_edge_cache_t;
+
 /** Quey matched with table with backref to query table administration.
  * This type is used to store a matched query together with the array index of
  * where the table is stored in the query administration. This type is used when
@@ -218,8 +286,8 @@ struct ecs_table_t {
     ecs_type_t type;                 /**< Identifies table type in type_index */
     ecs_c_info_t **c_info;           /**< Cached pointers to component info */
 
-    ecs_edge_t *lo_edges;            /**< Edges to other tables */
-    ecs_map_t *hi_edges;
+    ecs_map_t *edges;                /**< Edges to other tables */
+    ecs_edge_cache_t edge_cache[ECS_EDGE_CACHE_SIZE]; /**< Recent edges */
 
     ecs_data_t *data;                /**< Component storage */
 
@@ -233,6 +301,15 @@ struct ecs_table_t {
     int32_t *dirty_state;            /**< Keep track of changes in columns */
     int32_t alloc_count;             /**< Increases when columns are reallocd */
     uint32_t id;                     /**< Table id in sparse set */
+    uint64_t hash;                   /**< Hash of type, key in table_map */
+
+    int32_t gc_frame;                /**< Frame at which table became empty */
+    int32_t gc_index;                /**< Index in gc queue, -1 if not queued */
+
+    struct ecs_table_t *chunk_head;  /**< Table of which this is a chunk */
+    ecs_vector_t *chunks;            /**< Chunks of table (head only) */
+    struct ecs_table_t *chunk_tail;  /**< Chunk that is appended to (head only) */
+    ecs_vector_t *chunk_free;        /**< Chunks that have room again (head only) */
 
     ecs_flags32_t flags;             /**< Flags for testing table properties */
     
@@ -262,6 +339,7 @@ typedef struct ecs_matched_table_t {
     ecs_vector_t *sparse_columns;  /**< Column ids of sparse columns */
     ecs_vector_t *bitset_columns;  /**< Column ids with disabled flags */
     int32_t *monitor;              /**< Used to monitor table for changes */
+    ecs_vector_t *sorted_rows;     /**< Rows in sort order (EcsQuerySortRows) */
     int32_t rank;                  /**< Rank used to sort tables */
 } ecs_matched_table_t;
 
@@ -306,6 +384,8 @@ typedef struct ecs_table_slice_t {
 #define EcsQueryIsOrphaned (512)     /* Is subquery orphaned */
 #define EcsQueryHasOutColumns (1024) /* Does query have out columns */
 #define EcsQueryHasOptional (2048)   /* Does query have optional columns */
+#define EcsQuerySortRows (4096)      /* Does query sort without moving rows */
+#define EcsQuerySortKey (8192)       /* Does query sort on a numeric key */
 
 #define EcsQueryNoActivation (EcsQueryMonitor | EcsQueryOnSet | EcsQueryUnSet)
 
@@ -344,6 +424,8 @@ struct ecs_query_t {
     /* Used for sorting */
     ecs_entity_t sort_on_component;
     ecs_compare_action_t compare;   
+    ecs_sort_key_kind_t sort_key_kind;  /* Key type (EcsQuerySortKey) */
+    ecs_size_t sort_key_offset;         /* Key offset (EcsQuerySortKey) */
     ecs_vector_t *table_slices;     
 
     /* Used for table sorting */
@@ -416,6 +498,48 @@ typedef struct ecs_op_t {
     } is;
 } ecs_op_t;
 
+/** Component value of a deferred set operation. In a parallel merge, values
+ * are copied to storage after the structural changes of the merge have been
+ * applied, which lets multiple threads copy values at the same time. */
+typedef struct ecs_deferred_write_t {
+    ecs_entity_t entity;        /* Entity to write to */
+    ecs_entity_t component;     /* Component to write */
+    ecs_c_info_t *c_info;       /* Lifecycle callbacks of component */
+    void *value;                /* Value (stored in stage arena) */
+    ecs_size_t size;            /* Size of value */
+    bool notify;                /* Run OnSet systems after writing value */
+} ecs_deferred_write_t;
+
+/** Chunk of memory in an arena. Allocations are stored after the header. */
+typedef struct ecs_arena_chunk_t {
+    struct ecs_arena_chunk_t *next;
+    ecs_size_t size;            /* Number of bytes available in chunk */
+} ecs_arena_chunk_t;
+
+/** Position in an arena. Restoring an arena to a position releases everything
+ * allocated after it. */
+typedef struct ecs_arena_mark_t {
+    ecs_arena_chunk_t *chunk;   /* Current chunk (NULL if nothing allocated) */
+    ecs_size_t used;            /* Bytes used in current chunk */
+} ecs_arena_mark_t;
+
+/** Bump allocator for payloads of deferred operations. Memory is released all
+ * at once when a queue is flushed, and chunks are reused for the next queue. */
+typedef struct ecs_arena_t {
+    ecs_arena_chunk_t *chunks;  /* All chunks owned by the arena */
+    ecs_arena_mark_t cur;       /* Current allocation position */
+} ecs_arena_t;
+
+/** Memory pool of a world. Vectors that are allocated from a pool store a
+ * pointer to it, so that they are reallocated and freed by the same allocator.
+ * When the allocator of a pool is replaced while it still has allocations, the
+ * pool is retired and kept alive until the world is deleted. */
+struct ecs_pool_t {
+    ecs_pool_kind_t kind;
+    ecs_allocator_t allocator;
+    ecs_pool_stats_t stats;
+};
+
 /** A stage is a data structure in which delta's are stored until it is safe to
  * merge those delta's with the main world stage. A stage allows flecs systems
  * to arbitrarily add/remove/set components and create/delete entities while
@@ -439,6 +563,10 @@ struct ecs_stage_t {
     ecs_vector_t *defer_queue;
     ecs_vector_t *defer_merge_queue;
 
+    /* Payloads (values, component arrays) of deferred operations */
+    ecs_arena_t defer_arena;
+    ecs_arena_mark_t defer_mark;   /* Arena position when queue was created */
+
     /* One-shot actions to be executed after the merge */
     ecs_vector_t *post_frame_actions;
 
@@ -466,6 +594,19 @@ typedef struct ecs_store_t {
 
     /* Lookup map for tables */
     ecs_map_t *table_map;
+
+    /* Tables by type pointer, so types of existing tables aren't rehashed */
+    ecs_map_t *type_index;
+
+    /* Tables per component id. Tables with a base are also registered under
+     * ECS_INSTANCEOF, as they may inherit any component. */
+    ecs_map_t *component_tables;
+
+    /* Types of deleted tables by hash. Types are handed out to the application
+     * as ecs_type_t, so they outlive their table. When a table is recreated
+     * for the same type, it reuses the type so that type handles compare
+     * equal to the type of the new table. */
+    ecs_map_t *retired_types;
 } ecs_store_t;
 
 /** Supporting type to store looked up or derived entity data */
@@ -490,6 +631,7 @@ typedef struct ecs_thread_t {
     ecs_stage_t *stage;                       /* Stage for thread */
     ecs_os_thread_t thread;                   /* Thread handle */
     int32_t index;                           /* Index of thread */
+    FLECS_FLOAT sync_wait_time;              /* Time spent waiting since last sync */
 } ecs_thread_t;
 
 /** Supporting type to store looked up component data in specific table */
@@ -499,10 +641,35 @@ typedef struct ecs_column_info_t {
     int32_t column;
 } ecs_column_info_t;
 
+/** Number of elements in a page of a paged array, as a power of two */
+#define ECS_PAGE_BITS (8)
+#define ECS_PAGE_SIZE (1 << ECS_PAGE_BITS)
+
+/** Number of page pointers in a page table of a paged array, as a power of two */
+#define ECS_PAGE_TABLE_BITS (10)
+#define ECS_PAGE_TABLE_SIZE (1 << ECS_PAGE_TABLE_BITS)
+
+/** Array indexed by entity id that is split up in fixed size pages. Pages are
+ * only allocated for id ranges that are used, and elements never move once
+ * allocated, so pointers to elements may be cached. Pages are found through a
+ * two level directory, so that a high id only allocates the page table that
+ * contains its page, instead of a page pointer for every lower id. */
+typedef struct ecs_paged_t {
+    void ***tables;                 /* Page tables, NULL if not allocated */
+    int32_t table_count;            /* Number of page table pointers */
+    ecs_size_t elem_size;           /* Size of an element */
+} ecs_paged_t;
+
+/* Queries registered with a component monitor for a single component */
+typedef struct ecs_monitor_queries_t {
+    ecs_vector_t *queries;          /* Queries to notify */
+    bool dirty;                     /* Was component marked since last eval */
+} ecs_monitor_queries_t;
+
 /* Component monitors */
 typedef struct ecs_component_monitor_t {
-    bool dirty_flags[ECS_HI_COMPONENT_ID];
-    ecs_vector_t *monitors[ECS_HI_COMPONENT_ID];
+    ecs_paged_t monitors;           /* ecs_monitor_queries_t per component */
+    ecs_vector_t *dirty;            /* Components marked since last eval */
     bool rematch;
 } ecs_component_monitor_t;
 
@@ -525,8 +692,7 @@ struct ecs_world_t {
     void *context;               /* Application context */
     ecs_vector_t *fini_actions;  /* Callbacks to execute when world exits */
 
-    ecs_c_info_t c_info[ECS_HI_COMPONENT_ID]; /* Component callbacks & triggers */
-    ecs_map_t *t_info;                        /* Tag triggers */
+    ecs_paged_t c_info;          /* Component callbacks & triggers */
 
     /* Is entity range checking enabled? */
     bool range_check_enabled;
@@ -585,11 +751,18 @@ struct ecs_world_t {
     ecs_stage_t temp_stage;          /* Stage for when processing systems */
     ecs_vector_t *worker_stages;     /* Stages for worker threads */
     int32_t stage_count;            /* Number of stages in world */
+    ecs_vector_t *deferred_writes;   /* Values to copy after a parallel merge */
+    ecs_vector_t *deferred_write_order; /* Deferred writes by partition */
+    ecs_vector_t *deferred_write_slices; /* Partition offsets in order */
 
 
     /* -- Hierarchy administration -- */
 
     ecs_map_t *child_tables;        /* Child tables per parent entity */
+    ecs_map_t *name_index;          /* Named entities per scope & name hash */
+    ecs_map_t *name_entries;        /* Name index keys per named entity */
+    ecs_vector_t *name_pending;     /* Entities with names obtained mutably */
+    bool name_index_dirty;          /* Name index must be rebuilt */
     const char *name_prefix;        /* Remove prefix from C names in modules */
 
 
@@ -602,6 +775,12 @@ struct ecs_world_t {
     ecs_os_mutex_t sync_mutex;       /* Mutex for job_cond */
     int32_t workers_running;         /* Number of threads running */
     int32_t workers_waiting;         /* Number of workers waiting on sync */
+    int32_t sync_sense;              /* Flipped by main thread to release workers */
+    int32_t workers_parked;          /* Number of workers blocked on worker_cond */
+    int32_t main_parked;             /* Main thread is blocked on sync_cond */
+    int32_t sync_spin_count;         /* Polls before a thread parks on sync */
+    ecs_map_t *worker_jobs;          /* Job queues for systems */
+    int32_t job_chunk_size;          /* Max number of entities per job */
 
 
     /* -- Time management -- */
@@ -629,6 +808,23 @@ struct ecs_world_t {
     ecs_os_cond_t thr_cond;       /* Used to signal threads at end of frame */
 
 
+    /* -- Table storage -- */
+
+    int32_t column_alignment;     /* Minimum alignment of column buffers */
+    ecs_pool_t *pools[EcsPoolCount]; /* Memory pools for table storage */
+    ecs_vector_t *retired_pools;  /* Pools replaced by ecs_set_allocator */
+    int32_t cold_part_count;      /* Number of components with a cold part */
+    int32_t table_chunk_size;     /* Max rows per table chunk, 0 if disabled */
+
+
+    /* -- Table garbage collection -- */
+
+    int32_t gc_reclaim_after;     /* Frames after which empty tables are reclaimed */
+    int32_t gc_delete_after;      /* Frames after which empty tables are deleted */
+    ecs_vector_t *gc_queue;       /* Tables that were empty at some point */
+    int32_t snapshot_count;       /* Snapshots reference tables, pausing gc */
+
+
     /* -- Defered operation count -- */
     
     int32_t new_count;
@@ -644,6 +840,9 @@ struct ecs_world_t {
     /* -- World state -- */
 
     bool quit_workers;            /* Signals worker threads to quit */
+    bool parallel_merge;          /* Copy values on worker threads in merge */
+    bool defer_writes;            /* Collect values of set operations in merge */
+    bool merge_writes;            /* Signals worker threads to copy values */
     bool in_progress;             /* Is world being progressed */
     bool is_merging;              /* Is world currently being merged */
     bool is_fini;                 /* Is the world being cleaned up? */
@@ -715,6 +914,37 @@ void ecs_run_monitors(
     ecs_vector_t *v_src_monitors);
 
 
+////////////////////////////////////////////////////////////////////////////////
+//// Hierarchy API
+////////////////////////////////////////////////////////////////////////////////
+
+/* Update name index after the name of an entity changed */
+void ecs_name_index_update(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Name of entity may have been modified through a mutable pointer. The entity
+ * is reindexed before the next lookup. */
+void ecs_name_index_defer(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Update name index after an entity moved to a new table. This only needs to
+ * reindex the entity if its scope changed. */
+void ecs_name_index_move(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_table_t *table);
+
+/* Remove entity from name index */
+void ecs_name_index_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Free name index */
+void ecs_name_index_fini(
+    ecs_world_t *world);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// World API
 ////////////////////////////////////////////////////////////////////////////////
@@ -790,6 +1020,15 @@ bool ecs_stage_defer_begin(
 
 bool ecs_stage_defer_end(
     ecs_world_t *world,
+    ecs_stage_t *stage);
+
+/* Release payloads of deferred operations that were allocated after mark */
+void ecs_stage_defer_release(
+    ecs_stage_t *stage,
+    ecs_arena_mark_t mark);
+
+/* Release all payloads of deferred operations */
+void ecs_stage_defer_reset(
     ecs_stage_t *stage);    
 
 /* Delete table from stage */
@@ -797,6 +1036,11 @@ void ecs_delete_table(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Add empty table to the queue of tables that may be garbage collected */
+void ecs_table_gc_enqueue(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Defer API
 ////////////////////////////////////////////////////////////////////////////////
@@ -876,6 +1120,20 @@ bool ecs_defer_flush(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Divide deferred set operations into partitions by entity */
+void ecs_deferred_writes_partition(
+    ecs_world_t *world,
+    int32_t partition_count);
+
+/* Copy values of deferred set operations in partition */
+void ecs_deferred_writes_apply(
+    ecs_world_t *world,
+    int32_t partition);
+
+/* Run OnSet systems for deferred set operations and free values */
+void ecs_deferred_writes_end(
+    ecs_world_t *world);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Type API
 ////////////////////////////////////////////////////////////////////////////////
@@ -982,6 +1240,21 @@ void ecs_table_activate(
     ecs_query_t *query,
     bool activate);
 
+/* Release memory of an empty table, while keeping the table alive */
+void ecs_table_reclaim(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Reallocate columns after the column alignment of the world changed */
+void ecs_table_realign_columns(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get number of rows after which all columns start at the column alignment */
+int32_t ecs_table_row_alignment(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
 /* Clear all entities from a table. */
 void ecs_table_clear(
     ecs_world_t *world,
@@ -1024,7 +1297,8 @@ void ecs_table_delete(
     int32_t index,
     bool destruct);
 
-/* Move a row from one table to another */
+/* Move a row from one table to another. If map is not NULL, it is used to
+ * find the columns to move, construct and destruct. */
 void ecs_table_move(
     ecs_world_t *world,
     ecs_entity_t dst_entity,
@@ -1034,7 +1308,27 @@ void ecs_table_move(
     int32_t new_index,
     ecs_table_t *old_table,
     ecs_data_t *old_data,
-    int32_t old_index);
+    int32_t old_index,
+    const ecs_move_map_t *map);
+
+/* Compute column mapping for moving rows from old_table to new_table */
+ecs_move_map_t* ecs_move_map_new(
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data);
+
+/* Move a set of rows from one table to another. Rows must be sorted in
+ * ascending order, and tables may not have switch or bitset columns. Returns
+ * the index of the first moved row in the new table. */
+int32_t ecs_table_move_rows(
+    ecs_world_t *world,
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data,
+    const int32_t *rows,
+    int32_t count);
 
 /* Grow table with specified number of records. Populate table with entities,
  * starting from specified entity id. */
@@ -1119,6 +1413,22 @@ ecs_table_t *ecs_table_traverse_remove(
     ecs_entities_t *to_remove,
     ecs_entities_t *removed);
 
+/* Find table that also has the cold parts of the components in a table. Used
+ * when a table is looked up by type instead of by traversing the graph. */
+ecs_table_t *ecs_table_add_cold_parts(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get column mapping of the edge from src to dst for component e. Returns NULL
+ * if the edge does not lead to dst. */
+const ecs_move_map_t* ecs_table_get_move_map(
+    ecs_table_t *src,
+    ecs_data_t *src_data,
+    ecs_table_t *dst,
+    ecs_data_t *dst_data,
+    ecs_entity_t e,
+    bool add);
+
 void ecs_table_mark_dirty(
     ecs_table_t *table,
     ecs_entity_t component);
@@ -1141,6 +1451,50 @@ void ecs_table_clear_edges(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Remove table from component index and type lookup maps */
+void ecs_table_index_remove(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Keep type of a deleted table, so it can be reused if the table is recreated */
+void ecs_table_retire_type(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get chunk of table with room for count entities, creates chunk if needed */
+ecs_table_t* ecs_table_get_chunk(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count);
+
+/* Called when a chunk that was full has room for new entities again */
+void ecs_table_chunk_has_space(
+    ecs_table_t *table);
+
+/* Remove chunk from the first chunk of its type */
+void ecs_table_remove_chunk(
+    ecs_table_t *table);
+
+/* Returns whether tables with component can be found with component index */
+bool ecs_table_index_supports(
+    ecs_entity_t component);
+
+/* Number of tables returned by ecs_table_index_next for component */
+int32_t ecs_table_index_count(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    bool inherited);
+
+/* Iterate tables that have component. If inherited is true, tables with a base
+ * are returned as well, as they may inherit the component. Iteration starts
+ * with index and base_index set to 0, and ends when NULL is returned. */
+ecs_table_t* ecs_table_index_next(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    bool inherited,
+    int32_t *index,
+    int32_t *base_index);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Query API
 ////////////////////////////////////////////////////////////////////////////////
@@ -1207,11 +1561,6 @@ void ecs_increase_timer_resolution(
 //// Utilities
 ////////////////////////////////////////////////////////////////////////////////
 
-void ecs_hash(
-    const void *data,
-    ecs_size_t length,
-    uint64_t *result);
-
 /* Convert 64 bit signed integer to 16 bit */
 int8_t ecs_to_i8(
     int64_t v);
@@ -1770,7 +2119,8 @@ ecs_data_t* ecs_init_data(
                 if (component->size) {
                     /* This is a regular component column */
                     result->columns[i].size = ecs_to_i16(component->size);
-                    result->columns[i].alignment = ecs_to_i16(component->alignment);
+                    result->columns[i].alignment = ecs_to_i16(ECS_MAX(
+                        component->alignment, world->column_alignment));
                 } else {
                     /* This is a tag */
                 }
@@ -1842,7 +2192,10 @@ ecs_flags32_t get_component_action_flags(
     }
     if (c_info->on_remove) {
         flags |= EcsTableHasOnRemove;
-    }    
+    }
+    if (c_info->cold) {
+        flags |= EcsTableHasColdParts;
+    }
 
     return flags;  
 }
@@ -2136,6 +2489,135 @@ void ecs_table_activate(
             });                
         }
     }     
+
+    /* Table became empty, make it a candidate for garbage collection */
+    if (!activate && !query) {
+        ecs_table_gc_enqueue(world, table);
+    }
+}
+
+/* Release memory of an empty table. Columns are freed rather than shrunk, so
+ * that an empty table does not hold on to anything but its column array. The
+ * table is still valid, and allocates again when an entity is added. */
+void ecs_table_reclaim(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    (void)world;
+    ecs_data_t *data = ecs_table_get_data(table);
+    if (!data || !data->entities || ecs_table_data_count(data)) {
+        return;
+    }
+
+    ecs_column_t *columns = data->columns;
+    if (columns) {
+        int32_t c, column_count = table->column_count;
+        for (c = 0; c < column_count; c ++) {
+            ecs_vector_free_t(columns[c].data, columns[c].size, 
+                columns[c].alignment);
+            columns[c].data = NULL;
+        }
+    }
+
+    ecs_vector_free(data->entities);
+    ecs_vector_free(data->record_ptrs);
+    data->entities = NULL;
+    data->record_ptrs = NULL;
+
+    /* Invalidate references to the old column memory */
+    table->alloc_count ++;
+}
+
+/* Reallocate column buffers after the column alignment of the world changed */
+void ecs_table_realign_columns(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_data_t *data = ecs_table_get_data(table);
+    if (!data || !data->columns) {
+        return;
+    }
+
+    ecs_entity_t *components = ecs_vector_first(table->type, ecs_entity_t);
+    ecs_column_t *columns = data->columns;
+    int32_t c, column_count = table->column_count;
+    bool realloc = false;
+
+    for (c = 0; c < column_count; c ++) {
+        ecs_column_t *column = &columns[c];
+        int16_t size = column->size;
+        if (!size) {
+            continue;
+        }
+
+        const EcsComponent *component = ecs_component_from_id(
+            world, components[c]);
+        ecs_assert(component != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        int16_t alignment = ecs_to_i16(ECS_MAX(
+            component->alignment, world->column_alignment));
+        int16_t old_alignment = column->alignment;
+        if (alignment == old_alignment) {
+            continue;
+        }
+
+        ecs_vector_t *old_vec = column->data;
+        if (old_vec) {
+            int32_t count = ecs_vector_count(old_vec);
+            ecs_vector_t *new_vec = ecs_vector_new_w_pool_t(
+                world->pools[EcsPoolColumns], size, alignment, 
+                ecs_vector_size(old_vec));
+            ecs_vector_set_count_t(&new_vec, size, alignment, count);
+            ecs_os_memcpy(ecs_vector_first_t(new_vec, size, alignment),
+                ecs_vector_first_t(old_vec, size, old_alignment), size * count);
+            ecs_vector_free_t(old_vec, size, old_alignment);
+            column->data = new_vec;
+            realloc = true;
+        }
+
+        column->alignment = alignment;
+    }
+
+    if (realloc) {
+        table->alloc_count ++;
+    }
+}
+
+/* Get number of rows after which all columns of a table start at the column
+ * alignment of the world. Slices of a table that start at a multiple of this
+ * number are aligned in every column. */
+int32_t ecs_table_row_alignment(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    int32_t alignment = world->column_alignment;
+    ecs_data_t *data = table->data;
+    if (!alignment || !data || !data->columns) {
+        return 1;
+    }
+
+    ecs_column_t *columns = data->columns;
+    int32_t c, column_count = table->column_count;
+    int32_t result = 1;
+
+    for (c = 0; c < column_count; c ++) {
+        int32_t size = columns[c].size;
+        if (!size) {
+            continue;
+        }
+
+        /* Alignment is a power of two, so the number of rows needed to cover
+         * an aligned block is determined by the lowest set bit of the size */
+        int32_t size_alignment = size & -size;
+        if (size_alignment < alignment) {
+            int32_t rows = alignment / size_alignment;
+            if (rows > result) {
+                result = rows;
+            }
+        }
+    }
+
+    return result;
 }
 
 /* This function is called when a query is matched with a table. A table keeps
@@ -2244,6 +2726,19 @@ ecs_data_t* ecs_table_get_or_create_data(
     return get_data_intern(table, true);
 }
 
+/* Get the move action for relocating a value, which moves it to memory that
+ * has not been constructed and discards the old value without destructing it.
+ * Returns NULL if the value can be relocated with memcpy. */
+static
+ecs_move_t relocate_action(
+    const ecs_c_info_t * cdata)
+{
+    if (cdata && !cdata->lifecycle.relocatable) {
+        return cdata->lifecycle.move;
+    }
+    return NULL;
+}
+
 static
 void ctor_component(
     ecs_world_t * world,
@@ -2326,6 +2821,19 @@ void run_remove_actions(
     }
 }
 
+/* Entities are removed from a table. If the table is a chunk that was full, it
+ * can be appended to again. */
+static
+void remove_from_chunk(
+    ecs_table_t *table,
+    int32_t old_count,
+    int32_t size)
+{
+    if ((table->chunk_head || table->chunks) && old_count >= size) {
+        ecs_table_chunk_has_space(table);
+    }
+}
+
 void ecs_table_clear_data(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -2342,7 +2850,8 @@ void ecs_table_clear_data(
     if (columns) {
         int32_t c, column_count = table->column_count;
         for (c = 0; c < column_count; c ++) {
-            ecs_vector_free(columns[c].data);
+            ecs_vector_free_t(columns[c].data, columns[c].size, 
+                columns[c].alignment);
         }
         ecs_os_free(columns);
         data->columns = NULL;
@@ -2388,11 +2897,13 @@ void ecs_table_clear_silent(
     }
 
     int32_t count = ecs_vector_count(data->entities);
+    int32_t size = ecs_vector_size(data->entities);
     
     ecs_table_clear_data(world, table, data);
 
     if (count) {
         ecs_table_activate(world, table, 0, false);
+        remove_from_chunk(table, count, size);
     }
 }
 
@@ -2446,10 +2957,16 @@ void ecs_table_free(
 
     ecs_table_clear_edges(world, table);
 
-    ecs_os_free(table->lo_edges);
-    ecs_map_free(table->hi_edges);
+    ecs_map_free(table->edges);
     ecs_vector_free(table->queries);
-    ecs_vector_free((ecs_vector_t*)table->type);
+    ecs_vector_free(table->chunks);
+    ecs_vector_free(table->chunk_free);
+
+    /* The type of a chunk is owned by the first chunk of the type */
+    if (!table->chunk_head) {
+        ecs_vector_free((ecs_vector_t*)table->type);
+    }
+
     ecs_os_free(table->dirty_state);
     ecs_vector_free(table->monitors);
     ecs_vector_free(table->on_set_all);
@@ -2479,10 +2996,21 @@ void ecs_table_reset(
     ecs_table_t * table)
 {
     (void)world;
-    ecs_os_free(table->lo_edges);
-    ecs_map_free(table->hi_edges);
-    table->lo_edges = NULL;
-    table->hi_edges = NULL;
+
+    ecs_map_iter_t it = ecs_map_iter(table->edges);
+    ecs_edge_t *edge;
+    while ((edge = ecs_map_next(&it, ecs_edge_t, NULL))) {
+        if (edge->add_map) {
+            ecs_os_free(edge->add_map);
+        }
+        if (edge->remove_map) {
+            ecs_os_free(edge->remove_map);
+        }
+    }
+
+    ecs_map_free(table->edges);
+    table->edges = NULL;
+    ecs_os_memset(table->edge_cache, 0, ECS_SIZEOF(table->edge_cache));
 }
 
 static
@@ -2503,7 +3031,9 @@ void ecs_table_mark_dirty(
     if (table->dirty_state) {
         int32_t index = ecs_type_index_of(table->type, component);
         ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
-        table->dirty_state[index] ++;
+
+        /* Element 0 is reserved for changes to the entities in the table */
+        table->dirty_state[index + 1] ++;
     }
 }
 
@@ -2656,6 +3186,23 @@ void ensure_data(
     }
 }
 
+/* Column storage is allocated from the column pool of the world. A vector
+ * remembers the pool it was allocated from, so only creating it needs the pool.
+ * The capacity is the number of elements that is about to be added. */
+static
+void ensure_column(
+    ecs_world_t *world,
+    ecs_vector_t **vec,
+    ecs_size_t size,
+    int16_t alignment,
+    int32_t elem_count)
+{
+    if (!*vec) {
+        *vec = ecs_vector_new_w_pool_t(
+            world->pools[EcsPoolColumns], size, alignment, elem_count);
+    }
+}
+
 static
 void grow_column(
     ecs_world_t * world,
@@ -2666,10 +3213,11 @@ void grow_column(
     int32_t new_size,
     bool construct)
 {
-    ecs_vector_t *vec = column->data;
     int16_t alignment = column->alignment;
-
     int32_t size = column->size;
+    ensure_column(world, &column->data, size, alignment, new_size);
+
+    ecs_vector_t *vec = column->data;
     int32_t count = ecs_vector_count(vec);
     int32_t old_size = ecs_vector_size(vec);
     int32_t new_count = count + to_add;
@@ -2678,14 +3226,19 @@ void grow_column(
     ecs_assert(new_size >= new_count, ECS_INTERNAL_ERROR, NULL);
 
     /* If the array could possibly realloc and the component has a move action 
-     * defined, move old elements manually */
+     * defined, move old elements manually. Columns must remain contiguous, as
+     * iterators and the direct access API expose them as a single array. This
+     * makes growing a large table expensive, which applications can prevent
+     * by preallocating tables with ecs_dim_type, or by limiting the size of
+     * tables with ecs_set_table_chunk_size. */
     ecs_move_t move;
-    if (c_info && count && can_realloc && (move = c_info->lifecycle.move)) {
+    if (count && can_realloc && (move = relocate_action(c_info))) {
         ecs_xtor_t ctor = c_info->lifecycle.ctor;
         ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
 
         /* Create new vector */
-        ecs_vector_t *new_vec = ecs_vector_new_t(size, alignment, new_size);
+        ecs_vector_t *new_vec = ecs_vector_new_w_pool_t(
+            world->pools[EcsPoolColumns], size, alignment, new_size);
         ecs_vector_set_count_t(&new_vec, size, alignment, new_count);
 
         void *old_buffer = ecs_vector_first_t(
@@ -2705,7 +3258,7 @@ void grow_column(
             c_info->lifecycle.ctx);
 
         /* Free old vector */
-        ecs_vector_free(vec);
+        ecs_vector_free_t(vec, size, alignment);
         column->data = new_vec;
     } else {
         /* If array won't realloc or has no move, simply add new elements */
@@ -2753,6 +3306,8 @@ int32_t grow_data(
         &bs_column_count, &columns, &sw_columns, &bs_columns);    
 
     /* Add record to record ptr array */
+    ensure_column(world, &data->record_ptrs, ECS_SIZEOF(ecs_record_t*), 
+        ECS_ALIGNOF(ecs_record_t*), size);
     ecs_vector_set_size(&data->record_ptrs, ecs_record_t*, size);
     ecs_record_t **r = ecs_vector_addn(&data->record_ptrs, ecs_record_t*, to_add);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -2761,6 +3316,8 @@ int32_t grow_data(
     }
 
     /* Add entity to column with entity ids */
+    ensure_column(world, &data->entities, ECS_SIZEOF(ecs_entity_t), 
+        ECS_ALIGNOF(ecs_entity_t), size);
     ecs_vector_set_size(&data->entities, ecs_entity_t, size);
     ecs_entity_t *e = ecs_vector_addn(&data->entities, ecs_entity_t, to_add);
     ecs_assert(e != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -2823,6 +3380,7 @@ int32_t grow_data(
 
 static
 void fast_append(
+    ecs_world_t *world,
     ecs_column_t *columns,
     int32_t column_count)
 {
@@ -2833,6 +3391,7 @@ void fast_append(
         int16_t size = column->size;
         if (size) {
             int16_t alignment = column->alignment;
+            ensure_column(world, &column->data, size, alignment, 2);
             ecs_vector_add_t(&column->data, size, alignment);
         }
     }
@@ -2865,6 +3424,8 @@ int32_t ecs_table_append(
         &bs_column_count, &columns, &sw_columns, &bs_columns);
 
     /* Grow buffer with entity ids, set new element to new entity */
+    ensure_column(world, &data->entities, ECS_SIZEOF(ecs_entity_t), 
+        ECS_ALIGNOF(ecs_entity_t), 2);
     ecs_entity_t *e = ecs_vector_add(&data->entities, ecs_entity_t);
     ecs_assert(e != NULL, ECS_INTERNAL_ERROR, NULL);
     *e = entity;    
@@ -2874,6 +3435,8 @@ int32_t ecs_table_append(
     table->alloc_count += (count == size);
 
     /* Add record ptr to array with record ptrs */
+    ensure_column(world, &data->record_ptrs, ECS_SIZEOF(ecs_record_t*), 
+        ECS_ALIGNOF(ecs_record_t*), 2);
     ecs_record_t **r = ecs_vector_add(&data->record_ptrs, ecs_record_t*);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
     *r = record;
@@ -2891,7 +3454,7 @@ int32_t ecs_table_append(
 
     /* Fast path: no switch columns, no lifecycle actions */
     if (!(table->flags & EcsTableIsComplex)) {
-        fast_append(columns, column_count);
+        fast_append(world, columns, column_count);
         return count;
     }
 
@@ -3000,6 +3563,7 @@ void ecs_table_delete(
 
     ecs_entity_t *entities = ecs_vector_first(entity_column, ecs_entity_t);
     ecs_entity_t entity_to_move = entities[count];
+    ecs_entity_t entity_to_delete = entities[index];
 
     /* Move last entity id to index */
     entities[index] = entity_to_move;
@@ -3035,6 +3599,8 @@ void ecs_table_delete(
         ecs_table_activate(world, table, NULL, false);
     }
 
+    remove_from_chunk(table, count + 1, ecs_vector_size(entity_column));
+
     /* Move each component value in array to index */
     ecs_column_t *columns = data->columns;
 
@@ -3058,7 +3624,7 @@ void ecs_table_delete(
             void *dst = ecs_vector_get_t(column->data, size, alignment, index);
 
             ecs_move_t move;
-            if (c_info && (count != index) && (move = c_info->lifecycle.move)) {
+            if ((count != index) && (move = relocate_action(c_info))) {
                 void *ctx = c_info->lifecycle.ctx;
                 void *src = ecs_vector_get_t(column->data, size, alignment, count);
                 ecs_entity_t component = c_info->component;
@@ -3083,7 +3649,7 @@ void ecs_table_delete(
                 ecs_vector_remove_last(column->data);                              
             } else {
                 if (destruct && c_info && (dtor = c_info->lifecycle.dtor)) {
-                    dtor(world, c_info->component, &entities[index], dst, 
+                    dtor(world, c_info->component, &entity_to_delete, dst, 
                         ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
                 }
 
@@ -3107,36 +3673,161 @@ void ecs_table_delete(
     }    
 }
 
-static
-void fast_move(
-    ecs_table_t * new_table,
-    ecs_data_t * new_data,
-    int32_t new_index,
-    ecs_table_t * old_table,
-    ecs_data_t * old_data,
-    int32_t old_index)
+ecs_move_map_t* ecs_move_map_new(
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data)
 {
-    ecs_type_t new_type = new_table->type;
-    ecs_type_t old_type = old_table->type;
-
     int32_t i_new = 0, new_column_count = new_table->column_count;
     int32_t i_old = 0, old_column_count = old_table->column_count;
-    ecs_entity_t *new_components = ecs_vector_first(new_type, ecs_entity_t);
-    ecs_entity_t *old_components = ecs_vector_first(old_type, ecs_entity_t);
+    ecs_entity_t *new_components = ecs_vector_first(
+        new_table->type, ecs_entity_t);
+    ecs_entity_t *old_components = ecs_vector_first(
+        old_table->type, ecs_entity_t);
 
-    ecs_column_t *old_columns = old_data->columns;
     ecs_column_t *new_columns = new_data->columns;
+    ecs_column_t *old_columns = old_data->columns;
+
+    /* Allocate for the worst case, which is when no columns match */
+    int32_t max_count = new_column_count + old_column_count;
+    ecs_move_map_t *result = ecs_os_malloc(ECS_SIZEOF(ecs_move_map_t) + 
+        ECS_SIZEOF(int32_t) * max_count * 2);
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    int32_t *moves = ECS_OFFSET(result, ECS_SIZEOF(ecs_move_map_t));
+    int32_t *ctors = &moves[max_count];
+    int32_t *dtors = &ctors[new_column_count];
+    int32_t move_count = 0, ctor_count = 0, dtor_count = 0;
 
     for (; (i_new < new_column_count) && (i_old < old_column_count);) {
         ecs_entity_t new_component = new_components[i_new];
         ecs_entity_t old_component = old_components[i_old];
 
         if (new_component == old_component) {
-            ecs_column_t *new_column = &new_columns[i_new];
-            ecs_column_t *old_column = &old_columns[i_old];
-            int16_t size = new_column->size;
-
-            if (size) {
+            if (new_columns[i_new].size) {
+                moves[move_count * 2] = i_old;
+                moves[move_count * 2 + 1] = i_new;
+                move_count ++;
+            }
+        } else if (new_component < old_component) {
+            if (new_columns[i_new].size) {
+                ctors[ctor_count ++] = i_new;
+            }
+        } else {
+            if (old_columns[i_old].size) {
+                dtors[dtor_count ++] = i_old;
+            }
+        }
+
+        i_new += new_component <= old_component;
+        i_old += new_component >= old_component;
+    }
+
+    for (; (i_new < new_column_count); i_new ++) {
+        if (new_columns[i_new].size) {
+            ctors[ctor_count ++] = i_new;
+        }
+    }
+
+    for (; (i_old < old_column_count); i_old ++) {
+        if (old_columns[i_old].size) {
+            dtors[dtor_count ++] = i_old;
+        }
+    }
+
+    /* Make ctor and dtor columns follow the moved columns */
+    ecs_os_memmove(&moves[move_count * 2], ctors, 
+        ECS_SIZEOF(int32_t) * ctor_count);
+    ecs_os_memmove(&moves[move_count * 2 + ctor_count], dtors, 
+        ECS_SIZEOF(int32_t) * dtor_count);
+
+    result->move_count = move_count;
+    result->ctor_count = ctor_count;
+    result->dtor_count = dtor_count;
+    result->columns = moves;
+
+    return result;
+}
+
+static
+void move_component(
+    ecs_world_t * world,
+    ecs_c_info_t * cdata,
+    ecs_entity_t component,
+    ecs_entity_t dst_entity,
+    ecs_entity_t src_entity,
+    void * dst,
+    void * src,
+    int16_t size,
+    bool same_entity)
+{
+    if (same_entity) {
+        ecs_move_t move;
+        if ((move = relocate_action(cdata))) {
+            void *ctx = cdata->lifecycle.ctx;
+            ecs_xtor_t ctor = cdata->lifecycle.ctor;
+
+            /* Ctor should always be set if copy is set */
+            ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
+
+            /* Construct a new value, move the value to it */
+            ctor(world, component, &dst_entity, dst, 
+                    ecs_to_size_t(size), 1, ctx);
+
+            move(world, component, &dst_entity, &src_entity, 
+                dst, src, ecs_to_size_t(size), 1, ctx);
+        } else {
+            ecs_os_memcpy(dst, src, size);
+        }
+    } else {
+        ecs_copy_t copy;
+        if (cdata && (copy = cdata->lifecycle.copy)) {
+            void *ctx = cdata->lifecycle.ctx;
+            ecs_xtor_t ctor = cdata->lifecycle.ctor;
+
+            /* Ctor should always be set if copy is set */
+            ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
+            ctor(world, component, &dst_entity, dst, 
+                ecs_to_size_t(size), 1, ctx);
+            copy(world, component, &dst_entity, &src_entity, 
+                dst, src, ecs_to_size_t(size), 1, ctx);
+        } else {
+            ecs_os_memcpy(dst, src, size);
+        }
+    }
+}
+
+static
+void fast_move(
+    ecs_table_t * new_table,
+    ecs_data_t * new_data,
+    int32_t new_index,
+    ecs_table_t * old_table,
+    ecs_data_t * old_data,
+    int32_t old_index)
+{
+    ecs_type_t new_type = new_table->type;
+    ecs_type_t old_type = old_table->type;
+
+    int32_t i_new = 0, new_column_count = new_table->column_count;
+    int32_t i_old = 0, old_column_count = old_table->column_count;
+    ecs_entity_t *new_components = ecs_vector_first(new_type, ecs_entity_t);
+    ecs_entity_t *old_components = ecs_vector_first(old_type, ecs_entity_t);
+
+    ecs_column_t *old_columns = old_data->columns;
+    ecs_column_t *new_columns = new_data->columns;
+
+    for (; (i_new < new_column_count) && (i_old < old_column_count);) {
+        ecs_entity_t new_component = new_components[i_new];
+        ecs_entity_t old_component = old_components[i_old];
+
+        if (new_component == old_component) {
+            ecs_column_t *new_column = &new_columns[i_new];
+            ecs_column_t *old_column = &old_columns[i_old];
+            int16_t size = new_column->size;
+
+            if (size) {
                 int16_t alignment = new_column->alignment;
                 void *dst = ecs_vector_get_t(new_column->data, size, alignment, new_index);
                 void *src = ecs_vector_get_t(old_column->data, size, alignment, old_index);
@@ -3152,6 +3843,91 @@ void fast_move(
     }
 }
 
+/* Same as fast_move, but uses the column mapping of a table graph edge */
+static
+void fast_move_w_map(
+    ecs_data_t * new_data,
+    int32_t new_index,
+    ecs_data_t * old_data,
+    int32_t old_index,
+    const ecs_move_map_t * map)
+{
+    ecs_column_t *old_columns = old_data->columns;
+    ecs_column_t *new_columns = new_data->columns;
+    const int32_t *moves = map->columns;
+    int32_t i, count = map->move_count;
+
+    for (i = 0; i < count; i ++) {
+        ecs_column_t *old_column = &old_columns[moves[i * 2]];
+        ecs_column_t *new_column = &new_columns[moves[i * 2 + 1]];
+        int16_t size = new_column->size;
+        int16_t alignment = new_column->alignment;
+
+        void *dst = ecs_vector_get_t(new_column->data, size, alignment, new_index);
+        void *src = ecs_vector_get_t(old_column->data, size, alignment, old_index);
+
+        ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_os_memcpy(dst, src, size);
+    }
+}
+
+static
+void move_w_map(
+    ecs_world_t * world,
+    ecs_entity_t dst_entity,
+    ecs_entity_t src_entity,
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    int32_t new_index,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data,
+    int32_t old_index,
+    const ecs_move_map_t * map)
+{
+    bool same_entity = dst_entity == src_entity;
+    ecs_entity_t *new_components = ecs_vector_first(
+        new_table->type, ecs_entity_t);
+    ecs_column_t *old_columns = old_data->columns;
+    ecs_column_t *new_columns = new_data->columns;
+    const int32_t *columns = map->columns;
+    int32_t i, count = map->move_count;
+
+    for (i = 0; i < count; i ++) {
+        int32_t i_old = columns[i * 2];
+        int32_t i_new = columns[i * 2 + 1];
+        ecs_column_t *old_column = &old_columns[i_old];
+        ecs_column_t *new_column = &new_columns[i_new];
+        int16_t size = new_column->size;
+        int16_t alignment = new_column->alignment;
+
+        void *dst = ecs_vector_get_t(new_column->data, size, alignment, new_index);
+        void *src = ecs_vector_get_t(old_column->data, size, alignment, old_index);
+
+        ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        move_component(world, new_table->c_info[i_new], new_components[i_new],
+            dst_entity, src_entity, dst, src, size, same_entity);
+    }
+
+    columns = &columns[count * 2];
+    count = map->ctor_count;
+    for (i = 0; i < count; i ++) {
+        int32_t i_new = columns[i];
+        ctor_component(world, new_table->c_info[i_new],
+            &new_columns[i_new], &dst_entity, new_index, 1);
+    }
+
+    columns = &columns[count];
+    count = map->dtor_count;
+    for (i = 0; i < count; i ++) {
+        int32_t i_old = columns[i];
+        dtor_component(world, old_table->c_info[i_old],
+            &old_columns[i_old], &src_entity, old_index, 1);
+    }
+}
+
 void ecs_table_move(
     ecs_world_t * world,
     ecs_entity_t dst_entity,
@@ -3161,7 +3937,8 @@ void ecs_table_move(
     int32_t new_index,
     ecs_table_t *old_table,
     ecs_data_t *old_data,
-    int32_t old_index)
+    int32_t old_index,
+    const ecs_move_map_t *map)
 {
     ecs_assert(new_table != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(old_table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -3173,7 +3950,12 @@ void ecs_table_move(
     ecs_assert(new_data != NULL, ECS_INTERNAL_ERROR, NULL);
 
     if (!((new_table->flags | old_table->flags) & EcsTableIsComplex)) {
-        fast_move(new_table, new_data, new_index, old_table, old_data, old_index);
+        if (map) {
+            fast_move_w_map(new_data, new_index, old_data, old_index, map);
+        } else {
+            fast_move(new_table, new_data, new_index, 
+                old_table, old_data, old_index);
+        }
         return;
     }
 
@@ -3183,6 +3965,12 @@ void ecs_table_move(
     move_bitset_columns(
         new_table, new_data, new_index, old_table, old_data, old_index, 1);
 
+    if (map) {
+        move_w_map(world, dst_entity, src_entity, new_table, new_data, 
+            new_index, old_table, old_data, old_index, map);
+        return;
+    }
+
     bool same_entity = dst_entity == src_entity;
 
     ecs_type_t new_type = new_table->type;
@@ -3213,41 +4001,8 @@ void ecs_table_move(
                 ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
                 ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
 
-                ecs_c_info_t *cdata = new_table->c_info[i_new];
-                if (same_entity) {
-                    ecs_move_t move;
-                    if (cdata && (move = cdata->lifecycle.move)) {
-                        void *ctx = cdata->lifecycle.ctx;
-                        ecs_xtor_t ctor = cdata->lifecycle.ctor;
-
-                        /* Ctor should always be set if copy is set */
-                        ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
-
-                        /* Construct a new value, move the value to it */
-                        ctor(world, new_component, &dst_entity, dst, 
-                                ecs_to_size_t(size), 1, ctx);
-
-                        move(world, new_component, &dst_entity, &src_entity, 
-                            dst, src, ecs_to_size_t(size), 1, ctx);
-                    } else {
-                        ecs_os_memcpy(dst, src, size);
-                    }
-                } else {
-                    ecs_copy_t copy;
-                    if (cdata && (copy = cdata->lifecycle.copy)) {
-                        void *ctx = cdata->lifecycle.ctx;
-                        ecs_xtor_t ctor = cdata->lifecycle.ctor;
-
-                        /* Ctor should always be set if copy is set */
-                        ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
-                        ctor(world, new_component, &dst_entity, dst, 
-                            ecs_to_size_t(size), 1, ctx);
-                        copy(world, new_component, &dst_entity, &src_entity, 
-                            dst, src, ecs_to_size_t(size), 1, ctx);
-                    } else {
-                        ecs_os_memcpy(dst, src, size);
-                    }
-                }
+                move_component(world, new_table->c_info[i_new], new_component,
+                    dst_entity, src_entity, dst, src, size, same_entity);
             }
         } else {
             if (new_component < old_component) {
@@ -3274,113 +4029,347 @@ void ecs_table_move(
     }
 }
 
-int32_t ecs_table_appendn(
-    ecs_world_t * world,
-    ecs_table_t * table,
-    ecs_data_t * data,
-    int32_t to_add,
-    const ecs_entity_t *ids)
-{
-    int32_t cur_count = ecs_table_data_count(data);
-    return grow_data(world, table, data, to_add, cur_count + to_add, ids);
-}
-
-void ecs_table_set_size(
+/* Remove a sorted set of rows from a table in a single pass. Holes below the
+ * new table count are filled with the last rows that are kept, so that every
+ * column is traversed once regardless of the number of deleted rows. Values in
+ * the deleted rows must already have been moved or destructed. */
+static
+void delete_rows(
     ecs_world_t * world,
     ecs_table_t * table,
     ecs_data_t * data,
-    int32_t size)
+    const int32_t * rows,
+    int32_t count)
 {
-    int32_t cur_count = ecs_table_data_count(data);
+    int32_t src_count = ecs_vector_count(data->entities);
+    int32_t new_count = src_count - count;
 
-    if (cur_count < size) {
-        grow_data(world, table, data, 0, size, NULL);
-    } else if (!size) {
-        /* Initialize columns if 0 is passed. This is a shortcut to initialize
-         * columns when, for example, an API call is inserting bulk data. */
-        int32_t column_count = table->column_count;
-        int32_t sw_column_count = table->sw_column_count;
-        int32_t bs_column_count = table->bs_column_count;
-        ecs_column_t *columns;
-        ecs_sw_column_t *sw_columns;
-        ecs_bs_column_t *bs_columns;
-        ensure_data(world, table, data, &column_count, &sw_column_count,
-            &bs_column_count, &columns, &sw_columns, &bs_columns);
-    }
-}
+    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
+    ecs_record_t **records = ecs_vector_first(data->record_ptrs, ecs_record_t*);
 
-int32_t ecs_table_data_count(
-    ecs_data_t *data)
-{
-    return data ? ecs_vector_count(data->entities) : 0;
-}
+    /* Find which rows fill the holes */
+    int32_t *fill = ecs_os_malloc(ECS_SIZEOF(int32_t) * count * 2);
+    int32_t *holes = &fill[count];
+    int32_t i, fill_count = 0, last = src_count - 1, r = count - 1;
+    for (i = 0; i < count && rows[i] < new_count; i ++) {
+        while (r >= 0 && rows[r] == last) {
+            r --;
+            last --;
+        }
 
-static
-void swap_switch_columns(
-    ecs_table_t * table,
-    ecs_data_t * data,
-    int32_t row_1,
-    int32_t row_2)
-{
-    int32_t i = 0, column_count = table->sw_column_count;
-    if (!column_count) {
-        return;
+        ecs_assert(last >= new_count, ECS_INTERNAL_ERROR, NULL);
+        holes[fill_count] = rows[i];
+        fill[fill_count ++] = last --;
     }
 
-    ecs_sw_column_t *columns = data->sw_columns;
+    for (i = 0; i < fill_count; i ++) {
+        int32_t hole = holes[i];
+        entities[hole] = entities[fill[i]];
+        records[hole] = records[fill[i]];
 
-    for (i = 0; i < column_count; i ++) {
-        ecs_switch_t *sw = columns[i].data;
-        ecs_switch_swap(sw, row_1, row_2);
+        ecs_record_t *record = records[hole];
+        if (record) {
+            if (record->row >= 0) {
+                record->row = hole + 1;
+            } else {
+                record->row = -(hole + 1);
+            }
+            ecs_assert(record->table == table, ECS_INTERNAL_ERROR, NULL);
+        }
     }
-}
 
-static
-void swap_bitset_columns(
-    ecs_table_t * table,
-    ecs_data_t * data,
-    int32_t row_1,
-    int32_t row_2)
-{
-    int32_t i = 0, column_count = table->bs_column_count;
-    if (!column_count) {
-        return;
-    }
+    ecs_c_info_t **c_info_array = table->c_info;
+    ecs_column_t *columns = data->columns;
+    int32_t c, column_count = table->column_count;
+    for (c = 0; c < column_count; c ++) {
+        ecs_column_t *column = &columns[c];
+        int16_t size = column->size;
+        int16_t alignment = column->alignment;
+        if (!size) {
+            continue;
+        }
 
-    ecs_bs_column_t *columns = data->bs_columns;
+        void *buffer = ecs_vector_first_t(column->data, size, alignment);
+        ecs_c_info_t *c_info = c_info_array ? c_info_array[c] : NULL;
+        ecs_move_t move = relocate_action(c_info);
+
+        for (i = 0; i < fill_count; i ++) {
+            void *dst = ECS_OFFSET(buffer, size * holes[i]);
+            void *src = ECS_OFFSET(buffer, size * fill[i]);
+            if (move) {
+                /* Deleted element was moved or destructed, so construct it
+                 * before moving the last element into it */
+                ecs_entity_t e = entities[holes[i]];
+                c_info->lifecycle.ctor(world, c_info->component, &e, dst, 
+                    ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
+                move(world, c_info->component, &e, &e, dst, src,
+                    ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
+            } else {
+                ecs_os_memcpy(dst, src, size);
+            }
+        }
 
-    for (i = 0; i < column_count; i ++) {
-        ecs_bitset_t *bs = &columns[i].data;
-        ecs_bitset_swap(bs, row_1, row_2);
+        ecs_vector_set_count_t(&column->data, size, alignment, new_count);
     }
-}
 
-void ecs_table_swap(
-    ecs_world_t * world,
-    ecs_table_t * table,
-    ecs_data_t * data,
-    int32_t row_1,
-    int32_t row_2)
-{    
-    (void)world;
+    ecs_vector_set_count(&data->entities, ecs_entity_t, new_count);
+    ecs_vector_set_count(&data->record_ptrs, ecs_record_t*, new_count);
 
-    ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_column_t *columns = data->columns;
-    ecs_assert(columns != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_os_free(fill);
 
-    ecs_assert(row_1 >= 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(row_2 >= 0, ECS_INTERNAL_ERROR, NULL);
-    
-    if (row_1 == row_2) {
-        return;
+    /* If the table is monitored indicate that there has been a change */
+    mark_table_dirty(table, 0);
+
+    if (!new_count) {
+        ecs_table_activate(world, table, NULL, false);
     }
 
-    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
-    ecs_entity_t e1 = entities[row_1];
-    ecs_entity_t e2 = entities[row_2];
+    remove_from_chunk(table, src_count, ecs_vector_size(data->entities));
+}
 
-    ecs_record_t **record_ptrs = ecs_vector_first(data->record_ptrs, ecs_record_t*);
-    ecs_record_t *record_ptr_1 = record_ptrs[row_1];
+int32_t ecs_table_move_rows(
+    ecs_world_t * world,
+    ecs_table_t * new_table,
+    ecs_data_t * new_data,
+    ecs_table_t * old_table,
+    ecs_data_t * old_data,
+    const int32_t * rows,
+    int32_t count)
+{
+    ecs_assert(new_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(old_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(new_table != old_table, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(new_data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(old_data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!new_table->sw_column_count && !old_table->sw_column_count,
+        ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!new_table->bs_column_count && !old_table->bs_column_count,
+        ECS_INTERNAL_ERROR, NULL);
+
+    ecs_entity_t *old_entities = ecs_vector_first(
+        old_data->entities, ecs_entity_t);
+    ecs_record_t **old_records = ecs_vector_first(
+        old_data->record_ptrs, ecs_record_t*);
+
+    ecs_entity_t *ids = ecs_os_malloc(ECS_SIZEOF(ecs_entity_t) * count);
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_assert(!i || rows[i] > rows[i - 1], ECS_INTERNAL_ERROR, NULL);
+        ids[i] = old_entities[rows[i]];
+    }
+
+    /* Append all rows at once. This constructs the new elements. */
+    int32_t new_count = ecs_table_data_count(new_data);
+    int32_t new_index = grow_data(
+        world, new_table, new_data, count, new_count + count, ids);
+
+    ecs_record_t **new_records = ecs_vector_first(
+        new_data->record_ptrs, ecs_record_t*);
+    for (i = 0; i < count; i ++) {
+        new_records[new_index + i] = old_records[rows[i]];
+    }
+
+    ecs_type_t new_type = new_table->type;
+    ecs_type_t old_type = old_table->type;
+
+    int32_t i_new = 0, new_column_count = new_table->column_count;
+    int32_t i_old = 0, old_column_count = old_table->column_count;
+    ecs_entity_t *new_components = ecs_vector_first(new_type, ecs_entity_t);
+    ecs_entity_t *old_components = ecs_vector_first(old_type, ecs_entity_t);
+
+    ecs_column_t *old_columns = old_data->columns;
+    ecs_column_t *new_columns = new_data->columns;
+
+    /* Copy values column by column. Consecutive source rows are copied with a
+     * single memcpy or move. */
+    for (; (i_new < new_column_count) && (i_old < old_column_count);) {
+        ecs_entity_t new_component = new_components[i_new];
+        ecs_entity_t old_component = old_components[i_old];
+
+        if (new_component == old_component) {
+            ecs_column_t *new_column = &new_columns[i_new];
+            ecs_column_t *old_column = &old_columns[i_old];
+            int16_t size = new_column->size;
+            int16_t alignment = new_column->alignment;
+
+            if (size) {
+                void *dst = ecs_vector_get_t(
+                    new_column->data, size, alignment, new_index);
+                void *src = ecs_vector_first_t(
+                    old_column->data, size, alignment);
+
+                ecs_c_info_t *cdata = new_table->c_info ? 
+                    new_table->c_info[i_new] : NULL;
+                ecs_move_t move = relocate_action(cdata);
+                if (!move && cdata && cdata->lifecycle.dtor) {
+                    /* Values are relocated with memcpy into elements that were
+                     * constructed when appending, so destruct those first */
+                    cdata->lifecycle.dtor(world, new_component, ids, dst, 
+                        ecs_to_size_t(size), count, cdata->lifecycle.ctx);
+                }
+
+                int32_t start, end;
+                for (start = 0; start < count; start = end) {
+                    for (end = start + 1; end < count; end ++) {
+                        if (rows[end] != rows[end - 1] + 1) {
+                            break;
+                        }
+                    }
+
+                    void *dst_ptr = ECS_OFFSET(dst, size * start);
+                    void *src_ptr = ECS_OFFSET(src, size * rows[start]);
+                    if (move) {
+                        move(world, new_component, &ids[start], &ids[start],
+                            dst_ptr, src_ptr, ecs_to_size_t(size), 
+                            end - start, cdata->lifecycle.ctx);
+                    } else {
+                        ecs_os_memcpy(dst_ptr, src_ptr, size * (end - start));
+                    }
+                }
+            }
+        } else if (new_component > old_component) {
+            /* Components that are not in the new table are destructed. New
+             * components have already been constructed when appending. */
+            ecs_c_info_t *cdata = old_table->c_info ? 
+                old_table->c_info[i_old] : NULL;
+            if (cdata && cdata->lifecycle.dtor && old_columns[i_old].size) {
+                for (i = 0; i < count; i ++) {
+                    dtor_component(world, cdata, &old_columns[i_old], 
+                        &ids[i], rows[i], 1);
+                }
+            }
+        }
+
+        i_new += new_component <= old_component;
+        i_old += new_component >= old_component;
+    }
+
+    for (; (i_old < old_column_count); i_old ++) {
+        ecs_c_info_t *cdata = old_table->c_info ? 
+            old_table->c_info[i_old] : NULL;
+        if (cdata && cdata->lifecycle.dtor && old_columns[i_old].size) {
+            for (i = 0; i < count; i ++) {
+                dtor_component(world, cdata, &old_columns[i_old], 
+                    &ids[i], rows[i], 1);
+            }
+        }
+    }
+
+    ecs_os_free(ids);
+
+    delete_rows(world, old_table, old_data, rows, count);
+
+    return new_index;
+}
+
+int32_t ecs_table_appendn(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_data_t * data,
+    int32_t to_add,
+    const ecs_entity_t *ids)
+{
+    int32_t cur_count = ecs_table_data_count(data);
+    return grow_data(world, table, data, to_add, cur_count + to_add, ids);
+}
+
+void ecs_table_set_size(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_data_t * data,
+    int32_t size)
+{
+    int32_t cur_count = ecs_table_data_count(data);
+
+    if (cur_count < size) {
+        grow_data(world, table, data, 0, size, NULL);
+    } else if (!size) {
+        /* Initialize columns if 0 is passed. This is a shortcut to initialize
+         * columns when, for example, an API call is inserting bulk data. */
+        int32_t column_count = table->column_count;
+        int32_t sw_column_count = table->sw_column_count;
+        int32_t bs_column_count = table->bs_column_count;
+        ecs_column_t *columns;
+        ecs_sw_column_t *sw_columns;
+        ecs_bs_column_t *bs_columns;
+        ensure_data(world, table, data, &column_count, &sw_column_count,
+            &bs_column_count, &columns, &sw_columns, &bs_columns);
+    }
+}
+
+int32_t ecs_table_data_count(
+    ecs_data_t *data)
+{
+    return data ? ecs_vector_count(data->entities) : 0;
+}
+
+static
+void swap_switch_columns(
+    ecs_table_t * table,
+    ecs_data_t * data,
+    int32_t row_1,
+    int32_t row_2)
+{
+    int32_t i = 0, column_count = table->sw_column_count;
+    if (!column_count) {
+        return;
+    }
+
+    ecs_sw_column_t *columns = data->sw_columns;
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_switch_t *sw = columns[i].data;
+        ecs_switch_swap(sw, row_1, row_2);
+    }
+}
+
+static
+void swap_bitset_columns(
+    ecs_table_t * table,
+    ecs_data_t * data,
+    int32_t row_1,
+    int32_t row_2)
+{
+    int32_t i = 0, column_count = table->bs_column_count;
+    if (!column_count) {
+        return;
+    }
+
+    ecs_bs_column_t *columns = data->bs_columns;
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_bitset_t *bs = &columns[i].data;
+        ecs_bitset_swap(bs, row_1, row_2);
+    }
+}
+
+void ecs_table_swap(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_data_t * data,
+    int32_t row_1,
+    int32_t row_2)
+{    
+    (void)world;
+
+    ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_column_t *columns = data->columns;
+    ecs_assert(columns != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_assert(row_1 >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(row_2 >= 0, ECS_INTERNAL_ERROR, NULL);
+    
+    if (row_1 == row_2) {
+        return;
+    }
+
+    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
+    ecs_entity_t e1 = entities[row_1];
+    ecs_entity_t e2 = entities[row_2];
+
+    ecs_record_t **record_ptrs = ecs_vector_first(data->record_ptrs, ecs_record_t*);
+    ecs_record_t *record_ptr_1 = record_ptrs[row_1];
     ecs_record_t *record_ptr_2 = record_ptrs[row_2];
 
     ecs_assert(record_ptr_1 != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -3444,7 +4433,7 @@ void merge_vector(
 
     if (!dst_count) {
         if (dst) {
-            ecs_vector_free(dst);
+            ecs_vector_free_t(dst, size, alignment);
         }
 
         *dst_out = src;
@@ -3462,7 +4451,7 @@ void merge_vector(
         
         ecs_os_memcpy(dst_ptr, src_ptr, size * src_count);
 
-        ecs_vector_free(src);
+        ecs_vector_free_t(src, size, alignment);
         *dst_out = dst;
     }
 }
@@ -3485,7 +4474,7 @@ void merge_column(
 
     if (!dst_count) {
         if (dst) {
-            ecs_vector_free(dst);
+            ecs_vector_free_t(dst, size, alignment);
         }
 
         column->data = src;
@@ -3497,8 +4486,9 @@ void merge_column(
         ecs_vector_set_count_t(&dst, size, alignment, dst_count + src_count);
         column->data = dst;
 
-        /* Construct new values */
-        if (c_info) {
+        /* Construct new values, unless they can be relocated */
+        ecs_move_t move = relocate_action(c_info);
+        if (move) {
             ctor_component(
                 world, c_info, column, entities, dst_count, src_count);
         }
@@ -3509,8 +4499,7 @@ void merge_column(
         dst_ptr = ECS_OFFSET(dst_ptr, size * dst_count);
         
         /* Move values into column */
-        ecs_move_t move;
-        if (c_info && (move = c_info->lifecycle.move)) {
+        if (move) {
             move(world, c_info->component, entities, entities, 
                 dst_ptr, src_ptr, ecs_to_size_t(size), src_count, 
                 c_info->lifecycle.ctx);
@@ -3518,7 +4507,7 @@ void merge_column(
             ecs_os_memcpy(dst_ptr, src_ptr, size * src_count);
         }
 
-        ecs_vector_free(src);
+        ecs_vector_free_t(src, size, alignment);
     }
 }
 
@@ -3590,6 +4579,8 @@ void merge_table_data(
              * enough. */
             if (size) {
                 ecs_column_t *column = &new_columns[i_new];
+                ensure_column(world, &column->data, size, alignment, 
+                    old_count + new_count);
                 ecs_vector_set_count_t(&column->data, size, alignment,
                     old_count + new_count);
 
@@ -3620,7 +4611,7 @@ void merge_table_data(
                 }
 
                 /* Old column does not occur in new table, remove */
-                ecs_vector_free(column->data);
+                ecs_vector_free_t(column->data, size, column->alignment);
                 column->data = NULL;
 
                 i_old ++;
@@ -3638,6 +4629,8 @@ void merge_table_data(
         int16_t alignment = column->alignment;
 
         if (size) {
+            ensure_column(world, &column->data, size, alignment, 
+                old_count + new_count);
             ecs_vector_set_count_t(&column->data, size, alignment,
                 old_count + new_count);
 
@@ -3668,7 +4661,7 @@ void merge_table_data(
         }
 
         /* Old column does not occur in new table, remove */
-        ecs_vector_free(column->data);
+        ecs_vector_free_t(column->data, column->size, column->alignment);
         column->data = NULL;
     }    
 
@@ -3716,6 +4709,11 @@ ecs_data_t* ecs_table_merge(
         }
     }
 
+    /* Named entities may have moved to another scope */
+    if (new_table->flags & EcsTableHasName) {
+        world->name_index_dirty = true;
+    }
+
     ecs_entity_t *old_entities = ecs_vector_first(old_data->entities, ecs_entity_t);
 
     int32_t old_count = ecs_vector_count(old_data->entities);
@@ -3779,6 +4777,10 @@ void ecs_table_replace_data(
         return;
     }
 
+    if (table->flags & EcsTableHasName) {
+        world->name_index_dirty = true;
+    }
+
     int32_t count = ecs_table_count(table);
 
     if (!prev_count && count) {
@@ -4434,8 +5436,10 @@ void instantiate_children(
         }
 #endif
 
-        /* Create children */
+        /* Create children. Get the chunk up front, as the rows of the new
+         * children are looked up in the table. */
         int32_t child_row; 
+        i_table = ecs_table_get_chunk(world, i_table, child_count);
         new_w_data(world, i_table, NULL, child_count, c_info, &child_row);       
 
         /* If prefab child table has children itself, recursively instantiate */
@@ -4892,8 +5896,19 @@ int32_t move_entity(
                 world, src_table, src_data, src_row, 1, removed, false);
         }
 
+        /* If a single component is added or removed, the entity moves along
+         * a single edge, which caches the column mapping between tables */
+        const ecs_move_map_t *map = NULL;
+        int32_t added_count = added ? added->count : 0;
+        int32_t removed_count = removed ? removed->count : 0;
+        if (added_count + removed_count == 1) {
+            ecs_entity_t e = added_count ? added->array[0] : removed->array[0];
+            map = ecs_table_get_move_map(
+                src_table, src_data, dst_table, dst_data, e, added_count != 0);
+        }
+
         ecs_table_move(world, entity, entity, dst_table, dst_data, dst_row, 
-            src_table, src_data, src_row);                
+            src_table, src_data, src_row, map);
     }
     
     ecs_table_delete(world, src_table, src_data, src_row, false);
@@ -4968,7 +5983,7 @@ bool update_component_monitor_w_array(
     int i;
     for (i = 0; i < entities->count; i ++) {
         ecs_entity_t component = entities->array[i];
-        if (component < ECS_HI_COMPONENT_ID) {
+        if (!(component & ECS_ROLE_MASK)) {
             ecs_component_monitor_mark(mon, component);
         } else if (ECS_HAS_ROLE(component, CHILDOF)) {
             childof_changed = true;
@@ -5028,6 +6043,12 @@ void commit(
     ecs_assert(!world->in_progress, ECS_INTERNAL_ERROR, NULL);
     
     ecs_table_t *src_table = info->table;
+
+    /* Traversing from a chunk to its own type ends up in the first chunk */
+    if (src_table && src_table->chunk_head == dst_table) {
+        dst_table = src_table;
+    }
+
     if (src_table == dst_table) {
         /* If source and destination table are the same no action is needed *
          * However, if a component was added in the process of traversing a
@@ -5042,6 +6063,8 @@ void commit(
         return;
     }  
 
+    dst_table = ecs_table_get_chunk(world, dst_table, 1);
+
     if (src_table) {
         ecs_data_t *src_data = info->data;
         ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -5075,6 +6098,13 @@ void commit(
         update_component_monitors(world, entity, added, removed);
     }
 
+    /* If entity has a name, it may have moved to another scope */
+    if ((src_table && src_table->flags & EcsTableHasName) || 
+        (dst_table->flags & EcsTableHasName)) 
+    {
+        ecs_name_index_move(world, entity, dst_table);
+    }
+
     if ((!src_table || !src_table->type) && world->range_check_enabled) {
         ecs_assert(!world->stats.max_id || entity <= world->stats.max_id, ECS_OUT_OF_RANGE, 0);
         ecs_assert(entity >= world->stats.min_id, ECS_OUT_OF_RANGE, 0);
@@ -5117,6 +6147,7 @@ void new(
     ecs_entity_info_t info = {0};
     ecs_table_t *table = ecs_table_traverse_add(
         world, world->stage.scope_table, to_add, NULL);
+    table = ecs_table_get_chunk(world, table, 1);
     new_entity(world, entity, &info, table, to_add);
 }
 
@@ -5142,6 +6173,8 @@ const ecs_entity_t* new_w_data(
         return ids;        
     }
 
+    table = ecs_table_get_chunk(world, table, count);
+
     ecs_entities_t component_array = { 0 };
     if (!component_ids) {
         component_ids = &component_array;
@@ -5208,6 +6241,10 @@ const ecs_entity_t* new_w_data(
         };
 
         ecs_run_set_systems(world, &added, table, data, row, count, true);        
+
+        if (table->flags & EcsTableHasName) {
+            world->name_index_dirty = true;
+        }
     }
 
     ecs_run_monitors(world, table, table->monitors, row, count, NULL);
@@ -5620,8 +6657,9 @@ const ecs_entity_t* ecs_bulk_new_w_data(
         return ids;
     }
     ecs_type_t type = ecs_type_find(world, components->array, components->count);
-    ecs_table_t *table = ecs_table_from_type(world, type);    
-    ids = new_w_data(world, table, NULL, count, data, NULL);
+    ecs_table_t *table = ecs_table_from_type(world, type);
+    table = ecs_table_add_cold_parts(world, table);
+    ids = new_w_data(world, table, components, count, data, NULL);
     ecs_defer_flush(world, stage);
     return ids;
 }
@@ -5638,6 +6676,7 @@ const ecs_entity_t* ecs_bulk_new_w_type(
         return ids;
     }
     ecs_table_t *table = ecs_table_from_type(world, type);
+    table = ecs_table_add_cold_parts(world, table);
     ids = new_w_data(world, table, NULL, count, NULL, NULL);
     ecs_defer_flush(world, stage);
     return ids;
@@ -5658,6 +6697,7 @@ const ecs_entity_t* ecs_bulk_new_w_entity(
         return ids;
     }
     ecs_table_t *table = ecs_table_find_or_create(world, &components);
+    table = ecs_table_add_cold_parts(world, table);
     ids = new_w_data(world, table, NULL, count, NULL, NULL);
     ecs_defer_flush(world, stage);
     return ids;
@@ -5699,6 +6739,10 @@ void ecs_delete_children(
     ecs_vector_t *child_tables = ecs_map_get_ptr(
         world->child_tables, ecs_vector_t*, parent);
 
+    /* Remove the list before deleting tables, so deleted tables don't try to
+     * unregister themselves from it while it is being iterated */
+    ecs_map_remove(world->child_tables, parent);
+
     if (child_tables) {
         ecs_table_t **tables = ecs_vector_first(child_tables, ecs_table_t*);
         int32_t i, count = ecs_vector_count(child_tables);
@@ -5720,14 +6764,21 @@ void ecs_delete_children(
             /* Clear components from table (invokes destructors, OnRemove) */
             ecs_table_clear(world, table);
 
-            /* Delete table */
-            ecs_delete_table(world, table);
+            /* Delete chunks before the table that owns their type */
+            if (table->chunk_head) {
+                ecs_delete_table(world, table);
+                tables[i] = NULL;
+            }
         };
 
+        for (i = 0; i < count; i ++) {
+            if (tables[i]) {
+                ecs_delete_table(world, tables[i]);
+            }
+        }
+
         ecs_vector_free(child_tables);
     }
-
-    ecs_map_remove(world->child_tables, parent);
 }
 
 void ecs_delete(
@@ -5759,6 +6810,10 @@ void ecs_delete(
         /* If entity has components, remove them */
         ecs_table_t *table = info.table;
         if (table) {
+            if (table->flags & EcsTableHasName) {
+                ecs_name_index_remove(world, entity);
+            }
+
             ecs_type_t type = table->type;
             ecs_entities_t to_remove = ecs_type_to_entities(type);
             delete_entity(world, table, info.data, info.row, &to_remove);
@@ -5856,17 +6911,24 @@ ecs_entity_t ecs_clone(
     ecs_type_t src_type = src_table->type;
     ecs_entities_t to_add = ecs_type_to_entities(src_type);
 
+    /* The clone may not fit in the chunk of the source entity */
+    ecs_table_t *dst_table = ecs_table_get_chunk(world, src_table, 1);
+
     ecs_entity_info_t dst_info = {0};
-    dst_info.row = new_entity(world, dst, &dst_info, src_table, &to_add);
+    dst_info.row = new_entity(world, dst, &dst_info, dst_table, &to_add);
 
     if (copy_value) {
-        ecs_table_move(world, dst, src, src_table, dst_info.data, 
-            dst_info.row, src_table, src_info.data, src_info.row);
+        ecs_table_move(world, dst, src, dst_table, dst_info.data, 
+            dst_info.row, src_table, src_info.data, src_info.row, NULL);
 
         int i;
         for (i = 0; i < to_add.count; i ++) {
             ecs_run_set_systems(world, &to_add, 
-                src_table, src_info.data, dst_info.row, 1, true);
+                dst_table, dst_info.data, dst_info.row, 1, true);
+        }
+
+        if (dst_table->flags & EcsTableHasName) {
+            ecs_name_index_move(world, dst, dst_table);
         }
     }
 
@@ -5970,6 +7032,10 @@ void* ecs_get_mut_w_entity(
 
     ecs_entity_info_t info;
     result = get_mutable(world, entity, component, &info, is_added);
+
+    if (component == ecs_typeid(EcsName)) {
+        ecs_name_index_defer(world, entity);
+    }
     
     /* Store table so we can quickly check if returned pointer is still valid */
     ecs_table_t *table = info.record->table;
@@ -6021,8 +7087,16 @@ void ecs_modified_w_entity(
     ecs_assert(ecs_has_entity(world, entity, component), 
         ECS_INVALID_PARAMETER, NULL);
 
+    if (component == ecs_typeid(EcsName)) {
+        ecs_name_index_update(world, entity);
+    }
+
     ecs_entity_info_t info = {0};
     if (ecs_get_info(world, entity, &info)) {
+        if (ecs_type_index_of(info.table->type, component) != -1) {
+            ecs_table_mark_dirty(info.table, component);
+        }
+
         ecs_entities_t added = {
             .array = &component,
             .count = 1
@@ -6102,6 +7176,10 @@ ecs_entity_t assign_ptr_w_entity(
 
     ecs_table_mark_dirty(info.table, component);
 
+    if (component == ecs_typeid(EcsName)) {
+        ecs_name_index_update(world, entity);
+    }
+
     if (notify) {
         ecs_run_set_systems(world, &added, 
             info.table, info.data, info.row, 1, false);
@@ -6577,38 +7655,13 @@ void flush_bulk_new(
                 assign_ptr_w_entity(world, ids[i], component, size, ptr, 
                     true, true);
             }
-            ecs_os_free(data);
         }
-        ecs_os_free(bulk_data);
     } else {
         int i, count = op->is._n.count;
         for (i = 0; i < count; i ++) {
             add_entities(world, ids[i], &op->components);
         }
     }
-
-    if (op->components.count > 1) {
-        ecs_os_free(op->components.array);
-    }
-
-    ecs_os_free(ids);
-}
-
-static
-void discard_op(
-    ecs_op_t * op)
-{
-    ecs_assert(op->kind != EcsOpBulkNew, ECS_INTERNAL_ERROR, NULL);
-
-    void *value = op->is._1.value;
-    if (value) {
-        ecs_os_free(value);
-    }
-
-    ecs_entity_t *components = op->components.array;
-    if (components) {
-        ecs_os_free(components);
-    }
 }
 
 static
@@ -6630,999 +7683,2175 @@ bool valid_components(
     return true;
 }
 
-/* Leave safe section. Run all deferred commands. */
-bool ecs_defer_flush(
+/* Add component to entity, and store the value so it can be copied after all
+ * structural changes of the merge have been applied. */
+static
+void defer_write(
     ecs_world_t * world,
-    ecs_stage_t * stage)
+    ecs_op_t * op,
+    bool notify)
 {
-    if (!--stage->defer) {
-        ecs_vector_t *defer_queue = stage->defer_queue;
-        stage->defer_queue = NULL;
-        if (defer_queue) {
-            ecs_op_t *ops = ecs_vector_first(defer_queue, ecs_op_t);
-            int32_t i, count = ecs_vector_count(defer_queue);
-            
-            for (i = 0; i < count; i ++) {
-                ecs_op_t *op = &ops[i];
-                ecs_entity_t e = op->is._1.entity;
-                if (op->kind == EcsOpBulkNew) {
-                    e = 0;
-                }
+    ecs_entity_t e = op->is._1.entity;
+    ecs_entity_info_t info;
+    get_mutable(world, e, op->component, &info, NULL);
+
+    ecs_deferred_write_t *w = ecs_vector_add(
+        &world->deferred_writes, ecs_deferred_write_t);
+    w->entity = e;
+    w->component = op->component;
+    w->c_info = get_c_info(world, op->component);
+    w->value = op->is._1.value;
+    w->size = op->is._1.size;
+    w->notify = notify;
+}
+
+/* Operations that read or destroy component values of an entity can't be 
+ * applied before pending values are written. */
+static
+bool reads_values(
+    ecs_op_kind_t kind)
+{
+    switch(kind) {
+    case EcsOpClone:
+    case EcsOpModified:
+    case EcsOpDelete:
+    case EcsOpClear:
+    case EcsOpRemove:
+        return true;
+    default:
+        return false;
+    }
+}
 
-                /* If entity is no longer alive, this could be because the queue
-                 * contained both a delete and a subsequent add/remove/set which
-                 * should be ignored. */
-                if (e && !ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
-                    ecs_assert(op->kind != EcsOpNew && op->kind != EcsOpClone, 
-                        ECS_INTERNAL_ERROR, NULL);
-                    world->discard_count ++;
-                    discard_op(op);
-                    continue;
-                }
+void ecs_deferred_writes_partition(
+    ecs_world_t *world,
+    int32_t partition_count)
+{
+    ecs_deferred_write_t *writes = ecs_vector_first(
+        world->deferred_writes, ecs_deferred_write_t);
+    int32_t i, count = ecs_vector_count(world->deferred_writes);
 
-                if (op->components.count == 1) {
-                    op->components.array = &op->component;
-                }
+    ecs_vector_set_count(&world->deferred_write_slices, int32_t, 
+        partition_count + 1);
+    int32_t *slices = ecs_vector_first(world->deferred_write_slices, int32_t);
+    ecs_os_memset(slices, 0, ECS_SIZEOF(int32_t) * (partition_count + 1));
 
-                switch(op->kind) {
-                case EcsOpNew:
-                    if (op->scope) {
-                        ecs_add_entity(world, e, ECS_CHILDOF | op->scope);
-                    }
-                    /* Fallthrough */
-                case EcsOpAdd:
-                    if (valid_components(world, &op->components)) {
-                        world->add_count ++;
-                        add_entities(world, e, &op->components);
-                    } else {
-                        ecs_delete(world, e);
-                    }
-                    break;
-                case EcsOpRemove:
-                    remove_entities(world, e, &op->components);
-                    break;
-                case EcsOpClone:
-                    ecs_clone(world, e, op->component, op->is._1.clone_value);
-                    break;
-                case EcsOpSet:
-                    assign_ptr_w_entity(world, e, 
-                        op->component, ecs_to_size_t(op->is._1.size), 
-                        op->is._1.value, true, true);
-                    break;
-                case EcsOpMut:
-                    assign_ptr_w_entity(world, e, 
-                        op->component, ecs_to_size_t(op->is._1.size), 
-                        op->is._1.value, true, false);
-                    break;
-                case EcsOpModified:
-                    ecs_modified_w_entity(world, e, op->component);
-                    break;
-                case EcsOpDelete: {
-                    ecs_delete(world, e);
-                    break;
-                }
-                case EcsOpEnable:
-                    ecs_enable_component_w_entity(
-                        world, e, op->component, true);
-                    break;
-                case EcsOpDisable:
-                    ecs_enable_component_w_entity(
-                        world, e, op->component, false);
-                    break;
-                case EcsOpClear:
-                    ecs_clear(world, e);
-                    break;
-                case EcsOpBulkNew:
-                    flush_bulk_new(world, op);
+    /* Count writes per partition. Entities are assigned to partitions in
+     * blocks, so that threads write to different regions of a table. */
+    for (i = 0; i < count; i ++) {
+        uint32_t e = (uint32_t)writes[i].entity;
+        slices[(e / ECS_MERGE_PARTITION_SIZE) % (uint32_t)partition_count + 1]++;
+    }
 
-                    /* Continue since flush_bulk_new is repsonsible for cleaning
-                     * up resources. */
-                    continue;
-                }
+    for (i = 0; i < partition_count; i ++) {
+        slices[i + 1] += slices[i];
+    }
 
-                if (op->components.count > 1) {
-                    ecs_os_free(op->components.array);
-                }
+    /* Order writes by partition. Writes in a partition keep the order in which
+     * they were set, so that the last value for a component is written last. */
+    ecs_vector_set_count(&world->deferred_write_order, int32_t, count);
+    int32_t *order = ecs_vector_first(world->deferred_write_order, int32_t);
+    for (i = 0; i < count; i ++) {
+        uint32_t e = (uint32_t)writes[i].entity;
+        order[slices[(e / ECS_MERGE_PARTITION_SIZE) % 
+            (uint32_t)partition_count] ++] = i;
+    }
 
-                if (op->is._1.value) {
-                    ecs_os_free(op->is._1.value);
-                }                  
-            };
+    /* Filling in the order moved each offset to the start of the next
+     * partition, so shift offsets back by one */
+    for (i = partition_count; i > 0; i --) {
+        slices[i] = slices[i - 1];
+    }
+    slices[0] = 0;
+}
 
-            if (defer_queue != stage->defer_merge_queue) {
-                ecs_vector_free(defer_queue);
+void ecs_deferred_writes_apply(
+    ecs_world_t *world,
+    int32_t partition)
+{
+    ecs_assert(partition < ecs_vector_count(world->deferred_write_slices) - 1,
+        ECS_INTERNAL_ERROR, NULL);
+
+    ecs_deferred_write_t *writes = ecs_vector_first(
+        world->deferred_writes, ecs_deferred_write_t);
+    int32_t *order = ecs_vector_first(world->deferred_write_order, int32_t);
+    int32_t *slices = ecs_vector_first(world->deferred_write_slices, int32_t);
+    int32_t i, end = slices[partition + 1];
+
+    /* Consecutive writes often go to the same column, so the column of the
+     * last write is reused if table and component are the same */
+    ecs_table_t *table = NULL;
+    ecs_entity_t component = 0;
+    ecs_column_t *column = NULL;
+
+    for (i = slices[partition]; i < end; i ++) {
+        ecs_deferred_write_t *w = &writes[order[i]];
+        ecs_entity_t e = w->entity;
+
+        /* Entity may have been deleted, or the component removed by a trigger
+         * that ran during the merge */
+        ecs_record_t *record = ecs_eis_get(world, e);
+        if (!record || !record->table) {
+            continue;
+        }
+
+        if (record->table != table || w->component != component) {
+            table = record->table;
+            component = w->component;
+            column = NULL;
+
+            int32_t index = ecs_type_index_of(table->type, component);
+            if (index != -1 && index < table->column_count) {
+                ecs_data_t *data = ecs_table_get_data(table);
+                ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
+                column = &data->columns[index];
             }
         }
 
-        return true;
-    }
+        if (!column) {
+            continue;
+        }
 
-    return false;
-}
+        bool is_watched;
+        int32_t row = ecs_record_to_row(record->row, &is_watched);
+        void *dst = ECS_OFFSET(ecs_vector_first_t(column->data, column->size, 
+            column->alignment), row * column->size);
 
-static
-ecs_op_t* new_defer_op(ecs_stage_t *stage) {
-    ecs_op_t *result = ecs_vector_add(&stage->defer_queue, ecs_op_t);
-    ecs_os_memset(result, 0, ECS_SIZEOF(ecs_op_t));
-    return result;
-}
+        void *ptr = w->value;
+        size_t size = ecs_to_size_t(w->size);
+        ecs_c_info_t *cdata = w->c_info;
 
-static 
-void new_defer_component_ids(
-    ecs_op_t *op, 
-    ecs_entities_t *components)
-{
-    int32_t components_count = components->count;
-    if (components_count == 1) {
-        ecs_entity_t component = components->array[0];
-        op->component = component;
-        op->components = (ecs_entities_t) {
-            .array = NULL,
-            .count = 1
-        };
-    } else if (components_count) {
-        ecs_size_t array_size = components_count * ECS_SIZEOF(ecs_entity_t);
-        op->components.array = ecs_os_malloc(array_size);
-        ecs_os_memcpy(op->components.array, components->array, array_size);
-        op->components.count = components_count;
-    } else {
-        op->component = 0;
-        op->components = (ecs_entities_t){ 0 };
+        if (!ptr) {
+            memset(dst, 0, size);
+        } else if (cdata && cdata->lifecycle.move) {
+            ecs_entity_t real_id = cdata->component;
+            cdata->lifecycle.move(world, real_id, &e, &e, dst, ptr, size, 1, 
+                cdata->lifecycle.ctx);
+        } else {
+            ecs_os_memcpy(dst, ptr, w->size);
+        }
     }
 }
 
-static
-bool defer_add_remove(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    ecs_op_kind_t op_kind,
-    ecs_entity_t entity,
-    ecs_entities_t *components)
+void ecs_deferred_writes_end(
+    ecs_world_t *world)
 {
-    if (stage->defer) {
-        ecs_entity_t scope = stage->scope;
-        if (components) {
-            if (!components->count && !scope) {
-                return true;
-            }
-        }
+    ecs_vector_each(world->deferred_writes, ecs_deferred_write_t, w, {
+        ecs_entity_info_t info;
+        if (ecs_get_info(world, w->entity, &info) && info.table && 
+            get_component(&info, w->component)) 
+        {
+            ecs_table_mark_dirty(info.table, w->component);
 
-        ecs_op_t *op = new_defer_op(stage);
-        op->kind = op_kind;
-        op->scope = scope;
-        op->is._1.entity = entity;
+            if (w->component == ecs_typeid(EcsName)) {
+                ecs_name_index_update(world, w->entity);
+            }
 
-        new_defer_component_ids(op, components);
+            if (w->notify) {
+                ecs_entities_t added = {
+                    .array = &w->component,
+                    .count = 1
+                };
 
-        if (op_kind == EcsOpNew) {
-            world->new_count ++;
-        } else if (op_kind == EcsOpAdd) {
-            world->add_count ++;
-        } else if (op_kind == EcsOpRemove) {
-            world->remove_count ++;
+                ecs_run_set_systems(world, &added, 
+                    info.table, info.data, info.row, 1, false);
+            }
         }
 
-        return true;
-    } else {
-        stage->defer ++;
-    }
-    
-    return false;
+    });
+
+    ecs_vector_clear(world->deferred_writes);
 }
 
-bool ecs_defer_none(
-    ecs_world_t *world,
-    ecs_stage_t *stage)
+/* Write pending values on the current thread */
+static
+void flush_deferred_writes(
+    ecs_world_t *world)
 {
-    (void)world;
-    return (++ stage->defer) == 1;
+    ecs_deferred_writes_partition(world, 1);
+    ecs_deferred_writes_apply(world, 0);
+    ecs_deferred_writes_end(world);
 }
 
-bool ecs_defer_modified(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    ecs_entity_t entity,
-    ecs_entity_t component)
+/* Operations that only change the type of, or assign a value to a single
+ * entity can be combined with other operations for the same entity, so that
+ * the entity is moved at most once. Operations that involve switches, cases or
+ * base entities have side effects that depend on the intermediate tables and
+ * are applied one by one. */
+static
+bool can_coalesce(
+    ecs_world_t * world,
+    ecs_op_t * op)
 {
-    (void)world;
-    if (stage->defer) {
-        ecs_op_t *op = new_defer_op(stage);
-        op->kind = EcsOpModified;
-        op->component = component;
-        op->is._1.entity = entity;
+    switch(op->kind) {
+    case EcsOpNew:
+    case EcsOpAdd:
+        if (!valid_components(world, &op->components)) {
+            return false;
+        }
+        /* Fallthrough */
+    case EcsOpRemove: {
+        ecs_entity_t *array = op->components.array;
+        int32_t i, count = op->components.count;
+        for (i = 0; i < count; i ++) {
+            ecs_entity_t e = array[i];
+            if (ECS_HAS_ROLE(e, CASE) || ECS_HAS_ROLE(e, SWITCH) || 
+                ECS_HAS_ROLE(e, INSTANCEOF)) 
+            {
+                return false;
+            }
+        }
         return true;
-    } else {
-        stage->defer ++;
     }
-    
-    return false;
-}
-
-bool ecs_defer_clone(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    ecs_entity_t entity,
-    ecs_entity_t src,
-    bool clone_value)
-{   
-    (void)world;
-    if (stage->defer) {
-        ecs_op_t *op = new_defer_op(stage);
-        op->kind = EcsOpClone;
-        op->component = src;
-        op->is._1.entity = entity;
-        op->is._1.clone_value = clone_value;
+    case EcsOpSet:
+    case EcsOpMut:
         return true;
-    } else {
-        stage->defer ++;
+    default:
+        return false;
     }
-    
-    return false;   
 }
 
-bool ecs_defer_delete(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
+/* Combined type changes & pending values for one entity */
+typedef struct op_batch_t {
+    ecs_entity_t entity;
+    ecs_entity_info_t info;
+    ecs_table_t *table;
+    ecs_entities_t added;
+    ecs_entities_t removed;
+    ecs_entity_t added_buffer[ECS_MAX_ADD_REMOVE];
+    ecs_entity_t removed_buffer[ECS_MAX_ADD_REMOVE];
+    ecs_op_t *values[ECS_MAX_ADD_REMOVE];
+    int32_t value_count;
+} op_batch_t;
+
+static
+void batch_init(
+    ecs_world_t * world,
+    op_batch_t * batch,
     ecs_entity_t entity)
 {
-    (void)world;
-    if (stage->defer) {
-        ecs_op_t *op = new_defer_op(stage);
-        op->kind = EcsOpDelete;
-        op->is._1.entity = entity;
-        world->delete_count ++;
-        return true;
-    } else {
-        stage->defer ++;
-    }
-    return false;
+    batch->entity = entity;
+    ecs_get_info(world, entity, &batch->info);
+    batch->table = batch->info.table;
+    batch->added = (ecs_entities_t){ .array = batch->added_buffer };
+    batch->removed = (ecs_entities_t){ .array = batch->removed_buffer };
+    batch->value_count = 0;
 }
 
-bool ecs_defer_clear(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    ecs_entity_t entity)
+static
+bool entities_has(
+    ecs_entities_t * entities,
+    ecs_entity_t e)
 {
-    (void)world;
-    if (stage->defer) {
-        ecs_op_t *op = new_defer_op(stage);
-        op->kind = EcsOpClear;
-        op->is._1.entity = entity;
-        world->clear_count ++;
-        return true;
-    } else {
-        stage->defer ++;
+    int32_t i, count = entities->count;
+    for (i = 0; i < count; i ++) {
+        if (entities->array[i] == e) {
+            return true;
+        }
     }
     return false;
 }
 
-bool ecs_defer_enable(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    ecs_entity_t entity,
-    ecs_entity_t component,
-    bool enable)
+static
+bool batch_has_value(
+    op_batch_t * batch,
+    ecs_entity_t component)
 {
-    (void)world;
-    if (stage->defer) {
-        ecs_op_t *op = new_defer_op(stage);
-        op->kind = enable ? EcsOpEnable : EcsOpDisable;
-        op->is._1.entity = entity;
-        op->component = component;
-        return true;
-    } else {
-        stage->defer ++;
+    int32_t i, count = batch->value_count;
+    for (i = 0; i < count; i ++) {
+        if (batch->values[i]->component == component) {
+            return true;
+        }
     }
     return false;
 }
 
-bool ecs_defer_bulk_new(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    int32_t count,
-    ecs_entities_t *components_ids,
-    void **component_data,
-    const ecs_entity_t **ids_out)
+/* Get the number of ids an add or remove of the components can add to the
+ * batch. Components with a cold part are added and removed together with their
+ * cold part, which takes an extra slot. */
+static
+int32_t batch_slots(
+    ecs_world_t * world,
+    ecs_entities_t * components)
 {
-    if (stage->defer) {
-        ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
-        void **defer_data = NULL;
-
-        world->bulk_new_count ++;
+    int32_t i, count = components->count, result = count;
+    if (!world->cold_part_count) {
+        return result;
+    }
 
-        /* Use ecs_new_id as this is thread safe */
-        int i;
-        for (i = 0; i < count; i ++) {
-            ids[i] = ecs_new_id(world);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = components->array[i];
+        if (e & ECS_ROLE_MASK) {
+            continue;
         }
 
-        /* Create private copy for component data */
-        if (component_data) {
-            int c, c_count = components_ids->count;
-            ecs_entity_t *components = components_ids->array;
-            defer_data = ecs_os_malloc(ECS_SIZEOF(void*) * c_count);
-            for (c = 0; c < c_count; c ++) {
-                ecs_entity_t comp = components[c];
-                const EcsComponent *cptr = ecs_component_from_id(world, comp);
-                ecs_assert(cptr != NULL, ECS_INVALID_PARAMETER, NULL);
-
-                ecs_size_t size = cptr->size;
-                void *data = ecs_os_malloc(size * count);
-                defer_data[c] = data;
-
-                ecs_c_info_t *cinfo = NULL;
-                ecs_entity_t real_id = ecs_get_typeid(world, comp);
-                if (real_id) {
-                    cinfo = ecs_get_c_info(world, real_id);
-                }
-                ecs_xtor_t ctor;
-                if (cinfo && (ctor = cinfo->lifecycle.ctor)) {
-                    void *ctx = cinfo->lifecycle.ctx;
-                    ctor(world, comp, ids, data, ecs_to_size_t(size), count, ctx);
-                    ecs_move_t move;
-                    if ((move = cinfo->lifecycle.move)) {
-                        move(world, comp, ids, ids, data, component_data[c], 
-                            ecs_to_size_t(size), count, ctx);
-                    } else {
-                        ecs_os_memcpy(data, component_data[c], size * count);
-                    }
-                } else {
-                    ecs_os_memcpy(data, component_data[c], size * count);
-                }
-            }
+        ecs_c_info_t *c_info = ecs_get_c_info(world, e);
+        if (c_info && c_info->cold) {
+            result ++;
         }
-
-        /* Store data in op */
-        ecs_op_t *op = new_defer_op(stage);
-        op->kind = EcsOpBulkNew;
-        op->is._n.entities = ids;
-        op->is._n.bulk_data = defer_data;
-        op->is._n.count = count;
-        new_defer_component_ids(op, components_ids);
-        *ids_out = ids;
-
-        return true;
-    } else {
-        stage->defer ++;
     }
 
-    return false;
+    return result;
 }
 
-bool ecs_defer_new(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    ecs_entity_t entity,
-    ecs_entities_t *components)
-{   
-    return defer_add_remove(world, stage, EcsOpNew, entity, components);
-}
+/* Values of the batch are assigned after it is committed. When the batch holds
+ * values, it is committed before an operation that runs OnAdd, OnRemove, UnSet
+ * or monitor actions, so that those actions see the values that were set
+ * earlier in the same deferred block. */
+static
+bool batch_hides_values(
+    op_batch_t * batch,
+    ecs_table_t * table)
+{
+    if (!batch->value_count || table == batch->table) {
+        return false;
+    }
 
-bool ecs_defer_add(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    ecs_entity_t entity,
-    ecs_entities_t *components)
-{   
-    return defer_add_remove(world, stage, EcsOpAdd, entity, components);
-}
+    ecs_flags32_t flags = table ? table->flags : 0;
+    if (batch->table) {
+        flags |= batch->table->flags;
+    }
 
-bool ecs_defer_remove(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    ecs_entity_t entity,
-    ecs_entities_t *components)
-{
-    return defer_add_remove(world, stage, EcsOpRemove, entity, components);
+    return (flags & (EcsTableHasOnAdd | EcsTableHasOnRemove | 
+        EcsTableHasUnSet | EcsTableHasMonitors)) != 0;
 }
 
-bool ecs_defer_set(
-    ecs_world_t *world,
-    ecs_stage_t *stage,
-    ecs_op_kind_t op_kind,
-    ecs_entity_t entity,
-    ecs_entity_t component,
-    ecs_size_t size,
-    const void *value,
-    void **value_out,
-    bool *is_added)
+/* Add operation to batch. Returns false if the operation undoes part of the
+ * batch (like removing a component that was added), in which case the batch
+ * must be committed before the operation can be added. */
+static
+bool batch_add_op(
+    ecs_world_t * world,
+    op_batch_t * batch,
+    ecs_op_t * op)
 {
-    if (stage->defer) {
-        world->set_count ++;
-        if (!size) {
-            const EcsComponent *cptr = ecs_component_from_id(world, component);
-            ecs_assert(cptr != NULL, ECS_INVALID_PARAMETER, NULL);
-            size = cptr->size;
-        }
-
-        ecs_op_t *op = new_defer_op(stage);
-        op->kind = op_kind;
-        op->component = component;
-        op->is._1.entity = entity;
-        op->is._1.size = size;
-        op->is._1.value = ecs_os_malloc(size);
+    ecs_entities_t components = op->components;
+    ecs_entity_t scope_array[ECS_MAX_ADD_REMOVE];
+    int32_t i;
 
-        if (!value) {
-            value = ecs_get_w_entity(world, entity, component);
-            if (is_added) {
-                *is_added = value == NULL;
+    switch(op->kind) {
+    case EcsOpNew:
+        if (op->scope) {
+            ecs_assert(components.count < ECS_MAX_ADD_REMOVE - 1, 
+                ECS_INVALID_PARAMETER, NULL);
+            scope_array[0] = ECS_CHILDOF | op->scope;
+            for (i = 0; i < components.count; i ++) {
+                scope_array[i + 1] = components.array[i];
             }
+            components.array = scope_array;
+            components.count ++;
         }
-
-        ecs_c_info_t *c_info = NULL;
-        ecs_entity_t real_id = ecs_get_typeid(world, component);
-        if (real_id) {
-            c_info = ecs_get_c_info(world, real_id);
+        /* Fallthrough */
+    case EcsOpAdd:
+        if (batch->added.count + batch_slots(world, &components) >= 
+            ECS_MAX_ADD_REMOVE) 
+        {
+            return false;
         }
-        ecs_xtor_t ctor;
-        if (c_info && (ctor = c_info->lifecycle.ctor)) {
-            ctor(world, component, &entity, op->is._1.value, 
-                ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
-
-            ecs_copy_t copy;
-            if (value) {
-                if ((copy = c_info->lifecycle.copy)) {
-                    copy(world, component, &entity, &entity, op->is._1.value, value, 
-                        ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
-                } else {
-                    ecs_os_memcpy(op->is._1.value, value, size);
-                }
+        for (i = 0; i < components.count; i ++) {
+            if (entities_has(&batch->removed, components.array[i])) {
+                return false;
             }
-        } else if (value) {
-            ecs_os_memcpy(op->is._1.value, value, size);
         }
-        
-        if (value_out) {
-            *value_out = op->is._1.value;
+        if (batch_hides_values(batch, ecs_table_traverse_add(
+            world, batch->table, &components, NULL))) 
+        {
+            return false;
+        }
+        batch->table = ecs_table_traverse_add(
+            world, batch->table, &components, &batch->added);
+        break;
+    case EcsOpRemove:
+        if (batch->removed.count + batch_slots(world, &components) >= 
+            ECS_MAX_ADD_REMOVE) 
+        {
+            return false;
+        }
+        for (i = 0; i < components.count; i ++) {
+            ecs_entity_t e = components.array[i];
+            if (entities_has(&batch->added, e) || batch_has_value(batch, e)) {
+                return false;
+            }
+        }
+        if (batch_hides_values(batch, ecs_table_traverse_remove(
+            world, batch->table, &components, NULL))) 
+        {
+            return false;
+        }
+        batch->table = ecs_table_traverse_remove(
+            world, batch->table, &components, &batch->removed);
+        break;
+    case EcsOpSet:
+    case EcsOpMut:
+        components.array = &op->component;
+        components.count = 1;
+        if (batch->added.count + batch_slots(world, &components) >= 
+            ECS_MAX_ADD_REMOVE ||
+            batch->value_count == ECS_MAX_ADD_REMOVE ||
+            entities_has(&batch->removed, op->component) ||
+            batch_hides_values(batch, ecs_table_traverse_add(
+                world, batch->table, &components, NULL))) 
+        {
+            return false;
         }
+        batch->table = ecs_table_traverse_add(
+            world, batch->table, &components, &batch->added);
+        batch->values[batch->value_count ++] = op;
+        break;
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
 
-        return true;
+    return true;
+}
+
+static
+void assign_op_value(
+    ecs_world_t * world,
+    ecs_op_t * op,
+    bool defer_writes)
+{
+    bool notify = op->kind == EcsOpSet;
+    if (defer_writes) {
+        defer_write(world, op, notify);
     } else {
-        stage->defer ++;
+        assign_ptr_w_entity(world, op->is._1.entity, op->component, 
+            ecs_to_size_t(op->is._1.size), op->is._1.value, true, notify);
     }
-    
-    return false;
 }
 
-void ecs_stage_merge(
-    ecs_world_t *world,
-    ecs_stage_t *stage)
+/* Move entity to the final table of the batch, then assign pending values */
+static
+void batch_commit(
+    ecs_world_t * world,
+    op_batch_t * batch,
+    bool defer_writes)
 {
-    ecs_assert(stage != &world->stage, ECS_INTERNAL_ERROR, NULL);
-
-    ecs_assert(stage->defer == 0, ECS_INVALID_PARAMETER, NULL);
-    if (ecs_vector_count(stage->defer_merge_queue)) {
-        stage->defer ++;
-        stage->defer_queue = stage->defer_merge_queue;
-        ecs_defer_flush(world, stage);
-        ecs_vector_clear(stage->defer_merge_queue);
-        ecs_assert(stage->defer_queue == NULL, ECS_INVALID_PARAMETER, NULL);
-    }    
-}
+    ecs_entity_t e = batch->entity;
 
-bool ecs_stage_defer_begin(
-    ecs_world_t *world,
-    ecs_stage_t *stage)
-{   
-    (void)world; 
-    if (ecs_defer_none(world, stage)) {
-        stage->defer_queue = stage->defer_merge_queue;    
-        return true;  
+    if (defer_writes && batch->removed.count && 
+        ecs_vector_count(world->deferred_writes)) 
+    {
+        flush_deferred_writes(world);
+        ecs_get_info(world, e, &batch->info);
     }
-    return false;
-}
 
-bool ecs_stage_defer_end(
-    ecs_world_t *world,
-    ecs_stage_t *stage)
-{ 
-    (void)world;
-    stage->defer --;
-    if (!stage->defer) {
-        stage->defer_merge_queue = stage->defer_queue;
-        stage->defer_queue = NULL;
-        return true;
+    ecs_stage_t *stage = ecs_get_stage(&world);
+    ecs_defer_none(world, stage);
+    commit(world, e, &batch->info, batch->table, 
+        batch->added.count ? &batch->added : NULL, 
+        batch->removed.count ? &batch->removed : NULL);
+    ecs_defer_flush(world, stage);
+
+    int32_t i, count = batch->value_count;
+    for (i = 0; i < count; i ++) {
+        assign_op_value(world, batch->values[i], defer_writes);
     }
-    return false;
 }
 
-void ecs_stage_merge_post_frame(
-    ecs_world_t *world,
-    ecs_stage_t *stage)
+static
+int compare_row(
+    const void *ptr1,
+    const void *ptr2)
 {
-    /* Execute post frame actions */
-    ecs_vector_each(stage->post_frame_actions, ecs_action_elem_t, action, {
-        action->action(world, action->ctx);
-    });
-
-    ecs_vector_free(stage->post_frame_actions);
-    stage->post_frame_actions = NULL;
+    return *(const int32_t*)ptr1 - *(const int32_t*)ptr2;
 }
 
-void ecs_stage_init(
-    ecs_world_t *world,
-    ecs_stage_t *stage)
+/* Move entities that have the same source and destination table in one step.
+ * Hooks are invoked in the same order as when moving a single entity. */
+static
+void move_entities(
+    ecs_world_t * world,
+    ecs_table_t * src_table,
+    ecs_table_t * dst_table,
+    const ecs_entity_t * entities,
+    int32_t count,
+    ecs_entities_t * added,
+    ecs_entities_t * removed)
 {
-    memset(stage, 0, sizeof(ecs_stage_t));
-    if (stage == &world->stage) {
-        stage->id = 0;
-    } else if (stage == &world->temp_stage) {
-        stage->id = 1;
+    ecs_data_t *src_data = ecs_table_get_data(src_table);
+    ecs_data_t *dst_data = ecs_table_get_or_create_data(dst_table);
+    ecs_assert(src_data != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t *rows = ecs_os_malloc(ECS_SIZEOF(int32_t) * count);
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        bool is_watched;
+        ecs_record_t *record = ecs_eis_get(world, entities[i]);
+        ecs_assert(record != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(record->table == src_table, ECS_INTERNAL_ERROR, NULL);
+        rows[i] = ecs_record_to_row(record->row, &is_watched);
     }
-}
 
-void ecs_stage_deinit(
-    ecs_world_t *world,
-    ecs_stage_t *stage)
-{
-    (void)world;
-    ecs_vector_free(stage->defer_queue);
-    ecs_vector_free(stage->defer_merge_queue);
-}
+    qsort(rows, ecs_to_size_t(count), sizeof(int32_t), compare_row);
 
+    if (removed && (src_table->flags & EcsTableHasRemoveActions)) {
+        for (i = 0; i < count; i ++) {
+            ecs_run_monitors(world, dst_table, src_table->un_set_all, 
+                rows[i], 1, dst_table->un_set_all);
 
-/** Resize the vector buffer */
-static
-ecs_vector_t* resize(
-    ecs_vector_t *vector,
-    int16_t offset,
-    int32_t size)
-{
-    ecs_vector_t *result = ecs_os_realloc(vector, offset + size);
-    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
-    return result;
-}
+            ecs_run_remove_actions(
+                world, src_table, src_data, rows[i], 1, removed, false);
+        }
+    }
 
-/* -- Public functions -- */
+    int32_t dst_row = ecs_table_move_rows(
+        world, dst_table, dst_data, src_table, src_data, rows, count);
 
-ecs_vector_t* _ecs_vector_new(
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count)
-{
-    ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
-    
-    ecs_vector_t *result =
-        ecs_os_malloc(offset + elem_size * elem_count);
-    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+    ecs_os_free(rows);
 
-    result->count = 0;
-    result->size = elem_count;
-#ifndef NDEBUG
-    result->elem_size = elem_size;
-#endif
-    return result;
-}
+    ecs_entity_t *dst_entities = ecs_vector_first(
+        dst_data->entities, ecs_entity_t);
 
-ecs_vector_t* _ecs_vector_from_array(
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count,
-    void *array)
-{
-    ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
-    
-    ecs_vector_t *result =
-        ecs_os_malloc(offset + elem_size * elem_count);
-    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+    for (i = 0; i < count; i ++) {
+        bool is_watched;
+        ecs_entity_t e = dst_entities[dst_row + i];
+        ecs_record_t *record = ecs_eis_get(world, e);
+        ecs_record_to_row(record->row, &is_watched);
+        record->table = dst_table;
+        record->row = ecs_row_to_record(dst_row + i, is_watched);
 
-    ecs_os_memcpy(ECS_OFFSET(result, offset), array, elem_size * elem_count);
+        if (is_watched) {
+            update_component_monitors(world, e, added, removed);
+        }
 
-    result->count = elem_count;
-    result->size = elem_count;
-#ifndef NDEBUG
-    result->elem_size = elem_size;
-#endif
-    return result;   
+        if ((src_table->flags | dst_table->flags) & EcsTableHasName) {
+            ecs_name_index_move(world, e, dst_table);
+        }
+    }
+
+    if (added && (dst_table->flags & EcsTableHasAddActions)) {
+        ecs_run_add_actions(
+            world, dst_table, dst_data, dst_row, count, added, false, true);
+    }
+
+    if (dst_table->flags & EcsTableHasMonitors) {
+        ecs_run_monitors(world, dst_table, dst_table->monitors, dst_row, 
+            count, src_table->monitors);
+    }
+
+    if (removed && dst_table->flags & EcsTableHasBase) {
+        ecs_run_monitors(world, dst_table, src_table->on_set_override, 
+            dst_row, count, dst_table->on_set_override);          
+    }
 }
 
-void ecs_vector_free(
-    ecs_vector_t *vector)
+static
+bool can_move_rows(
+    ecs_table_t * table)
 {
-    ecs_os_free(vector);
+    return table && table->type && 
+        !table->sw_column_count && !table->bs_column_count;
 }
 
-void ecs_vector_clear(
-    ecs_vector_t *vector)
+/* Apply a single deferred operation */
+static
+void flush_op(
+    ecs_world_t * world,
+    ecs_op_t * op,
+    ecs_entity_t e,
+    bool defer_writes)
 {
-    if (vector) {
-        vector->count = 0;
+    if (defer_writes && reads_values(op->kind) && 
+        ecs_vector_count(world->deferred_writes)) 
+    {
+        flush_deferred_writes(world);
     }
-}
 
-void _ecs_vector_zero(
-    ecs_vector_t *vector,
-    ecs_size_t elem_size,
-    int16_t offset)
-{
-    void *array = ECS_OFFSET(vector, offset);
-    ecs_os_memset(array, 0, elem_size * vector->count);
+    switch(op->kind) {
+    case EcsOpNew:
+        if (op->scope) {
+            ecs_add_entity(world, e, ECS_CHILDOF | op->scope);
+        }
+        /* Fallthrough */
+    case EcsOpAdd:
+        if (valid_components(world, &op->components)) {
+            world->add_count ++;
+            add_entities(world, e, &op->components);
+        } else {
+            ecs_delete(world, e);
+        }
+        break;
+    case EcsOpRemove:
+        remove_entities(world, e, &op->components);
+        break;
+    case EcsOpClone:
+        ecs_clone(world, e, op->component, op->is._1.clone_value);
+        break;
+    case EcsOpSet:
+        if (defer_writes) {
+            defer_write(world, op, true);
+            break;
+        }
+        assign_ptr_w_entity(world, e, 
+            op->component, ecs_to_size_t(op->is._1.size), 
+            op->is._1.value, true, true);
+        break;
+    case EcsOpMut:
+        if (defer_writes) {
+            defer_write(world, op, false);
+            break;
+        }
+        assign_ptr_w_entity(world, e, 
+            op->component, ecs_to_size_t(op->is._1.size), 
+            op->is._1.value, true, false);
+        break;
+    case EcsOpModified:
+        ecs_modified_w_entity(world, e, op->component);
+        break;
+    case EcsOpDelete: {
+        ecs_delete(world, e);
+        break;
+    }
+    case EcsOpEnable:
+        ecs_enable_component_w_entity(
+            world, e, op->component, true);
+        break;
+    case EcsOpDisable:
+        ecs_enable_component_w_entity(
+            world, e, op->component, false);
+        break;
+    case EcsOpClear:
+        ecs_clear(world, e);
+        break;
+    case EcsOpBulkNew:
+        flush_bulk_new(world, op);
+        break;
+    }
 }
 
-void ecs_vector_assert_size(
-    ecs_vector_t *vector,
-    ecs_size_t elem_size)
+static
+void flush_part(
+    ecs_world_t * world,
+    ecs_entity_t e,
+    ecs_op_kind_t kind,
+    ecs_entities_t * part)
 {
-    (void)elem_size;
-    
-    if (vector) {
-        ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    if (!part->count) {
+        return;
+    }
+
+    if (kind == EcsOpRemove) {
+        remove_entities(world, e, part);
+    } else {
+        add_entities(world, e, part);
     }
 }
 
-void* _ecs_vector_addn(
-    ecs_vector_t **array_inout,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count)
+/* Apply an operation that has more ids than fit in a batch. Ids are added or
+ * removed in parts, so that the ids and the cold parts that come with them
+ * don't exceed the maximum number of ids of a single table move. */
+static
+void flush_large_op(
+    ecs_world_t * world,
+    ecs_op_t * op,
+    ecs_entity_t e,
+    bool defer_writes)
 {
-    ecs_assert(array_inout != NULL, ECS_INTERNAL_ERROR, NULL);
-    
-    if (elem_count == 1) {
-        return _ecs_vector_add(array_inout, elem_size, offset);
+    ecs_op_kind_t kind = op->kind;
+    ecs_entities_t *components = &op->components;
+    if ((kind != EcsOpNew && kind != EcsOpAdd && kind != EcsOpRemove) ||
+        (kind != EcsOpRemove && !valid_components(world, components))) 
+    {
+        flush_op(world, op, e, defer_writes);
+        return;
     }
-    
-    ecs_vector_t *vector = *array_inout;
-    if (!vector) {
-        vector = _ecs_vector_new(elem_size, offset, 1);
-        *array_inout = vector;
+
+    if (defer_writes && reads_values(kind) && 
+        ecs_vector_count(world->deferred_writes)) 
+    {
+        flush_deferred_writes(world);
     }
 
-    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    if (kind == EcsOpNew && op->scope) {
+        ecs_add_entity(world, e, ECS_CHILDOF | op->scope);
+    }
 
-    int32_t max_count = vector->size;
-    int32_t old_count = vector->count;
-    int32_t new_count = old_count + elem_count;
+    if (kind != EcsOpRemove) {
+        world->add_count ++;
+    }
 
-    if ((new_count - 1) >= max_count) {
-        if (!max_count) {
-            max_count = elem_count;
-        } else {
-            while (max_count < new_count) {
-                max_count *= 2;
-            }
+    ecs_entities_t part = { .array = components->array, .count = 0 };
+    int32_t i, slots = 0, count = components->count;
+    for (i = 0; i < count; i ++) {
+        ecs_entities_t id = { .array = &components->array[i], .count = 1 };
+        int32_t id_slots = batch_slots(world, &id);
+        if (slots + id_slots >= ECS_MAX_ADD_REMOVE) {
+            flush_part(world, e, kind, &part);
+            part.array = id.array;
+            part.count = 0;
+            slots = 0;
         }
 
-        vector = resize(vector, offset, max_count * elem_size);
-        vector->size = max_count;
-        *array_inout = vector;
+        part.count ++;
+        slots += id_slots;
     }
 
-    vector->count = new_count;
-
-    return ECS_OFFSET(vector, offset + elem_size * old_count);
+    flush_part(world, e, kind, &part);
 }
 
-void* _ecs_vector_add(
-    ecs_vector_t **array_inout,
-    ecs_size_t elem_size,
-    int16_t offset)
-{
-    ecs_vector_t *vector = *array_inout;
-    int32_t count, size;
+/* Apply all operations for an entity, committing whenever an operation undoes
+ * part of the changes collected so far. */
+static
+void flush_entity_ops(
+    ecs_world_t * world,
+    ecs_op_t * ops,
+    const int32_t * next,
+    int32_t head,
+    bool defer_writes)
+{
+    ecs_entity_t e = ops[head].is._1.entity;
+    op_batch_t batch;
+    batch_init(world, &batch, e);
+
+    int32_t cur;
+    for (cur = head; cur != -1; cur = next[cur]) {
+        ecs_op_t *op = &ops[cur];
+
+        /* Entity could have been deleted by a trigger */
+        if (!ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
+            world->discard_count ++;
+            continue;
+        }
 
-    if (vector) {
-        ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-        count = vector->count;
-        size = vector->size;
+        if (!batch_add_op(world, &batch, op)) {
+            batch_commit(world, &batch, defer_writes);
+            batch_init(world, &batch, e);
 
-        if (count >= size) {
-            size *= 2;
-            if (!size) {
-                size = 2;
+            /* Operations that don't fit in an empty batch, like an add with
+             * more ids than the batch has slots, are applied by themselves */
+            if (!batch_add_op(world, &batch, op)) {
+                flush_large_op(world, op, e, defer_writes);
+                batch_init(world, &batch, e);
             }
-            vector = resize(vector, offset, size * elem_size);
-            *array_inout = vector;
-            vector->size = size;
         }
-
-        vector->count = count + 1;
-        return ECS_OFFSET(vector, offset + elem_size * count);
     }
 
-    vector = _ecs_vector_new(elem_size, offset, 2);
-    *array_inout = vector;
-    vector->count = 1;
-    vector->size = 2;
-    return ECS_OFFSET(vector, offset);
-}
-
-int32_t _ecs_vector_move_index(
-    ecs_vector_t **dst,
-    ecs_vector_t *src,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t index)
-{
-    ecs_assert((*dst)->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(src->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-
-    void *dst_elem = _ecs_vector_add(dst, elem_size, offset);
-    void *src_elem = _ecs_vector_get(src, elem_size, offset, index);
-
-    ecs_os_memcpy(dst_elem, src_elem, elem_size);
-    return _ecs_vector_remove_index(src, elem_size, offset, index);
+    if (ecs_is_alive(world, e) || !ecs_eis_exists(world, e)) {
+        batch_commit(world, &batch, defer_writes);
+    }
 }
 
-void ecs_vector_remove_last(
-    ecs_vector_t *vector)
-{
-    if (vector && vector->count) vector->count --;
-}
+/* Entities that move between the same tables in a flush */
+typedef struct move_group_t {
+    ecs_table_t *src;
+    ecs_table_t *dst;
+    int32_t first;          /* First operation of first entity in group */
+    int32_t last;           /* First operation of last entity in group */
+    int32_t count;
+} move_group_t;
 
-bool _ecs_vector_pop(
-    ecs_vector_t *vector,
-    ecs_size_t elem_size,
-    int16_t offset,
-    void *value)
+/* Find final table for entity. Returns false if the operations for the entity
+ * cannot be applied with a single move of rows between tables. */
+static
+bool find_move(
+    ecs_world_t * world,
+    ecs_op_t * ops,
+    const int32_t * next,
+    int32_t head,
+    op_batch_t * batch)
 {
-    if (!vector) {
+    ecs_entity_t e = ops[head].is._1.entity;
+    if (!ecs_is_alive(world, e)) {
         return false;
     }
 
-    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-
-    int32_t count = vector->count;
-    if (!count) {
+    batch_init(world, batch, e);
+    if (!can_move_rows(batch->info.table) || !batch->info.data) {
         return false;
     }
 
-    void *elem = ECS_OFFSET(vector, offset + (count - 1) * elem_size);
-
-    if (value) {
-        ecs_os_memcpy(value, elem, elem_size);
+    int32_t cur;
+    for (cur = head; cur != -1; cur = next[cur]) {
+        if (!batch_add_op(world, batch, &ops[cur])) {
+            return false;
+        }
     }
 
-    ecs_vector_remove_last(vector);
-
-    return true;
+    ecs_table_t *src = batch->info.table;
+    return batch->table != src && batch->table != src->chunk_head && 
+        can_move_rows(batch->table);
 }
 
-int32_t _ecs_vector_remove_index(
-    ecs_vector_t *vector,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t index)
-{
-    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-    
-    int32_t count = vector->count;
-    void *buffer = ECS_OFFSET(vector, offset);
-    void *elem = ECS_OFFSET(buffer, index * elem_size);
-
-    ecs_assert(index < count, ECS_INVALID_PARAMETER, NULL);
-
-    count --;
-    if (index != count) {
-        void *last_elem = ECS_OFFSET(buffer, elem_size * count);
-        ecs_os_memcpy(elem, last_elem, elem_size);
+static
+void flush_move_group(
+    ecs_world_t * world,
+    ecs_op_t * ops,
+    const int32_t * next,
+    const int32_t * next_in_group,
+    move_group_t * group,
+    bool defer_writes)
+{
+    ecs_entity_t *entities = ecs_os_malloc(
+        ECS_SIZEOF(ecs_entity_t) * group->count);
+    int32_t head, count = 0;
+
+    /* Triggers that ran for a previous group may have changed entities in this
+     * group. Those are applied one by one. */
+    for (head = group->first; head != -1; head = next_in_group[head]) {
+        ecs_entity_t e = ops[head].is._1.entity;
+        ecs_record_t *record = ecs_eis_get(world, e);
+        if (ecs_is_alive(world, e) && record && record->table == group->src) {
+            entities[count ++] = e;
+        } else {
+            flush_entity_ops(world, ops, next, head, defer_writes);
+        }
     }
 
-    vector->count = count;
+    if (count) {
+        /* Entities in a group have the same source and destination table, 
+         * so the components that are added and removed are the same */
+        op_batch_t batch;
+        head = group->first;
+        while (ops[head].is._1.entity != entities[0]) {
+            head = next_in_group[head];
+        }
 
-    return count;
-}
+        bool found = find_move(world, ops, next, head, &batch);
+        ecs_assert(found && batch.table == group->dst, 
+            ECS_INTERNAL_ERROR, NULL);
+        (void)found;
 
-void _ecs_vector_reclaim(
-    ecs_vector_t **array_inout,
-    ecs_size_t elem_size,
-    int16_t offset)
-{
-    ecs_vector_t *vector = *array_inout;
+        ecs_stage_t *stage = ecs_get_stage(&world);
+        ecs_defer_none(world, stage);
+        ecs_table_t *dst = ecs_table_get_chunk(world, group->dst, count);
+        move_entities(world, group->src, dst, entities, count, 
+            batch.added.count ? &batch.added : NULL, 
+            batch.removed.count ? &batch.removed : NULL);
+        ecs_defer_flush(world, stage);
 
-    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-    
-    int32_t size = vector->size;
-    int32_t count = vector->count;
+        int32_t i = 0;
+        for (head = group->first; head != -1; head = next_in_group[head]) {
+            if (i == count || ops[head].is._1.entity != entities[i]) {
+                continue;
+            }
 
-    if (count < size) {
-        size = count;
-        vector = resize(vector, offset, size * elem_size);
-        vector->size = size;
-        *array_inout = vector;
-    }
-}
+            i ++;
 
-int32_t ecs_vector_count(
-    const ecs_vector_t *vector)
-{
-    if (!vector) {
-        return 0;
+            int32_t cur;
+            for (cur = head; cur != -1; cur = next[cur]) {
+                ecs_op_kind_t kind = ops[cur].kind;
+                if (kind == EcsOpSet || kind == EcsOpMut) {
+                    assign_op_value(world, &ops[cur], defer_writes);
+                }
+            }
+        }
     }
-    return vector->count;
+
+    ecs_os_free(entities);
 }
 
-int32_t ecs_vector_size(
-    const ecs_vector_t *vector)
+/* Apply a sequence of operations that can be coalesced. Operations are grouped
+ * by entity, so that each entity moves to its final table in one step. The
+ * order of operations for the same entity is preserved, the order across
+ * entities is not. Entities that move between the same tables are moved 
+ * together, which replaces row by row moves with a copy per column. */
+static
+void flush_coalesced(
+    ecs_world_t * world,
+    ecs_op_t * ops,
+    int32_t count,
+    bool defer_writes)
 {
-    if (!vector) {
-        return 0;
+    ecs_map_t *last = ecs_map_new(int32_t, count);
+    int32_t *next = ecs_os_malloc(ECS_SIZEOF(int32_t) * count * 3);
+    int32_t *prev = &next[count];
+    int32_t *group_of = &next[count * 2];
+    int32_t i;
+
+    /* Link each operation to the next operation for the same entity. Indices
+     * in the map are stored offset by one, as 0 means not found. */
+    for (i = 0; i < count; i ++) {
+        ecs_op_kind_t kind = ops[i].kind;
+        if (kind == EcsOpNew || kind == EcsOpAdd) {
+            world->add_count ++;
+        }
+
+        int32_t *last_op = ecs_map_ensure(last, int32_t, ops[i].is._1.entity);
+        prev[i] = last_op[0] - 1;
+        next[i] = -1;
+        group_of[i] = -1;
+        if (prev[i] != -1) {
+            next[prev[i]] = i;
+            group_of[i] = -2; /* Not the first operation for entity */
+        }
+        last_op[0] = i + 1;
     }
-    return vector->size;
-}
 
-int32_t _ecs_vector_set_size(
-    ecs_vector_t **array_inout,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count)
-{
-    ecs_vector_t *vector = *array_inout;
+    /* Group entities by source and destination table. The next_in_group array
+     * reuses the prev array, which is no longer needed. */
+    ecs_map_t *group_index = ecs_map_new(int32_t, 0);
+    ecs_vector_t *groups = NULL;
+    int32_t *next_in_group = prev;
+    op_batch_t batch;
 
-    if (!vector) {
-        *array_inout = _ecs_vector_new(elem_size, offset, elem_count);
-        return elem_count;
-    } else {
-        ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    for (i = 0; i < count; i ++) {
+        if (group_of[i] == -2) {
+            continue;
+        }
 
-        int32_t result = vector->size;
+        next_in_group[i] = -1;
 
-        if (elem_count < vector->count) {
-            elem_count = vector->count;
+        if (!find_move(world, ops, next, i, &batch)) {
+            continue;
         }
 
-        if (result < elem_count) {
-            elem_count = ecs_next_pow_of_2(elem_count);
-            vector = resize(vector, offset, elem_count * elem_size);
-            vector->size = elem_count;
-            *array_inout = vector;
-            result = elem_count;
+        ecs_map_key_t key = ((ecs_map_key_t)batch.info.table->id << 32) | 
+            batch.table->id;
+        int32_t *group_id = ecs_map_ensure(group_index, int32_t, key);
+        move_group_t *group;
+        if (!group_id[0]) {
+            group = ecs_vector_add(&groups, move_group_t);
+            group->src = batch.info.table;
+            group->dst = batch.table;
+            group->first = i;
+            group->count = 0;
+            group_id[0] = ecs_vector_count(groups);
+        } else {
+            group = ecs_vector_get(groups, move_group_t, group_id[0] - 1);
+            next_in_group[group->last] = i;
         }
 
-        return result;
+        group->last = i;
+        group->count ++;
+        group_of[i] = group_id[0] - 1;
     }
-}
 
-int32_t _ecs_vector_grow(
-    ecs_vector_t **array_inout,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count)
-{
-    int32_t current = ecs_vector_count(*array_inout);
-    return _ecs_vector_set_size(array_inout, elem_size, offset, current + elem_count);
-}
+    for (i = 0; i < count; i ++) {
+        int32_t group_id = group_of[i];
+        if (group_id == -2) {
+            continue;
+        }
 
-int32_t _ecs_vector_set_count(
-    ecs_vector_t **array_inout,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count)
-{
-    if (!*array_inout) {
-        *array_inout = _ecs_vector_new(elem_size, offset, elem_count);
-    }
+        if (group_id != -1) {
+            move_group_t *group = ecs_vector_get(
+                groups, move_group_t, group_id);
+            if (group->count > 1) {
+                if (group->first == i) {
+                    flush_move_group(
+                        world, ops, next, next_in_group, group, defer_writes);
+                }
+                continue;
+            }
+        }
 
-    ecs_assert((*array_inout)->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+        flush_entity_ops(world, ops, next, i, defer_writes);
+    }
 
-    (*array_inout)->count = elem_count;
-    ecs_size_t size = _ecs_vector_set_size(array_inout, elem_size, offset, elem_count);
-    return size;
+    ecs_os_free(next);
+    ecs_map_free(group_index);
+    ecs_vector_free(groups);
+    ecs_map_free(last);
 }
 
-void* _ecs_vector_first(
-    const ecs_vector_t *vector,
-    ecs_size_t elem_size,
-    int16_t offset)
+/* Leave safe section. Run all deferred commands. */
+bool ecs_defer_flush(
+    ecs_world_t * world,
+    ecs_stage_t * stage)
 {
-    (void)elem_size;
+    if (!--stage->defer) {
+        ecs_vector_t *defer_queue = stage->defer_queue;
+        stage->defer_queue = NULL;
+        if (defer_queue) {
+            ecs_op_t *ops = ecs_vector_first(defer_queue, ecs_op_t);
+            int32_t i, count = ecs_vector_count(defer_queue);
 
-    ecs_assert(!vector || vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-    if (vector && vector->size) {
-        return ECS_OFFSET(vector, offset);
-    } else {
-        return NULL;
-    }
-}
+            /* In a parallel merge, values of set operations are copied after
+             * the structural changes from all stages have been applied */
+            bool defer_writes = world->defer_writes && stage != &world->stage;
+            ecs_arena_mark_t mark = stage->defer_mark;
 
-void* _ecs_vector_get(
-    const ecs_vector_t *vector,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t index)
-{
-    if (!vector) {
-        return NULL;
-    }
-    
-    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);    
-    ecs_assert(index >= 0, ECS_INTERNAL_ERROR, NULL);
+            for (i = 0; i < count; i ++) {
+                if (ops[i].components.count == 1) {
+                    ops[i].components.array = &ops[i].component;
+                }
+            }
+            
+            for (i = 0; i < count; i ++) {
+                ecs_op_t *op = &ops[i];
 
-    int32_t count = vector->count;
+                /* Combine adjacent operations that only change the type of or
+                 * assign values to entities */
+                if (can_coalesce(world, op)) {
+                    int32_t end = i + 1;
+                    while (end < count && can_coalesce(world, &ops[end])) {
+                        end ++;
+                    }
 
-    if (index >= count) {
-        return NULL;
-    }
+                    if (end - i > 1) {
+                        flush_coalesced(world, op, end - i, defer_writes);
+                        i = end - 1;
+                        continue;
+                    }
+                }
 
-    return ECS_OFFSET(vector, offset + elem_size * index);
-}
+                ecs_entity_t e = op->is._1.entity;
+                if (op->kind == EcsOpBulkNew) {
+                    e = 0;
+                }
 
-void* _ecs_vector_last(
-    const ecs_vector_t *vector,
-    ecs_size_t elem_size,
-    int16_t offset)
-{
-    if (vector) {
-        ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-        int32_t count = vector->count;
-        if (!count) {
-            return NULL;
-        } else {
-            return ECS_OFFSET(vector, offset + elem_size * (count - 1));
-        }
-    } else {
-        return NULL;
-    }
-}
+                /* If entity is no longer alive, this could be because the queue
+                 * contained both a delete and a subsequent add/remove/set which
+                 * should be ignored. */
+                if (e && !ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
+                    ecs_assert(op->kind != EcsOpNew && op->kind != EcsOpClone, 
+                        ECS_INTERNAL_ERROR, NULL);
+                    world->discard_count ++;
+                    continue;
+                }
 
-int32_t _ecs_vector_set_min_size(
-    ecs_vector_t **vector_inout,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count)
-{
-    if (!*vector_inout || (*vector_inout)->size < elem_count) {
-        return _ecs_vector_set_size(vector_inout, elem_size, offset, elem_count);
-    } else {
-        return (*vector_inout)->size;
-    }
-}
+                flush_op(world, op, e, defer_writes);
+            };
 
-int32_t _ecs_vector_set_min_count(
-    ecs_vector_t **vector_inout,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count)
-{
-    _ecs_vector_set_min_size(vector_inout, elem_size, offset, elem_count);
+            if (defer_queue != stage->defer_merge_queue) {
+                ecs_vector_free(defer_queue);
+            }
 
-    ecs_vector_t *v = *vector_inout;
-    if (v && v->count < elem_count) {
-        v->count = elem_count;
+            /* Release payloads of the queue in one go. Values collected for a
+             * parallel merge are released after they have been written. */
+            if (!defer_writes) {
+                ecs_stage_defer_release(stage, mark);
+            }
+        }
+
+        return true;
     }
 
-    return v->count;
+    return false;
 }
 
-void _ecs_vector_sort(
-    ecs_vector_t *vector,
-    ecs_size_t elem_size,
-    int16_t offset,
-    ecs_comparator_t compare_action)
+#define ARENA_HEADER_SIZE\
+    ECS_ALIGN(ECS_SIZEOF(ecs_arena_chunk_t), ECS_ARENA_ALIGNMENT)
+
+static
+void* arena_alloc(
+    ecs_arena_t *arena,
+    ecs_size_t size)
 {
-    if (!vector) {
-        return;
-    }
+    ecs_assert(size > 0, ECS_INTERNAL_ERROR, NULL);
 
-    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);    
+    size = ECS_ALIGN(size, ECS_ARENA_ALIGNMENT);
+    ecs_arena_chunk_t *chunk = arena->cur.chunk;
 
-    int32_t count = vector->count;
-    void *buffer = ECS_OFFSET(vector, offset);
+    if (!chunk || (arena->cur.used + size) > chunk->size) {
+        /* Chunks after the current chunk are not in use. Skip to the next chunk
+         * that is large enough, and free chunks that are too small. */
+        ecs_arena_chunk_t **next = chunk ? &chunk->next : &arena->chunks;
+        while (*next && (*next)->size < size) {
+            ecs_arena_chunk_t *small = *next;
+            *next = small->next;
+            ecs_os_free(small);
+        }
 
-    if (count > 1) {
-        qsort(buffer, (size_t)count, (size_t)elem_size, compare_action);
+        if (!*next) {
+            ecs_size_t chunk_size = ECS_ARENA_CHUNK_SIZE;
+            if (size > chunk_size) {
+                chunk_size = size;
+            }
+
+            ecs_arena_chunk_t *new_chunk = ecs_os_malloc(
+                ARENA_HEADER_SIZE + chunk_size);
+            ecs_assert(new_chunk != NULL, ECS_OUT_OF_MEMORY, NULL);
+            new_chunk->next = NULL;
+            new_chunk->size = chunk_size;
+            *next = new_chunk;
+        }
+
+        chunk = arena->cur.chunk = *next;
+        arena->cur.used = 0;
     }
+
+    void *result = ECS_OFFSET(chunk, ARENA_HEADER_SIZE + arena->cur.used);
+    arena->cur.used += size;
+    return result;
 }
 
-void _ecs_vector_memory(
-    const ecs_vector_t *vector,
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t *allocd,
-    int32_t *used)
+static
+void arena_free(
+    ecs_arena_t *arena)
 {
-    if (!vector) {
-        return;
+    ecs_arena_chunk_t *chunk = arena->chunks;
+    while (chunk) {
+        ecs_arena_chunk_t *next = chunk->next;
+        ecs_os_free(chunk);
+        chunk = next;
     }
 
-    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-
-    if (allocd) {
-        *allocd += vector->size * elem_size + offset;
-    }
-    if (used) {
-        *used += vector->count * elem_size;
-    }
+    arena->chunks = NULL;
+    arena->cur = (ecs_arena_mark_t){ 0 };
+}
+
+static
+void* defer_alloc(
+    ecs_stage_t *stage,
+    ecs_size_t size)
+{
+    return arena_alloc(&stage->defer_arena, size);
+}
+
+static
+ecs_op_t* new_defer_op(ecs_stage_t *stage) {
+    if (!ecs_vector_count(stage->defer_queue)) {
+        /* Payloads of a queue are released when the queue is flushed */
+        stage->defer_mark = stage->defer_arena.cur;
+    }
+
+    ecs_op_t *result = ecs_vector_add(&stage->defer_queue, ecs_op_t);
+    ecs_os_memset(result, 0, ECS_SIZEOF(ecs_op_t));
+    return result;
+}
+
+static 
+void new_defer_component_ids(
+    ecs_stage_t *stage,
+    ecs_op_t *op, 
+    ecs_entities_t *components)
+{
+    int32_t components_count = components->count;
+    if (components_count == 1) {
+        ecs_entity_t component = components->array[0];
+        op->component = component;
+        op->components = (ecs_entities_t) {
+            .array = NULL,
+            .count = 1
+        };
+    } else if (components_count) {
+        ecs_size_t array_size = components_count * ECS_SIZEOF(ecs_entity_t);
+        op->components.array = defer_alloc(stage, array_size);
+        ecs_os_memcpy(op->components.array, components->array, array_size);
+        op->components.count = components_count;
+    } else {
+        op->component = 0;
+        op->components = (ecs_entities_t){ 0 };
+    }
+}
+
+static
+bool defer_add_remove(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_op_kind_t op_kind,
+    ecs_entity_t entity,
+    ecs_entities_t *components)
+{
+    if (stage->defer) {
+        ecs_entity_t scope = stage->scope;
+        if (components) {
+            if (!components->count && !scope) {
+                return true;
+            }
+        }
+
+        ecs_op_t *op = new_defer_op(stage);
+        op->kind = op_kind;
+        op->scope = scope;
+        op->is._1.entity = entity;
+
+        new_defer_component_ids(stage, op, components);
+
+        if (op_kind == EcsOpNew) {
+            world->new_count ++;
+        } else if (op_kind == EcsOpAdd) {
+            world->add_count ++;
+        } else if (op_kind == EcsOpRemove) {
+            world->remove_count ++;
+        }
+
+        return true;
+    } else {
+        stage->defer ++;
+    }
+    
+    return false;
+}
+
+bool ecs_defer_none(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    (void)world;
+    return (++ stage->defer) == 1;
+}
+
+bool ecs_defer_modified(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t entity,
+    ecs_entity_t component)
+{
+    (void)world;
+    if (stage->defer) {
+        ecs_op_t *op = new_defer_op(stage);
+        op->kind = EcsOpModified;
+        op->component = component;
+        op->is._1.entity = entity;
+        return true;
+    } else {
+        stage->defer ++;
+    }
+    
+    return false;
+}
+
+bool ecs_defer_clone(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t entity,
+    ecs_entity_t src,
+    bool clone_value)
+{   
+    (void)world;
+    if (stage->defer) {
+        ecs_op_t *op = new_defer_op(stage);
+        op->kind = EcsOpClone;
+        op->component = src;
+        op->is._1.entity = entity;
+        op->is._1.clone_value = clone_value;
+        return true;
+    } else {
+        stage->defer ++;
+    }
+    
+    return false;   
+}
+
+bool ecs_defer_delete(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t entity)
+{
+    (void)world;
+    if (stage->defer) {
+        ecs_op_t *op = new_defer_op(stage);
+        op->kind = EcsOpDelete;
+        op->is._1.entity = entity;
+        world->delete_count ++;
+        return true;
+    } else {
+        stage->defer ++;
+    }
+    return false;
+}
+
+bool ecs_defer_clear(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t entity)
+{
+    (void)world;
+    if (stage->defer) {
+        ecs_op_t *op = new_defer_op(stage);
+        op->kind = EcsOpClear;
+        op->is._1.entity = entity;
+        world->clear_count ++;
+        return true;
+    } else {
+        stage->defer ++;
+    }
+    return false;
+}
+
+bool ecs_defer_enable(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t entity,
+    ecs_entity_t component,
+    bool enable)
+{
+    (void)world;
+    if (stage->defer) {
+        ecs_op_t *op = new_defer_op(stage);
+        op->kind = enable ? EcsOpEnable : EcsOpDisable;
+        op->is._1.entity = entity;
+        op->component = component;
+        return true;
+    } else {
+        stage->defer ++;
+    }
+    return false;
+}
+
+bool ecs_defer_bulk_new(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    int32_t count,
+    ecs_entities_t *components_ids,
+    void **component_data,
+    const ecs_entity_t **ids_out)
+{
+    if (stage->defer) {
+        /* Create operation first, so payloads are released with the queue */
+        ecs_op_t *op = new_defer_op(stage);
+        ecs_entity_t *ids = defer_alloc(stage, count * ECS_SIZEOF(ecs_entity_t));
+        void **defer_data = NULL;
+
+        world->bulk_new_count ++;
+
+        /* Use ecs_new_id as this is thread safe */
+        int i;
+        for (i = 0; i < count; i ++) {
+            ids[i] = ecs_new_id(world);
+        }
+
+        /* Create private copy for component data */
+        if (component_data) {
+            int c, c_count = components_ids->count;
+            ecs_entity_t *components = components_ids->array;
+            defer_data = defer_alloc(stage, ECS_SIZEOF(void*) * c_count);
+            for (c = 0; c < c_count; c ++) {
+                ecs_entity_t comp = components[c];
+                const EcsComponent *cptr = ecs_component_from_id(world, comp);
+                ecs_assert(cptr != NULL, ECS_INVALID_PARAMETER, NULL);
+
+                ecs_size_t size = cptr->size;
+                void *data = defer_alloc(stage, size * count);
+                defer_data[c] = data;
+
+                ecs_c_info_t *cinfo = NULL;
+                ecs_entity_t real_id = ecs_get_typeid(world, comp);
+                if (real_id) {
+                    cinfo = ecs_get_c_info(world, real_id);
+                }
+                ecs_xtor_t ctor;
+                if (cinfo && (ctor = cinfo->lifecycle.ctor)) {
+                    void *ctx = cinfo->lifecycle.ctx;
+                    ctor(world, comp, ids, data, ecs_to_size_t(size), count, ctx);
+                    ecs_move_t move;
+                    if ((move = cinfo->lifecycle.move)) {
+                        move(world, comp, ids, ids, data, component_data[c], 
+                            ecs_to_size_t(size), count, ctx);
+                    } else {
+                        ecs_os_memcpy(data, component_data[c], size * count);
+                    }
+                } else {
+                    ecs_os_memcpy(data, component_data[c], size * count);
+                }
+            }
+        }
+
+        /* Store data in op */
+        op->kind = EcsOpBulkNew;
+        op->is._n.entities = ids;
+        op->is._n.bulk_data = defer_data;
+        op->is._n.count = count;
+        new_defer_component_ids(stage, op, components_ids);
+        *ids_out = ids;
+
+        return true;
+    } else {
+        stage->defer ++;
+    }
+
+    return false;
+}
+
+bool ecs_defer_new(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t entity,
+    ecs_entities_t *components)
+{   
+    return defer_add_remove(world, stage, EcsOpNew, entity, components);
+}
+
+bool ecs_defer_add(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t entity,
+    ecs_entities_t *components)
+{   
+    return defer_add_remove(world, stage, EcsOpAdd, entity, components);
+}
+
+bool ecs_defer_remove(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t entity,
+    ecs_entities_t *components)
+{
+    return defer_add_remove(world, stage, EcsOpRemove, entity, components);
+}
+
+bool ecs_defer_set(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_op_kind_t op_kind,
+    ecs_entity_t entity,
+    ecs_entity_t component,
+    ecs_size_t size,
+    const void *value,
+    void **value_out,
+    bool *is_added)
+{
+    if (stage->defer) {
+        world->set_count ++;
+        if (!size) {
+            const EcsComponent *cptr = ecs_component_from_id(world, component);
+            ecs_assert(cptr != NULL, ECS_INVALID_PARAMETER, NULL);
+            size = cptr->size;
+        }
+
+        ecs_op_t *op = new_defer_op(stage);
+        op->kind = op_kind;
+        op->component = component;
+        op->is._1.entity = entity;
+        op->is._1.size = size;
+        op->is._1.value = defer_alloc(stage, size);
+
+        if (!value) {
+            value = ecs_get_w_entity(world, entity, component);
+            if (is_added) {
+                *is_added = value == NULL;
+            }
+        }
+
+        ecs_c_info_t *c_info = NULL;
+        ecs_entity_t real_id = ecs_get_typeid(world, component);
+        if (real_id) {
+            c_info = ecs_get_c_info(world, real_id);
+        }
+        ecs_xtor_t ctor;
+        if (c_info && (ctor = c_info->lifecycle.ctor)) {
+            ctor(world, component, &entity, op->is._1.value, 
+                ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
+
+            ecs_copy_t copy;
+            if (value) {
+                if ((copy = c_info->lifecycle.copy)) {
+                    copy(world, component, &entity, &entity, op->is._1.value, value, 
+                        ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
+                } else {
+                    ecs_os_memcpy(op->is._1.value, value, size);
+                }
+            }
+        } else if (value) {
+            ecs_os_memcpy(op->is._1.value, value, size);
+        }
+        
+        if (value_out) {
+            *value_out = op->is._1.value;
+        }
+
+        return true;
+    } else {
+        stage->defer ++;
+    }
+    
+    return false;
+}
+
+void ecs_stage_merge(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    ecs_assert(stage != &world->stage, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_assert(stage->defer == 0, ECS_INVALID_PARAMETER, NULL);
+    if (ecs_vector_count(stage->defer_merge_queue)) {
+        stage->defer ++;
+        stage->defer_queue = stage->defer_merge_queue;
+        ecs_defer_flush(world, stage);
+        ecs_vector_clear(stage->defer_merge_queue);
+        ecs_assert(stage->defer_queue == NULL, ECS_INVALID_PARAMETER, NULL);
+    }    
+}
+
+bool ecs_stage_defer_begin(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{   
+    (void)world; 
+    if (ecs_defer_none(world, stage)) {
+        stage->defer_queue = stage->defer_merge_queue;    
+        return true;  
+    }
+    return false;
+}
+
+bool ecs_stage_defer_end(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{ 
+    (void)world;
+    stage->defer --;
+    if (!stage->defer) {
+        stage->defer_merge_queue = stage->defer_queue;
+        stage->defer_queue = NULL;
+        return true;
+    }
+    return false;
+}
+
+void ecs_stage_merge_post_frame(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    /* Execute post frame actions */
+    ecs_vector_each(stage->post_frame_actions, ecs_action_elem_t, action, {
+        action->action(world, action->ctx);
+    });
+
+    ecs_vector_free(stage->post_frame_actions);
+    stage->post_frame_actions = NULL;
+}
+
+void ecs_stage_init(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    memset(stage, 0, sizeof(ecs_stage_t));
+    if (stage == &world->stage) {
+        stage->id = 0;
+    } else if (stage == &world->temp_stage) {
+        stage->id = 1;
+    }
+}
+
+void ecs_stage_deinit(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    (void)world;
+    ecs_vector_free(stage->defer_queue);
+    ecs_vector_free(stage->defer_merge_queue);
+    arena_free(&stage->defer_arena);
+}
+
+void ecs_stage_defer_release(
+    ecs_stage_t *stage,
+    ecs_arena_mark_t mark)
+{
+    stage->defer_arena.cur = mark;
+}
+
+void ecs_stage_defer_reset(
+    ecs_stage_t *stage)
+{
+    stage->defer_arena.cur = (ecs_arena_mark_t){ 0 };
+}
+
+
+/* Vectors with an element alignment larger than what malloc guarantees have an
+ * offset that is larger than the header. The allocation is padded, so that the
+ * header can be placed at an address with that alignment, which also aligns
+ * the elements. The pointer returned by malloc is stored in the unused space
+ * between the header and the elements. */
+static
+bool is_overaligned(
+    int16_t offset)
+{
+    return offset > ECS_VECTOR_HEADER_SIZE;
+}
+
+static
+void** malloc_ptr(
+    ecs_vector_t *vector,
+    int16_t offset)
+{
+    return ECS_OFFSET(vector, offset - ECS_SIZEOF(void*));
+}
+
+/* Vectors that are not allocated from a pool use the OS API */
+static
+void* pool_malloc(
+    ecs_pool_t *pool,
+    ecs_size_t size)
+{
+    if (!pool) {
+        return ecs_os_malloc(size);
+    }
+
+    pool->stats.malloc_count ++;
+    pool->stats.bytes_allocated += size;
+    return pool->allocator.malloc_(pool->allocator.ctx, size);
+}
+
+static
+void* pool_realloc(
+    ecs_pool_t *pool,
+    void *ptr,
+    ecs_size_t size)
+{
+    if (!pool) {
+        return ecs_os_realloc(ptr, size);
+    }
+
+    pool->stats.realloc_count ++;
+    pool->stats.bytes_allocated += size;
+    return pool->allocator.realloc_(pool->allocator.ctx, ptr, size);
+}
+
+static
+void pool_free(
+    ecs_pool_t *pool,
+    void *ptr)
+{
+    if (!pool) {
+        ecs_os_free(ptr);
+    } else {
+        pool->stats.free_count ++;
+        pool->allocator.free_(pool->allocator.ctx, ptr);
+    }
+}
+
+static
+ecs_vector_t* alloc_vector(
+    ecs_pool_t *pool,
+    int16_t offset,
+    ecs_size_t size)
+{
+    ecs_vector_t *result;
+
+    if (!is_overaligned(offset)) {
+        result = pool_malloc(pool, offset + size);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+    } else {
+        void *ptr = pool_malloc(pool, offset * 2 + size);
+        ecs_assert(ptr != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+        uintptr_t align_mask = (uintptr_t)offset - 1;
+        result = (ecs_vector_t*)(((uintptr_t)ptr + align_mask) & ~align_mask);
+        *malloc_ptr(result, offset) = ptr;
+    }
+
+    result->pool = pool;
+#ifndef NDEBUG
+    result->offset = offset;
+#endif
+    return result;
+}
+
+static
+void free_vector(
+    ecs_vector_t *vector,
+    int16_t offset)
+{
+    if (!vector) {
+        return;
+    }
+
+    if (is_overaligned(offset)) {
+        pool_free(vector->pool, *malloc_ptr(vector, offset));
+    } else {
+        pool_free(vector->pool, vector);
+    }
+}
+
+/** Resize the vector buffer */
+static
+ecs_vector_t* resize(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    if (!is_overaligned(offset)) {
+        ecs_vector_t *result = pool_realloc(
+            vector->pool, vector, offset + elem_size * elem_count);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
+        return result;
+    }
+
+    /* Realloc does not preserve alignment, so copy to a new allocation */
+    ecs_vector_t *result = alloc_vector(
+        vector->pool, offset, elem_size * elem_count);
+    int32_t count = vector->count;
+    if (count > elem_count) {
+        count = elem_count;
+    }
+
+    *result = *vector;
+    ecs_os_memcpy(ECS_OFFSET(result, offset), ECS_OFFSET(vector, offset), 
+        elem_size * count);
+    free_vector(vector, offset);
+
+    return result;
+}
+
+/* -- Public functions -- */
+
+ecs_vector_t* _ecs_vector_new(
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    return _ecs_vector_new_w_pool(NULL, elem_size, offset, elem_count);
+}
+
+ecs_vector_t* _ecs_vector_new_w_pool(
+    ecs_pool_t *pool,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
+    
+    ecs_vector_t *result = alloc_vector(pool, offset, elem_size * elem_count);
+
+    result->count = 0;
+    result->size = elem_count;
+#ifndef NDEBUG
+    result->elem_size = elem_size;
+#endif
+    return result;
+}
+
+ecs_vector_t* _ecs_vector_from_array(
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count,
+    void *array)
+{
+    ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
+    
+    ecs_vector_t *result = alloc_vector(NULL, offset, elem_size * elem_count);
+
+    ecs_os_memcpy(ECS_OFFSET(result, offset), array, elem_size * elem_count);
+
+    result->count = elem_count;
+    result->size = elem_count;
+#ifndef NDEBUG
+    result->elem_size = elem_size;
+#endif
+    return result;   
+}
+
+void ecs_vector_free(
+    ecs_vector_t *vector)
+{
+    if (vector) {
+        /* The pointer to free is stored in the header of over-aligned vectors,
+         * which can only be found if the offset is known */
+        ecs_assert(!is_overaligned(vector->offset), 
+            ECS_INVALID_PARAMETER, NULL);
+        pool_free(vector->pool, vector);
+    }
+}
+
+void _ecs_vector_free(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    (void)elem_size;
+    ecs_assert(!vector || vector->offset == offset, 
+        ECS_INVALID_PARAMETER, NULL);
+    free_vector(vector, offset);
+}
+
+void ecs_vector_clear(
+    ecs_vector_t *vector)
+{
+    if (vector) {
+        vector->count = 0;
+    }
+}
+
+void _ecs_vector_zero(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    void *array = ECS_OFFSET(vector, offset);
+    ecs_os_memset(array, 0, elem_size * vector->count);
+}
+
+void ecs_vector_assert_size(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size)
+{
+    (void)elem_size;
+    
+    if (vector) {
+        ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+void ecs_vector_assert_alignment(
+    ecs_vector_t *vector,
+    ecs_size_t elem_alignment)
+{
+    (void)elem_alignment;
+
+    if (vector) {
+        ecs_assert(vector->offset == ECS_VECTOR_OFFSET(elem_alignment), 
+            ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+void* _ecs_vector_addn(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    ecs_assert(array_inout != NULL, ECS_INTERNAL_ERROR, NULL);
+    
+    if (elem_count == 1) {
+        return _ecs_vector_add(array_inout, elem_size, offset);
+    }
+    
+    ecs_vector_t *vector = *array_inout;
+    if (!vector) {
+        vector = _ecs_vector_new(elem_size, offset, 1);
+        *array_inout = vector;
+    }
+
+    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t max_count = vector->size;
+    int32_t old_count = vector->count;
+    int32_t new_count = old_count + elem_count;
+
+    if ((new_count - 1) >= max_count) {
+        if (!max_count) {
+            max_count = elem_count;
+        } else {
+            while (max_count < new_count) {
+                max_count *= 2;
+            }
+        }
+
+        vector = resize(vector, elem_size, offset, max_count);
+        vector->size = max_count;
+        *array_inout = vector;
+    }
+
+    vector->count = new_count;
+
+    return ECS_OFFSET(vector, offset + elem_size * old_count);
+}
+
+void* _ecs_vector_add(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    ecs_vector_t *vector = *array_inout;
+    int32_t count, size;
+
+    if (vector) {
+        ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+        count = vector->count;
+        size = vector->size;
+
+        if (count >= size) {
+            size *= 2;
+            if (!size) {
+                size = 2;
+            }
+            vector = resize(vector, elem_size, offset, size);
+            *array_inout = vector;
+            vector->size = size;
+        }
+
+        vector->count = count + 1;
+        return ECS_OFFSET(vector, offset + elem_size * count);
+    }
+
+    vector = _ecs_vector_new(elem_size, offset, 2);
+    *array_inout = vector;
+    vector->count = 1;
+    vector->size = 2;
+    return ECS_OFFSET(vector, offset);
+}
+
+int32_t _ecs_vector_move_index(
+    ecs_vector_t **dst,
+    ecs_vector_t *src,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t index)
+{
+    ecs_assert((*dst)->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(src->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+    void *dst_elem = _ecs_vector_add(dst, elem_size, offset);
+    void *src_elem = _ecs_vector_get(src, elem_size, offset, index);
+
+    ecs_os_memcpy(dst_elem, src_elem, elem_size);
+    return _ecs_vector_remove_index(src, elem_size, offset, index);
+}
+
+void ecs_vector_remove_last(
+    ecs_vector_t *vector)
+{
+    if (vector && vector->count) vector->count --;
+}
+
+bool _ecs_vector_pop(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset,
+    void *value)
+{
+    if (!vector) {
+        return false;
+    }
+
+    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t count = vector->count;
+    if (!count) {
+        return false;
+    }
+
+    void *elem = ECS_OFFSET(vector, offset + (count - 1) * elem_size);
+
+    if (value) {
+        ecs_os_memcpy(value, elem, elem_size);
+    }
+
+    ecs_vector_remove_last(vector);
+
+    return true;
+}
+
+int32_t _ecs_vector_remove_index(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t index)
+{
+    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    
+    int32_t count = vector->count;
+    void *buffer = ECS_OFFSET(vector, offset);
+    void *elem = ECS_OFFSET(buffer, index * elem_size);
+
+    ecs_assert(index < count, ECS_INVALID_PARAMETER, NULL);
+
+    count --;
+    if (index != count) {
+        void *last_elem = ECS_OFFSET(buffer, elem_size * count);
+        ecs_os_memcpy(elem, last_elem, elem_size);
+    }
+
+    vector->count = count;
+
+    return count;
+}
+
+void _ecs_vector_reclaim(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    ecs_vector_t *vector = *array_inout;
+
+    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    
+    int32_t size = vector->size;
+    int32_t count = vector->count;
+
+    if (count < size) {
+        size = count;
+        vector = resize(vector, elem_size, offset, size);
+        vector->size = size;
+        *array_inout = vector;
+    }
+}
+
+int32_t ecs_vector_count(
+    const ecs_vector_t *vector)
+{
+    if (!vector) {
+        return 0;
+    }
+    return vector->count;
+}
+
+int32_t ecs_vector_size(
+    const ecs_vector_t *vector)
+{
+    if (!vector) {
+        return 0;
+    }
+    return vector->size;
+}
+
+int32_t _ecs_vector_set_size(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    ecs_vector_t *vector = *array_inout;
+
+    if (!vector) {
+        *array_inout = _ecs_vector_new(elem_size, offset, elem_count);
+        return elem_count;
+    } else {
+        ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+        int32_t result = vector->size;
+
+        if (elem_count < vector->count) {
+            elem_count = vector->count;
+        }
+
+        if (result < elem_count) {
+            elem_count = ecs_next_pow_of_2(elem_count);
+            vector = resize(vector, elem_size, offset, elem_count);
+            vector->size = elem_count;
+            *array_inout = vector;
+            result = elem_count;
+        }
+
+        return result;
+    }
+}
+
+int32_t _ecs_vector_grow(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    int32_t current = ecs_vector_count(*array_inout);
+    return _ecs_vector_set_size(array_inout, elem_size, offset, current + elem_count);
+}
+
+int32_t _ecs_vector_set_count(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    if (!*array_inout) {
+        *array_inout = _ecs_vector_new(elem_size, offset, elem_count);
+    }
+
+    ecs_assert((*array_inout)->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+    (*array_inout)->count = elem_count;
+    ecs_size_t size = _ecs_vector_set_size(array_inout, elem_size, offset, elem_count);
+    return size;
+}
+
+void* _ecs_vector_first(
+    const ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    (void)elem_size;
+
+    ecs_assert(!vector || vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    if (vector && vector->size) {
+        return ECS_OFFSET(vector, offset);
+    } else {
+        return NULL;
+    }
+}
+
+void* _ecs_vector_get(
+    const ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t index)
+{
+    if (!vector) {
+        return NULL;
+    }
+    
+    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);    
+    ecs_assert(index >= 0, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t count = vector->count;
+
+    if (index >= count) {
+        return NULL;
+    }
+
+    return ECS_OFFSET(vector, offset + elem_size * index);
+}
+
+void* _ecs_vector_last(
+    const ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    if (vector) {
+        ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+        int32_t count = vector->count;
+        if (!count) {
+            return NULL;
+        } else {
+            return ECS_OFFSET(vector, offset + elem_size * (count - 1));
+        }
+    } else {
+        return NULL;
+    }
+}
+
+int32_t _ecs_vector_set_min_size(
+    ecs_vector_t **vector_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    if (!*vector_inout || (*vector_inout)->size < elem_count) {
+        return _ecs_vector_set_size(vector_inout, elem_size, offset, elem_count);
+    } else {
+        return (*vector_inout)->size;
+    }
+}
+
+int32_t _ecs_vector_set_min_count(
+    ecs_vector_t **vector_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    _ecs_vector_set_min_size(vector_inout, elem_size, offset, elem_count);
+
+    ecs_vector_t *v = *vector_inout;
+    if (v && v->count < elem_count) {
+        v->count = elem_count;
+    }
+
+    return v->count;
+}
+
+void _ecs_vector_sort(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset,
+    ecs_comparator_t compare_action)
+{
+    if (!vector) {
+        return;
+    }
+
+    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);    
+
+    int32_t count = vector->count;
+    void *buffer = ECS_OFFSET(vector, offset);
+
+    if (count > 1) {
+        qsort(buffer, (size_t)count, (size_t)elem_size, compare_action);
+    }
+}
+
+void _ecs_vector_memory(
+    const ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t *allocd,
+    int32_t *used)
+{
+    if (!vector) {
+        return;
+    }
+
+    ecs_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+    if (allocd) {
+        *allocd += vector->size * elem_size + offset;
+    }
+    if (used) {
+        *used += vector->count * elem_size;
+    }
 }
 
 ecs_vector_t* _ecs_vector_copy(
@@ -7634,8 +9863,11 @@ ecs_vector_t* _ecs_vector_copy(
         return NULL;
     }
 
-    ecs_vector_t *dst = _ecs_vector_new(elem_size, offset, src->size);
-    ecs_os_memcpy(dst, src, offset + elem_size * src->count);
+    ecs_vector_t *dst = _ecs_vector_new_w_pool(
+        src->pool, elem_size, offset, src->size);
+    ecs_os_memcpy(ECS_OFFSET(dst, offset), ECS_OFFSET(src, offset), 
+        elem_size * src->count);
+    dst->count = src->count;
     return dst;
 }
 
@@ -8443,6 +10675,11 @@ void ecs_table_writer_finalize_table(
     /* Register entities in table in entity index */
     ecs_data_t *data = ecs_table_get_data(writer->table);
     ecs_vector_t *entity_vector = data->entities;
+
+    if (writer->table->flags & EcsTableHasName) {
+        world->name_index_dirty = true;
+    }
+
     ecs_entity_t *entities = ecs_vector_first(entity_vector, ecs_entity_t);
     ecs_record_t **record_ptrs = ecs_vector_first(data->record_ptrs, ecs_record_t*);
     int32_t i, count = ecs_vector_count(entity_vector);
@@ -8496,10 +10733,12 @@ void ecs_table_writer_prepare_column(
 
         if (size) {
             int32_t old_count = ecs_vector_count(column->data);
-            _ecs_vector_set_count(&column->data, ECS_VECTOR_U(size, 0), writer->row_count);
+            int16_t alignment = column->alignment;
+            ecs_vector_set_count_t(
+                &column->data, size, alignment, writer->row_count);
 
             /* Initialize new elements to 0 */
-            void *buffer = ecs_vector_first_t(column->data, size, 0);
+            void *buffer = ecs_vector_first_t(column->data, size, alignment);
             ecs_os_memset(ECS_OFFSET(buffer, old_count * size), 0, 
                 (writer->row_count - old_count) * size);
         }
@@ -9141,6 +11380,17 @@ ecs_entity_t ecs_run_intern(
     void *param,
     bool ran_by_app);
 
+#ifdef FLECS_PIPELINE
+/* Run system on a worker thread. Matched entities are divided up in jobs that
+ * are shared between workers. Implemented by the pipeline module. */
+void ecs_worker_run_jobs(
+    ecs_world_t *world,
+    ecs_thread_t *thread,
+    ecs_entity_t system,
+    ecs_iter_t *it,
+    ecs_iter_action_t action);
+#endif
+
 #endif
 #endif
 
@@ -9156,11 +11406,49 @@ typedef struct ecs_pipeline_op_t {
     int32_t count;              /**< Number of systems to run before merge */
 } ecs_pipeline_op_t;
 
+/** A range of entities from a single query result that is part of a job. The
+ * fields correspond with the iterator fields that are set by ecs_query_next, so
+ * that a worker can run a fragment without having to iterate the query. */
+typedef struct ecs_job_fragment_t {
+    ecs_iter_table_t *table;    /**< Table data for iterator */
+    void *table_columns;        /**< Table component data */
+    ecs_entity_t *entities;     /**< First entity of fragment */
+    int32_t offset;             /**< Offset relative to current table */
+    int32_t count;              /**< Number of entities in fragment */
+    int32_t total_count;        /**< Total number of entities in result */
+    int32_t frame_offset;       /**< Offset relative to frame */
+} ecs_job_fragment_t;
+
+/** Jobs owned by a single worker. The worker pops jobs from the head of the
+ * deque, while workers that ran out of jobs steal from the tail. */
+typedef struct ecs_job_deque_t {
+    ecs_os_mutex_t lock;
+    int32_t head;
+    int32_t tail;
+} ecs_job_deque_t;
+
+/** Jobs for a system that is ran on multiple threads. The first worker that
+ * runs the system builds the job list, which is then shared by all workers. */
+typedef struct ecs_job_queue_t {
+    ecs_os_mutex_t lock;        /**< Guards building the job list */
+    ecs_os_cond_t done_cond;    /**< Signalled when all jobs have finished */
+    bool built;                 /**< Is job list built for current frame */
+    int32_t job_count;          /**< Number of jobs, -1 until list is built */
+    int32_t jobs_done;          /**< Number of finished jobs */
+    ecs_vector_t *depends_on;   /**< Queues that must finish before this one */
+    ecs_vector_t *results;      /**< Query results used to build jobs */
+    ecs_vector_t *fragments;    /**< Fragments ordered by job */
+    ecs_vector_t *jobs;         /**< Index of first fragment per job */
+    ecs_job_deque_t *deques;    /**< One deque per worker */
+    int32_t deque_count;
+} ecs_job_queue_t;
+
 typedef struct EcsPipelineQuery {
     ecs_query_t *query;
     ecs_query_t *build_query;
     int32_t match_count;
     ecs_vector_t *ops;
+    ecs_map_t *deps;            /**< Systems that a system depends on */
 } EcsPipelineQuery;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -9192,14 +11480,24 @@ void ecs_worker_begin(
     ecs_world_t *world);
 
 bool ecs_worker_sync(
-    ecs_world_t *world);
+    ecs_world_t *world,
+    ecs_stage_t *stage);
 
 void ecs_worker_end(
-    ecs_world_t *world);
+    ecs_world_t *world,
+    ecs_stage_t *stage);
 
 void ecs_workers_progress(
     ecs_world_t *world);
 
+void ecs_workers_prepare_jobs(
+    ecs_world_t *world,
+    ecs_entity_t pipeline);
+
+void ecs_worker_skip_jobs(
+    ecs_world_t *world,
+    ecs_entity_t system);
+
 #endif
 #endif
 
@@ -9314,6 +11612,7 @@ void ecs_get_world_stats(
     record_counter(&s->frame_time_total, t, world->stats.frame_time_total);
     record_counter(&s->system_time_total, t, world->stats.system_time_total);
     record_counter(&s->merge_time_total, t, world->stats.merge_time_total);
+    record_counter(&s->sync_wait_time_total, t, world->stats.sync_wait_time_total);
 
     float delta_frame_count = record_counter(&s->frame_count_total, t, world->stats.frame_count_total);
     record_counter(&s->merge_count_total, t, world->stats.merge_count_total);
@@ -9345,6 +11644,7 @@ void ecs_get_world_stats(
     int32_t empty_table_count = 0;
     int32_t singleton_table_count = 0;
     int32_t matched_table_count = 0, matched_entity_count = 0;
+    int32_t edge_count = 0, edge_memory = 0;
 
     int32_t i, count = ecs_sparse_count(world->store.tables);
     for (i = 0; i < count; i ++) {
@@ -9373,6 +11673,18 @@ void ecs_get_world_stats(
             matched_table_count ++;
             matched_entity_count += entity_count;
         }
+
+        if (table->edges) {
+            edge_count += ecs_map_count(table->edges);
+            ecs_map_memory(table->edges, &edge_memory, NULL);
+        }
+    }
+
+    /* The root table is not stored in the table sparse set */
+    ecs_table_t *root = &world->store.root;
+    if (root->edges) {
+        edge_count += ecs_map_count(root->edges);
+        ecs_map_memory(root->edges, &edge_memory, NULL);
     }
 
     record_gauge(&s->matched_table_count, t, matched_table_count);
@@ -9381,6 +11693,8 @@ void ecs_get_world_stats(
     record_gauge(&s->table_count, t, count);
     record_gauge(&s->empty_table_count, t, empty_table_count);
     record_gauge(&s->singleton_table_count, t, singleton_table_count);
+    record_gauge(&s->table_edge_count, t, edge_count);
+    record_gauge(&s->table_edge_memory, t, edge_memory);
 }
 
 void ecs_get_query_stats(
@@ -9525,6 +11839,7 @@ void ecs_dump_world_stats(
     print_counter("frame time", t, &s->frame_time_total);
     print_counter("system time", t, &s->system_time_total);
     print_counter("merge time", t, &s->merge_time_total);
+    print_counter("sync wait time", t, &s->sync_wait_time_total);
     print_counter("simulation time elapsed", t, &s->world_time_total);
     printf("\n");
     print_gauge("entity count", t, &s->entity_count);
@@ -9534,6 +11849,8 @@ void ecs_dump_world_stats(
     print_gauge("table count", t, &s->table_count);
     print_gauge("singleton table count", t, &s->singleton_table_count);
     print_gauge("empty table count", t, &s->empty_table_count);
+    print_gauge("table edge count", t, &s->table_edge_count);
+    print_gauge("table edge memory", t, &s->table_edge_memory);
     printf("\n");
     print_counter("deferred new operations", t, &s->new_count);
     print_counter("deferred bulk_new operations", t, &s->bulk_new_count);
@@ -9586,11 +11903,6 @@ ecs_data_t* duplicate_data(
         ecs_entity_t component = components[i];
         ecs_column_t *column = &result->columns[i];
 
-        if (component > ECS_HI_COMPONENT_ID) {
-            column->data = NULL;
-            continue;
-        }
-
         ecs_c_info_t *cdata = ecs_get_c_info(world, component);
         int16_t size = column->size;
         int16_t alignment = column->alignment;
@@ -9634,6 +11946,9 @@ ecs_snapshot_t* snapshot_create(
 
     result->world = world;
 
+    /* Prevent tables from being garbage collected while snapshot is alive */
+    world->snapshot_count ++;
+
     /* If no iterator is provided, the snapshot will be taken of the entire
      * world, and we can simply copy the entity index as it will be restored
      * entirely upon snapshote restore. */
@@ -9828,6 +12143,8 @@ void ecs_snapshot_restore(
 
     ecs_vector_free(snapshot->tables);   
 
+    world->snapshot_count --;
+
     ecs_os_free(snapshot);
 }
 
@@ -9897,6 +12214,9 @@ void ecs_snapshot_free(
     }    
 
     ecs_vector_free(snapshot->tables);
+
+    snapshot->world->snapshot_count --;
+
     ecs_os_free(snapshot);
 }
 
@@ -10486,8 +12806,9 @@ void merge_table(
         /* Merge table into dst_table */
         if (dst_table != src_table) {
             ecs_data_t *src_data = ecs_table_get_data(src_table);
-            int32_t dst_count = ecs_table_count(dst_table);
             int32_t src_count = ecs_table_count(src_table);
+            dst_table = ecs_table_get_chunk(world, dst_table, src_count);
+            int32_t dst_count = ecs_table_count(dst_table);
 
             if (to_remove && to_remove->count && src_data) {
                 ecs_run_remove_actions(world, src_table, 
@@ -10867,6 +13188,15 @@ ecs_vector_t* ecs_table_get_column(
     return c ? c->data : NULL;
 }
 
+size_t ecs_table_column_alignment(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column)
+{
+    ecs_column_t *c = da_get_or_create_column(world, table, column);
+    return ecs_to_size_t(c->alignment);
+}
+
 ecs_vector_t* ecs_table_set_column(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -10876,6 +13206,7 @@ ecs_vector_t* ecs_table_set_column(
     ecs_column_t *c = da_get_or_create_column(world, table, column);
     if (vector) {
         ecs_vector_assert_size(vector, c->size);
+        ecs_vector_assert_alignment(vector, c->alignment);
     } else {
         ecs_vector_t *entities = ecs_table_get_entities(table);
         if (entities) {
@@ -11006,7 +13337,7 @@ void ecs_table_delete_column(
         c->data = NULL;
     }
 
-    ecs_vector_free(vector);
+    ecs_vector_free_t(vector, c->size, c->alignment);
 }
 
 void* ecs_record_get_column(
@@ -11164,6 +13495,123 @@ ecs_stage_t *ecs_get_stage(
     return NULL;
 }
 
+/* -- Paged array -- */
+
+static
+void paged_init(
+    ecs_paged_t *paged,
+    ecs_size_t elem_size)
+{
+    paged->tables = NULL;
+    paged->table_count = 0;
+    paged->elem_size = elem_size;
+}
+
+static
+void paged_fini(
+    ecs_paged_t *paged)
+{
+    int32_t t, p;
+    for (t = 0; t < paged->table_count; t ++) {
+        void **table = paged->tables[t];
+        if (table) {
+            for (p = 0; p < ECS_PAGE_TABLE_SIZE; p ++) {
+                ecs_os_free(table[p]);
+            }
+            ecs_os_free(table);
+        }
+    }
+
+    ecs_os_free(paged->tables);
+    paged->tables = NULL;
+    paged->table_count = 0;
+}
+
+static
+void* paged_get(
+    const ecs_paged_t *paged,
+    uint64_t index)
+{
+    index &= ECS_ENTITY_MASK;
+
+    uint64_t page_index = index >> ECS_PAGE_BITS;
+    int32_t table_index = (int32_t)(page_index >> ECS_PAGE_TABLE_BITS);
+    if (table_index >= paged->table_count) {
+        return NULL;
+    }
+
+    void **table = paged->tables[table_index];
+    if (!table) {
+        return NULL;
+    }
+
+    void *page = table[page_index & (ECS_PAGE_TABLE_SIZE - 1)];
+    if (!page) {
+        return NULL;
+    }
+
+    int32_t offset = (int32_t)(index & (ECS_PAGE_SIZE - 1));
+    return ECS_OFFSET(page, paged->elem_size * offset);
+}
+
+static
+void* paged_ensure(
+    ecs_paged_t *paged,
+    uint64_t index)
+{
+    void *result = paged_get(paged, index);
+    if (result) {
+        return result;
+    }
+
+    index &= ECS_ENTITY_MASK;
+
+    uint64_t page_index = index >> ECS_PAGE_BITS;
+    int32_t table_index = (int32_t)(page_index >> ECS_PAGE_TABLE_BITS);
+    int32_t count = paged->table_count;
+    if (table_index >= count) {
+        paged->tables = ecs_os_realloc(
+            paged->tables, (table_index + 1) * ECS_SIZEOF(void**));
+        ecs_os_memset(&paged->tables[count], 0, 
+            (table_index + 1 - count) * ECS_SIZEOF(void**));
+        paged->table_count = table_index + 1;
+    }
+
+    void **table = paged->tables[table_index];
+    if (!table) {
+        table = paged->tables[table_index] = ecs_os_calloc(
+            ECS_SIZEOF(void*) * ECS_PAGE_TABLE_SIZE);
+    }
+
+    void **page = &table[page_index & (ECS_PAGE_TABLE_SIZE - 1)];
+    ecs_assert(*page == NULL, ECS_INTERNAL_ERROR, NULL);
+    *page = ecs_os_calloc(paged->elem_size * ECS_PAGE_SIZE);
+
+    int32_t offset = (int32_t)(index & (ECS_PAGE_SIZE - 1));
+    return ECS_OFFSET(*page, paged->elem_size * offset);
+}
+
+/* Call action for each element in allocated pages */
+#define paged_each(paged, T, var, ...)\
+    {\
+        int32_t t_i, p_i;\
+        for (t_i = 0; t_i < (paged)->table_count; t_i ++) {\
+            void **p_t = (paged)->tables[t_i];\
+            if (!p_t) {\
+                continue;\
+            }\
+            for (p_i = 0; p_i < ECS_PAGE_TABLE_SIZE; p_i ++) {\
+                T *var = p_t[p_i];\
+                if (var) {\
+                    int32_t e_i;\
+                    for (e_i = 0; e_i < ECS_PAGE_SIZE; e_i ++, var ++) {\
+                        __VA_ARGS__\
+                    }\
+                }\
+            }\
+        }\
+    }
+
 /* Evaluate component monitor. If a monitored entity changed it will have set a
  * flag in one of the world's component monitors. Queries can register 
  * themselves with component monitors to determine whether they need to rematch
@@ -11177,26 +13625,33 @@ void eval_component_monitor(
         return;
     }
 
-    ecs_vector_t *eval[ECS_HI_COMPONENT_ID];
-    int32_t eval_count = 0;
+    /* Take ownership of the dirty list, so that components marked while
+     * notifying queries are evaluated next time */
+    ecs_vector_t *dirty = mon->dirty;
+    mon->dirty = NULL;
+    mon->rematch = false;
 
-    int32_t i;
-    for (i = 0; i < ECS_HI_COMPONENT_ID; i ++) {
-        if (mon->dirty_flags[i]) {
-            eval[eval_count ++] = mon->monitors[i];
-            mon->dirty_flags[i] = 0;
-        }
-    }
+    ecs_vector_each(dirty, ecs_entity_t, component, {
+        ecs_monitor_queries_t *m = paged_get(&mon->monitors, *component);
+        ecs_assert(m != NULL, ECS_INTERNAL_ERROR, NULL);
+        m->dirty = false;
+    });
 
-    for (i = 0; i < eval_count; i ++) {
-        ecs_vector_each(eval[i], ecs_query_t*, q_ptr, {
+    ecs_vector_each(dirty, ecs_entity_t, component, {
+        ecs_monitor_queries_t *m = paged_get(&mon->monitors, *component);
+        ecs_vector_each(m->queries, ecs_query_t*, q_ptr, {
             ecs_query_notify(world, *q_ptr, &(ecs_query_event_t) {
                 .kind = EcsQueryTableRematch
             });
         });
+    });
+
+    if (!mon->dirty) {
+        ecs_vector_clear(dirty);
+        mon->dirty = dirty;
+    } else {
+        ecs_vector_free(dirty);
     }
-    
-    mon->rematch = false;
 }
 
 void ecs_component_monitor_mark(
@@ -11205,8 +13660,11 @@ void ecs_component_monitor_mark(
 {
     /* Only flag if there are actually monitors registered, so that we
      * don't waste cycles evaluating monitors if there's no interest */
-    if (mon->monitors[component]) {
-        mon->dirty_flags[component] = true;
+    ecs_monitor_queries_t *m = paged_get(&mon->monitors, component);
+    if (m && m->queries && !m->dirty) {
+        m->dirty = true;
+        ecs_entity_t *elem = ecs_vector_add(&mon->dirty, ecs_entity_t);
+        *elem = component;
         mon->rematch = true;
     }
 }
@@ -11219,23 +13677,35 @@ void ecs_component_monitor_register(
     ecs_assert(mon != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(query != NULL, ECS_INTERNAL_ERROR, NULL);
 
-    /* Ignore component ids > ECS_HI_COMPONENT_ID */
-    if(component >= ECS_HI_COMPONENT_ID) {
+    /* Ignore ids with roles */
+    if (component & ECS_ROLE_MASK) {
         return;
-    }    
+    }
 
-    ecs_query_t **q = ecs_vector_add(&mon->monitors[component], ecs_query_t*);
+    ecs_monitor_queries_t *m = paged_ensure(&mon->monitors, component);
+    ecs_query_t **q = ecs_vector_add(&m->queries, ecs_query_t*);
     *q = query;
 }
 
+static
+void ecs_component_monitor_init(
+    ecs_component_monitor_t *mon)
+{
+    paged_init(&mon->monitors, ECS_SIZEOF(ecs_monitor_queries_t));
+    mon->dirty = NULL;
+    mon->rematch = false;
+}
+
 static
 void ecs_component_monitor_free(
     ecs_component_monitor_t *mon)
 {
-    int i;
-    for (i = 0; i < ECS_HI_COMPONENT_ID; i ++) {
-        ecs_vector_free(mon->monitors[i]);
-    }
+    paged_each(&mon->monitors, ecs_monitor_queries_t, m, {
+        ecs_vector_free(m->queries);
+    });
+
+    paged_fini(&mon->monitors);
+    ecs_vector_free(mon->dirty);
 }
 
 static
@@ -11251,6 +13721,10 @@ void init_store(ecs_world_t *world) {
 
     /* Initialize table map */
     world->store.table_map = ecs_map_new(ecs_vector_t*, 8);
+    world->store.type_index = ecs_map_new(ecs_table_t*, 8);
+
+    /* Initialize component index */
+    world->store.component_tables = ecs_map_new(ecs_vector_t*, 8);
 
     /* Initialize one root table per stage */
     ecs_init_root_table(world);
@@ -11262,9 +13736,19 @@ void clean_tables(
 {
     int32_t i, count = ecs_sparse_count(world->store.tables);
 
+    /* Free chunks before the tables that own their type */
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *t = ecs_sparse_get(world->store.tables, ecs_table_t, i);
+        if (t->chunk_head) {
+            ecs_table_free(world, t);
+        }
+    }
+
     for (i = 0; i < count; i ++) {
         ecs_table_t *t = ecs_sparse_get(world->store.tables, ecs_table_t, i);
-        ecs_table_free(world, t);
+        if (!t->chunk_head) {
+            ecs_table_free(world, t);
+        }
     }
 
     /* Clear the root table */
@@ -11287,6 +13771,113 @@ void fini_store(ecs_world_t *world) {
     }
     
     ecs_map_free(world->store.table_map);
+    ecs_map_free(world->store.type_index);
+
+    it = ecs_map_iter(world->store.component_tables);
+    while ((tables = ecs_map_next_ptr(&it, ecs_vector_t*, NULL))) {
+        ecs_vector_free(tables);
+    }
+
+    ecs_map_free(world->store.component_tables);
+
+    it = ecs_map_iter(world->store.retired_types);
+    ecs_vector_t *types;
+    while ((types = ecs_map_next_ptr(&it, ecs_vector_t*, NULL))) {
+        ecs_vector_each(types, ecs_type_t, type_ptr, {
+            ecs_vector_free((ecs_vector_t*)*type_ptr);
+        });
+        ecs_vector_free(types);
+    }
+
+    ecs_map_free(world->store.retired_types);
+    ecs_vector_free(world->gc_queue);
+}
+
+/* Default allocator of memory pools */
+static
+void* os_pool_malloc(
+    void *ctx,
+    ecs_size_t size)
+{
+    (void)ctx;
+    return ecs_os_malloc(size);
+}
+
+static
+void* os_pool_realloc(
+    void *ctx,
+    void *ptr,
+    ecs_size_t size)
+{
+    (void)ctx;
+    return ecs_os_realloc(ptr, size);
+}
+
+static
+void os_pool_free(
+    void *ctx,
+    void *ptr)
+{
+    (void)ctx;
+    ecs_os_free(ptr);
+}
+
+static
+void set_pool_allocator(
+    ecs_pool_t *pool,
+    const ecs_allocator_t *allocator)
+{
+    if (allocator) {
+        ecs_assert(allocator->malloc_ != NULL, ECS_INVALID_PARAMETER, NULL);
+        ecs_assert(allocator->realloc_ != NULL, ECS_INVALID_PARAMETER, NULL);
+        ecs_assert(allocator->free_ != NULL, ECS_INVALID_PARAMETER, NULL);
+        pool->allocator = *allocator;
+    } else {
+        pool->allocator = (ecs_allocator_t){
+            .malloc_ = os_pool_malloc,
+            .realloc_ = os_pool_realloc,
+            .free_ = os_pool_free
+        };
+    }
+}
+
+static
+ecs_pool_t* pool_new(
+    ecs_pool_kind_t kind,
+    const ecs_allocator_t *allocator)
+{
+    ecs_pool_t *result = ecs_os_calloc(ECS_SIZEOF(ecs_pool_t));
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+    result->kind = kind;
+    set_pool_allocator(result, allocator);
+    return result;
+}
+
+static
+void init_pools(
+    ecs_world_t *world)
+{
+    int32_t i;
+    for (i = 0; i < EcsPoolCount; i ++) {
+        world->pools[i] = pool_new((ecs_pool_kind_t)i, NULL);
+    }
+    world->retired_pools = NULL;
+}
+
+/* Pools are freed last, as all table storage must be released first */
+static
+void fini_pools(
+    ecs_world_t *world)
+{
+    int32_t i;
+    for (i = 0; i < EcsPoolCount; i ++) {
+        ecs_os_free(world->pools[i]);
+    }
+
+    ecs_vector_each(world->retired_pools, ecs_pool_t*, pool, {
+        ecs_os_free(*pool);
+    });
+    ecs_vector_free(world->retired_pools);
 }
 
 /* -- Public functions -- */
@@ -11313,9 +13904,7 @@ ecs_world_t *ecs_mini(void) {
     ecs_assert(world != NULL, ECS_OUT_OF_MEMORY, NULL);
 
     world->magic = ECS_WORLD_MAGIC;
-    memset(&world->c_info, 0, sizeof(ecs_c_info_t) * ECS_HI_COMPONENT_ID); 
-
-    world->t_info = ecs_map_new(ecs_c_info_t, 0);  
+    paged_init(&world->c_info, ECS_SIZEOF(ecs_c_info_t));
     world->fini_actions = NULL; 
 
     world->aliases = NULL;
@@ -11323,10 +13912,14 @@ ecs_world_t *ecs_mini(void) {
     world->queries = ecs_vector_new(ecs_query_t*, 0);
     world->fini_tasks = ecs_vector_new(ecs_entity_t, 0);
     world->child_tables = NULL;
+    world->name_index = NULL;
+    world->name_entries = NULL;
+    world->name_pending = NULL;
+    world->name_index_dirty = true;
     world->name_prefix = NULL;
 
-    memset(&world->component_monitors, 0, sizeof(world->component_monitors));
-    memset(&world->parent_monitors, 0, sizeof(world->parent_monitors));
+    ecs_component_monitor_init(&world->component_monitors);
+    ecs_component_monitor_init(&world->parent_monitors);
 
     world->type_handles = ecs_map_new(ecs_entity_t, 0);
     world->on_activate_components = ecs_map_new(ecs_on_demand_in_t, 0);
@@ -11337,6 +13930,7 @@ ecs_world_t *ecs_mini(void) {
     world->workers = NULL;
     world->workers_waiting = 0;
     world->workers_running = 0;
+    world->sync_spin_count = ECS_DEFAULT_SYNC_SPIN_COUNT;
     world->quit_workers = false;
     world->in_progress = false;
     world->is_merging = false;
@@ -11363,6 +13957,7 @@ ecs_world_t *ecs_mini(void) {
     world->stats.sleep_err = 0;
     world->stats.system_time_total = 0;
     world->stats.merge_time_total = 0;
+    world->stats.sync_wait_time_total = 0;
     world->stats.world_time_total = 0;
     world->stats.frame_count_total = 0;
     world->stats.merge_count_total = 0;
@@ -11373,6 +13968,15 @@ ecs_world_t *ecs_mini(void) {
 
     world->fps_sleep = 0;
 
+    world->column_alignment = 0;
+    world->cold_part_count = 0;
+    init_pools(world);
+
+    world->gc_reclaim_after = 0;
+    world->gc_delete_after = 0;
+    world->gc_queue = NULL;
+    world->snapshot_count = 0;
+
     world->context = NULL;
 
     world->arg_fps = 0;
@@ -11511,6 +14115,8 @@ void ecs_set_component_actions_w_entity(
             ECS_INCONSISTENT_COMPONENT_ACTION, NULL);
         ecs_assert(c_info->lifecycle.move == lifecycle->move, 
             ECS_INCONSISTENT_COMPONENT_ACTION, NULL);
+        ecs_assert(c_info->lifecycle.relocatable == lifecycle->relocatable, 
+            ECS_INCONSISTENT_COMPONENT_ACTION, NULL);
     } else {
         c_info->component = component;
         c_info->lifecycle = *lifecycle;
@@ -11539,6 +14145,48 @@ bool ecs_component_has_actions(
     return (c_info != NULL) && c_info->lifecycle_set;
 }
 
+void ecs_set_component_cold_w_entity(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    ecs_entity_t cold)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(component != cold, ECS_INVALID_PARAMETER, NULL);
+
+#ifndef NDEBUG
+    const EcsComponent *component_ptr = ecs_get(world, component, EcsComponent);
+    const EcsComponent *cold_ptr = ecs_get(world, cold, EcsComponent);
+
+    /* Both parts must be components with data */
+    ecs_assert(component_ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(component_ptr->size != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(cold_ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(cold_ptr->size != 0, ECS_INVALID_PARAMETER, NULL);
+#endif
+
+    ecs_c_info_t *c_info = ecs_get_or_create_c_info(world, component);
+    if (c_info->cold == cold) {
+        return;
+    }
+
+    /* Existing entities with the component would not have the cold part */
+    ecs_assert(!ecs_table_index_count(world, component, false), 
+        ECS_INVALID_OPERATION, NULL);
+
+    /* A component can have one cold part, and a cold part can't be split */
+    ecs_assert(!c_info->cold, ECS_INCONSISTENT_COMPONENT_ACTION, NULL);
+    ecs_assert(!c_info->hot, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_c_info_t *cold_info = ecs_get_or_create_c_info(world, cold);
+    ecs_assert(!cold_info->hot, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(!cold_info->cold, ECS_INVALID_PARAMETER, NULL);
+
+    c_info->cold = cold;
+    cold_info->hot = component;
+    world->cold_part_count ++;
+}
+
 void ecs_atfini(
     ecs_world_t *world,
     ecs_fini_action_t action,
@@ -11599,20 +14247,12 @@ static
 void fini_component_lifecycle(
     ecs_world_t *world)
 {
-    int32_t i;
-    for (i = 0; i < ECS_HI_COMPONENT_ID; i ++) {
-        ecs_vector_free(world->c_info[i].on_add);
-        ecs_vector_free(world->c_info[i].on_remove);
-    }
-
-    ecs_map_iter_t it = ecs_map_iter(world->t_info);
-    ecs_c_info_t *c_info;
-    while ((c_info = ecs_map_next(&it, ecs_c_info_t, NULL))) {
+    paged_each(&world->c_info, ecs_c_info_t, c_info, {
         ecs_vector_free(c_info->on_add);
         ecs_vector_free(c_info->on_remove);
-    }    
+    });
 
-    ecs_map_free(world->t_info);
+    paged_fini(&world->c_info);
 }
 
 /* Cleanup queries */
@@ -11681,6 +14321,9 @@ void fini_misc(
     on_demand_in_map_deinit(world->on_enable_components);
     ecs_map_free(world->type_handles);
     ecs_vector_free(world->fini_tasks);
+    ecs_vector_free(world->deferred_writes);
+    ecs_vector_free(world->deferred_write_order);
+    ecs_vector_free(world->deferred_write_slices);
     ecs_component_monitor_free(&world->component_monitors);
     ecs_component_monitor_free(&world->parent_monitors);
 }
@@ -11713,11 +14356,14 @@ int ecs_fini(
     fini_queries(world);
 
     fini_child_tables(world);
+    ecs_name_index_fini(world);
 
     fini_aliases(world);
 
     fini_misc(world);
 
+    fini_pools(world);
+
     /* In case the application tries to use the memory of the freed world, this
      * will trigger an assert */
     world->magic = 0;
@@ -11844,6 +14490,113 @@ void ecs_set_target_fps(
     }
 }
 
+void ecs_set_table_gc(
+    ecs_world_t *world,
+    int32_t reclaim_after,
+    int32_t delete_after)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(reclaim_after >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(delete_after >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    bool was_enabled = world->gc_reclaim_after || world->gc_delete_after;
+
+    world->gc_reclaim_after = reclaim_after;
+    world->gc_delete_after = delete_after;
+
+    /* Tables that became empty while collection was disabled have not been
+     * queued, so add them now. Their empty count starts at this frame. */
+    if (!was_enabled) {
+        int32_t i, count = ecs_sparse_count(world->store.tables);
+        for (i = 0; i < count; i ++) {
+            ecs_table_t *table = ecs_sparse_get(
+                world->store.tables, ecs_table_t, i);
+            if (!ecs_table_count(table)) {
+                ecs_table_gc_enqueue(world, table);
+            }
+        }
+    }
+}
+
+void ecs_set_column_alignment(
+    ecs_world_t *world,
+    int32_t alignment)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(!world->snapshot_count, ECS_INVALID_OPERATION, NULL);
+    ecs_assert(alignment >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(alignment <= ECS_MAX_COLUMN_ALIGNMENT, 
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(!(alignment & (alignment - 1)), ECS_INVALID_PARAMETER, NULL);
+
+    if (world->column_alignment == alignment) {
+        return;
+    }
+
+    world->column_alignment = alignment;
+
+    int32_t i, count = ecs_sparse_count(world->store.tables);
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *table = ecs_sparse_get(
+            world->store.tables, ecs_table_t, i);
+        ecs_table_realign_columns(world, table);
+    }
+}
+
+void ecs_set_table_chunk_size(
+    ecs_world_t *world,
+    int32_t chunk_size)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(chunk_size >= 0, ECS_INVALID_PARAMETER, NULL);
+    world->table_chunk_size = chunk_size;
+}
+
+void ecs_set_allocator(
+    ecs_world_t *world,
+    ecs_pool_kind_t kind,
+    const ecs_allocator_t *allocator)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(kind < EcsPoolCount, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_pool_t *pool = world->pools[kind];
+    ecs_pool_stats_t *stats = &pool->stats;
+
+    /* If memory in the pool is still in use it has to be released with the
+     * current allocator, so keep the pool around and create a new one */
+    if (stats->malloc_count != stats->free_count) {
+        ecs_pool_t **elem = ecs_vector_add(&world->retired_pools, ecs_pool_t*);
+        *elem = pool;
+        world->pools[kind] = pool_new(kind, allocator);
+    } else {
+        set_pool_allocator(pool, allocator);
+    }
+}
+
+void ecs_get_pool_stats(
+    ecs_world_t *world,
+    ecs_pool_kind_t kind,
+    ecs_pool_stats_t *stats)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(kind < EcsPoolCount, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(stats != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    *stats = world->pools[kind]->stats;
+
+    ecs_vector_each(world->retired_pools, ecs_pool_t*, pool_ptr, {
+        ecs_pool_t *pool = *pool_ptr;
+        if (pool->kind == kind) {
+            stats->malloc_count += pool->stats.malloc_count;
+            stats->realloc_count += pool->stats.realloc_count;
+            stats->free_count += pool->stats.free_count;
+            stats->bytes_allocated += pool->stats.bytes_allocated;
+        }
+    });
+}
+
 void* ecs_get_context(
     ecs_world_t *world)
 {
@@ -11960,19 +14713,14 @@ ecs_c_info_t * ecs_get_c_info(
     ecs_world_t *world,
     ecs_entity_t component)
 {
-    ecs_assert(component != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(!(component & ECS_ROLE_MASK), ECS_INTERNAL_ERROR, NULL);
-
-    if (component < ECS_HI_COMPONENT_ID) {
-        ecs_c_info_t *c_info = &world->c_info[component];
-        if (c_info->component) {
-            ecs_assert(c_info->component == component, ECS_INTERNAL_ERROR, NULL);
-            return c_info;
-        } else {
-            return NULL;
-        }
+    ecs_assert(component != 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!(component & ECS_ROLE_MASK), ECS_INTERNAL_ERROR, NULL);
+
+    ecs_c_info_t *c_info = paged_get(&world->c_info, component);
+    if (c_info && c_info->component == component) {
+        return c_info;
     } else {
-        return ecs_map_get(world->t_info, ecs_c_info_t, component);
+        return NULL;
     }
 }
 
@@ -11982,16 +14730,17 @@ ecs_c_info_t * ecs_get_or_create_c_info(
 {    
     ecs_c_info_t *c_info = ecs_get_c_info(world, component);
     if (!c_info) {
-        if (component < ECS_HI_COMPONENT_ID) {
-            c_info = &world->c_info[component];
-            ecs_assert(c_info->component == 0, ECS_INTERNAL_ERROR, NULL);
-            c_info->component = component;
-        } else {
-            ecs_c_info_t t_info = { 0 };
-            ecs_map_set(world->t_info, component, &t_info);
-            c_info = ecs_map_get(world->t_info, ecs_c_info_t, component);
-            ecs_assert(c_info != NULL, ECS_INTERNAL_ERROR, NULL); 
+        c_info = paged_ensure(&world->c_info, component);
+
+        /* If the id was used by a previous generation of the entity, the
+         * element still holds the data of the deleted component */
+        if (c_info->component) {
+            ecs_vector_free(c_info->on_add);
+            ecs_vector_free(c_info->on_remove);
+            ecs_os_memset(c_info, 0, ECS_SIZEOF(ecs_c_info_t));
         }
+
+        c_info->component = component;
     }
 
     return c_info;
@@ -12186,6 +14935,10 @@ void ecs_frame_end(
         ecs_stage_merge_post_frame(world, stage);
     });        
 
+    if (world->gc_queue) {
+        ecs_run_table_gc(world);
+    }
+
     if (world->locking_enabled) {
         ecs_unlock(world);
 
@@ -12215,6 +14968,115 @@ void ecs_notify_queries(
     }    
 }
 
+void ecs_table_gc_enqueue(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    /* Also set frame when table is already queued, as a table can be emptied
+     * more than once before it is collected */
+    table->gc_frame = world->stats.frame_count_total;
+
+    if (!world->gc_reclaim_after && !world->gc_delete_after) {
+        return;
+    }
+
+    /* The root table is never collected */
+    if (!table->id || table->gc_index != -1 || world->is_fini) {
+        return;
+    }
+
+    table->gc_index = ecs_vector_count(world->gc_queue);
+    ecs_table_t **elem = ecs_vector_add(&world->gc_queue, ecs_table_t*);
+    *elem = table;
+}
+
+static
+void table_gc_dequeue(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    int32_t gc_index = table->gc_index;
+    if (gc_index == -1) {
+        return;
+    }
+
+    ecs_table_t **gc_queue = ecs_vector_first(world->gc_queue, ecs_table_t*);
+    int32_t gc_last = ecs_vector_count(world->gc_queue) - 1;
+    gc_queue[gc_index] = gc_queue[gc_last];
+    gc_queue[gc_index]->gc_index = gc_index;
+    ecs_vector_remove_last(world->gc_queue);
+    table->gc_index = -1;
+}
+
+/* Tables that are used as scope by a stage are cached by the stage, and cannot
+ * be deleted */
+static
+bool table_in_use(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    if (world->stage.scope_table == table || 
+        world->temp_stage.scope_table == table) 
+    {
+        return true;
+    }
+
+    ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
+        if (stage->scope_table == table) {
+            return true;
+        }
+    });
+
+    return false;
+}
+
+int32_t ecs_run_table_gc(
+    ecs_world_t *world)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_OPERATION, NULL);
+
+    /* Snapshots store pointers to tables, so tables cannot be deleted while a
+     * snapshot is alive */
+    if (world->snapshot_count) {
+        return 0;
+    }
+
+    int32_t reclaim_after = world->gc_reclaim_after;
+    int32_t delete_after = world->gc_delete_after;
+    int32_t frame = world->stats.frame_count_total;
+    int32_t deleted = 0;
+
+    /* Iterate backwards, as tables are swapped out of the queue */
+    int32_t i;
+    for (i = ecs_vector_count(world->gc_queue) - 1; i >= 0; i --) {
+        ecs_table_t *table = *ecs_vector_get(world->gc_queue, ecs_table_t*, i);
+        int32_t empty_frames = frame - table->gc_frame;
+
+        if (ecs_table_count(table)) {
+            table_gc_dequeue(world, table);
+        } else if (delete_after && empty_frames >= delete_after) {
+            /* A table that owns the type of its chunks is deleted after the
+             * chunks, which are in the queue when they are empty */
+            if (!table_in_use(world, table) && 
+                !ecs_vector_count(table->chunks)) 
+            {
+                ecs_delete_table(world, table);
+                deleted ++;
+            }
+        } else if (reclaim_after && empty_frames >= reclaim_after) {
+            ecs_table_reclaim(world, table);
+
+            /* Keep table in queue if it still needs to be deleted */
+            if (!delete_after) {
+                table_gc_dequeue(world, table);
+            }
+        }
+    }
+
+    return deleted;
+}
+
 void ecs_delete_table(
     ecs_world_t *world,
     ecs_table_t *table)
@@ -12228,6 +15090,23 @@ void ecs_delete_table(
 
     uint32_t id = table->id;
 
+    /* Remove table from garbage collection queue */
+    table_gc_dequeue(world, table);
+
+    /* Remove table from component index and type lookup maps */
+    ecs_table_index_remove(world, table);
+
+    /* Keep the type around so that if the table is recreated, it gets the same
+     * type handle. Type handles are stored by the application, and are
+     * compared by pointer. The type of a chunk is owned by the first chunk. */
+    if (table->chunk_head) {
+        ecs_table_remove_chunk(table);
+    } else {
+        ecs_assert(!ecs_vector_count(table->chunks), 
+            ECS_INTERNAL_ERROR, NULL);
+        ecs_table_retire_type(world, table);
+    }
+
     /* Free resources associated with table */
     ecs_table_free(world, table);
 
@@ -12575,320 +15454,150 @@ int32_t ecs_switch_next(
     return nodes[element].next;
 }
 
-#ifndef _MSC_VER
-#pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
 #endif
 
 /*
 -------------------------------------------------------------------------------
-lookup3.c, by Bob Jenkins, May 2006, Public Domain.
-  http://burtleburtle.net/bob/c/lookup3.c
+Hash function based on wyhash, by Wang Yi. Public domain (The Unlicense).
+  https://github.com/wangyi-fudan/wyhash
+
+Hashes are used to find tables by their type, which is an array of 8 byte ids
+that is typically between 8 and 64 bytes long, and to find entities by name.
+The function mixes 16 bytes at a time with a single 64x64 -> 128 bit multiply,
+which is several times faster than a byte oriented hash for these inputs while
+still distributing all bits of the result evenly.
+
+To use a different hash function, replace hash_bytes. ecs_hash is the only
+function that should be called by the rest of the code.
 -------------------------------------------------------------------------------
 */
 
-#ifdef _MSC_VER
-//FIXME
-#else
-#include <sys/param.h>  /* attempt to define endianness */
-#endif
-#ifdef linux
-# include <endian.h>    /* attempt to define endianness */
-#endif
+static const uint64_t hash_secret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+    0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+};
 
-/*
- * My best guess at if you are big-endian or little-endian.  This may
- * need adjustment.
- */
-#if (defined(__BYTE_ORDER) && defined(__LITTLE_ENDIAN) && \
-     __BYTE_ORDER == __LITTLE_ENDIAN) || \
-    (defined(i386) || defined(__i386__) || defined(__i486__) || \
-     defined(__i586__) || defined(__i686__) || defined(vax) || defined(MIPSEL))
-# define HASH_LITTLE_ENDIAN 1
-#elif (defined(__BYTE_ORDER) && defined(__BIG_ENDIAN) && \
-       __BYTE_ORDER == __BIG_ENDIAN) || \
-      (defined(sparc) || defined(POWERPC) || defined(mc68000) || defined(sel))
-# define HASH_LITTLE_ENDIAN 0
+/* Multiply a and b, store the low 64 bits of the result in a and the high 64
+ * bits in b */
+static
+void hash_mum(
+    uint64_t *a,
+    uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
 #else
-# define HASH_LITTLE_ENDIAN 0
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm_0 = ha * lb, rm_1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm_0 << 32), c = t < rl;
+    uint64_t lo = t + (rm_1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm_0 >> 32) + (rm_1 >> 32) + c;
 #endif
-
-#define rot(x,k) (((x)<<(k)) | ((x)>>(32-(k))))
-
-/*
--------------------------------------------------------------------------------
-mix -- mix 3 32-bit values reversibly.
-
-This is reversible, so any information in (a,b,c) before mix() is
-still in (a,b,c) after mix().
-
-If four pairs of (a,b,c) inputs are run through mix(), or through
-mix() in reverse, there are at least 32 bits of the output that
-are sometimes the same for one pair and different for another pair.
-This was tested for:
-* pairs that differed by one bit, by two bits, in any combination
-  of top bits of (a,b,c), or in any combination of bottom bits of
-  (a,b,c).
-* "differ" is defined as +, -, ^, or ~^.  For + and -, I transformed
-  the output delta to a Gray code (a^(a>>1)) so a string of 1's (as
-  is commonly produced by subtraction) look like a single 1-bit
-  difference.
-* the base values were pseudorandom, all zero but one bit set, or 
-  all zero plus a counter that starts at zero.
-
-Some k values for my "a-=c; a^=rot(c,k); c+=b;" arrangement that
-satisfy this are
-    4  6  8 16 19  4
-    9 15  3 18 27 15
-   14  9  3  7 17  3
-Well, "9 15 3 18 27 15" didn't quite get 32 bits diffing
-for "differ" defined as + with a one-bit base and a two-bit delta.  I
-used http://burtleburtle.net/bob/hash/avalanche.html to choose 
-the operations, constants, and arrangements of the variables.
-
-This does not achieve avalanche.  There are input bits of (a,b,c)
-that fail to affect some output bits of (a,b,c), especially of a.  The
-most thoroughly mixed value is c, but it doesn't really even achieve
-avalanche in c.
-
-This allows some parallelism.  Read-after-writes are good at doubling
-the number of bits affected, so the goal of mixing pulls in the opposite
-direction as the goal of parallelism.  I did what I could.  Rotates
-seem to cost as much as shifts on every machine I could lay my hands
-on, and rotates are much kinder to the top and bottom bits, so I used
-rotates.
--------------------------------------------------------------------------------
-*/
-#define mix(a,b,c) \
-{ \
-  a -= c;  a ^= rot(c, 4);  c += b; \
-  b -= a;  b ^= rot(a, 6);  a += c; \
-  c -= b;  c ^= rot(b, 8);  b += a; \
-  a -= c;  a ^= rot(c,16);  c += b; \
-  b -= a;  b ^= rot(a,19);  a += c; \
-  c -= b;  c ^= rot(b, 4);  b += a; \
 }
 
-/*
--------------------------------------------------------------------------------
-final -- final mixing of 3 32-bit values (a,b,c) into c
-
-Pairs of (a,b,c) values differing in only a few bits will usually
-produce values of c that look totally different.  This was tested for
-* pairs that differed by one bit, by two bits, in any combination
-  of top bits of (a,b,c), or in any combination of bottom bits of
-  (a,b,c).
-* "differ" is defined as +, -, ^, or ~^.  For + and -, I transformed
-  the output delta to a Gray code (a^(a>>1)) so a string of 1's (as
-  is commonly produced by subtraction) look like a single 1-bit
-  difference.
-* the base values were pseudorandom, all zero but one bit set, or 
-  all zero plus a counter that starts at zero.
-
-These constants passed:
- 14 11 25 16 4 14 24
- 12 14 25 16 4 14 24
-and these came close:
-  4  8 15 26 3 22 24
- 10  8 15 26 3 22 24
- 11  8 15 26 3 22 24
--------------------------------------------------------------------------------
-*/
-#define final(a,b,c) \
-{ \
-  c ^= b; c -= rot(b,14); \
-  a ^= c; a -= rot(c,11); \
-  b ^= a; b -= rot(a,25); \
-  c ^= b; c -= rot(b,16); \
-  a ^= c; a -= rot(c,4);  \
-  b ^= a; b -= rot(a,14); \
-  c ^= b; c -= rot(b,24); \
+/* Multiply a and b, fold the 128 bit result into 64 bits */
+static
+uint64_t hash_mix(
+    uint64_t a,
+    uint64_t b)
+{
+    hash_mum(&a, &b);
+    return a ^ b;
 }
 
+static
+uint64_t hash_read64(
+    const uint8_t *p)
+{
+    uint64_t v;
+    ecs_os_memcpy(&v, p, 8);
+    return v;
+}
 
-/*
- * hashlittle2: return 2 32-bit hash values
- *
- * This is identical to hashlittle(), except it returns two 32-bit hash
- * values instead of just one.  This is good enough for hash table
- * lookup with 2^^64 buckets, or if you want a second hash if you're not
- * happy with the first, or if you want a probably-unique 64-bit ID for
- * the key.  *pc is better mixed than *pb, so use *pc first.  If you want
- * a 64-bit value do something like "*pc + (((uint64_t)*pb)<<32)".
- */
 static
-void hashlittle2( 
-  const void *key,       /* the key to hash */
-  size_t      length,    /* length of the key */
-  uint32_t   *pc,        /* IN: primary initval, OUT: primary hash */
-  uint32_t   *pb)        /* IN: secondary initval, OUT: secondary hash */
+uint64_t hash_read32(
+    const uint8_t *p)
 {
-  uint32_t a,b,c;                                          /* internal state */
-  union { const void *ptr; size_t i; } u;     /* needed for Mac Powerbook G4 */
+    uint32_t v;
+    ecs_os_memcpy(&v, p, 4);
+    return v;
+}
 
-  /* Set up the internal state */
-  a = b = c = 0xdeadbeef + ((uint32_t)length) + *pc;
-  c += *pb;
+/* Read 1 to 3 bytes */
+static
+uint64_t hash_read3(
+    const uint8_t *p,
+    size_t len)
+{
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[len >> 1]) << 8) |
+        p[len - 1];
+}
 
-  u.ptr = key;
-  if (HASH_LITTLE_ENDIAN && ((u.i & 0x3) == 0)) {
-    const uint32_t *k = (const uint32_t *)key;         /* read 32-bit chunks */
-    const uint8_t  *k8;
-    (void)k8;
+static
+uint64_t hash_bytes(
+    const void *data,
+    size_t len,
+    uint64_t seed)
+{
+    const uint8_t *p = data;
+    const uint64_t *s = hash_secret;
+    uint64_t a, b;
+
+    seed ^= hash_mix(seed ^ s[0], s[1]);
+
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t off = (len >> 3) << 2;
+            a = (hash_read32(p) << 32) | hash_read32(p + off);
+            b = (hash_read32(p + len - 4) << 32) |
+                hash_read32(p + len - 4 - off);
+        } else if (len > 0) {
+            a = hash_read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see_1 = seed, see_2 = seed;
+            do {
+                seed = hash_mix(hash_read64(p) ^ s[1],
+                    hash_read64(p + 8) ^ seed);
+                see_1 = hash_mix(hash_read64(p + 16) ^ s[2],
+                    hash_read64(p + 24) ^ see_1);
+                see_2 = hash_mix(hash_read64(p + 32) ^ s[3],
+                    hash_read64(p + 40) ^ see_2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see_1 ^ see_2;
+        }
 
-    /*------ all but last block: aligned reads and affect 32 bits of (a,b,c) */
-    while (length > 12)
-    {
-      a += k[0];
-      b += k[1];
-      c += k[2];
-      mix(a,b,c);
-      length -= 12;
-      k += 3;
-    }
-
-    /*----------------------------- handle the last (probably partial) block */
-    /* 
-     * "k[2]&0xffffff" actually reads beyond the end of the string, but
-     * then masks off the part it's not allowed to read.  Because the
-     * string is aligned, the masked-off tail is in the same word as the
-     * rest of the string.  Every machine with memory protection I've seen
-     * does it on word boundaries, so is OK with this.  But VALGRIND will
-     * still catch it and complain.  The masking trick does make the hash
-     * noticably faster for short strings (like English words).
-     */
-#ifndef VALGRIND
+        while (i > 16) {
+            seed = hash_mix(hash_read64(p) ^ s[1], hash_read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
 
-    switch(length)
-    {
-    case 12: c+=k[2]; b+=k[1]; a+=k[0]; break;
-    case 11: c+=k[2]&0xffffff; b+=k[1]; a+=k[0]; break;
-    case 10: c+=k[2]&0xffff; b+=k[1]; a+=k[0]; break;
-    case 9 : c+=k[2]&0xff; b+=k[1]; a+=k[0]; break;
-    case 8 : b+=k[1]; a+=k[0]; break;
-    case 7 : b+=k[1]&0xffffff; a+=k[0]; break;
-    case 6 : b+=k[1]&0xffff; a+=k[0]; break;
-    case 5 : b+=k[1]&0xff; a+=k[0]; break;
-    case 4 : a+=k[0]; break;
-    case 3 : a+=k[0]&0xffffff; break;
-    case 2 : a+=k[0]&0xffff; break;
-    case 1 : a+=k[0]&0xff; break;
-    case 0 : *pc=c; *pb=b; return;  /* zero length strings require no mixing */
-    }
-
-#else /* make valgrind happy */
-
-    k8 = (const uint8_t *)k;
-    switch(length)
-    {
-    case 12: c+=k[2]; b+=k[1]; a+=k[0]; break;
-    case 11: c+=((uint32_t)k8[10])<<16;  /* fall through */
-    case 10: c+=((uint32_t)k8[9])<<8;    /* fall through */
-    case 9 : c+=k8[8];                   /* fall through */
-    case 8 : b+=k[1]; a+=k[0]; break;
-    case 7 : b+=((uint32_t)k8[6])<<16;   /* fall through */
-    case 6 : b+=((uint32_t)k8[5])<<8;    /* fall through */
-    case 5 : b+=k8[4];                   /* fall through */
-    case 4 : a+=k[0]; break;
-    case 3 : a+=((uint32_t)k8[2])<<16;   /* fall through */
-    case 2 : a+=((uint32_t)k8[1])<<8;    /* fall through */
-    case 1 : a+=k8[0]; break;
-    case 0 : *pc=c; *pb=b; return;  /* zero length strings require no mixing */
-    }
-
-#endif /* !valgrind */
-
-  } else if (HASH_LITTLE_ENDIAN && ((u.i & 0x1) == 0)) {
-    const uint16_t *k = (const uint16_t *)key;         /* read 16-bit chunks */
-    const uint8_t  *k8;
-
-    /*--------------- all but last block: aligned reads and different mixing */
-    while (length > 12)
-    {
-      a += k[0] + (((uint32_t)k[1])<<16);
-      b += k[2] + (((uint32_t)k[3])<<16);
-      c += k[4] + (((uint32_t)k[5])<<16);
-      mix(a,b,c);
-      length -= 12;
-      k += 6;
+        a = hash_read64(p + i - 16);
+        b = hash_read64(p + i - 8);
     }
 
-    /*----------------------------- handle the last (probably partial) block */
-    k8 = (const uint8_t *)k;
-    switch(length)
-    {
-    case 12: c+=k[4]+(((uint32_t)k[5])<<16);
-             b+=k[2]+(((uint32_t)k[3])<<16);
-             a+=k[0]+(((uint32_t)k[1])<<16);
-             break;
-    case 11: c+=((uint32_t)k8[10])<<16;     /* fall through */
-    case 10: c+=k[4];
-             b+=k[2]+(((uint32_t)k[3])<<16);
-             a+=k[0]+(((uint32_t)k[1])<<16);
-             break;
-    case 9 : c+=k8[8];                      /* fall through */
-    case 8 : b+=k[2]+(((uint32_t)k[3])<<16);
-             a+=k[0]+(((uint32_t)k[1])<<16);
-             break;
-    case 7 : b+=((uint32_t)k8[6])<<16;      /* fall through */
-    case 6 : b+=k[2];
-             a+=k[0]+(((uint32_t)k[1])<<16);
-             break;
-    case 5 : b+=k8[4];                      /* fall through */
-    case 4 : a+=k[0]+(((uint32_t)k[1])<<16);
-             break;
-    case 3 : a+=((uint32_t)k8[2])<<16;      /* fall through */
-    case 2 : a+=k[0];
-             break;
-    case 1 : a+=k8[0];
-             break;
-    case 0 : *pc=c; *pb=b; return;  /* zero length strings require no mixing */
-    }
-
-  } else {                        /* need to read the key one byte at a time */
-    const uint8_t *k = (const uint8_t *)key;
-
-    /*--------------- all but the last block: affect some 32 bits of (a,b,c) */
-    while (length > 12)
-    {
-      a += k[0];
-      a += ((uint32_t)k[1])<<8;
-      a += ((uint32_t)k[2])<<16;
-      a += ((uint32_t)k[3])<<24;
-      b += k[4];
-      b += ((uint32_t)k[5])<<8;
-      b += ((uint32_t)k[6])<<16;
-      b += ((uint32_t)k[7])<<24;
-      c += k[8];
-      c += ((uint32_t)k[9])<<8;
-      c += ((uint32_t)k[10])<<16;
-      c += ((uint32_t)k[11])<<24;
-      mix(a,b,c);
-      length -= 12;
-      k += 12;
-    }
-
-    /*-------------------------------- last block: affect all 32 bits of (c) */
-    switch(length)                   /* all the case statements fall through */
-    {
-    case 12: c+=((uint32_t)k[11])<<24;
-    case 11: c+=((uint32_t)k[10])<<16;
-    case 10: c+=((uint32_t)k[9])<<8;
-    case 9 : c+=k[8];
-    case 8 : b+=((uint32_t)k[7])<<24;
-    case 7 : b+=((uint32_t)k[6])<<16;
-    case 6 : b+=((uint32_t)k[5])<<8;
-    case 5 : b+=k[4];
-    case 4 : a+=((uint32_t)k[3])<<24;
-    case 3 : a+=((uint32_t)k[2])<<16;
-    case 2 : a+=((uint32_t)k[1])<<8;
-    case 1 : a+=k[0];
-             break;
-    case 0 : *pc=c; *pb=b; return;  /* zero length strings require no mixing */
-    }
-  }
-
-  final(a,b,c);
-  *pc=c; *pb=b;
+    a ^= s[1];
+    b ^= seed;
+    hash_mum(&a, &b);
+
+    return hash_mix(a ^ s[0] ^ len, b ^ s[1]);
 }
 
 void ecs_hash(
@@ -12896,18 +15605,60 @@ void ecs_hash(
     ecs_size_t length,
     uint64_t *result)
 {
-    uint32_t h_1 = 0;
-    uint32_t h_2 = 0;
+    *result = hash_bytes(data, ecs_to_size_t(length), 0);
+}
+
+
+/* Find the component of the filter with the fewest tables. Only the tables for
+ * this component have to be evaluated, instead of all tables in the world. */
+static
+ecs_entity_t select_filter_component(
+    ecs_world_t *world,
+    const ecs_filter_t *filter)
+{
+    if (!filter || !filter->include || filter->include_kind == EcsMatchAny) {
+        return 0;
+    }
+
+    ecs_entity_t *array = ecs_vector_first(filter->include, ecs_entity_t);
+    int32_t i, count = ecs_vector_count(filter->include);
+
+    ecs_entity_t result = 0;
+    int32_t min_count = -1;
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = array[i];
+        if (!ecs_table_index_supports(e)) {
+            continue;
+        }
 
-    hashlittle2(
-        data,
-        ecs_to_size_t(length),
-        &h_1,
-        &h_2);
+        int32_t table_count = ecs_table_index_count(world, e, true);
+        if (min_count == -1 || table_count < min_count) {
+            result = e;
+            min_count = table_count;
+        }
+    }
 
-    *result = h_1 | ((uint64_t)h_2 << 32);
+    return result;
 }
 
+static
+ecs_table_t* next_filter_table(
+    ecs_world_t *world,
+    ecs_filter_iter_t *iter)
+{
+    if (iter->component) {
+        return ecs_table_index_next(world, iter->component, true, 
+            &iter->index, &iter->base_index);
+    }
+
+    ecs_sparse_t *tables = iter->tables;
+    if (iter->index < ecs_sparse_count(tables)) {
+        return ecs_sparse_get(tables, ecs_table_t, iter->index ++);
+    }
+
+    return NULL;
+}
 
 ecs_iter_t ecs_filter_iter(
     ecs_world_t *world,
@@ -12916,7 +15667,9 @@ ecs_iter_t ecs_filter_iter(
     ecs_filter_iter_t iter = {
         .filter = filter ? *filter : (ecs_filter_t){0},
         .tables = world->store.tables,
-        .index = 0
+        .component = select_filter_component(world, filter),
+        .index = 0,
+        .base_index = 0
     };
 
     return (ecs_iter_t){
@@ -12929,14 +15682,9 @@ bool ecs_filter_next(
     ecs_iter_t *it)
 {
     ecs_filter_iter_t *iter = &it->iter.filter;
-    ecs_sparse_t *tables = iter->tables;
-    int32_t count = ecs_sparse_count(tables);
-    int32_t i;
+    ecs_table_t *table;
 
-    for (i = iter->index; i < count; i ++) {
-        ecs_table_t *table = ecs_sparse_get(tables, ecs_table_t, i);
-        ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
-        
+    while ((table = next_filter_table(it->world, iter))) {
         ecs_data_t *data = ecs_table_get_data(table);
 
         if (!data) {
@@ -12952,7 +15700,6 @@ bool ecs_filter_next(
         it->table_columns = data->columns;
         it->count = ecs_table_count(table);
         it->entities = ecs_vector_first(data->entities, ecs_entity_t);
-        iter->index = i + 1;
 
         return true;
     }
@@ -14935,6 +17682,55 @@ char* ecs_os_api_strdup(const char *str) {
     return result;
 }
 
+/* Default atomics use compiler intrinsics. Applications can override them
+ * with an implementation from their own threading library. */
+#if defined(__GNUC__) || defined(__clang__)
+static
+int ecs_os_api_ainc(int32_t *value) {
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static
+int ecs_os_api_adec(int32_t *value) {
+    return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static
+int32_t ecs_os_api_aload(const int32_t *value) {
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+}
+
+static
+void ecs_os_api_astore(int32_t *value, int32_t desired) {
+    __atomic_store_n(value, desired, __ATOMIC_SEQ_CST);
+}
+#define ECS_OS_API_HAS_ATOMICS
+#elif defined(_MSC_VER)
+#include <intrin.h>
+
+static
+int ecs_os_api_ainc(int32_t *value) {
+    return (int)_InterlockedIncrement((volatile long*)value);
+}
+
+static
+int ecs_os_api_adec(int32_t *value) {
+    return (int)_InterlockedDecrement((volatile long*)value);
+}
+
+static
+int32_t ecs_os_api_aload(const int32_t *value) {
+    return (int32_t)_InterlockedCompareExchange(
+        (volatile long*)(uintptr_t)value, 0, 0);
+}
+
+static
+void ecs_os_api_astore(int32_t *value, int32_t desired) {
+    _InterlockedExchange((volatile long*)value, desired);
+}
+#define ECS_OS_API_HAS_ATOMICS
+#endif
+
 /* Replace dots with underscores */
 static
 char *module_file_base(const char *module, char sep) {
@@ -15007,6 +17803,14 @@ void ecs_os_set_api_defaults(void)
     /* Strings */
     ecs_os_api.strdup_ = ecs_os_api_strdup;
 
+#ifdef ECS_OS_API_HAS_ATOMICS
+    /* Atomics */
+    ecs_os_api.ainc_ = ecs_os_api_ainc;
+    ecs_os_api.adec_ = ecs_os_api_adec;
+    ecs_os_api.aload_ = ecs_os_api_aload;
+    ecs_os_api.astore_ = ecs_os_api_astore;
+#endif
+
     /* Time */
     ecs_os_api.sleep_ = ecs_os_time_sleep;
     ecs_os_api.get_time_ = ecs_os_gettime;
@@ -15049,7 +17853,11 @@ bool ecs_os_has_threading(void) {
         (ecs_os_api.cond_signal_ != NULL) &&
         (ecs_os_api.cond_broadcast_ != NULL) &&
         (ecs_os_api.thread_new_ != NULL) &&
-        (ecs_os_api.thread_join_ != NULL);   
+        (ecs_os_api.thread_join_ != NULL) &&
+        (ecs_os_api.ainc_ != NULL) &&
+        (ecs_os_api.adec_ != NULL) &&
+        (ecs_os_api.aload_ != NULL) &&
+        (ecs_os_api.astore_ != NULL);   
 }
 
 bool ecs_os_has_time(void) {
@@ -15079,6 +17887,18 @@ bool ecs_os_has_modules(void) {
         (ecs_os_api.module_to_etc_ != NULL);
 }
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_WIN64)
+#include <intrin.h>
+#endif
+
 #ifdef FLECS_SYSTEMS_H
 #endif
 
@@ -16099,20 +18919,89 @@ bool ecs_query_match(
     return true;
 }
 
+/* Find the required component of the query with the fewest tables. Only tables
+ * for this component can match the query. */
+static
+ecs_entity_t select_query_component(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    bool *inherited_out)
+{
+    int32_t i, column_count = ecs_vector_count(query->sig.columns);
+    ecs_sig_column_t *columns = ecs_vector_first(
+        query->sig.columns, ecs_sig_column_t);
+
+    ecs_entity_t result = 0;
+    int32_t min_count = -1;
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_sig_column_t *column = &columns[i];
+        if (column->oper_kind != EcsOperAnd) {
+            continue;
+        }
+
+        ecs_sig_from_kind_t from_kind = column->from_kind;
+        if (from_kind != EcsFromAny && from_kind != EcsFromOwned) {
+            continue;
+        }
+
+        ecs_entity_t component = column->is.component;
+        if (!ecs_table_index_supports(component)) {
+            continue;
+        }
+
+        bool inherited = from_kind == EcsFromAny;
+        int32_t count = ecs_table_index_count(world, component, inherited);
+        if (min_count == -1 || count < min_count) {
+            result = component;
+            min_count = count;
+            *inherited_out = inherited;
+        }
+    }
+
+    return result;
+}
+
 /** Match existing tables against system (table is created before system) */
 static
 void match_tables(
     ecs_world_t *world,
     ecs_query_t *query)
 {
-    int32_t i, count = ecs_sparse_count(world->store.tables);
+    bool inherited = false;
+    ecs_entity_t component = select_query_component(world, query, &inherited);
 
-    for (i = 0; i < count; i ++) {
-        ecs_table_t *table = ecs_sparse_get(
-            world->store.tables, ecs_table_t, i);
+    if (component) {
+        /* Collect tables first, as matching may create new tables, which are
+         * matched with the query when they are created. */
+        ecs_vector_t *tables = NULL;
+        ecs_table_t *table;
+        int32_t index = 0, base_index = 0;
 
-        if (ecs_query_match(world, table, query, NULL)) {
-            add_table(world, query, table);
+        while ((table = ecs_table_index_next(
+            world, component, inherited, &index, &base_index))) 
+        {
+            ecs_table_t **elem = ecs_vector_add(&tables, ecs_table_t*);
+            *elem = table;
+        }
+
+        ecs_vector_each(tables, ecs_table_t*, table_ptr, {
+            if (ecs_query_match(world, *table_ptr, query, NULL)) {
+                add_table(world, query, *table_ptr);
+            }
+        });
+
+        ecs_vector_free(tables);
+    } else {
+        int32_t i, count = ecs_sparse_count(world->store.tables);
+
+        for (i = 0; i < count; i ++) {
+            ecs_table_t *table = ecs_sparse_get(
+                world->store.tables, ecs_table_t, i);
+
+            if (ecs_query_match(world, table, query, NULL)) {
+                add_table(world, query, table);
+            }
         }
     }
 
@@ -16122,75 +19011,106 @@ void match_tables(
 #define ELEM(ptr, size, index) ECS_OFFSET(ptr, size * index)
 
 static
-int32_t qsort_partition(
-    ecs_world_t *world,
-    ecs_table_t *table,
-    ecs_data_t *data,
+int compare_rows(
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t row_1,
+    int32_t row_2,
+    ecs_compare_action_t compare)
+{
+    return compare(entities[row_1], ELEM(ptr, size, row_1), 
+        entities[row_2], ELEM(ptr, size, row_2));
+}
+
+/* Merge two sorted ranges of row indices. If the ranges are already in order
+ * nothing needs to be merged. */
+static
+void merge_rows(
     ecs_entity_t *entities,
-    void *ptr,    
-    int32_t elem_size,
+    void *ptr,
+    int32_t size,
+    int32_t *rows,
+    int32_t *tmp,
     int32_t lo,
+    int32_t mid,
     int32_t hi,
     ecs_compare_action_t compare)
 {
-    int32_t p = (hi + lo) / 2;
-    void *pivot = ELEM(ptr, elem_size, p);
-    ecs_entity_t pivot_e = entities[p];
-    int32_t i = lo - 1, j = hi + 1;
-    void *el;    
+    if (lo == mid || mid == hi) {
+        return;
+    }
 
-repeat:
+    if (compare_rows(entities, ptr, size, rows[mid - 1], rows[mid], 
+        compare) <= 0) 
     {
-        do {
-            i ++;
-            el = ELEM(ptr, elem_size, i);
-        } while ( compare(entities[i], el, pivot_e, pivot) < 0);
-
-        do {
-            j --;
-            el = ELEM(ptr, elem_size, j);
-        } while ( compare(entities[j], el, pivot_e, pivot) > 0);
+        return;
+    }
 
-        if (i >= j) {
-            return j;
+    int32_t i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) {
+        if (compare_rows(entities, ptr, size, rows[i], rows[j], compare) <= 0) {
+            tmp[k ++] = rows[i ++];
+        } else {
+            tmp[k ++] = rows[j ++];
         }
+    }
 
-        ecs_table_swap(world, table, data, i, j);
-
-        if (p == i) {
-            pivot = ELEM(ptr, elem_size, j);
-            pivot_e = entities[j];
-        } else if (p == j) {
-            pivot = ELEM(ptr, elem_size, i);
-            pivot_e = entities[i];
-        }
+    while (i < mid) {
+        tmp[k ++] = rows[i ++];
+    }
 
-        goto repeat;
+    while (j < hi) {
+        tmp[k ++] = rows[j ++];
     }
+
+    ecs_os_memcpy(&rows[lo], &tmp[lo], (hi - lo) * ECS_SIZEOF(int32_t));
 }
 
+/* Stable merge sort of row indices. Runs that are already in order are not
+ * merged, which makes sorting rows that are (mostly) sorted close to O(n). */
 static
-void qsort_array(
-    ecs_world_t *world,
-    ecs_table_t *table,
-    ecs_data_t *data,
+void msort_rows(
     ecs_entity_t *entities,
     void *ptr,
     int32_t size,
+    int32_t *rows,
+    int32_t *tmp,
     int32_t lo,
     int32_t hi,
     ecs_compare_action_t compare)
-{   
-    if ((hi - lo) < 1)  {
+{
+    if ((hi - lo) < 2) {
         return;
     }
 
-    int32_t p = qsort_partition(
-        world, table, data, entities, ptr, size, lo, hi, compare);
-
-    qsort_array(world, table, data, entities, ptr, size, lo, p, compare);
+    int32_t mid = lo + (hi - lo) / 2;
+    msort_rows(entities, ptr, size, rows, tmp, lo, mid, compare);
+    msort_rows(entities, ptr, size, rows, tmp, mid, hi, compare);
+    merge_rows(entities, ptr, size, rows, tmp, lo, mid, hi, compare);
+}
 
-    qsort_array(world, table, data, entities, ptr, size, p + 1, hi, compare); 
+/* Move entities so that row i contains the entity currently stored in rows[i].
+ * Each cycle in the permutation is followed once, so every entity is moved at
+ * most once. Visited rows are marked by pointing them to themselves. */
+static
+void apply_row_order(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t *rows,
+    int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        int32_t cur = i, next;
+        while ((next = rows[cur]) != i) {
+            ecs_table_swap(world, table, data, cur, next);
+            rows[cur] = cur;
+            cur = next;
+        }
+        rows[cur] = cur;
+    }
 }
 
 static
@@ -16206,7 +19126,92 @@ void sort_table(
         return;
     }
 
+    int32_t i, count = ecs_table_data_count(data);
+    if (count < 2) {
+        return;
+    }
+
+    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
+
+    void *ptr = NULL;
+    int32_t size = 0;
+    if (column_index != -1) {
+        ecs_column_t *column = &data->columns[column_index];
+        size = column->size;
+        ptr = ecs_vector_first_t(column->data, size, column->alignment);
+    }
+
+    /* Find the rows that are still sorted since the last time the table was
+     * sorted. If no rows changed, nothing needs to happen. */
+    int32_t sorted = 1;
+    while (sorted < count && compare_rows(
+        entities, ptr, size, sorted - 1, sorted, compare) <= 0) 
+    {
+        sorted ++;
+    }
+
+    if (sorted == count) {
+        return;
+    }
+
+    /* Sort the remaining rows, and merge them with the sorted rows. If rows
+     * were appended to a sorted table this only requires a single merge. The
+     * sorted order is computed first, so each entity is moved at most once. */
+    int32_t *rows = ecs_os_malloc(count * ECS_SIZEOF(int32_t) * 2);
+    for (i = 0; i < count; i ++) {
+        rows[i] = i;
+    }
+
+    msort_rows(entities, ptr, size, rows, &rows[count], sorted, count, compare);
+    merge_rows(entities, ptr, size, rows, &rows[count], 
+        0, sorted, count, compare);
+    apply_row_order(world, table, data, rows, count);
+    ecs_os_free(rows);
+}
+
+/* Get the sorted rows of a table. If rows were added or removed, rows that no
+ * longer exist are removed from the previous order and new rows are appended,
+ * so that the previous order can still be used as starting point. */
+static
+int32_t* prepare_sorted_rows(
+    ecs_matched_table_t *table_data,
+    int32_t count)
+{
+    int32_t i, prev_count = ecs_vector_count(table_data->sorted_rows);
+    int32_t *rows = ecs_vector_first(table_data->sorted_rows, int32_t);
+    int32_t kept = 0;
+
+    for (i = 0; i < prev_count; i ++) {
+        if (rows[i] < count) {
+            rows[kept ++] = rows[i];
+        }
+    }
+
+    ecs_vector_set_count(&table_data->sorted_rows, int32_t, count);
+    rows = ecs_vector_first(table_data->sorted_rows, int32_t);
+
+    for (i = prev_count; i < count; i ++) {
+        rows[kept ++] = i;
+    }
+
+    ecs_assert(kept == count, ECS_INTERNAL_ERROR, NULL);
+
+    return rows;
+}
+
+/* Sort the rows of a table without moving them. The previous order is used as
+ * starting point. */
+static
+void sort_table_rows(
+    ecs_table_t *table,
+    ecs_matched_table_t *table_data,
+    int32_t column_index,
+    ecs_compare_action_t compare)
+{
+    ecs_data_t *data = ecs_table_get_data(table);
     int32_t count = ecs_table_data_count(data);
+    int32_t *rows = prepare_sorted_rows(table_data, count);
+
     if (count < 2) {
         return;
     }
@@ -16221,7 +19226,220 @@ void sort_table(
         ptr = ecs_vector_first_t(column->data, size, column->alignment);
     }
 
-    qsort_array(world, table, data, entities, ptr, size, 0, count - 1, compare);
+    int32_t *tmp = ecs_os_malloc(count * ECS_SIZEOF(int32_t));
+    msort_rows(entities, ptr, size, rows, tmp, 0, count, compare);
+    ecs_os_free(tmp);
+}
+
+/* Convert a numeric key to an unsigned integer with the same ordering, so that
+ * keys of all kinds can be sorted and compared as unsigned integers. */
+static
+uint64_t key_to_uint(
+    ecs_sort_key_kind_t kind,
+    const void *ptr)
+{
+    switch(kind) {
+    case EcsSortKeyI32: {
+        uint32_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint32_t));
+        return v ^ 0x80000000u;
+    }
+    case EcsSortKeyU32: {
+        uint32_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint32_t));
+        return v;
+    }
+    case EcsSortKeyF32: {
+        uint32_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint32_t));
+        return (v & 0x80000000u) ? ~v : (v | 0x80000000u);
+    }
+    case EcsSortKeyI64: {
+        uint64_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint64_t));
+        return v ^ 0x8000000000000000u;
+    }
+    case EcsSortKeyU64: {
+        uint64_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint64_t));
+        return v;
+    }
+    case EcsSortKeyF64: {
+        uint64_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint64_t));
+        return (v & 0x8000000000000000u) ? ~v : (v | 0x8000000000000000u);
+    }
+    }
+
+    ecs_abort(ECS_INVALID_PARAMETER, NULL);
+    return 0;
+}
+
+static
+ecs_size_t key_size(
+    ecs_sort_key_kind_t kind)
+{
+    switch(kind) {
+    case EcsSortKeyI32:
+    case EcsSortKeyU32:
+    case EcsSortKeyF32:
+        return 4;
+    case EcsSortKeyI64:
+    case EcsSortKeyU64:
+    case EcsSortKeyF64:
+        return 8;
+    }
+
+    ecs_abort(ECS_INVALID_PARAMETER, NULL);
+    return 0;
+}
+
+/* Stable LSD radix sort of rows by key, one byte per pass. The counts for all 
+ * bytes are computed in a single pass over the keys. Bytes that are the same 
+ * for all keys are skipped. */
+static
+void radix_sort_rows(
+    uint64_t *keys,
+    int32_t *rows,
+    int32_t count,
+    ecs_size_t size)
+{
+    int32_t counts[8][256];
+    ecs_os_memset(counts, 0, ECS_SIZEOF(counts));
+
+    int32_t i, b;
+    for (i = 0; i < count; i ++) {
+        uint64_t key = keys[i];
+        for (b = 0; b < size; b ++) {
+            counts[b][(key >> (b * 8)) & 0xff] ++;
+        }
+    }
+
+    uint64_t *keys_tmp = ecs_os_malloc(count * ECS_SIZEOF(uint64_t));
+    int32_t *rows_tmp = ecs_os_malloc(count * ECS_SIZEOF(int32_t));
+    uint64_t *src_keys = keys, *dst_keys = keys_tmp;
+    int32_t *src_rows = rows, *dst_rows = rows_tmp;
+
+    for (b = 0; b < size; b ++) {
+        int32_t *offsets = counts[b];
+        int32_t shift = b * 8;
+
+        if (offsets[(src_keys[0] >> shift) & 0xff] == count) {
+            continue;
+        }
+
+        int32_t d, offset = 0;
+        for (d = 0; d < 256; d ++) {
+            int32_t digit_count = offsets[d];
+            offsets[d] = offset;
+            offset += digit_count;
+        }
+
+        for (i = 0; i < count; i ++) {
+            uint64_t key = src_keys[i];
+            int32_t dst = offsets[(key >> shift) & 0xff] ++;
+            dst_keys[dst] = key;
+            dst_rows[dst] = src_rows[i];
+        }
+
+        uint64_t *t_keys = src_keys; src_keys = dst_keys; dst_keys = t_keys;
+        int32_t *t_rows = src_rows; src_rows = dst_rows; dst_rows = t_rows;
+    }
+
+    if (src_rows != rows) {
+        ecs_os_memcpy(rows, src_rows, count * ECS_SIZEOF(int32_t));
+        ecs_os_memcpy(keys, src_keys, count * ECS_SIZEOF(uint64_t));
+    }
+
+    ecs_os_free(keys_tmp);
+    ecs_os_free(rows_tmp);
+}
+
+/* Sort rows by the key in the sorted column. Returns false if the rows were
+ * already in order, in which case they are not modified. */
+static
+bool sort_rows_by_key(
+    ecs_query_t *query,
+    ecs_column_t *column,
+    int32_t *rows,
+    int32_t count)
+{
+    ecs_sort_key_kind_t kind = query->sort_key_kind;
+    ecs_size_t offset = query->sort_key_offset;
+    int16_t size = column->size;
+    void *ptr = ecs_vector_first_t(column->data, size, column->alignment);
+    ptr = ECS_OFFSET(ptr, offset);
+
+    uint64_t *keys = ecs_os_malloc(count * ECS_SIZEOF(uint64_t));
+    bool sorted = true;
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        keys[i] = key_to_uint(kind, ELEM(ptr, size, rows[i]));
+        if (i && keys[i] < keys[i - 1]) {
+            sorted = false;
+        }
+    }
+
+    if (!sorted) {
+        radix_sort_rows(keys, rows, count, key_size(kind));
+    }
+
+    ecs_os_free(keys);
+
+    return !sorted;
+}
+
+/* Sort a table by key. The sorted order is computed first, after which each
+ * entity is moved at most once to its new row. */
+static
+void sort_table_by_key(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_table_t *table,
+    int32_t column_index)
+{
+    ecs_data_t *data = ecs_table_get_data(table);
+    if (!data || !data->entities) {
+        /* Nothing to sort */
+        return;
+    }
+
+    int32_t i, count = ecs_table_data_count(data);
+    if (count < 2) {
+        return;
+    }
+
+    int32_t *rows = ecs_os_malloc(count * ECS_SIZEOF(int32_t));
+    for (i = 0; i < count; i ++) {
+        rows[i] = i;
+    }
+
+    if (sort_rows_by_key(query, &data->columns[column_index], rows, count)) {
+        apply_row_order(world, table, data, rows, count);
+    }
+
+    ecs_os_free(rows);
+}
+
+/* Sort the rows of a table by key without moving them. Radix sort is stable, 
+ * so starting from the previous order keeps equal keys in the same order. */
+static
+void sort_table_rows_by_key(
+    ecs_query_t *query,
+    ecs_table_t *table,
+    ecs_matched_table_t *table_data,
+    int32_t column_index)
+{
+    ecs_data_t *data = ecs_table_get_data(table);
+    int32_t count = ecs_table_data_count(data);
+    int32_t *rows = prepare_sorted_rows(table_data, count);
+
+    if (count < 2) {
+        return;
+    }
+
+    sort_rows_by_key(query, &data->columns[column_index], rows, count);
 }
 
 /* Helper struct for building sorted table ranges */
@@ -16229,34 +19447,224 @@ typedef struct sort_helper_t {
     ecs_matched_table_t *table;
     ecs_entity_t *entities;
     const void *ptr;
+    int32_t *rows;
+    uint64_t key;
     int32_t row;
     int32_t elem_size;
     int32_t count;
     bool shared;
 } sort_helper_t;
 
+/* Get the table row for the current position of the helper. If rows are not
+ * sorted in place, the position is an index into the sorted rows. */
 static
-const void* ptr_from_helper(
+int32_t row_from_helper(
     sort_helper_t *helper)
 {
-    ecs_assert(helper->row < helper->count, ECS_INTERNAL_ERROR, NULL);
+    if (helper->rows) {
+        return helper->rows[helper->row];
+    } else {
+        return helper->row;
+    }
+}
+
+static
+const void* ptr_from_row(
+    sort_helper_t *helper,
+    int32_t row)
+{
     ecs_assert(helper->elem_size >= 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(helper->row >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(row >= 0, ECS_INTERNAL_ERROR, NULL);
     if (helper->shared) {
         return helper->ptr;
     } else {
-        return ELEM(helper->ptr, helper->elem_size, helper->row);
+        return ELEM(helper->ptr, helper->elem_size, row);
+    }
+}
+
+static
+const void* ptr_from_helper(
+    sort_helper_t *helper)
+{
+    ecs_assert(helper->row < helper->count, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(helper->row >= 0, ECS_INTERNAL_ERROR, NULL);
+    return ptr_from_row(helper, row_from_helper(helper));
+}
+
+static
+ecs_entity_t e_from_helper(
+    sort_helper_t *helper)
+{
+    if (helper->row < helper->count) {
+        return helper->entities[row_from_helper(helper)];
+    } else {
+        return 0;
+    }
+}
+
+static
+uint64_t key_from_row(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t row)
+{
+    return key_to_uint(query->sort_key_kind, 
+        ECS_OFFSET(ptr_from_row(helper, row), query->sort_key_offset));
+}
+
+/* Move helper to the next entity in the sorted order of its table */
+static
+void advance_helper(
+    ecs_query_t *query,
+    sort_helper_t *helper)
+{
+    helper->row ++;
+
+    /* Keys are cached so they don't have to be converted for each compare */
+    if ((query->flags & EcsQuerySortKey) && helper->row < helper->count) {
+        helper->key = key_from_row(query, helper, row_from_helper(helper));
+    }
+}
+
+/* Initialize helper for a table. Returns false if the table is empty. */
+static
+bool init_sort_helper(
+    ecs_query_t *query,
+    ecs_matched_table_t *table_data,
+    sort_helper_t *helper)
+{
+    ecs_world_t *world = query->world;
+    ecs_entity_t component = query->sort_on_component;
+    ecs_table_t *table = table_data->iter_data.table;
+    ecs_data_t *data = ecs_table_get_data(table);
+    ecs_vector_t *entities;
+    if (!data || !(entities = data->entities) || !ecs_table_count(table)) {
+        return false;
+    }
+
+    int32_t index = ecs_type_index_of(table->type, component);
+    if (index != -1) {
+        ecs_column_t *column = &data->columns[index];
+        int16_t size = column->size;
+        int16_t align = column->alignment;
+        helper->ptr = ecs_vector_first_t(column->data, size, align);
+        helper->elem_size = size;
+        helper->shared = false;
+    } else if (component) {
+        /* Find component in prefab */
+        ecs_entity_t base = ecs_find_entity_in_prefabs(
+            world, 0, table->type, component, 0);
+        
+        /* If a base was not found, the query should not have allowed using
+         * the component for sorting */
+        ecs_assert(base != 0, ECS_INTERNAL_ERROR, NULL);
+
+        const EcsComponent *cptr = ecs_get(world, component, EcsComponent);
+        ecs_assert(cptr != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        helper->ptr = ecs_get_w_entity(world, base, component);
+        helper->elem_size = cptr->size;
+        helper->shared = true;
+    } else {
+        helper->ptr = NULL;
+        helper->elem_size = 0;
+        helper->shared = false;
+    }
+
+    helper->table = table_data;
+    helper->entities = ecs_vector_first(entities, ecs_entity_t);
+    helper->rows = NULL;
+    helper->row = -1;
+    helper->count = ecs_table_count(table);
+
+    /* Tables for which the sort component is shared don't have sorted 
+     * rows, as all entities have the same value */
+    ecs_vector_t *sorted_rows = table_data->sorted_rows;
+    if ((query->flags & EcsQuerySortRows) && 
+        ecs_vector_count(sorted_rows) == helper->count) 
+    {
+        helper->rows = ecs_vector_first(sorted_rows, int32_t);
+    }
+
+    advance_helper(query, helper);
+
+    return true;
+}
+
+/* Compare table rows of two helpers, independent of the helper position */
+static
+int compare_helper_rows(
+    ecs_query_t *query,
+    sort_helper_t *helper_1,
+    int32_t row_1,
+    sort_helper_t *helper_2,
+    int32_t row_2)
+{
+    if (query->flags & EcsQuerySortKey) {
+        uint64_t key_1 = key_from_row(query, helper_1, row_1);
+        uint64_t key_2 = key_from_row(query, helper_2, row_2);
+        return (key_1 > key_2) - (key_1 < key_2);
+    } else {
+        return query->compare(
+            helper_1->entities[row_1], ptr_from_row(helper_1, row_1),
+            helper_2->entities[row_2], ptr_from_row(helper_2, row_2));
     }
 }
 
+/* Find the helper with the lowest value. If values are equal, the helper that
+ * comes first wins. Returns -1 if all helpers are at the end of their table. */
 static
-ecs_entity_t e_from_helper(
-    sort_helper_t *helper)
+int32_t min_helper(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t count)
 {
-    if (helper->row < helper->count) {
-        return helper->entities[helper->row];
+    bool sort_key = (query->flags & EcsQuerySortKey) != 0;
+    int32_t i, min = -1;
+
+    for (i = 0; i < count; i ++) {
+        sort_helper_t *cur = &helper[i];
+        if (cur->row >= cur->count) {
+            continue;
+        }
+
+        if (min == -1) {
+            min = i;
+        } else if (sort_key) {
+            if (helper[min].key > cur->key) {
+                min = i;
+            }
+        } else {
+            sort_helper_t *min_h = &helper[min];
+            if (query->compare(e_from_helper(min_h), ptr_from_helper(min_h), 
+                e_from_helper(cur), ptr_from_helper(cur)) > 0) 
+            {
+                min = i;
+            }
+        }
+    }
+
+    return min;
+}
+
+/* Add rows to the sorted slices. A slice can only be extended with the next 
+ * row in the table, as iterators expect rows to be stored consecutively. */
+static
+void add_table_slice(
+    ecs_vector_t **slices,
+    ecs_matched_table_t *table,
+    int32_t row,
+    int32_t count)
+{
+    ecs_table_slice_t *cur = ecs_vector_last(*slices, ecs_table_slice_t);
+    if (cur && cur->table == table && row == (cur->start_row + cur->count)) {
+        cur->count += count;
     } else {
-        return 0;
+        cur = ecs_vector_add(slices, ecs_table_slice_t);
+        ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
+        cur->table = table;
+        cur->start_row = row;
+        cur->count = count;
     }
 }
 
@@ -16266,118 +19674,176 @@ void build_sorted_table_range(
     int32_t start,
     int32_t end)
 {
-    ecs_world_t *world = query->world;
-    ecs_entity_t component = query->sort_on_component;
-    ecs_compare_action_t compare = query->compare;
-
     /* Fetch data from all matched tables */
     ecs_matched_table_t *tables = ecs_vector_first(query->tables, ecs_matched_table_t);
     sort_helper_t *helper = ecs_os_malloc((end - start) * ECS_SIZEOF(sort_helper_t));
 
-    int i, to_sort = 0;
+    int32_t i, to_sort = 0;
     for (i = start; i < end; i ++) {
-        ecs_matched_table_t *table_data = &tables[i];
-        ecs_table_t *table = table_data->iter_data.table;
-        ecs_data_t *data = ecs_table_get_data(table);
-        ecs_vector_t *entities;
-        if (!data || !(entities = data->entities) || !ecs_table_count(table)) {
-            continue;
+        if (init_sort_helper(query, &tables[i], &helper[to_sort])) {
+            to_sort ++;
         }
+    }
 
-        int32_t index = ecs_type_index_of(table->type, component);
-        if (index != -1) {
-            ecs_column_t *column = &data->columns[index];
-            int16_t size = column->size;
-            int16_t align = column->alignment;
-            helper[to_sort].ptr = ecs_vector_first_t(column->data, size, align);
-            helper[to_sort].elem_size = size;
-            helper[to_sort].shared = false;
-        } else if (component) {
-            /* Find component in prefab */
-            ecs_entity_t base = ecs_find_entity_in_prefabs(
-                world, 0, table->type, component, 0);
-            
-            /* If a base was not found, the query should not have allowed using
-             * the component for sorting */
-            ecs_assert(base != 0, ECS_INTERNAL_ERROR, NULL);
+    int32_t min;
+    while ((min = min_helper(query, helper, to_sort)) != -1) {
+        sort_helper_t *cur = &helper[min];
+        add_table_slice(&query->table_slices, cur->table, 
+            row_from_helper(cur), 1);
+        advance_helper(query, cur);
+    }
 
-            const EcsComponent *cptr = ecs_get(world, component, EcsComponent);
-            ecs_assert(cptr != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_os_free(helper);
+}
+
+/* Merge the entities of tables that changed with the previous slices of tables
+ * that did not change. Those slices are still in order, so finding where the
+ * next changed entity goes only requires a binary search in one slice. */
+static
+void patch_sorted_table_range(
+    ecs_query_t *query,
+    int32_t start,
+    int32_t end,
+    bool *dirty,
+    ecs_table_slice_t *slices,
+    int32_t slice_count)
+{
+    ecs_matched_table_t *tables = ecs_vector_first(query->tables, ecs_matched_table_t);
+    sort_helper_t *helper = ecs_os_malloc((end - start) * ECS_SIZEOF(sort_helper_t));
+    sort_helper_t *changed = ecs_os_malloc((end - start) * ECS_SIZEOF(sort_helper_t));
 
-            helper[to_sort].ptr = ecs_get_w_entity(world, base, component);
-            helper[to_sort].elem_size = cptr->size;
-            helper[to_sort].shared = true;
+    int32_t i, changed_count = 0;
+    for (i = start; i < end; i ++) {
+        if (dirty[i]) {
+            if (init_sort_helper(query, &tables[i], &changed[changed_count])) {
+                changed_count ++;
+            }
         } else {
-            helper[to_sort].ptr = NULL;
-            helper[to_sort].elem_size = 0;
-            helper[to_sort].shared = false;
+            init_sort_helper(query, &tables[i], &helper[i - start]);
         }
-
-        helper[to_sort].table = table_data;
-        helper[to_sort].entities = ecs_vector_first(entities, ecs_entity_t);
-        helper[to_sort].row = 0;
-        helper[to_sort].count = ecs_table_count(table);
-        to_sort ++;      
     }
 
-    ecs_table_slice_t *cur = NULL;
+    int32_t min = min_helper(query, changed, changed_count);
 
-    bool proceed;
-    do {
-        int32_t j, min = 0;
-        proceed = true;
-
-        ecs_entity_t e1;
-        while (!(e1 = e_from_helper(&helper[min]))) {
-            min ++;
-            if (min == to_sort) {
-                proceed = false;
-                break;
-            }
+    for (i = 0; i < slice_count; i ++) {
+        ecs_table_slice_t *slice = &slices[i];
+        int32_t index = (int32_t)(slice->table - tables);
+        if (dirty[index]) {
+            continue;
         }
 
-        if (!proceed) {
-            break;
-        }
+        sort_helper_t *cur = &helper[index - start];
+        int32_t row = slice->start_row, slice_end = row + slice->count;
 
-        for (j = min + 1; j < to_sort; j++) {
-            ecs_entity_t e2 = e_from_helper(&helper[j]);
-            if (!e2) {
-                continue;
+        while (min != -1 && row < slice_end) {
+            sort_helper_t *next = &changed[min];
+            int32_t next_row = row_from_helper(next);
+
+            /* If values are equal, the table that comes first goes first */
+            int tie = next->table < slice->table;
+
+            /* Find first row in slice that goes after the changed entity. Test
+             * the last row first, as most slices are not split. */
+            int32_t lo = row, hi = slice_end;
+            if (compare_helper_rows(
+                query, next, next_row, cur, slice_end - 1) >= tie) 
+            {
+                lo = slice_end;
+            }
+
+            while (lo < hi) {
+                int32_t mid = lo + (hi - lo) / 2;
+                if (compare_helper_rows(
+                    query, next, next_row, cur, mid) < tie) 
+                {
+                    hi = mid;
+                } else {
+                    lo = mid + 1;
+                }
             }
 
-            const void *ptr1 = ptr_from_helper(&helper[min]);
-            const void *ptr2 = ptr_from_helper(&helper[j]);
+            if (lo != row) {
+                add_table_slice(
+                    &query->table_slices, slice->table, row, lo - row);
+                row = lo;
+            }
 
-            if (compare(e1, ptr1, e2, ptr2) > 0) {
-                min = j;
+            if (row < slice_end) {
+                add_table_slice(&query->table_slices, next->table, next_row, 1);
+                advance_helper(query, next);
+                min = min_helper(query, changed, changed_count);
             }
         }
 
-        sort_helper_t *cur_helper = &helper[min];
-
-        if (!cur || cur->table != cur_helper->table) {
-            cur = ecs_vector_add(&query->table_slices, ecs_table_slice_t);
-            ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
-            cur->table = cur_helper->table;
-            cur->start_row = cur_helper->row;
-            cur->count = 1;
-        } else {
-            cur->count ++;
+        if (row < slice_end) {
+            add_table_slice(
+                &query->table_slices, slice->table, row, slice_end - row);
         }
+    }
 
-        cur_helper->row ++;
-    } while (proceed);
+    while (min != -1) {
+        sort_helper_t *next = &changed[min];
+        add_table_slice(&query->table_slices, next->table, 
+            row_from_helper(next), 1);
+        advance_helper(query, next);
+        min = min_helper(query, changed, changed_count);
+    }
 
     ecs_os_free(helper);
+    ecs_os_free(changed);
+}
+
+/* Build slices for tables in a group. If a table is not marked as dirty, its
+ * previous slices are still valid, and tables that changed are merged in. */
+static
+void build_sorted_group(
+    ecs_query_t *query,
+    int32_t start,
+    int32_t end,
+    bool *dirty,
+    ecs_table_slice_t *slices,
+    int32_t slice_count,
+    int32_t *slice_index)
+{
+    ecs_matched_table_t *tables = ecs_vector_first(query->tables, ecs_matched_table_t);
+
+    /* Previous slices for the group are stored consecutively */
+    int32_t first = *slice_index, last = first;
+    while (last < slice_count && (slices[last].table - tables) < end) {
+        last ++;
+    }
+    *slice_index = last;
+
+    int32_t i, changed = 0;
+    if (dirty) {
+        for (i = start; i < end; i ++) {
+            changed += dirty[i];
+        }
+    }
+
+    if (!dirty || changed == (end - start)) {
+        build_sorted_table_range(query, start, end);
+    } else if (changed) {
+        patch_sorted_table_range(
+            query, start, end, dirty, &slices[first], last - first);
+    } else if (last != first) {
+        ecs_table_slice_t *dst = ecs_vector_addn(
+            &query->table_slices, ecs_table_slice_t, last - first);
+        ecs_os_memcpy(dst, &slices[first], 
+            (last - first) * ECS_SIZEOF(ecs_table_slice_t));
+    }
 }
 
+/* Build slices for all tables. If dirty is NULL, all slices are rebuilt. */
 static
 void build_sorted_tables(
-    ecs_query_t *query)
+    ecs_query_t *query,
+    bool *dirty)
 {
-    /* Clean previous sorted tables */
-    ecs_vector_free(query->table_slices);
+    ecs_vector_t *prev_slices = query->table_slices;
+    ecs_table_slice_t *slices = ecs_vector_first(
+        prev_slices, ecs_table_slice_t);
+    int32_t slice_count = ecs_vector_count(prev_slices), slice_index = 0;
     query->table_slices = NULL;
 
     int32_t i, count = ecs_vector_count(query->tables);
@@ -16389,7 +19855,8 @@ void build_sorted_tables(
         table = &tables[i];
         if (rank != table->rank) {
             if (start != i) {
-                build_sorted_table_range(query, start, i);
+                build_sorted_group(query, start, i, dirty, 
+                    slices, slice_count, &slice_index);
                 start = i;
             }
             rank = table->rank;
@@ -16397,8 +19864,11 @@ void build_sorted_tables(
     }
 
     if (start != i) {
-        build_sorted_table_range(query, start, i);
+        build_sorted_group(query, start, i, dirty, 
+            slices, slice_count, &slice_index);
     }
+
+    ecs_vector_free(prev_slices);
 }
 
 static
@@ -16439,7 +19909,11 @@ static
 void tables_reset_dirty(
     ecs_query_t *query)
 {
-    query->prev_match_count = query->match_count;
+    /* Only write values that changed. Worker threads iterate the same query,
+     * and when nothing changed they should not write to it. */
+    if (query->prev_match_count != query->match_count) {
+        query->prev_match_count = query->match_count;
+    }
 
     int32_t i, count = ecs_vector_count(query->tables);
     ecs_matched_table_t *tables = ecs_vector_first(
@@ -16458,18 +19932,34 @@ void tables_reset_dirty(
         int32_t *dirty_state = ecs_table_get_dirty_state(table);
         int32_t t, type_count = table->column_count;
         for (t = 0; t < type_count + 1; t ++) {
-            table_data->monitor[t] = dirty_state[t];
+            if (table_data->monitor[t] != dirty_state[t]) {
+                table_data->monitor[t] = dirty_state[t];
+            }
         }
     }
 }
 
+static
+bool* mark_dirty(
+    bool *dirty,
+    int32_t count,
+    int32_t index)
+{
+    if (!dirty) {
+        dirty = ecs_os_calloc(count * ECS_SIZEOF(bool));
+    }
+    dirty[index] = true;
+    return dirty;
+}
+
 static
 void sort_tables(
     ecs_world_t *world,
     ecs_query_t *query)
 {
     ecs_compare_action_t compare = query->compare;
-    if (!compare) {
+    bool sort_key = (query->flags & EcsQuerySortKey) != 0;
+    if (!compare && !sort_key) {
         return;
     }
     
@@ -16482,6 +19972,14 @@ void sort_tables(
         query->tables, ecs_matched_table_t);
     bool tables_sorted = false;
 
+    /* If the matched tables did not change, the previous slices can be patched
+     * with the tables that changed, instead of rebuilding all slices. The
+     * array that marks changed tables is allocated when the first changed
+     * table is found, so iterating a query that didn't change is free. */
+    bool patch = query->table_slices && 
+        query->match_count == query->prev_match_count;
+    bool *dirty = NULL;
+
     for (i = 0; i < count; i ++) {
         ecs_matched_table_t *table_data = &tables[i];
         ecs_table_t *table = table_data->iter_data.table;
@@ -16509,24 +20007,52 @@ void sort_tables(
                 is_dirty = is_dirty || (dirty_state[index + 1] != table_data->monitor[index + 1]);
             } else {
                 /* Table does not contain component which means the sorted
-                 * component is shared. Table does not need to be sorted */
+                 * component is shared. Table does not need to be sorted, but
+                 * the shared value is not monitored, so always merge it. */
+                if (patch) {
+                    dirty = mark_dirty(dirty, count, i);
+                }
                 continue;
             }
         }      
         
         /* Check both if entities have moved (element 0) or if the component
          * we're sorting on has changed (index + 1) */
-        if (is_dirty) {
+        if (query->flags & EcsQuerySortRows) {
+            /* Sorted rows are also missing after changing the sort order */
+            if (is_dirty || !table_data->sorted_rows) {
+                if (sort_key) {
+                    sort_table_rows_by_key(query, table, table_data, index);
+                } else {
+                    sort_table_rows(table, table_data, index, compare);
+                }
+                tables_sorted = true;
+            } else {
+                continue;
+            }
+        } else if (is_dirty) {
             /* Sort the table */
-            sort_table(world, table, index, compare);
+            if (sort_key) {
+                sort_table_by_key(world, query, table, index);
+            } else {
+                sort_table(world, table, index, compare);
+            }
             tables_sorted = true;
+        } else {
+            continue;
+        }
+
+        if (patch) {
+            dirty = mark_dirty(dirty, count, i);
         }
     }
 
     if (tables_sorted || query->match_count != query->prev_match_count) {
-        build_sorted_tables(query);
+        build_sorted_tables(query, dirty);
         query->match_count ++; /* Increase version if tables changed */
     }
+
+    ecs_os_free(dirty);
 }
 
 static
@@ -16963,6 +20489,7 @@ void free_matched_table(
     ecs_os_free(table->sparse_columns);
     ecs_os_free(table->bitset_columns);
     ecs_os_free(table->monitor);
+    ecs_vector_free(table->sorted_rows);
 }
 
 /** Check if a table was matched with the system */
@@ -17048,6 +20575,12 @@ void remove_table(
      * the memory of mt */
     free_matched_table(mt);  
     move_table(query, mt->iter_data.table, index, NULL, tables, empty);
+
+    /* Removing an active table moves another table, so sorted slices that 
+     * point to matched tables need to be rebuilt */
+    if (!empty) {
+        query->match_count ++;
+    }
 }
 
 static
@@ -17586,6 +21119,34 @@ int find_smallest_column(
     return index;
 }
 
+/* When a case covers at least 1/SWITCH_SCAN_RATIO of the rows in a table, it
+ * is cheaper to scan the switch values linearly than to follow the case list,
+ * which visits rows in LIFO order and rarely yields contiguous runs. */
+#define SWITCH_SCAN_RATIO (8)
+
+static
+bool sparse_row_matches(
+    ecs_sparse_column_t *columns,
+    int32_t count,
+    int32_t skip,
+    int32_t row)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        if (i == skip) {
+            /* Already validated this one */
+            continue;
+        }
+
+        ecs_sparse_column_t *column = &columns[i];
+        if (ecs_switch_get(column->sw_column->data, row) != column->sw_case) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static
 int sparse_column_next(
     ecs_table_t *table,
@@ -17608,44 +21169,95 @@ int sparse_column_next(
     ecs_sparse_column_t *columns = ecs_vector_first(
         sparse_columns, ecs_sparse_column_t);
     ecs_sparse_column_t *column = &columns[sparse_smallest];
-    ecs_switch_t *sw, *sw_smallest = column->sw_column->data;
+    ecs_switch_t *sw_smallest = column->sw_column->data;
     ecs_entity_t case_smallest = column->sw_case;
+    int32_t count = ecs_vector_count(sparse_columns);
 
-    /* Find next entity to iterate in sparse column */
-    int32_t first;
     if (first_iteration) {
-        first = ecs_switch_first(sw_smallest, case_smallest);
-    } else {
-        first = ecs_switch_next(sw_smallest, iter->sparse_first);
+        int32_t case_count = ecs_switch_case_count(sw_smallest, case_smallest);
+        iter->sparse_scan = case_count * SWITCH_SCAN_RATIO >= 
+            ecs_table_count(table);
+        iter->sparse_first = 0;
     }
 
-    if (first == -1) {
-        goto done;
-    }    
+    int32_t lo, hi;
 
-    /* Check if entity matches with other sparse columns, if any */
-    int32_t i, count = ecs_vector_count(sparse_columns);
-    do {
-        for (i = 0; i < count; i ++) {
-            if (i == sparse_smallest) {
-                /* Already validated this one */
-                continue;
+    if (iter->sparse_scan) {
+        /* Dense case: find the next run of matching rows in the values array.
+         * sparse_first is the first row that hasn't been visited yet. */
+        uint64_t *values = ecs_vector_first(
+            ecs_switch_values(sw_smallest), uint64_t);
+        int32_t row = iter->sparse_first, table_count = ecs_table_count(table);
+
+        for (; row < table_count; row ++) {
+            if (values[row] == case_smallest && 
+                sparse_row_matches(columns, count, sparse_smallest, row)) 
+            {
+                break;
+            }
+        }
+
+        if (row == table_count) {
+            goto done;
+        }
+
+        lo = row;
+        for (row ++; row < table_count; row ++) {
+            if (values[row] != case_smallest || 
+                !sparse_row_matches(columns, count, sparse_smallest, row)) 
+            {
+                break;
             }
+        }
+
+        hi = row - 1;
+        iter->sparse_first = row;
+    } else {
+        /* Sparse case: follow the case list. sparse_first is the last list
+         * element that was visited. */
+        int32_t elem;
+        if (first_iteration) {
+            elem = ecs_switch_first(sw_smallest, case_smallest);
+        } else {
+            elem = ecs_switch_next(sw_smallest, iter->sparse_first);
+        }
 
-            column = &columns[i];
-            sw = column->sw_column->data;
+        while (elem != -1 && 
+            !sparse_row_matches(columns, count, sparse_smallest, elem)) 
+        {
+            elem = ecs_switch_next(sw_smallest, elem);
+        }
 
-            if (ecs_switch_get(sw, first) != column->sw_case) {
-                first = ecs_switch_next(sw_smallest, first);
-                if (first == -1) {
-                    goto done;
-                }
+        if (elem == -1) {
+            goto done;
+        }
+
+        /* Grow the run for as long as the list visits adjacent rows */
+        lo = hi = elem;
+        int32_t next;
+        while ((next = ecs_switch_next(sw_smallest, elem)) != -1) {
+            if (next != lo - 1 && next != hi + 1) {
+                break;
+            }
+
+            if (!sparse_row_matches(columns, count, sparse_smallest, next)) {
+                break;
+            }
+
+            if (next < lo) {
+                lo = next;
+            } else {
+                hi = next;
             }
+
+            elem = next;
         }
-    } while (i != count);
 
-    cur->first = iter->sparse_first = first;
-    cur->count = 1;
+        iter->sparse_first = elem;
+    }
+
+    cur->first = lo;
+    cur->count = hi - lo + 1;
 
     return 0;
 done:
@@ -17653,12 +21265,105 @@ done:
      * next matched table. */
     iter->sparse_smallest = 0;
     iter->sparse_first = 0;
+    iter->sparse_scan = false;
 
     return -1;
 }
 
 #define BS_MAX ((uint64_t)0xFFFFFFFFFFFFFFFF)
 
+/* Number of bitset words that are combined in one step (256 bits) */
+#define BS_WORDS (4)
+
+/* Index of the lowest set bit. v must not be 0. */
+static
+int32_t bs_ctz(
+    uint64_t v)
+{
+    ecs_assert(v != 0, ECS_INTERNAL_ERROR, NULL);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (int32_t)index;
+#else
+    int32_t index = 0;
+    if (!(v & 0xFFFFFFFF)) { v >>= 32; index += 32; }
+    if (!(v & 0xFFFF)) { v >>= 16; index += 16; }
+    if (!(v & 0xFF)) { v >>= 8; index += 8; }
+    if (!(v & 0xF)) { v >>= 4; index += 4; }
+    if (!(v & 0x3)) { v >>= 2; index += 2; }
+    if (!(v & 0x1)) { index += 1; }
+    return index;
+#endif
+}
+
+/* AND the words of all bitset columns, starting from block. Returns the number
+ * of words written to out, which is at most BS_WORDS. */
+static
+int32_t bitset_and_words(
+    uint64_t **data,
+    int32_t count,
+    int32_t block,
+    int32_t block_count,
+    uint64_t *out)
+{
+    int32_t i, w, n = block_count - block;
+
+    if (n >= BS_WORDS) {
+#if defined(__AVX2__)
+        __m256i v = _mm256_loadu_si256((const __m256i*)&data[0][block]);
+        for (i = 1; i < count; i ++) {
+            v = _mm256_and_si256(v, 
+                _mm256_loadu_si256((const __m256i*)&data[i][block]));
+        }
+        _mm256_storeu_si256((__m256i*)out, v);
+#elif defined(__SSE2__)
+        __m128i lo = _mm_loadu_si128((const __m128i*)&data[0][block]);
+        __m128i hi = _mm_loadu_si128((const __m128i*)&data[0][block + 2]);
+        for (i = 1; i < count; i ++) {
+            lo = _mm_and_si128(lo, 
+                _mm_loadu_si128((const __m128i*)&data[i][block]));
+            hi = _mm_and_si128(hi, 
+                _mm_loadu_si128((const __m128i*)&data[i][block + 2]));
+        }
+        _mm_storeu_si128((__m128i*)out, lo);
+        _mm_storeu_si128((__m128i*)&out[2], hi);
+#elif defined(__ARM_NEON)
+        uint64x2_t lo = vld1q_u64(&data[0][block]);
+        uint64x2_t hi = vld1q_u64(&data[0][block + 2]);
+        for (i = 1; i < count; i ++) {
+            lo = vandq_u64(lo, vld1q_u64(&data[i][block]));
+            hi = vandq_u64(hi, vld1q_u64(&data[i][block + 2]));
+        }
+        vst1q_u64(out, lo);
+        vst1q_u64(&out[2], hi);
+#else
+        for (w = 0; w < BS_WORDS; w ++) {
+            out[w] = data[0][block + w];
+        }
+        for (i = 1; i < count; i ++) {
+            for (w = 0; w < BS_WORDS; w ++) {
+                out[w] &= data[i][block + w];
+            }
+        }
+#endif
+        return BS_WORDS;
+    }
+
+    /* Last words of the bitset */
+    for (w = 0; w < n; w ++) {
+        uint64_t v = data[0][block + w];
+        for (i = 1; i < count; i ++) {
+            v &= data[i][block + w];
+        }
+        out[w] = v;
+    }
+
+    return n;
+}
+
 static
 int bitset_column_next(
     ecs_table_t *table,
@@ -17666,179 +21371,125 @@ int bitset_column_next(
     ecs_query_iter_t *iter,
     ecs_page_cursor_t *cur)
 {
-    /* Precomputed single-bit test */
-    static const uint64_t bitmask[64] = {
-    (uint64_t)1 << 0, (uint64_t)1 << 1, (uint64_t)1 << 2, (uint64_t)1 << 3,
-    (uint64_t)1 << 4, (uint64_t)1 << 5, (uint64_t)1 << 6, (uint64_t)1 << 7,
-    (uint64_t)1 << 8, (uint64_t)1 << 9, (uint64_t)1 << 10, (uint64_t)1 << 11,
-    (uint64_t)1 << 12, (uint64_t)1 << 13, (uint64_t)1 << 14, (uint64_t)1 << 15,
-    (uint64_t)1 << 16, (uint64_t)1 << 17, (uint64_t)1 << 18, (uint64_t)1 << 19,
-    (uint64_t)1 << 20, (uint64_t)1 << 21, (uint64_t)1 << 22, (uint64_t)1 << 23,
-    (uint64_t)1 << 24, (uint64_t)1 << 25, (uint64_t)1 << 26, (uint64_t)1 << 27,  
-    (uint64_t)1 << 28, (uint64_t)1 << 29, (uint64_t)1 << 30, (uint64_t)1 << 31,
-    (uint64_t)1 << 32, (uint64_t)1 << 33, (uint64_t)1 << 34, (uint64_t)1 << 35,  
-    (uint64_t)1 << 36, (uint64_t)1 << 37, (uint64_t)1 << 38, (uint64_t)1 << 39,
-    (uint64_t)1 << 40, (uint64_t)1 << 41, (uint64_t)1 << 42, (uint64_t)1 << 43,
-    (uint64_t)1 << 44, (uint64_t)1 << 45, (uint64_t)1 << 46, (uint64_t)1 << 47,  
-    (uint64_t)1 << 48, (uint64_t)1 << 49, (uint64_t)1 << 50, (uint64_t)1 << 51,
-    (uint64_t)1 << 52, (uint64_t)1 << 53, (uint64_t)1 << 54, (uint64_t)1 << 55,  
-    (uint64_t)1 << 56, (uint64_t)1 << 57, (uint64_t)1 << 58, (uint64_t)1 << 59,
-    (uint64_t)1 << 60, (uint64_t)1 << 61, (uint64_t)1 << 62, (uint64_t)1 << 63
-    };
-
-    /* Precomputed test to verify if remainder of block is set (or not) */
-    static const uint64_t bitmask_remain[64] = {
-    BS_MAX, BS_MAX - (BS_MAX >> 63), BS_MAX - (BS_MAX >> 62),
-    BS_MAX - (BS_MAX >> 61), BS_MAX - (BS_MAX >> 60), BS_MAX - (BS_MAX >> 59),
-    BS_MAX - (BS_MAX >> 58), BS_MAX - (BS_MAX >> 57), BS_MAX - (BS_MAX >> 56), 
-    BS_MAX - (BS_MAX >> 55), BS_MAX - (BS_MAX >> 54), BS_MAX - (BS_MAX >> 53), 
-    BS_MAX - (BS_MAX >> 52), BS_MAX - (BS_MAX >> 51), BS_MAX - (BS_MAX >> 50), 
-    BS_MAX - (BS_MAX >> 49), BS_MAX - (BS_MAX >> 48), BS_MAX - (BS_MAX >> 47), 
-    BS_MAX - (BS_MAX >> 46), BS_MAX - (BS_MAX >> 45), BS_MAX - (BS_MAX >> 44), 
-    BS_MAX - (BS_MAX >> 43), BS_MAX - (BS_MAX >> 42), BS_MAX - (BS_MAX >> 41), 
-    BS_MAX - (BS_MAX >> 40), BS_MAX - (BS_MAX >> 39), BS_MAX - (BS_MAX >> 38), 
-    BS_MAX - (BS_MAX >> 37), BS_MAX - (BS_MAX >> 36), BS_MAX - (BS_MAX >> 35), 
-    BS_MAX - (BS_MAX >> 34), BS_MAX - (BS_MAX >> 33), BS_MAX - (BS_MAX >> 32), 
-    BS_MAX - (BS_MAX >> 31), BS_MAX - (BS_MAX >> 30), BS_MAX - (BS_MAX >> 29), 
-    BS_MAX - (BS_MAX >> 28), BS_MAX - (BS_MAX >> 27), BS_MAX - (BS_MAX >> 26), 
-    BS_MAX - (BS_MAX >> 25), BS_MAX - (BS_MAX >> 24), BS_MAX - (BS_MAX >> 23), 
-    BS_MAX - (BS_MAX >> 22), BS_MAX - (BS_MAX >> 21), BS_MAX - (BS_MAX >> 20), 
-    BS_MAX - (BS_MAX >> 19), BS_MAX - (BS_MAX >> 18), BS_MAX - (BS_MAX >> 17), 
-    BS_MAX - (BS_MAX >> 16), BS_MAX - (BS_MAX >> 15), BS_MAX - (BS_MAX >> 14), 
-    BS_MAX - (BS_MAX >> 13), BS_MAX - (BS_MAX >> 12), BS_MAX - (BS_MAX >> 11), 
-    BS_MAX - (BS_MAX >> 10), BS_MAX - (BS_MAX >> 9), BS_MAX - (BS_MAX >> 8), 
-    BS_MAX - (BS_MAX >> 7), BS_MAX - (BS_MAX >> 6), BS_MAX - (BS_MAX >> 5), 
-    BS_MAX - (BS_MAX >> 4), BS_MAX - (BS_MAX >> 3), BS_MAX - (BS_MAX >> 2),
-    BS_MAX - (BS_MAX >> 1)
-    };
-
     int32_t i, count = ecs_vector_count(bitset_columns);
     ecs_bitset_column_t *columns = ecs_vector_first(
         bitset_columns, ecs_bitset_column_t);
     int32_t bs_offset = table->bs_column_offset;
+    int32_t elem_count = ecs_table_count(table);
 
-    int32_t first = iter->bitset_first;
-    int32_t last = 0;
+    uint64_t *data_stack[BS_WORDS];
+    uint64_t **data = data_stack;
+    if (count > BS_WORDS) {
+        data = ecs_os_malloc(ECS_SIZEOF(uint64_t*) * count);
+    }
 
     for (i = 0; i < count; i ++) {
         ecs_bitset_column_t *column = &columns[i];
         ecs_bs_column_t *bs_column = columns[i].bs_column;
 
         if (!bs_column) {
-            ecs_data_t *data = table->data;
+            ecs_data_t *table_data = table->data;
             int32_t index = column->column_index;
             ecs_assert((index - bs_offset >= 0), ECS_INTERNAL_ERROR, NULL);
-            bs_column = &data->bs_columns[index - bs_offset];
+            bs_column = &table_data->bs_columns[index - bs_offset];
             columns[i].bs_column = bs_column;
         }
-        
-        ecs_bitset_t *bs = &bs_column->data;
-        int32_t bs_elem_count = bs->count;
-        int32_t bs_block = first >> 6;
-        int32_t bs_block_count = ((bs_elem_count - 1) >> 6) + 1;
 
-        if (bs_block >= bs_block_count) {
-            goto done;
+        ecs_bitset_t *bs = &bs_column->data;
+        if (bs->count < elem_count) {
+            elem_count = bs->count;
         }
 
-        uint64_t *data = bs->data;
-        int32_t bs_start = first & 0x3F;
+        data[i] = bs->data;
+    }
 
-        /* Step 1: find the first non-empty block */
-        uint64_t v = data[bs_block];
-        uint64_t remain = bitmask_remain[bs_start];
-        while (!(v & remain)) {
-            /* If no elements are remaining, move to next block */
-            if ((++bs_block) >= bs_block_count) {
-                /* No non-empty blocks left */
-                goto done;
-            }
+    int32_t first = iter->bitset_first;
+    if (first >= elem_count) {
+        goto done;
+    }
 
-            bs_start = 0;
-            remain = BS_MAX; /* Test the full block */
-            v = data[bs_block];
-        }
+    /* Scan the combined bitsets BS_WORDS words at a time */
+    uint64_t words[BS_WORDS];
+    int32_t block_count = ((elem_count - 1) >> 6) + 1;
+    int32_t block = first >> 6, base = block, n = 0, w = 0;
+    uint64_t v;
 
-        /* Step 2: find the first non-empty element in the block */
-        while (!(v & bitmask[bs_start])) {
-            bs_start ++;
+    /* Step 1: find the first enabled element */
+    for (;;) {
+        if (w == n) {
+            if (block >= block_count) {
+                goto done;
+            }
 
-            /* Block was not empty, so bs_start must be smaller than 64 */
-            ecs_assert(bs_start < 64, ECS_INTERNAL_ERROR, NULL);
-        }
-        
-        /* Step 3: Find number of contiguous enabled elements after start */
-        int32_t bs_end = bs_start, bs_block_end = bs_block;
-        
-        remain = bitmask_remain[bs_end];
-        while ((v & remain) == remain) {
-            bs_end = 0;
-            bs_block_end ++;
+            base = block;
+            n = bitset_and_words(data, count, block, block_count, words);
+            block += n;
+            w = 0;
 
-            if (bs_block_end == bs_block_count) {
-                break;
+            if (base == (first >> 6)) {
+                /* Ignore elements before first */
+                words[0] &= BS_MAX << (first & 0x3F);
             }
-
-            v = data[bs_block_end];
-            remain = BS_MAX; /* Test the full block */
         }
 
-        /* Step 4: find remainder of enabled elements in current block */
-        if (bs_block_end != bs_block_count) {
-            while ((v & bitmask[bs_end])) {
-                bs_end ++;
-            }
+        if ((v = words[w])) {
+            break;
         }
 
-        /* Block was not 100% occupied, so bs_start must be smaller than 64 */
-        ecs_assert(bs_end < 64, ECS_INTERNAL_ERROR, NULL);
+        w ++;
+    }
 
-        /* Step 5: translate to element start/end and make sure that each column
-         * range is a subset of the previous one. */
-        first = bs_block * 64 + bs_start;
-        int32_t cur_last = bs_block_end * 64 + bs_end;
-        
-        /* No enabled elements found in table */
-        if (first == cur_last) {
-            goto done;
+    first = (base + w) * 64 + bs_ctz(v);
+    if (first >= elem_count) {
+        goto done;
+    }
+
+    /* Step 2: find the first disabled element after first */
+    int32_t last = elem_count;
+    v = ~words[w] & (BS_MAX << (first & 0x3F));
+    for (;;) {
+        if (v) {
+            last = (base + w) * 64 + bs_ctz(v);
+            break;
         }
 
-        /* If multiple bitsets are evaluated, make sure each subsequent range
-         * is equal or a subset of the previous range */
-        if (i) {
-            /* If the first element of a subsequent bitset is larger than the
-             * previous last value, start over. */
-            if (first >= last) {
-                i = -1;
-                continue;
+        if (++ w == n) {
+            if (block >= block_count) {
+                break;
             }
 
-            /* Make sure the last element of the range doesn't exceed the last
-             * element of the previous range. */
-            if (cur_last > last) {
-                cur_last = last;
-            }
+            base = block;
+            n = bitset_and_words(data, count, block, block_count, words);
+            block += n;
+            w = 0;
         }
-        
-        last = cur_last;
-        int32_t elem_count = last - first;
 
-        /* Make sure last element doesn't exceed total number of elements in 
-         * the table */
-        if (elem_count > bs_elem_count) {
-            elem_count = bs_elem_count;
-        }
-        
-        cur->first = first;
-        cur->count = elem_count;
-        iter->bitset_first = first;
+        v = ~words[w];
     }
-    
+
+    if (last > elem_count) {
+        last = elem_count;
+    }
+
+    if (data != data_stack) {
+        ecs_os_free(data);
+    }
+
+    cur->first = first;
+    cur->count = last - first;
+
     /* Keep track of last processed element for iteration */ 
     iter->bitset_first = last;
 
     return 0;
 done:
+    if (data != data_stack) {
+        ecs_os_free(data);
+    }
+
+    /* No more enabled elements in this table, next table starts at 0 */
+    iter->bitset_first = 0;
+
     return -1;
 }
 
@@ -17881,7 +21532,8 @@ bool ecs_query_next(
     ecs_matched_table_t *tables = ecs_vector_first(
         query->tables, ecs_matched_table_t);
 
-    ecs_assert(!slice || query->compare, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!slice || query->compare || (query->flags & EcsQuerySortKey), 
+        ECS_INTERNAL_ERROR, NULL);
     
     ecs_page_cursor_t cur;
     int32_t table_count = it->table_count;
@@ -17988,28 +21640,56 @@ bool ecs_query_next_worker(
     int32_t current,
     int32_t total)
 {
+    ecs_world_t *world = it->world;
     int32_t per_worker, first, prev_offset = it->offset;
 
+    ecs_get_stage(&world);
+
     do {
         if (!ecs_query_next(it)) {
             return false;
         }
 
-        int32_t count = it->count;
-        per_worker = count / total;
-        first = per_worker * current;
+        /* When columns are aligned, divide the table in units of rows that
+         * start on an aligned address, so that workers don't share cache
+         * lines. Rows before the first aligned row go to the first worker. */
+        int32_t count = it->count, align = 1;
+        if (it->table && it->table->table) {
+            align = ecs_table_row_alignment(world, it->table->table);
+        }
 
-        count -= per_worker * total;
+        int32_t head = (align - it->offset % align) % align;
+        if (head > count) {
+            head = count;
+        }
 
-        if (count) {
-            if (current < count) {
-                per_worker ++;
-                first += current;
+        int32_t units = (count - head + align - 1) / align;
+        int32_t per_unit = units / total;
+        int32_t unit_first = per_unit * current;
+        int32_t remainder = units - per_unit * total;
+
+        if (remainder) {
+            if (current < remainder) {
+                per_unit ++;
+                unit_first += current;
             } else {
-                first += count;
+                unit_first += remainder;
             }
         }
 
+        int32_t last = head + (unit_first + per_unit) * align;
+        if (last > count) {
+            last = count;
+        }
+
+        if (current) {
+            first = head + unit_first * align;
+        } else {
+            first = 0;
+        }
+
+        per_worker = ECS_MAX(0, last - first);
+
         if (!per_worker && !(it->query->flags & EcsQueryNeedsTables)) {
             if (current == 0) {
                 return true;
@@ -18028,11 +21708,13 @@ bool ecs_query_next_worker(
     return true;
 }
 
-void ecs_query_order_by(
+static
+void order_by(
     ecs_world_t *world,
     ecs_query_t *query,
     ecs_entity_t sort_component,
-    ecs_compare_action_t compare)
+    ecs_compare_action_t compare,
+    ecs_flags32_t sort_flags)
 {
     ecs_assert(query != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(!(query->flags & EcsQueryIsOrphaned), ECS_INVALID_PARAMETER, NULL);    
@@ -18041,16 +21723,94 @@ void ecs_query_order_by(
     query->sort_on_component = sort_component;
     query->compare = compare;
 
+    query->flags &= ~(ecs_flags32_t)(EcsQuerySortRows | EcsQuerySortKey);
+    query->flags |= sort_flags;
+
+    /* Rows sorted with the previous sort order are no longer valid */
+    ecs_vector_each(query->tables, ecs_matched_table_t, table_data, {
+        ecs_vector_free(table_data->sorted_rows);
+        table_data->sorted_rows = NULL;
+    });
+
+    ecs_vector_each(query->empty_tables, ecs_matched_table_t, table_data, {
+        ecs_vector_free(table_data->sorted_rows);
+        table_data->sorted_rows = NULL;
+    });
+
     ecs_vector_free(query->table_slices);
     query->table_slices = NULL;
 
     sort_tables(world, query);    
 
     if (!query->table_slices) {
-        build_sorted_tables(query);
+        build_sorted_tables(query, NULL);
     }
 }
 
+void ecs_query_order_by(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_compare_action_t compare)
+{
+    order_by(world, query, sort_component, compare, 0);
+}
+
+void ecs_query_order_by_rows(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_compare_action_t compare)
+{
+    order_by(world, query, sort_component, compare, EcsQuerySortRows);
+}
+
+static
+void order_by_key(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset,
+    ecs_flags32_t sort_flags)
+{
+    ecs_assert(query != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(sort_component != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(offset >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    const EcsComponent *cptr = ecs_get(world, sort_component, EcsComponent);
+    ecs_assert(cptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(offset + key_size(kind) <= cptr->size, 
+        ECS_INVALID_PARAMETER, NULL);
+    (void)cptr;
+
+    query->sort_key_kind = kind;
+    query->sort_key_offset = offset;
+
+    order_by(world, query, sort_component, NULL, sort_flags | EcsQuerySortKey);
+}
+
+void ecs_query_order_by_key(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset)
+{
+    order_by_key(world, query, sort_component, kind, offset, 0);
+}
+
+void ecs_query_order_by_key_rows(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset)
+{
+    order_by_key(world, query, sort_component, kind, offset, 
+        EcsQuerySortRows);
+}
+
 void ecs_query_group_by(
     ecs_world_t *world,
     ecs_query_t *query,
@@ -18068,7 +21828,10 @@ void ecs_query_group_by(
 
     order_ranked_tables(world, query);
 
-    build_sorted_tables(query);
+    /* Only sorted queries iterate slices */
+    if (query->compare || (query->flags & EcsQuerySortKey)) {
+        build_sorted_tables(query, NULL);
+    }
 }
 
 bool ecs_query_changed(
@@ -18180,10 +21943,12 @@ int32_t bitset_column_count(
 
 static
 ecs_type_t entities_to_type(
+    ecs_world_t *world,
     ecs_entities_t *entities)
 {
     if (entities->count) {
-        ecs_vector_t *result = NULL;
+        ecs_vector_t *result = ecs_vector_new_w_pool(
+            world->pools[EcsPoolTypes], ecs_entity_t, entities->count);
         ecs_vector_set_count(&result, ecs_entity_t, entities->count);
         ecs_entity_t *array = ecs_vector_first(result, ecs_entity_t);
         ecs_os_memcpy(array, entities->array, ECS_SIZEOF(ecs_entity_t) * entities->count);
@@ -18216,22 +21981,137 @@ void register_child_table(
     ecs_map_set(world->child_tables, parent, &child_tables);
 }
 
+static
+void unregister_child_table(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_entity_t parent)
+{
+    ecs_vector_t *child_tables = ecs_map_get_ptr(
+            world->child_tables, ecs_vector_t*, parent);
+    
+    ecs_table_t **array = ecs_vector_first(child_tables, ecs_table_t*);
+    int32_t i, count = ecs_vector_count(child_tables);
+    for (i = 0; i < count; i ++) {
+        if (array[i] == table) {
+            break;
+        }
+    }
+
+    /* Table can be missing if the parent is being deleted */
+    if (i == count) {
+        return;
+    }
+
+    /* Don't swap with last element, so tables remain in creation order */
+    ecs_os_memmove(&array[i], &array[i + 1], 
+        ECS_SIZEOF(ecs_table_t*) * (count - i - 1));
+    ecs_vector_remove_last(child_tables);
+}
+
+static
+void register_component_table(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_entity_t component)
+{
+    ecs_vector_t *tables = ecs_map_get_ptr(
+        world->store.component_tables, ecs_vector_t*, component);
+
+    ecs_table_t **el = ecs_vector_add(&tables, ecs_table_t*);
+    *el = table;
+
+    ecs_map_set(world->store.component_tables, component, &tables);
+}
+
+static
+void unregister_component_table(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_entity_t component)
+{
+    ecs_vector_t *tables = ecs_map_get_ptr(
+        world->store.component_tables, ecs_vector_t*, component);
+
+    ecs_table_t **array = ecs_vector_first(tables, ecs_table_t*);
+    int32_t i, count = ecs_vector_count(tables);
+    for (i = 0; i < count; i ++) {
+        if (array[i] == table) {
+            break;
+        }
+    }
+
+    ecs_assert(i != count, ECS_INTERNAL_ERROR, NULL);
+
+    /* Don't swap with last element, so tables remain in creation order */
+    ecs_os_memmove(&array[i], &array[i + 1], 
+        ECS_SIZEOF(ecs_table_t*) * (count - i - 1));
+    ecs_vector_remove_last(tables);
+}
+
+static
+void register_component_tables(
+    ecs_world_t * world,
+    ecs_table_t * table)
+{
+    ecs_entity_t *entities = ecs_vector_first(table->type, ecs_entity_t);
+    int32_t i, count = ecs_vector_count(table->type);
+
+    for (i = 0; i < count; i ++) {
+        register_component_table(world, table, entities[i]);
+    }
+
+    if (table->flags & EcsTableHasBase) {
+        register_component_table(world, table, ECS_INSTANCEOF);
+    }
+}
+
+static
+void invalidate_edge_cache(
+    ecs_table_t *node)
+{
+    ecs_os_memset(node->edge_cache, 0, ECS_SIZEOF(node->edge_cache));
+}
+
+/* Edges are stored in a map that only contains entries for components that
+ * have been added to or removed from the table. The most recently used edges
+ * are cached inline, so that repeatedly adding/removing the same components
+ * does not require a map lookup. */
 static
 ecs_edge_t* get_edge(
     ecs_table_t *node,
     ecs_entity_t e)
 {
-    if (e < ECS_HI_COMPONENT_ID) {
-        if (!node->lo_edges) {
-            node->lo_edges = ecs_os_calloc(sizeof(ecs_edge_t) * ECS_HI_COMPONENT_ID);
-        }
-        return &node->lo_edges[e];
-    } else {
-        if (!node->hi_edges) {
-            node->hi_edges = ecs_map_new(ecs_edge_t, 1);
-        }
-        return ecs_map_ensure(node->hi_edges, ecs_edge_t, e);
+    ecs_edge_cache_t *cache = &node->edge_cache[e & (ECS_EDGE_CACHE_SIZE - 1)];
+    if (cache->id == e) {
+        return cache->edge;
+    }
+
+    ecs_map_t *edges = node->edges;
+    if (!edges) {
+        edges = node->edges = ecs_map_new(ecs_edge_t, 1);
+    }
+
+    ecs_edge_t *edge = ecs_map_get(edges, ecs_edge_t, e);
+    if (!edge) {
+        /* Inserting may move existing edges, which invalidates the cache */
+        edge = ecs_map_ensure(edges, ecs_edge_t, e);
+        invalidate_edge_cache(node);
     }
+
+    cache->id = e;
+    cache->edge = edge;
+
+    return edge;
+}
+
+static
+void remove_edge(
+    ecs_table_t *node,
+    ecs_entity_t e)
+{
+    ecs_map_remove(node->edges, e);
+    invalidate_edge_cache(node);
 }
 
 static
@@ -18242,8 +22122,8 @@ void init_edges(
     ecs_entity_t *entities = ecs_vector_first(table->type, ecs_entity_t);
     int32_t count = ecs_vector_count(table->type);
 
-    table->lo_edges = NULL;
-    table->hi_edges = NULL;
+    table->edges = NULL;
+    invalidate_edge_cache(table);
     
     /* Make add edges to own components point to self */
     int32_t i;
@@ -18279,6 +22159,10 @@ void init_edges(
             table->flags |= EcsTableHasComponentData;
         }
 
+        if (e == ecs_typeid(EcsName)) {
+            table->flags |= EcsTableHasName;
+        }
+
         if (ECS_HAS_ROLE(e, XOR)) {
             table->flags |= EcsTableHasXor;
         }
@@ -18318,13 +22202,68 @@ void init_edges(
     }
 }
 
+/* Find type of a deleted table with the same components */
+static
+ecs_type_t find_retired_type(
+    ecs_world_t * world,
+    ecs_entities_t * entities,
+    uint64_t hash)
+{
+    ecs_vector_t *types = ecs_map_get_ptr(
+        world->store.retired_types, ecs_vector_t*, hash);
+    if (!types) {
+        return NULL;
+    }
+
+    ecs_type_t *array = ecs_vector_first(types, ecs_type_t);
+    int32_t i, count = ecs_vector_count(types);
+    for (i = 0; i < count; i ++) {
+        ecs_type_t type = array[i];
+        if (ecs_vector_count(type) != entities->count) {
+            continue;
+        }
+
+        if (ecs_os_memcmp(ecs_vector_first(type, ecs_entity_t), 
+            entities->array, ECS_SIZEOF(ecs_entity_t) * entities->count))
+        {
+            continue;
+        }
+
+        ecs_vector_remove_index(types, ecs_type_t, i);
+        if (!ecs_vector_count(types)) {
+            ecs_vector_free(types);
+            ecs_map_remove(world->store.retired_types, hash);
+        }
+
+        return type;
+    }
+
+    return NULL;
+}
+
+static
+ecs_type_t find_or_create_type(
+    ecs_world_t * world,
+    ecs_entities_t * entities,
+    uint64_t hash)
+{
+    ecs_type_t type = NULL;
+    if (entities->count) {
+        type = find_retired_type(world, entities, hash);
+    }
+
+    if (!type) {
+        type = entities_to_type(world, entities);
+    }
+
+    return type;
+}
+
 static
 void init_table(
     ecs_world_t * world,
-    ecs_table_t * table,
-    ecs_entities_t * entities)
+    ecs_table_t * table)
 {
-    table->type = entities_to_type(entities);
     table->c_info = NULL;
     table->data = NULL;
     table->flags = 0;
@@ -18335,6 +22274,12 @@ void init_table(
     table->on_set_override = NULL;
     table->un_set_all = NULL;
     table->alloc_count = 0;
+    table->gc_frame = 0;
+    table->gc_index = -1;
+    table->chunk_head = NULL;
+    table->chunks = NULL;
+    table->chunk_tail = NULL;
+    table->chunk_free = NULL;
 
     table->queries = NULL;
     table->column_count = data_column_count(world, table);
@@ -18352,9 +22297,12 @@ ecs_table_t *create_table(
 {
     ecs_table_t *result = ecs_sparse_add(world->store.tables, ecs_table_t);
     result->id = ecs_to_u32(ecs_sparse_last_id(world->store.tables));
+    result->hash = hash;
 
     ecs_assert(result != NULL, ECS_INTERNAL_ERROR, NULL);
-    init_table(world, result, entities);
+    result->type = find_or_create_type(world, entities, hash);
+    init_table(world, result);
+    register_component_tables(world, result);
 
 #ifndef NDEBUG
     char *expr = ecs_type_str(world, result->type);
@@ -18368,6 +22316,56 @@ ecs_table_t *create_table(
     ecs_table_t **elem = ecs_vector_add(&tables, ecs_table_t*);
     *elem = result;
     ecs_map_set(world->store.table_map, hash, &tables);
+    ecs_map_set(world->store.type_index, (uintptr_t)result->type, &result);
+
+    ecs_notify_queries(world, &(ecs_query_event_t) {
+        .kind = EcsQueryTableMatch,
+        .table = result
+    });
+
+    /* Tables are created empty, and may never be populated if they were only
+     * created while traversing to another table */
+    ecs_table_gc_enqueue(world, result);
+
+    ecs_log_pop();
+
+    return result;
+}
+
+/* Create a table with the same type as head, of which the columns have room
+ * for size entities. Chunks are matched with queries, and show up in the child
+ * and component tables of their type, but are not added to the lookup maps so
+ * that finding a table by type always returns the head. */
+static
+ecs_table_t *create_chunk(
+    ecs_world_t * world,
+    ecs_table_t * head,
+    int32_t size)
+{
+    ecs_table_t *result = ecs_sparse_add(world->store.tables, ecs_table_t);
+    ecs_assert(result != NULL, ECS_INTERNAL_ERROR, NULL);
+    result->id = ecs_to_u32(ecs_sparse_last_id(world->store.tables));
+    result->hash = head->hash;
+    result->type = head->type;
+
+    init_table(world, result);
+    register_component_tables(world, result);
+    result->chunk_head = head;
+
+    ecs_table_t **elem = ecs_vector_add(&head->chunks, ecs_table_t*);
+    *elem = result;
+
+#ifndef NDEBUG
+    char *expr = ecs_type_str(world, result->type);
+    ecs_trace_2("table #[green][%s]#[normal] chunk %d created", 
+        expr, ecs_vector_count(head->chunks));
+    ecs_os_free(expr);
+#endif
+    ecs_log_push();
+
+    /* Allocate columns once, so that they are never reallocated */
+    ecs_data_t *data = ecs_table_get_or_create_data(result);
+    ecs_table_set_size(world, result, data, size);
 
     ecs_notify_queries(world, &(ecs_query_event_t) {
         .kind = EcsQueryTableMatch,
@@ -18379,6 +22377,136 @@ ecs_table_t *create_table(
     return result;
 }
 
+static
+bool chunk_has_space(
+    ecs_table_t * chunk,
+    int32_t chunk_size,
+    int32_t count)
+{
+    ecs_data_t *data = ecs_table_get_data(chunk);
+    int32_t size = chunk_size, used = 0;
+    if (data) {
+        ecs_vector_t *entities = data->entities;
+        used = ecs_vector_count(entities);
+        size = ECS_MAX(size, ecs_vector_size(entities));
+    }
+
+    return (used + count) <= size;
+}
+
+/* Make sure columns of a chunk have room for the chunk size */
+static
+ecs_table_t* use_chunk(
+    ecs_world_t * world,
+    ecs_table_t * head,
+    ecs_table_t * chunk,
+    int32_t chunk_size)
+{
+    head->chunk_tail = chunk;
+    if (chunk != head) {
+        /* Columns of an empty chunk may have been reclaimed */
+        ecs_data_t *data = ecs_table_get_or_create_data(chunk);
+        if (ecs_vector_size(data->entities) < chunk_size) {
+            ecs_table_set_size(world, chunk, data, chunk_size);
+        }
+    }
+    return chunk;
+}
+
+ecs_table_t* ecs_table_get_chunk(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    int32_t count)
+{
+    int32_t chunk_size = world->table_chunk_size;
+    if (!chunk_size || !table->type) {
+        return table;
+    }
+
+    ecs_table_t *head = table->chunk_head;
+    if (!head) {
+        head = table;
+    }
+
+    /* Append to the chunk that was last appended to. If it is full, use a
+     * chunk from which entities have been removed before creating one. */
+    ecs_table_t *chunk = head->chunk_tail;
+    if (!chunk) {
+        chunk = head;
+    }
+
+    if (chunk_has_space(chunk, chunk_size, count)) {
+        return use_chunk(world, head, chunk, chunk_size);
+    }
+
+    ecs_table_t **elem;
+    while ((elem = ecs_vector_last(head->chunk_free, ecs_table_t*))) {
+        chunk = *elem;
+        ecs_vector_remove_last(head->chunk_free);
+        if (chunk_has_space(chunk, chunk_size, count)) {
+            return use_chunk(world, head, chunk, chunk_size);
+        }
+    }
+
+    chunk = create_chunk(world, head, ECS_MAX(chunk_size, count));
+    head->chunk_tail = chunk;
+
+    return chunk;
+}
+
+void ecs_table_chunk_has_space(
+    ecs_table_t * table)
+{
+    ecs_table_t *head = table->chunk_head;
+    if (!head) {
+        if (!table->chunks) {
+            return;
+        }
+        head = table;
+    }
+
+    /* The tail is always tried first */
+    ecs_table_t *tail = head->chunk_tail ? head->chunk_tail : head;
+    if (table != tail) {
+        ecs_table_t **elem = ecs_vector_add(&head->chunk_free, ecs_table_t*);
+        *elem = table;
+    }
+}
+
+/* Remove all occurrences of a chunk from a list of chunks */
+static
+bool remove_chunk_from(
+    ecs_vector_t *chunks,
+    ecs_table_t * table)
+{
+    ecs_table_t **array = ecs_vector_first(chunks, ecs_table_t*);
+    int32_t i, count = ecs_vector_count(chunks);
+    bool found = false;
+    for (i = count - 1; i >= 0; i --) {
+        if (array[i] == table) {
+            ecs_vector_remove_index(chunks, ecs_table_t*, i);
+            found = true;
+        }
+    }
+    return found;
+}
+
+void ecs_table_remove_chunk(
+    ecs_table_t * table)
+{
+    ecs_table_t *head = table->chunk_head;
+    ecs_assert(head != NULL, ECS_INTERNAL_ERROR, NULL);
+    bool found = remove_chunk_from(head->chunks, table);
+    ecs_assert(found, ECS_INTERNAL_ERROR, NULL);
+    (void)found;
+
+    remove_chunk_from(head->chunk_free, table);
+
+    if (head->chunk_tail == table) {
+        head->chunk_tail = NULL;
+    }
+}
+
 static
 void add_entity_to_type(
     ecs_type_t type,
@@ -18612,6 +22740,24 @@ ecs_table_t *find_or_create_table_exclude(
     return result;    
 }
 
+/* Get the component info of a component that is part of a hot/cold pair */
+static
+const ecs_c_info_t* get_split_info(
+    ecs_world_t * world,
+    ecs_entity_t e)
+{
+    if (e & ECS_ROLE_MASK) {
+        return NULL;
+    }
+
+    const ecs_c_info_t *c_info = ecs_get_c_info(world, e);
+    if (c_info && (c_info->cold || c_info->hot)) {
+        return c_info;
+    }
+
+    return NULL;
+}
+
 ecs_table_t* ecs_table_traverse_remove(
     ecs_world_t * world,
     ecs_table_t * node,
@@ -18622,12 +22768,30 @@ ecs_table_t* ecs_table_traverse_remove(
     ecs_entity_t *entities = to_remove->array;
     node = node ? node : &world->store.root;
 
+    ecs_entity_t cold_array[ECS_MAX_ADD_REMOVE];
+    ecs_entities_t cold = {
+        .array = cold_array,
+        .count = 0
+    };
+
     for (i = 0; i < count; i ++) {
         ecs_entity_t e = entities[i];
 
         /* Removing 0 from an entity is not valid */
         ecs_assert(e != 0, ECS_INVALID_PARAMETER, NULL);
 
+        const ecs_c_info_t *split = NULL;
+        if (node->flags & EcsTableHasColdParts) {
+            split = get_split_info(world, e);
+
+            /* The cold part stays for as long as the entity has the hot part */
+            if (split && split->hot && 
+                ecs_type_index_of(node->type, split->hot) != -1) 
+            {
+                continue;
+            }
+        }
+
         ecs_edge_t *edge = get_edge(node, e);
         ecs_table_t *next = edge->remove;
 
@@ -18639,7 +22803,12 @@ ecs_table_t* ecs_table_traverse_remove(
                     return NULL;
                 }
 
-                edge->remove = next;
+                /* Only cache the edge if next links back to node, so that the
+                 * edge can be cleared when either table is deleted. Creating a
+                 * table can insert edges, so look up edge again. */
+                if (next == node || get_edge(next, e)->add == node) {
+                    get_edge(node, e)->remove = next;
+                }
             } else {
                 /* If the add edge does not point to self, the table
                  * does not have the entity in to_remove. */
@@ -18652,8 +22821,19 @@ ecs_table_t* ecs_table_traverse_remove(
             removed->array[removed->count ++] = e; 
         }
 
+        if ((node != next) && split && split->cold) {
+            ecs_assert(cold.count < ECS_MAX_ADD_REMOVE, 
+                ECS_INVALID_PARAMETER, NULL);
+            cold.array[cold.count ++] = split->cold;
+        }
+
         node = next;
-    }    
+    }
+
+    /* Remove the cold parts of removed components */
+    if (cold.count) {
+        node = ecs_table_traverse_remove(world, node, &cold, removed);
+    }
 
     return node;
 }
@@ -18723,7 +22903,13 @@ ecs_table_t* ecs_table_traverse_add(
         if (!next) {
             next = find_or_create_table_include(world, node, e);
             ecs_assert(next != NULL, ECS_INTERNAL_ERROR, NULL);
-            edge->add = next;
+
+            /* Only cache the edge if next links back to node, so that the
+             * edge can be cleared when either table is deleted. Creating a
+             * table can insert edges, so look up edge again. */
+            if (next == node || get_edge(next, e)->remove == node) {
+                get_edge(node, e)->add = next;
+            }
         }
 
         bool has_case = ECS_HAS_ROLE(e, CASE);
@@ -18733,12 +22919,22 @@ ecs_table_t* ecs_table_traverse_add(
 
         if ((node != next) && ECS_HAS_ROLE(e, INSTANCEOF)) {
             find_owned_components(world, next, ECS_COMPONENT_MASK & e, &owned);
-        }        
+        }
+
+        /* A component with a cold part is never added without it */
+        if ((node != next) && (next->flags & EcsTableHasColdParts)) {
+            const ecs_c_info_t *split = get_split_info(world, e);
+            if (split && split->cold) {
+                ecs_assert(owned.count < ECS_MAX_ADD_REMOVE, 
+                    ECS_INVALID_PARAMETER, NULL);
+                owned.array[owned.count ++] = split->cold;
+            }
+        }
 
         node = next;
     }
 
-    /* In case OWNED components were found, add them as well */
+    /* In case OWNED components or cold parts were found, add them as well */
     if (owned.count) {
         node = ecs_table_traverse_add(world, node, &owned, added);
     }
@@ -18746,6 +22942,33 @@ ecs_table_t* ecs_table_traverse_add(
     return node;
 }
 
+ecs_table_t* ecs_table_add_cold_parts(
+    ecs_world_t * world,
+    ecs_table_t * table)
+{
+    if (!(table->flags & EcsTableHasColdParts)) {
+        return table;
+    }
+
+    ecs_entity_t cold_array[ECS_MAX_ADD_REMOVE];
+    ecs_entities_t cold = {
+        .array = cold_array,
+        .count = 0
+    };
+
+    int32_t i, count = table->column_count;
+    for (i = 0; i < count; i ++) {
+        ecs_c_info_t *c_info = table->c_info[i];
+        if (c_info && c_info->cold) {
+            ecs_assert(cold.count < ECS_MAX_ADD_REMOVE, 
+                ECS_INVALID_PARAMETER, NULL);
+            cold.array[cold.count ++] = c_info->cold;
+        }
+    }
+
+    return ecs_table_traverse_add(world, table, &cold, NULL);
+}
+
 static
 int ecs_entity_compare(
     const void *e1,
@@ -18897,7 +23120,7 @@ ecs_table_t *find_or_create(
     }
 
     uint64_t hash = 0;
-    ecs_hash(ordered, entities->count * ECS_SIZEOF(ecs_entity_t), &hash);
+    ecs_hash(ordered, type_count * ECS_SIZEOF(ecs_entity_t), &hash);
     ecs_vector_t *table_vec = ecs_map_get_ptr(
         world->store.table_map, ecs_vector_t*, hash);
     if (table_vec) {
@@ -18969,6 +23192,14 @@ ecs_table_t* ecs_table_from_type(
     ecs_world_t *world,
     ecs_type_t type)
 {
+    /* Types are usually owned by a table, in which case the table can be
+     * found without hashing the type. */
+    ecs_table_t *table = ecs_map_get_ptr(
+        world->store.type_index, ecs_table_t*, (uintptr_t)type);
+    if (table) {
+        return table;
+    }
+
     ecs_entities_t components = ecs_type_to_entities(type);
     return ecs_table_find_or_create(
         world, &components);
@@ -18982,47 +23213,244 @@ void ecs_init_root_table(
         .count = 0
     };
 
-    init_table(world, &world->store.root, &entities);
+    world->store.root.type = find_or_create_type(world, &entities, 0);
+    init_table(world, &world->store.root);
 }
 
-void ecs_table_clear_edges(
+static
+void remove_from_type_index(
     ecs_world_t *world,
     ecs_table_t *table)
 {
-    (void)world;
+    ecs_vector_t *tables = ecs_map_get_ptr(
+        world->store.table_map, ecs_vector_t*, table->hash);
+    ecs_table_t **array = ecs_vector_first(tables, ecs_table_t*);
+    int32_t i, count = ecs_vector_count(tables);
+    for (i = 0; i < count; i ++) {
+        if (array[i] == table) {
+            ecs_vector_remove_index(tables, ecs_table_t*, i);
+            break;
+        }
+    }
 
-    uint32_t i;
+    ecs_assert(i != count, ECS_INTERNAL_ERROR, NULL);
 
-    if (table->lo_edges) {
-        for (i = 0; i < ECS_HI_COMPONENT_ID; i ++) {
-            ecs_edge_t *e = &table->lo_edges[i];
-            ecs_table_t *add = e->add, *remove = e->remove;
-            if (add) {
-                add->lo_edges[i].remove = NULL;
-            }
-            if (remove) {
-                remove->lo_edges[i].add = NULL;
+    if (!ecs_vector_count(tables)) {
+        ecs_vector_free(tables);
+        ecs_map_remove(world->store.table_map, table->hash);
+    }
+
+    ecs_map_remove(world->store.type_index, (uintptr_t)table->type);
+}
+
+void ecs_table_index_remove(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_entity_t *entities = ecs_vector_first(table->type, ecs_entity_t);
+    int32_t i, count = ecs_vector_count(table->type);
+
+    for (i = 0; i < count; i ++) {
+        unregister_component_table(world, table, entities[i]);
+    }
+
+    if (table->flags & EcsTableHasBase) {
+        unregister_component_table(world, table, ECS_INSTANCEOF);
+    }
+
+    /* Chunks are not stored in the type lookup maps */
+    if (!table->chunk_head) {
+        remove_from_type_index(world, table);
+    }
+
+    /* Remove table from parent, or from root tables */
+    if (table->flags & EcsTableHasParent) {
+        ecs_vector_each(table->type, ecs_entity_t, e_ptr, {
+            if (ECS_HAS_ROLE(*e_ptr, CHILDOF)) {
+                unregister_child_table(
+                    world, table, *e_ptr & ECS_COMPONENT_MASK);
             }
+        });
+    } else {
+        unregister_child_table(world, table, 0);
+    }
+}
+
+void ecs_table_retire_type(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_type_t type = table->type;
+    if (!type) {
+        return;
+    }
+
+    if (!world->store.retired_types) {
+        world->store.retired_types = ecs_map_new(ecs_vector_t*, 1);
+    }
+
+    ecs_vector_t *types = ecs_map_get_ptr(
+        world->store.retired_types, ecs_vector_t*, table->hash);
+    ecs_type_t *elem = ecs_vector_add(&types, ecs_type_t);
+    *elem = type;
+    ecs_map_set(world->store.retired_types, table->hash, &types);
+
+    table->type = NULL;
+}
+
+bool ecs_table_index_supports(
+    ecs_entity_t component)
+{
+    if (!(component & ECS_COMPONENT_MASK)) {
+        return false;
+    }
+
+    /* Traits may be matched by wildcard, and cases are matched by the switch
+     * of the table. Tables for these can't be found with a single lookup. */
+    return !(component & ECS_ROLE_MASK) || 
+        ECS_HAS_ROLE(component, CHILDOF) || 
+        ECS_HAS_ROLE(component, INSTANCEOF);
+}
+
+int32_t ecs_table_index_count(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    bool inherited)
+{
+    int32_t count = ecs_vector_count(ecs_map_get_ptr(
+        world->store.component_tables, ecs_vector_t*, component));
+
+    if (inherited) {
+        count += ecs_vector_count(ecs_map_get_ptr(
+            world->store.component_tables, ecs_vector_t*, ECS_INSTANCEOF));
+    }
+
+    return count;
+}
+
+ecs_table_t* ecs_table_index_next(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    bool inherited,
+    int32_t *index,
+    int32_t *base_index)
+{
+    ecs_vector_t *tables = ecs_map_get_ptr(
+        world->store.component_tables, ecs_vector_t*, component);
+    ecs_table_t **array = ecs_vector_first(tables, ecs_table_t*);
+    int32_t count = ecs_vector_count(tables);
+
+    ecs_table_t **base_array = NULL;
+    int32_t base_count = 0;
+
+    if (inherited) {
+        ecs_vector_t *base_tables = ecs_map_get_ptr(
+            world->store.component_tables, ecs_vector_t*, ECS_INSTANCEOF);
+        base_array = ecs_vector_first(base_tables, ecs_table_t*);
+        base_count = ecs_vector_count(base_tables);
+
+        /* Tables with a base that own the component are already visited */
+        while (*base_index < base_count && ecs_type_index_of(
+            base_array[*base_index]->type, component) != -1)
+        {
+            (*base_index) ++;
+        }
+    }
+
+    /* Interleave both lists so that tables are returned in creation order */
+    if (*index < count) {
+        ecs_table_t *table = array[*index];
+        if (*base_index < base_count && base_array[*base_index]->id < table->id) {
+            return base_array[(*base_index) ++];
+        }
+
+        (*index) ++;
+        return table;
+    } else if (*base_index < base_count) {
+        return base_array[(*base_index) ++];
+    }
+
+    return NULL;
+}
+
+static
+void free_move_map(
+    ecs_move_map_t **map)
+{
+    if (*map) {
+        ecs_os_free(*map);
+        *map = NULL;
+    }
+}
+
+const ecs_move_map_t* ecs_table_get_move_map(
+    ecs_table_t *src,
+    ecs_data_t *src_data,
+    ecs_table_t *dst,
+    ecs_data_t *dst_data,
+    ecs_entity_t e,
+    bool add)
+{
+    ecs_edge_t *edge = get_edge(src, e);
+    ecs_move_map_t **map;
+
+    /* Edges point to the first chunk of a type. All chunks of a type have the
+     * same columns, so the map of an edge is valid for each of its chunks. */
+    ecs_table_t *head = dst->chunk_head ? dst->chunk_head : dst;
+
+    if (add) {
+        if (edge->add != head) {
+            return NULL;
+        }
+        map = &edge->add_map;
+    } else {
+        if (edge->remove != head) {
+            return NULL;
         }
+        map = &edge->remove_map;
+    }
+
+    if (!*map) {
+        *map = ecs_move_map_new(dst, dst_data, src, src_data);
     }
 
-    ecs_map_iter_t it = ecs_map_iter(table->hi_edges);
+    return *map;
+}
+
+void ecs_table_clear_edges(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    (void)world;
+
+    ecs_map_iter_t it = ecs_map_iter(table->edges);
     ecs_edge_t *edge;
     ecs_map_key_t component;
     while ((edge = ecs_map_next(&it, ecs_edge_t, &component))) {
         ecs_table_t *add = edge->add, *remove = edge->remove;
-        if (add) {
+
+        free_move_map(&edge->add_map);
+        free_move_map(&edge->remove_map);
+
+        /* Edges that point to self are cleaned up with the table */
+        if (add && add != table) {
             ecs_edge_t *e = get_edge(add, component);
-            e->remove = NULL;
-            if (!e->add) {
-                ecs_map_remove(add->hi_edges, component);
+            if (e->remove == table) {
+                e->remove = NULL;
+                free_move_map(&e->remove_map);
+            }
+            if (!e->add && !e->remove) {
+                remove_edge(add, component);
             }
         }
-        if (remove) {
+        if (remove && remove != table) {
             ecs_edge_t *e = get_edge(remove, component);
-            e->add = NULL;
-            if (!e->remove) {
-                ecs_map_remove(remove->hi_edges, component);
+            if (e->add == table) {
+                e->add = NULL;
+                free_move_map(&e->add_map);
+            }
+            if (!e->add && !e->remove) {
+                remove_edge(remove, component);
             }
         }
     }
@@ -19032,20 +23460,32 @@ void ecs_table_clear_edges(
  * (element_count * LOAD_FACTOR) > bucket_count, bucket count is increased. */
 #define LOAD_FACTOR (1.5)
 #define KEY_SIZE (ECS_SIZEOF(ecs_map_key_t))
-#define GET_ELEM(array, elem_size, index) \
-    ECS_OFFSET(array, (elem_size) * (index))
-
-struct ecs_bucket_t {
-    ecs_map_key_t *keys;    /* Array with keys */
-    void *payload;          /* Payload array */
-    int32_t count;          /* Number of elements in bucket */
-};
 
+/* Probe distances are stored in a byte, offset by one so that 0 means empty.
+ * Larger distances are stored as MAX_DIST. */
+#define MAX_DIST (255)
+
+#define GET_SLOT(map, index) \
+    ECS_OFFSET((map)->slots, (map)->slot_size * (index))
+#define GET_KEY(map, index) \
+    (*(ecs_map_key_t*)GET_SLOT(map, index))
+#define GET_ELEM(map, index) \
+    ECS_OFFSET(GET_SLOT(map, index), KEY_SIZE)
+
+/* The map uses open addressing with Robin Hood hashing. Keys and payloads are
+ * stored together in a single slot array, so that a lookup typically touches a
+ * single cache line. A separate byte array stores the probe distance for each
+ * slot. Because elements that are far from their home slot take the place of
+ * elements that are closer to theirs, lookups can stop as soon as they
+ * encounter a slot with a smaller probe distance than the current one. */
 struct ecs_map_t {
-    ecs_bucket_t *buckets;
-    int32_t elem_size;
-    int32_t bucket_count;
-    int32_t count;
+    void *slots;            /* Key + payload for each slot */
+    uint8_t *dist;          /* Probe distance + 1 for each slot, 0 if empty */
+    int32_t elem_size;      /* Size of payload */
+    int32_t slot_size;      /* Size of key + aligned payload */
+    int32_t bucket_count;   /* Number of slots, always a power of 2 */
+    int32_t shift;          /* 32 - log2(bucket_count), used by get_home */
+    int32_t count;          /* Number of elements in map */
 };
 
 /* Get bucket count for number of elements */
@@ -19056,160 +23496,118 @@ int32_t get_bucket_count(
     return ecs_next_pow_of_2((int32_t)((float)element_count * LOAD_FACTOR));
 }
 
-/* Get bucket index for provided map key */
-static
-int32_t get_bucket_id(
-    int32_t bucket_count,
-    ecs_map_key_t key) 
-{
-    ecs_assert(bucket_count > 0, ECS_INTERNAL_ERROR, NULL);
-    int32_t result = (int32_t)(key & ((uint64_t)bucket_count - 1));
-    ecs_assert(result < INT32_MAX, ECS_INTERNAL_ERROR, NULL);
-    return result;
-}
-
-/* Get bucket for key */
+/* Get home slot for provided map key. All 64 bits of the key are mixed with a
+ * multiplicative (Fibonacci) hash, of which the upper bits select the slot. 
+ * This spreads sequential ids (entities, tables) evenly, as well as keys that
+ * only differ in their upper half (like traits or keys that combine two ids).*/
 static
-ecs_bucket_t* get_bucket(
+int32_t get_home(
     const ecs_map_t *map,
     ecs_map_key_t key)
 {
-    int32_t bucket_count = map->bucket_count;
-    if (!bucket_count) {
-        return NULL;
-    }
-
-    int32_t bucket_id = get_bucket_id(bucket_count, key);
-    ecs_assert(bucket_id < bucket_count, ECS_INTERNAL_ERROR, NULL);
-
-    return &map->buckets[bucket_id];
-}
-
-/* Ensure that map has at least new_count buckets */
-static
-void ensure_buckets(
-    ecs_map_t *map,
-    int32_t new_count)
-{
-    int32_t bucket_count = map->bucket_count;
-    new_count = ecs_next_pow_of_2(new_count);
-    if (new_count && new_count > bucket_count) {
-        map->buckets = ecs_os_realloc(map->buckets, new_count * ECS_SIZEOF(ecs_bucket_t));
-        map->bucket_count = new_count;
-
-        ecs_os_memset(
-            ECS_OFFSET(map->buckets, bucket_count * ECS_SIZEOF(ecs_bucket_t)), 
-            0, (new_count - bucket_count) * ECS_SIZEOF(ecs_bucket_t));
-    }
-}
-
-/* Free contents of bucket */
-static
-void clear_bucket(
-    ecs_bucket_t *bucket)
-{
-    ecs_os_free(bucket->keys);
-    ecs_os_free(bucket->payload);
-    bucket->keys = NULL;
-    bucket->payload = NULL;
-    bucket->count = 0;
+    ecs_assert(map->bucket_count > 0, ECS_INTERNAL_ERROR, NULL);
+    uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+    return (int32_t)((hash >> 32) >> map->shift);
 }
 
-/* Clear all buckets */
+/* Scratch slots at the end of the slot array, used when swapping elements */
 static
-void clear_buckets(
-    ecs_map_t *map)
+void* get_scratch(
+    const ecs_map_t *map,
+    int32_t index)
 {
-    ecs_bucket_t *buckets = map->buckets;
-    int32_t i, count = map->bucket_count;
-    for (i = 0; i < count; i ++) {
-        clear_bucket(&buckets[i]);
-    }
-    ecs_os_free(buckets);
-    map->buckets = NULL;
-    map->bucket_count = 0;
+    return GET_SLOT(map, map->bucket_count + index);
 }
 
-/* Find or create bucket for specified key */
+/* Find slot for key, returns -1 if key is not in map */
 static
-ecs_bucket_t* ensure_bucket(
-    ecs_map_t *map,
+int32_t find_slot(
+    const ecs_map_t *map,
     ecs_map_key_t key)
 {
-    if (!map->bucket_count) {
-        ensure_buckets(map, 2);
+    if (!map->count) {
+        return -1;
     }
 
-    int32_t bucket_id = get_bucket_id(map->bucket_count, key);
-    ecs_assert(bucket_id >= 0, ECS_INTERNAL_ERROR, NULL);
-    return &map->buckets[bucket_id];
-}
+    int32_t mask = map->bucket_count - 1;
+    int32_t index = get_home(map, key);
+    int32_t dist = 1;
+    uint8_t *dist_array = map->dist;
 
-/* Add element to bucket */
-static
-int32_t add_to_bucket(
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
-    ecs_map_key_t key,
-    const void *payload)
-{
-    int32_t index = bucket->count ++;
-    int32_t bucket_count = index + 1;
+    for (;;) {
+        int32_t slot_dist = dist_array[index];
+        if (slot_dist < dist) {
+            /* Slot is empty or the element in the slot is closer to its home
+             * than key would be, so key can't be further down */
+            return -1;
+        }
 
-    bucket->keys = ecs_os_realloc(bucket->keys, KEY_SIZE * bucket_count);
-    bucket->payload = ecs_os_realloc(bucket->payload, elem_size * bucket_count);
-    bucket->keys[index] = key;
+        if (slot_dist == dist && GET_KEY(map, index) == key) {
+            return index;
+        }
 
-    if (payload) {
-        void *elem = GET_ELEM(bucket->payload, elem_size, index);
-        ecs_os_memcpy(elem, payload, elem_size);
+        index = (index + 1) & mask;
+        if (dist < MAX_DIST) {
+            dist ++;
+        }
     }
-
-    return index;
 }
 
-/*  Remove element from bucket */
+/* Insert slot contents (key + payload) in map. Key must not be in the map.
+ * Returns the slot in which the element is stored. */
 static
-void remove_from_bucket(
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
-    ecs_map_key_t key,
-    int32_t index)
-{
-    (void)key;
-
-    ecs_assert(bucket->count != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(index < bucket->count, ECS_INTERNAL_ERROR, NULL);
-    
-    int32_t bucket_count = -- bucket->count;
-
-    if (index != bucket->count) {
-        ecs_assert(key == bucket->keys[index], ECS_INTERNAL_ERROR, NULL);
-        bucket->keys[index] = bucket->keys[bucket_count];
-
-        ecs_map_key_t *elem = GET_ELEM(bucket->payload, elem_size, index);
-        ecs_map_key_t *last_elem = GET_ELEM(bucket->payload, elem_size, bucket->count);
+int32_t insert_slot(
+    ecs_map_t *map,
+    void *slot)
+{
+    ecs_size_t slot_size = map->slot_size;
+    ecs_map_key_t key = *(ecs_map_key_t*)slot;
+
+    /* cur holds the element that is being inserted, tmp is used for swapping */
+    void *cur = get_scratch(map, 0);
+    void *tmp = get_scratch(map, 1);
+    if (slot != cur) {
+        ecs_os_memcpy(cur, slot, slot_size);
+    }
+
+    int32_t mask = map->bucket_count - 1;
+    int32_t index = get_home(map, key);
+    int32_t dist = 1, result = -1;
+    uint8_t *dist_array = map->dist;
+
+    for (;;) {
+        int32_t slot_dist = dist_array[index];
+        if (!slot_dist) {
+            ecs_os_memcpy(GET_SLOT(map, index), cur, slot_size);
+            dist_array[index] = (uint8_t)dist;
+            if (result == -1) {
+                result = index;
+            }
+            break;
+        }
 
-        ecs_os_memcpy(elem, last_elem, elem_size);
-    }
-}
+        if (slot_dist < dist) {
+            /* Element in slot is closer to its home, take its place and find
+             * a new slot for the displaced element. */
+            void *elem = GET_SLOT(map, index);
+            ecs_os_memcpy(tmp, elem, slot_size);
+            ecs_os_memcpy(elem, cur, slot_size);
+            ecs_os_memcpy(cur, tmp, slot_size);
+            dist_array[index] = (uint8_t)dist;
+            dist = slot_dist;
 
-/* Get payload pointer for key from bucket */
-static
-void* get_from_bucket(
-    ecs_bucket_t *bucket,
-    ecs_map_key_t key,
-    ecs_size_t elem_size)
-{
-    ecs_map_key_t *keys = bucket->keys;
-    int32_t i, count = bucket->count;
+            if (result == -1) {
+                result = index;
+            }
+        }
 
-    for (i = 0; i < count; i ++) {
-        if (keys[i] == key) {
-            return GET_ELEM(bucket->payload, elem_size, i);
+        index = (index + 1) & mask;
+        if (dist < MAX_DIST) {
+            dist ++;
         }
     }
-    return NULL;
+
+    return result;
 }
 
 /* Grow number of buckets */
@@ -19220,51 +23618,49 @@ void rehash(
 {
     ecs_assert(bucket_count != 0, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(bucket_count > map->bucket_count, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(bucket_count == ecs_next_pow_of_2(bucket_count),
+        ECS_INTERNAL_ERROR, NULL);
 
-    ecs_size_t elem_size = map->elem_size;
-
-    ensure_buckets(map, bucket_count);
-
-    ecs_bucket_t *buckets = map->buckets;
-    ecs_assert(buckets != NULL, ECS_INTERNAL_ERROR, NULL);
-    
-    int32_t bucket_id;
-
-    /* Iterate backwards as elements could otherwise be moved to existing
-        * buckets which could temporarily cause the number of elements in a
-        * bucket to exceed BUCKET_COUNT. */
-    for (bucket_id = bucket_count - 1; bucket_id >= 0; bucket_id --) {
-        ecs_bucket_t *bucket = &buckets[bucket_id];
-
-        int i, count = bucket->count;
-        ecs_map_key_t *key_array = bucket->keys;
-        void *payload_array = bucket->payload;
-
-        for (i = 0; i < count; i ++) {
-            ecs_map_key_t key = key_array[i];
-            void *elem = GET_ELEM(payload_array, elem_size, i);
-            int32_t new_bucket_id = get_bucket_id(bucket_count, key);
-
-            if (new_bucket_id != bucket_id) {
-                ecs_bucket_t *new_bucket = &buckets[new_bucket_id];
+    void *old_slots = map->slots;
+    uint8_t *old_dist = map->dist;
+    int32_t i, old_bucket_count = map->bucket_count;
+    ecs_size_t slot_size = map->slot_size;
 
-                add_to_bucket(new_bucket, elem_size, key, elem);
-                remove_from_bucket(bucket, elem_size, key, i);
+    /* Slots, two scratch slots and the distance array share one allocation */
+    map->slots = ecs_os_malloc((bucket_count + 2) * slot_size + bucket_count);
+    map->dist = ECS_OFFSET(map->slots, (bucket_count + 2) * slot_size);
+    map->bucket_count = bucket_count;
+    ecs_os_memset(map->dist, 0, bucket_count);
 
-                count --;
-                i --;
-            }
-        }
+    int32_t bits = 0;
+    while ((1 << bits) < bucket_count) {
+        bits ++;
+    }
+    map->shift = 32 - bits;
 
-        if (!bucket->count) {
-            clear_bucket(bucket);
+    for (i = 0; i < old_bucket_count; i ++) {
+        if (old_dist[i]) {
+            insert_slot(map, ECS_OFFSET(old_slots, i * slot_size));
         }
     }
+
+    ecs_os_free(old_slots);
+}
+
+/* Free storage of map */
+static
+void clear_buckets(
+    ecs_map_t *map)
+{
+    ecs_os_free(map->slots);
+    map->slots = NULL;
+    map->dist = NULL;
+    map->bucket_count = 0;
 }
 
 ecs_map_t* _ecs_map_new(
     ecs_size_t elem_size,
-    ecs_size_t alignment, 
+    ecs_size_t alignment,
     int32_t element_count)
 {
     (void)alignment;
@@ -19276,8 +23672,11 @@ ecs_map_t* _ecs_map_new(
 
     result->count = 0;
     result->elem_size = elem_size;
+    result->slot_size = KEY_SIZE + ECS_ALIGN(elem_size, KEY_SIZE);
 
-    ensure_buckets(result, bucket_count);
+    if (bucket_count) {
+        rehash(result, bucket_count);
+    }
 
     return result;
 }
@@ -19304,12 +23703,12 @@ void* _ecs_map_get(
 
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
+    int32_t index = find_slot(map, key);
+    if (index == -1) {
         return NULL;
     }
 
-    return get_from_bucket(bucket, key, elem_size);
+    return GET_ELEM(map, index);
 }
 
 void* _ecs_map_get_ptr(
@@ -19334,7 +23733,6 @@ void * _ecs_map_ensure(
     if (!result) {
         result = _ecs_map_set(map, elem_size, key, NULL);
         ecs_assert(result != NULL, ECS_INTERNAL_ERROR, NULL);
-        ecs_os_memset(result, 0, elem_size);
     }
 
     return result;
@@ -19349,30 +23747,37 @@ void* _ecs_map_set(
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = ensure_bucket(map, key);
-    ecs_assert(bucket != NULL, ECS_INTERNAL_ERROR, NULL);
-
-    void *elem = get_from_bucket(bucket, key, elem_size);
-    if (!elem) {
-        int32_t index = add_to_bucket(bucket, elem_size, key, payload);
-        
-        int32_t map_count = ++map->count;
-        int32_t target_bucket_count = get_bucket_count(map_count);
-        int32_t map_bucket_count = map->bucket_count;
-
-        if (target_bucket_count > map_bucket_count) {
-            rehash(map, target_bucket_count);
-            bucket = ensure_bucket(map, key);
-            return get_from_bucket(bucket, key, elem_size);
-        } else {
-            return GET_ELEM(bucket->payload, elem_size, index);
-        }       
-    } else {
+    int32_t index = find_slot(map, key);
+    if (index != -1) {
+        void *elem = GET_ELEM(map, index);
         if (payload) {
             ecs_os_memcpy(elem, payload, elem_size);
         }
         return elem;
     }
+
+    int32_t target_bucket_count = get_bucket_count(map->count + 1);
+    if (target_bucket_count < 2) {
+        target_bucket_count = 2;
+    }
+
+    if (target_bucket_count > map->bucket_count) {
+        rehash(map, target_bucket_count);
+    }
+
+    /* Prepare element in scratch slot so it can be moved in one go */
+    void *slot = get_scratch(map, 0);
+    *(ecs_map_key_t*)slot = key;
+    if (payload) {
+        ecs_os_memcpy(ECS_OFFSET(slot, KEY_SIZE), payload, elem_size);
+    } else {
+        ecs_os_memset(ECS_OFFSET(slot, KEY_SIZE), 0, elem_size);
+    }
+
+    index = insert_slot(map, slot);
+    map->count ++;
+
+    return GET_ELEM(map, index);
 }
 
 void ecs_map_remove(
@@ -19381,18 +23786,37 @@ void ecs_map_remove(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
+    int32_t index = find_slot(map, key);
+    if (index == -1) {
         return;
     }
 
-    int32_t i, bucket_count = bucket->count;
-    for (i = 0; i < bucket_count; i ++) {
-        if (bucket->keys[i] == key) {
-            remove_from_bucket(bucket, map->elem_size, key, i);
-            map->count --;
+    /* Shift back elements that are not in their home slot, so that lookups
+     * don't need tombstones to find them */
+    int32_t mask = map->bucket_count - 1;
+    int32_t next = (index + 1) & mask;
+    uint8_t *dist_array = map->dist;
+
+    while (dist_array[next] > 1) {
+        ecs_os_memcpy(GET_SLOT(map, index), GET_SLOT(map, next),
+            map->slot_size);
+
+        int32_t dist = dist_array[next];
+        if (dist == MAX_DIST) {
+            /* Stored distance is clamped, compute the actual distance */
+            dist = ((next - get_home(map, GET_KEY(map, index))) & mask) + 1;
+            if (dist > MAX_DIST) {
+                dist = MAX_DIST + 1;
+            }
         }
-    } 
+
+        dist_array[index] = (uint8_t)(dist - 1);
+        index = next;
+        next = (next + 1) & mask;
+    }
+
+    dist_array[index] = 0;
+    map->count --;
 }
 
 int32_t ecs_map_count(
@@ -19420,9 +23844,7 @@ ecs_map_iter_t ecs_map_iter(
 {
     return (ecs_map_iter_t){
         .map = map,
-        .bucket = NULL,
-        .bucket_index = 0,
-        .element_index = 0
+        .index = 0
     };
 }
 
@@ -19435,42 +23857,29 @@ void* _ecs_map_next(
     if (!map) {
         return NULL;
     }
-    
+
     ecs_assert(!elem_size || elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
- 
-    ecs_bucket_t *bucket = iter->bucket;
-    int32_t element_index = iter->element_index;
-    elem_size = map->elem_size;
+    (void)elem_size;
 
-    do {
-        if (!bucket) {
-            int32_t bucket_index = iter->bucket_index;
-            ecs_bucket_t *buckets = map->buckets;
-            if (bucket_index < map->bucket_count) {
-                bucket = &buckets[bucket_index];
-                iter->bucket = bucket;
-
-                element_index = 0;
-                iter->element_index = 0;
-            } else {
-                return NULL;
-            }
-        }
+    int32_t index = iter->index, bucket_count = map->bucket_count;
+    uint8_t *dist_array = map->dist;
+
+    while (index < bucket_count && !dist_array[index]) {
+        index ++;
+    }
+
+    if (index >= bucket_count) {
+        iter->index = index;
+        return NULL;
+    }
+
+    iter->index = index + 1;
 
-        if (element_index < bucket->count) {
-            iter->element_index = element_index + 1;
-            break;
-        } else {
-            bucket = NULL;
-            iter->bucket_index ++;
-        }
-    } while (true);
-    
     if (key_out) {
-        *key_out = bucket->keys[element_index];
+        *key_out = GET_KEY(map, index);
     }
 
-    return GET_ELEM(bucket->payload, elem_size, element_index);
+    return GET_ELEM(map, index);
 }
 
 void* _ecs_map_next_ptr(
@@ -19486,7 +23895,7 @@ void* _ecs_map_next_ptr(
 }
 
 void ecs_map_grow(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -19499,19 +23908,19 @@ void ecs_map_grow(
 }
 
 void ecs_map_set_size(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
-{    
+{
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     int32_t bucket_count = get_bucket_count(element_count);
 
-    if (bucket_count) {
+    if (bucket_count > map->bucket_count) {
         rehash(map, bucket_count);
     }
 }
 
 void ecs_map_memory(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t *allocd,
     int32_t *used)
 {
@@ -19524,14 +23933,10 @@ void ecs_map_memory(
     if (allocd) {
         *allocd += ECS_SIZEOF(ecs_map_t);
 
-        int i, bucket_count = map->bucket_count;
-        for (i = 0; i < bucket_count; i ++) {
-            ecs_bucket_t *bucket = &map->buckets[i];
-            *allocd += KEY_SIZE * bucket->count;
-            *allocd += map->elem_size * bucket->count;
+        int32_t bucket_count = map->bucket_count;
+        if (bucket_count) {
+            *allocd += (bucket_count + 2) * map->slot_size + bucket_count;
         }
-
-        *allocd += ECS_SIZEOF(ecs_bucket_t) * bucket_count;
     }
 }
 
@@ -20109,6 +24514,45 @@ void ecs_increase_timer_resolution(bool enable)
 #ifdef FLECS_PIPELINE
 
 
+/* Wait until the main thread flips the sync sense. Threads poll the sense
+ * first, as the main thread is usually only briefly busy merging, and block on
+ * worker_cond when the wait takes longer than the spin count. */
+static
+void wait_for_release(
+    ecs_world_t *world,
+    int32_t sense)
+{
+    int32_t i, spin_count = world->sync_spin_count;
+    for (i = 0; i < spin_count; i ++) {
+        if (ecs_os_aload(&world->sync_sense) != sense) {
+            return;
+        }
+    }
+
+    /* The parked counter is incremented before the sense is tested again, so
+     * that either this thread observes the new sense, or the main thread
+     * observes the parked thread and wakes it up. */
+    ecs_os_mutex_lock(world->sync_mutex);
+    ecs_os_ainc(&world->workers_parked);
+    while (ecs_os_aload(&world->sync_sense) == sense) {
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+    }
+    ecs_os_adec(&world->workers_parked);
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
+/* Wake up the main thread if it stopped spinning on a sync counter */
+static
+void wake_main(
+    ecs_world_t *world)
+{
+    if (ecs_os_aload(&world->main_parked)) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        ecs_os_cond_signal(world->sync_cond);
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
+}
+
 /* Worker thread */
 static
 void* worker(void *arg) {
@@ -20116,15 +24560,12 @@ void* worker(void *arg) {
     ecs_world_t *world = thread->world;
 
     /* Start worker thread, increase counter so main thread knows how many
-     * workers are ready */
-    ecs_os_mutex_lock(world->sync_mutex);
-    world->workers_running ++;
-
-    if (!world->quit_workers) {
-        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    }
-
-    ecs_os_mutex_unlock(world->sync_mutex);
+     * workers are ready. The sense is read before the counter is increased, so
+     * that the worker can't miss the first release. */
+    int32_t sense = ecs_os_aload(&world->sync_sense);
+    ecs_os_ainc(&world->workers_running);
+    wake_main(world);
+    wait_for_release(world, sense);
 
     while (!world->quit_workers) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)thread, 0);
@@ -20135,114 +24576,548 @@ void* worker(void *arg) {
         ecs_set_scope((ecs_world_t*)thread, old_scope);
     }
 
+    ecs_os_adec(&world->workers_running);
+
+    return NULL;
+}
+
+/* Start threads */
+static
+void start_workers(
+    ecs_world_t *world,
+    int32_t threads)
+{
+    ecs_assert(world->workers == NULL, ECS_INTERNAL_ERROR, NULL);
+
+    world->workers = ecs_vector_new(ecs_thread_t, threads);
+    world->worker_stages = ecs_vector_new(ecs_stage_t, threads);
+
+    int32_t i;
+    for (i = 0; i < threads; i ++) {
+        ecs_thread_t *thread =
+            ecs_vector_add(&world->workers, ecs_thread_t);
+
+        thread->magic = ECS_THREAD_MAGIC;
+        thread->world = world;
+        thread->thread = 0;
+        thread->index = i;
+        thread->sync_wait_time = 0;
+
+        thread->stage = ecs_vector_add(&world->worker_stages, ecs_stage_t);
+        ecs_stage_init(world, thread->stage);
+        thread->stage->id = 2 + i; /* 0 and 1 are reserved for main and temp */
+        thread->stage->world = (ecs_world_t*)thread;
+
+        thread->thread = ecs_os_thread_new(worker, thread);
+        ecs_assert(thread->thread != 0, ECS_THREAD_ERROR, NULL);
+    }
+}
+
+/* Wait until a counter that is incremented by the workers reaches the number
+ * of workers. The main thread polls the counter first, and blocks on sync_cond
+ * when the wait takes longer than the spin count. main_parked is set before 
+ * the counter is tested again, so that either the main thread observes the
+ * last increment, or the last worker observes that it has to wake it up. */
+static
+void wait_for_counter(
+    ecs_world_t *world,
+    int32_t *counter)
+{
+    int32_t thread_count = ecs_vector_count(world->workers);
+
+    int32_t i, spin_count = world->sync_spin_count;
+    for (i = 0; i < spin_count; i ++) {
+        if (ecs_os_aload(counter) == thread_count) {
+            return;
+        }
+    }
+
     ecs_os_mutex_lock(world->sync_mutex);
-    world->workers_running --;
+    ecs_os_astore(&world->main_parked, 1);
+    while (ecs_os_aload(counter) != thread_count) {
+        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+    }
+    ecs_os_astore(&world->main_parked, 0);
     ecs_os_mutex_unlock(world->sync_mutex);
+}
+
+/* Wait until all workers are running */
+static
+void wait_for_workers(
+    ecs_world_t *world)
+{
+    wait_for_counter(world, &world->workers_running);
+}
+
+/* Synchronize worker threads. If measure is true, the time spent waiting is
+ * added to the wait time of the thread. */
+static
+void sync_worker(
+    ecs_world_t *world,
+    ecs_thread_t *thread,
+    bool measure)
+{
+    int32_t thread_count = ecs_vector_count(world->workers);
+
+    do {
+        ecs_time_t start = {0};
+        if (measure) {
+            ecs_time_measure(&start);
+        }
+
+        /* Read the sense before signalling that the thread is waiting. Once
+         * the last thread arrives, the main thread may flip it at any time. */
+        int32_t sense = ecs_os_aload(&world->sync_sense);
+
+        /* Signal that thread is waiting. Only wake up main thread when all 
+         * threads are waiting. */
+        if (ecs_os_ainc(&world->workers_waiting) == thread_count) {
+            wake_main(world);
+        }
+
+        /* Wait until main thread signals that thread can continue */
+        wait_for_release(world, sense);
+
+        /* The main thread only reads the wait time while all workers are 
+         * waiting on a sync point, so it can be updated without locking */
+        if (measure) {
+            thread->sync_wait_time += (FLECS_FLOAT)ecs_time_measure(&start);
+        }
+
+        /* The main thread may release workers to copy component values for a
+         * parallel merge before they continue with the pipeline */
+        if (!world->merge_writes) {
+            break;
+        }
+
+        ecs_deferred_writes_apply(world, thread->index);
+    } while (true);
+}
+
+/* Wait until all threads are waiting on sync point */
+static
+void wait_for_sync(
+    ecs_world_t *world)
+{
+    ecs_time_t start = {0};
+    if (world->measure_frame_time) {
+        ecs_time_measure(&start);
+    }
+
+    wait_for_counter(world, &world->workers_waiting);
+
+    if (world->measure_frame_time) {
+        FLECS_FLOAT wait_time = (FLECS_FLOAT)ecs_time_measure(&start);
+        ecs_vector_each(world->workers, ecs_thread_t, thr, {
+            wait_time += thr->sync_wait_time;
+            thr->sync_wait_time = 0;
+        });
+        world->stats.sync_wait_time_total += wait_time;
+    }
+}
+
+/* Signal workers that they can start/resume work */
+static
+void signal_workers(
+    ecs_world_t *world)
+{
+    /* Reset the counter before flipping the sense, as released workers may
+     * immediately arrive at the next sync point */
+    ecs_os_astore(&world->workers_waiting, 0);
+    ecs_os_astore(&world->sync_sense, !ecs_os_aload(&world->sync_sense));
+
+    if (ecs_os_aload(&world->workers_parked)) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        ecs_os_cond_broadcast(world->worker_cond);
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
+}
+
+/* Copy component values of deferred set operations on all threads */
+static
+void merge_writes(
+    ecs_world_t *world)
+{
+    ecs_time_t start = {0};
+    if (world->measure_frame_time) {
+        ecs_time_measure(&start);
+    }
+
+    /* Writes are divided before the workers are released, so that each thread
+     * only visits its own writes. Main thread takes the last partition. */
+    int32_t thread_count = ecs_vector_count(world->workers);
+    ecs_deferred_writes_partition(world, thread_count + 1);
+    world->merge_writes = true;
+    signal_workers(world);
+    ecs_deferred_writes_apply(world, thread_count);
+    wait_for_sync(world);
+    world->merge_writes = false;
+
+    /* Run OnSet systems in the order in which values were set */
+    ecs_deferred_writes_end(world);
+
+    if (world->measure_frame_time) {
+        world->stats.merge_time_total += (FLECS_FLOAT)ecs_time_measure(&start);
+    }
+}
+
+/* Merge stages. In a parallel merge, the main thread applies the structural
+ * changes of all stages, after which component values of set operations are 
+ * copied by all threads. */
+static
+void merge_stages(
+    ecs_world_t *world)
+{
+    if (!world->parallel_merge || !world->auto_merge) {
+        ecs_staging_end(world);
+        return;
+    }
+
+    world->defer_writes = true;
+    ecs_staging_end(world);
+    world->defer_writes = false;
+
+    if (ecs_vector_count(world->deferred_writes)) {
+        merge_writes(world);
+    }
+
+    /* Values are stored in the arenas of the stages, which are released after
+     * the values have been written */
+    ecs_stage_defer_reset(&world->temp_stage);
+    ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
+        ecs_stage_defer_reset(stage);
+    });
+}
+
+/* -- Job scheduling -- */
+
+static
+ecs_job_queue_t* job_queue_new(
+    int32_t deque_count)
+{
+    ecs_job_queue_t *q = ecs_os_calloc(sizeof(ecs_job_queue_t));
+    ecs_assert(q != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    q->lock = ecs_os_mutex_new();
+    q->done_cond = ecs_os_cond_new();
+    q->job_count = -1;
+    q->deques = ecs_os_calloc(ECS_SIZEOF(ecs_job_deque_t) * deque_count);
+    ecs_assert(q->deques != NULL, ECS_OUT_OF_MEMORY, NULL);
+    q->deque_count = deque_count;
+
+    int32_t i;
+    for (i = 0; i < deque_count; i ++) {
+        q->deques[i].lock = ecs_os_mutex_new();
+    }
+
+    return q;
+}
+
+static
+void job_queue_free(
+    ecs_job_queue_t *q)
+{
+    int32_t i;
+    for (i = 0; i < q->deque_count; i ++) {
+        ecs_os_mutex_free(q->deques[i].lock);
+    }
+
+    ecs_os_cond_free(q->done_cond);
+    ecs_os_mutex_free(q->lock);
+    ecs_vector_free(q->depends_on);
+    ecs_vector_free(q->results);
+    ecs_vector_free(q->fragments);
+    ecs_vector_free(q->jobs);
+    ecs_os_free(q->deques);
+    ecs_os_free(q);
+}
+
+static
+void free_job_queues(
+    ecs_world_t *world)
+{
+    ecs_map_iter_t it = ecs_map_iter(world->worker_jobs);
+    ecs_job_queue_t *q;
+    while ((q = ecs_map_next_ptr(&it, ecs_job_queue_t*, NULL))) {
+        job_queue_free(q);
+    }
+
+    ecs_map_free(world->worker_jobs);
+    world->worker_jobs = NULL;
+}
+
+static
+int32_t job_chunk_size(
+    ecs_world_t *world,
+    int32_t entity_count,
+    int32_t worker_count)
+{
+    int32_t size = world->job_chunk_size;
+    if (!size) {
+        int32_t job_count = worker_count * ECS_MAX_JOBS_PER_WORKER;
+        size = (entity_count + job_count - 1) / job_count;
+        if (size < ECS_MIN_JOB_CHUNK_SIZE) {
+            size = ECS_MIN_JOB_CHUNK_SIZE;
+        }
+    }
+    return size;
+}
+
+static
+void add_job(
+    ecs_job_queue_t *q)
+{
+    int32_t *job = ecs_vector_add(&q->jobs, int32_t);
+    *job = ecs_vector_count(q->fragments);
+}
+
+static
+void add_fragment(
+    ecs_job_queue_t *q,
+    const ecs_job_fragment_t *f)
+{
+    ecs_job_fragment_t *elem = ecs_vector_add(
+        &q->fragments, ecs_job_fragment_t);
+    *elem = *f;
+}
+
+static
+void clear_jobs(
+    ecs_job_queue_t *q)
+{
+    ecs_vector_clear(q->fragments);
+    ecs_vector_clear(q->jobs);
 
-    return NULL;
+    int32_t i;
+    for (i = 0; i < q->deque_count; i ++) {
+        q->deques[i].head = q->deques[i].tail = 0;
+    }
 }
 
-/* Start threads */
+/* Iterate the query once, and divide up the results in jobs of at most 
+ * chunk_size entities. Large tables are split up in multiple jobs, entities of
+ * small tables are combined into a single job. */
 static
-void start_workers(
+void build_jobs(
     ecs_world_t *world,
-    int32_t threads)
+    ecs_job_queue_t *q,
+    const ecs_iter_t *it_in)
 {
-    ecs_assert(world->workers == NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_vector_clear(q->results);
+    clear_jobs(q);
 
-    world->workers = ecs_vector_new(ecs_thread_t, threads);
-    world->worker_stages = ecs_vector_new(ecs_stage_t, threads);
+    ecs_iter_t it = *it_in;
+    int32_t entity_count = 0;
+    while (ecs_query_next(&it)) {
+        ecs_job_fragment_t *f = ecs_vector_add(
+            &q->results, ecs_job_fragment_t);
+        f->table = it.table;
+        f->table_columns = it.table_columns;
+        f->entities = it.entities;
+        f->offset = it.offset;
+        f->count = it.count;
+        f->total_count = it.total_count;
+        f->frame_offset = it.frame_offset;
+        entity_count += it.count;
+    }
+
+    int32_t i, result_count = ecs_vector_count(q->results);
+    ecs_job_fragment_t *results = ecs_vector_first(
+        q->results, ecs_job_fragment_t);
+
+    int32_t size = job_chunk_size(world, entity_count, q->deque_count);
+    int32_t job_remaining = 0;
+
+    for (i = 0; i < result_count; i ++) {
+        ecs_job_fragment_t f = results[i];
+
+        /* Results without entities (queries that don't match tables) are
+         * scheduled as a separate job, so they run exactly once */
+        if (!f.count) {
+            add_job(q);
+            add_fragment(q, &f);
+            job_remaining = 0;
+            continue;
+        }
 
-    int32_t i;
-    for (i = 0; i < threads; i ++) {
-        ecs_thread_t *thread =
-            ecs_vector_add(&world->workers, ecs_thread_t);
+        /* When columns are aligned, split tables on rows that start on an
+         * aligned address, so that jobs don't share cache lines */
+        int32_t align = 1;
+        if (f.table && f.table->table) {
+            align = ecs_table_row_alignment(world, f.table->table);
+        }
 
-        thread->magic = ECS_THREAD_MAGIC;
-        thread->world = world;
-        thread->thread = 0;
-        thread->index = i;
+        while (f.count) {
+            if (job_remaining <= 0) {
+                add_job(q);
+                job_remaining = size;
+            }
 
-        thread->stage = ecs_vector_add(&world->worker_stages, ecs_stage_t);
-        ecs_stage_init(world, thread->stage);
-        thread->stage->id = 2 + i; /* 0 and 1 are reserved for main and temp */
-        thread->stage->world = (ecs_world_t*)thread;
+            ecs_job_fragment_t piece = f;
+            if (piece.count > job_remaining) {
+                piece.count = job_remaining;
 
-        thread->thread = ecs_os_thread_new(worker, thread);
-        ecs_assert(thread->thread != 0, ECS_THREAD_ERROR, NULL);
+                if (align > 1) {
+                    int32_t end = f.offset + piece.count;
+                    end -= end % align;
+                    if (end <= f.offset) {
+                        end += align;
+                    }
+                    piece.count = end - f.offset;
+                    if (piece.count > f.count) {
+                        piece.count = f.count;
+                    }
+                }
+            }
+
+            add_fragment(q, &piece);
+
+            f.entities += piece.count;
+            f.offset += piece.count;
+            f.frame_offset += piece.count;
+            f.count -= piece.count;
+            job_remaining -= piece.count;
+        }
+    }
+
+    /* Assign each worker a contiguous range of jobs */
+    int32_t job_count = ecs_vector_count(q->jobs);
+    int32_t deque_count = q->deque_count;
+    for (i = 0; i < deque_count; i ++) {
+        q->deques[i].head = (job_count * i) / deque_count;
+        q->deques[i].tail = (job_count * (i + 1)) / deque_count;
     }
 }
 
-/* Wait until all workers are running */
+/* Publish the number of jobs once the job list is built. Must be called while
+ * holding the queue lock. */
 static
-void wait_for_workers(
-    ecs_world_t *world)
+void set_job_count(
+    ecs_job_queue_t *q,
+    int32_t count)
 {
-    int32_t thread_count = ecs_vector_count(world->workers);
-    bool wait = true;
-
-    do {
-        ecs_os_mutex_lock(world->sync_mutex);
-        if (world->workers_running == thread_count) {
-            wait = false;
-        }
-        ecs_os_mutex_unlock(world->sync_mutex);
-    } while (wait);
+    q->built = true;
+    ecs_os_astore(&q->job_count, count);
+    if (!count) {
+        ecs_os_cond_broadcast(q->done_cond);
+    }
 }
 
-/* Synchronize worker threads */
+/* Mark a job as finished. The thread that finishes the last job wakes up the
+ * threads that are waiting for the queue. */
 static
-void sync_worker(
-    ecs_world_t *world)
+void finish_job(
+    ecs_job_queue_t *q)
 {
-    int32_t thread_count = ecs_vector_count(world->workers);
-
-    /* Signal that thread is waiting */
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (++ world->workers_waiting == thread_count) {
-        /* Only signal main thread when all threads are waiting */
-        ecs_os_cond_signal(world->sync_cond);
+    if (ecs_os_ainc(&q->jobs_done) == ecs_os_aload(&q->job_count)) {
+        ecs_os_mutex_lock(q->lock);
+        ecs_os_cond_broadcast(q->done_cond);
+        ecs_os_mutex_unlock(q->lock);
     }
+}
 
-    /* Wait until main thread signals that thread can continue */
-    ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    ecs_os_mutex_unlock(world->sync_mutex);
+static
+bool jobs_finished(
+    ecs_job_queue_t *q)
+{
+    return ecs_os_aload(&q->jobs_done) == ecs_os_aload(&q->job_count);
 }
 
-/* Wait until all threads are waiting on sync point */
+/* Wait until systems that conflict with this system have finished. Threads 
+ * poll the queue first, and block on its condition variable when the wait 
+ * takes longer than the spin count. The last job is counted before the queue
+ * is signalled under the lock, so a blocked thread can't miss the signal. */
 static
-void wait_for_sync(
-    ecs_world_t *world)
+void wait_for_dependencies(
+    ecs_world_t *world,
+    ecs_job_queue_t *q)
 {
-    int32_t thread_count = ecs_vector_count(world->workers);
+    int32_t spin_count = world->sync_spin_count;
 
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (world->workers_waiting != thread_count) {
-        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+    ecs_vector_each(q->depends_on, ecs_job_queue_t*, dep_ptr, {
+        ecs_job_queue_t *dep = *dep_ptr;
+        int32_t i;
+        for (i = 0; i < spin_count; i ++) {
+            if (jobs_finished(dep)) {
+                break;
+            }
+        }
+
+        if (i == spin_count) {
+            ecs_os_mutex_lock(dep->lock);
+            while (!jobs_finished(dep)) {
+                ecs_os_cond_wait(dep->done_cond, dep->lock);
+            }
+            ecs_os_mutex_unlock(dep->lock);
+        }
+    });
+}
+
+static
+int32_t pop_job(
+    ecs_job_deque_t *deque)
+{
+    int32_t result = -1;
+    ecs_os_mutex_lock(deque->lock);
+    if (deque->head < deque->tail) {
+        result = deque->head ++;
     }
-    
-    /* We should have been signalled unless all workers are waiting on sync */
-    ecs_assert(world->workers_waiting == thread_count, 
-        ECS_INTERNAL_ERROR, NULL);
+    ecs_os_mutex_unlock(deque->lock);
+    return result;
+}
 
-    ecs_os_mutex_unlock(world->sync_mutex);
+static
+int32_t steal_job(
+    ecs_job_deque_t *deque)
+{
+    int32_t result = -1;
+    ecs_os_mutex_lock(deque->lock);
+    if (deque->head < deque->tail) {
+        result = -- deque->tail;
+    }
+    ecs_os_mutex_unlock(deque->lock);
+    return result;
 }
 
-/* Signal workers that they can start/resume work */
 static
-void signal_workers(
-    ecs_world_t *world)
+void run_job(
+    ecs_job_queue_t *q,
+    int32_t job,
+    ecs_iter_t *it,
+    ecs_iter_action_t action)
 {
-    ecs_os_mutex_lock(world->sync_mutex);
-    ecs_os_cond_broadcast(world->worker_cond);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    int32_t *jobs = ecs_vector_first(q->jobs, int32_t);
+    int32_t first = jobs[job];
+    int32_t last = ecs_vector_count(q->fragments);
+    if (job < (ecs_vector_count(q->jobs) - 1)) {
+        last = jobs[job + 1];
+    }
+
+    ecs_job_fragment_t *fragments = ecs_vector_first(
+        q->fragments, ecs_job_fragment_t);
+
+    int32_t i;
+    for (i = first; i < last; i ++) {
+        ecs_job_fragment_t *f = &fragments[i];
+        it->table = f->table;
+        it->table_columns = f->table_columns;
+        it->entities = f->entities;
+        it->offset = f->offset;
+        it->count = f->count;
+        it->total_count = f->total_count;
+        it->frame_offset = f->frame_offset;
+        action(it);
+    }
 }
 
-/** Stop worker threads */
+/* Stop worker threads */
 static
 void ecs_stop_threads(
     ecs_world_t *world)
 {
+    /* Make sure all workers observed the sense before releasing them */
+    wait_for_workers(world);
+
     world->quit_workers = true;
     signal_workers(world);
 
@@ -20251,6 +25126,8 @@ void ecs_stop_threads(
         ecs_stage_deinit(world, thr->stage);
     });
 
+    free_job_queues(world);
+
     ecs_vector_free(world->workers);
     ecs_vector_free(world->worker_stages);
     world->worker_stages = NULL;
@@ -20271,7 +25148,8 @@ void ecs_worker_begin(
 }
 
 bool ecs_worker_sync(
-    ecs_world_t *world)
+    ecs_world_t *world,
+    ecs_stage_t *stage)
 {
     int32_t build_count = world->stats.pipeline_build_count_total;
 
@@ -20283,20 +25161,142 @@ bool ecs_worker_sync(
 
         ecs_staging_begin(world);
     } else {
-        sync_worker(world);
+        sync_worker(world, (ecs_thread_t*)stage->world, 
+            world->measure_frame_time);
     }
 
     return world->stats.pipeline_build_count_total != build_count;
 }
 
 void ecs_worker_end(
-    ecs_world_t *world)
+    ecs_world_t *world,
+    ecs_stage_t *stage)
 {
     int32_t thread_count = ecs_vector_count(world->workers);
     if (!thread_count) {
         ecs_staging_end(world);
     } else {
-        sync_worker(world);
+        /* Don't measure the wait at the end of the frame, as this includes the
+         * time the application spends outside of ecs_progress */
+        sync_worker(world, (ecs_thread_t*)stage->world, false);
+    }
+}
+
+void ecs_worker_run_jobs(
+    ecs_world_t *world,
+    ecs_thread_t *thread,
+    ecs_entity_t system,
+    ecs_iter_t *it,
+    ecs_iter_action_t action)
+{
+    ecs_job_queue_t *q = ecs_map_get_ptr(
+        world->worker_jobs, ecs_job_queue_t*, system);
+
+    /* Systems that are not part of the pipeline when jobs were prepared, like
+     * a system that is ran manually from a worker, have no job queue. These
+     * divide entities evenly over workers. */
+    if (!q) {
+        int32_t total = ecs_vector_count(world->workers);
+        while (ecs_query_next_worker(it, thread->index, total)) {
+            action(it);
+        }
+        return;
+    }
+
+    wait_for_dependencies(world, q);
+
+    ecs_os_mutex_lock(q->lock);
+    if (!q->built) {
+        build_jobs(world, q, it);
+        set_job_count(q, ecs_vector_count(q->jobs));
+    }
+    ecs_os_mutex_unlock(q->lock);
+
+    /* Run jobs from own deque first */
+    int32_t job, index = thread->index, count = q->deque_count;
+    while ((job = pop_job(&q->deques[index])) != -1) {
+        run_job(q, job, it, action);
+        finish_job(q);
+    }
+
+    /* Steal jobs from other workers until no jobs are left */
+    int32_t i;
+    for (i = 1; i < count; i ++) {
+        ecs_job_deque_t *victim = &q->deques[(index + i) % count];
+        while ((job = steal_job(victim)) != -1) {
+            run_job(q, job, it, action);
+            finish_job(q);
+        }
+    }
+}
+
+void ecs_worker_skip_jobs(
+    ecs_world_t *world,
+    ecs_entity_t system)
+{
+    ecs_job_queue_t *q = ecs_map_get_ptr(
+        world->worker_jobs, ecs_job_queue_t*, system);
+    if (!q) {
+        return;
+    }
+
+    ecs_os_mutex_lock(q->lock);
+    if (!q->built) {
+        clear_jobs(q);
+        set_job_count(q, 0);
+    }
+    ecs_os_mutex_unlock(q->lock);
+}
+
+static
+ecs_job_queue_t* get_job_queue(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    int32_t thread_count)
+{
+    ecs_job_queue_t *q = ecs_map_get_ptr(
+        world->worker_jobs, ecs_job_queue_t*, system);
+    if (!q) {
+        q = job_queue_new(thread_count);
+        ecs_map_set(world->worker_jobs, system, &q);
+    }
+    return q;
+}
+
+void ecs_workers_prepare_jobs(
+    ecs_world_t *world,
+    ecs_entity_t pipeline)
+{
+    const EcsPipelineQuery *pq = ecs_get(world, pipeline, EcsPipelineQuery);
+    ecs_assert(pq != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t thread_count = ecs_vector_count(world->workers);
+
+    if (!world->worker_jobs) {
+        world->worker_jobs = ecs_map_new(ecs_job_queue_t*, 0);
+    }
+
+    /* Make sure each system has a job queue and reset queues from the
+     * previous frame. Workers are not running, so this is safe. */
+    ecs_iter_t it = ecs_query_iter(pq->query);
+    while (ecs_query_next(&it)) {
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            ecs_entity_t e = it.entities[i];
+            ecs_job_queue_t *q = get_job_queue(world, e, thread_count);
+            q->built = false;
+            q->job_count = -1;
+            q->jobs_done = 0;
+
+            /* Resolve systems this system depends on to their job queues */
+            ecs_vector_clear(q->depends_on);
+            ecs_vector_t *deps = ecs_map_get_ptr(pq->deps, ecs_vector_t*, e);
+            ecs_vector_each(deps, ecs_entity_t, dep, {
+                ecs_job_queue_t **elem = ecs_vector_add(
+                    &q->depends_on, ecs_job_queue_t*);
+                *elem = get_job_queue(world, *dep, thread_count);
+            });
+        }
     }
 }
 
@@ -20323,25 +25323,27 @@ void ecs_workers_progress(
         /* Make sure workers are running and ready */
         wait_for_workers(world);
 
+        ecs_workers_prepare_jobs(world, pipeline);
+
         /* Synchronize n times for each op in the pipeline */
         for (i = 0; i < sync_count; i ++) {
             ecs_staging_begin(world);
 
             /* Signal workers that they should start running systems */
-            world->workers_waiting = 0;
             signal_workers(world);
 
             /* Wait until all workers are waiting on sync point */
             wait_for_sync(world);
 
             /* Merge */
-            ecs_staging_end(world);
+            merge_stages(world);
 
             int32_t update_count;
             if ((update_count = ecs_pipeline_update(world, pipeline))) {
                 /* The number of operations in the pipeline could have changed
                  * as result of the merge */
                 sync_count = update_count;
+                ecs_workers_prepare_jobs(world, pipeline);
             }
         }
 
@@ -20356,6 +25358,29 @@ void ecs_workers_progress(
 
 /* -- Public functions -- */
 
+void ecs_set_job_chunk_size(
+    ecs_world_t *world,
+    int32_t size)
+{
+    ecs_assert(size >= 0, ECS_INVALID_PARAMETER, NULL);
+    world->job_chunk_size = size;
+}
+
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enabled)
+{
+    world->parallel_merge = enabled;
+}
+
+void ecs_set_sync_spin_count(
+    ecs_world_t *world,
+    int32_t spin_count)
+{
+    ecs_assert(spin_count >= 0, ECS_INVALID_PARAMETER, NULL);
+    world->sync_spin_count = spin_count;
+}
+
 void ecs_set_threads(
     ecs_world_t *world,
     int32_t threads)
@@ -20400,8 +25425,23 @@ static ECS_CTOR(EcsPipelineQuery, ptr, {
     memset(ptr, 0, _size);
 })
 
+static
+void free_deps(
+    ecs_map_t *deps)
+{
+    ecs_map_iter_t it = ecs_map_iter(deps);
+    ecs_vector_t *v;
+    while ((v = ecs_map_next_ptr(&it, ecs_vector_t*, NULL))) {
+        ecs_vector_free(v);
+    }
+    ecs_map_free(deps);
+}
+
 static ECS_DTOR(EcsPipelineQuery, ptr, {
     ecs_vector_free(ptr->ops);
+    if (ptr->deps) {
+        free_deps(ptr->deps);
+    }
 })
 
 static
@@ -20554,7 +25594,151 @@ bool check_column(
             column, is_active, column->is.component, write_state);
     }  
 
-    return false;
+    return false;
+}
+
+/* -- System dependencies -- 
+ * Systems in the same merge segment run concurrently on worker threads, unless
+ * they access the same component and one of them writes it. In that case the
+ * system that comes later in the pipeline depends on the earlier one, and won't
+ * start before all of its jobs have finished. */
+
+typedef struct system_access_t {
+    ecs_entity_t component;
+    bool write;
+} system_access_t;
+
+typedef struct system_deps_t {
+    ecs_entity_t system;
+    ecs_vector_t *access;       /* system_access_t */
+    bool exclusive;             /* Depends on / is dependency of all systems */
+} system_deps_t;
+
+static
+void add_access(
+    system_deps_t *sd,
+    ecs_entity_t component,
+    ecs_sig_inout_kind_t inout_kind)
+{
+    system_access_t *elem = ecs_vector_add(&sd->access, system_access_t);
+    elem->component = component;
+    elem->write = inout_kind != EcsIn;
+}
+
+static
+void get_system_access(
+    ecs_query_t *query,
+    system_deps_t *sd)
+{
+    bool has_data = false;
+
+    ecs_vector_each(query->sig.columns, ecs_sig_column_t, column, {
+        if (column->from_kind == EcsFromEmpty || 
+            column->oper_kind == EcsOperNot) 
+        {
+            continue;
+        }
+
+        if (column->oper_kind == EcsOperOr) {
+            ecs_vector_each(column->is.type, ecs_entity_t, c_ptr, {
+                add_access(sd, *c_ptr, column->inout_kind);
+            });
+        } else {
+            add_access(sd, column->is.component, column->inout_kind);
+        }
+
+        has_data = true;
+    });
+
+    /* Systems without columns (tasks) may access anything */
+    sd->exclusive = !has_data;
+}
+
+static
+bool component_overlaps(
+    ecs_entity_t c1,
+    ecs_entity_t c2)
+{
+    if (c1 == c2 || c1 == EcsWildcard || c2 == EcsWildcard) {
+        return true;
+    }
+
+    /* Traits may contain wildcards, so compare their individual parts */
+    if ((c1 | c2) & ECS_ROLE_MASK) {
+        uint32_t c1_lo = ecs_entity_t_lo(c1), c1_hi = ecs_entity_t_hi(c1 & ECS_COMPONENT_MASK);
+        uint32_t c2_lo = ecs_entity_t_lo(c2), c2_hi = ecs_entity_t_hi(c2 & ECS_COMPONENT_MASK);
+        
+        if (c1_lo == EcsWildcard || c2_lo == EcsWildcard || c1_lo == c2_lo) {
+            return true;
+        }
+
+        if ((c1_hi && (c1_hi == c2_lo || c1_hi == c2_hi)) ||
+            (c2_hi && c2_hi == c1_lo)) 
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static
+bool systems_conflict(
+    system_deps_t *sd1,
+    system_deps_t *sd2)
+{
+    if (sd1->exclusive || sd2->exclusive) {
+        return true;
+    }
+
+    ecs_vector_each(sd1->access, system_access_t, a1, {
+        ecs_vector_each(sd2->access, system_access_t, a2, {
+            if ((a1->write || a2->write) && 
+                component_overlaps(a1->component, a2->component)) 
+            {
+                return true;
+            }
+        });
+    });
+
+    return false;
+}
+
+static
+void clear_segment(
+    ecs_vector_t *segment)
+{
+    ecs_vector_each(segment, system_deps_t, sd, {
+        ecs_vector_free(sd->access);
+    });
+    ecs_vector_clear(segment);
+}
+
+/* Add system to segment, and store systems it depends on in the deps map */
+static
+void add_to_segment(
+    ecs_map_t *deps,
+    ecs_vector_t **segment,
+    ecs_entity_t system,
+    ecs_query_t *query)
+{
+    system_deps_t sd = { .system = system };
+    get_system_access(query, &sd);
+
+    ecs_vector_t *depends_on = NULL;
+    ecs_vector_each(*segment, system_deps_t, prev, {
+        if (systems_conflict(prev, &sd)) {
+            ecs_entity_t *e = ecs_vector_add(&depends_on, ecs_entity_t);
+            *e = prev->system;
+        }
+    });
+
+    if (depends_on) {
+        ecs_map_set(deps, system, &depends_on);
+    }
+
+    system_deps_t *elem = ecs_vector_add(segment, system_deps_t);
+    *elem = sd;
 }
 
 static
@@ -20590,6 +25774,13 @@ bool build_pipeline(
         ecs_vector_free(pq->ops);
     }
 
+    if (pq->deps) {
+        free_deps(pq->deps);
+    }
+
+    ecs_map_t *deps = ecs_map_new(ecs_vector_t*, 0);
+    ecs_vector_t *segment = NULL;
+
     /* Iterate systems in pipeline, add ops for running / merging */
     ecs_iter_t it = ecs_query_iter(query);
     while (ecs_query_next(&it)) {
@@ -20613,6 +25804,7 @@ bool build_pipeline(
             if (needs_merge) {
                 /* After merge all components will be merged, so reset state */
                 reset_write_state(&ws);
+                clear_segment(segment);
                 op = NULL;
 
                 /* Re-evaluate columns to set write flags if system is active.
@@ -20639,15 +25831,19 @@ bool build_pipeline(
              * the query used to run the pipeline. */
             if (is_active) {
                 op->count ++;
+                add_to_segment(deps, &segment, it.entities[i], q);
             }
         }
     }
 
     ecs_map_free(ws.components);
+    clear_segment(segment);
+    ecs_vector_free(segment);
 
     /* Force sort of query as this could increase the match_count */
     pq->match_count = pq->query->match_count;
     pq->ops = ops;
+    pq->deps = deps;
 
     return true;
 }
@@ -20754,6 +25950,12 @@ void ecs_pipeline_progress(
             ecs_run_intern(world, stage, e, &sys[i], delta_time, 0, 0, 
                 NULL, NULL, false);
 
+            /* If the system was not ran (for example because its timer did not
+             * fire) make sure it doesn't block systems that depend on it. */
+            if (world != stage->world) {
+                ecs_worker_skip_jobs(world, e);
+            }
+
             ran_since_merge ++;
             world->stats.systems_ran_frame ++;
 
@@ -20766,7 +25968,7 @@ void ecs_pipeline_progress(
                  * current position (system). If there are a lot of systems
                  * in the pipeline this can be an expensive operation, but
                  * should happen infrequently. */
-                if (ecs_worker_sync(world)) {
+                if (ecs_worker_sync(world, stage)) {
                     i = iter_reset(pq, &it, &op, e);
                     op_last = ecs_vector_last(pq->ops, ecs_pipeline_op_t);
                     sys = ecs_column(&it, EcsSystem, 1);
@@ -20775,7 +25977,7 @@ void ecs_pipeline_progress(
         }
     }
 
-    ecs_worker_end(world);
+    ecs_worker_end(world, stage);
 }
 
 static
@@ -20862,6 +26064,7 @@ void EcsOnAddPipeline(
         pq->build_query = build_query;
         pq->match_count = -1;
         pq->ops = NULL;
+        pq->deps = NULL;
 
         ecs_log_pop();
     }
@@ -21705,12 +26908,16 @@ ecs_entity_t ecs_run_intern(
         }
     } else {
         ecs_thread_t *thread = (ecs_thread_t*)stage->world;
+#ifdef FLECS_PIPELINE
+        ecs_worker_run_jobs(world, thread, system, &it, action);
+#else
         int32_t total = ecs_vector_count(world->workers);
         int32_t current = thread->index;
 
         while (ecs_query_next_worker(&it, current, total)) {
             action(&it);               
         }
+#endif
     }
 
     if (defer) {
@@ -22454,693 +27661,1090 @@ EcsType type_from_vec(
 
     result.type = table->type;
 
-    /* Create normalized type. A normalized type resolves all elements with an
-     * AND flag and appends them to the resulting type, where the default type
-     * maintains the original type hierarchy. */
-    ecs_vector_t *normalized = NULL;
+    /* Create normalized type. A normalized type resolves all elements with an
+     * AND flag and appends them to the resulting type, where the default type
+     * maintains the original type hierarchy. */
+    ecs_vector_t *normalized = NULL;
+
+    ecs_entity_t *array = ecs_vector_first(vec, ecs_entity_t);
+    int32_t i, count = ecs_vector_count(vec);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = array[i];
+        if (ECS_HAS_ROLE(e, AND)) {
+            ecs_entity_t entity = e & ECS_COMPONENT_MASK;
+            const EcsType *type_ptr = ecs_get(world, entity, EcsType);
+            ecs_assert(type_ptr != NULL, ECS_INVALID_PARAMETER, 
+                "flag must be applied to type");
+
+            ecs_vector_each(type_ptr->normalized, ecs_entity_t, c_ptr, {
+                ecs_entity_t *el = ecs_vector_add(&normalized, ecs_entity_t);
+                *el = *c_ptr;
+            })
+        }       
+    }
+
+    /* Only get normalized type if it's different from the type */
+    if (normalized) {
+        ecs_entities_t normalized_array = ecs_type_to_entities(normalized);
+        ecs_table_t *norm_table = ecs_table_traverse_add(
+            world, table, &normalized_array, NULL);
+
+        result.normalized = norm_table->type;
+
+        ecs_vector_free(normalized);
+    } else {
+        result.normalized = result.type;
+    }
+
+    return result;
+}
+
+static
+EcsType type_from_expr(
+    ecs_world_t *world,
+    const char *name,
+    const char *expr)
+{
+    if (expr) {
+        ecs_vector_t *vec = ecs_vector_new(ecs_entity_t, 1);
+        ecs_parse_expr(world, name, expr, parse_type_action, &vec);
+        EcsType result = type_from_vec(world, vec);
+        ecs_vector_free(vec);
+        return result;
+    } else {
+        return (EcsType){0, 0};
+    }
+}
+
+/* If a name prefix is set with ecs_set_name_prefix, check if the entity name
+ * has the prefix, and if so remove it. This enables using prefixed names in C
+ * for components / systems while storing a canonical / language independent 
+ * identifier. */
+const char* ecs_name_from_symbol(
+    ecs_world_t *world,
+    const char *type_name)
+{
+    const char *prefix = world->name_prefix;
+    if (type_name && prefix) {
+        ecs_size_t len = ecs_os_strlen(prefix);
+        if (!ecs_os_strncmp(type_name, prefix, len) && 
+           (isupper(type_name[len]) || type_name[len] == '_')) 
+        {
+            if (type_name[len] == '_') {
+                return type_name + len + 1;
+            } else {
+                return type_name + len;
+            }
+        }
+    }
+
+    return type_name;
+}
+
+void ecs_set_symbol(
+    ecs_world_t *world,
+    ecs_entity_t e,
+    const char *name)
+{
+    if (!name) {
+        return;
+    }
+    
+    const char *e_name = ecs_name_from_symbol(world, name);
+
+    EcsName *name_ptr = ecs_get_mut(world, e, EcsName, NULL);
+    name_ptr->value = e_name;
+
+    if (name_ptr->symbol) {
+        ecs_os_free(name_ptr->symbol);
+    }
+
+    name_ptr->symbol = ecs_os_strdup(name);
+
+    ecs_name_index_update(world, e);
+}
+
+ecs_entity_t ecs_lookup_w_id(
+    ecs_world_t *world,
+    ecs_entity_t e,
+    const char *name)
+{
+    if (e) {
+        /* If explicit id was provided but it does not exist in the world, make
+         * sure it has the proper scope. This can happen when an entity was 
+         * defined in another world. */
+        if (!ecs_exists(world, e)) {
+            ecs_entity_t scope = world->stage.scope;
+            if (scope) {
+                ecs_add_entity(world, e, ECS_CHILDOF | scope);
+            }
+        }
+
+        if (name) {
+            /* Make sure name is the same */
+            const char *existing = ecs_get_name(world, e);
+            if (existing && strcmp(existing, name)) {
+                ecs_abort(ECS_INCONSISTENT_NAME, name);
+            }
+            if (!existing) {
+                ecs_set_symbol(world, e, name);
+            }
+        }
+    }
+    
+    ecs_entity_t result = e;
+    if (!result) {
+        if (!name) {
+            /* If neither an id nor name is specified, return 0 */
+            return 0;
+        }
+
+        result = ecs_lookup(world, name);
+    }
+    
+    return result;
+}
+
+/* -- Public functions -- */
+
+ecs_type_t ecs_type_from_str(
+    ecs_world_t *world,
+    const char *expr)
+{
+    EcsType type = type_from_expr(world, NULL, expr);
+    return type.normalized;
+}
+
+ecs_table_t* ecs_table_from_str(
+    ecs_world_t *world,
+    const char *expr)
+{
+    if (expr) {
+        ecs_vector_t *vec = ecs_vector_new(ecs_entity_t, 1);
+        ecs_parse_expr(world, NULL, expr, parse_type_action, &vec);
+        ecs_table_t *result = table_from_vec(world, vec);
+        ecs_vector_free(vec);
+        return result;
+    } else {
+        return NULL;
+    }
+}
+
+ecs_entity_t ecs_new_entity(
+    ecs_world_t *world,
+    ecs_entity_t e,
+    const char *name,
+    const char *expr)
+{
+    ecs_entity_t result = ecs_lookup_w_id(world, e, name);
+    if (!result) {
+        result = ecs_new(world, 0);
+        ecs_set_symbol(world, result, name);
+    }
+    
+    EcsType type = type_from_expr(world, name, expr);
+    ecs_add_type(world, result, type.normalized);
+
+    return result;
+}
+
+ecs_entity_t ecs_new_prefab(
+    ecs_world_t *world,
+    ecs_entity_t e,
+    const char *name,
+    const char *expr)
+{
+    ecs_entity_t result = ecs_lookup_w_id(world, e, name);
+    if (!result) {
+        result = ecs_new(world, 0);
+        ecs_set_symbol(world, result, name);
+    }
+
+    ecs_add_entity(world, result, EcsPrefab);
+
+    EcsType type = type_from_expr(world, name, expr);
+    ecs_add_type(world, result, type.normalized);
+
+    return result;
+}
+
+ecs_entity_t ecs_new_component(
+    ecs_world_t *world,
+    ecs_entity_t e,
+    const char *name,
+    size_t size,
+    size_t alignment)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    assert(world->magic == ECS_WORLD_MAGIC);
+    bool in_progress = world->in_progress;
+    bool found = false;
+
+    /* If world is in progress component may be registered, but only when not
+     * in multithreading mode. */
+    if (in_progress) {
+        ecs_assert(ecs_vector_count(world->workers) < 1, 
+            ECS_INVALID_WHILE_ITERATING, NULL);
+
+        /* Component creation should not be deferred */
+        ecs_defer_end(world);
+        world->in_progress = false;
+    }
+
+    ecs_entity_t result = ecs_lookup_w_id(world, e, name);
+    if (!result) {
+        result = ecs_new_component_id(world);
+        found = true;
+    }
+
+    /* ecs_new_component_id does not add the scope, so add it explicitly */
+    ecs_entity_t scope = world->stage.scope;
+    if (scope) {
+        ecs_add_entity(world, result, ECS_CHILDOF | scope);
+    }
+
+    if (found) {
+        ecs_set_symbol(world, result, name);
+    }
 
-    ecs_entity_t *array = ecs_vector_first(vec, ecs_entity_t);
-    int32_t i, count = ecs_vector_count(vec);
-    for (i = 0; i < count; i ++) {
-        ecs_entity_t e = array[i];
-        if (ECS_HAS_ROLE(e, AND)) {
-            ecs_entity_t entity = e & ECS_COMPONENT_MASK;
-            const EcsType *type_ptr = ecs_get(world, entity, EcsType);
-            ecs_assert(type_ptr != NULL, ECS_INVALID_PARAMETER, 
-                "flag must be applied to type");
+    bool added = false;
+    EcsComponent *ptr = ecs_get_mut(world, result, EcsComponent, &added);
 
-            ecs_vector_each(type_ptr->normalized, ecs_entity_t, c_ptr, {
-                ecs_entity_t *el = ecs_vector_add(&normalized, ecs_entity_t);
-                *el = *c_ptr;
-            })
-        }       
+    if (added) {
+        ptr->size = ecs_from_size_t(size);
+        ptr->alignment = ecs_from_size_t(alignment);
+    } else {
+        if (ptr->size != ecs_from_size_t(size)) {
+            ecs_abort(ECS_INVALID_COMPONENT_SIZE, name);
+        }
+        if (ptr->alignment != ecs_from_size_t(alignment)) {
+            ecs_abort(ECS_INVALID_COMPONENT_SIZE, name);
+        }
     }
 
-    /* Only get normalized type if it's different from the type */
-    if (normalized) {
-        ecs_entities_t normalized_array = ecs_type_to_entities(normalized);
-        ecs_table_t *norm_table = ecs_table_traverse_add(
-            world, table, &normalized_array, NULL);
+    ecs_modified(world, result, EcsComponent);
 
-        result.normalized = norm_table->type;
+    if (e > world->stats.last_component_id && e < ECS_HI_COMPONENT_ID) {
+        world->stats.last_component_id = e + 1;
+    }
 
-        ecs_vector_free(normalized);
-    } else {
-        result.normalized = result.type;
+    if (in_progress) {
+        world->in_progress = true;
+        ecs_defer_begin(world);
     }
 
     return result;
 }
 
-static
-EcsType type_from_expr(
+ecs_entity_t ecs_new_type(
     ecs_world_t *world,
+    ecs_entity_t e,
     const char *name,
     const char *expr)
 {
-    if (expr) {
-        ecs_vector_t *vec = ecs_vector_new(ecs_entity_t, 1);
-        ecs_parse_expr(world, name, expr, parse_type_action, &vec);
-        EcsType result = type_from_vec(world, vec);
-        ecs_vector_free(vec);
-        return result;
-    } else {
-        return (EcsType){0, 0};
+    assert(world->magic == ECS_WORLD_MAGIC);
+
+    ecs_entity_t result = ecs_lookup_w_id(world, e, name);
+    if (!result) {
+        result = ecs_new_entity(world, 0, name, NULL);
     }
-}
+    
+    EcsType type_parsed = type_from_expr(world, name, expr);
 
-/* If a name prefix is set with ecs_set_name_prefix, check if the entity name
- * has the prefix, and if so remove it. This enables using prefixed names in C
- * for components / systems while storing a canonical / language independent 
- * identifier. */
-const char* ecs_name_from_symbol(
-    ecs_world_t *world,
-    const char *type_name)
-{
-    const char *prefix = world->name_prefix;
-    if (type_name && prefix) {
-        ecs_size_t len = ecs_os_strlen(prefix);
-        if (!ecs_os_strncmp(type_name, prefix, len) && 
-           (isupper(type_name[len]) || type_name[len] == '_')) 
-        {
-            if (type_name[len] == '_') {
-                return type_name + len + 1;
-            } else {
-                return type_name + len;
-            }
+    bool added = false;
+    EcsType *type = ecs_get_mut(world, result, EcsType, &added);
+    if (added) {
+        type->type = type_parsed.type;
+        type->normalized = type_parsed.normalized;
+    } else {
+        if (type->type != type_parsed.type) {
+            ecs_abort(ECS_ALREADY_DEFINED, name);
         }
-    }
 
-    return type_name;
+        if (type->normalized != type_parsed.normalized) {
+            ecs_abort(ECS_ALREADY_DEFINED, name);
+        }
+    }     
+
+    /* This will allow the type to show up in debug tools */
+    ecs_map_set(world->type_handles, (uintptr_t)type_parsed.type, &result);
+
+    return result;
 }
 
-void ecs_set_symbol(
-    ecs_world_t *world,
-    ecs_entity_t e,
-    const char *name)
-{
-    if (!name) {
-        return;
+/* Global type variables */
+ecs_type_t ecs_type(EcsComponent);
+ecs_type_t ecs_type(EcsType);
+ecs_type_t ecs_type(EcsName);
+ecs_type_t ecs_type(EcsPrefab);
+
+/* Component lifecycle actions for EcsName */
+static ECS_CTOR(EcsName, ptr, {
+    ptr->value = NULL;
+    ptr->alloc_value = NULL;
+    ptr->symbol = NULL;
+})
+
+static ECS_DTOR(EcsName, ptr, {
+    ecs_os_free(ptr->alloc_value);
+    ecs_os_free(ptr->symbol);
+    ptr->value = NULL;
+    ptr->alloc_value = NULL;
+    ptr->symbol = NULL;
+})
+
+static ECS_COPY(EcsName, dst, src, {
+    if (dst->alloc_value) {
+        ecs_os_free(dst->alloc_value);
+        dst->alloc_value = NULL;
+    }
+
+    if (dst->symbol) {
+        ecs_os_free(dst->symbol);
+        dst->symbol = NULL;
     }
     
-    const char *e_name = ecs_name_from_symbol(world, name);
+    if (src->alloc_value) {
+        dst->alloc_value = ecs_os_strdup(src->alloc_value);
+        dst->value = dst->alloc_value;
+    } else {
+        dst->alloc_value = NULL;
+        dst->value = src->value;
+    }
 
-    EcsName *name_ptr = ecs_get_mut(world, e, EcsName, NULL);
-    name_ptr->value = e_name;
+    if (src->symbol) {
+        dst->symbol = ecs_os_strdup(src->symbol);
+    }
+})
 
-    if (name_ptr->symbol) {
-        ecs_os_free(name_ptr->symbol);
+static ECS_MOVE(EcsName, dst, src, {
+    if (dst->alloc_value) {
+        ecs_os_free(dst->alloc_value);
+    }
+    if (dst->symbol) {
+        ecs_os_free(dst->symbol);
     }
 
-    name_ptr->symbol = ecs_os_strdup(name);
-}
+    dst->value = src->value;
+    dst->alloc_value = src->alloc_value;
+    dst->symbol = src->symbol;
 
-ecs_entity_t ecs_lookup_w_id(
+    src->value = NULL;
+    src->alloc_value = NULL;
+    src->symbol = NULL;
+})
+
+/* -- Bootstrapping -- */
+
+#define bootstrap_component(world, table, name)\
+    _bootstrap_component(world, table, ecs_typeid(name), #name, sizeof(name),\
+        ECS_ALIGNOF(name))
+
+static
+void _bootstrap_component(
     ecs_world_t *world,
-    ecs_entity_t e,
-    const char *name)
+    ecs_table_t *table,
+    ecs_entity_t entity,
+    const char *id,
+    ecs_size_t size,
+    ecs_size_t alignment)
 {
-    if (e) {
-        /* If explicit id was provided but it does not exist in the world, make
-         * sure it has the proper scope. This can happen when an entity was 
-         * defined in another world. */
-        if (!ecs_exists(world, e)) {
-            ecs_entity_t scope = world->stage.scope;
-            if (scope) {
-                ecs_add_entity(world, e, ECS_CHILDOF | scope);
-            }
-        }
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
 
-        if (name) {
-            /* Make sure name is the same */
-            const char *existing = ecs_get_name(world, e);
-            if (existing && strcmp(existing, name)) {
-                ecs_abort(ECS_INCONSISTENT_NAME, name);
-            }
-            if (!existing) {
-                ecs_set_symbol(world, e, name);
-            }
-        }
-    }
-    
-    ecs_entity_t result = e;
-    if (!result) {
-        if (!name) {
-            /* If neither an id nor name is specified, return 0 */
-            return 0;
-        }
+    ecs_data_t *data = ecs_table_get_or_create_data(table);
+    ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
 
-        result = ecs_lookup(world, name);
-    }
+    ecs_column_t *columns = data->columns;
+    ecs_assert(columns != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    /* Create record in entity index */
+    ecs_record_t *record = ecs_eis_get_or_create(world, entity);
+    record->table = table;
+
+    /* Insert row into table to store EcsComponent itself */
+    int32_t index = ecs_table_append(world, table, data, entity, record, false);
+    record->row = index + 1;
+
+    /* Set size and id */
+    EcsComponent *c_info = ecs_vector_first(columns[0].data, EcsComponent);
+    EcsName *id_data = ecs_vector_first(columns[1].data, EcsName);
     
-    return result;
+    c_info[index].size = size;
+    c_info[index].alignment = alignment;
+    id_data[index].value = &id[ecs_os_strlen("Ecs")]; /* Skip prefix */
+    id_data[index].symbol = ecs_os_strdup(id);
+    id_data[index].alloc_value = NULL;
 }
 
-/* -- Public functions -- */
+/** Create type for component */
+ecs_type_t ecs_bootstrap_type(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    ecs_table_t *table = ecs_table_find_or_create(world, &(ecs_entities_t){
+        .array = (ecs_entity_t[]){entity},
+        .count = 1
+    });
+
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(table->type != NULL, ECS_INTERNAL_ERROR, NULL);
 
-ecs_type_t ecs_type_from_str(
-    ecs_world_t *world,
-    const char *expr)
-{
-    EcsType type = type_from_expr(world, NULL, expr);
-    return type.normalized;
+    return table->type;
 }
 
-ecs_table_t* ecs_table_from_str(
-    ecs_world_t *world,
-    const char *expr)
+/** Bootstrap types for builtin components and tags */
+static
+void bootstrap_types(
+    ecs_world_t *world)
 {
-    if (expr) {
-        ecs_vector_t *vec = ecs_vector_new(ecs_entity_t, 1);
-        ecs_parse_expr(world, NULL, expr, parse_type_action, &vec);
-        ecs_table_t *result = table_from_vec(world, vec);
-        ecs_vector_free(vec);
-        return result;
-    } else {
-        return NULL;
-    }
+    ecs_type(EcsComponent) = ecs_bootstrap_type(world, ecs_typeid(EcsComponent));
+    ecs_type(EcsType) = ecs_bootstrap_type(world, ecs_typeid(EcsType));
+    ecs_type(EcsName) = ecs_bootstrap_type(world, ecs_typeid(EcsName));
 }
 
-ecs_entity_t ecs_new_entity(
-    ecs_world_t *world,
-    ecs_entity_t e,
-    const char *name,
-    const char *expr)
+/** Initialize component table. This table is manually constructed to bootstrap
+ * flecs. After this function has been called, the builtin components can be
+ * created. 
+ * The reason this table is constructed manually is because it requires the size
+ * and alignment of the EcsComponent and EcsName components, which haven't been 
+ * created yet */
+static
+ecs_table_t* bootstrap_component_table(
+    ecs_world_t *world)
 {
-    ecs_entity_t result = ecs_lookup_w_id(world, e, name);
-    if (!result) {
-        result = ecs_new(world, 0);
-        ecs_set_symbol(world, result, name);
-    }
-    
-    EcsType type = type_from_expr(world, name, expr);
-    ecs_add_type(world, result, type.normalized);
+    ecs_entity_t entities[] = {ecs_typeid(EcsComponent), ecs_typeid(EcsName), ECS_CHILDOF | EcsFlecsCore};
+    ecs_entities_t array = {
+        .array = entities,
+        .count = 3
+    };
 
-    return result;
-}
+    ecs_table_t *result = ecs_table_find_or_create(world, &array);
+    ecs_data_t *data = ecs_table_get_or_create_data(result);
 
-ecs_entity_t ecs_new_prefab(
-    ecs_world_t *world,
-    ecs_entity_t e,
-    const char *name,
-    const char *expr)
-{
-    ecs_entity_t result = ecs_lookup_w_id(world, e, name);
-    if (!result) {
-        result = ecs_new(world, 0);
-        ecs_set_symbol(world, result, name);
-    }
+    /* Preallocate enough memory for initial components */
+    data->entities = ecs_vector_new(ecs_entity_t, EcsFirstUserComponentId);
+    data->record_ptrs = ecs_vector_new(ecs_record_t*, EcsFirstUserComponentId);
 
-    ecs_add_entity(world, result, EcsPrefab);
+    data->columns = ecs_os_malloc(sizeof(ecs_column_t) * 2);
+    ecs_assert(data->columns != NULL, ECS_OUT_OF_MEMORY, NULL);
 
-    EcsType type = type_from_expr(world, name, expr);
-    ecs_add_type(world, result, type.normalized);
+    data->columns[0].data = ecs_vector_new(EcsComponent, EcsFirstUserComponentId);
+    data->columns[0].size = sizeof(EcsComponent);
+    data->columns[0].alignment = ECS_ALIGNOF(EcsComponent);
+    data->columns[1].data = ecs_vector_new(EcsName, EcsFirstUserComponentId);
+    data->columns[1].size = sizeof(EcsName);
+    data->columns[1].alignment = ECS_ALIGNOF(EcsName);
 
+    result->column_count = 2;
+    
     return result;
 }
 
-ecs_entity_t ecs_new_component(
-    ecs_world_t *world,
-    ecs_entity_t e,
-    const char *name,
-    size_t size,
-    size_t alignment)
+void ecs_bootstrap(
+    ecs_world_t *world)
 {
-    ecs_assert(world != NULL, ECS_INVALID_PARAMETER, NULL);
-    assert(world->magic == ECS_WORLD_MAGIC);
-    bool in_progress = world->in_progress;
-    bool found = false;
+    ecs_type(EcsComponent) = NULL;
 
-    /* If world is in progress component may be registered, but only when not
-     * in multithreading mode. */
-    if (in_progress) {
-        ecs_assert(ecs_vector_count(world->workers) < 1, 
-            ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_trace_1("bootstrap core components");
+    ecs_log_push();
 
-        /* Component creation should not be deferred */
-        ecs_defer_end(world);
-        world->in_progress = false;
-    }
+    /* Create table that will hold components (EcsComponent, EcsName) */
+    ecs_table_t *table = bootstrap_component_table(world);
+    assert(table != NULL);
 
-    ecs_entity_t result = ecs_lookup_w_id(world, e, name);
-    if (!result) {
-        result = ecs_new_component_id(world);
-        found = true;
-    }
+    bootstrap_component(world, table, EcsName);
+    bootstrap_component(world, table, EcsComponent);
+    bootstrap_component(world, table, EcsType);
 
-    /* ecs_new_component_id does not add the scope, so add it explicitly */
-    ecs_entity_t scope = world->stage.scope;
-    if (scope) {
-        ecs_add_entity(world, result, ECS_CHILDOF | scope);
-    }
+    ecs_set_component_actions(world, EcsName, {
+        .ctor = ecs_ctor(EcsName),
+        .dtor = ecs_dtor(EcsName),
+        .copy = ecs_copy(EcsName),
+        .move = ecs_move(EcsName)
+    });    
 
-    if (found) {
-        ecs_set_symbol(world, result, name);
-    }
+    world->stats.last_component_id = EcsFirstUserComponentId;
+    world->stats.last_id = EcsFirstUserEntityId;
+    world->stats.min_id = 0;
+    world->stats.max_id = 0;
 
-    bool added = false;
-    EcsComponent *ptr = ecs_get_mut(world, result, EcsComponent, &added);
+    bootstrap_types(world);
 
-    if (added) {
-        ptr->size = ecs_from_size_t(size);
-        ptr->alignment = ecs_from_size_t(alignment);
-    } else {
-        if (ptr->size != ecs_from_size_t(size)) {
-            ecs_abort(ECS_INVALID_COMPONENT_SIZE, name);
-        }
-        if (ptr->alignment != ecs_from_size_t(alignment)) {
-            ecs_abort(ECS_INVALID_COMPONENT_SIZE, name);
-        }
-    }
+    ecs_set_scope(world, EcsFlecsCore);
 
-    ecs_modified(world, result, EcsComponent);
+    ecs_bootstrap_tag(world, EcsModule);
+    ecs_bootstrap_tag(world, EcsPrefab);
+    ecs_bootstrap_tag(world, EcsHidden);
+    ecs_bootstrap_tag(world, EcsDisabled);
 
-    if (e > world->stats.last_component_id && e < ECS_HI_COMPONENT_ID) {
-        world->stats.last_component_id = e + 1;
-    }
+    /* Initialize scopes */
+    ecs_set(world, EcsFlecs, EcsName, {.value = "flecs"});
+    ecs_add_entity(world, EcsFlecs, EcsModule);
+    ecs_set(world, EcsFlecsCore, EcsName, {.value = "core"});
+    ecs_add_entity(world, EcsFlecsCore, EcsModule);
+    ecs_add_entity(world, EcsFlecsCore, ECS_CHILDOF | EcsFlecs);
 
-    if (in_progress) {
-        world->in_progress = true;
-        ecs_defer_begin(world);
-    }
+    /* Initialize EcsWorld */
+    ecs_set(world, EcsWorld, EcsName, {.value = "World"});
+    ecs_assert(ecs_get_name(world, EcsWorld) != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(ecs_lookup(world, "World") == EcsWorld, ECS_INTERNAL_ERROR, NULL);
+    ecs_add_entity(world, EcsWorld, ECS_CHILDOF | EcsFlecsCore);
 
-    return result;
+    /* Initialize EcsSingleton */
+    ecs_set(world, EcsSingleton, EcsName, {.value = "$"});
+    ecs_assert(ecs_get_name(world, EcsSingleton) != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(ecs_lookup(world, "$") == EcsSingleton, ECS_INTERNAL_ERROR, NULL);
+    ecs_add_entity(world, EcsSingleton, ECS_CHILDOF | EcsFlecsCore);
+
+    /* Initialize EcsWildcard */
+    ecs_set(world, EcsWildcard, EcsName, {.value = "*"});
+    ecs_assert(ecs_get_name(world, EcsWildcard) != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(ecs_lookup(world, "*") == EcsWildcard, ECS_INTERNAL_ERROR, NULL);
+    ecs_add_entity(world, EcsWildcard, ECS_CHILDOF | EcsFlecsCore);    
+
+    ecs_set_scope(world, 0);
+
+    ecs_log_pop();
 }
 
-ecs_entity_t ecs_new_type(
-    ecs_world_t *world,
-    ecs_entity_t e,
-    const char *name,
-    const char *expr)
+
+static
+bool path_append(
+    ecs_world_t *world, 
+    ecs_entity_t parent, 
+    ecs_entity_t child, 
+    ecs_entity_t component,
+    const char *sep,
+    const char *prefix,
+    ecs_strbuf_t *buf)
 {
-    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_type_t type = ecs_get_type(world, child);
+    ecs_entity_t cur = ecs_find_in_type(world, type, component, ECS_CHILDOF);
+    
+    if (cur) {
+        if (cur != parent && cur != EcsFlecsCore) {
+            path_append(world, parent, cur, component, sep, prefix, buf);
+            ecs_strbuf_appendstr(buf, sep);
+        }
+    } else if (prefix) {
+        ecs_strbuf_appendstr(buf, prefix);
+    }
 
-    ecs_entity_t result = ecs_lookup_w_id(world, e, name);
-    if (!result) {
-        result = ecs_new_entity(world, 0, name, NULL);
+    char buff[22];
+    const char *name = ecs_get_name(world, child);
+    if (!name) {
+        ecs_os_sprintf(buff, "%u", (uint32_t)child);
+        name = buff;
     }
-    
-    EcsType type_parsed = type_from_expr(world, name, expr);
 
-    bool added = false;
-    EcsType *type = ecs_get_mut(world, result, EcsType, &added);
-    if (added) {
-        type->type = type_parsed.type;
-        type->normalized = type_parsed.normalized;
-    } else {
-        if (type->type != type_parsed.type) {
-            ecs_abort(ECS_ALREADY_DEFINED, name);
-        }
+    ecs_strbuf_appendstr(buf, name);
 
-        if (type->normalized != type_parsed.normalized) {
-            ecs_abort(ECS_ALREADY_DEFINED, name);
+    return cur != 0;
+}
+
+static
+ecs_entity_t find_as_alias(
+    ecs_world_t *world,
+    const char *name)
+{
+    int32_t i, count = ecs_vector_count(world->aliases);
+    ecs_alias_t *aliases = ecs_vector_first(world->aliases, ecs_alias_t);
+    for (i = 0; i < count; i ++) {
+        if (!strcmp(aliases[i].name, name)) {
+            return aliases[i].entity;
         }
-    }     
-
-    /* This will allow the type to show up in debug tools */
-    ecs_map_set(world->type_handles, (uintptr_t)type_parsed.type, &result);
+    }
 
-    return result;
+    return 0;
 }
 
-/* Global type variables */
-ecs_type_t ecs_type(EcsComponent);
-ecs_type_t ecs_type(EcsType);
-ecs_type_t ecs_type(EcsName);
-ecs_type_t ecs_type(EcsPrefab);
+char* ecs_get_path_w_sep(
+    ecs_world_t *world,
+    ecs_entity_t parent,
+    ecs_entity_t child,
+    ecs_entity_t component,
+    const char *sep,
+    const char *prefix)
+{
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
 
-/* Component lifecycle actions for EcsName */
-static ECS_CTOR(EcsName, ptr, {
-    ptr->value = NULL;
-    ptr->alloc_value = NULL;
-    ptr->symbol = NULL;
-})
+    if (parent != child) {
+        path_append(world, parent, child, component, sep, prefix, &buf);
+    } else {
+        ecs_strbuf_appendstr(&buf, "");
+    }
 
-static ECS_DTOR(EcsName, ptr, {
-    ecs_os_free(ptr->alloc_value);
-    ecs_os_free(ptr->symbol);
-    ptr->value = NULL;
-    ptr->alloc_value = NULL;
-    ptr->symbol = NULL;
-})
+    return ecs_strbuf_get(&buf);
+}
 
-static ECS_COPY(EcsName, dst, src, {
-    if (dst->alloc_value) {
-        ecs_os_free(dst->alloc_value);
-        dst->alloc_value = NULL;
+static
+bool is_number(
+    const char *name)
+{
+    if (!isdigit(name[0])) {
+        return false;
     }
 
-    if (dst->symbol) {
-        ecs_os_free(dst->symbol);
-        dst->symbol = NULL;
+    ecs_size_t i, s = ecs_os_strlen(name);
+    for (i = 1; i < s; i ++) {
+        if (!isdigit(name[i])) {
+            break;
+        }
     }
-    
-    if (src->alloc_value) {
-        dst->alloc_value = ecs_os_strdup(src->alloc_value);
-        dst->value = dst->alloc_value;
-    } else {
-        dst->alloc_value = NULL;
-        dst->value = src->value;
+
+    return i >= s;
+}
+
+static 
+ecs_entity_t name_to_id(
+    const char *name)
+{
+    long int result = atol(name);
+    ecs_assert(result >= 0, ECS_INTERNAL_ERROR, NULL);
+    return (ecs_entity_t)result;
+}
+
+static
+ecs_entity_t find_child_in_table(
+    ecs_table_t *table,
+    const char *name)
+{
+    /* If table doesn't have EcsName, then don't bother */
+    int32_t name_index = ecs_type_index_of(table->type, ecs_typeid(EcsName));
+    if (name_index == -1) {
+        return 0;
     }
 
-    if (src->symbol) {
-        dst->symbol = ecs_os_strdup(src->symbol);
+    ecs_data_t *data = ecs_table_get_data(table);
+    if (!data || !data->columns) {
+        return 0;
     }
-})
 
-static ECS_MOVE(EcsName, dst, src, {
-    if (dst->alloc_value) {
-        ecs_os_free(dst->alloc_value);
+    int32_t i, count = ecs_vector_count(data->entities);
+    if (!count) {
+        return 0;
     }
-    if (dst->symbol) {
-        ecs_os_free(dst->symbol);
+
+    if (is_number(name)) {
+        return name_to_id(name);
     }
 
-    dst->value = src->value;
-    dst->alloc_value = src->alloc_value;
-    dst->symbol = src->symbol;
+    ecs_column_t *column = &data->columns[name_index];
+    EcsName *names = ecs_vector_first(column->data, EcsName);
 
-    src->value = NULL;
-    src->alloc_value = NULL;
-    src->symbol = NULL;
-})
+    for (i = 0; i < count; i ++) {
+        const char *cur_name = names[i].value;
+        const char *cur_sym = names[i].symbol;
+        if ((cur_name && !strcmp(cur_name, name)) || (cur_sym && !strcmp(cur_sym, name))) {
+            return *ecs_vector_get(data->entities, ecs_entity_t, i);
+        }
+    }
 
-/* -- Bootstrapping -- */
+    return 0;
+}
 
-#define bootstrap_component(world, table, name)\
-    _bootstrap_component(world, table, ecs_typeid(name), #name, sizeof(name),\
-        ECS_ALIGNOF(name))
+/* -- Name index -- */
+
+/* The name index stores named entities by scope and by the hash of their name,
+ * so that looking up a child does not require visiting every entity in the
+ * scope. Entities with a symbol that is different from their name are also
+ * stored by the hash of the symbol. All entities are also stored by hash only,
+ * which is used to lookup symbols across scopes. 
+ *
+ * Entries are validated on lookup, which means that an entry does not have to
+ * be removed when an entity is deleted in bulk. Operations that add names in
+ * bulk mark the index as dirty, which rebuilds the index on the next lookup. */
 
 static
-void _bootstrap_component(
-    ecs_world_t *world,
-    ecs_table_t *table,
-    ecs_entity_t entity,
-    const char *id,
-    ecs_size_t size,
-    ecs_size_t alignment)
+uint64_t name_hash(
+    const char *name)
 {
-    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    uint64_t hash;
+    ecs_hash(name, ecs_os_strlen(name), &hash);
+    return hash;
+}
 
-    ecs_data_t *data = ecs_table_get_or_create_data(table);
-    ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
+static
+ecs_map_key_t scope_key(
+    ecs_entity_t scope,
+    uint64_t hash)
+{
+    return hash ^ ((scope + 1) * 0x9E3779B97F4A7C15);
+}
 
-    ecs_column_t *columns = data->columns;
-    ecs_assert(columns != NULL, ECS_INTERNAL_ERROR, NULL);
+static
+ecs_entity_t table_scope(
+    ecs_table_t *table)
+{
+    if (!(table->flags & EcsTableHasParent)) {
+        return 0;
+    }
 
-    /* Create record in entity index */
-    ecs_record_t *record = ecs_eis_get_or_create(world, entity);
-    record->table = table;
+    ecs_vector_each(table->type, ecs_entity_t, c_ptr, {
+        if (ECS_HAS_ROLE(*c_ptr, CHILDOF)) {
+            return *c_ptr & ECS_COMPONENT_MASK;
+        }
+    });
 
-    /* Insert row into table to store EcsComponent itself */
-    int32_t index = ecs_table_append(world, table, data, entity, record, false);
-    record->row = index + 1;
+    return 0;
+}
 
-    /* Set size and id */
-    EcsComponent *c_info = ecs_vector_first(columns[0].data, EcsComponent);
-    EcsName *id_data = ecs_vector_first(columns[1].data, EcsName);
-    
-    c_info[index].size = size;
-    c_info[index].alignment = alignment;
-    id_data[index].value = &id[ecs_os_strlen("Ecs")]; /* Skip prefix */
-    id_data[index].symbol = ecs_os_strdup(id);
-    id_data[index].alloc_value = NULL;
+static
+void bucket_add(
+    ecs_world_t *world,
+    ecs_map_key_t key,
+    ecs_entity_t entity)
+{
+    ecs_name_bucket_t *bucket = ecs_map_ensure(
+        world->name_index, ecs_name_bucket_t, key);
+    if (!bucket->first) {
+        bucket->first = entity;
+    } else {
+        ecs_entity_t *elem = ecs_vector_add(&bucket->more, ecs_entity_t);
+        *elem = entity;
+    }
 }
 
-/** Create type for component */
-ecs_type_t ecs_bootstrap_type(
+static
+void bucket_remove(
     ecs_world_t *world,
+    ecs_map_key_t key,
     ecs_entity_t entity)
 {
-    ecs_table_t *table = ecs_table_find_or_create(world, &(ecs_entities_t){
-        .array = (ecs_entity_t[]){entity},
-        .count = 1
-    });
+    ecs_name_bucket_t *bucket = ecs_map_get(
+        world->name_index, ecs_name_bucket_t, key);
+    if (!bucket) {
+        return;
+    }
 
-    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(table->type != NULL, ECS_INTERNAL_ERROR, NULL);
+    int32_t i, count = ecs_vector_count(bucket->more);
+    ecs_entity_t *more = ecs_vector_first(bucket->more, ecs_entity_t);
 
-    return table->type;
+    if (bucket->first == entity) {
+        if (count) {
+            bucket->first = more[count - 1];
+            ecs_vector_remove_last(bucket->more);
+        } else {
+            ecs_map_remove(world->name_index, key);
+        }
+        return;
+    }
+
+    for (i = 0; i < count; i ++) {
+        if (more[i] == entity) {
+            ecs_vector_remove_index(bucket->more, ecs_entity_t, i);
+            break;
+        }
+    }
 }
 
-/** Bootstrap types for builtin components and tags */
 static
-void bootstrap_types(
-    ecs_world_t *world)
+void index_hash(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_entity_t scope,
+    uint64_t hash)
 {
-    ecs_type(EcsComponent) = ecs_bootstrap_type(world, ecs_typeid(EcsComponent));
-    ecs_type(EcsType) = ecs_bootstrap_type(world, ecs_typeid(EcsType));
-    ecs_type(EcsName) = ecs_bootstrap_type(world, ecs_typeid(EcsName));
+    if (hash) {
+        bucket_add(world, scope_key(scope, hash), entity);
+        bucket_add(world, hash, entity);
+    }
 }
 
-/** Initialize component table. This table is manually constructed to bootstrap
- * flecs. After this function has been called, the builtin components can be
- * created. 
- * The reason this table is constructed manually is because it requires the size
- * and alignment of the EcsComponent and EcsName components, which haven't been 
- * created yet */
 static
-ecs_table_t* bootstrap_component_table(
-    ecs_world_t *world)
+void unindex_hash(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_entity_t scope,
+    uint64_t hash)
 {
-    ecs_entity_t entities[] = {ecs_typeid(EcsComponent), ecs_typeid(EcsName), ECS_CHILDOF | EcsFlecsCore};
-    ecs_entities_t array = {
-        .array = entities,
-        .count = 3
-    };
-
-    ecs_table_t *result = ecs_table_find_or_create(world, &array);
-    ecs_data_t *data = ecs_table_get_or_create_data(result);
-
-    /* Preallocate enough memory for initial components */
-    data->entities = ecs_vector_new(ecs_entity_t, EcsFirstUserComponentId);
-    data->record_ptrs = ecs_vector_new(ecs_record_t*, EcsFirstUserComponentId);
-
-    data->columns = ecs_os_malloc(sizeof(ecs_column_t) * 2);
-    ecs_assert(data->columns != NULL, ECS_OUT_OF_MEMORY, NULL);
-
-    data->columns[0].data = ecs_vector_new(EcsComponent, EcsFirstUserComponentId);
-    data->columns[0].size = sizeof(EcsComponent);
-    data->columns[0].alignment = ECS_ALIGNOF(EcsComponent);
-    data->columns[1].data = ecs_vector_new(EcsName, EcsFirstUserComponentId);
-    data->columns[1].size = sizeof(EcsName);
-    data->columns[1].alignment = ECS_ALIGNOF(EcsName);
-
-    result->column_count = 2;
-    
-    return result;
+    if (hash) {
+        bucket_remove(world, scope_key(scope, hash), entity);
+        bucket_remove(world, hash, entity);
+    }
 }
 
-void ecs_bootstrap(
-    ecs_world_t *world)
+static
+void index_entity(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_table_t *table,
+    const EcsName *name)
 {
-    ecs_type(EcsComponent) = NULL;
+    const char *value = name->value;
+    const char *symbol = name->symbol;
+    if (!value && !symbol) {
+        return;
+    }
 
-    ecs_trace_1("bootstrap core components");
-    ecs_log_push();
+    ecs_name_entry_t entry = {
+        .scope = table_scope(table),
+        .name_hash = value ? name_hash(value) : 0
+    };
 
-    /* Create table that will hold components (EcsComponent, EcsName) */
-    ecs_table_t *table = bootstrap_component_table(world);
-    assert(table != NULL);
+    if (symbol && (!value || strcmp(symbol, value))) {
+        entry.symbol_hash = name_hash(symbol);
+    }
 
-    bootstrap_component(world, table, EcsName);
-    bootstrap_component(world, table, EcsComponent);
-    bootstrap_component(world, table, EcsType);
+    index_hash(world, entity, entry.scope, entry.name_hash);
+    index_hash(world, entity, entry.scope, entry.symbol_hash);
 
-    ecs_set_component_actions(world, EcsName, {
-        .ctor = ecs_ctor(EcsName),
-        .dtor = ecs_dtor(EcsName),
-        .copy = ecs_copy(EcsName),
-        .move = ecs_move(EcsName)
-    });    
+    ecs_map_set(world->name_entries, entity, &entry);
+}
 
-    world->stats.last_component_id = EcsFirstUserComponentId;
-    world->stats.last_id = EcsFirstUserEntityId;
-    world->stats.min_id = 0;
-    world->stats.max_id = 0;
+static
+void unindex_entity(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    ecs_name_entry_t *entry = ecs_map_get(
+        world->name_entries, ecs_name_entry_t, entity);
+    if (!entry) {
+        return;
+    }
 
-    bootstrap_types(world);
+    unindex_hash(world, entity, entry->scope, entry->name_hash);
+    unindex_hash(world, entity, entry->scope, entry->symbol_hash);
 
-    ecs_set_scope(world, EcsFlecsCore);
+    ecs_map_remove(world->name_entries, entity);
+}
 
-    ecs_bootstrap_tag(world, EcsModule);
-    ecs_bootstrap_tag(world, EcsPrefab);
-    ecs_bootstrap_tag(world, EcsHidden);
-    ecs_bootstrap_tag(world, EcsDisabled);
+static
+void free_name_index(
+    ecs_world_t *world)
+{
+    ecs_map_iter_t it = ecs_map_iter(world->name_index);
+    ecs_name_bucket_t *bucket;
+    while ((bucket = ecs_map_next(&it, ecs_name_bucket_t, NULL))) {
+        ecs_vector_free(bucket->more);
+    }
 
-    /* Initialize scopes */
-    ecs_set(world, EcsFlecs, EcsName, {.value = "flecs"});
-    ecs_add_entity(world, EcsFlecs, EcsModule);
-    ecs_set(world, EcsFlecsCore, EcsName, {.value = "core"});
-    ecs_add_entity(world, EcsFlecsCore, EcsModule);
-    ecs_add_entity(world, EcsFlecsCore, ECS_CHILDOF | EcsFlecs);
+    ecs_map_free(world->name_index);
+    ecs_map_free(world->name_entries);
+    ecs_vector_free(world->name_pending);
+    world->name_index = NULL;
+    world->name_entries = NULL;
+    world->name_pending = NULL;
+}
 
-    /* Initialize EcsWorld */
-    ecs_set(world, EcsWorld, EcsName, {.value = "World"});
-    ecs_assert(ecs_get_name(world, EcsWorld) != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(ecs_lookup(world, "World") == EcsWorld, ECS_INTERNAL_ERROR, NULL);
-    ecs_add_entity(world, EcsWorld, ECS_CHILDOF | EcsFlecsCore);
+static
+void build_name_index(
+    ecs_world_t *world)
+{
+    free_name_index(world);
+    world->name_index = ecs_map_new(ecs_name_bucket_t, 0);
+    world->name_entries = ecs_map_new(ecs_name_entry_t, 0);
 
-    /* Initialize EcsSingleton */
-    ecs_set(world, EcsSingleton, EcsName, {.value = "$"});
-    ecs_assert(ecs_get_name(world, EcsSingleton) != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(ecs_lookup(world, "$") == EcsSingleton, ECS_INTERNAL_ERROR, NULL);
-    ecs_add_entity(world, EcsSingleton, ECS_CHILDOF | EcsFlecsCore);
+    ecs_sparse_each(world->store.tables, ecs_table_t, table, {
+        if (!(table->flags & EcsTableHasName)) {
+            continue;
+        }
 
-    /* Initialize EcsWildcard */
-    ecs_set(world, EcsWildcard, EcsName, {.value = "*"});
-    ecs_assert(ecs_get_name(world, EcsWildcard) != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(ecs_lookup(world, "*") == EcsWildcard, ECS_INTERNAL_ERROR, NULL);
-    ecs_add_entity(world, EcsWildcard, ECS_CHILDOF | EcsFlecsCore);    
+        ecs_data_t *data = ecs_table_get_data(table);
+        if (!data || !data->columns) {
+            continue;
+        }
 
-    ecs_set_scope(world, 0);
+        int32_t name_index = ecs_type_index_of(
+            table->type, ecs_typeid(EcsName));
+        ecs_assert(name_index != -1, ECS_INTERNAL_ERROR, NULL);
 
-    ecs_log_pop();
-}
+        ecs_entity_t *entities = ecs_vector_first(
+            data->entities, ecs_entity_t);
+        EcsName *names = ecs_vector_first(
+            data->columns[name_index].data, EcsName);
+
+        int32_t i, count = ecs_vector_count(data->entities);
+        for (i = 0; i < count; i ++) {
+            index_entity(world, entities[i], table, &names[i]);
+        }
+    });
 
+    world->name_index_dirty = false;
+}
 
+/* Returns whether index can be used. The index is not updated while the world
+ * is progressing, as lookups may happen from multiple threads. */
 static
-bool path_append(
-    ecs_world_t *world, 
-    ecs_entity_t parent, 
-    ecs_entity_t child, 
-    ecs_entity_t component,
-    const char *sep,
-    const char *prefix,
-    ecs_strbuf_t *buf)
+bool name_index_ready(
+    ecs_world_t *world)
 {
-    ecs_type_t type = ecs_get_type(world, child);
-    ecs_entity_t cur = ecs_find_in_type(world, type, component, ECS_CHILDOF);
-    
-    if (cur) {
-        if (cur != parent && cur != EcsFlecsCore) {
-            path_append(world, parent, cur, component, sep, prefix, buf);
-            ecs_strbuf_appendstr(buf, sep);
+    if (world->name_index_dirty) {
+        if (world->in_progress) {
+            return false;
         }
-    } else if (prefix) {
-        ecs_strbuf_appendstr(buf, prefix);
-    }
 
-    char buff[22];
-    const char *name = ecs_get_name(world, child);
-    if (!name) {
-        ecs_os_sprintf(buff, "%u", (uint32_t)child);
-        name = buff;
+        build_name_index(world);
     }
 
-    ecs_strbuf_appendstr(buf, name);
+    if (world->name_pending) {
+        if (world->in_progress) {
+            return false;
+        }
 
-    return cur != 0;
+        ecs_vector_t *pending = world->name_pending;
+        world->name_pending = NULL;
+
+        ecs_vector_each(pending, ecs_entity_t, e_ptr, {
+            if (ecs_is_alive(world, *e_ptr)) {
+                ecs_name_index_update(world, *e_ptr);
+            }
+        });
+
+        ecs_vector_free(pending);
+    }
+
+    return true;
 }
 
 static
-ecs_entity_t find_as_alias(
+bool name_matches(
     ecs_world_t *world,
+    ecs_entity_t entity,
     const char *name)
 {
-    int32_t i, count = ecs_vector_count(world->aliases);
-    ecs_alias_t *aliases = ecs_vector_first(world->aliases, ecs_alias_t);
-    for (i = 0; i < count; i ++) {
-        if (!strcmp(aliases[i].name, name)) {
-            return aliases[i].entity;
-        }
+    if (!ecs_is_alive(world, entity)) {
+        return false;
     }
 
-    return 0;
+    const EcsName *ptr = ecs_get(world, entity, EcsName);
+    if (!ptr) {
+        return false;
+    }
+
+    return (ptr->value && !strcmp(ptr->value, name)) || 
+        (ptr->symbol && !strcmp(ptr->symbol, name));
 }
 
-char* ecs_get_path_w_sep(
+static
+bool in_scope(
     ecs_world_t *world,
-    ecs_entity_t parent,
-    ecs_entity_t child,
-    ecs_entity_t component,
-    const char *sep,
-    const char *prefix)
+    ecs_entity_t entity,
+    ecs_entity_t scope)
 {
-    ecs_strbuf_t buf = ECS_STRBUF_INIT;
-
-    if (parent != child) {
-        path_append(world, parent, child, component, sep, prefix, &buf);
+    ecs_table_t *table = ecs_eis_get(world, entity)->table;
+    if (scope) {
+        return ecs_type_index_of(table->type, ECS_CHILDOF | scope) != -1;
     } else {
-        ecs_strbuf_appendstr(&buf, "");
+        return !(table->flags & EcsTableHasParent);
     }
-
-    return ecs_strbuf_get(&buf);
 }
 
 static
-bool is_number(
+ecs_entity_t find_in_bucket(
+    ecs_world_t *world,
+    ecs_map_key_t key,
+    ecs_entity_t scope,
+    bool any_scope,
     const char *name)
 {
-    if (!isdigit(name[0])) {
-        return false;
+    ecs_name_bucket_t *bucket = ecs_map_get(
+        world->name_index, ecs_name_bucket_t, key);
+    if (!bucket) {
+        return 0;
     }
 
-    ecs_size_t i, s = ecs_os_strlen(name);
-    for (i = 1; i < s; i ++) {
-        if (!isdigit(name[i])) {
-            break;
-        }
+    ecs_entity_t e = bucket->first;
+    if (name_matches(world, e, name) && 
+        (any_scope || in_scope(world, e, scope))) 
+    {
+        return e;
     }
 
-    return i >= s;
+    ecs_vector_each(bucket->more, ecs_entity_t, e_ptr, {
+        e = *e_ptr;
+        if (name_matches(world, e, name) && 
+            (any_scope || in_scope(world, e, scope))) 
+        {
+            return e;
+        }
+    });
+
+    return 0;
 }
 
-static 
-ecs_entity_t name_to_id(
-    const char *name)
+void ecs_name_index_update(
+    ecs_world_t *world,
+    ecs_entity_t entity)
 {
-    long int result = atol(name);
-    ecs_assert(result >= 0, ECS_INTERNAL_ERROR, NULL);
-    return (ecs_entity_t)result;
+    if (world->name_index_dirty) {
+        return;
+    }
+
+    unindex_entity(world, entity);
+
+    ecs_record_t *record = ecs_eis_get(world, entity);
+    if (!record || !record->table) {
+        return;
+    }
+
+    ecs_table_t *table = record->table;
+    if (!(table->flags & EcsTableHasName)) {
+        return;
+    }
+
+    const EcsName *name = ecs_get(world, entity, EcsName);
+    ecs_assert(name != NULL, ECS_INTERNAL_ERROR, NULL);
+    index_entity(world, entity, table, name);
 }
 
-static
-ecs_entity_t find_child_in_table(
-    ecs_table_t *table,
-    const char *name)
+void ecs_name_index_defer(
+    ecs_world_t *world,
+    ecs_entity_t entity)
 {
-    /* If table doesn't have EcsName, then don't bother */
-    int32_t name_index = ecs_type_index_of(table->type, ecs_typeid(EcsName));
-    if (name_index == -1) {
-        return 0;
+    if (!world->name_index_dirty) {
+        ecs_entity_t *e = ecs_vector_add(&world->name_pending, ecs_entity_t);
+        *e = entity;
     }
+}
 
-    ecs_data_t *data = ecs_table_get_data(table);
-    if (!data || !data->columns) {
-        return 0;
+void ecs_name_index_move(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_table_t *table)
+{
+    if (world->name_index_dirty) {
+        return;
     }
 
-    int32_t i, count = ecs_vector_count(data->entities);
-    if (!count) {
-        return 0;
+    if (!table || !(table->flags & EcsTableHasName)) {
+        unindex_entity(world, entity);
+        return;
     }
 
-    if (is_number(name)) {
-        return name_to_id(name);
+    /* Entities that are not indexed yet may have been moved to the table with
+     * a name, for example when it was copied from a base */
+    ecs_name_entry_t *entry = ecs_map_get(
+        world->name_entries, ecs_name_entry_t, entity);
+    if (!entry || entry->scope != table_scope(table)) {
+        ecs_name_index_update(world, entity);
     }
+}
 
-    ecs_column_t *column = &data->columns[name_index];
-    EcsName *names = ecs_vector_first(column->data, EcsName);
-
-    for (i = 0; i < count; i ++) {
-        const char *cur_name = names[i].value;
-        const char *cur_sym = names[i].symbol;
-        if ((cur_name && !strcmp(cur_name, name)) || (cur_sym && !strcmp(cur_sym, name))) {
-            return *ecs_vector_get(data->entities, ecs_entity_t, i);
-        }
+void ecs_name_index_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    if (!world->name_index_dirty) {
+        unindex_entity(world, entity);
     }
+}
 
-    return 0;
+void ecs_name_index_fini(
+    ecs_world_t *world)
+{
+    free_name_index(world);
 }
 
+/* Lookup entity in all scopes by name or symbol */
 static
 ecs_entity_t find_child(
     ecs_world_t *world,
-    ecs_entity_t parent,
     const char *name)
 {
-    (void)parent;
+    if (!is_number(name) && name_index_ready(world)) {
+        return find_in_bucket(world, name_hash(name), 0, true, name);
+    }
     
     ecs_sparse_each(world->store.tables, ecs_table_t, table, {
         ecs_entity_t result = find_child_in_table(table, name);
@@ -23161,17 +28765,33 @@ ecs_entity_t ecs_lookup_child(
 
     ecs_vector_t *child_tables = ecs_map_get_ptr(
         world->child_tables, ecs_vector_t*, parent);
-    
-    if (child_tables) {
-        ecs_vector_each(child_tables, ecs_table_t*, table_ptr, {
-            ecs_table_t *table = *table_ptr;
-            result = find_child_in_table(table, name);
-            if (result) {
-                return result;
-            }
-        });
+    if (!child_tables) {
+        return 0;
+    }
+
+    bool use_index = !is_number(name) && name_index_ready(world);
+    if (use_index) {
+        result = find_in_bucket(
+            world, scope_key(parent, name_hash(name)), parent, false, name);
+        if (result || !parent) {
+            return result;
+        }
     }
 
+    /* Entities are indexed by their first parent. Scan tables of children for
+     * which the parent is not the first parent. */
+    ecs_vector_each(child_tables, ecs_table_t*, table_ptr, {
+        ecs_table_t *table = *table_ptr;
+        if (use_index && table_scope(table) == parent) {
+            continue;
+        }
+
+        result = find_child_in_table(table, name);
+        if (result) {
+            return result;
+        }
+    });
+
     return result;
 }
 
@@ -23207,7 +28827,7 @@ ecs_entity_t ecs_lookup_symbol(
         return name_to_id(name);
     }   
     
-    return find_child(world, 0, name);
+    return find_child(world, name);
 }
 
 static
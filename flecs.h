@@ -387,18 +387,40 @@ typedef int32_t ecs_size_t;
 extern "C" {
 #endif
 
+/* Memory pool from which a vector is allocated */
+typedef struct ecs_pool_t ecs_pool_t;
+
 /* Public, so we can do compile-time header size calculation */
 struct ecs_vector_t {
     int32_t count;
     int32_t size;
+    ecs_pool_t *pool; /* NULL if allocated with the OS API */
     
 #ifndef NDEBUG
     int64_t elem_size;
+    int16_t offset;   /* Used to validate alignment of operations */
 #endif
 };
 
+/* Largest alignment guaranteed by ecs_os_malloc. Vectors with a larger element
+ * alignment are allocated with padding, so the elements can be aligned. */
+#define ECS_VECTOR_MALLOC_ALIGNMENT (16)
+
+/* Size of the vector header, rounded up so that the elements of vectors with
+ * an alignment up to ECS_VECTOR_MALLOC_ALIGNMENT directly follow the header */
+#define ECS_VECTOR_HEADER_SIZE\
+    ECS_ALIGN(ECS_SIZEOF(ecs_vector_t), ECS_VECTOR_MALLOC_ALIGNMENT)
+
+/* Offset of the elements from the start of the vector. Vectors with a larger
+ * alignment than malloc guarantees have an offset larger than the header, which
+ * leaves room for the padding administration. */
+#define ECS_VECTOR_OFFSET(alignment)\
+    ((alignment) > ECS_VECTOR_MALLOC_ALIGNMENT\
+        ? ECS_MAX(ECS_VECTOR_HEADER_SIZE * 2, (alignment))\
+        : ECS_VECTOR_HEADER_SIZE)
+
 /* Compute the header size of the vector from size & alignment */
-#define ECS_VECTOR_U(size, alignment) size, ECS_MAX(ECS_SIZEOF(ecs_vector_t), alignment)
+#define ECS_VECTOR_U(size, alignment) size, ECS_VECTOR_OFFSET(alignment)
 
 /* Compute the header size of the vector from a provided compile-time type */
 #define ECS_VECTOR_T(T) ECS_VECTOR_U(ECS_SIZEOF(T), ECS_ALIGNOF(T))
@@ -408,6 +430,7 @@ struct ecs_vector_t {
 #define ECS_VECTOR_VALUE(T, elem_count)\
 {\
     .elem_size = (int32_t)(ECS_SIZEOF(T)),\
+    .offset = ECS_VECTOR_HEADER_SIZE,\
     .count = elem_count,\
     .size = elem_count\
 }
@@ -424,6 +447,7 @@ struct {\
     union {\
         ecs_vector_t vector;\
         uint64_t align;\
+        char size[ECS_VECTOR_HEADER_SIZE];\
     } header;\
     T array[elem_count];\
 } __##name##_value = {\
@@ -457,6 +481,21 @@ ecs_vector_t* _ecs_vector_new(
 #define ecs_vector_new_t(size, alignment, elem_count) \
     _ecs_vector_new(ECS_VECTOR_U(size, alignment), elem_count)    
 
+/** Create new vector that is allocated from a memory pool. Operations that
+ * reallocate or free the vector use the same pool. */
+FLECS_API
+ecs_vector_t* _ecs_vector_new_w_pool(
+    ecs_pool_t *pool,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define ecs_vector_new_w_pool(pool, T, elem_count) \
+    _ecs_vector_new_w_pool(pool, ECS_VECTOR_T(T), elem_count)
+
+#define ecs_vector_new_w_pool_t(pool, size, alignment, elem_count) \
+    _ecs_vector_new_w_pool(pool, ECS_VECTOR_U(size, alignment), elem_count)
+
 /* Create new vector, initialize it with provided array */
 FLECS_API
 ecs_vector_t* _ecs_vector_from_array(
@@ -478,11 +517,23 @@ void _ecs_vector_zero(
 #define ecs_vector_zero(vector, T) \
     _ecs_vector_zero(vector, ECS_VECTOR_T(T))
 
-/** Free vector */
+/** Free vector. Vectors with an alignment larger than 
+ * ECS_VECTOR_MALLOC_ALIGNMENT must be freed with ecs_vector_free_t. In debug
+ * mode the operation asserts if such a vector is passed in. */
 FLECS_API
 void ecs_vector_free(
     ecs_vector_t *vector);
 
+/** Free vector with alignment */
+FLECS_API
+void _ecs_vector_free(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset);
+
+#define ecs_vector_free_t(vector, size, alignment) \
+    _ecs_vector_free(vector, ECS_VECTOR_U(size, alignment))
+
 /** Clear values in vector */
 FLECS_API
 void ecs_vector_clear(
@@ -1169,14 +1220,16 @@ void ecs_bitset_swap(
  * a 64-bit key. While it is not as fast as the sparse set, it is better at
  * handling randomly distributed values.
  *
- * Payload is stored in bucket arrays. A bucket is computed from an id by
- * using the (bucket_count - 1) as an AND-mask. The number of buckets is always
- * a power of 2. Multiple keys will be stored in the same bucket. As a result
- * the worst case retrieval performance of the map is O(n), though this is rare.
- * On average lookup performance should equal O(1).
+ * The map uses open addressing. Keys and payload are stored together in a
+ * single array of buckets, the number of which is always a power of 2. A key
+ * is stored in the first free bucket after the one computed from its value.
+ * Robin Hood hashing keeps the distance between a key and its computed bucket
+ * short, so lookups only touch a few adjacent buckets. On average lookup
+ * performance should equal O(1).
  *
  * The datastructure will automatically grow the number of buckets when the
  * ratio between elements and buckets exceeds a certain threshold (LOAD_FACTOR).
+ * Pointers to payload are invalidated when elements are added or removed.
  *
  * Note that while the implementation is a hashmap, it can only compute hashes
  * for the provided 64 bit keys. This means that the provided keys must always
@@ -1196,15 +1249,11 @@ extern "C" {
 #endif
 
 typedef struct ecs_map_t ecs_map_t;
-typedef struct ecs_bucket_t ecs_bucket_t;
 typedef uint64_t ecs_map_key_t;
 
 typedef struct ecs_map_iter_t {
     const ecs_map_t *map;
-    ecs_bucket_t *bucket;
-    int32_t bucket_index;
-    int32_t element_index;
-    void *payload;
+    int32_t index;
 } ecs_map_iter_t;
 
 /** Create new map. */
@@ -1810,6 +1859,17 @@ typedef
 int (*ecs_os_api_ainc_t)(
     int32_t *value);
 
+/* Atomic load / store. Implementations must provide sequentially consistent
+ * ordering. */
+typedef
+int32_t (*ecs_os_api_aload_t)(
+    const int32_t *value);
+
+typedef
+void (*ecs_os_api_astore_t)(
+    int32_t *value,
+    int32_t desired);
+
 
 /* Mutex */
 typedef
@@ -1951,6 +2011,10 @@ typedef struct ecs_os_api_t {
     /* Overridable function that translates from a logical module id to a
      * path that contains module-specif resources or assets */
     ecs_os_api_module_to_path_t module_to_etc_;    
+
+    /* Atomic load / store */
+    ecs_os_api_aload_t aload_;
+    ecs_os_api_astore_t astore_;
 } ecs_os_api_t;
 
 FLECS_API
@@ -2023,6 +2087,10 @@ void ecs_os_set_api_defaults(void);
 #define ecs_os_ainc(value) ecs_os_api.ainc_(value)
 #define ecs_os_adec(value) ecs_os_api.adec_(value)
 
+/* Atomic load / store */
+#define ecs_os_aload(value) ecs_os_api.aload_(value)
+#define ecs_os_astore(value, desired) ecs_os_api.astore_(value, desired)
+
 /* Mutex */
 #define ecs_os_mutex_new() ecs_os_api.mutex_new_()
 #define ecs_os_mutex_free(mutex) ecs_os_api.mutex_free_(mutex)
@@ -2168,6 +2236,31 @@ typedef struct ecs_filter_t {
     ecs_match_kind_t exclude_kind;  /**< Match kind for exclude components */
 } ecs_filter_t;
 
+/** Describes the type of the key used by ecs_query_order_by_key. */
+typedef enum ecs_sort_key_kind_t {
+    EcsSortKeyI32,          /**< Key is an int32_t */
+    EcsSortKeyU32,          /**< Key is an uint32_t */
+    EcsSortKeyI64,          /**< Key is an int64_t */
+    EcsSortKeyU64,          /**< Key is an uint64_t */
+    EcsSortKeyF32,          /**< Key is a float */
+    EcsSortKeyF64           /**< Key is a double */
+} ecs_sort_key_kind_t;
+
+/** Memory pools of a world. Each pool has its own allocator and counters. */
+typedef enum ecs_pool_kind_t {
+    EcsPoolColumns,         /**< Component columns, entities and records of tables */
+    EcsPoolTypes,           /**< Types of tables */
+    EcsPoolCount
+} ecs_pool_kind_t;
+
+/** Usage counters of a memory pool. */
+typedef struct ecs_pool_stats_t {
+    int64_t malloc_count;       /**< Number of allocations */
+    int64_t realloc_count;      /**< Number of reallocations */
+    int64_t free_count;         /**< Number of freed allocations */
+    int64_t bytes_allocated;    /**< Total bytes requested by (re)allocations */
+} ecs_pool_stats_t;
+
 /** Type that contains information about the world. */
 typedef struct ecs_world_info_t {
     ecs_entity_t last_component_id;   /**< Last issued component entity id */
@@ -2182,6 +2275,7 @@ typedef struct ecs_world_info_t {
     FLECS_FLOAT frame_time_total;    /**< Total time spent processing a frame */
     FLECS_FLOAT system_time_total;   /**< Total time spent in systems */
     FLECS_FLOAT merge_time_total;    /**< Total time spent in merges */
+    FLECS_FLOAT sync_wait_time_total; /**< Total time threads spent waiting on sync points */
     FLECS_FLOAT world_time_total;    /**< Time elapsed in simulation */
     FLECS_FLOAT world_time_total_raw; /**< Time elapsed in simulation (no scaling) */
     FLECS_FLOAT sleep_err;           /**< Measured sleep error */
@@ -2228,6 +2322,28 @@ typedef void (*ecs_fini_action_t)(
     ecs_world_t *world,
     void *ctx);
 
+/** Allocation callbacks of a memory pool */
+typedef void* (*ecs_pool_malloc_action_t)(
+    void *ctx,
+    ecs_size_t size);
+
+typedef void* (*ecs_pool_realloc_action_t)(
+    void *ctx,
+    void *ptr,
+    ecs_size_t size);
+
+typedef void (*ecs_pool_free_action_t)(
+    void *ctx,
+    void *ptr);
+
+/** Allocator for a memory pool of a world. */
+typedef struct ecs_allocator_t {
+    ecs_pool_malloc_action_t malloc_;
+    ecs_pool_realloc_action_t realloc_;
+    ecs_pool_free_action_t free_;
+    void *ctx;                  /**< Passed to the callbacks */
+} ecs_allocator_t;
+
 /**
  * @file api_types.h
  * @brief Supporting types for the public API.
@@ -2325,7 +2441,9 @@ typedef struct ecs_scope_iter_t {
 typedef struct ecs_filter_iter_t {
     ecs_filter_t filter;
     ecs_sparse_t *tables;
+    ecs_entity_t component;     /* Component used to select tables, or 0 */
     int32_t index;
+    int32_t base_index;
     ecs_iter_table_t table;
 } ecs_filter_iter_t;
 
@@ -2344,6 +2462,7 @@ typedef struct ecs_query_iter_t {
     int32_t sparse_smallest;
     int32_t sparse_first;
     int32_t bitset_first;
+    bool sparse_scan;
 } ecs_query_iter_t;  
 
 /** Query-iterator specific data */
@@ -2484,10 +2603,8 @@ extern "C" {
 #endif
 
 /** This reserves entity ids for components. Regular entity ids will start after
- * this constant. This affects performance of table traversal, as edges with ids 
- * lower than this constant are looked up in an array, whereas constants higher
- * than this id are looked up in a map. Increasing this value can improve
- * performance at the cost of (significantly) higher memory usage. */
+ * this constant. Components with higher ids are supported, and use the same
+ * code paths as components with ids in the reserved range. */
 #define ECS_HI_COMPONENT_ID (256) /* Maximum number of components */
 
 
@@ -2583,6 +2700,14 @@ bool ecs_component_has_actions(
     ecs_world_t *world,
     ecs_entity_t component);
 
+/** Compute 64 bit hash of data. Used to find tables by type and entities by 
+ * name. */
+FLECS_API
+void ecs_hash(
+    const void *data,
+    ecs_size_t length,
+    uint64_t *result);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Signature API
 ////////////////////////////////////////////////////////////////////////////////
@@ -3041,6 +3166,12 @@ typedef struct EcsComponentLifecycle {
     ecs_copy_t copy;        /**< Component copy */
     ecs_move_t move;        /**< Component move */
     void *ctx;              /**< User defined context */
+
+    /** Values can be moved to a new address with memcpy, after which the old
+     * value is discarded without invoking the destructor. When set, tables
+     * don't invoke ctor and move when they relocate values, which happens
+     * when a column grows, and when an entity moves between tables. */
+    bool relocatable;
 } EcsComponentLifecycle;
 
 /** Component used for registering component triggers */
@@ -3487,6 +3618,37 @@ void ecs_set_component_actions_w_entity(
     ecs_set_component_actions_w_entity(world, ecs_typeid(component), &(EcsComponentLifecycle)__VA_ARGS__)
 
 #endif
+
+/** Register the cold part of a component.
+ * Components are stored whole, which means that systems that only use a few
+ * fields of a large component still load the entire component into the cache.
+ * To prevent this, the fields that are rarely accessed can be moved to a 
+ * separate (cold) component. This operation binds the cold component to the 
+ * (hot) component, so that tables store the fields of both in separate arrays
+ * while entities always have both or neither.
+ *
+ * When the component is added to an entity, the cold part is added with it,
+ * and when the component is removed, the cold part is removed with it. The 
+ * cold part cannot be removed while the entity has the component. Systems that
+ * only access the hot fields use ecs_column with the component, and add the 
+ * cold part to their signature to access the other fields.
+ *
+ * This operation must be called before entities with the component are 
+ * created. A component can have a single cold part, and a cold part cannot
+ * itself have a cold part.
+ *
+ * @param world The world.
+ * @param component The component that stores the frequently accessed fields.
+ * @param cold The component that stores the rarely accessed fields.
+ */
+FLECS_API
+void ecs_set_component_cold_w_entity(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    ecs_entity_t cold);
+
+#define ecs_set_component_cold(world, component, cold)\
+    ecs_set_component_cold_w_entity(world, ecs_typeid(component), ecs_typeid(cold))
 /** Set a world context.
  * This operation allows an application to register custom data with a world
  * that can be accessed anywhere where the application has the world object.
@@ -3716,7 +3878,143 @@ FLECS_API void ecs_measure_system_time(
 FLECS_API
 void ecs_set_target_fps(
     ecs_world_t *world,
-    FLECS_FLOAT fps);     
+    FLECS_FLOAT fps);
+
+/** Enable garbage collection of empty tables.
+ * Applications that create many short-lived combinations of components end up
+ * with many empty tables, which hold on to column memory and slow down query
+ * matching. When table garbage collection is enabled, tables that stay empty
+ * for the specified number of frames are cleaned up at the end of a frame.
+ *
+ * After reclaim_after frames the memory of the table columns is released. The
+ * table itself remains, and allocates again when an entity is added to it.
+ *
+ * After delete_after frames the table is deleted. It is removed from queries
+ * and from the table graph. If the table is needed again, it is recreated.
+ *
+ * Tables are not collected while a snapshot is alive. Garbage collection is
+ * disabled by default. A value of 0 disables the corresponding step.
+ *
+ * @param world The world.
+ * @param reclaim_after Number of empty frames after which memory is released.
+ * @param delete_after Number of empty frames after which the table is deleted.
+ */
+FLECS_API
+void ecs_set_table_gc(
+    ecs_world_t *world,
+    int32_t reclaim_after,
+    int32_t delete_after);
+
+/** Run table garbage collection.
+ * This operation is invoked by ecs_frame_end, and only needs to be called by
+ * applications that do not use ecs_progress or ecs_frame_end. Only tables that
+ * have been empty for the number of frames specified by ecs_set_table_gc are
+ * collected.
+ *
+ * This operation may not be called while iterating.
+ *
+ * @param world The world.
+ * @return The number of deleted tables.
+ */
+FLECS_API
+int32_t ecs_run_table_gc(
+    ecs_world_t *world);
+
+/** Set minimum alignment of table columns.
+ * This operation sets the minimum alignment of the buffers that store component
+ * values in tables. Components with a larger natural alignment keep their own
+ * alignment. Aligning columns to the size of a cache line (64 bytes) prevents a
+ * column from sharing a cache line with other memory, and lets systems use
+ * aligned vector loads on the first entity of a table.
+ *
+ * When the alignment is set, the entities of a table are divided over worker
+ * threads in slices that start on an aligned row, so that threads do not write
+ * to the same cache line.
+ *
+ * Existing tables are reallocated with the new alignment, which invalidates
+ * pointers to component values. Column vectors that are obtained through the
+ * direct access API must be freed with ecs_vector_free_t. The default value
+ * is 0, which uses the alignment of the component.
+ *
+ * This operation may not be called while iterating, or while a snapshot is
+ * alive.
+ *
+ * @param world The world.
+ * @param alignment The alignment (a power of two, at most 4096) or 0.
+ */
+FLECS_API
+void ecs_set_column_alignment(
+    ecs_world_t *world,
+    int32_t alignment);
+
+/** Store tables in chunks of a fixed size.
+ * When a table runs out of space its columns are reallocated, which moves all
+ * component values of the table to a new buffer. For large tables this makes
+ * adding a single entity take time proportional to the size of the table.
+ *
+ * When a chunk size is set, a table does not grow beyond the chunk size.
+ * Entities that do not fit are stored in another table with the same type (a
+ * chunk), of which the columns are allocated once with room for the specified
+ * number of entities. Component values in a chunk do not move when entities
+ * are added, and a pointer to a component stays valid until its entity is
+ * removed from the chunk.
+ *
+ * Queries match each chunk as a separate table, so iterators return the
+ * entities of a type as multiple arrays. Operations that look up a table by
+ * type, like ecs_table_from_type, return the first chunk. Existing tables are
+ * not affected. The default value is 0, which disables chunks.
+ *
+ * Chunks have the following limitations:
+ * - ecs_dim_type only preallocates the first chunk. If it is dimensioned with
+ *   more than the chunk size, the first chunk holds that many entities.
+ * - The reader serializes each chunk as a separate table, but the writer 
+ *   restores each table into the first chunk of its type, replacing its 
+ *   contents. A blob with more than one chunk per type can't be restored.
+ *
+ * @param world The world.
+ * @param chunk_size The maximum number of entities in a chunk, or 0.
+ */
+FLECS_API
+void ecs_set_table_chunk_size(
+    ecs_world_t *world,
+    int32_t chunk_size);
+
+/** Set allocator for a memory pool of a world.
+ * This operation sets the allocator that is used for new allocations in the
+ * specified pool. Pools make it possible to give each world its own heap, and
+ * to keep long-lived table storage apart from other allocations. By default
+ * all pools use the OS API.
+ *
+ * Memory that was allocated before the allocator changed is released with the
+ * allocator that created it, which must remain valid until the world is
+ * deleted. Passing NULL restores the default allocator.
+ *
+ * Pools are not thread safe. They are only used by operations that modify
+ * tables, which happen on the main thread.
+ *
+ * @param world The world.
+ * @param pool The pool.
+ * @param allocator The allocator, or NULL for the OS API.
+ */
+FLECS_API
+void ecs_set_allocator(
+    ecs_world_t *world,
+    ecs_pool_kind_t pool,
+    const ecs_allocator_t *allocator);
+
+/** Get usage counters of a memory pool.
+ * The counters include memory that was allocated with allocators that were
+ * previously set for the pool.
+ *
+ * @param world The world.
+ * @param pool The pool.
+ * @param stats Out parameter for the counters.
+ */
+FLECS_API
+void ecs_get_pool_stats(
+    ecs_world_t *world,
+    ecs_pool_kind_t pool,
+    ecs_pool_stats_t *stats);
 
 /** Get current number of threads. */
 FLECS_API
@@ -5281,6 +5579,74 @@ void ecs_query_order_by(
     ecs_entity_t component,
     ecs_compare_action_t compare);
 
+/** Sort the output of a query without moving entities.
+ * Same as ecs_query_order_by, but instead of changing the order of entities in
+ * the matched tables, the query stores the sorted order of the rows for each 
+ * table. This avoids moving the components of entities while sorting, which 
+ * can be expensive for tables with many (large) components.
+ *
+ * Rows that are sorted consecutively and are stored next to each other in a
+ * table are returned in a single iteration. If the sorted order differs much
+ * from the order in which entities are stored, iterations will return small
+ * numbers of entities.
+ *
+ * When only the sorted component changed, the previous order of the rows is 
+ * used as starting point, which makes resorting cheap if few values changed.
+ *
+ * @param world The world.
+ * @param query The query.
+ * @param component The component used to sort.
+ * @param compare The compare function used to sort the components.
+ */
+FLECS_API
+void ecs_query_order_by_rows(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t component,
+    ecs_compare_action_t compare);
+
+/** Sort the output of a query by a numeric key.
+ * Same as ecs_query_order_by, but instead of a compare function the query 
+ * sorts on a number stored in the component. The number is located at the 
+ * specified offset in the component, and is of the specified kind. Entities 
+ * are sorted in ascending order of the key.
+ *
+ * Because the query knows the type of the key, it can use a radix sort which
+ * does not call a compare function, and is significantly faster than 
+ * ecs_query_order_by for large numbers of entities.
+ *
+ * @param world The world.
+ * @param query The query.
+ * @param component The component used to sort.
+ * @param kind The type of the key.
+ * @param offset The offset of the key in the component.
+ */
+FLECS_API
+void ecs_query_order_by_key(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset);
+
+/** Sort the output of a query by a numeric key without moving entities.
+ * Same as ecs_query_order_by_key, but does not change the order of entities in
+ * the matched tables. See ecs_query_order_by_rows.
+ *
+ * @param world The world.
+ * @param query The query.
+ * @param component The component used to sort.
+ * @param kind The type of the key.
+ * @param offset The offset of the key in the component.
+ */
+FLECS_API
+void ecs_query_order_by_key_rows(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset);
+
 /** Group and sort matched tables.
  * Similar yo ecs_query_order_by, but instead of sorting individual entities, this
  * operation only sorts matched tables. This can be useful of a query needs to
@@ -6412,6 +6778,66 @@ void ecs_set_threads(
     ecs_world_t *world,
     int32_t threads);
 
+/** Set maximum number of entities per job.
+ * When systems are ran on multiple threads, their matched entities are divided
+ * up in jobs. Each worker starts with its own set of jobs, and steals jobs from
+ * other workers once it runs out. Entities from small tables are combined into
+ * a single job, while large tables are split up across multiple jobs.
+ *
+ * When the size is 0 (default), it is derived from the number of entities
+ * matched with a system and the number of threads.
+ *
+ * @param world The world.
+ * @param size The maximum number of entities per job.
+ */
+FLECS_API
+void ecs_set_job_chunk_size(
+    ecs_world_t *world,
+    int32_t size);
+
+/** Enable or disable parallel merging.
+ * When systems are ran on multiple threads, the operations that were deferred
+ * by each thread are merged by the main thread at each sync point. When
+ * parallel merging is enabled, the main thread applies the structural changes
+ * (new, add, remove, delete) of all threads first, after which all threads
+ * copy the component values of deferred set operations to storage. OnSet 
+ * systems are ran after the values are copied, in the order in which the
+ * values were set.
+ *
+ * Because values are copied after the structural changes, OnAdd systems that
+ * run during the merge may not yet see values that were set in the same frame.
+ * Operations that read or remove component values, like remove, delete, clear
+ * and clone, are applied after pending values are copied.
+ *
+ * Parallel merging is disabled by default.
+ *
+ * @param world The world.
+ * @param enabled Whether to enable parallel merging.
+ */
+FLECS_API
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enabled);
+
+/** Set number of polls before a thread blocks on a sync point.
+ * When systems are ran on multiple threads, threads synchronize at each merge
+ * point in the pipeline. A thread that arrives at a sync point polls for the
+ * other threads before it blocks on a condition variable. Spinning avoids
+ * the cost of waking up a blocked thread when systems are short, at the cost
+ * of burning CPU cycles while waiting.
+ *
+ * A spin count of 0 makes threads block immediately. The time spent waiting on
+ * sync points is stored in sync_wait_time_total of ecs_world_info_t when frame
+ * time is measured.
+ *
+ * @param world The world.
+ * @param spin_count The number of polls before blocking.
+ */
+FLECS_API
+void ecs_set_sync_spin_count(
+    ecs_world_t *world,
+    int32_t spin_count);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Module
 ////////////////////////////////////////////////////////////////////////////////
@@ -7347,6 +7773,24 @@ ecs_vector_t* ecs_table_get_column(
     ecs_table_t *table,
     int32_t column);
 
+/** Get alignment of table column.
+ * This operation returns the alignment of the elements in a column, which is
+ * the alignment of the component, or the column alignment of the world if that
+ * is larger (see ecs_set_column_alignment). Vectors that are assigned to the
+ * column with ecs_table_set_column must be created with this alignment, for
+ * example with ecs_vector_new_t.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param column The column index.
+ * @return The alignment of the column elements.
+ */
+FLECS_API
+size_t ecs_table_column_alignment(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column);
+
 /** Set table column.
  * This operation enables an application to set a component column for a table.
  * After the operation the column is owned by the table. Any operations that
@@ -7363,8 +7807,9 @@ ecs_vector_t* ecs_table_get_column(
  * properly (using ecs_table_delete_column).
  *
  * The provided vector must have the same element size and alignment as the
- * target column. If the size and/or alignment do not match, the behavior will
- * be undefined. In debug mode the operation may assert.
+ * target column. The alignment of a column can be obtained with 
+ * ecs_table_column_alignment. If the size and/or alignment do not match, the 
+ * behavior will be undefined. In debug mode the operation asserts.
  *
  * If the provided vector is NULL, the table will ensure that a vector is
  * created for the provided column. If a vector exists that is not of the
@@ -7668,6 +8113,8 @@ typedef struct ecs_world_stats_t {
     ecs_gauge_t singleton_table_count;        /**< Number of singleton tables. Singleton tables are tables with just a single entity that contains itself */
     ecs_gauge_t matched_entity_count;         /**< Number of entities matched by queries */
     ecs_gauge_t matched_table_count;          /**< Number of tables matched by queries */
+    ecs_gauge_t table_edge_count;             /**< Number of edges between tables in the table graph */
+    ecs_gauge_t table_edge_memory;            /**< Memory allocated for table edges, in bytes */
 
     /* Deferred operations */
     ecs_counter_t new_count;
@@ -7685,6 +8132,7 @@ typedef struct ecs_world_stats_t {
     ecs_counter_t frame_time_total;           /**< Time spent processing a frame. Smaller than world_time_total when load is not 100% */
     ecs_counter_t system_time_total;          /**< Time spent on processing systems. */
     ecs_counter_t merge_time_total;           /**< Time spent on merging deferred actions. */
+    ecs_counter_t sync_wait_time_total;       /**< Time spent by threads waiting on sync points. */
     ecs_gauge_t fps;                          /**< Frames per second. */
     ecs_gauge_t delta_time;                   /**< Delta_time. */
     
@@ -7830,6 +8278,7 @@ FLECS_API void ecs_gauge_reduce(
 #include <sstream>
 #include <array>
 #include <functional>
+#include <type_traits>
 
 // Macros so that C++ new calls can allocate using ecs_os_api memory allocation functions
 // Rationale:
@@ -7901,6 +8350,17 @@ enum match_kind {
     MatchExact = EcsMatchExact
 };
 
+/** Trait that tells flecs whether values of a type can be moved to a new 
+ * address with memcpy. When true, tables don't invoke the move constructor 
+ * when they grow or when an entity moves between tables. Specialize this for
+ * types that are not trivially copyable but can be safely relocated, like
+ * types that only own a pointer to heap memory:
+ *
+ *   template <> struct flecs::is_relocatable<MyType> : std::true_type { };
+ */
+template <typename T>
+struct is_relocatable : std::is_trivially_copyable<T> { };
+
 namespace _
 {
 template <typename T>
@@ -11186,10 +11646,14 @@ void register_lifecycle_actions(
     bool ctor,
     bool dtor,
     bool copy,
-    bool move)
+    bool move,
+    bool relocatable = is_relocatable<
+        typename std::remove_const<
+            typename std::remove_pointer<T>::type>::type>::value)
 {
     if (!ecs_component_has_actions(world, component)) {
         EcsComponentLifecycle cl{};
+        cl.relocatable = relocatable;
         if (ctor) {
             cl.ctor = _::component_ctor<
                 typename std::remove_const<
@@ -11637,7 +12101,7 @@ flecs::entity relocatable_component(const flecs::world& world, const char *name
     flecs::entity result = pod_component<T>(world, name);
 
     _::register_lifecycle_actions<T>(world.c_ptr(), result.id(),
-        true, true, true, false);
+        true, true, true, false, true);
 
     return result;
 }
@@ -12035,6 +12499,59 @@ public:
         ecs_query_order_by(m_world, m_query, component.id(), compare);
     }    
 
+    /** Sort the output of a query without moving entities.
+     * Same as order_by<T>, but instead of changing the order of entities in
+     * the matched tables, the query stores the sorted order of the rows.
+     *
+     * @tparam T The component used to sort.
+     * @param compare The compare function used to sort the components.
+     */
+    template <typename T>
+    void order_by_rows(int(*compare)(flecs::entity_t, const T*, flecs::entity_t, const T*)) {
+        ecs_query_order_by_rows(m_world, m_query, 
+            flecs::_::component_info<T>::id(m_world),
+            (ecs_compare_action_t)compare);
+    }
+
+    /** Sort the output of a query without moving entities.
+     * Same as order_by_rows<T>, but with component identifier.
+     *
+     * @param component The component used to sort.
+     * @param compare The compare function used to sort the components.
+     */
+    void order_by_rows(flecs::entity component, int(*compare)(flecs::entity_t, const void*, flecs::entity_t, const void*)) {
+        ecs_query_order_by_rows(m_world, m_query, component.id(), compare);
+    }
+
+    /** Sort the output of a query by a numeric key.
+     * Same as order_by<T>, but sorts on a number stored in the component.
+     *
+     * @tparam T The component used to sort.
+     * @param kind The type of the key.
+     * @param offset The offset of the key in the component.
+     */
+    template <typename T>
+    void order_by_key(ecs_sort_key_kind_t kind, size_t offset) {
+        ecs_query_order_by_key(m_world, m_query, 
+            flecs::_::component_info<T>::id(m_world), kind, 
+            static_cast<ecs_size_t>(offset));
+    }
+
+    /** Sort the output of a query by a numeric key without moving entities.
+     * Same as order_by_key<T>, but does not change the order of entities in 
+     * the matched tables.
+     *
+     * @tparam T The component used to sort.
+     * @param kind The type of the key.
+     * @param offset The offset of the key in the component.
+     */
+    template <typename T>
+    void order_by_key_rows(ecs_sort_key_kind_t kind, size_t offset) {
+        ecs_query_order_by_key_rows(m_world, m_query, 
+            flecs::_::component_info<T>::id(m_world), kind, 
+            static_cast<ecs_size_t>(offset));
+    }
+
     /** Group and sort matched tables.
      * Similar yo ecs_query_order_by, but instead of sorting individual entities, this
      * operation only sorts matched tables. This can be useful of a query needs to
@@ -12439,6 +12956,29 @@ public:
         return *this;
     }
 
+    /** Same as query::order_by_rows */
+    template <typename T>
+    system& order_by_rows(int(*compare)(flecs::entity_t, const T*, flecs::entity_t, const T*)) {
+        ecs_compare_action_t cmp = reinterpret_cast<ecs_compare_action_t>(compare);
+        return this->order_by_rows(
+            flecs::entity(m_world, _::component_info<T>::id(m_world)), cmp);
+    }
+
+    /** Same as query::order_by_rows */
+    system& order_by_rows(flecs::entity component, int(*compare)(flecs::entity_t, const void*, flecs::entity_t, const void*)) {
+        if (!m_finalized) {
+            m_order_by = reinterpret_cast<ecs_compare_action_t>(compare);
+            m_order_by_component = component;
+            m_order_by_rows = true;
+        } else {
+            const EcsQuery *q = ecs_get(m_world, m_id, EcsQuery);
+            ecs_assert(q != NULL, ECS_INVALID_OPERATION, NULL);
+            ecs_query_order_by_rows(m_world, q->query, 
+                component.id(), reinterpret_cast<ecs_compare_action_t>(compare));
+        }
+        return *this;
+    }
+
     /** Same as query::group_by */
     template <typename T>
     system& group_by(int(*rank)(flecs::world_t*, flecs::entity_t, flecs::type_t type)) {
@@ -12603,7 +13143,11 @@ private:
         }
 
         if (m_order_by) {
-            this->order_by(m_order_by_component, m_order_by);
+            if (m_order_by_rows) {
+                this->order_by_rows(m_order_by_component, m_order_by);
+            } else {
+                this->order_by(m_order_by_component, m_order_by);
+            }
         }
 
         if (m_group_by) {
@@ -12654,6 +13198,7 @@ private:
 
     ecs_compare_action_t m_order_by = nullptr;
     flecs::entity m_order_by_component;
+    bool m_order_by_rows = false;
 
     ecs_rank_type_action_t m_group_by = nullptr;
     flecs::entity m_group_by_component;
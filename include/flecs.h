@@ -99,6 +99,31 @@ typedef struct ecs_filter_t {
     ecs_match_kind_t exclude_kind;  /**< Match kind for exclude components */
 } ecs_filter_t;
 
+/** Describes the type of the key used by ecs_query_order_by_key. */
+typedef enum ecs_sort_key_kind_t {
+    EcsSortKeyI32,          /**< Key is an int32_t */
+    EcsSortKeyU32,          /**< Key is an uint32_t */
+    EcsSortKeyI64,          /**< Key is an int64_t */
+    EcsSortKeyU64,          /**< Key is an uint64_t */
+    EcsSortKeyF32,          /**< Key is a float */
+    EcsSortKeyF64           /**< Key is a double */
+} ecs_sort_key_kind_t;
+
+/** Memory pools of a world. Each pool has its own allocator and counters. */
+typedef enum ecs_pool_kind_t {
+    EcsPoolColumns,         /**< Component columns, entities and records of tables */
+    EcsPoolTypes,           /**< Types of tables */
+    EcsPoolCount
+} ecs_pool_kind_t;
+
+/** Usage counters of a memory pool. */
+typedef struct ecs_pool_stats_t {
+    int64_t malloc_count;       /**< Number of allocations */
+    int64_t realloc_count;      /**< Number of reallocations */
+    int64_t free_count;         /**< Number of freed allocations */
+    int64_t bytes_allocated;    /**< Total bytes requested by (re)allocations */
+} ecs_pool_stats_t;
+
 /** Type that contains information about the world. */
 typedef struct ecs_world_info_t {
     ecs_entity_t last_component_id;   /**< Last issued component entity id */
@@ -113,6 +138,7 @@ typedef struct ecs_world_info_t {
     FLECS_FLOAT frame_time_total;    /**< Total time spent processing a frame */
     FLECS_FLOAT system_time_total;   /**< Total time spent in systems */
     FLECS_FLOAT merge_time_total;    /**< Total time spent in merges */
+    FLECS_FLOAT sync_wait_time_total; /**< Total time threads spent waiting on sync points */
     FLECS_FLOAT world_time_total;    /**< Time elapsed in simulation */
     FLECS_FLOAT world_time_total_raw; /**< Time elapsed in simulation (no scaling) */
     FLECS_FLOAT sleep_err;           /**< Measured sleep error */
@@ -159,6 +185,28 @@ typedef void (*ecs_fini_action_t)(
     ecs_world_t *world,
     void *ctx);
 
+/** Allocation callbacks of a memory pool */
+typedef void* (*ecs_pool_malloc_action_t)(
+    void *ctx,
+    ecs_size_t size);
+
+typedef void* (*ecs_pool_realloc_action_t)(
+    void *ctx,
+    void *ptr,
+    ecs_size_t size);
+
+typedef void (*ecs_pool_free_action_t)(
+    void *ctx,
+    void *ptr);
+
+/** Allocator for a memory pool of a world. */
+typedef struct ecs_allocator_t {
+    ecs_pool_malloc_action_t malloc_;
+    ecs_pool_realloc_action_t realloc_;
+    ecs_pool_free_action_t free_;
+    void *ctx;                  /**< Passed to the callbacks */
+} ecs_allocator_t;
+
 #include "flecs/private/api_types.h"        /* Supporting API types */
 #include "flecs/private/api_support.h"      /* Supporting API functions */
 #include "flecs/private/log.h"              /* Logging API */
@@ -201,6 +249,12 @@ typedef struct EcsComponentLifecycle {
     ecs_copy_t copy;        /**< Component copy */
     ecs_move_t move;        /**< Component move */
     void *ctx;              /**< User defined context */
+
+    /** Values can be moved to a new address with memcpy, after which the old
+     * value is discarded without invoking the destructor. When set, tables
+     * don't invoke ctor and move when they relocate values, which happens
+     * when a column grows, and when an entity moves between tables. */
+    bool relocatable;
 } EcsComponentLifecycle;
 
 /** Component used for registering component triggers */
@@ -647,6 +701,37 @@ void ecs_set_component_actions_w_entity(
     ecs_set_component_actions_w_entity(world, ecs_typeid(component), &(EcsComponentLifecycle)__VA_ARGS__)
 
 #endif
+
+/** Register the cold part of a component.
+ * Components are stored whole, which means that systems that only use a few
+ * fields of a large component still load the entire component into the cache.
+ * To prevent this, the fields that are rarely accessed can be moved to a 
+ * separate (cold) component. This operation binds the cold component to the 
+ * (hot) component, so that tables store the fields of both in separate arrays
+ * while entities always have both or neither.
+ *
+ * When the component is added to an entity, the cold part is added with it,
+ * and when the component is removed, the cold part is removed with it. The 
+ * cold part cannot be removed while the entity has the component. Systems that
+ * only access the hot fields use ecs_column with the component, and add the 
+ * cold part to their signature to access the other fields.
+ *
+ * This operation must be called before entities with the component are 
+ * created. A component can have a single cold part, and a cold part cannot
+ * itself have a cold part.
+ *
+ * @param world The world.
+ * @param component The component that stores the frequently accessed fields.
+ * @param cold The component that stores the rarely accessed fields.
+ */
+FLECS_API
+void ecs_set_component_cold_w_entity(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    ecs_entity_t cold);
+
+#define ecs_set_component_cold(world, component, cold)\
+    ecs_set_component_cold_w_entity(world, ecs_typeid(component), ecs_typeid(cold))
 /** Set a world context.
  * This operation allows an application to register custom data with a world
  * that can be accessed anywhere where the application has the world object.
@@ -876,7 +961,143 @@ FLECS_API void ecs_measure_system_time(
 FLECS_API
 void ecs_set_target_fps(
     ecs_world_t *world,
-    FLECS_FLOAT fps);     
+    FLECS_FLOAT fps);
+
+/** Enable garbage collection of empty tables.
+ * Applications that create many short-lived combinations of components end up
+ * with many empty tables, which hold on to column memory and slow down query
+ * matching. When table garbage collection is enabled, tables that stay empty
+ * for the specified number of frames are cleaned up at the end of a frame.
+ *
+ * After reclaim_after frames the memory of the table columns is released. The
+ * table itself remains, and allocates again when an entity is added to it.
+ *
+ * After delete_after frames the table is deleted. It is removed from queries
+ * and from the table graph. If the table is needed again, it is recreated.
+ *
+ * Tables are not collected while a snapshot is alive. Garbage collection is
+ * disabled by default. A value of 0 disables the corresponding step.
+ *
+ * @param world The world.
+ * @param reclaim_after Number of empty frames after which memory is released.
+ * @param delete_after Number of empty frames after which the table is deleted.
+ */
+FLECS_API
+void ecs_set_table_gc(
+    ecs_world_t *world,
+    int32_t reclaim_after,
+    int32_t delete_after);
+
+/** Run table garbage collection.
+ * This operation is invoked by ecs_frame_end, and only needs to be called by
+ * applications that do not use ecs_progress or ecs_frame_end. Only tables that
+ * have been empty for the number of frames specified by ecs_set_table_gc are
+ * collected.
+ *
+ * This operation may not be called while iterating.
+ *
+ * @param world The world.
+ * @return The number of deleted tables.
+ */
+FLECS_API
+int32_t ecs_run_table_gc(
+    ecs_world_t *world);
+
+/** Set minimum alignment of table columns.
+ * This operation sets the minimum alignment of the buffers that store component
+ * values in tables. Components with a larger natural alignment keep their own
+ * alignment. Aligning columns to the size of a cache line (64 bytes) prevents a
+ * column from sharing a cache line with other memory, and lets systems use
+ * aligned vector loads on the first entity of a table.
+ *
+ * When the alignment is set, the entities of a table are divided over worker
+ * threads in slices that start on an aligned row, so that threads do not write
+ * to the same cache line.
+ *
+ * Existing tables are reallocated with the new alignment, which invalidates
+ * pointers to component values. Column vectors that are obtained through the
+ * direct access API must be freed with ecs_vector_free_t. The default value
+ * is 0, which uses the alignment of the component.
+ *
+ * This operation may not be called while iterating, or while a snapshot is
+ * alive.
+ *
+ * @param world The world.
+ * @param alignment The alignment (a power of two, at most 4096) or 0.
+ */
+FLECS_API
+void ecs_set_column_alignment(
+    ecs_world_t *world,
+    int32_t alignment);
+
+/** Store tables in chunks of a fixed size.
+ * When a table runs out of space its columns are reallocated, which moves all
+ * component values of the table to a new buffer. For large tables this makes
+ * adding a single entity take time proportional to the size of the table.
+ *
+ * When a chunk size is set, a table does not grow beyond the chunk size.
+ * Entities that do not fit are stored in another table with the same type (a
+ * chunk), of which the columns are allocated once with room for the specified
+ * number of entities. Component values in a chunk do not move when entities
+ * are added, and a pointer to a component stays valid until its entity is
+ * removed from the chunk.
+ *
+ * Queries match each chunk as a separate table, so iterators return the
+ * entities of a type as multiple arrays. Operations that look up a table by
+ * type, like ecs_table_from_type, return the first chunk. Existing tables are
+ * not affected. The default value is 0, which disables chunks.
+ *
+ * Chunks have the following limitations:
+ * - ecs_dim_type only preallocates the first chunk. If it is dimensioned with
+ *   more than the chunk size, the first chunk holds that many entities.
+ * - The reader serializes each chunk as a separate table, but the writer 
+ *   restores each table into the first chunk of its type, replacing its 
+ *   contents. A blob with more than one chunk per type can't be restored.
+ *
+ * @param world The world.
+ * @param chunk_size The maximum number of entities in a chunk, or 0.
+ */
+FLECS_API
+void ecs_set_table_chunk_size(
+    ecs_world_t *world,
+    int32_t chunk_size);
+
+/** Set allocator for a memory pool of a world.
+ * This operation sets the allocator that is used for new allocations in the
+ * specified pool. Pools make it possible to give each world its own heap, and
+ * to keep long-lived table storage apart from other allocations. By default
+ * all pools use the OS API.
+ *
+ * Memory that was allocated before the allocator changed is released with the
+ * allocator that created it, which must remain valid until the world is
+ * deleted. Passing NULL restores the default allocator.
+ *
+ * Pools are not thread safe. They are only used by operations that modify
+ * tables, which happen on the main thread.
+ *
+ * @param world The world.
+ * @param pool The pool.
+ * @param allocator The allocator, or NULL for the OS API.
+ */
+FLECS_API
+void ecs_set_allocator(
+    ecs_world_t *world,
+    ecs_pool_kind_t pool,
+    const ecs_allocator_t *allocator);
+
+/** Get usage counters of a memory pool.
+ * The counters include memory that was allocated with allocators that were
+ * previously set for the pool.
+ *
+ * @param world The world.
+ * @param pool The pool.
+ * @param stats Out parameter for the counters.
+ */
+FLECS_API
+void ecs_get_pool_stats(
+    ecs_world_t *world,
+    ecs_pool_kind_t pool,
+    ecs_pool_stats_t *stats);
 
 /** Get current number of threads. */
 FLECS_API
@@ -2441,6 +2662,74 @@ void ecs_query_order_by(
     ecs_entity_t component,
     ecs_compare_action_t compare);
 
+/** Sort the output of a query without moving entities.
+ * Same as ecs_query_order_by, but instead of changing the order of entities in
+ * the matched tables, the query stores the sorted order of the rows for each 
+ * table. This avoids moving the components of entities while sorting, which 
+ * can be expensive for tables with many (large) components.
+ *
+ * Rows that are sorted consecutively and are stored next to each other in a
+ * table are returned in a single iteration. If the sorted order differs much
+ * from the order in which entities are stored, iterations will return small
+ * numbers of entities.
+ *
+ * When only the sorted component changed, the previous order of the rows is 
+ * used as starting point, which makes resorting cheap if few values changed.
+ *
+ * @param world The world.
+ * @param query The query.
+ * @param component The component used to sort.
+ * @param compare The compare function used to sort the components.
+ */
+FLECS_API
+void ecs_query_order_by_rows(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t component,
+    ecs_compare_action_t compare);
+
+/** Sort the output of a query by a numeric key.
+ * Same as ecs_query_order_by, but instead of a compare function the query 
+ * sorts on a number stored in the component. The number is located at the 
+ * specified offset in the component, and is of the specified kind. Entities 
+ * are sorted in ascending order of the key.
+ *
+ * Because the query knows the type of the key, it can use a radix sort which
+ * does not call a compare function, and is significantly faster than 
+ * ecs_query_order_by for large numbers of entities.
+ *
+ * @param world The world.
+ * @param query The query.
+ * @param component The component used to sort.
+ * @param kind The type of the key.
+ * @param offset The offset of the key in the component.
+ */
+FLECS_API
+void ecs_query_order_by_key(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset);
+
+/** Sort the output of a query by a numeric key without moving entities.
+ * Same as ecs_query_order_by_key, but does not change the order of entities in
+ * the matched tables. See ecs_query_order_by_rows.
+ *
+ * @param world The world.
+ * @param query The query.
+ * @param component The component used to sort.
+ * @param kind The type of the key.
+ * @param offset The offset of the key in the component.
+ */
+FLECS_API
+void ecs_query_order_by_key_rows(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset);
+
 /** Group and sort matched tables.
  * Similar yo ecs_query_order_by, but instead of sorting individual entities, this
  * operation only sorts matched tables. This can be useful of a query needs to
@@ -51,6 +51,24 @@ ecs_vector_t* ecs_table_get_column(
     ecs_table_t *table,
     int32_t column);
 
+/** Get alignment of table column.
+ * This operation returns the alignment of the elements in a column, which is
+ * the alignment of the component, or the column alignment of the world if that
+ * is larger (see ecs_set_column_alignment). Vectors that are assigned to the
+ * column with ecs_table_set_column must be created with this alignment, for
+ * example with ecs_vector_new_t.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param column The column index.
+ * @return The alignment of the column elements.
+ */
+FLECS_API
+size_t ecs_table_column_alignment(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column);
+
 /** Set table column.
  * This operation enables an application to set a component column for a table.
  * After the operation the column is owned by the table. Any operations that
@@ -67,8 +85,9 @@ ecs_vector_t* ecs_table_get_column(
  * properly (using ecs_table_delete_column).
  *
  * The provided vector must have the same element size and alignment as the
- * target column. If the size and/or alignment do not match, the behavior will
- * be undefined. In debug mode the operation may assert.
+ * target column. The alignment of a column can be obtained with 
+ * ecs_table_column_alignment. If the size and/or alignment do not match, the 
+ * behavior will be undefined. In debug mode the operation asserts.
  *
  * If the provided vector is NULL, the table will ensure that a vector is
  * created for the provided column. If a vector exists that is not of the
@@ -45,6 +45,8 @@ typedef struct ecs_world_stats_t {
     ecs_gauge_t singleton_table_count;        /**< Number of singleton tables. Singleton tables are tables with just a single entity that contains itself */
     ecs_gauge_t matched_entity_count;         /**< Number of entities matched by queries */
     ecs_gauge_t matched_table_count;          /**< Number of tables matched by queries */
+    ecs_gauge_t table_edge_count;             /**< Number of edges between tables in the table graph */
+    ecs_gauge_t table_edge_memory;            /**< Memory allocated for table edges, in bytes */
 
     /* Deferred operations */
     ecs_counter_t new_count;
@@ -62,6 +64,7 @@ typedef struct ecs_world_stats_t {
     ecs_counter_t frame_time_total;           /**< Time spent processing a frame. Smaller than world_time_total when load is not 100% */
     ecs_counter_t system_time_total;          /**< Time spent on processing systems. */
     ecs_counter_t merge_time_total;           /**< Time spent on merging deferred actions. */
+    ecs_counter_t sync_wait_time_total;       /**< Time spent by threads waiting on sync points. */
     ecs_gauge_t fps;                          /**< Frames per second. */
     ecs_gauge_t delta_time;                   /**< Delta_time. */
     
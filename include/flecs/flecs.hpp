@@ -11,6 +11,7 @@
 #include <sstream>
 #include <array>
 #include <functional>
+#include <type_traits>
 
 // Macros so that C++ new calls can allocate using ecs_os_api memory allocation functions
 // Rationale:
@@ -82,6 +83,17 @@ enum match_kind {
     MatchExact = EcsMatchExact
 };
 
+/** Trait that tells flecs whether values of a type can be moved to a new 
+ * address with memcpy. When true, tables don't invoke the move constructor 
+ * when they grow or when an entity moves between tables. Specialize this for
+ * types that are not trivially copyable but can be safely relocated, like
+ * types that only own a pointer to heap memory:
+ *
+ *   template <> struct flecs::is_relocatable<MyType> : std::true_type { };
+ */
+template <typename T>
+struct is_relocatable : std::is_trivially_copyable<T> { };
+
 namespace _
 {
 template <typename T>
@@ -3367,10 +3379,14 @@ void register_lifecycle_actions(
     bool ctor,
     bool dtor,
     bool copy,
-    bool move)
+    bool move,
+    bool relocatable = is_relocatable<
+        typename std::remove_const<
+            typename std::remove_pointer<T>::type>::type>::value)
 {
     if (!ecs_component_has_actions(world, component)) {
         EcsComponentLifecycle cl{};
+        cl.relocatable = relocatable;
         if (ctor) {
             cl.ctor = _::component_ctor<
                 typename std::remove_const<
@@ -3818,7 +3834,7 @@ flecs::entity relocatable_component(const flecs::world& world, const char *name
     flecs::entity result = pod_component<T>(world, name);
 
     _::register_lifecycle_actions<T>(world.c_ptr(), result.id(),
-        true, true, true, false);
+        true, true, true, false, true);
 
     return result;
 }
@@ -4216,6 +4232,59 @@ public:
         ecs_query_order_by(m_world, m_query, component.id(), compare);
     }    
 
+    /** Sort the output of a query without moving entities.
+     * Same as order_by<T>, but instead of changing the order of entities in
+     * the matched tables, the query stores the sorted order of the rows.
+     *
+     * @tparam T The component used to sort.
+     * @param compare The compare function used to sort the components.
+     */
+    template <typename T>
+    void order_by_rows(int(*compare)(flecs::entity_t, const T*, flecs::entity_t, const T*)) {
+        ecs_query_order_by_rows(m_world, m_query, 
+            flecs::_::component_info<T>::id(m_world),
+            (ecs_compare_action_t)compare);
+    }
+
+    /** Sort the output of a query without moving entities.
+     * Same as order_by_rows<T>, but with component identifier.
+     *
+     * @param component The component used to sort.
+     * @param compare The compare function used to sort the components.
+     */
+    void order_by_rows(flecs::entity component, int(*compare)(flecs::entity_t, const void*, flecs::entity_t, const void*)) {
+        ecs_query_order_by_rows(m_world, m_query, component.id(), compare);
+    }
+
+    /** Sort the output of a query by a numeric key.
+     * Same as order_by<T>, but sorts on a number stored in the component.
+     *
+     * @tparam T The component used to sort.
+     * @param kind The type of the key.
+     * @param offset The offset of the key in the component.
+     */
+    template <typename T>
+    void order_by_key(ecs_sort_key_kind_t kind, size_t offset) {
+        ecs_query_order_by_key(m_world, m_query, 
+            flecs::_::component_info<T>::id(m_world), kind, 
+            static_cast<ecs_size_t>(offset));
+    }
+
+    /** Sort the output of a query by a numeric key without moving entities.
+     * Same as order_by_key<T>, but does not change the order of entities in 
+     * the matched tables.
+     *
+     * @tparam T The component used to sort.
+     * @param kind The type of the key.
+     * @param offset The offset of the key in the component.
+     */
+    template <typename T>
+    void order_by_key_rows(ecs_sort_key_kind_t kind, size_t offset) {
+        ecs_query_order_by_key_rows(m_world, m_query, 
+            flecs::_::component_info<T>::id(m_world), kind, 
+            static_cast<ecs_size_t>(offset));
+    }
+
     /** Group and sort matched tables.
      * Similar yo ecs_query_order_by, but instead of sorting individual entities, this
      * operation only sorts matched tables. This can be useful of a query needs to
@@ -4620,6 +4689,29 @@ public:
         return *this;
     }
 
+    /** Same as query::order_by_rows */
+    template <typename T>
+    system& order_by_rows(int(*compare)(flecs::entity_t, const T*, flecs::entity_t, const T*)) {
+        ecs_compare_action_t cmp = reinterpret_cast<ecs_compare_action_t>(compare);
+        return this->order_by_rows(
+            flecs::entity(m_world, _::component_info<T>::id(m_world)), cmp);
+    }
+
+    /** Same as query::order_by_rows */
+    system& order_by_rows(flecs::entity component, int(*compare)(flecs::entity_t, const void*, flecs::entity_t, const void*)) {
+        if (!m_finalized) {
+            m_order_by = reinterpret_cast<ecs_compare_action_t>(compare);
+            m_order_by_component = component;
+            m_order_by_rows = true;
+        } else {
+            const EcsQuery *q = ecs_get(m_world, m_id, EcsQuery);
+            ecs_assert(q != NULL, ECS_INVALID_OPERATION, NULL);
+            ecs_query_order_by_rows(m_world, q->query, 
+                component.id(), reinterpret_cast<ecs_compare_action_t>(compare));
+        }
+        return *this;
+    }
+
     /** Same as query::group_by */
     template <typename T>
     system& group_by(int(*rank)(flecs::world_t*, flecs::entity_t, flecs::type_t type)) {
@@ -4784,7 +4876,11 @@ private:
         }
 
         if (m_order_by) {
-            this->order_by(m_order_by_component, m_order_by);
+            if (m_order_by_rows) {
+                this->order_by_rows(m_order_by_component, m_order_by);
+            } else {
+                this->order_by(m_order_by_component, m_order_by);
+            }
         }
 
         if (m_group_by) {
@@ -4835,6 +4931,7 @@ private:
 
     ecs_compare_action_t m_order_by = nullptr;
     flecs::entity m_order_by_component;
+    bool m_order_by_rows = false;
 
     ecs_rank_type_action_t m_group_by = nullptr;
     flecs::entity m_group_by_component;
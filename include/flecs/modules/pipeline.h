@@ -136,6 +136,66 @@ void ecs_set_threads(
     ecs_world_t *world,
     int32_t threads);
 
+/** Set maximum number of entities per job.
+ * When systems are ran on multiple threads, their matched entities are divided
+ * up in jobs. Each worker starts with its own set of jobs, and steals jobs from
+ * other workers once it runs out. Entities from small tables are combined into
+ * a single job, while large tables are split up across multiple jobs.
+ *
+ * When the size is 0 (default), it is derived from the number of entities
+ * matched with a system and the number of threads.
+ *
+ * @param world The world.
+ * @param size The maximum number of entities per job.
+ */
+FLECS_API
+void ecs_set_job_chunk_size(
+    ecs_world_t *world,
+    int32_t size);
+
+/** Enable or disable parallel merging.
+ * When systems are ran on multiple threads, the operations that were deferred
+ * by each thread are merged by the main thread at each sync point. When
+ * parallel merging is enabled, the main thread applies the structural changes
+ * (new, add, remove, delete) of all threads first, after which all threads
+ * copy the component values of deferred set operations to storage. OnSet 
+ * systems are ran after the values are copied, in the order in which the
+ * values were set.
+ *
+ * Because values are copied after the structural changes, OnAdd systems that
+ * run during the merge may not yet see values that were set in the same frame.
+ * Operations that read or remove component values, like remove, delete, clear
+ * and clone, are applied after pending values are copied.
+ *
+ * Parallel merging is disabled by default.
+ *
+ * @param world The world.
+ * @param enabled Whether to enable parallel merging.
+ */
+FLECS_API
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enabled);
+
+/** Set number of polls before a thread blocks on a sync point.
+ * When systems are ran on multiple threads, threads synchronize at each merge
+ * point in the pipeline. A thread that arrives at a sync point polls for the
+ * other threads before it blocks on a condition variable. Spinning avoids
+ * the cost of waking up a blocked thread when systems are short, at the cost
+ * of burning CPU cycles while waiting.
+ *
+ * A spin count of 0 makes threads block immediately. The time spent waiting on
+ * sync points is stored in sync_wait_time_total of ecs_world_info_t when frame
+ * time is measured.
+ *
+ * @param world The world.
+ * @param spin_count The number of polls before blocking.
+ */
+FLECS_API
+void ecs_set_sync_spin_count(
+    ecs_world_t *world,
+    int32_t spin_count);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Module
 ////////////////////////////////////////////////////////////////////////////////
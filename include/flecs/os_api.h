@@ -107,6 +107,17 @@ typedef
 int (*ecs_os_api_ainc_t)(
     int32_t *value);
 
+/* Atomic load / store. Implementations must provide sequentially consistent
+ * ordering. */
+typedef
+int32_t (*ecs_os_api_aload_t)(
+    const int32_t *value);
+
+typedef
+void (*ecs_os_api_astore_t)(
+    int32_t *value,
+    int32_t desired);
+
 
 /* Mutex */
 typedef
@@ -248,6 +259,10 @@ typedef struct ecs_os_api_t {
     /* Overridable function that translates from a logical module id to a
      * path that contains module-specif resources or assets */
     ecs_os_api_module_to_path_t module_to_etc_;    
+
+    /* Atomic load / store */
+    ecs_os_api_aload_t aload_;
+    ecs_os_api_astore_t astore_;
 } ecs_os_api_t;
 
 FLECS_API
@@ -320,6 +335,10 @@ void ecs_os_set_api_defaults(void);
 #define ecs_os_ainc(value) ecs_os_api.ainc_(value)
 #define ecs_os_adec(value) ecs_os_api.adec_(value)
 
+/* Atomic load / store */
+#define ecs_os_aload(value) ecs_os_api.aload_(value)
+#define ecs_os_astore(value, desired) ecs_os_api.astore_(value, desired)
+
 /* Mutex */
 #define ecs_os_mutex_new() ecs_os_api.mutex_new_()
 #define ecs_os_mutex_free(mutex) ecs_os_api.mutex_free_(mutex)
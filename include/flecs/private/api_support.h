@@ -17,10 +17,8 @@ extern "C" {
 #endif
 
 /** This reserves entity ids for components. Regular entity ids will start after
- * this constant. This affects performance of table traversal, as edges with ids 
- * lower than this constant are looked up in an array, whereas constants higher
- * than this id are looked up in a map. Increasing this value can improve
- * performance at the cost of (significantly) higher memory usage. */
+ * this constant. Components with higher ids are supported, and use the same
+ * code paths as components with ids in the reserved range. */
 #define ECS_HI_COMPONENT_ID (256) /* Maximum number of components */
 
 
@@ -116,6 +114,14 @@ bool ecs_component_has_actions(
     ecs_world_t *world,
     ecs_entity_t component);
 
+/** Compute 64 bit hash of data. Used to find tables by type and entities by 
+ * name. */
+FLECS_API
+void ecs_hash(
+    const void *data,
+    ecs_size_t length,
+    uint64_t *result);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Signature API
 ////////////////////////////////////////////////////////////////////////////////
@@ -96,7 +96,9 @@ typedef struct ecs_scope_iter_t {
 typedef struct ecs_filter_iter_t {
     ecs_filter_t filter;
     ecs_sparse_t *tables;
+    ecs_entity_t component;     /* Component used to select tables, or 0 */
     int32_t index;
+    int32_t base_index;
     ecs_iter_table_t table;
 } ecs_filter_iter_t;
 
@@ -115,6 +117,7 @@ typedef struct ecs_query_iter_t {
     int32_t sparse_smallest;
     int32_t sparse_first;
     int32_t bitset_first;
+    bool sparse_scan;
 } ecs_query_iter_t;  
 
 /** Query-iterator specific data */
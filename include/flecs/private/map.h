@@ -6,14 +6,16 @@
  * a 64-bit key. While it is not as fast as the sparse set, it is better at
  * handling randomly distributed values.
  *
- * Payload is stored in bucket arrays. A bucket is computed from an id by
- * using the (bucket_count - 1) as an AND-mask. The number of buckets is always
- * a power of 2. Multiple keys will be stored in the same bucket. As a result
- * the worst case retrieval performance of the map is O(n), though this is rare.
- * On average lookup performance should equal O(1).
+ * The map uses open addressing. Keys and payload are stored together in a
+ * single array of buckets, the number of which is always a power of 2. A key
+ * is stored in the first free bucket after the one computed from its value.
+ * Robin Hood hashing keeps the distance between a key and its computed bucket
+ * short, so lookups only touch a few adjacent buckets. On average lookup
+ * performance should equal O(1).
  *
  * The datastructure will automatically grow the number of buckets when the
  * ratio between elements and buckets exceeds a certain threshold (LOAD_FACTOR).
+ * Pointers to payload are invalidated when elements are added or removed.
  *
  * Note that while the implementation is a hashmap, it can only compute hashes
  * for the provided 64 bit keys. This means that the provided keys must always
@@ -34,15 +36,11 @@ extern "C" {
 #endif
 
 typedef struct ecs_map_t ecs_map_t;
-typedef struct ecs_bucket_t ecs_bucket_t;
 typedef uint64_t ecs_map_key_t;
 
 typedef struct ecs_map_iter_t {
     const ecs_map_t *map;
-    ecs_bucket_t *bucket;
-    int32_t bucket_index;
-    int32_t element_index;
-    void *payload;
+    int32_t index;
 } ecs_map_iter_t;
 
 /** Create new map. */
@@ -36,18 +36,40 @@
 extern "C" {
 #endif
 
+/* Memory pool from which a vector is allocated */
+typedef struct ecs_pool_t ecs_pool_t;
+
 /* Public, so we can do compile-time header size calculation */
 struct ecs_vector_t {
     int32_t count;
     int32_t size;
+    ecs_pool_t *pool; /* NULL if allocated with the OS API */
     
 #ifndef NDEBUG
     int64_t elem_size;
+    int16_t offset;   /* Used to validate alignment of operations */
 #endif
 };
 
+/* Largest alignment guaranteed by ecs_os_malloc. Vectors with a larger element
+ * alignment are allocated with padding, so the elements can be aligned. */
+#define ECS_VECTOR_MALLOC_ALIGNMENT (16)
+
+/* Size of the vector header, rounded up so that the elements of vectors with
+ * an alignment up to ECS_VECTOR_MALLOC_ALIGNMENT directly follow the header */
+#define ECS_VECTOR_HEADER_SIZE\
+    ECS_ALIGN(ECS_SIZEOF(ecs_vector_t), ECS_VECTOR_MALLOC_ALIGNMENT)
+
+/* Offset of the elements from the start of the vector. Vectors with a larger
+ * alignment than malloc guarantees have an offset larger than the header, which
+ * leaves room for the padding administration. */
+#define ECS_VECTOR_OFFSET(alignment)\
+    ((alignment) > ECS_VECTOR_MALLOC_ALIGNMENT\
+        ? ECS_MAX(ECS_VECTOR_HEADER_SIZE * 2, (alignment))\
+        : ECS_VECTOR_HEADER_SIZE)
+
 /* Compute the header size of the vector from size & alignment */
-#define ECS_VECTOR_U(size, alignment) size, ECS_MAX(ECS_SIZEOF(ecs_vector_t), alignment)
+#define ECS_VECTOR_U(size, alignment) size, ECS_VECTOR_OFFSET(alignment)
 
 /* Compute the header size of the vector from a provided compile-time type */
 #define ECS_VECTOR_T(T) ECS_VECTOR_U(ECS_SIZEOF(T), ECS_ALIGNOF(T))
@@ -57,6 +79,7 @@ struct ecs_vector_t {
 #define ECS_VECTOR_VALUE(T, elem_count)\
 {\
     .elem_size = (int32_t)(ECS_SIZEOF(T)),\
+    .offset = ECS_VECTOR_HEADER_SIZE,\
     .count = elem_count,\
     .size = elem_count\
 }
@@ -73,6 +96,7 @@ struct {\
     union {\
         ecs_vector_t vector;\
         uint64_t align;\
+        char size[ECS_VECTOR_HEADER_SIZE];\
     } header;\
     T array[elem_count];\
 } __##name##_value = {\
@@ -106,6 +130,21 @@ ecs_vector_t* _ecs_vector_new(
 #define ecs_vector_new_t(size, alignment, elem_count) \
     _ecs_vector_new(ECS_VECTOR_U(size, alignment), elem_count)    
 
+/** Create new vector that is allocated from a memory pool. Operations that
+ * reallocate or free the vector use the same pool. */
+FLECS_API
+ecs_vector_t* _ecs_vector_new_w_pool(
+    ecs_pool_t *pool,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define ecs_vector_new_w_pool(pool, T, elem_count) \
+    _ecs_vector_new_w_pool(pool, ECS_VECTOR_T(T), elem_count)
+
+#define ecs_vector_new_w_pool_t(pool, size, alignment, elem_count) \
+    _ecs_vector_new_w_pool(pool, ECS_VECTOR_U(size, alignment), elem_count)
+
 /* Create new vector, initialize it with provided array */
 FLECS_API
 ecs_vector_t* _ecs_vector_from_array(
@@ -127,11 +166,23 @@ void _ecs_vector_zero(
 #define ecs_vector_zero(vector, T) \
     _ecs_vector_zero(vector, ECS_VECTOR_T(T))
 
-/** Free vector */
+/** Free vector. Vectors with an alignment larger than 
+ * ECS_VECTOR_MALLOC_ALIGNMENT must be freed with ecs_vector_free_t. In debug
+ * mode the operation asserts if such a vector is passed in. */
 FLECS_API
 void ecs_vector_free(
     ecs_vector_t *vector);
 
+/** Free vector with alignment */
+FLECS_API
+void _ecs_vector_free(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset);
+
+#define ecs_vector_free_t(vector, size, alignment) \
+    _ecs_vector_free(vector, ECS_VECTOR_U(size, alignment))
+
 /** Clear values in vector */
 FLECS_API
 void ecs_vector_clear(
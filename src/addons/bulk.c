@@ -68,8 +68,9 @@ void merge_table(
         /* Merge table into dst_table */
         if (dst_table != src_table) {
             ecs_data_t *src_data = ecs_table_get_data(src_table);
-            int32_t dst_count = ecs_table_count(dst_table);
             int32_t src_count = ecs_table_count(src_table);
+            dst_table = ecs_table_get_chunk(world, dst_table, src_count);
+            int32_t dst_count = ecs_table_count(dst_table);
 
             if (to_remove && to_remove->count && src_data) {
                 ecs_run_remove_actions(world, src_table, 
@@ -110,6 +110,15 @@ ecs_vector_t* ecs_table_get_column(
     return c ? c->data : NULL;
 }
 
+size_t ecs_table_column_alignment(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column)
+{
+    ecs_column_t *c = da_get_or_create_column(world, table, column);
+    return ecs_to_size_t(c->alignment);
+}
+
 ecs_vector_t* ecs_table_set_column(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -119,6 +128,7 @@ ecs_vector_t* ecs_table_set_column(
     ecs_column_t *c = da_get_or_create_column(world, table, column);
     if (vector) {
         ecs_vector_assert_size(vector, c->size);
+        ecs_vector_assert_alignment(vector, c->alignment);
     } else {
         ecs_vector_t *entities = ecs_table_get_entities(table);
         if (entities) {
@@ -249,7 +259,7 @@ void ecs_table_delete_column(
         c->data = NULL;
     }
 
-    ecs_vector_free(vector);
+    ecs_vector_free_t(vector, c->size, c->alignment);
 }
 
 void* ecs_record_get_column(
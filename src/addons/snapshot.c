@@ -39,11 +39,6 @@ ecs_data_t* duplicate_data(
         ecs_entity_t component = components[i];
         ecs_column_t *column = &result->columns[i];
 
-        if (component > ECS_HI_COMPONENT_ID) {
-            column->data = NULL;
-            continue;
-        }
-
         ecs_c_info_t *cdata = ecs_get_c_info(world, component);
         int16_t size = column->size;
         int16_t alignment = column->alignment;
@@ -87,6 +82,9 @@ ecs_snapshot_t* snapshot_create(
 
     result->world = world;
 
+    /* Prevent tables from being garbage collected while snapshot is alive */
+    world->snapshot_count ++;
+
     /* If no iterator is provided, the snapshot will be taken of the entire
      * world, and we can simply copy the entity index as it will be restored
      * entirely upon snapshote restore. */
@@ -281,6 +279,8 @@ void ecs_snapshot_restore(
 
     ecs_vector_free(snapshot->tables);   
 
+    world->snapshot_count --;
+
     ecs_os_free(snapshot);
 }
 
@@ -350,6 +350,9 @@ void ecs_snapshot_free(
     }    
 
     ecs_vector_free(snapshot->tables);
+
+    snapshot->world->snapshot_count --;
+
     ecs_os_free(snapshot);
 }
 
@@ -122,6 +122,7 @@ void ecs_get_world_stats(
     record_counter(&s->frame_time_total, t, world->stats.frame_time_total);
     record_counter(&s->system_time_total, t, world->stats.system_time_total);
     record_counter(&s->merge_time_total, t, world->stats.merge_time_total);
+    record_counter(&s->sync_wait_time_total, t, world->stats.sync_wait_time_total);
 
     float delta_frame_count = record_counter(&s->frame_count_total, t, world->stats.frame_count_total);
     record_counter(&s->merge_count_total, t, world->stats.merge_count_total);
@@ -153,6 +154,7 @@ void ecs_get_world_stats(
     int32_t empty_table_count = 0;
     int32_t singleton_table_count = 0;
     int32_t matched_table_count = 0, matched_entity_count = 0;
+    int32_t edge_count = 0, edge_memory = 0;
 
     int32_t i, count = ecs_sparse_count(world->store.tables);
     for (i = 0; i < count; i ++) {
@@ -181,6 +183,18 @@ void ecs_get_world_stats(
             matched_table_count ++;
             matched_entity_count += entity_count;
         }
+
+        if (table->edges) {
+            edge_count += ecs_map_count(table->edges);
+            ecs_map_memory(table->edges, &edge_memory, NULL);
+        }
+    }
+
+    /* The root table is not stored in the table sparse set */
+    ecs_table_t *root = &world->store.root;
+    if (root->edges) {
+        edge_count += ecs_map_count(root->edges);
+        ecs_map_memory(root->edges, &edge_memory, NULL);
     }
 
     record_gauge(&s->matched_table_count, t, matched_table_count);
@@ -189,6 +203,8 @@ void ecs_get_world_stats(
     record_gauge(&s->table_count, t, count);
     record_gauge(&s->empty_table_count, t, empty_table_count);
     record_gauge(&s->singleton_table_count, t, singleton_table_count);
+    record_gauge(&s->table_edge_count, t, edge_count);
+    record_gauge(&s->table_edge_memory, t, edge_memory);
 }
 
 void ecs_get_query_stats(
@@ -333,6 +349,7 @@ void ecs_dump_world_stats(
     print_counter("frame time", t, &s->frame_time_total);
     print_counter("system time", t, &s->system_time_total);
     print_counter("merge time", t, &s->merge_time_total);
+    print_counter("sync wait time", t, &s->sync_wait_time_total);
     print_counter("simulation time elapsed", t, &s->world_time_total);
     printf("\n");
     print_gauge("entity count", t, &s->entity_count);
@@ -342,6 +359,8 @@ void ecs_dump_world_stats(
     print_gauge("table count", t, &s->table_count);
     print_gauge("singleton table count", t, &s->singleton_table_count);
     print_gauge("empty table count", t, &s->empty_table_count);
+    print_gauge("table edge count", t, &s->table_edge_count);
+    print_gauge("table edge memory", t, &s->table_edge_memory);
     printf("\n");
     print_counter("deferred new operations", t, &s->new_count);
     print_counter("deferred bulk_new operations", t, &s->bulk_new_count);
@@ -93,6 +93,11 @@ void ecs_table_writer_finalize_table(
     /* Register entities in table in entity index */
     ecs_data_t *data = ecs_table_get_data(writer->table);
     ecs_vector_t *entity_vector = data->entities;
+
+    if (writer->table->flags & EcsTableHasName) {
+        world->name_index_dirty = true;
+    }
+
     ecs_entity_t *entities = ecs_vector_first(entity_vector, ecs_entity_t);
     ecs_record_t **record_ptrs = ecs_vector_first(data->record_ptrs, ecs_record_t*);
     int32_t i, count = ecs_vector_count(entity_vector);
@@ -146,10 +151,12 @@ void ecs_table_writer_prepare_column(
 
         if (size) {
             int32_t old_count = ecs_vector_count(column->data);
-            _ecs_vector_set_count(&column->data, ECS_VECTOR_U(size, 0), writer->row_count);
+            int16_t alignment = column->alignment;
+            ecs_vector_set_count_t(
+                &column->data, size, alignment, writer->row_count);
 
             /* Initialize new elements to 0 */
-            void *buffer = ecs_vector_first_t(column->data, size, 0);
+            void *buffer = ecs_vector_first_t(column->data, size, alignment);
             ecs_os_memset(ECS_OFFSET(buffer, old_count * size), 0, 
                 (writer->row_count - old_count) * size);
         }
@@ -208,6 +208,8 @@ void ecs_set_symbol(
     }
 
     name_ptr->symbol = ecs_os_strdup(name);
+
+    ecs_name_index_update(world, e);
 }
 
 ecs_entity_t ecs_lookup_w_id(
@@ -558,8 +558,10 @@ void instantiate_children(
         }
 #endif
 
-        /* Create children */
+        /* Create children. Get the chunk up front, as the rows of the new
+         * children are looked up in the table. */
         int32_t child_row; 
+        i_table = ecs_table_get_chunk(world, i_table, child_count);
         new_w_data(world, i_table, NULL, child_count, c_info, &child_row);       
 
         /* If prefab child table has children itself, recursively instantiate */
@@ -1016,8 +1018,19 @@ int32_t move_entity(
                 world, src_table, src_data, src_row, 1, removed, false);
         }
 
+        /* If a single component is added or removed, the entity moves along
+         * a single edge, which caches the column mapping between tables */
+        const ecs_move_map_t *map = NULL;
+        int32_t added_count = added ? added->count : 0;
+        int32_t removed_count = removed ? removed->count : 0;
+        if (added_count + removed_count == 1) {
+            ecs_entity_t e = added_count ? added->array[0] : removed->array[0];
+            map = ecs_table_get_move_map(
+                src_table, src_data, dst_table, dst_data, e, added_count != 0);
+        }
+
         ecs_table_move(world, entity, entity, dst_table, dst_data, dst_row, 
-            src_table, src_data, src_row);                
+            src_table, src_data, src_row, map);
     }
     
     ecs_table_delete(world, src_table, src_data, src_row, false);
@@ -1092,7 +1105,7 @@ bool update_component_monitor_w_array(
     int i;
     for (i = 0; i < entities->count; i ++) {
         ecs_entity_t component = entities->array[i];
-        if (component < ECS_HI_COMPONENT_ID) {
+        if (!(component & ECS_ROLE_MASK)) {
             ecs_component_monitor_mark(mon, component);
         } else if (ECS_HAS_ROLE(component, CHILDOF)) {
             childof_changed = true;
@@ -1152,6 +1165,12 @@ void commit(
     ecs_assert(!world->in_progress, ECS_INTERNAL_ERROR, NULL);
     
     ecs_table_t *src_table = info->table;
+
+    /* Traversing from a chunk to its own type ends up in the first chunk */
+    if (src_table && src_table->chunk_head == dst_table) {
+        dst_table = src_table;
+    }
+
     if (src_table == dst_table) {
         /* If source and destination table are the same no action is needed *
          * However, if a component was added in the process of traversing a
@@ -1166,6 +1185,8 @@ void commit(
         return;
     }  
 
+    dst_table = ecs_table_get_chunk(world, dst_table, 1);
+
     if (src_table) {
         ecs_data_t *src_data = info->data;
         ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -1199,6 +1220,13 @@ void commit(
         update_component_monitors(world, entity, added, removed);
     }
 
+    /* If entity has a name, it may have moved to another scope */
+    if ((src_table && src_table->flags & EcsTableHasName) || 
+        (dst_table->flags & EcsTableHasName)) 
+    {
+        ecs_name_index_move(world, entity, dst_table);
+    }
+
     if ((!src_table || !src_table->type) && world->range_check_enabled) {
         ecs_assert(!world->stats.max_id || entity <= world->stats.max_id, ECS_OUT_OF_RANGE, 0);
         ecs_assert(entity >= world->stats.min_id, ECS_OUT_OF_RANGE, 0);
@@ -1241,6 +1269,7 @@ void new(
     ecs_entity_info_t info = {0};
     ecs_table_t *table = ecs_table_traverse_add(
         world, world->stage.scope_table, to_add, NULL);
+    table = ecs_table_get_chunk(world, table, 1);
     new_entity(world, entity, &info, table, to_add);
 }
 
@@ -1266,6 +1295,8 @@ const ecs_entity_t* new_w_data(
         return ids;        
     }
 
+    table = ecs_table_get_chunk(world, table, count);
+
     ecs_entities_t component_array = { 0 };
     if (!component_ids) {
         component_ids = &component_array;
@@ -1332,6 +1363,10 @@ const ecs_entity_t* new_w_data(
         };
 
         ecs_run_set_systems(world, &added, table, data, row, count, true);        
+
+        if (table->flags & EcsTableHasName) {
+            world->name_index_dirty = true;
+        }
     }
 
     ecs_run_monitors(world, table, table->monitors, row, count, NULL);
@@ -1744,8 +1779,9 @@ const ecs_entity_t* ecs_bulk_new_w_data(
         return ids;
     }
     ecs_type_t type = ecs_type_find(world, components->array, components->count);
-    ecs_table_t *table = ecs_table_from_type(world, type);    
-    ids = new_w_data(world, table, NULL, count, data, NULL);
+    ecs_table_t *table = ecs_table_from_type(world, type);
+    table = ecs_table_add_cold_parts(world, table);
+    ids = new_w_data(world, table, components, count, data, NULL);
     ecs_defer_flush(world, stage);
     return ids;
 }
@@ -1762,6 +1798,7 @@ const ecs_entity_t* ecs_bulk_new_w_type(
         return ids;
     }
     ecs_table_t *table = ecs_table_from_type(world, type);
+    table = ecs_table_add_cold_parts(world, table);
     ids = new_w_data(world, table, NULL, count, NULL, NULL);
     ecs_defer_flush(world, stage);
     return ids;
@@ -1782,6 +1819,7 @@ const ecs_entity_t* ecs_bulk_new_w_entity(
         return ids;
     }
     ecs_table_t *table = ecs_table_find_or_create(world, &components);
+    table = ecs_table_add_cold_parts(world, table);
     ids = new_w_data(world, table, NULL, count, NULL, NULL);
     ecs_defer_flush(world, stage);
     return ids;
@@ -1823,6 +1861,10 @@ void ecs_delete_children(
     ecs_vector_t *child_tables = ecs_map_get_ptr(
         world->child_tables, ecs_vector_t*, parent);
 
+    /* Remove the list before deleting tables, so deleted tables don't try to
+     * unregister themselves from it while it is being iterated */
+    ecs_map_remove(world->child_tables, parent);
+
     if (child_tables) {
         ecs_table_t **tables = ecs_vector_first(child_tables, ecs_table_t*);
         int32_t i, count = ecs_vector_count(child_tables);
@@ -1844,14 +1886,21 @@ void ecs_delete_children(
             /* Clear components from table (invokes destructors, OnRemove) */
             ecs_table_clear(world, table);
 
-            /* Delete table */
-            ecs_delete_table(world, table);
+            /* Delete chunks before the table that owns their type */
+            if (table->chunk_head) {
+                ecs_delete_table(world, table);
+                tables[i] = NULL;
+            }
         };
 
+        for (i = 0; i < count; i ++) {
+            if (tables[i]) {
+                ecs_delete_table(world, tables[i]);
+            }
+        }
+
         ecs_vector_free(child_tables);
     }
-
-    ecs_map_remove(world->child_tables, parent);
 }
 
 void ecs_delete(
@@ -1883,6 +1932,10 @@ void ecs_delete(
         /* If entity has components, remove them */
         ecs_table_t *table = info.table;
         if (table) {
+            if (table->flags & EcsTableHasName) {
+                ecs_name_index_remove(world, entity);
+            }
+
             ecs_type_t type = table->type;
             ecs_entities_t to_remove = ecs_type_to_entities(type);
             delete_entity(world, table, info.data, info.row, &to_remove);
@@ -1980,17 +2033,24 @@ ecs_entity_t ecs_clone(
     ecs_type_t src_type = src_table->type;
     ecs_entities_t to_add = ecs_type_to_entities(src_type);
 
+    /* The clone may not fit in the chunk of the source entity */
+    ecs_table_t *dst_table = ecs_table_get_chunk(world, src_table, 1);
+
     ecs_entity_info_t dst_info = {0};
-    dst_info.row = new_entity(world, dst, &dst_info, src_table, &to_add);
+    dst_info.row = new_entity(world, dst, &dst_info, dst_table, &to_add);
 
     if (copy_value) {
-        ecs_table_move(world, dst, src, src_table, dst_info.data, 
-            dst_info.row, src_table, src_info.data, src_info.row);
+        ecs_table_move(world, dst, src, dst_table, dst_info.data, 
+            dst_info.row, src_table, src_info.data, src_info.row, NULL);
 
         int i;
         for (i = 0; i < to_add.count; i ++) {
             ecs_run_set_systems(world, &to_add, 
-                src_table, src_info.data, dst_info.row, 1, true);
+                dst_table, dst_info.data, dst_info.row, 1, true);
+        }
+
+        if (dst_table->flags & EcsTableHasName) {
+            ecs_name_index_move(world, dst, dst_table);
         }
     }
 
@@ -2094,6 +2154,10 @@ void* ecs_get_mut_w_entity(
 
     ecs_entity_info_t info;
     result = get_mutable(world, entity, component, &info, is_added);
+
+    if (component == ecs_typeid(EcsName)) {
+        ecs_name_index_defer(world, entity);
+    }
     
     /* Store table so we can quickly check if returned pointer is still valid */
     ecs_table_t *table = info.record->table;
@@ -2145,8 +2209,16 @@ void ecs_modified_w_entity(
     ecs_assert(ecs_has_entity(world, entity, component), 
         ECS_INVALID_PARAMETER, NULL);
 
+    if (component == ecs_typeid(EcsName)) {
+        ecs_name_index_update(world, entity);
+    }
+
     ecs_entity_info_t info = {0};
     if (ecs_get_info(world, entity, &info)) {
+        if (ecs_type_index_of(info.table->type, component) != -1) {
+            ecs_table_mark_dirty(info.table, component);
+        }
+
         ecs_entities_t added = {
             .array = &component,
             .count = 1
@@ -2226,6 +2298,10 @@ ecs_entity_t assign_ptr_w_entity(
 
     ecs_table_mark_dirty(info.table, component);
 
+    if (component == ecs_typeid(EcsName)) {
+        ecs_name_index_update(world, entity);
+    }
+
     if (notify) {
         ecs_run_set_systems(world, &added, 
             info.table, info.data, info.row, 1, false);
@@ -2701,59 +2777,995 @@ void flush_bulk_new(
                 assign_ptr_w_entity(world, ids[i], component, size, ptr, 
                     true, true);
             }
-            ecs_os_free(data);
         }
-        ecs_os_free(bulk_data);
     } else {
         int i, count = op->is._n.count;
         for (i = 0; i < count; i ++) {
             add_entities(world, ids[i], &op->components);
         }
     }
+}
 
-    if (op->components.count > 1) {
-        ecs_os_free(op->components.array);
+static
+bool valid_components(
+    ecs_world_t * world,
+    ecs_entities_t * entities)
+{
+    ecs_entity_t *array = entities->array;
+    int32_t i, count = entities->count;
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = array[i];
+        if (ECS_HAS_ROLE(e, CHILDOF)) {
+            e &= ECS_COMPONENT_MASK;
+            if (ecs_exists(world, e) && !ecs_is_alive(world, e)) {
+                return false;
+            }
+        }
     }
+    return true;
+}
 
-    ecs_os_free(ids);
+/* Add component to entity, and store the value so it can be copied after all
+ * structural changes of the merge have been applied. */
+static
+void defer_write(
+    ecs_world_t * world,
+    ecs_op_t * op,
+    bool notify)
+{
+    ecs_entity_t e = op->is._1.entity;
+    ecs_entity_info_t info;
+    get_mutable(world, e, op->component, &info, NULL);
+
+    ecs_deferred_write_t *w = ecs_vector_add(
+        &world->deferred_writes, ecs_deferred_write_t);
+    w->entity = e;
+    w->component = op->component;
+    w->c_info = get_c_info(world, op->component);
+    w->value = op->is._1.value;
+    w->size = op->is._1.size;
+    w->notify = notify;
 }
 
+/* Operations that read or destroy component values of an entity can't be 
+ * applied before pending values are written. */
 static
-void discard_op(
-    ecs_op_t * op)
+bool reads_values(
+    ecs_op_kind_t kind)
+{
+    switch(kind) {
+    case EcsOpClone:
+    case EcsOpModified:
+    case EcsOpDelete:
+    case EcsOpClear:
+    case EcsOpRemove:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void ecs_deferred_writes_partition(
+    ecs_world_t *world,
+    int32_t partition_count)
 {
-    ecs_assert(op->kind != EcsOpBulkNew, ECS_INTERNAL_ERROR, NULL);
+    ecs_deferred_write_t *writes = ecs_vector_first(
+        world->deferred_writes, ecs_deferred_write_t);
+    int32_t i, count = ecs_vector_count(world->deferred_writes);
 
-    void *value = op->is._1.value;
-    if (value) {
-        ecs_os_free(value);
+    ecs_vector_set_count(&world->deferred_write_slices, int32_t, 
+        partition_count + 1);
+    int32_t *slices = ecs_vector_first(world->deferred_write_slices, int32_t);
+    ecs_os_memset(slices, 0, ECS_SIZEOF(int32_t) * (partition_count + 1));
+
+    /* Count writes per partition. Entities are assigned to partitions in
+     * blocks, so that threads write to different regions of a table. */
+    for (i = 0; i < count; i ++) {
+        uint32_t e = (uint32_t)writes[i].entity;
+        slices[(e / ECS_MERGE_PARTITION_SIZE) % (uint32_t)partition_count + 1]++;
+    }
+
+    for (i = 0; i < partition_count; i ++) {
+        slices[i + 1] += slices[i];
+    }
+
+    /* Order writes by partition. Writes in a partition keep the order in which
+     * they were set, so that the last value for a component is written last. */
+    ecs_vector_set_count(&world->deferred_write_order, int32_t, count);
+    int32_t *order = ecs_vector_first(world->deferred_write_order, int32_t);
+    for (i = 0; i < count; i ++) {
+        uint32_t e = (uint32_t)writes[i].entity;
+        order[slices[(e / ECS_MERGE_PARTITION_SIZE) % 
+            (uint32_t)partition_count] ++] = i;
     }
 
-    ecs_entity_t *components = op->components.array;
-    if (components) {
-        ecs_os_free(components);
+    /* Filling in the order moved each offset to the start of the next
+     * partition, so shift offsets back by one */
+    for (i = partition_count; i > 0; i --) {
+        slices[i] = slices[i - 1];
     }
+    slices[0] = 0;
 }
 
+void ecs_deferred_writes_apply(
+    ecs_world_t *world,
+    int32_t partition)
+{
+    ecs_assert(partition < ecs_vector_count(world->deferred_write_slices) - 1,
+        ECS_INTERNAL_ERROR, NULL);
+
+    ecs_deferred_write_t *writes = ecs_vector_first(
+        world->deferred_writes, ecs_deferred_write_t);
+    int32_t *order = ecs_vector_first(world->deferred_write_order, int32_t);
+    int32_t *slices = ecs_vector_first(world->deferred_write_slices, int32_t);
+    int32_t i, end = slices[partition + 1];
+
+    /* Consecutive writes often go to the same column, so the column of the
+     * last write is reused if table and component are the same */
+    ecs_table_t *table = NULL;
+    ecs_entity_t component = 0;
+    ecs_column_t *column = NULL;
+
+    for (i = slices[partition]; i < end; i ++) {
+        ecs_deferred_write_t *w = &writes[order[i]];
+        ecs_entity_t e = w->entity;
+
+        /* Entity may have been deleted, or the component removed by a trigger
+         * that ran during the merge */
+        ecs_record_t *record = ecs_eis_get(world, e);
+        if (!record || !record->table) {
+            continue;
+        }
+
+        if (record->table != table || w->component != component) {
+            table = record->table;
+            component = w->component;
+            column = NULL;
+
+            int32_t index = ecs_type_index_of(table->type, component);
+            if (index != -1 && index < table->column_count) {
+                ecs_data_t *data = ecs_table_get_data(table);
+                ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
+                column = &data->columns[index];
+            }
+        }
+
+        if (!column) {
+            continue;
+        }
+
+        bool is_watched;
+        int32_t row = ecs_record_to_row(record->row, &is_watched);
+        void *dst = ECS_OFFSET(ecs_vector_first_t(column->data, column->size, 
+            column->alignment), row * column->size);
+
+        void *ptr = w->value;
+        size_t size = ecs_to_size_t(w->size);
+        ecs_c_info_t *cdata = w->c_info;
+
+        if (!ptr) {
+            memset(dst, 0, size);
+        } else if (cdata && cdata->lifecycle.move) {
+            ecs_entity_t real_id = cdata->component;
+            cdata->lifecycle.move(world, real_id, &e, &e, dst, ptr, size, 1, 
+                cdata->lifecycle.ctx);
+        } else {
+            ecs_os_memcpy(dst, ptr, w->size);
+        }
+    }
+}
+
+void ecs_deferred_writes_end(
+    ecs_world_t *world)
+{
+    ecs_vector_each(world->deferred_writes, ecs_deferred_write_t, w, {
+        ecs_entity_info_t info;
+        if (ecs_get_info(world, w->entity, &info) && info.table && 
+            get_component(&info, w->component)) 
+        {
+            ecs_table_mark_dirty(info.table, w->component);
+
+            if (w->component == ecs_typeid(EcsName)) {
+                ecs_name_index_update(world, w->entity);
+            }
+
+            if (w->notify) {
+                ecs_entities_t added = {
+                    .array = &w->component,
+                    .count = 1
+                };
+
+                ecs_run_set_systems(world, &added, 
+                    info.table, info.data, info.row, 1, false);
+            }
+        }
+
+    });
+
+    ecs_vector_clear(world->deferred_writes);
+}
+
+/* Write pending values on the current thread */
 static
-bool valid_components(
+void flush_deferred_writes(
+    ecs_world_t *world)
+{
+    ecs_deferred_writes_partition(world, 1);
+    ecs_deferred_writes_apply(world, 0);
+    ecs_deferred_writes_end(world);
+}
+
+/* Operations that only change the type of, or assign a value to a single
+ * entity can be combined with other operations for the same entity, so that
+ * the entity is moved at most once. Operations that involve switches, cases or
+ * base entities have side effects that depend on the intermediate tables and
+ * are applied one by one. */
+static
+bool can_coalesce(
     ecs_world_t * world,
-    ecs_entities_t * entities)
+    ecs_op_t * op)
+{
+    switch(op->kind) {
+    case EcsOpNew:
+    case EcsOpAdd:
+        if (!valid_components(world, &op->components)) {
+            return false;
+        }
+        /* Fallthrough */
+    case EcsOpRemove: {
+        ecs_entity_t *array = op->components.array;
+        int32_t i, count = op->components.count;
+        for (i = 0; i < count; i ++) {
+            ecs_entity_t e = array[i];
+            if (ECS_HAS_ROLE(e, CASE) || ECS_HAS_ROLE(e, SWITCH) || 
+                ECS_HAS_ROLE(e, INSTANCEOF)) 
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    case EcsOpSet:
+    case EcsOpMut:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Combined type changes & pending values for one entity */
+typedef struct op_batch_t {
+    ecs_entity_t entity;
+    ecs_entity_info_t info;
+    ecs_table_t *table;
+    ecs_entities_t added;
+    ecs_entities_t removed;
+    ecs_entity_t added_buffer[ECS_MAX_ADD_REMOVE];
+    ecs_entity_t removed_buffer[ECS_MAX_ADD_REMOVE];
+    ecs_op_t *values[ECS_MAX_ADD_REMOVE];
+    int32_t value_count;
+} op_batch_t;
+
+static
+void batch_init(
+    ecs_world_t * world,
+    op_batch_t * batch,
+    ecs_entity_t entity)
+{
+    batch->entity = entity;
+    ecs_get_info(world, entity, &batch->info);
+    batch->table = batch->info.table;
+    batch->added = (ecs_entities_t){ .array = batch->added_buffer };
+    batch->removed = (ecs_entities_t){ .array = batch->removed_buffer };
+    batch->value_count = 0;
+}
+
+static
+bool entities_has(
+    ecs_entities_t * entities,
+    ecs_entity_t e)
 {
-    ecs_entity_t *array = entities->array;
     int32_t i, count = entities->count;
     for (i = 0; i < count; i ++) {
-        ecs_entity_t e = array[i];
-        if (ECS_HAS_ROLE(e, CHILDOF)) {
-            e &= ECS_COMPONENT_MASK;
-            if (ecs_exists(world, e) && !ecs_is_alive(world, e)) {
+        if (entities->array[i] == e) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static
+bool batch_has_value(
+    op_batch_t * batch,
+    ecs_entity_t component)
+{
+    int32_t i, count = batch->value_count;
+    for (i = 0; i < count; i ++) {
+        if (batch->values[i]->component == component) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Get the number of ids an add or remove of the components can add to the
+ * batch. Components with a cold part are added and removed together with their
+ * cold part, which takes an extra slot. */
+static
+int32_t batch_slots(
+    ecs_world_t * world,
+    ecs_entities_t * components)
+{
+    int32_t i, count = components->count, result = count;
+    if (!world->cold_part_count) {
+        return result;
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = components->array[i];
+        if (e & ECS_ROLE_MASK) {
+            continue;
+        }
+
+        ecs_c_info_t *c_info = ecs_get_c_info(world, e);
+        if (c_info && c_info->cold) {
+            result ++;
+        }
+    }
+
+    return result;
+}
+
+/* Values of the batch are assigned after it is committed. When the batch holds
+ * values, it is committed before an operation that runs OnAdd, OnRemove, UnSet
+ * or monitor actions, so that those actions see the values that were set
+ * earlier in the same deferred block. */
+static
+bool batch_hides_values(
+    op_batch_t * batch,
+    ecs_table_t * table)
+{
+    if (!batch->value_count || table == batch->table) {
+        return false;
+    }
+
+    ecs_flags32_t flags = table ? table->flags : 0;
+    if (batch->table) {
+        flags |= batch->table->flags;
+    }
+
+    return (flags & (EcsTableHasOnAdd | EcsTableHasOnRemove | 
+        EcsTableHasUnSet | EcsTableHasMonitors)) != 0;
+}
+
+/* Add operation to batch. Returns false if the operation undoes part of the
+ * batch (like removing a component that was added), in which case the batch
+ * must be committed before the operation can be added. */
+static
+bool batch_add_op(
+    ecs_world_t * world,
+    op_batch_t * batch,
+    ecs_op_t * op)
+{
+    ecs_entities_t components = op->components;
+    ecs_entity_t scope_array[ECS_MAX_ADD_REMOVE];
+    int32_t i;
+
+    switch(op->kind) {
+    case EcsOpNew:
+        if (op->scope) {
+            ecs_assert(components.count < ECS_MAX_ADD_REMOVE - 1, 
+                ECS_INVALID_PARAMETER, NULL);
+            scope_array[0] = ECS_CHILDOF | op->scope;
+            for (i = 0; i < components.count; i ++) {
+                scope_array[i + 1] = components.array[i];
+            }
+            components.array = scope_array;
+            components.count ++;
+        }
+        /* Fallthrough */
+    case EcsOpAdd:
+        if (batch->added.count + batch_slots(world, &components) >= 
+            ECS_MAX_ADD_REMOVE) 
+        {
+            return false;
+        }
+        for (i = 0; i < components.count; i ++) {
+            if (entities_has(&batch->removed, components.array[i])) {
                 return false;
             }
         }
+        if (batch_hides_values(batch, ecs_table_traverse_add(
+            world, batch->table, &components, NULL))) 
+        {
+            return false;
+        }
+        batch->table = ecs_table_traverse_add(
+            world, batch->table, &components, &batch->added);
+        break;
+    case EcsOpRemove:
+        if (batch->removed.count + batch_slots(world, &components) >= 
+            ECS_MAX_ADD_REMOVE) 
+        {
+            return false;
+        }
+        for (i = 0; i < components.count; i ++) {
+            ecs_entity_t e = components.array[i];
+            if (entities_has(&batch->added, e) || batch_has_value(batch, e)) {
+                return false;
+            }
+        }
+        if (batch_hides_values(batch, ecs_table_traverse_remove(
+            world, batch->table, &components, NULL))) 
+        {
+            return false;
+        }
+        batch->table = ecs_table_traverse_remove(
+            world, batch->table, &components, &batch->removed);
+        break;
+    case EcsOpSet:
+    case EcsOpMut:
+        components.array = &op->component;
+        components.count = 1;
+        if (batch->added.count + batch_slots(world, &components) >= 
+            ECS_MAX_ADD_REMOVE ||
+            batch->value_count == ECS_MAX_ADD_REMOVE ||
+            entities_has(&batch->removed, op->component) ||
+            batch_hides_values(batch, ecs_table_traverse_add(
+                world, batch->table, &components, NULL))) 
+        {
+            return false;
+        }
+        batch->table = ecs_table_traverse_add(
+            world, batch->table, &components, &batch->added);
+        batch->values[batch->value_count ++] = op;
+        break;
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
     }
+
     return true;
 }
 
+static
+void assign_op_value(
+    ecs_world_t * world,
+    ecs_op_t * op,
+    bool defer_writes)
+{
+    bool notify = op->kind == EcsOpSet;
+    if (defer_writes) {
+        defer_write(world, op, notify);
+    } else {
+        assign_ptr_w_entity(world, op->is._1.entity, op->component, 
+            ecs_to_size_t(op->is._1.size), op->is._1.value, true, notify);
+    }
+}
+
+/* Move entity to the final table of the batch, then assign pending values */
+static
+void batch_commit(
+    ecs_world_t * world,
+    op_batch_t * batch,
+    bool defer_writes)
+{
+    ecs_entity_t e = batch->entity;
+
+    if (defer_writes && batch->removed.count && 
+        ecs_vector_count(world->deferred_writes)) 
+    {
+        flush_deferred_writes(world);
+        ecs_get_info(world, e, &batch->info);
+    }
+
+    ecs_stage_t *stage = ecs_get_stage(&world);
+    ecs_defer_none(world, stage);
+    commit(world, e, &batch->info, batch->table, 
+        batch->added.count ? &batch->added : NULL, 
+        batch->removed.count ? &batch->removed : NULL);
+    ecs_defer_flush(world, stage);
+
+    int32_t i, count = batch->value_count;
+    for (i = 0; i < count; i ++) {
+        assign_op_value(world, batch->values[i], defer_writes);
+    }
+}
+
+static
+int compare_row(
+    const void *ptr1,
+    const void *ptr2)
+{
+    return *(const int32_t*)ptr1 - *(const int32_t*)ptr2;
+}
+
+/* Move entities that have the same source and destination table in one step.
+ * Hooks are invoked in the same order as when moving a single entity. */
+static
+void move_entities(
+    ecs_world_t * world,
+    ecs_table_t * src_table,
+    ecs_table_t * dst_table,
+    const ecs_entity_t * entities,
+    int32_t count,
+    ecs_entities_t * added,
+    ecs_entities_t * removed)
+{
+    ecs_data_t *src_data = ecs_table_get_data(src_table);
+    ecs_data_t *dst_data = ecs_table_get_or_create_data(dst_table);
+    ecs_assert(src_data != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t *rows = ecs_os_malloc(ECS_SIZEOF(int32_t) * count);
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        bool is_watched;
+        ecs_record_t *record = ecs_eis_get(world, entities[i]);
+        ecs_assert(record != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(record->table == src_table, ECS_INTERNAL_ERROR, NULL);
+        rows[i] = ecs_record_to_row(record->row, &is_watched);
+    }
+
+    qsort(rows, ecs_to_size_t(count), sizeof(int32_t), compare_row);
+
+    if (removed && (src_table->flags & EcsTableHasRemoveActions)) {
+        for (i = 0; i < count; i ++) {
+            ecs_run_monitors(world, dst_table, src_table->un_set_all, 
+                rows[i], 1, dst_table->un_set_all);
+
+            ecs_run_remove_actions(
+                world, src_table, src_data, rows[i], 1, removed, false);
+        }
+    }
+
+    int32_t dst_row = ecs_table_move_rows(
+        world, dst_table, dst_data, src_table, src_data, rows, count);
+
+    ecs_os_free(rows);
+
+    ecs_entity_t *dst_entities = ecs_vector_first(
+        dst_data->entities, ecs_entity_t);
+
+    for (i = 0; i < count; i ++) {
+        bool is_watched;
+        ecs_entity_t e = dst_entities[dst_row + i];
+        ecs_record_t *record = ecs_eis_get(world, e);
+        ecs_record_to_row(record->row, &is_watched);
+        record->table = dst_table;
+        record->row = ecs_row_to_record(dst_row + i, is_watched);
+
+        if (is_watched) {
+            update_component_monitors(world, e, added, removed);
+        }
+
+        if ((src_table->flags | dst_table->flags) & EcsTableHasName) {
+            ecs_name_index_move(world, e, dst_table);
+        }
+    }
+
+    if (added && (dst_table->flags & EcsTableHasAddActions)) {
+        ecs_run_add_actions(
+            world, dst_table, dst_data, dst_row, count, added, false, true);
+    }
+
+    if (dst_table->flags & EcsTableHasMonitors) {
+        ecs_run_monitors(world, dst_table, dst_table->monitors, dst_row, 
+            count, src_table->monitors);
+    }
+
+    if (removed && dst_table->flags & EcsTableHasBase) {
+        ecs_run_monitors(world, dst_table, src_table->on_set_override, 
+            dst_row, count, dst_table->on_set_override);          
+    }
+}
+
+static
+bool can_move_rows(
+    ecs_table_t * table)
+{
+    return table && table->type && 
+        !table->sw_column_count && !table->bs_column_count;
+}
+
+/* Apply a single deferred operation */
+static
+void flush_op(
+    ecs_world_t * world,
+    ecs_op_t * op,
+    ecs_entity_t e,
+    bool defer_writes)
+{
+    if (defer_writes && reads_values(op->kind) && 
+        ecs_vector_count(world->deferred_writes)) 
+    {
+        flush_deferred_writes(world);
+    }
+
+    switch(op->kind) {
+    case EcsOpNew:
+        if (op->scope) {
+            ecs_add_entity(world, e, ECS_CHILDOF | op->scope);
+        }
+        /* Fallthrough */
+    case EcsOpAdd:
+        if (valid_components(world, &op->components)) {
+            world->add_count ++;
+            add_entities(world, e, &op->components);
+        } else {
+            ecs_delete(world, e);
+        }
+        break;
+    case EcsOpRemove:
+        remove_entities(world, e, &op->components);
+        break;
+    case EcsOpClone:
+        ecs_clone(world, e, op->component, op->is._1.clone_value);
+        break;
+    case EcsOpSet:
+        if (defer_writes) {
+            defer_write(world, op, true);
+            break;
+        }
+        assign_ptr_w_entity(world, e, 
+            op->component, ecs_to_size_t(op->is._1.size), 
+            op->is._1.value, true, true);
+        break;
+    case EcsOpMut:
+        if (defer_writes) {
+            defer_write(world, op, false);
+            break;
+        }
+        assign_ptr_w_entity(world, e, 
+            op->component, ecs_to_size_t(op->is._1.size), 
+            op->is._1.value, true, false);
+        break;
+    case EcsOpModified:
+        ecs_modified_w_entity(world, e, op->component);
+        break;
+    case EcsOpDelete: {
+        ecs_delete(world, e);
+        break;
+    }
+    case EcsOpEnable:
+        ecs_enable_component_w_entity(
+            world, e, op->component, true);
+        break;
+    case EcsOpDisable:
+        ecs_enable_component_w_entity(
+            world, e, op->component, false);
+        break;
+    case EcsOpClear:
+        ecs_clear(world, e);
+        break;
+    case EcsOpBulkNew:
+        flush_bulk_new(world, op);
+        break;
+    }
+}
+
+static
+void flush_part(
+    ecs_world_t * world,
+    ecs_entity_t e,
+    ecs_op_kind_t kind,
+    ecs_entities_t * part)
+{
+    if (!part->count) {
+        return;
+    }
+
+    if (kind == EcsOpRemove) {
+        remove_entities(world, e, part);
+    } else {
+        add_entities(world, e, part);
+    }
+}
+
+/* Apply an operation that has more ids than fit in a batch. Ids are added or
+ * removed in parts, so that the ids and the cold parts that come with them
+ * don't exceed the maximum number of ids of a single table move. */
+static
+void flush_large_op(
+    ecs_world_t * world,
+    ecs_op_t * op,
+    ecs_entity_t e,
+    bool defer_writes)
+{
+    ecs_op_kind_t kind = op->kind;
+    ecs_entities_t *components = &op->components;
+    if ((kind != EcsOpNew && kind != EcsOpAdd && kind != EcsOpRemove) ||
+        (kind != EcsOpRemove && !valid_components(world, components))) 
+    {
+        flush_op(world, op, e, defer_writes);
+        return;
+    }
+
+    if (defer_writes && reads_values(kind) && 
+        ecs_vector_count(world->deferred_writes)) 
+    {
+        flush_deferred_writes(world);
+    }
+
+    if (kind == EcsOpNew && op->scope) {
+        ecs_add_entity(world, e, ECS_CHILDOF | op->scope);
+    }
+
+    if (kind != EcsOpRemove) {
+        world->add_count ++;
+    }
+
+    ecs_entities_t part = { .array = components->array, .count = 0 };
+    int32_t i, slots = 0, count = components->count;
+    for (i = 0; i < count; i ++) {
+        ecs_entities_t id = { .array = &components->array[i], .count = 1 };
+        int32_t id_slots = batch_slots(world, &id);
+        if (slots + id_slots >= ECS_MAX_ADD_REMOVE) {
+            flush_part(world, e, kind, &part);
+            part.array = id.array;
+            part.count = 0;
+            slots = 0;
+        }
+
+        part.count ++;
+        slots += id_slots;
+    }
+
+    flush_part(world, e, kind, &part);
+}
+
+/* Apply all operations for an entity, committing whenever an operation undoes
+ * part of the changes collected so far. */
+static
+void flush_entity_ops(
+    ecs_world_t * world,
+    ecs_op_t * ops,
+    const int32_t * next,
+    int32_t head,
+    bool defer_writes)
+{
+    ecs_entity_t e = ops[head].is._1.entity;
+    op_batch_t batch;
+    batch_init(world, &batch, e);
+
+    int32_t cur;
+    for (cur = head; cur != -1; cur = next[cur]) {
+        ecs_op_t *op = &ops[cur];
+
+        /* Entity could have been deleted by a trigger */
+        if (!ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
+            world->discard_count ++;
+            continue;
+        }
+
+        if (!batch_add_op(world, &batch, op)) {
+            batch_commit(world, &batch, defer_writes);
+            batch_init(world, &batch, e);
+
+            /* Operations that don't fit in an empty batch, like an add with
+             * more ids than the batch has slots, are applied by themselves */
+            if (!batch_add_op(world, &batch, op)) {
+                flush_large_op(world, op, e, defer_writes);
+                batch_init(world, &batch, e);
+            }
+        }
+    }
+
+    if (ecs_is_alive(world, e) || !ecs_eis_exists(world, e)) {
+        batch_commit(world, &batch, defer_writes);
+    }
+}
+
+/* Entities that move between the same tables in a flush */
+typedef struct move_group_t {
+    ecs_table_t *src;
+    ecs_table_t *dst;
+    int32_t first;          /* First operation of first entity in group */
+    int32_t last;           /* First operation of last entity in group */
+    int32_t count;
+} move_group_t;
+
+/* Find final table for entity. Returns false if the operations for the entity
+ * cannot be applied with a single move of rows between tables. */
+static
+bool find_move(
+    ecs_world_t * world,
+    ecs_op_t * ops,
+    const int32_t * next,
+    int32_t head,
+    op_batch_t * batch)
+{
+    ecs_entity_t e = ops[head].is._1.entity;
+    if (!ecs_is_alive(world, e)) {
+        return false;
+    }
+
+    batch_init(world, batch, e);
+    if (!can_move_rows(batch->info.table) || !batch->info.data) {
+        return false;
+    }
+
+    int32_t cur;
+    for (cur = head; cur != -1; cur = next[cur]) {
+        if (!batch_add_op(world, batch, &ops[cur])) {
+            return false;
+        }
+    }
+
+    ecs_table_t *src = batch->info.table;
+    return batch->table != src && batch->table != src->chunk_head && 
+        can_move_rows(batch->table);
+}
+
+static
+void flush_move_group(
+    ecs_world_t * world,
+    ecs_op_t * ops,
+    const int32_t * next,
+    const int32_t * next_in_group,
+    move_group_t * group,
+    bool defer_writes)
+{
+    ecs_entity_t *entities = ecs_os_malloc(
+        ECS_SIZEOF(ecs_entity_t) * group->count);
+    int32_t head, count = 0;
+
+    /* Triggers that ran for a previous group may have changed entities in this
+     * group. Those are applied one by one. */
+    for (head = group->first; head != -1; head = next_in_group[head]) {
+        ecs_entity_t e = ops[head].is._1.entity;
+        ecs_record_t *record = ecs_eis_get(world, e);
+        if (ecs_is_alive(world, e) && record && record->table == group->src) {
+            entities[count ++] = e;
+        } else {
+            flush_entity_ops(world, ops, next, head, defer_writes);
+        }
+    }
+
+    if (count) {
+        /* Entities in a group have the same source and destination table, 
+         * so the components that are added and removed are the same */
+        op_batch_t batch;
+        head = group->first;
+        while (ops[head].is._1.entity != entities[0]) {
+            head = next_in_group[head];
+        }
+
+        bool found = find_move(world, ops, next, head, &batch);
+        ecs_assert(found && batch.table == group->dst, 
+            ECS_INTERNAL_ERROR, NULL);
+        (void)found;
+
+        ecs_stage_t *stage = ecs_get_stage(&world);
+        ecs_defer_none(world, stage);
+        ecs_table_t *dst = ecs_table_get_chunk(world, group->dst, count);
+        move_entities(world, group->src, dst, entities, count, 
+            batch.added.count ? &batch.added : NULL, 
+            batch.removed.count ? &batch.removed : NULL);
+        ecs_defer_flush(world, stage);
+
+        int32_t i = 0;
+        for (head = group->first; head != -1; head = next_in_group[head]) {
+            if (i == count || ops[head].is._1.entity != entities[i]) {
+                continue;
+            }
+
+            i ++;
+
+            int32_t cur;
+            for (cur = head; cur != -1; cur = next[cur]) {
+                ecs_op_kind_t kind = ops[cur].kind;
+                if (kind == EcsOpSet || kind == EcsOpMut) {
+                    assign_op_value(world, &ops[cur], defer_writes);
+                }
+            }
+        }
+    }
+
+    ecs_os_free(entities);
+}
+
+/* Apply a sequence of operations that can be coalesced. Operations are grouped
+ * by entity, so that each entity moves to its final table in one step. The
+ * order of operations for the same entity is preserved, the order across
+ * entities is not. Entities that move between the same tables are moved 
+ * together, which replaces row by row moves with a copy per column. */
+static
+void flush_coalesced(
+    ecs_world_t * world,
+    ecs_op_t * ops,
+    int32_t count,
+    bool defer_writes)
+{
+    ecs_map_t *last = ecs_map_new(int32_t, count);
+    int32_t *next = ecs_os_malloc(ECS_SIZEOF(int32_t) * count * 3);
+    int32_t *prev = &next[count];
+    int32_t *group_of = &next[count * 2];
+    int32_t i;
+
+    /* Link each operation to the next operation for the same entity. Indices
+     * in the map are stored offset by one, as 0 means not found. */
+    for (i = 0; i < count; i ++) {
+        ecs_op_kind_t kind = ops[i].kind;
+        if (kind == EcsOpNew || kind == EcsOpAdd) {
+            world->add_count ++;
+        }
+
+        int32_t *last_op = ecs_map_ensure(last, int32_t, ops[i].is._1.entity);
+        prev[i] = last_op[0] - 1;
+        next[i] = -1;
+        group_of[i] = -1;
+        if (prev[i] != -1) {
+            next[prev[i]] = i;
+            group_of[i] = -2; /* Not the first operation for entity */
+        }
+        last_op[0] = i + 1;
+    }
+
+    /* Group entities by source and destination table. The next_in_group array
+     * reuses the prev array, which is no longer needed. */
+    ecs_map_t *group_index = ecs_map_new(int32_t, 0);
+    ecs_vector_t *groups = NULL;
+    int32_t *next_in_group = prev;
+    op_batch_t batch;
+
+    for (i = 0; i < count; i ++) {
+        if (group_of[i] == -2) {
+            continue;
+        }
+
+        next_in_group[i] = -1;
+
+        if (!find_move(world, ops, next, i, &batch)) {
+            continue;
+        }
+
+        ecs_map_key_t key = ((ecs_map_key_t)batch.info.table->id << 32) | 
+            batch.table->id;
+        int32_t *group_id = ecs_map_ensure(group_index, int32_t, key);
+        move_group_t *group;
+        if (!group_id[0]) {
+            group = ecs_vector_add(&groups, move_group_t);
+            group->src = batch.info.table;
+            group->dst = batch.table;
+            group->first = i;
+            group->count = 0;
+            group_id[0] = ecs_vector_count(groups);
+        } else {
+            group = ecs_vector_get(groups, move_group_t, group_id[0] - 1);
+            next_in_group[group->last] = i;
+        }
+
+        group->last = i;
+        group->count ++;
+        group_of[i] = group_id[0] - 1;
+    }
+
+    for (i = 0; i < count; i ++) {
+        int32_t group_id = group_of[i];
+        if (group_id == -2) {
+            continue;
+        }
+
+        if (group_id != -1) {
+            move_group_t *group = ecs_vector_get(
+                groups, move_group_t, group_id);
+            if (group->count > 1) {
+                if (group->first == i) {
+                    flush_move_group(
+                        world, ops, next, next_in_group, group, defer_writes);
+                }
+                continue;
+            }
+        }
+
+        flush_entity_ops(world, ops, next, i, defer_writes);
+    }
+
+    ecs_os_free(next);
+    ecs_map_free(group_index);
+    ecs_vector_free(groups);
+    ecs_map_free(last);
+}
+
 /* Leave safe section. Run all deferred commands. */
 bool ecs_defer_flush(
     ecs_world_t * world,
@@ -2765,9 +3777,36 @@ bool ecs_defer_flush(
         if (defer_queue) {
             ecs_op_t *ops = ecs_vector_first(defer_queue, ecs_op_t);
             int32_t i, count = ecs_vector_count(defer_queue);
+
+            /* In a parallel merge, values of set operations are copied after
+             * the structural changes from all stages have been applied */
+            bool defer_writes = world->defer_writes && stage != &world->stage;
+            ecs_arena_mark_t mark = stage->defer_mark;
+
+            for (i = 0; i < count; i ++) {
+                if (ops[i].components.count == 1) {
+                    ops[i].components.array = &ops[i].component;
+                }
+            }
             
             for (i = 0; i < count; i ++) {
                 ecs_op_t *op = &ops[i];
+
+                /* Combine adjacent operations that only change the type of or
+                 * assign values to entities */
+                if (can_coalesce(world, op)) {
+                    int32_t end = i + 1;
+                    while (end < count && can_coalesce(world, &ops[end])) {
+                        end ++;
+                    }
+
+                    if (end - i > 1) {
+                        flush_coalesced(world, op, end - i, defer_writes);
+                        i = end - 1;
+                        continue;
+                    }
+                }
+
                 ecs_entity_t e = op->is._1.entity;
                 if (op->kind == EcsOpBulkNew) {
                     e = 0;
@@ -2780,82 +3819,21 @@ bool ecs_defer_flush(
                     ecs_assert(op->kind != EcsOpNew && op->kind != EcsOpClone, 
                         ECS_INTERNAL_ERROR, NULL);
                     world->discard_count ++;
-                    discard_op(op);
-                    continue;
-                }
-
-                if (op->components.count == 1) {
-                    op->components.array = &op->component;
-                }
-
-                switch(op->kind) {
-                case EcsOpNew:
-                    if (op->scope) {
-                        ecs_add_entity(world, e, ECS_CHILDOF | op->scope);
-                    }
-                    /* Fallthrough */
-                case EcsOpAdd:
-                    if (valid_components(world, &op->components)) {
-                        world->add_count ++;
-                        add_entities(world, e, &op->components);
-                    } else {
-                        ecs_delete(world, e);
-                    }
-                    break;
-                case EcsOpRemove:
-                    remove_entities(world, e, &op->components);
-                    break;
-                case EcsOpClone:
-                    ecs_clone(world, e, op->component, op->is._1.clone_value);
-                    break;
-                case EcsOpSet:
-                    assign_ptr_w_entity(world, e, 
-                        op->component, ecs_to_size_t(op->is._1.size), 
-                        op->is._1.value, true, true);
-                    break;
-                case EcsOpMut:
-                    assign_ptr_w_entity(world, e, 
-                        op->component, ecs_to_size_t(op->is._1.size), 
-                        op->is._1.value, true, false);
-                    break;
-                case EcsOpModified:
-                    ecs_modified_w_entity(world, e, op->component);
-                    break;
-                case EcsOpDelete: {
-                    ecs_delete(world, e);
-                    break;
-                }
-                case EcsOpEnable:
-                    ecs_enable_component_w_entity(
-                        world, e, op->component, true);
-                    break;
-                case EcsOpDisable:
-                    ecs_enable_component_w_entity(
-                        world, e, op->component, false);
-                    break;
-                case EcsOpClear:
-                    ecs_clear(world, e);
-                    break;
-                case EcsOpBulkNew:
-                    flush_bulk_new(world, op);
-
-                    /* Continue since flush_bulk_new is repsonsible for cleaning
-                     * up resources. */
                     continue;
                 }
 
-                if (op->components.count > 1) {
-                    ecs_os_free(op->components.array);
-                }
-
-                if (op->is._1.value) {
-                    ecs_os_free(op->is._1.value);
-                }                  
+                flush_op(world, op, e, defer_writes);
             };
 
             if (defer_queue != stage->defer_merge_queue) {
                 ecs_vector_free(defer_queue);
             }
+
+            /* Release payloads of the queue in one go. Values collected for a
+             * parallel merge are released after they have been written. */
+            if (!defer_writes) {
+                ecs_stage_defer_release(stage, mark);
+            }
         }
 
         return true;
@@ -1,6 +1,57 @@
 
 #include "private_api.h"
 
+/* Find the component of the filter with the fewest tables. Only the tables for
+ * this component have to be evaluated, instead of all tables in the world. */
+static
+ecs_entity_t select_filter_component(
+    ecs_world_t *world,
+    const ecs_filter_t *filter)
+{
+    if (!filter || !filter->include || filter->include_kind == EcsMatchAny) {
+        return 0;
+    }
+
+    ecs_entity_t *array = ecs_vector_first(filter->include, ecs_entity_t);
+    int32_t i, count = ecs_vector_count(filter->include);
+
+    ecs_entity_t result = 0;
+    int32_t min_count = -1;
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = array[i];
+        if (!ecs_table_index_supports(e)) {
+            continue;
+        }
+
+        int32_t table_count = ecs_table_index_count(world, e, true);
+        if (min_count == -1 || table_count < min_count) {
+            result = e;
+            min_count = table_count;
+        }
+    }
+
+    return result;
+}
+
+static
+ecs_table_t* next_filter_table(
+    ecs_world_t *world,
+    ecs_filter_iter_t *iter)
+{
+    if (iter->component) {
+        return ecs_table_index_next(world, iter->component, true, 
+            &iter->index, &iter->base_index);
+    }
+
+    ecs_sparse_t *tables = iter->tables;
+    if (iter->index < ecs_sparse_count(tables)) {
+        return ecs_sparse_get(tables, ecs_table_t, iter->index ++);
+    }
+
+    return NULL;
+}
+
 ecs_iter_t ecs_filter_iter(
     ecs_world_t *world,
     const ecs_filter_t *filter)
@@ -8,7 +59,9 @@ ecs_iter_t ecs_filter_iter(
     ecs_filter_iter_t iter = {
         .filter = filter ? *filter : (ecs_filter_t){0},
         .tables = world->store.tables,
-        .index = 0
+        .component = select_filter_component(world, filter),
+        .index = 0,
+        .base_index = 0
     };
 
     return (ecs_iter_t){
@@ -21,14 +74,9 @@ bool ecs_filter_next(
     ecs_iter_t *it)
 {
     ecs_filter_iter_t *iter = &it->iter.filter;
-    ecs_sparse_t *tables = iter->tables;
-    int32_t count = ecs_sparse_count(tables);
-    int32_t i;
+    ecs_table_t *table;
 
-    for (i = iter->index; i < count; i ++) {
-        ecs_table_t *table = ecs_sparse_get(tables, ecs_table_t, i);
-        ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
-        
+    while ((table = next_filter_table(it->world, iter))) {
         ecs_data_t *data = ecs_table_get_data(table);
 
         if (!data) {
@@ -44,7 +92,6 @@ bool ecs_filter_next(
         it->table_columns = data->columns;
         it->count = ecs_table_count(table);
         it->entities = ecs_vector_first(data->entities, ecs_entity_t);
-        iter->index = i + 1;
 
         return true;
     }
@@ -136,13 +136,408 @@ ecs_entity_t find_child_in_table(
     return 0;
 }
 
+/* -- Name index -- */
+
+/* The name index stores named entities by scope and by the hash of their name,
+ * so that looking up a child does not require visiting every entity in the
+ * scope. Entities with a symbol that is different from their name are also
+ * stored by the hash of the symbol. All entities are also stored by hash only,
+ * which is used to lookup symbols across scopes. 
+ *
+ * Entries are validated on lookup, which means that an entry does not have to
+ * be removed when an entity is deleted in bulk. Operations that add names in
+ * bulk mark the index as dirty, which rebuilds the index on the next lookup. */
+
+static
+uint64_t name_hash(
+    const char *name)
+{
+    uint64_t hash;
+    ecs_hash(name, ecs_os_strlen(name), &hash);
+    return hash;
+}
+
+static
+ecs_map_key_t scope_key(
+    ecs_entity_t scope,
+    uint64_t hash)
+{
+    return hash ^ ((scope + 1) * 0x9E3779B97F4A7C15);
+}
+
+static
+ecs_entity_t table_scope(
+    ecs_table_t *table)
+{
+    if (!(table->flags & EcsTableHasParent)) {
+        return 0;
+    }
+
+    ecs_vector_each(table->type, ecs_entity_t, c_ptr, {
+        if (ECS_HAS_ROLE(*c_ptr, CHILDOF)) {
+            return *c_ptr & ECS_COMPONENT_MASK;
+        }
+    });
+
+    return 0;
+}
+
+static
+void bucket_add(
+    ecs_world_t *world,
+    ecs_map_key_t key,
+    ecs_entity_t entity)
+{
+    ecs_name_bucket_t *bucket = ecs_map_ensure(
+        world->name_index, ecs_name_bucket_t, key);
+    if (!bucket->first) {
+        bucket->first = entity;
+    } else {
+        ecs_entity_t *elem = ecs_vector_add(&bucket->more, ecs_entity_t);
+        *elem = entity;
+    }
+}
+
+static
+void bucket_remove(
+    ecs_world_t *world,
+    ecs_map_key_t key,
+    ecs_entity_t entity)
+{
+    ecs_name_bucket_t *bucket = ecs_map_get(
+        world->name_index, ecs_name_bucket_t, key);
+    if (!bucket) {
+        return;
+    }
+
+    int32_t i, count = ecs_vector_count(bucket->more);
+    ecs_entity_t *more = ecs_vector_first(bucket->more, ecs_entity_t);
+
+    if (bucket->first == entity) {
+        if (count) {
+            bucket->first = more[count - 1];
+            ecs_vector_remove_last(bucket->more);
+        } else {
+            ecs_map_remove(world->name_index, key);
+        }
+        return;
+    }
+
+    for (i = 0; i < count; i ++) {
+        if (more[i] == entity) {
+            ecs_vector_remove_index(bucket->more, ecs_entity_t, i);
+            break;
+        }
+    }
+}
+
+static
+void index_hash(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_entity_t scope,
+    uint64_t hash)
+{
+    if (hash) {
+        bucket_add(world, scope_key(scope, hash), entity);
+        bucket_add(world, hash, entity);
+    }
+}
+
+static
+void unindex_hash(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_entity_t scope,
+    uint64_t hash)
+{
+    if (hash) {
+        bucket_remove(world, scope_key(scope, hash), entity);
+        bucket_remove(world, hash, entity);
+    }
+}
+
+static
+void index_entity(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_table_t *table,
+    const EcsName *name)
+{
+    const char *value = name->value;
+    const char *symbol = name->symbol;
+    if (!value && !symbol) {
+        return;
+    }
+
+    ecs_name_entry_t entry = {
+        .scope = table_scope(table),
+        .name_hash = value ? name_hash(value) : 0
+    };
+
+    if (symbol && (!value || strcmp(symbol, value))) {
+        entry.symbol_hash = name_hash(symbol);
+    }
+
+    index_hash(world, entity, entry.scope, entry.name_hash);
+    index_hash(world, entity, entry.scope, entry.symbol_hash);
+
+    ecs_map_set(world->name_entries, entity, &entry);
+}
+
+static
+void unindex_entity(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    ecs_name_entry_t *entry = ecs_map_get(
+        world->name_entries, ecs_name_entry_t, entity);
+    if (!entry) {
+        return;
+    }
+
+    unindex_hash(world, entity, entry->scope, entry->name_hash);
+    unindex_hash(world, entity, entry->scope, entry->symbol_hash);
+
+    ecs_map_remove(world->name_entries, entity);
+}
+
+static
+void free_name_index(
+    ecs_world_t *world)
+{
+    ecs_map_iter_t it = ecs_map_iter(world->name_index);
+    ecs_name_bucket_t *bucket;
+    while ((bucket = ecs_map_next(&it, ecs_name_bucket_t, NULL))) {
+        ecs_vector_free(bucket->more);
+    }
+
+    ecs_map_free(world->name_index);
+    ecs_map_free(world->name_entries);
+    ecs_vector_free(world->name_pending);
+    world->name_index = NULL;
+    world->name_entries = NULL;
+    world->name_pending = NULL;
+}
+
+static
+void build_name_index(
+    ecs_world_t *world)
+{
+    free_name_index(world);
+    world->name_index = ecs_map_new(ecs_name_bucket_t, 0);
+    world->name_entries = ecs_map_new(ecs_name_entry_t, 0);
+
+    ecs_sparse_each(world->store.tables, ecs_table_t, table, {
+        if (!(table->flags & EcsTableHasName)) {
+            continue;
+        }
+
+        ecs_data_t *data = ecs_table_get_data(table);
+        if (!data || !data->columns) {
+            continue;
+        }
+
+        int32_t name_index = ecs_type_index_of(
+            table->type, ecs_typeid(EcsName));
+        ecs_assert(name_index != -1, ECS_INTERNAL_ERROR, NULL);
+
+        ecs_entity_t *entities = ecs_vector_first(
+            data->entities, ecs_entity_t);
+        EcsName *names = ecs_vector_first(
+            data->columns[name_index].data, EcsName);
+
+        int32_t i, count = ecs_vector_count(data->entities);
+        for (i = 0; i < count; i ++) {
+            index_entity(world, entities[i], table, &names[i]);
+        }
+    });
+
+    world->name_index_dirty = false;
+}
+
+/* Returns whether index can be used. The index is not updated while the world
+ * is progressing, as lookups may happen from multiple threads. */
+static
+bool name_index_ready(
+    ecs_world_t *world)
+{
+    if (world->name_index_dirty) {
+        if (world->in_progress) {
+            return false;
+        }
+
+        build_name_index(world);
+    }
+
+    if (world->name_pending) {
+        if (world->in_progress) {
+            return false;
+        }
+
+        ecs_vector_t *pending = world->name_pending;
+        world->name_pending = NULL;
+
+        ecs_vector_each(pending, ecs_entity_t, e_ptr, {
+            if (ecs_is_alive(world, *e_ptr)) {
+                ecs_name_index_update(world, *e_ptr);
+            }
+        });
+
+        ecs_vector_free(pending);
+    }
+
+    return true;
+}
+
+static
+bool name_matches(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    const char *name)
+{
+    if (!ecs_is_alive(world, entity)) {
+        return false;
+    }
+
+    const EcsName *ptr = ecs_get(world, entity, EcsName);
+    if (!ptr) {
+        return false;
+    }
+
+    return (ptr->value && !strcmp(ptr->value, name)) || 
+        (ptr->symbol && !strcmp(ptr->symbol, name));
+}
+
+static
+bool in_scope(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_entity_t scope)
+{
+    ecs_table_t *table = ecs_eis_get(world, entity)->table;
+    if (scope) {
+        return ecs_type_index_of(table->type, ECS_CHILDOF | scope) != -1;
+    } else {
+        return !(table->flags & EcsTableHasParent);
+    }
+}
+
+static
+ecs_entity_t find_in_bucket(
+    ecs_world_t *world,
+    ecs_map_key_t key,
+    ecs_entity_t scope,
+    bool any_scope,
+    const char *name)
+{
+    ecs_name_bucket_t *bucket = ecs_map_get(
+        world->name_index, ecs_name_bucket_t, key);
+    if (!bucket) {
+        return 0;
+    }
+
+    ecs_entity_t e = bucket->first;
+    if (name_matches(world, e, name) && 
+        (any_scope || in_scope(world, e, scope))) 
+    {
+        return e;
+    }
+
+    ecs_vector_each(bucket->more, ecs_entity_t, e_ptr, {
+        e = *e_ptr;
+        if (name_matches(world, e, name) && 
+            (any_scope || in_scope(world, e, scope))) 
+        {
+            return e;
+        }
+    });
+
+    return 0;
+}
+
+void ecs_name_index_update(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    if (world->name_index_dirty) {
+        return;
+    }
+
+    unindex_entity(world, entity);
+
+    ecs_record_t *record = ecs_eis_get(world, entity);
+    if (!record || !record->table) {
+        return;
+    }
+
+    ecs_table_t *table = record->table;
+    if (!(table->flags & EcsTableHasName)) {
+        return;
+    }
+
+    const EcsName *name = ecs_get(world, entity, EcsName);
+    ecs_assert(name != NULL, ECS_INTERNAL_ERROR, NULL);
+    index_entity(world, entity, table, name);
+}
+
+void ecs_name_index_defer(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    if (!world->name_index_dirty) {
+        ecs_entity_t *e = ecs_vector_add(&world->name_pending, ecs_entity_t);
+        *e = entity;
+    }
+}
+
+void ecs_name_index_move(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_table_t *table)
+{
+    if (world->name_index_dirty) {
+        return;
+    }
+
+    if (!table || !(table->flags & EcsTableHasName)) {
+        unindex_entity(world, entity);
+        return;
+    }
+
+    /* Entities that are not indexed yet may have been moved to the table with
+     * a name, for example when it was copied from a base */
+    ecs_name_entry_t *entry = ecs_map_get(
+        world->name_entries, ecs_name_entry_t, entity);
+    if (!entry || entry->scope != table_scope(table)) {
+        ecs_name_index_update(world, entity);
+    }
+}
+
+void ecs_name_index_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    if (!world->name_index_dirty) {
+        unindex_entity(world, entity);
+    }
+}
+
+void ecs_name_index_fini(
+    ecs_world_t *world)
+{
+    free_name_index(world);
+}
+
+/* Lookup entity in all scopes by name or symbol */
 static
 ecs_entity_t find_child(
     ecs_world_t *world,
-    ecs_entity_t parent,
     const char *name)
 {
-    (void)parent;
+    if (!is_number(name) && name_index_ready(world)) {
+        return find_in_bucket(world, name_hash(name), 0, true, name);
+    }
     
     ecs_sparse_each(world->store.tables, ecs_table_t, table, {
         ecs_entity_t result = find_child_in_table(table, name);
@@ -163,17 +558,33 @@ ecs_entity_t ecs_lookup_child(
 
     ecs_vector_t *child_tables = ecs_map_get_ptr(
         world->child_tables, ecs_vector_t*, parent);
-    
-    if (child_tables) {
-        ecs_vector_each(child_tables, ecs_table_t*, table_ptr, {
-            ecs_table_t *table = *table_ptr;
-            result = find_child_in_table(table, name);
-            if (result) {
-                return result;
-            }
-        });
+    if (!child_tables) {
+        return 0;
     }
 
+    bool use_index = !is_number(name) && name_index_ready(world);
+    if (use_index) {
+        result = find_in_bucket(
+            world, scope_key(parent, name_hash(name)), parent, false, name);
+        if (result || !parent) {
+            return result;
+        }
+    }
+
+    /* Entities are indexed by their first parent. Scan tables of children for
+     * which the parent is not the first parent. */
+    ecs_vector_each(child_tables, ecs_table_t*, table_ptr, {
+        ecs_table_t *table = *table_ptr;
+        if (use_index && table_scope(table) == parent) {
+            continue;
+        }
+
+        result = find_child_in_table(table, name);
+        if (result) {
+            return result;
+        }
+    });
+
     return result;
 }
 
@@ -209,7 +620,7 @@ ecs_entity_t ecs_lookup_symbol(
         return name_to_id(name);
     }   
     
-    return find_child(world, 0, name);
+    return find_child(world, name);
 }
 
 static
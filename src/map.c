@@ -4,20 +4,32 @@
  * (element_count * LOAD_FACTOR) > bucket_count, bucket count is increased. */
 #define LOAD_FACTOR (1.5)
 #define KEY_SIZE (ECS_SIZEOF(ecs_map_key_t))
-#define GET_ELEM(array, elem_size, index) \
-    ECS_OFFSET(array, (elem_size) * (index))
-
-struct ecs_bucket_t {
-    ecs_map_key_t *keys;    /* Array with keys */
-    void *payload;          /* Payload array */
-    int32_t count;          /* Number of elements in bucket */
-};
 
+/* Probe distances are stored in a byte, offset by one so that 0 means empty.
+ * Larger distances are stored as MAX_DIST. */
+#define MAX_DIST (255)
+
+#define GET_SLOT(map, index) \
+    ECS_OFFSET((map)->slots, (map)->slot_size * (index))
+#define GET_KEY(map, index) \
+    (*(ecs_map_key_t*)GET_SLOT(map, index))
+#define GET_ELEM(map, index) \
+    ECS_OFFSET(GET_SLOT(map, index), KEY_SIZE)
+
+/* The map uses open addressing with Robin Hood hashing. Keys and payloads are
+ * stored together in a single slot array, so that a lookup typically touches a
+ * single cache line. A separate byte array stores the probe distance for each
+ * slot. Because elements that are far from their home slot take the place of
+ * elements that are closer to theirs, lookups can stop as soon as they
+ * encounter a slot with a smaller probe distance than the current one. */
 struct ecs_map_t {
-    ecs_bucket_t *buckets;
-    int32_t elem_size;
-    int32_t bucket_count;
-    int32_t count;
+    void *slots;            /* Key + payload for each slot */
+    uint8_t *dist;          /* Probe distance + 1 for each slot, 0 if empty */
+    int32_t elem_size;      /* Size of payload */
+    int32_t slot_size;      /* Size of key + aligned payload */
+    int32_t bucket_count;   /* Number of slots, always a power of 2 */
+    int32_t shift;          /* 32 - log2(bucket_count), used by get_home */
+    int32_t count;          /* Number of elements in map */
 };
 
 /* Get bucket count for number of elements */
@@ -28,160 +40,118 @@ int32_t get_bucket_count(
     return ecs_next_pow_of_2((int32_t)((float)element_count * LOAD_FACTOR));
 }
 
-/* Get bucket index for provided map key */
-static
-int32_t get_bucket_id(
-    int32_t bucket_count,
-    ecs_map_key_t key) 
-{
-    ecs_assert(bucket_count > 0, ECS_INTERNAL_ERROR, NULL);
-    int32_t result = (int32_t)(key & ((uint64_t)bucket_count - 1));
-    ecs_assert(result < INT32_MAX, ECS_INTERNAL_ERROR, NULL);
-    return result;
-}
-
-/* Get bucket for key */
+/* Get home slot for provided map key. All 64 bits of the key are mixed with a
+ * multiplicative (Fibonacci) hash, of which the upper bits select the slot. 
+ * This spreads sequential ids (entities, tables) evenly, as well as keys that
+ * only differ in their upper half (like traits or keys that combine two ids).*/
 static
-ecs_bucket_t* get_bucket(
+int32_t get_home(
     const ecs_map_t *map,
     ecs_map_key_t key)
 {
-    int32_t bucket_count = map->bucket_count;
-    if (!bucket_count) {
-        return NULL;
-    }
-
-    int32_t bucket_id = get_bucket_id(bucket_count, key);
-    ecs_assert(bucket_id < bucket_count, ECS_INTERNAL_ERROR, NULL);
-
-    return &map->buckets[bucket_id];
-}
-
-/* Ensure that map has at least new_count buckets */
-static
-void ensure_buckets(
-    ecs_map_t *map,
-    int32_t new_count)
-{
-    int32_t bucket_count = map->bucket_count;
-    new_count = ecs_next_pow_of_2(new_count);
-    if (new_count && new_count > bucket_count) {
-        map->buckets = ecs_os_realloc(map->buckets, new_count * ECS_SIZEOF(ecs_bucket_t));
-        map->bucket_count = new_count;
-
-        ecs_os_memset(
-            ECS_OFFSET(map->buckets, bucket_count * ECS_SIZEOF(ecs_bucket_t)), 
-            0, (new_count - bucket_count) * ECS_SIZEOF(ecs_bucket_t));
-    }
-}
-
-/* Free contents of bucket */
-static
-void clear_bucket(
-    ecs_bucket_t *bucket)
-{
-    ecs_os_free(bucket->keys);
-    ecs_os_free(bucket->payload);
-    bucket->keys = NULL;
-    bucket->payload = NULL;
-    bucket->count = 0;
+    ecs_assert(map->bucket_count > 0, ECS_INTERNAL_ERROR, NULL);
+    uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+    return (int32_t)((hash >> 32) >> map->shift);
 }
 
-/* Clear all buckets */
+/* Scratch slots at the end of the slot array, used when swapping elements */
 static
-void clear_buckets(
-    ecs_map_t *map)
+void* get_scratch(
+    const ecs_map_t *map,
+    int32_t index)
 {
-    ecs_bucket_t *buckets = map->buckets;
-    int32_t i, count = map->bucket_count;
-    for (i = 0; i < count; i ++) {
-        clear_bucket(&buckets[i]);
-    }
-    ecs_os_free(buckets);
-    map->buckets = NULL;
-    map->bucket_count = 0;
+    return GET_SLOT(map, map->bucket_count + index);
 }
 
-/* Find or create bucket for specified key */
+/* Find slot for key, returns -1 if key is not in map */
 static
-ecs_bucket_t* ensure_bucket(
-    ecs_map_t *map,
+int32_t find_slot(
+    const ecs_map_t *map,
     ecs_map_key_t key)
 {
-    if (!map->bucket_count) {
-        ensure_buckets(map, 2);
+    if (!map->count) {
+        return -1;
     }
 
-    int32_t bucket_id = get_bucket_id(map->bucket_count, key);
-    ecs_assert(bucket_id >= 0, ECS_INTERNAL_ERROR, NULL);
-    return &map->buckets[bucket_id];
-}
-
-/* Add element to bucket */
-static
-int32_t add_to_bucket(
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
-    ecs_map_key_t key,
-    const void *payload)
-{
-    int32_t index = bucket->count ++;
-    int32_t bucket_count = index + 1;
+    int32_t mask = map->bucket_count - 1;
+    int32_t index = get_home(map, key);
+    int32_t dist = 1;
+    uint8_t *dist_array = map->dist;
+
+    for (;;) {
+        int32_t slot_dist = dist_array[index];
+        if (slot_dist < dist) {
+            /* Slot is empty or the element in the slot is closer to its home
+             * than key would be, so key can't be further down */
+            return -1;
+        }
 
-    bucket->keys = ecs_os_realloc(bucket->keys, KEY_SIZE * bucket_count);
-    bucket->payload = ecs_os_realloc(bucket->payload, elem_size * bucket_count);
-    bucket->keys[index] = key;
+        if (slot_dist == dist && GET_KEY(map, index) == key) {
+            return index;
+        }
 
-    if (payload) {
-        void *elem = GET_ELEM(bucket->payload, elem_size, index);
-        ecs_os_memcpy(elem, payload, elem_size);
+        index = (index + 1) & mask;
+        if (dist < MAX_DIST) {
+            dist ++;
+        }
     }
-
-    return index;
 }
 
-/*  Remove element from bucket */
+/* Insert slot contents (key + payload) in map. Key must not be in the map.
+ * Returns the slot in which the element is stored. */
 static
-void remove_from_bucket(
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
-    ecs_map_key_t key,
-    int32_t index)
+int32_t insert_slot(
+    ecs_map_t *map,
+    void *slot)
 {
-    (void)key;
-
-    ecs_assert(bucket->count != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(index < bucket->count, ECS_INTERNAL_ERROR, NULL);
-    
-    int32_t bucket_count = -- bucket->count;
-
-    if (index != bucket->count) {
-        ecs_assert(key == bucket->keys[index], ECS_INTERNAL_ERROR, NULL);
-        bucket->keys[index] = bucket->keys[bucket_count];
-
-        ecs_map_key_t *elem = GET_ELEM(bucket->payload, elem_size, index);
-        ecs_map_key_t *last_elem = GET_ELEM(bucket->payload, elem_size, bucket->count);
-
-        ecs_os_memcpy(elem, last_elem, elem_size);
+    ecs_size_t slot_size = map->slot_size;
+    ecs_map_key_t key = *(ecs_map_key_t*)slot;
+
+    /* cur holds the element that is being inserted, tmp is used for swapping */
+    void *cur = get_scratch(map, 0);
+    void *tmp = get_scratch(map, 1);
+    if (slot != cur) {
+        ecs_os_memcpy(cur, slot, slot_size);
     }
-}
 
-/* Get payload pointer for key from bucket */
-static
-void* get_from_bucket(
-    ecs_bucket_t *bucket,
-    ecs_map_key_t key,
-    ecs_size_t elem_size)
-{
-    ecs_map_key_t *keys = bucket->keys;
-    int32_t i, count = bucket->count;
+    int32_t mask = map->bucket_count - 1;
+    int32_t index = get_home(map, key);
+    int32_t dist = 1, result = -1;
+    uint8_t *dist_array = map->dist;
+
+    for (;;) {
+        int32_t slot_dist = dist_array[index];
+        if (!slot_dist) {
+            ecs_os_memcpy(GET_SLOT(map, index), cur, slot_size);
+            dist_array[index] = (uint8_t)dist;
+            if (result == -1) {
+                result = index;
+            }
+            break;
+        }
+
+        if (slot_dist < dist) {
+            /* Element in slot is closer to its home, take its place and find
+             * a new slot for the displaced element. */
+            void *elem = GET_SLOT(map, index);
+            ecs_os_memcpy(tmp, elem, slot_size);
+            ecs_os_memcpy(elem, cur, slot_size);
+            ecs_os_memcpy(cur, tmp, slot_size);
+            dist_array[index] = (uint8_t)dist;
+            dist = slot_dist;
+
+            if (result == -1) {
+                result = index;
+            }
+        }
 
-    for (i = 0; i < count; i ++) {
-        if (keys[i] == key) {
-            return GET_ELEM(bucket->payload, elem_size, i);
+        index = (index + 1) & mask;
+        if (dist < MAX_DIST) {
+            dist ++;
         }
     }
-    return NULL;
+
+    return result;
 }
 
 /* Grow number of buckets */
@@ -192,51 +162,49 @@ void rehash(
 {
     ecs_assert(bucket_count != 0, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(bucket_count > map->bucket_count, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(bucket_count == ecs_next_pow_of_2(bucket_count),
+        ECS_INTERNAL_ERROR, NULL);
+
+    void *old_slots = map->slots;
+    uint8_t *old_dist = map->dist;
+    int32_t i, old_bucket_count = map->bucket_count;
+    ecs_size_t slot_size = map->slot_size;
+
+    /* Slots, two scratch slots and the distance array share one allocation */
+    map->slots = ecs_os_malloc((bucket_count + 2) * slot_size + bucket_count);
+    map->dist = ECS_OFFSET(map->slots, (bucket_count + 2) * slot_size);
+    map->bucket_count = bucket_count;
+    ecs_os_memset(map->dist, 0, bucket_count);
+
+    int32_t bits = 0;
+    while ((1 << bits) < bucket_count) {
+        bits ++;
+    }
+    map->shift = 32 - bits;
 
-    ecs_size_t elem_size = map->elem_size;
-
-    ensure_buckets(map, bucket_count);
-
-    ecs_bucket_t *buckets = map->buckets;
-    ecs_assert(buckets != NULL, ECS_INTERNAL_ERROR, NULL);
-    
-    int32_t bucket_id;
-
-    /* Iterate backwards as elements could otherwise be moved to existing
-        * buckets which could temporarily cause the number of elements in a
-        * bucket to exceed BUCKET_COUNT. */
-    for (bucket_id = bucket_count - 1; bucket_id >= 0; bucket_id --) {
-        ecs_bucket_t *bucket = &buckets[bucket_id];
-
-        int i, count = bucket->count;
-        ecs_map_key_t *key_array = bucket->keys;
-        void *payload_array = bucket->payload;
-
-        for (i = 0; i < count; i ++) {
-            ecs_map_key_t key = key_array[i];
-            void *elem = GET_ELEM(payload_array, elem_size, i);
-            int32_t new_bucket_id = get_bucket_id(bucket_count, key);
-
-            if (new_bucket_id != bucket_id) {
-                ecs_bucket_t *new_bucket = &buckets[new_bucket_id];
-
-                add_to_bucket(new_bucket, elem_size, key, elem);
-                remove_from_bucket(bucket, elem_size, key, i);
-
-                count --;
-                i --;
-            }
-        }
-
-        if (!bucket->count) {
-            clear_bucket(bucket);
+    for (i = 0; i < old_bucket_count; i ++) {
+        if (old_dist[i]) {
+            insert_slot(map, ECS_OFFSET(old_slots, i * slot_size));
         }
     }
+
+    ecs_os_free(old_slots);
+}
+
+/* Free storage of map */
+static
+void clear_buckets(
+    ecs_map_t *map)
+{
+    ecs_os_free(map->slots);
+    map->slots = NULL;
+    map->dist = NULL;
+    map->bucket_count = 0;
 }
 
 ecs_map_t* _ecs_map_new(
     ecs_size_t elem_size,
-    ecs_size_t alignment, 
+    ecs_size_t alignment,
     int32_t element_count)
 {
     (void)alignment;
@@ -248,8 +216,11 @@ ecs_map_t* _ecs_map_new(
 
     result->count = 0;
     result->elem_size = elem_size;
+    result->slot_size = KEY_SIZE + ECS_ALIGN(elem_size, KEY_SIZE);
 
-    ensure_buckets(result, bucket_count);
+    if (bucket_count) {
+        rehash(result, bucket_count);
+    }
 
     return result;
 }
@@ -276,12 +247,12 @@ void* _ecs_map_get(
 
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
+    int32_t index = find_slot(map, key);
+    if (index == -1) {
         return NULL;
     }
 
-    return get_from_bucket(bucket, key, elem_size);
+    return GET_ELEM(map, index);
 }
 
 void* _ecs_map_get_ptr(
@@ -306,7 +277,6 @@ void * _ecs_map_ensure(
     if (!result) {
         result = _ecs_map_set(map, elem_size, key, NULL);
         ecs_assert(result != NULL, ECS_INTERNAL_ERROR, NULL);
-        ecs_os_memset(result, 0, elem_size);
     }
 
     return result;
@@ -321,30 +291,37 @@ void* _ecs_map_set(
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = ensure_bucket(map, key);
-    ecs_assert(bucket != NULL, ECS_INTERNAL_ERROR, NULL);
-
-    void *elem = get_from_bucket(bucket, key, elem_size);
-    if (!elem) {
-        int32_t index = add_to_bucket(bucket, elem_size, key, payload);
-        
-        int32_t map_count = ++map->count;
-        int32_t target_bucket_count = get_bucket_count(map_count);
-        int32_t map_bucket_count = map->bucket_count;
-
-        if (target_bucket_count > map_bucket_count) {
-            rehash(map, target_bucket_count);
-            bucket = ensure_bucket(map, key);
-            return get_from_bucket(bucket, key, elem_size);
-        } else {
-            return GET_ELEM(bucket->payload, elem_size, index);
-        }       
-    } else {
+    int32_t index = find_slot(map, key);
+    if (index != -1) {
+        void *elem = GET_ELEM(map, index);
         if (payload) {
             ecs_os_memcpy(elem, payload, elem_size);
         }
         return elem;
     }
+
+    int32_t target_bucket_count = get_bucket_count(map->count + 1);
+    if (target_bucket_count < 2) {
+        target_bucket_count = 2;
+    }
+
+    if (target_bucket_count > map->bucket_count) {
+        rehash(map, target_bucket_count);
+    }
+
+    /* Prepare element in scratch slot so it can be moved in one go */
+    void *slot = get_scratch(map, 0);
+    *(ecs_map_key_t*)slot = key;
+    if (payload) {
+        ecs_os_memcpy(ECS_OFFSET(slot, KEY_SIZE), payload, elem_size);
+    } else {
+        ecs_os_memset(ECS_OFFSET(slot, KEY_SIZE), 0, elem_size);
+    }
+
+    index = insert_slot(map, slot);
+    map->count ++;
+
+    return GET_ELEM(map, index);
 }
 
 void ecs_map_remove(
@@ -353,18 +330,37 @@ void ecs_map_remove(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
+    int32_t index = find_slot(map, key);
+    if (index == -1) {
         return;
     }
 
-    int32_t i, bucket_count = bucket->count;
-    for (i = 0; i < bucket_count; i ++) {
-        if (bucket->keys[i] == key) {
-            remove_from_bucket(bucket, map->elem_size, key, i);
-            map->count --;
+    /* Shift back elements that are not in their home slot, so that lookups
+     * don't need tombstones to find them */
+    int32_t mask = map->bucket_count - 1;
+    int32_t next = (index + 1) & mask;
+    uint8_t *dist_array = map->dist;
+
+    while (dist_array[next] > 1) {
+        ecs_os_memcpy(GET_SLOT(map, index), GET_SLOT(map, next),
+            map->slot_size);
+
+        int32_t dist = dist_array[next];
+        if (dist == MAX_DIST) {
+            /* Stored distance is clamped, compute the actual distance */
+            dist = ((next - get_home(map, GET_KEY(map, index))) & mask) + 1;
+            if (dist > MAX_DIST) {
+                dist = MAX_DIST + 1;
+            }
         }
-    } 
+
+        dist_array[index] = (uint8_t)(dist - 1);
+        index = next;
+        next = (next + 1) & mask;
+    }
+
+    dist_array[index] = 0;
+    map->count --;
 }
 
 int32_t ecs_map_count(
@@ -392,9 +388,7 @@ ecs_map_iter_t ecs_map_iter(
 {
     return (ecs_map_iter_t){
         .map = map,
-        .bucket = NULL,
-        .bucket_index = 0,
-        .element_index = 0
+        .index = 0
     };
 }
 
@@ -407,42 +401,29 @@ void* _ecs_map_next(
     if (!map) {
         return NULL;
     }
-    
+
     ecs_assert(!elem_size || elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
- 
-    ecs_bucket_t *bucket = iter->bucket;
-    int32_t element_index = iter->element_index;
-    elem_size = map->elem_size;
-
-    do {
-        if (!bucket) {
-            int32_t bucket_index = iter->bucket_index;
-            ecs_bucket_t *buckets = map->buckets;
-            if (bucket_index < map->bucket_count) {
-                bucket = &buckets[bucket_index];
-                iter->bucket = bucket;
-
-                element_index = 0;
-                iter->element_index = 0;
-            } else {
-                return NULL;
-            }
-        }
+    (void)elem_size;
+
+    int32_t index = iter->index, bucket_count = map->bucket_count;
+    uint8_t *dist_array = map->dist;
+
+    while (index < bucket_count && !dist_array[index]) {
+        index ++;
+    }
+
+    if (index >= bucket_count) {
+        iter->index = index;
+        return NULL;
+    }
+
+    iter->index = index + 1;
 
-        if (element_index < bucket->count) {
-            iter->element_index = element_index + 1;
-            break;
-        } else {
-            bucket = NULL;
-            iter->bucket_index ++;
-        }
-    } while (true);
-    
     if (key_out) {
-        *key_out = bucket->keys[element_index];
+        *key_out = GET_KEY(map, index);
     }
 
-    return GET_ELEM(bucket->payload, elem_size, element_index);
+    return GET_ELEM(map, index);
 }
 
 void* _ecs_map_next_ptr(
@@ -458,7 +439,7 @@ void* _ecs_map_next_ptr(
 }
 
 void ecs_map_grow(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -471,19 +452,19 @@ void ecs_map_grow(
 }
 
 void ecs_map_set_size(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
-{    
+{
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     int32_t bucket_count = get_bucket_count(element_count);
 
-    if (bucket_count) {
+    if (bucket_count > map->bucket_count) {
         rehash(map, bucket_count);
     }
 }
 
 void ecs_map_memory(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t *allocd,
     int32_t *used)
 {
@@ -496,13 +477,9 @@ void ecs_map_memory(
     if (allocd) {
         *allocd += ECS_SIZEOF(ecs_map_t);
 
-        int i, bucket_count = map->bucket_count;
-        for (i = 0; i < bucket_count; i ++) {
-            ecs_bucket_t *bucket = &map->buckets[i];
-            *allocd += KEY_SIZE * bucket->count;
-            *allocd += map->elem_size * bucket->count;
+        int32_t bucket_count = map->bucket_count;
+        if (bucket_count) {
+            *allocd += (bucket_count + 2) * map->slot_size + bucket_count;
         }
-
-        *allocd += ECS_SIZEOF(ecs_bucket_t) * bucket_count;
     }
 }
@@ -10,8 +10,23 @@ static ECS_CTOR(EcsPipelineQuery, ptr, {
     memset(ptr, 0, _size);
 })
 
+static
+void free_deps(
+    ecs_map_t *deps)
+{
+    ecs_map_iter_t it = ecs_map_iter(deps);
+    ecs_vector_t *v;
+    while ((v = ecs_map_next_ptr(&it, ecs_vector_t*, NULL))) {
+        ecs_vector_free(v);
+    }
+    ecs_map_free(deps);
+}
+
 static ECS_DTOR(EcsPipelineQuery, ptr, {
     ecs_vector_free(ptr->ops);
+    if (ptr->deps) {
+        free_deps(ptr->deps);
+    }
 })
 
 static
@@ -167,6 +182,150 @@ bool check_column(
     return false;
 }
 
+/* -- System dependencies -- 
+ * Systems in the same merge segment run concurrently on worker threads, unless
+ * they access the same component and one of them writes it. In that case the
+ * system that comes later in the pipeline depends on the earlier one, and won't
+ * start before all of its jobs have finished. */
+
+typedef struct system_access_t {
+    ecs_entity_t component;
+    bool write;
+} system_access_t;
+
+typedef struct system_deps_t {
+    ecs_entity_t system;
+    ecs_vector_t *access;       /* system_access_t */
+    bool exclusive;             /* Depends on / is dependency of all systems */
+} system_deps_t;
+
+static
+void add_access(
+    system_deps_t *sd,
+    ecs_entity_t component,
+    ecs_sig_inout_kind_t inout_kind)
+{
+    system_access_t *elem = ecs_vector_add(&sd->access, system_access_t);
+    elem->component = component;
+    elem->write = inout_kind != EcsIn;
+}
+
+static
+void get_system_access(
+    ecs_query_t *query,
+    system_deps_t *sd)
+{
+    bool has_data = false;
+
+    ecs_vector_each(query->sig.columns, ecs_sig_column_t, column, {
+        if (column->from_kind == EcsFromEmpty || 
+            column->oper_kind == EcsOperNot) 
+        {
+            continue;
+        }
+
+        if (column->oper_kind == EcsOperOr) {
+            ecs_vector_each(column->is.type, ecs_entity_t, c_ptr, {
+                add_access(sd, *c_ptr, column->inout_kind);
+            });
+        } else {
+            add_access(sd, column->is.component, column->inout_kind);
+        }
+
+        has_data = true;
+    });
+
+    /* Systems without columns (tasks) may access anything */
+    sd->exclusive = !has_data;
+}
+
+static
+bool component_overlaps(
+    ecs_entity_t c1,
+    ecs_entity_t c2)
+{
+    if (c1 == c2 || c1 == EcsWildcard || c2 == EcsWildcard) {
+        return true;
+    }
+
+    /* Traits may contain wildcards, so compare their individual parts */
+    if ((c1 | c2) & ECS_ROLE_MASK) {
+        uint32_t c1_lo = ecs_entity_t_lo(c1), c1_hi = ecs_entity_t_hi(c1 & ECS_COMPONENT_MASK);
+        uint32_t c2_lo = ecs_entity_t_lo(c2), c2_hi = ecs_entity_t_hi(c2 & ECS_COMPONENT_MASK);
+        
+        if (c1_lo == EcsWildcard || c2_lo == EcsWildcard || c1_lo == c2_lo) {
+            return true;
+        }
+
+        if ((c1_hi && (c1_hi == c2_lo || c1_hi == c2_hi)) ||
+            (c2_hi && c2_hi == c1_lo)) 
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static
+bool systems_conflict(
+    system_deps_t *sd1,
+    system_deps_t *sd2)
+{
+    if (sd1->exclusive || sd2->exclusive) {
+        return true;
+    }
+
+    ecs_vector_each(sd1->access, system_access_t, a1, {
+        ecs_vector_each(sd2->access, system_access_t, a2, {
+            if ((a1->write || a2->write) && 
+                component_overlaps(a1->component, a2->component)) 
+            {
+                return true;
+            }
+        });
+    });
+
+    return false;
+}
+
+static
+void clear_segment(
+    ecs_vector_t *segment)
+{
+    ecs_vector_each(segment, system_deps_t, sd, {
+        ecs_vector_free(sd->access);
+    });
+    ecs_vector_clear(segment);
+}
+
+/* Add system to segment, and store systems it depends on in the deps map */
+static
+void add_to_segment(
+    ecs_map_t *deps,
+    ecs_vector_t **segment,
+    ecs_entity_t system,
+    ecs_query_t *query)
+{
+    system_deps_t sd = { .system = system };
+    get_system_access(query, &sd);
+
+    ecs_vector_t *depends_on = NULL;
+    ecs_vector_each(*segment, system_deps_t, prev, {
+        if (systems_conflict(prev, &sd)) {
+            ecs_entity_t *e = ecs_vector_add(&depends_on, ecs_entity_t);
+            *e = prev->system;
+        }
+    });
+
+    if (depends_on) {
+        ecs_map_set(deps, system, &depends_on);
+    }
+
+    system_deps_t *elem = ecs_vector_add(segment, system_deps_t);
+    *elem = sd;
+}
+
 static
 bool build_pipeline(
     ecs_world_t *world,
@@ -200,6 +359,13 @@ bool build_pipeline(
         ecs_vector_free(pq->ops);
     }
 
+    if (pq->deps) {
+        free_deps(pq->deps);
+    }
+
+    ecs_map_t *deps = ecs_map_new(ecs_vector_t*, 0);
+    ecs_vector_t *segment = NULL;
+
     /* Iterate systems in pipeline, add ops for running / merging */
     ecs_iter_t it = ecs_query_iter(query);
     while (ecs_query_next(&it)) {
@@ -223,6 +389,7 @@ bool build_pipeline(
             if (needs_merge) {
                 /* After merge all components will be merged, so reset state */
                 reset_write_state(&ws);
+                clear_segment(segment);
                 op = NULL;
 
                 /* Re-evaluate columns to set write flags if system is active.
@@ -249,15 +416,19 @@ bool build_pipeline(
              * the query used to run the pipeline. */
             if (is_active) {
                 op->count ++;
+                add_to_segment(deps, &segment, it.entities[i], q);
             }
         }
     }
 
     ecs_map_free(ws.components);
+    clear_segment(segment);
+    ecs_vector_free(segment);
 
     /* Force sort of query as this could increase the match_count */
     pq->match_count = pq->query->match_count;
     pq->ops = ops;
+    pq->deps = deps;
 
     return true;
 }
@@ -364,6 +535,12 @@ void ecs_pipeline_progress(
             ecs_run_intern(world, stage, e, &sys[i], delta_time, 0, 0, 
                 NULL, NULL, false);
 
+            /* If the system was not ran (for example because its timer did not
+             * fire) make sure it doesn't block systems that depend on it. */
+            if (world != stage->world) {
+                ecs_worker_skip_jobs(world, e);
+            }
+
             ran_since_merge ++;
             world->stats.systems_ran_frame ++;
 
@@ -376,7 +553,7 @@ void ecs_pipeline_progress(
                  * current position (system). If there are a lot of systems
                  * in the pipeline this can be an expensive operation, but
                  * should happen infrequently. */
-                if (ecs_worker_sync(world)) {
+                if (ecs_worker_sync(world, stage)) {
                     i = iter_reset(pq, &it, &op, e);
                     op_last = ecs_vector_last(pq->ops, ecs_pipeline_op_t);
                     sys = ecs_column(&it, EcsSystem, 1);
@@ -385,7 +562,7 @@ void ecs_pipeline_progress(
         }
     }
 
-    ecs_worker_end(world);
+    ecs_worker_end(world, stage);
 }
 
 static
@@ -472,6 +649,7 @@ void EcsOnAddPipeline(
         pq->build_query = build_query;
         pq->match_count = -1;
         pq->ops = NULL;
+        pq->deps = NULL;
 
         ecs_log_pop();
     }
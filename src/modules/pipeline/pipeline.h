@@ -12,11 +12,49 @@ typedef struct ecs_pipeline_op_t {
     int32_t count;              /**< Number of systems to run before merge */
 } ecs_pipeline_op_t;
 
+/** A range of entities from a single query result that is part of a job. The
+ * fields correspond with the iterator fields that are set by ecs_query_next, so
+ * that a worker can run a fragment without having to iterate the query. */
+typedef struct ecs_job_fragment_t {
+    ecs_iter_table_t *table;    /**< Table data for iterator */
+    void *table_columns;        /**< Table component data */
+    ecs_entity_t *entities;     /**< First entity of fragment */
+    int32_t offset;             /**< Offset relative to current table */
+    int32_t count;              /**< Number of entities in fragment */
+    int32_t total_count;        /**< Total number of entities in result */
+    int32_t frame_offset;       /**< Offset relative to frame */
+} ecs_job_fragment_t;
+
+/** Jobs owned by a single worker. The worker pops jobs from the head of the
+ * deque, while workers that ran out of jobs steal from the tail. */
+typedef struct ecs_job_deque_t {
+    ecs_os_mutex_t lock;
+    int32_t head;
+    int32_t tail;
+} ecs_job_deque_t;
+
+/** Jobs for a system that is ran on multiple threads. The first worker that
+ * runs the system builds the job list, which is then shared by all workers. */
+typedef struct ecs_job_queue_t {
+    ecs_os_mutex_t lock;        /**< Guards building the job list */
+    ecs_os_cond_t done_cond;    /**< Signalled when all jobs have finished */
+    bool built;                 /**< Is job list built for current frame */
+    int32_t job_count;          /**< Number of jobs, -1 until list is built */
+    int32_t jobs_done;          /**< Number of finished jobs */
+    ecs_vector_t *depends_on;   /**< Queues that must finish before this one */
+    ecs_vector_t *results;      /**< Query results used to build jobs */
+    ecs_vector_t *fragments;    /**< Fragments ordered by job */
+    ecs_vector_t *jobs;         /**< Index of first fragment per job */
+    ecs_job_deque_t *deques;    /**< One deque per worker */
+    int32_t deque_count;
+} ecs_job_queue_t;
+
 typedef struct EcsPipelineQuery {
     ecs_query_t *query;
     ecs_query_t *build_query;
     int32_t match_count;
     ecs_vector_t *ops;
+    ecs_map_t *deps;            /**< Systems that a system depends on */
 } EcsPipelineQuery;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -48,12 +86,22 @@ void ecs_worker_begin(
     ecs_world_t *world);
 
 bool ecs_worker_sync(
-    ecs_world_t *world);
+    ecs_world_t *world,
+    ecs_stage_t *stage);
 
 void ecs_worker_end(
-    ecs_world_t *world);
+    ecs_world_t *world,
+    ecs_stage_t *stage);
 
 void ecs_workers_progress(
     ecs_world_t *world);
 
+void ecs_workers_prepare_jobs(
+    ecs_world_t *world,
+    ecs_entity_t pipeline);
+
+void ecs_worker_skip_jobs(
+    ecs_world_t *world,
+    ecs_entity_t system);
+
 #endif
@@ -4,6 +4,45 @@
 
 #include "pipeline.h"
 
+/* Wait until the main thread flips the sync sense. Threads poll the sense
+ * first, as the main thread is usually only briefly busy merging, and block on
+ * worker_cond when the wait takes longer than the spin count. */
+static
+void wait_for_release(
+    ecs_world_t *world,
+    int32_t sense)
+{
+    int32_t i, spin_count = world->sync_spin_count;
+    for (i = 0; i < spin_count; i ++) {
+        if (ecs_os_aload(&world->sync_sense) != sense) {
+            return;
+        }
+    }
+
+    /* The parked counter is incremented before the sense is tested again, so
+     * that either this thread observes the new sense, or the main thread
+     * observes the parked thread and wakes it up. */
+    ecs_os_mutex_lock(world->sync_mutex);
+    ecs_os_ainc(&world->workers_parked);
+    while (ecs_os_aload(&world->sync_sense) == sense) {
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+    }
+    ecs_os_adec(&world->workers_parked);
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
+/* Wake up the main thread if it stopped spinning on a sync counter */
+static
+void wake_main(
+    ecs_world_t *world)
+{
+    if (ecs_os_aload(&world->main_parked)) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        ecs_os_cond_signal(world->sync_cond);
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
+}
+
 /* Worker thread */
 static
 void* worker(void *arg) {
@@ -11,15 +50,12 @@ void* worker(void *arg) {
     ecs_world_t *world = thread->world;
 
     /* Start worker thread, increase counter so main thread knows how many
-     * workers are ready */
-    ecs_os_mutex_lock(world->sync_mutex);
-    world->workers_running ++;
-
-    if (!world->quit_workers) {
-        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    }
-
-    ecs_os_mutex_unlock(world->sync_mutex);
+     * workers are ready. The sense is read before the counter is increased, so
+     * that the worker can't miss the first release. */
+    int32_t sense = ecs_os_aload(&world->sync_sense);
+    ecs_os_ainc(&world->workers_running);
+    wake_main(world);
+    wait_for_release(world, sense);
 
     while (!world->quit_workers) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)thread, 0);
@@ -30,9 +66,7 @@ void* worker(void *arg) {
         ecs_set_scope((ecs_world_t*)thread, old_scope);
     }
 
-    ecs_os_mutex_lock(world->sync_mutex);
-    world->workers_running --;
-    ecs_os_mutex_unlock(world->sync_mutex);
+    ecs_os_adec(&world->workers_running);
 
     return NULL;
 }
@@ -57,6 +91,7 @@ void start_workers(
         thread->world = world;
         thread->thread = 0;
         thread->index = i;
+        thread->sync_wait_time = 0;
 
         thread->stage = ecs_vector_add(&world->worker_stages, ecs_stage_t);
         ecs_stage_init(world, thread->stage);
@@ -68,76 +103,511 @@ void start_workers(
     }
 }
 
+/* Wait until a counter that is incremented by the workers reaches the number
+ * of workers. The main thread polls the counter first, and blocks on sync_cond
+ * when the wait takes longer than the spin count. main_parked is set before 
+ * the counter is tested again, so that either the main thread observes the
+ * last increment, or the last worker observes that it has to wake it up. */
+static
+void wait_for_counter(
+    ecs_world_t *world,
+    int32_t *counter)
+{
+    int32_t thread_count = ecs_vector_count(world->workers);
+
+    int32_t i, spin_count = world->sync_spin_count;
+    for (i = 0; i < spin_count; i ++) {
+        if (ecs_os_aload(counter) == thread_count) {
+            return;
+        }
+    }
+
+    ecs_os_mutex_lock(world->sync_mutex);
+    ecs_os_astore(&world->main_parked, 1);
+    while (ecs_os_aload(counter) != thread_count) {
+        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+    }
+    ecs_os_astore(&world->main_parked, 0);
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
 /* Wait until all workers are running */
 static
 void wait_for_workers(
     ecs_world_t *world)
+{
+    wait_for_counter(world, &world->workers_running);
+}
+
+/* Synchronize worker threads. If measure is true, the time spent waiting is
+ * added to the wait time of the thread. */
+static
+void sync_worker(
+    ecs_world_t *world,
+    ecs_thread_t *thread,
+    bool measure)
 {
     int32_t thread_count = ecs_vector_count(world->workers);
-    bool wait = true;
 
     do {
-        ecs_os_mutex_lock(world->sync_mutex);
-        if (world->workers_running == thread_count) {
-            wait = false;
+        ecs_time_t start = {0};
+        if (measure) {
+            ecs_time_measure(&start);
         }
-        ecs_os_mutex_unlock(world->sync_mutex);
-    } while (wait);
+
+        /* Read the sense before signalling that the thread is waiting. Once
+         * the last thread arrives, the main thread may flip it at any time. */
+        int32_t sense = ecs_os_aload(&world->sync_sense);
+
+        /* Signal that thread is waiting. Only wake up main thread when all 
+         * threads are waiting. */
+        if (ecs_os_ainc(&world->workers_waiting) == thread_count) {
+            wake_main(world);
+        }
+
+        /* Wait until main thread signals that thread can continue */
+        wait_for_release(world, sense);
+
+        /* The main thread only reads the wait time while all workers are 
+         * waiting on a sync point, so it can be updated without locking */
+        if (measure) {
+            thread->sync_wait_time += (FLECS_FLOAT)ecs_time_measure(&start);
+        }
+
+        /* The main thread may release workers to copy component values for a
+         * parallel merge before they continue with the pipeline */
+        if (!world->merge_writes) {
+            break;
+        }
+
+        ecs_deferred_writes_apply(world, thread->index);
+    } while (true);
 }
 
-/* Synchronize worker threads */
+/* Wait until all threads are waiting on sync point */
 static
-void sync_worker(
+void wait_for_sync(
     ecs_world_t *world)
 {
-    int32_t thread_count = ecs_vector_count(world->workers);
+    ecs_time_t start = {0};
+    if (world->measure_frame_time) {
+        ecs_time_measure(&start);
+    }
 
-    /* Signal that thread is waiting */
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (++ world->workers_waiting == thread_count) {
-        /* Only signal main thread when all threads are waiting */
-        ecs_os_cond_signal(world->sync_cond);
+    wait_for_counter(world, &world->workers_waiting);
+
+    if (world->measure_frame_time) {
+        FLECS_FLOAT wait_time = (FLECS_FLOAT)ecs_time_measure(&start);
+        ecs_vector_each(world->workers, ecs_thread_t, thr, {
+            wait_time += thr->sync_wait_time;
+            thr->sync_wait_time = 0;
+        });
+        world->stats.sync_wait_time_total += wait_time;
     }
+}
 
-    /* Wait until main thread signals that thread can continue */
-    ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    ecs_os_mutex_unlock(world->sync_mutex);
+/* Signal workers that they can start/resume work */
+static
+void signal_workers(
+    ecs_world_t *world)
+{
+    /* Reset the counter before flipping the sense, as released workers may
+     * immediately arrive at the next sync point */
+    ecs_os_astore(&world->workers_waiting, 0);
+    ecs_os_astore(&world->sync_sense, !ecs_os_aload(&world->sync_sense));
+
+    if (ecs_os_aload(&world->workers_parked)) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        ecs_os_cond_broadcast(world->worker_cond);
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
 }
 
-/* Wait until all threads are waiting on sync point */
+/* Copy component values of deferred set operations on all threads */
 static
-void wait_for_sync(
+void merge_writes(
     ecs_world_t *world)
 {
+    ecs_time_t start = {0};
+    if (world->measure_frame_time) {
+        ecs_time_measure(&start);
+    }
+
+    /* Writes are divided before the workers are released, so that each thread
+     * only visits its own writes. Main thread takes the last partition. */
     int32_t thread_count = ecs_vector_count(world->workers);
+    ecs_deferred_writes_partition(world, thread_count + 1);
+    world->merge_writes = true;
+    signal_workers(world);
+    ecs_deferred_writes_apply(world, thread_count);
+    wait_for_sync(world);
+    world->merge_writes = false;
 
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (world->workers_waiting != thread_count) {
-        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+    /* Run OnSet systems in the order in which values were set */
+    ecs_deferred_writes_end(world);
+
+    if (world->measure_frame_time) {
+        world->stats.merge_time_total += (FLECS_FLOAT)ecs_time_measure(&start);
     }
-    
-    /* We should have been signalled unless all workers are waiting on sync */
-    ecs_assert(world->workers_waiting == thread_count, 
-        ECS_INTERNAL_ERROR, NULL);
+}
 
-    ecs_os_mutex_unlock(world->sync_mutex);
+/* Merge stages. In a parallel merge, the main thread applies the structural
+ * changes of all stages, after which component values of set operations are 
+ * copied by all threads. */
+static
+void merge_stages(
+    ecs_world_t *world)
+{
+    if (!world->parallel_merge || !world->auto_merge) {
+        ecs_staging_end(world);
+        return;
+    }
+
+    world->defer_writes = true;
+    ecs_staging_end(world);
+    world->defer_writes = false;
+
+    if (ecs_vector_count(world->deferred_writes)) {
+        merge_writes(world);
+    }
+
+    /* Values are stored in the arenas of the stages, which are released after
+     * the values have been written */
+    ecs_stage_defer_reset(&world->temp_stage);
+    ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
+        ecs_stage_defer_reset(stage);
+    });
 }
 
-/* Signal workers that they can start/resume work */
+/* -- Job scheduling -- */
+
 static
-void signal_workers(
+ecs_job_queue_t* job_queue_new(
+    int32_t deque_count)
+{
+    ecs_job_queue_t *q = ecs_os_calloc(sizeof(ecs_job_queue_t));
+    ecs_assert(q != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    q->lock = ecs_os_mutex_new();
+    q->done_cond = ecs_os_cond_new();
+    q->job_count = -1;
+    q->deques = ecs_os_calloc(ECS_SIZEOF(ecs_job_deque_t) * deque_count);
+    ecs_assert(q->deques != NULL, ECS_OUT_OF_MEMORY, NULL);
+    q->deque_count = deque_count;
+
+    int32_t i;
+    for (i = 0; i < deque_count; i ++) {
+        q->deques[i].lock = ecs_os_mutex_new();
+    }
+
+    return q;
+}
+
+static
+void job_queue_free(
+    ecs_job_queue_t *q)
+{
+    int32_t i;
+    for (i = 0; i < q->deque_count; i ++) {
+        ecs_os_mutex_free(q->deques[i].lock);
+    }
+
+    ecs_os_cond_free(q->done_cond);
+    ecs_os_mutex_free(q->lock);
+    ecs_vector_free(q->depends_on);
+    ecs_vector_free(q->results);
+    ecs_vector_free(q->fragments);
+    ecs_vector_free(q->jobs);
+    ecs_os_free(q->deques);
+    ecs_os_free(q);
+}
+
+static
+void free_job_queues(
     ecs_world_t *world)
 {
-    ecs_os_mutex_lock(world->sync_mutex);
-    ecs_os_cond_broadcast(world->worker_cond);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    ecs_map_iter_t it = ecs_map_iter(world->worker_jobs);
+    ecs_job_queue_t *q;
+    while ((q = ecs_map_next_ptr(&it, ecs_job_queue_t*, NULL))) {
+        job_queue_free(q);
+    }
+
+    ecs_map_free(world->worker_jobs);
+    world->worker_jobs = NULL;
 }
 
-/** Stop worker threads */
+static
+int32_t job_chunk_size(
+    ecs_world_t *world,
+    int32_t entity_count,
+    int32_t worker_count)
+{
+    int32_t size = world->job_chunk_size;
+    if (!size) {
+        int32_t job_count = worker_count * ECS_MAX_JOBS_PER_WORKER;
+        size = (entity_count + job_count - 1) / job_count;
+        if (size < ECS_MIN_JOB_CHUNK_SIZE) {
+            size = ECS_MIN_JOB_CHUNK_SIZE;
+        }
+    }
+    return size;
+}
+
+static
+void add_job(
+    ecs_job_queue_t *q)
+{
+    int32_t *job = ecs_vector_add(&q->jobs, int32_t);
+    *job = ecs_vector_count(q->fragments);
+}
+
+static
+void add_fragment(
+    ecs_job_queue_t *q,
+    const ecs_job_fragment_t *f)
+{
+    ecs_job_fragment_t *elem = ecs_vector_add(
+        &q->fragments, ecs_job_fragment_t);
+    *elem = *f;
+}
+
+static
+void clear_jobs(
+    ecs_job_queue_t *q)
+{
+    ecs_vector_clear(q->fragments);
+    ecs_vector_clear(q->jobs);
+
+    int32_t i;
+    for (i = 0; i < q->deque_count; i ++) {
+        q->deques[i].head = q->deques[i].tail = 0;
+    }
+}
+
+/* Iterate the query once, and divide up the results in jobs of at most 
+ * chunk_size entities. Large tables are split up in multiple jobs, entities of
+ * small tables are combined into a single job. */
+static
+void build_jobs(
+    ecs_world_t *world,
+    ecs_job_queue_t *q,
+    const ecs_iter_t *it_in)
+{
+    ecs_vector_clear(q->results);
+    clear_jobs(q);
+
+    ecs_iter_t it = *it_in;
+    int32_t entity_count = 0;
+    while (ecs_query_next(&it)) {
+        ecs_job_fragment_t *f = ecs_vector_add(
+            &q->results, ecs_job_fragment_t);
+        f->table = it.table;
+        f->table_columns = it.table_columns;
+        f->entities = it.entities;
+        f->offset = it.offset;
+        f->count = it.count;
+        f->total_count = it.total_count;
+        f->frame_offset = it.frame_offset;
+        entity_count += it.count;
+    }
+
+    int32_t i, result_count = ecs_vector_count(q->results);
+    ecs_job_fragment_t *results = ecs_vector_first(
+        q->results, ecs_job_fragment_t);
+
+    int32_t size = job_chunk_size(world, entity_count, q->deque_count);
+    int32_t job_remaining = 0;
+
+    for (i = 0; i < result_count; i ++) {
+        ecs_job_fragment_t f = results[i];
+
+        /* Results without entities (queries that don't match tables) are
+         * scheduled as a separate job, so they run exactly once */
+        if (!f.count) {
+            add_job(q);
+            add_fragment(q, &f);
+            job_remaining = 0;
+            continue;
+        }
+
+        /* When columns are aligned, split tables on rows that start on an
+         * aligned address, so that jobs don't share cache lines */
+        int32_t align = 1;
+        if (f.table && f.table->table) {
+            align = ecs_table_row_alignment(world, f.table->table);
+        }
+
+        while (f.count) {
+            if (job_remaining <= 0) {
+                add_job(q);
+                job_remaining = size;
+            }
+
+            ecs_job_fragment_t piece = f;
+            if (piece.count > job_remaining) {
+                piece.count = job_remaining;
+
+                if (align > 1) {
+                    int32_t end = f.offset + piece.count;
+                    end -= end % align;
+                    if (end <= f.offset) {
+                        end += align;
+                    }
+                    piece.count = end - f.offset;
+                    if (piece.count > f.count) {
+                        piece.count = f.count;
+                    }
+                }
+            }
+
+            add_fragment(q, &piece);
+
+            f.entities += piece.count;
+            f.offset += piece.count;
+            f.frame_offset += piece.count;
+            f.count -= piece.count;
+            job_remaining -= piece.count;
+        }
+    }
+
+    /* Assign each worker a contiguous range of jobs */
+    int32_t job_count = ecs_vector_count(q->jobs);
+    int32_t deque_count = q->deque_count;
+    for (i = 0; i < deque_count; i ++) {
+        q->deques[i].head = (job_count * i) / deque_count;
+        q->deques[i].tail = (job_count * (i + 1)) / deque_count;
+    }
+}
+
+/* Publish the number of jobs once the job list is built. Must be called while
+ * holding the queue lock. */
+static
+void set_job_count(
+    ecs_job_queue_t *q,
+    int32_t count)
+{
+    q->built = true;
+    ecs_os_astore(&q->job_count, count);
+    if (!count) {
+        ecs_os_cond_broadcast(q->done_cond);
+    }
+}
+
+/* Mark a job as finished. The thread that finishes the last job wakes up the
+ * threads that are waiting for the queue. */
+static
+void finish_job(
+    ecs_job_queue_t *q)
+{
+    if (ecs_os_ainc(&q->jobs_done) == ecs_os_aload(&q->job_count)) {
+        ecs_os_mutex_lock(q->lock);
+        ecs_os_cond_broadcast(q->done_cond);
+        ecs_os_mutex_unlock(q->lock);
+    }
+}
+
+static
+bool jobs_finished(
+    ecs_job_queue_t *q)
+{
+    return ecs_os_aload(&q->jobs_done) == ecs_os_aload(&q->job_count);
+}
+
+/* Wait until systems that conflict with this system have finished. Threads 
+ * poll the queue first, and block on its condition variable when the wait 
+ * takes longer than the spin count. The last job is counted before the queue
+ * is signalled under the lock, so a blocked thread can't miss the signal. */
+static
+void wait_for_dependencies(
+    ecs_world_t *world,
+    ecs_job_queue_t *q)
+{
+    int32_t spin_count = world->sync_spin_count;
+
+    ecs_vector_each(q->depends_on, ecs_job_queue_t*, dep_ptr, {
+        ecs_job_queue_t *dep = *dep_ptr;
+        int32_t i;
+        for (i = 0; i < spin_count; i ++) {
+            if (jobs_finished(dep)) {
+                break;
+            }
+        }
+
+        if (i == spin_count) {
+            ecs_os_mutex_lock(dep->lock);
+            while (!jobs_finished(dep)) {
+                ecs_os_cond_wait(dep->done_cond, dep->lock);
+            }
+            ecs_os_mutex_unlock(dep->lock);
+        }
+    });
+}
+
+static
+int32_t pop_job(
+    ecs_job_deque_t *deque)
+{
+    int32_t result = -1;
+    ecs_os_mutex_lock(deque->lock);
+    if (deque->head < deque->tail) {
+        result = deque->head ++;
+    }
+    ecs_os_mutex_unlock(deque->lock);
+    return result;
+}
+
+static
+int32_t steal_job(
+    ecs_job_deque_t *deque)
+{
+    int32_t result = -1;
+    ecs_os_mutex_lock(deque->lock);
+    if (deque->head < deque->tail) {
+        result = -- deque->tail;
+    }
+    ecs_os_mutex_unlock(deque->lock);
+    return result;
+}
+
+static
+void run_job(
+    ecs_job_queue_t *q,
+    int32_t job,
+    ecs_iter_t *it,
+    ecs_iter_action_t action)
+{
+    int32_t *jobs = ecs_vector_first(q->jobs, int32_t);
+    int32_t first = jobs[job];
+    int32_t last = ecs_vector_count(q->fragments);
+    if (job < (ecs_vector_count(q->jobs) - 1)) {
+        last = jobs[job + 1];
+    }
+
+    ecs_job_fragment_t *fragments = ecs_vector_first(
+        q->fragments, ecs_job_fragment_t);
+
+    int32_t i;
+    for (i = first; i < last; i ++) {
+        ecs_job_fragment_t *f = &fragments[i];
+        it->table = f->table;
+        it->table_columns = f->table_columns;
+        it->entities = f->entities;
+        it->offset = f->offset;
+        it->count = f->count;
+        it->total_count = f->total_count;
+        it->frame_offset = f->frame_offset;
+        action(it);
+    }
+}
+
+/* Stop worker threads */
 static
 void ecs_stop_threads(
     ecs_world_t *world)
 {
+    /* Make sure all workers observed the sense before releasing them */
+    wait_for_workers(world);
+
     world->quit_workers = true;
     signal_workers(world);
 
@@ -146,6 +616,8 @@ void ecs_stop_threads(
         ecs_stage_deinit(world, thr->stage);
     });
 
+    free_job_queues(world);
+
     ecs_vector_free(world->workers);
     ecs_vector_free(world->worker_stages);
     world->worker_stages = NULL;
@@ -166,7 +638,8 @@ void ecs_worker_begin(
 }
 
 bool ecs_worker_sync(
-    ecs_world_t *world)
+    ecs_world_t *world,
+    ecs_stage_t *stage)
 {
     int32_t build_count = world->stats.pipeline_build_count_total;
 
@@ -178,20 +651,142 @@ bool ecs_worker_sync(
 
         ecs_staging_begin(world);
     } else {
-        sync_worker(world);
+        sync_worker(world, (ecs_thread_t*)stage->world, 
+            world->measure_frame_time);
     }
 
     return world->stats.pipeline_build_count_total != build_count;
 }
 
 void ecs_worker_end(
-    ecs_world_t *world)
+    ecs_world_t *world,
+    ecs_stage_t *stage)
 {
     int32_t thread_count = ecs_vector_count(world->workers);
     if (!thread_count) {
         ecs_staging_end(world);
     } else {
-        sync_worker(world);
+        /* Don't measure the wait at the end of the frame, as this includes the
+         * time the application spends outside of ecs_progress */
+        sync_worker(world, (ecs_thread_t*)stage->world, false);
+    }
+}
+
+void ecs_worker_run_jobs(
+    ecs_world_t *world,
+    ecs_thread_t *thread,
+    ecs_entity_t system,
+    ecs_iter_t *it,
+    ecs_iter_action_t action)
+{
+    ecs_job_queue_t *q = ecs_map_get_ptr(
+        world->worker_jobs, ecs_job_queue_t*, system);
+
+    /* Systems that are not part of the pipeline when jobs were prepared, like
+     * a system that is ran manually from a worker, have no job queue. These
+     * divide entities evenly over workers. */
+    if (!q) {
+        int32_t total = ecs_vector_count(world->workers);
+        while (ecs_query_next_worker(it, thread->index, total)) {
+            action(it);
+        }
+        return;
+    }
+
+    wait_for_dependencies(world, q);
+
+    ecs_os_mutex_lock(q->lock);
+    if (!q->built) {
+        build_jobs(world, q, it);
+        set_job_count(q, ecs_vector_count(q->jobs));
+    }
+    ecs_os_mutex_unlock(q->lock);
+
+    /* Run jobs from own deque first */
+    int32_t job, index = thread->index, count = q->deque_count;
+    while ((job = pop_job(&q->deques[index])) != -1) {
+        run_job(q, job, it, action);
+        finish_job(q);
+    }
+
+    /* Steal jobs from other workers until no jobs are left */
+    int32_t i;
+    for (i = 1; i < count; i ++) {
+        ecs_job_deque_t *victim = &q->deques[(index + i) % count];
+        while ((job = steal_job(victim)) != -1) {
+            run_job(q, job, it, action);
+            finish_job(q);
+        }
+    }
+}
+
+void ecs_worker_skip_jobs(
+    ecs_world_t *world,
+    ecs_entity_t system)
+{
+    ecs_job_queue_t *q = ecs_map_get_ptr(
+        world->worker_jobs, ecs_job_queue_t*, system);
+    if (!q) {
+        return;
+    }
+
+    ecs_os_mutex_lock(q->lock);
+    if (!q->built) {
+        clear_jobs(q);
+        set_job_count(q, 0);
+    }
+    ecs_os_mutex_unlock(q->lock);
+}
+
+static
+ecs_job_queue_t* get_job_queue(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    int32_t thread_count)
+{
+    ecs_job_queue_t *q = ecs_map_get_ptr(
+        world->worker_jobs, ecs_job_queue_t*, system);
+    if (!q) {
+        q = job_queue_new(thread_count);
+        ecs_map_set(world->worker_jobs, system, &q);
+    }
+    return q;
+}
+
+void ecs_workers_prepare_jobs(
+    ecs_world_t *world,
+    ecs_entity_t pipeline)
+{
+    const EcsPipelineQuery *pq = ecs_get(world, pipeline, EcsPipelineQuery);
+    ecs_assert(pq != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t thread_count = ecs_vector_count(world->workers);
+
+    if (!world->worker_jobs) {
+        world->worker_jobs = ecs_map_new(ecs_job_queue_t*, 0);
+    }
+
+    /* Make sure each system has a job queue and reset queues from the
+     * previous frame. Workers are not running, so this is safe. */
+    ecs_iter_t it = ecs_query_iter(pq->query);
+    while (ecs_query_next(&it)) {
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            ecs_entity_t e = it.entities[i];
+            ecs_job_queue_t *q = get_job_queue(world, e, thread_count);
+            q->built = false;
+            q->job_count = -1;
+            q->jobs_done = 0;
+
+            /* Resolve systems this system depends on to their job queues */
+            ecs_vector_clear(q->depends_on);
+            ecs_vector_t *deps = ecs_map_get_ptr(pq->deps, ecs_vector_t*, e);
+            ecs_vector_each(deps, ecs_entity_t, dep, {
+                ecs_job_queue_t **elem = ecs_vector_add(
+                    &q->depends_on, ecs_job_queue_t*);
+                *elem = get_job_queue(world, *dep, thread_count);
+            });
+        }
     }
 }
 
@@ -218,25 +813,27 @@ void ecs_workers_progress(
         /* Make sure workers are running and ready */
         wait_for_workers(world);
 
+        ecs_workers_prepare_jobs(world, pipeline);
+
         /* Synchronize n times for each op in the pipeline */
         for (i = 0; i < sync_count; i ++) {
             ecs_staging_begin(world);
 
             /* Signal workers that they should start running systems */
-            world->workers_waiting = 0;
             signal_workers(world);
 
             /* Wait until all workers are waiting on sync point */
             wait_for_sync(world);
 
             /* Merge */
-            ecs_staging_end(world);
+            merge_stages(world);
 
             int32_t update_count;
             if ((update_count = ecs_pipeline_update(world, pipeline))) {
                 /* The number of operations in the pipeline could have changed
                  * as result of the merge */
                 sync_count = update_count;
+                ecs_workers_prepare_jobs(world, pipeline);
             }
         }
 
@@ -251,6 +848,29 @@ void ecs_workers_progress(
 
 /* -- Public functions -- */
 
+void ecs_set_job_chunk_size(
+    ecs_world_t *world,
+    int32_t size)
+{
+    ecs_assert(size >= 0, ECS_INVALID_PARAMETER, NULL);
+    world->job_chunk_size = size;
+}
+
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enabled)
+{
+    world->parallel_merge = enabled;
+}
+
+void ecs_set_sync_spin_count(
+    ecs_world_t *world,
+    int32_t spin_count)
+{
+    ecs_assert(spin_count >= 0, ECS_INVALID_PARAMETER, NULL);
+    world->sync_spin_count = spin_count;
+}
+
 void ecs_set_threads(
     ecs_world_t *world,
     int32_t threads)
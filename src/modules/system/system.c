@@ -435,12 +435,16 @@ ecs_entity_t ecs_run_intern(
         }
     } else {
         ecs_thread_t *thread = (ecs_thread_t*)stage->world;
+#ifdef FLECS_PIPELINE
+        ecs_worker_run_jobs(world, thread, system, &it, action);
+#else
         int32_t total = ecs_vector_count(world->workers);
         int32_t current = thread->index;
 
         while (ecs_query_next_worker(&it, current, total)) {
             action(&it);               
         }
+#endif
     }
 
     if (defer) {
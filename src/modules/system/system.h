@@ -39,4 +39,15 @@ ecs_entity_t ecs_run_intern(
     void *param,
     bool ran_by_app);
 
+#ifdef FLECS_PIPELINE
+/* Run system on a worker thread. Matched entities are divided up in jobs that
+ * are shared between workers. Implemented by the pipeline module. */
+void ecs_worker_run_jobs(
+    ecs_world_t *world,
+    ecs_thread_t *thread,
+    ecs_entity_t system,
+    ecs_iter_t *it,
+    ecs_iter_action_t action);
+#endif
+
 #endif
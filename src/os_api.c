@@ -164,6 +164,55 @@ char* ecs_os_api_strdup(const char *str) {
     return result;
 }
 
+/* Default atomics use compiler intrinsics. Applications can override them
+ * with an implementation from their own threading library. */
+#if defined(__GNUC__) || defined(__clang__)
+static
+int ecs_os_api_ainc(int32_t *value) {
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static
+int ecs_os_api_adec(int32_t *value) {
+    return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static
+int32_t ecs_os_api_aload(const int32_t *value) {
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+}
+
+static
+void ecs_os_api_astore(int32_t *value, int32_t desired) {
+    __atomic_store_n(value, desired, __ATOMIC_SEQ_CST);
+}
+#define ECS_OS_API_HAS_ATOMICS
+#elif defined(_MSC_VER)
+#include <intrin.h>
+
+static
+int ecs_os_api_ainc(int32_t *value) {
+    return (int)_InterlockedIncrement((volatile long*)value);
+}
+
+static
+int ecs_os_api_adec(int32_t *value) {
+    return (int)_InterlockedDecrement((volatile long*)value);
+}
+
+static
+int32_t ecs_os_api_aload(const int32_t *value) {
+    return (int32_t)_InterlockedCompareExchange(
+        (volatile long*)(uintptr_t)value, 0, 0);
+}
+
+static
+void ecs_os_api_astore(int32_t *value, int32_t desired) {
+    _InterlockedExchange((volatile long*)value, desired);
+}
+#define ECS_OS_API_HAS_ATOMICS
+#endif
+
 /* Replace dots with underscores */
 static
 char *module_file_base(const char *module, char sep) {
@@ -236,6 +285,14 @@ void ecs_os_set_api_defaults(void)
     /* Strings */
     ecs_os_api.strdup_ = ecs_os_api_strdup;
 
+#ifdef ECS_OS_API_HAS_ATOMICS
+    /* Atomics */
+    ecs_os_api.ainc_ = ecs_os_api_ainc;
+    ecs_os_api.adec_ = ecs_os_api_adec;
+    ecs_os_api.aload_ = ecs_os_api_aload;
+    ecs_os_api.astore_ = ecs_os_api_astore;
+#endif
+
     /* Time */
     ecs_os_api.sleep_ = ecs_os_time_sleep;
     ecs_os_api.get_time_ = ecs_os_gettime;
@@ -278,7 +335,11 @@ bool ecs_os_has_threading(void) {
         (ecs_os_api.cond_signal_ != NULL) &&
         (ecs_os_api.cond_broadcast_ != NULL) &&
         (ecs_os_api.thread_new_ != NULL) &&
-        (ecs_os_api.thread_join_ != NULL);   
+        (ecs_os_api.thread_join_ != NULL) &&
+        (ecs_os_api.ainc_ != NULL) &&
+        (ecs_os_api.adec_ != NULL) &&
+        (ecs_os_api.aload_ != NULL) &&
+        (ecs_os_api.astore_ != NULL);   
 }
 
 bool ecs_os_has_time(void) {
@@ -62,6 +62,37 @@ void ecs_run_monitors(
     ecs_vector_t *v_src_monitors);
 
 
+////////////////////////////////////////////////////////////////////////////////
+//// Hierarchy API
+////////////////////////////////////////////////////////////////////////////////
+
+/* Update name index after the name of an entity changed */
+void ecs_name_index_update(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Name of entity may have been modified through a mutable pointer. The entity
+ * is reindexed before the next lookup. */
+void ecs_name_index_defer(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Update name index after an entity moved to a new table. This only needs to
+ * reindex the entity if its scope changed. */
+void ecs_name_index_move(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_table_t *table);
+
+/* Remove entity from name index */
+void ecs_name_index_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Free name index */
+void ecs_name_index_fini(
+    ecs_world_t *world);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// World API
 ////////////////////////////////////////////////////////////////////////////////
@@ -137,6 +168,15 @@ bool ecs_stage_defer_begin(
 
 bool ecs_stage_defer_end(
     ecs_world_t *world,
+    ecs_stage_t *stage);
+
+/* Release payloads of deferred operations that were allocated after mark */
+void ecs_stage_defer_release(
+    ecs_stage_t *stage,
+    ecs_arena_mark_t mark);
+
+/* Release all payloads of deferred operations */
+void ecs_stage_defer_reset(
     ecs_stage_t *stage);    
 
 /* Delete table from stage */
@@ -144,6 +184,11 @@ void ecs_delete_table(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Add empty table to the queue of tables that may be garbage collected */
+void ecs_table_gc_enqueue(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Defer API
 ////////////////////////////////////////////////////////////////////////////////
@@ -223,6 +268,20 @@ bool ecs_defer_flush(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Divide deferred set operations into partitions by entity */
+void ecs_deferred_writes_partition(
+    ecs_world_t *world,
+    int32_t partition_count);
+
+/* Copy values of deferred set operations in partition */
+void ecs_deferred_writes_apply(
+    ecs_world_t *world,
+    int32_t partition);
+
+/* Run OnSet systems for deferred set operations and free values */
+void ecs_deferred_writes_end(
+    ecs_world_t *world);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Type API
 ////////////////////////////////////////////////////////////////////////////////
@@ -329,6 +388,21 @@ void ecs_table_activate(
     ecs_query_t *query,
     bool activate);
 
+/* Release memory of an empty table, while keeping the table alive */
+void ecs_table_reclaim(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Reallocate columns after the column alignment of the world changed */
+void ecs_table_realign_columns(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get number of rows after which all columns start at the column alignment */
+int32_t ecs_table_row_alignment(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
 /* Clear all entities from a table. */
 void ecs_table_clear(
     ecs_world_t *world,
@@ -371,7 +445,8 @@ void ecs_table_delete(
     int32_t index,
     bool destruct);
 
-/* Move a row from one table to another */
+/* Move a row from one table to another. If map is not NULL, it is used to
+ * find the columns to move, construct and destruct. */
 void ecs_table_move(
     ecs_world_t *world,
     ecs_entity_t dst_entity,
@@ -381,7 +456,27 @@ void ecs_table_move(
     int32_t new_index,
     ecs_table_t *old_table,
     ecs_data_t *old_data,
-    int32_t old_index);
+    int32_t old_index,
+    const ecs_move_map_t *map);
+
+/* Compute column mapping for moving rows from old_table to new_table */
+ecs_move_map_t* ecs_move_map_new(
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data);
+
+/* Move a set of rows from one table to another. Rows must be sorted in
+ * ascending order, and tables may not have switch or bitset columns. Returns
+ * the index of the first moved row in the new table. */
+int32_t ecs_table_move_rows(
+    ecs_world_t *world,
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data,
+    const int32_t *rows,
+    int32_t count);
 
 /* Grow table with specified number of records. Populate table with entities,
  * starting from specified entity id. */
@@ -466,6 +561,22 @@ ecs_table_t *ecs_table_traverse_remove(
     ecs_entities_t *to_remove,
     ecs_entities_t *removed);
 
+/* Find table that also has the cold parts of the components in a table. Used
+ * when a table is looked up by type instead of by traversing the graph. */
+ecs_table_t *ecs_table_add_cold_parts(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get column mapping of the edge from src to dst for component e. Returns NULL
+ * if the edge does not lead to dst. */
+const ecs_move_map_t* ecs_table_get_move_map(
+    ecs_table_t *src,
+    ecs_data_t *src_data,
+    ecs_table_t *dst,
+    ecs_data_t *dst_data,
+    ecs_entity_t e,
+    bool add);
+
 void ecs_table_mark_dirty(
     ecs_table_t *table,
     ecs_entity_t component);
@@ -488,6 +599,50 @@ void ecs_table_clear_edges(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Remove table from component index and type lookup maps */
+void ecs_table_index_remove(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Keep type of a deleted table, so it can be reused if the table is recreated */
+void ecs_table_retire_type(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get chunk of table with room for count entities, creates chunk if needed */
+ecs_table_t* ecs_table_get_chunk(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count);
+
+/* Called when a chunk that was full has room for new entities again */
+void ecs_table_chunk_has_space(
+    ecs_table_t *table);
+
+/* Remove chunk from the first chunk of its type */
+void ecs_table_remove_chunk(
+    ecs_table_t *table);
+
+/* Returns whether tables with component can be found with component index */
+bool ecs_table_index_supports(
+    ecs_entity_t component);
+
+/* Number of tables returned by ecs_table_index_next for component */
+int32_t ecs_table_index_count(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    bool inherited);
+
+/* Iterate tables that have component. If inherited is true, tables with a base
+ * are returned as well, as they may inherit the component. Iteration starts
+ * with index and base_index set to 0, and ends when NULL is returned. */
+ecs_table_t* ecs_table_index_next(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    bool inherited,
+    int32_t *index,
+    int32_t *base_index);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Query API
 ////////////////////////////////////////////////////////////////////////////////
@@ -554,11 +709,6 @@ void ecs_increase_timer_resolution(
 //// Utilities
 ////////////////////////////////////////////////////////////////////////////////
 
-void ecs_hash(
-    const void *data,
-    ecs_size_t length,
-    uint64_t *result);
-
 /* Convert 64 bit signed integer to 16 bit */
 int8_t ecs_to_i8(
     int64_t v);
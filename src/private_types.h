@@ -30,6 +30,31 @@
 
 #define ECS_MAX_JOBS_PER_WORKER (16)
 
+/* Minimum number of entities in a job when the job size is derived from the
+ * number of matched entities. Prevents splitting small tables in fragments that
+ * are too small to offset the cost of scheduling them. */
+#define ECS_MIN_JOB_CHUNK_SIZE (64)
+
+/* Number of times a thread polls a sync point before it parks on a condition
+ * variable. Spinning avoids a futex round trip when all threads arrive at a
+ * merge point at roughly the same time, which is the common case. */
+#define ECS_DEFAULT_SYNC_SPIN_COUNT (10000)
+
+/* Number of consecutive entity ids assigned to the same thread when component
+ * values are copied in parallel during a merge */
+#define ECS_MERGE_PARTITION_SIZE (64)
+
+/* Size of the memory chunks from which payloads of deferred operations are
+ * allocated. Payloads that are larger get a chunk of their own. */
+#define ECS_ARENA_CHUNK_SIZE (64 * 1024)
+
+/* Alignment of payloads allocated from an arena */
+#define ECS_ARENA_ALIGNMENT (16)
+
+/* Maximum alignment of table columns that can be set for a world. Column
+ * buffers are over-allocated by twice the alignment. */
+#define ECS_MAX_COLUMN_ALIGNMENT (4096)
+
 /** These values are used to verify validity of the pointers passed into the API
  * and to allow for passing a thread as a world to some API calls (this allows
  * for transparently passing thread context to API functions) */
@@ -66,6 +91,8 @@ typedef struct ecs_c_info_t {
     ecs_vector_t *on_remove;    /* Systems ran after removing this component */
     EcsComponentLifecycle lifecycle; /* Component lifecycle callbacks */
     bool lifecycle_set;
+    ecs_entity_t cold;          /* Cold part that is added with the component */
+    ecs_entity_t hot;           /* Component of which this is the cold part */
 } ecs_c_info_t;
 
 /* Table event type for notifying tables of world events */
@@ -143,6 +170,8 @@ typedef struct ecs_table_leaf_t {
 #define EcsTableHasMonitors         32768u
 #define EcsTableHasSwitch           65536u
 #define EcsTableHasDisabled         131072u
+#define EcsTableHasName             262144u /**< Does the table have EcsName */
+#define EcsTableHasColdParts        524288u /**< Does the table have components with a cold part */
 
 /* Composite constants */
 #define EcsTableHasLifecycle        (EcsTableHasCtors | EcsTableHasDtors)
@@ -150,12 +179,51 @@ typedef struct ecs_table_leaf_t {
 #define EcsTableHasAddActions       (EcsTableHasBase | EcsTableHasSwitch | EcsTableHasCtors | EcsTableHasOnAdd | EcsTableHasOnSet | EcsTableHasMonitors)
 #define EcsTableHasRemoveActions    (EcsTableHasBase | EcsTableHasDtors | EcsTableHasOnRemove | EcsTableHasUnSet | EcsTableHasMonitors)
 
+/** Entities in the name index with the same scope & name hash */
+typedef struct ecs_name_bucket_t {
+    ecs_entity_t first;
+    ecs_vector_t *more;
+} ecs_name_bucket_t;
+
+/** Keys under which an entity is stored in the name index */
+typedef struct ecs_name_entry_t {
+    ecs_entity_t scope;
+    uint64_t name_hash;
+    uint64_t symbol_hash;            /**< 0 if no symbol or same as name */
+} ecs_name_entry_t;
+
+/** Mapping between the columns of two tables. This allows moving an entity
+ * between tables without comparing their types. Columns without data (tags) are
+ * not included. The columns array stores, in order:
+ *  - source and destination column of each column in both tables
+ *  - destination columns that are not in the source (to construct)
+ *  - source columns that are not in the destination (to destruct) */
+typedef struct ecs_move_map_t {
+    int32_t move_count;             /**< Number of columns in both tables */
+    int32_t ctor_count;             /**< Number of columns only in destination */
+    int32_t dtor_count;             /**< Number of columns only in source */
+    int32_t *columns;               /**< Column indices */
+} ecs_move_map_t;
+
 /** Edge used for traversing the table graph. */
 typedef struct ecs_edge_t {
     ecs_table_t *add;               /**< Edges traversed when adding */
     ecs_table_t *remove;            /**< Edges traversed when removing */
+    ecs_move_map_t *add_map;        /**< Column mapping to add table (lazy) */
+    ecs_move_map_t *remove_map;     /**< Column mapping to remove table (lazy) */
 } ecs_edge_t;
 
+/** Number of recently used edges cached inline on a table. Must be a power of
+ * two, as the component id is used to index the cache. */
+#define ECS_EDGE_CACHE_SIZE (4)
+
+/** Cached pointer to an edge in the edge map of a table. Pointers are
+ * invalidated when an edge is inserted into or removed from the map. */
+typedef struct ecs_edge_cache_t {
+    ecs_entity_t id;                /**< Component of edge, 0 if empty */
+    ecs_edge_t *edge;               /**< Edge stored in table edge map */
+} ecs_edge_cache_t;
+
 /** Quey matched with table with backref to query table administration.
  * This type is used to store a matched query together with the array index of
  * where the table is stored in the query administration. This type is used when
@@ -175,8 +243,8 @@ struct ecs_table_t {
     ecs_type_t type;                 /**< Identifies table type in type_index */
     ecs_c_info_t **c_info;           /**< Cached pointers to component info */
 
-    ecs_edge_t *lo_edges;            /**< Edges to other tables */
-    ecs_map_t *hi_edges;
+    ecs_map_t *edges;                /**< Edges to other tables */
+    ecs_edge_cache_t edge_cache[ECS_EDGE_CACHE_SIZE]; /**< Recent edges */
 
     ecs_data_t *data;                /**< Component storage */
 
@@ -190,6 +258,15 @@ struct ecs_table_t {
     int32_t *dirty_state;            /**< Keep track of changes in columns */
     int32_t alloc_count;             /**< Increases when columns are reallocd */
     uint32_t id;                     /**< Table id in sparse set */
+    uint64_t hash;                   /**< Hash of type, key in table_map */
+
+    int32_t gc_frame;                /**< Frame at which table became empty */
+    int32_t gc_index;                /**< Index in gc queue, -1 if not queued */
+
+    struct ecs_table_t *chunk_head;  /**< Table of which this is a chunk */
+    ecs_vector_t *chunks;            /**< Chunks of table (head only) */
+    struct ecs_table_t *chunk_tail;  /**< Chunk that is appended to (head only) */
+    ecs_vector_t *chunk_free;        /**< Chunks that have room again (head only) */
 
     ecs_flags32_t flags;             /**< Flags for testing table properties */
     
@@ -219,6 +296,7 @@ typedef struct ecs_matched_table_t {
     ecs_vector_t *sparse_columns;  /**< Column ids of sparse columns */
     ecs_vector_t *bitset_columns;  /**< Column ids with disabled flags */
     int32_t *monitor;              /**< Used to monitor table for changes */
+    ecs_vector_t *sorted_rows;     /**< Rows in sort order (EcsQuerySortRows) */
     int32_t rank;                  /**< Rank used to sort tables */
 } ecs_matched_table_t;
 
@@ -263,6 +341,8 @@ typedef struct ecs_table_slice_t {
 #define EcsQueryIsOrphaned (512)     /* Is subquery orphaned */
 #define EcsQueryHasOutColumns (1024) /* Does query have out columns */
 #define EcsQueryHasOptional (2048)   /* Does query have optional columns */
+#define EcsQuerySortRows (4096)      /* Does query sort without moving rows */
+#define EcsQuerySortKey (8192)       /* Does query sort on a numeric key */
 
 #define EcsQueryNoActivation (EcsQueryMonitor | EcsQueryOnSet | EcsQueryUnSet)
 
@@ -301,6 +381,8 @@ struct ecs_query_t {
     /* Used for sorting */
     ecs_entity_t sort_on_component;
     ecs_compare_action_t compare;   
+    ecs_sort_key_kind_t sort_key_kind;  /* Key type (EcsQuerySortKey) */
+    ecs_size_t sort_key_offset;         /* Key offset (EcsQuerySortKey) */
     ecs_vector_t *table_slices;     
 
     /* Used for table sorting */
@@ -373,6 +455,48 @@ typedef struct ecs_op_t {
     } is;
 } ecs_op_t;
 
+/** Component value of a deferred set operation. In a parallel merge, values
+ * are copied to storage after the structural changes of the merge have been
+ * applied, which lets multiple threads copy values at the same time. */
+typedef struct ecs_deferred_write_t {
+    ecs_entity_t entity;        /* Entity to write to */
+    ecs_entity_t component;     /* Component to write */
+    ecs_c_info_t *c_info;       /* Lifecycle callbacks of component */
+    void *value;                /* Value (stored in stage arena) */
+    ecs_size_t size;            /* Size of value */
+    bool notify;                /* Run OnSet systems after writing value */
+} ecs_deferred_write_t;
+
+/** Chunk of memory in an arena. Allocations are stored after the header. */
+typedef struct ecs_arena_chunk_t {
+    struct ecs_arena_chunk_t *next;
+    ecs_size_t size;            /* Number of bytes available in chunk */
+} ecs_arena_chunk_t;
+
+/** Position in an arena. Restoring an arena to a position releases everything
+ * allocated after it. */
+typedef struct ecs_arena_mark_t {
+    ecs_arena_chunk_t *chunk;   /* Current chunk (NULL if nothing allocated) */
+    ecs_size_t used;            /* Bytes used in current chunk */
+} ecs_arena_mark_t;
+
+/** Bump allocator for payloads of deferred operations. Memory is released all
+ * at once when a queue is flushed, and chunks are reused for the next queue. */
+typedef struct ecs_arena_t {
+    ecs_arena_chunk_t *chunks;  /* All chunks owned by the arena */
+    ecs_arena_mark_t cur;       /* Current allocation position */
+} ecs_arena_t;
+
+/** Memory pool of a world. Vectors that are allocated from a pool store a
+ * pointer to it, so that they are reallocated and freed by the same allocator.
+ * When the allocator of a pool is replaced while it still has allocations, the
+ * pool is retired and kept alive until the world is deleted. */
+struct ecs_pool_t {
+    ecs_pool_kind_t kind;
+    ecs_allocator_t allocator;
+    ecs_pool_stats_t stats;
+};
+
 /** A stage is a data structure in which delta's are stored until it is safe to
  * merge those delta's with the main world stage. A stage allows flecs systems
  * to arbitrarily add/remove/set components and create/delete entities while
@@ -396,6 +520,10 @@ struct ecs_stage_t {
     ecs_vector_t *defer_queue;
     ecs_vector_t *defer_merge_queue;
 
+    /* Payloads (values, component arrays) of deferred operations */
+    ecs_arena_t defer_arena;
+    ecs_arena_mark_t defer_mark;   /* Arena position when queue was created */
+
     /* One-shot actions to be executed after the merge */
     ecs_vector_t *post_frame_actions;
 
@@ -423,6 +551,19 @@ typedef struct ecs_store_t {
 
     /* Lookup map for tables */
     ecs_map_t *table_map;
+
+    /* Tables by type pointer, so types of existing tables aren't rehashed */
+    ecs_map_t *type_index;
+
+    /* Tables per component id. Tables with a base are also registered under
+     * ECS_INSTANCEOF, as they may inherit any component. */
+    ecs_map_t *component_tables;
+
+    /* Types of deleted tables by hash. Types are handed out to the application
+     * as ecs_type_t, so they outlive their table. When a table is recreated
+     * for the same type, it reuses the type so that type handles compare
+     * equal to the type of the new table. */
+    ecs_map_t *retired_types;
 } ecs_store_t;
 
 /** Supporting type to store looked up or derived entity data */
@@ -447,6 +588,7 @@ typedef struct ecs_thread_t {
     ecs_stage_t *stage;                       /* Stage for thread */
     ecs_os_thread_t thread;                   /* Thread handle */
     int32_t index;                           /* Index of thread */
+    FLECS_FLOAT sync_wait_time;              /* Time spent waiting since last sync */
 } ecs_thread_t;
 
 /** Supporting type to store looked up component data in specific table */
@@ -456,10 +598,35 @@ typedef struct ecs_column_info_t {
     int32_t column;
 } ecs_column_info_t;
 
+/** Number of elements in a page of a paged array, as a power of two */
+#define ECS_PAGE_BITS (8)
+#define ECS_PAGE_SIZE (1 << ECS_PAGE_BITS)
+
+/** Number of page pointers in a page table of a paged array, as a power of two */
+#define ECS_PAGE_TABLE_BITS (10)
+#define ECS_PAGE_TABLE_SIZE (1 << ECS_PAGE_TABLE_BITS)
+
+/** Array indexed by entity id that is split up in fixed size pages. Pages are
+ * only allocated for id ranges that are used, and elements never move once
+ * allocated, so pointers to elements may be cached. Pages are found through a
+ * two level directory, so that a high id only allocates the page table that
+ * contains its page, instead of a page pointer for every lower id. */
+typedef struct ecs_paged_t {
+    void ***tables;                 /* Page tables, NULL if not allocated */
+    int32_t table_count;            /* Number of page table pointers */
+    ecs_size_t elem_size;           /* Size of an element */
+} ecs_paged_t;
+
+/* Queries registered with a component monitor for a single component */
+typedef struct ecs_monitor_queries_t {
+    ecs_vector_t *queries;          /* Queries to notify */
+    bool dirty;                     /* Was component marked since last eval */
+} ecs_monitor_queries_t;
+
 /* Component monitors */
 typedef struct ecs_component_monitor_t {
-    bool dirty_flags[ECS_HI_COMPONENT_ID];
-    ecs_vector_t *monitors[ECS_HI_COMPONENT_ID];
+    ecs_paged_t monitors;           /* ecs_monitor_queries_t per component */
+    ecs_vector_t *dirty;            /* Components marked since last eval */
     bool rematch;
 } ecs_component_monitor_t;
 
@@ -482,8 +649,7 @@ struct ecs_world_t {
     void *context;               /* Application context */
     ecs_vector_t *fini_actions;  /* Callbacks to execute when world exits */
 
-    ecs_c_info_t c_info[ECS_HI_COMPONENT_ID]; /* Component callbacks & triggers */
-    ecs_map_t *t_info;                        /* Tag triggers */
+    ecs_paged_t c_info;          /* Component callbacks & triggers */
 
     /* Is entity range checking enabled? */
     bool range_check_enabled;
@@ -542,11 +708,18 @@ struct ecs_world_t {
     ecs_stage_t temp_stage;          /* Stage for when processing systems */
     ecs_vector_t *worker_stages;     /* Stages for worker threads */
     int32_t stage_count;            /* Number of stages in world */
+    ecs_vector_t *deferred_writes;   /* Values to copy after a parallel merge */
+    ecs_vector_t *deferred_write_order; /* Deferred writes by partition */
+    ecs_vector_t *deferred_write_slices; /* Partition offsets in order */
 
 
     /* -- Hierarchy administration -- */
 
     ecs_map_t *child_tables;        /* Child tables per parent entity */
+    ecs_map_t *name_index;          /* Named entities per scope & name hash */
+    ecs_map_t *name_entries;        /* Name index keys per named entity */
+    ecs_vector_t *name_pending;     /* Entities with names obtained mutably */
+    bool name_index_dirty;          /* Name index must be rebuilt */
     const char *name_prefix;        /* Remove prefix from C names in modules */
 
 
@@ -559,6 +732,12 @@ struct ecs_world_t {
     ecs_os_mutex_t sync_mutex;       /* Mutex for job_cond */
     int32_t workers_running;         /* Number of threads running */
     int32_t workers_waiting;         /* Number of workers waiting on sync */
+    int32_t sync_sense;              /* Flipped by main thread to release workers */
+    int32_t workers_parked;          /* Number of workers blocked on worker_cond */
+    int32_t main_parked;             /* Main thread is blocked on sync_cond */
+    int32_t sync_spin_count;         /* Polls before a thread parks on sync */
+    ecs_map_t *worker_jobs;          /* Job queues for systems */
+    int32_t job_chunk_size;          /* Max number of entities per job */
 
 
     /* -- Time management -- */
@@ -586,6 +765,23 @@ struct ecs_world_t {
     ecs_os_cond_t thr_cond;       /* Used to signal threads at end of frame */
 
 
+    /* -- Table storage -- */
+
+    int32_t column_alignment;     /* Minimum alignment of column buffers */
+    ecs_pool_t *pools[EcsPoolCount]; /* Memory pools for table storage */
+    ecs_vector_t *retired_pools;  /* Pools replaced by ecs_set_allocator */
+    int32_t cold_part_count;      /* Number of components with a cold part */
+    int32_t table_chunk_size;     /* Max rows per table chunk, 0 if disabled */
+
+
+    /* -- Table garbage collection -- */
+
+    int32_t gc_reclaim_after;     /* Frames after which empty tables are reclaimed */
+    int32_t gc_delete_after;      /* Frames after which empty tables are deleted */
+    ecs_vector_t *gc_queue;       /* Tables that were empty at some point */
+    int32_t snapshot_count;       /* Snapshots reference tables, pausing gc */
+
+
     /* -- Defered operation count -- */
     
     int32_t new_count;
@@ -601,6 +797,9 @@ struct ecs_world_t {
     /* -- World state -- */
 
     bool quit_workers;            /* Signals worker threads to quit */
+    bool parallel_merge;          /* Copy values on worker threads in merge */
+    bool defer_writes;            /* Collect values of set operations in merge */
+    bool merge_writes;            /* Signals worker threads to copy values */
     bool in_progress;             /* Is world being progressed */
     bool is_merging;              /* Is world currently being merged */
     bool is_fini;                 /* Is the world being cleaned up? */
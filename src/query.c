@@ -1,5 +1,17 @@
 #include "private_api.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_WIN64)
+#include <intrin.h>
+#endif
+
 #ifdef FLECS_SYSTEMS_H
 #include "modules/system/system.h"
 #endif
@@ -1021,20 +1033,89 @@ bool ecs_query_match(
     return true;
 }
 
+/* Find the required component of the query with the fewest tables. Only tables
+ * for this component can match the query. */
+static
+ecs_entity_t select_query_component(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    bool *inherited_out)
+{
+    int32_t i, column_count = ecs_vector_count(query->sig.columns);
+    ecs_sig_column_t *columns = ecs_vector_first(
+        query->sig.columns, ecs_sig_column_t);
+
+    ecs_entity_t result = 0;
+    int32_t min_count = -1;
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_sig_column_t *column = &columns[i];
+        if (column->oper_kind != EcsOperAnd) {
+            continue;
+        }
+
+        ecs_sig_from_kind_t from_kind = column->from_kind;
+        if (from_kind != EcsFromAny && from_kind != EcsFromOwned) {
+            continue;
+        }
+
+        ecs_entity_t component = column->is.component;
+        if (!ecs_table_index_supports(component)) {
+            continue;
+        }
+
+        bool inherited = from_kind == EcsFromAny;
+        int32_t count = ecs_table_index_count(world, component, inherited);
+        if (min_count == -1 || count < min_count) {
+            result = component;
+            min_count = count;
+            *inherited_out = inherited;
+        }
+    }
+
+    return result;
+}
+
 /** Match existing tables against system (table is created before system) */
 static
 void match_tables(
     ecs_world_t *world,
     ecs_query_t *query)
 {
-    int32_t i, count = ecs_sparse_count(world->store.tables);
+    bool inherited = false;
+    ecs_entity_t component = select_query_component(world, query, &inherited);
 
-    for (i = 0; i < count; i ++) {
-        ecs_table_t *table = ecs_sparse_get(
-            world->store.tables, ecs_table_t, i);
+    if (component) {
+        /* Collect tables first, as matching may create new tables, which are
+         * matched with the query when they are created. */
+        ecs_vector_t *tables = NULL;
+        ecs_table_t *table;
+        int32_t index = 0, base_index = 0;
+
+        while ((table = ecs_table_index_next(
+            world, component, inherited, &index, &base_index))) 
+        {
+            ecs_table_t **elem = ecs_vector_add(&tables, ecs_table_t*);
+            *elem = table;
+        }
 
-        if (ecs_query_match(world, table, query, NULL)) {
-            add_table(world, query, table);
+        ecs_vector_each(tables, ecs_table_t*, table_ptr, {
+            if (ecs_query_match(world, *table_ptr, query, NULL)) {
+                add_table(world, query, *table_ptr);
+            }
+        });
+
+        ecs_vector_free(tables);
+    } else {
+        int32_t i, count = ecs_sparse_count(world->store.tables);
+
+        for (i = 0; i < count; i ++) {
+            ecs_table_t *table = ecs_sparse_get(
+                world->store.tables, ecs_table_t, i);
+
+            if (ecs_query_match(world, table, query, NULL)) {
+                add_table(world, query, table);
+            }
         }
     }
 
@@ -1044,75 +1125,106 @@ void match_tables(
 #define ELEM(ptr, size, index) ECS_OFFSET(ptr, size * index)
 
 static
-int32_t qsort_partition(
-    ecs_world_t *world,
-    ecs_table_t *table,
-    ecs_data_t *data,
+int compare_rows(
     ecs_entity_t *entities,
-    void *ptr,    
-    int32_t elem_size,
+    void *ptr,
+    int32_t size,
+    int32_t row_1,
+    int32_t row_2,
+    ecs_compare_action_t compare)
+{
+    return compare(entities[row_1], ELEM(ptr, size, row_1), 
+        entities[row_2], ELEM(ptr, size, row_2));
+}
+
+/* Merge two sorted ranges of row indices. If the ranges are already in order
+ * nothing needs to be merged. */
+static
+void merge_rows(
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t *rows,
+    int32_t *tmp,
     int32_t lo,
+    int32_t mid,
     int32_t hi,
     ecs_compare_action_t compare)
 {
-    int32_t p = (hi + lo) / 2;
-    void *pivot = ELEM(ptr, elem_size, p);
-    ecs_entity_t pivot_e = entities[p];
-    int32_t i = lo - 1, j = hi + 1;
-    void *el;    
+    if (lo == mid || mid == hi) {
+        return;
+    }
 
-repeat:
+    if (compare_rows(entities, ptr, size, rows[mid - 1], rows[mid], 
+        compare) <= 0) 
     {
-        do {
-            i ++;
-            el = ELEM(ptr, elem_size, i);
-        } while ( compare(entities[i], el, pivot_e, pivot) < 0);
-
-        do {
-            j --;
-            el = ELEM(ptr, elem_size, j);
-        } while ( compare(entities[j], el, pivot_e, pivot) > 0);
+        return;
+    }
 
-        if (i >= j) {
-            return j;
+    int32_t i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) {
+        if (compare_rows(entities, ptr, size, rows[i], rows[j], compare) <= 0) {
+            tmp[k ++] = rows[i ++];
+        } else {
+            tmp[k ++] = rows[j ++];
         }
+    }
 
-        ecs_table_swap(world, table, data, i, j);
-
-        if (p == i) {
-            pivot = ELEM(ptr, elem_size, j);
-            pivot_e = entities[j];
-        } else if (p == j) {
-            pivot = ELEM(ptr, elem_size, i);
-            pivot_e = entities[i];
-        }
+    while (i < mid) {
+        tmp[k ++] = rows[i ++];
+    }
 
-        goto repeat;
+    while (j < hi) {
+        tmp[k ++] = rows[j ++];
     }
+
+    ecs_os_memcpy(&rows[lo], &tmp[lo], (hi - lo) * ECS_SIZEOF(int32_t));
 }
 
+/* Stable merge sort of row indices. Runs that are already in order are not
+ * merged, which makes sorting rows that are (mostly) sorted close to O(n). */
 static
-void qsort_array(
-    ecs_world_t *world,
-    ecs_table_t *table,
-    ecs_data_t *data,
+void msort_rows(
     ecs_entity_t *entities,
     void *ptr,
     int32_t size,
+    int32_t *rows,
+    int32_t *tmp,
     int32_t lo,
     int32_t hi,
     ecs_compare_action_t compare)
-{   
-    if ((hi - lo) < 1)  {
+{
+    if ((hi - lo) < 2) {
         return;
     }
 
-    int32_t p = qsort_partition(
-        world, table, data, entities, ptr, size, lo, hi, compare);
-
-    qsort_array(world, table, data, entities, ptr, size, lo, p, compare);
+    int32_t mid = lo + (hi - lo) / 2;
+    msort_rows(entities, ptr, size, rows, tmp, lo, mid, compare);
+    msort_rows(entities, ptr, size, rows, tmp, mid, hi, compare);
+    merge_rows(entities, ptr, size, rows, tmp, lo, mid, hi, compare);
+}
 
-    qsort_array(world, table, data, entities, ptr, size, p + 1, hi, compare); 
+/* Move entities so that row i contains the entity currently stored in rows[i].
+ * Each cycle in the permutation is followed once, so every entity is moved at
+ * most once. Visited rows are marked by pointing them to themselves. */
+static
+void apply_row_order(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t *rows,
+    int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        int32_t cur = i, next;
+        while ((next = rows[cur]) != i) {
+            ecs_table_swap(world, table, data, cur, next);
+            rows[cur] = cur;
+            cur = next;
+        }
+        rows[cur] = cur;
+    }
 }
 
 static
@@ -1128,7 +1240,92 @@ void sort_table(
         return;
     }
 
+    int32_t i, count = ecs_table_data_count(data);
+    if (count < 2) {
+        return;
+    }
+
+    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
+
+    void *ptr = NULL;
+    int32_t size = 0;
+    if (column_index != -1) {
+        ecs_column_t *column = &data->columns[column_index];
+        size = column->size;
+        ptr = ecs_vector_first_t(column->data, size, column->alignment);
+    }
+
+    /* Find the rows that are still sorted since the last time the table was
+     * sorted. If no rows changed, nothing needs to happen. */
+    int32_t sorted = 1;
+    while (sorted < count && compare_rows(
+        entities, ptr, size, sorted - 1, sorted, compare) <= 0) 
+    {
+        sorted ++;
+    }
+
+    if (sorted == count) {
+        return;
+    }
+
+    /* Sort the remaining rows, and merge them with the sorted rows. If rows
+     * were appended to a sorted table this only requires a single merge. The
+     * sorted order is computed first, so each entity is moved at most once. */
+    int32_t *rows = ecs_os_malloc(count * ECS_SIZEOF(int32_t) * 2);
+    for (i = 0; i < count; i ++) {
+        rows[i] = i;
+    }
+
+    msort_rows(entities, ptr, size, rows, &rows[count], sorted, count, compare);
+    merge_rows(entities, ptr, size, rows, &rows[count], 
+        0, sorted, count, compare);
+    apply_row_order(world, table, data, rows, count);
+    ecs_os_free(rows);
+}
+
+/* Get the sorted rows of a table. If rows were added or removed, rows that no
+ * longer exist are removed from the previous order and new rows are appended,
+ * so that the previous order can still be used as starting point. */
+static
+int32_t* prepare_sorted_rows(
+    ecs_matched_table_t *table_data,
+    int32_t count)
+{
+    int32_t i, prev_count = ecs_vector_count(table_data->sorted_rows);
+    int32_t *rows = ecs_vector_first(table_data->sorted_rows, int32_t);
+    int32_t kept = 0;
+
+    for (i = 0; i < prev_count; i ++) {
+        if (rows[i] < count) {
+            rows[kept ++] = rows[i];
+        }
+    }
+
+    ecs_vector_set_count(&table_data->sorted_rows, int32_t, count);
+    rows = ecs_vector_first(table_data->sorted_rows, int32_t);
+
+    for (i = prev_count; i < count; i ++) {
+        rows[kept ++] = i;
+    }
+
+    ecs_assert(kept == count, ECS_INTERNAL_ERROR, NULL);
+
+    return rows;
+}
+
+/* Sort the rows of a table without moving them. The previous order is used as
+ * starting point. */
+static
+void sort_table_rows(
+    ecs_table_t *table,
+    ecs_matched_table_t *table_data,
+    int32_t column_index,
+    ecs_compare_action_t compare)
+{
+    ecs_data_t *data = ecs_table_get_data(table);
     int32_t count = ecs_table_data_count(data);
+    int32_t *rows = prepare_sorted_rows(table_data, count);
+
     if (count < 2) {
         return;
     }
@@ -1143,7 +1340,220 @@ void sort_table(
         ptr = ecs_vector_first_t(column->data, size, column->alignment);
     }
 
-    qsort_array(world, table, data, entities, ptr, size, 0, count - 1, compare);
+    int32_t *tmp = ecs_os_malloc(count * ECS_SIZEOF(int32_t));
+    msort_rows(entities, ptr, size, rows, tmp, 0, count, compare);
+    ecs_os_free(tmp);
+}
+
+/* Convert a numeric key to an unsigned integer with the same ordering, so that
+ * keys of all kinds can be sorted and compared as unsigned integers. */
+static
+uint64_t key_to_uint(
+    ecs_sort_key_kind_t kind,
+    const void *ptr)
+{
+    switch(kind) {
+    case EcsSortKeyI32: {
+        uint32_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint32_t));
+        return v ^ 0x80000000u;
+    }
+    case EcsSortKeyU32: {
+        uint32_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint32_t));
+        return v;
+    }
+    case EcsSortKeyF32: {
+        uint32_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint32_t));
+        return (v & 0x80000000u) ? ~v : (v | 0x80000000u);
+    }
+    case EcsSortKeyI64: {
+        uint64_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint64_t));
+        return v ^ 0x8000000000000000u;
+    }
+    case EcsSortKeyU64: {
+        uint64_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint64_t));
+        return v;
+    }
+    case EcsSortKeyF64: {
+        uint64_t v;
+        ecs_os_memcpy(&v, ptr, ECS_SIZEOF(uint64_t));
+        return (v & 0x8000000000000000u) ? ~v : (v | 0x8000000000000000u);
+    }
+    }
+
+    ecs_abort(ECS_INVALID_PARAMETER, NULL);
+    return 0;
+}
+
+static
+ecs_size_t key_size(
+    ecs_sort_key_kind_t kind)
+{
+    switch(kind) {
+    case EcsSortKeyI32:
+    case EcsSortKeyU32:
+    case EcsSortKeyF32:
+        return 4;
+    case EcsSortKeyI64:
+    case EcsSortKeyU64:
+    case EcsSortKeyF64:
+        return 8;
+    }
+
+    ecs_abort(ECS_INVALID_PARAMETER, NULL);
+    return 0;
+}
+
+/* Stable LSD radix sort of rows by key, one byte per pass. The counts for all 
+ * bytes are computed in a single pass over the keys. Bytes that are the same 
+ * for all keys are skipped. */
+static
+void radix_sort_rows(
+    uint64_t *keys,
+    int32_t *rows,
+    int32_t count,
+    ecs_size_t size)
+{
+    int32_t counts[8][256];
+    ecs_os_memset(counts, 0, ECS_SIZEOF(counts));
+
+    int32_t i, b;
+    for (i = 0; i < count; i ++) {
+        uint64_t key = keys[i];
+        for (b = 0; b < size; b ++) {
+            counts[b][(key >> (b * 8)) & 0xff] ++;
+        }
+    }
+
+    uint64_t *keys_tmp = ecs_os_malloc(count * ECS_SIZEOF(uint64_t));
+    int32_t *rows_tmp = ecs_os_malloc(count * ECS_SIZEOF(int32_t));
+    uint64_t *src_keys = keys, *dst_keys = keys_tmp;
+    int32_t *src_rows = rows, *dst_rows = rows_tmp;
+
+    for (b = 0; b < size; b ++) {
+        int32_t *offsets = counts[b];
+        int32_t shift = b * 8;
+
+        if (offsets[(src_keys[0] >> shift) & 0xff] == count) {
+            continue;
+        }
+
+        int32_t d, offset = 0;
+        for (d = 0; d < 256; d ++) {
+            int32_t digit_count = offsets[d];
+            offsets[d] = offset;
+            offset += digit_count;
+        }
+
+        for (i = 0; i < count; i ++) {
+            uint64_t key = src_keys[i];
+            int32_t dst = offsets[(key >> shift) & 0xff] ++;
+            dst_keys[dst] = key;
+            dst_rows[dst] = src_rows[i];
+        }
+
+        uint64_t *t_keys = src_keys; src_keys = dst_keys; dst_keys = t_keys;
+        int32_t *t_rows = src_rows; src_rows = dst_rows; dst_rows = t_rows;
+    }
+
+    if (src_rows != rows) {
+        ecs_os_memcpy(rows, src_rows, count * ECS_SIZEOF(int32_t));
+        ecs_os_memcpy(keys, src_keys, count * ECS_SIZEOF(uint64_t));
+    }
+
+    ecs_os_free(keys_tmp);
+    ecs_os_free(rows_tmp);
+}
+
+/* Sort rows by the key in the sorted column. Returns false if the rows were
+ * already in order, in which case they are not modified. */
+static
+bool sort_rows_by_key(
+    ecs_query_t *query,
+    ecs_column_t *column,
+    int32_t *rows,
+    int32_t count)
+{
+    ecs_sort_key_kind_t kind = query->sort_key_kind;
+    ecs_size_t offset = query->sort_key_offset;
+    int16_t size = column->size;
+    void *ptr = ecs_vector_first_t(column->data, size, column->alignment);
+    ptr = ECS_OFFSET(ptr, offset);
+
+    uint64_t *keys = ecs_os_malloc(count * ECS_SIZEOF(uint64_t));
+    bool sorted = true;
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        keys[i] = key_to_uint(kind, ELEM(ptr, size, rows[i]));
+        if (i && keys[i] < keys[i - 1]) {
+            sorted = false;
+        }
+    }
+
+    if (!sorted) {
+        radix_sort_rows(keys, rows, count, key_size(kind));
+    }
+
+    ecs_os_free(keys);
+
+    return !sorted;
+}
+
+/* Sort a table by key. The sorted order is computed first, after which each
+ * entity is moved at most once to its new row. */
+static
+void sort_table_by_key(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_table_t *table,
+    int32_t column_index)
+{
+    ecs_data_t *data = ecs_table_get_data(table);
+    if (!data || !data->entities) {
+        /* Nothing to sort */
+        return;
+    }
+
+    int32_t i, count = ecs_table_data_count(data);
+    if (count < 2) {
+        return;
+    }
+
+    int32_t *rows = ecs_os_malloc(count * ECS_SIZEOF(int32_t));
+    for (i = 0; i < count; i ++) {
+        rows[i] = i;
+    }
+
+    if (sort_rows_by_key(query, &data->columns[column_index], rows, count)) {
+        apply_row_order(world, table, data, rows, count);
+    }
+
+    ecs_os_free(rows);
+}
+
+/* Sort the rows of a table by key without moving them. Radix sort is stable, 
+ * so starting from the previous order keeps equal keys in the same order. */
+static
+void sort_table_rows_by_key(
+    ecs_query_t *query,
+    ecs_table_t *table,
+    ecs_matched_table_t *table_data,
+    int32_t column_index)
+{
+    ecs_data_t *data = ecs_table_get_data(table);
+    int32_t count = ecs_table_data_count(data);
+    int32_t *rows = prepare_sorted_rows(table_data, count);
+
+    if (count < 2) {
+        return;
+    }
+
+    sort_rows_by_key(query, &data->columns[column_index], rows, count);
 }
 
 /* Helper struct for building sorted table ranges */
@@ -1151,155 +1561,403 @@ typedef struct sort_helper_t {
     ecs_matched_table_t *table;
     ecs_entity_t *entities;
     const void *ptr;
+    int32_t *rows;
+    uint64_t key;
     int32_t row;
     int32_t elem_size;
     int32_t count;
     bool shared;
 } sort_helper_t;
 
+/* Get the table row for the current position of the helper. If rows are not
+ * sorted in place, the position is an index into the sorted rows. */
 static
-const void* ptr_from_helper(
+int32_t row_from_helper(
     sort_helper_t *helper)
 {
-    ecs_assert(helper->row < helper->count, ECS_INTERNAL_ERROR, NULL);
+    if (helper->rows) {
+        return helper->rows[helper->row];
+    } else {
+        return helper->row;
+    }
+}
+
+static
+const void* ptr_from_row(
+    sort_helper_t *helper,
+    int32_t row)
+{
     ecs_assert(helper->elem_size >= 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(helper->row >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(row >= 0, ECS_INTERNAL_ERROR, NULL);
     if (helper->shared) {
         return helper->ptr;
     } else {
-        return ELEM(helper->ptr, helper->elem_size, helper->row);
+        return ELEM(helper->ptr, helper->elem_size, row);
     }
 }
 
+static
+const void* ptr_from_helper(
+    sort_helper_t *helper)
+{
+    ecs_assert(helper->row < helper->count, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(helper->row >= 0, ECS_INTERNAL_ERROR, NULL);
+    return ptr_from_row(helper, row_from_helper(helper));
+}
+
 static
 ecs_entity_t e_from_helper(
     sort_helper_t *helper)
 {
     if (helper->row < helper->count) {
-        return helper->entities[helper->row];
+        return helper->entities[row_from_helper(helper)];
     } else {
         return 0;
     }
 }
 
 static
-void build_sorted_table_range(
+uint64_t key_from_row(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t row)
+{
+    return key_to_uint(query->sort_key_kind, 
+        ECS_OFFSET(ptr_from_row(helper, row), query->sort_key_offset));
+}
+
+/* Move helper to the next entity in the sorted order of its table */
+static
+void advance_helper(
+    ecs_query_t *query,
+    sort_helper_t *helper)
+{
+    helper->row ++;
+
+    /* Keys are cached so they don't have to be converted for each compare */
+    if ((query->flags & EcsQuerySortKey) && helper->row < helper->count) {
+        helper->key = key_from_row(query, helper, row_from_helper(helper));
+    }
+}
+
+/* Initialize helper for a table. Returns false if the table is empty. */
+static
+bool init_sort_helper(
+    ecs_query_t *query,
+    ecs_matched_table_t *table_data,
+    sort_helper_t *helper)
+{
+    ecs_world_t *world = query->world;
+    ecs_entity_t component = query->sort_on_component;
+    ecs_table_t *table = table_data->iter_data.table;
+    ecs_data_t *data = ecs_table_get_data(table);
+    ecs_vector_t *entities;
+    if (!data || !(entities = data->entities) || !ecs_table_count(table)) {
+        return false;
+    }
+
+    int32_t index = ecs_type_index_of(table->type, component);
+    if (index != -1) {
+        ecs_column_t *column = &data->columns[index];
+        int16_t size = column->size;
+        int16_t align = column->alignment;
+        helper->ptr = ecs_vector_first_t(column->data, size, align);
+        helper->elem_size = size;
+        helper->shared = false;
+    } else if (component) {
+        /* Find component in prefab */
+        ecs_entity_t base = ecs_find_entity_in_prefabs(
+            world, 0, table->type, component, 0);
+        
+        /* If a base was not found, the query should not have allowed using
+         * the component for sorting */
+        ecs_assert(base != 0, ECS_INTERNAL_ERROR, NULL);
+
+        const EcsComponent *cptr = ecs_get(world, component, EcsComponent);
+        ecs_assert(cptr != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        helper->ptr = ecs_get_w_entity(world, base, component);
+        helper->elem_size = cptr->size;
+        helper->shared = true;
+    } else {
+        helper->ptr = NULL;
+        helper->elem_size = 0;
+        helper->shared = false;
+    }
+
+    helper->table = table_data;
+    helper->entities = ecs_vector_first(entities, ecs_entity_t);
+    helper->rows = NULL;
+    helper->row = -1;
+    helper->count = ecs_table_count(table);
+
+    /* Tables for which the sort component is shared don't have sorted 
+     * rows, as all entities have the same value */
+    ecs_vector_t *sorted_rows = table_data->sorted_rows;
+    if ((query->flags & EcsQuerySortRows) && 
+        ecs_vector_count(sorted_rows) == helper->count) 
+    {
+        helper->rows = ecs_vector_first(sorted_rows, int32_t);
+    }
+
+    advance_helper(query, helper);
+
+    return true;
+}
+
+/* Compare table rows of two helpers, independent of the helper position */
+static
+int compare_helper_rows(
+    ecs_query_t *query,
+    sort_helper_t *helper_1,
+    int32_t row_1,
+    sort_helper_t *helper_2,
+    int32_t row_2)
+{
+    if (query->flags & EcsQuerySortKey) {
+        uint64_t key_1 = key_from_row(query, helper_1, row_1);
+        uint64_t key_2 = key_from_row(query, helper_2, row_2);
+        return (key_1 > key_2) - (key_1 < key_2);
+    } else {
+        return query->compare(
+            helper_1->entities[row_1], ptr_from_row(helper_1, row_1),
+            helper_2->entities[row_2], ptr_from_row(helper_2, row_2));
+    }
+}
+
+/* Find the helper with the lowest value. If values are equal, the helper that
+ * comes first wins. Returns -1 if all helpers are at the end of their table. */
+static
+int32_t min_helper(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t count)
+{
+    bool sort_key = (query->flags & EcsQuerySortKey) != 0;
+    int32_t i, min = -1;
+
+    for (i = 0; i < count; i ++) {
+        sort_helper_t *cur = &helper[i];
+        if (cur->row >= cur->count) {
+            continue;
+        }
+
+        if (min == -1) {
+            min = i;
+        } else if (sort_key) {
+            if (helper[min].key > cur->key) {
+                min = i;
+            }
+        } else {
+            sort_helper_t *min_h = &helper[min];
+            if (query->compare(e_from_helper(min_h), ptr_from_helper(min_h), 
+                e_from_helper(cur), ptr_from_helper(cur)) > 0) 
+            {
+                min = i;
+            }
+        }
+    }
+
+    return min;
+}
+
+/* Add rows to the sorted slices. A slice can only be extended with the next 
+ * row in the table, as iterators expect rows to be stored consecutively. */
+static
+void add_table_slice(
+    ecs_vector_t **slices,
+    ecs_matched_table_t *table,
+    int32_t row,
+    int32_t count)
+{
+    ecs_table_slice_t *cur = ecs_vector_last(*slices, ecs_table_slice_t);
+    if (cur && cur->table == table && row == (cur->start_row + cur->count)) {
+        cur->count += count;
+    } else {
+        cur = ecs_vector_add(slices, ecs_table_slice_t);
+        ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
+        cur->table = table;
+        cur->start_row = row;
+        cur->count = count;
+    }
+}
+
+static
+void build_sorted_table_range(
+    ecs_query_t *query,
+    int32_t start,
+    int32_t end)
+{
+    /* Fetch data from all matched tables */
+    ecs_matched_table_t *tables = ecs_vector_first(query->tables, ecs_matched_table_t);
+    sort_helper_t *helper = ecs_os_malloc((end - start) * ECS_SIZEOF(sort_helper_t));
+
+    int32_t i, to_sort = 0;
+    for (i = start; i < end; i ++) {
+        if (init_sort_helper(query, &tables[i], &helper[to_sort])) {
+            to_sort ++;
+        }
+    }
+
+    int32_t min;
+    while ((min = min_helper(query, helper, to_sort)) != -1) {
+        sort_helper_t *cur = &helper[min];
+        add_table_slice(&query->table_slices, cur->table, 
+            row_from_helper(cur), 1);
+        advance_helper(query, cur);
+    }
+
+    ecs_os_free(helper);
+}
+
+/* Merge the entities of tables that changed with the previous slices of tables
+ * that did not change. Those slices are still in order, so finding where the
+ * next changed entity goes only requires a binary search in one slice. */
+static
+void patch_sorted_table_range(
     ecs_query_t *query,
     int32_t start,
-    int32_t end)
+    int32_t end,
+    bool *dirty,
+    ecs_table_slice_t *slices,
+    int32_t slice_count)
 {
-    ecs_world_t *world = query->world;
-    ecs_entity_t component = query->sort_on_component;
-    ecs_compare_action_t compare = query->compare;
-
-    /* Fetch data from all matched tables */
     ecs_matched_table_t *tables = ecs_vector_first(query->tables, ecs_matched_table_t);
     sort_helper_t *helper = ecs_os_malloc((end - start) * ECS_SIZEOF(sort_helper_t));
+    sort_helper_t *changed = ecs_os_malloc((end - start) * ECS_SIZEOF(sort_helper_t));
 
-    int i, to_sort = 0;
+    int32_t i, changed_count = 0;
     for (i = start; i < end; i ++) {
-        ecs_matched_table_t *table_data = &tables[i];
-        ecs_table_t *table = table_data->iter_data.table;
-        ecs_data_t *data = ecs_table_get_data(table);
-        ecs_vector_t *entities;
-        if (!data || !(entities = data->entities) || !ecs_table_count(table)) {
-            continue;
+        if (dirty[i]) {
+            if (init_sort_helper(query, &tables[i], &changed[changed_count])) {
+                changed_count ++;
+            }
+        } else {
+            init_sort_helper(query, &tables[i], &helper[i - start]);
         }
+    }
 
-        int32_t index = ecs_type_index_of(table->type, component);
-        if (index != -1) {
-            ecs_column_t *column = &data->columns[index];
-            int16_t size = column->size;
-            int16_t align = column->alignment;
-            helper[to_sort].ptr = ecs_vector_first_t(column->data, size, align);
-            helper[to_sort].elem_size = size;
-            helper[to_sort].shared = false;
-        } else if (component) {
-            /* Find component in prefab */
-            ecs_entity_t base = ecs_find_entity_in_prefabs(
-                world, 0, table->type, component, 0);
-            
-            /* If a base was not found, the query should not have allowed using
-             * the component for sorting */
-            ecs_assert(base != 0, ECS_INTERNAL_ERROR, NULL);
-
-            const EcsComponent *cptr = ecs_get(world, component, EcsComponent);
-            ecs_assert(cptr != NULL, ECS_INTERNAL_ERROR, NULL);
+    int32_t min = min_helper(query, changed, changed_count);
 
-            helper[to_sort].ptr = ecs_get_w_entity(world, base, component);
-            helper[to_sort].elem_size = cptr->size;
-            helper[to_sort].shared = true;
-        } else {
-            helper[to_sort].ptr = NULL;
-            helper[to_sort].elem_size = 0;
-            helper[to_sort].shared = false;
+    for (i = 0; i < slice_count; i ++) {
+        ecs_table_slice_t *slice = &slices[i];
+        int32_t index = (int32_t)(slice->table - tables);
+        if (dirty[index]) {
+            continue;
         }
 
-        helper[to_sort].table = table_data;
-        helper[to_sort].entities = ecs_vector_first(entities, ecs_entity_t);
-        helper[to_sort].row = 0;
-        helper[to_sort].count = ecs_table_count(table);
-        to_sort ++;      
-    }
+        sort_helper_t *cur = &helper[index - start];
+        int32_t row = slice->start_row, slice_end = row + slice->count;
 
-    ecs_table_slice_t *cur = NULL;
+        while (min != -1 && row < slice_end) {
+            sort_helper_t *next = &changed[min];
+            int32_t next_row = row_from_helper(next);
 
-    bool proceed;
-    do {
-        int32_t j, min = 0;
-        proceed = true;
-
-        ecs_entity_t e1;
-        while (!(e1 = e_from_helper(&helper[min]))) {
-            min ++;
-            if (min == to_sort) {
-                proceed = false;
-                break;
-            }
-        }
+            /* If values are equal, the table that comes first goes first */
+            int tie = next->table < slice->table;
 
-        if (!proceed) {
-            break;
-        }
+            /* Find first row in slice that goes after the changed entity. Test
+             * the last row first, as most slices are not split. */
+            int32_t lo = row, hi = slice_end;
+            if (compare_helper_rows(
+                query, next, next_row, cur, slice_end - 1) >= tie) 
+            {
+                lo = slice_end;
+            }
 
-        for (j = min + 1; j < to_sort; j++) {
-            ecs_entity_t e2 = e_from_helper(&helper[j]);
-            if (!e2) {
-                continue;
+            while (lo < hi) {
+                int32_t mid = lo + (hi - lo) / 2;
+                if (compare_helper_rows(
+                    query, next, next_row, cur, mid) < tie) 
+                {
+                    hi = mid;
+                } else {
+                    lo = mid + 1;
+                }
             }
 
-            const void *ptr1 = ptr_from_helper(&helper[min]);
-            const void *ptr2 = ptr_from_helper(&helper[j]);
+            if (lo != row) {
+                add_table_slice(
+                    &query->table_slices, slice->table, row, lo - row);
+                row = lo;
+            }
 
-            if (compare(e1, ptr1, e2, ptr2) > 0) {
-                min = j;
+            if (row < slice_end) {
+                add_table_slice(&query->table_slices, next->table, next_row, 1);
+                advance_helper(query, next);
+                min = min_helper(query, changed, changed_count);
             }
         }
 
-        sort_helper_t *cur_helper = &helper[min];
-
-        if (!cur || cur->table != cur_helper->table) {
-            cur = ecs_vector_add(&query->table_slices, ecs_table_slice_t);
-            ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
-            cur->table = cur_helper->table;
-            cur->start_row = cur_helper->row;
-            cur->count = 1;
-        } else {
-            cur->count ++;
+        if (row < slice_end) {
+            add_table_slice(
+                &query->table_slices, slice->table, row, slice_end - row);
         }
+    }
 
-        cur_helper->row ++;
-    } while (proceed);
+    while (min != -1) {
+        sort_helper_t *next = &changed[min];
+        add_table_slice(&query->table_slices, next->table, 
+            row_from_helper(next), 1);
+        advance_helper(query, next);
+        min = min_helper(query, changed, changed_count);
+    }
 
     ecs_os_free(helper);
+    ecs_os_free(changed);
+}
+
+/* Build slices for tables in a group. If a table is not marked as dirty, its
+ * previous slices are still valid, and tables that changed are merged in. */
+static
+void build_sorted_group(
+    ecs_query_t *query,
+    int32_t start,
+    int32_t end,
+    bool *dirty,
+    ecs_table_slice_t *slices,
+    int32_t slice_count,
+    int32_t *slice_index)
+{
+    ecs_matched_table_t *tables = ecs_vector_first(query->tables, ecs_matched_table_t);
+
+    /* Previous slices for the group are stored consecutively */
+    int32_t first = *slice_index, last = first;
+    while (last < slice_count && (slices[last].table - tables) < end) {
+        last ++;
+    }
+    *slice_index = last;
+
+    int32_t i, changed = 0;
+    if (dirty) {
+        for (i = start; i < end; i ++) {
+            changed += dirty[i];
+        }
+    }
+
+    if (!dirty || changed == (end - start)) {
+        build_sorted_table_range(query, start, end);
+    } else if (changed) {
+        patch_sorted_table_range(
+            query, start, end, dirty, &slices[first], last - first);
+    } else if (last != first) {
+        ecs_table_slice_t *dst = ecs_vector_addn(
+            &query->table_slices, ecs_table_slice_t, last - first);
+        ecs_os_memcpy(dst, &slices[first], 
+            (last - first) * ECS_SIZEOF(ecs_table_slice_t));
+    }
 }
 
+/* Build slices for all tables. If dirty is NULL, all slices are rebuilt. */
 static
 void build_sorted_tables(
-    ecs_query_t *query)
+    ecs_query_t *query,
+    bool *dirty)
 {
-    /* Clean previous sorted tables */
-    ecs_vector_free(query->table_slices);
+    ecs_vector_t *prev_slices = query->table_slices;
+    ecs_table_slice_t *slices = ecs_vector_first(
+        prev_slices, ecs_table_slice_t);
+    int32_t slice_count = ecs_vector_count(prev_slices), slice_index = 0;
     query->table_slices = NULL;
 
     int32_t i, count = ecs_vector_count(query->tables);
@@ -1311,7 +1969,8 @@ void build_sorted_tables(
         table = &tables[i];
         if (rank != table->rank) {
             if (start != i) {
-                build_sorted_table_range(query, start, i);
+                build_sorted_group(query, start, i, dirty, 
+                    slices, slice_count, &slice_index);
                 start = i;
             }
             rank = table->rank;
@@ -1319,8 +1978,11 @@ void build_sorted_tables(
     }
 
     if (start != i) {
-        build_sorted_table_range(query, start, i);
+        build_sorted_group(query, start, i, dirty, 
+            slices, slice_count, &slice_index);
     }
+
+    ecs_vector_free(prev_slices);
 }
 
 static
@@ -1361,7 +2023,11 @@ static
 void tables_reset_dirty(
     ecs_query_t *query)
 {
-    query->prev_match_count = query->match_count;
+    /* Only write values that changed. Worker threads iterate the same query,
+     * and when nothing changed they should not write to it. */
+    if (query->prev_match_count != query->match_count) {
+        query->prev_match_count = query->match_count;
+    }
 
     int32_t i, count = ecs_vector_count(query->tables);
     ecs_matched_table_t *tables = ecs_vector_first(
@@ -1380,18 +2046,34 @@ void tables_reset_dirty(
         int32_t *dirty_state = ecs_table_get_dirty_state(table);
         int32_t t, type_count = table->column_count;
         for (t = 0; t < type_count + 1; t ++) {
-            table_data->monitor[t] = dirty_state[t];
+            if (table_data->monitor[t] != dirty_state[t]) {
+                table_data->monitor[t] = dirty_state[t];
+            }
         }
     }
 }
 
+static
+bool* mark_dirty(
+    bool *dirty,
+    int32_t count,
+    int32_t index)
+{
+    if (!dirty) {
+        dirty = ecs_os_calloc(count * ECS_SIZEOF(bool));
+    }
+    dirty[index] = true;
+    return dirty;
+}
+
 static
 void sort_tables(
     ecs_world_t *world,
     ecs_query_t *query)
 {
     ecs_compare_action_t compare = query->compare;
-    if (!compare) {
+    bool sort_key = (query->flags & EcsQuerySortKey) != 0;
+    if (!compare && !sort_key) {
         return;
     }
     
@@ -1404,6 +2086,14 @@ void sort_tables(
         query->tables, ecs_matched_table_t);
     bool tables_sorted = false;
 
+    /* If the matched tables did not change, the previous slices can be patched
+     * with the tables that changed, instead of rebuilding all slices. The
+     * array that marks changed tables is allocated when the first changed
+     * table is found, so iterating a query that didn't change is free. */
+    bool patch = query->table_slices && 
+        query->match_count == query->prev_match_count;
+    bool *dirty = NULL;
+
     for (i = 0; i < count; i ++) {
         ecs_matched_table_t *table_data = &tables[i];
         ecs_table_t *table = table_data->iter_data.table;
@@ -1431,24 +2121,52 @@ void sort_tables(
                 is_dirty = is_dirty || (dirty_state[index + 1] != table_data->monitor[index + 1]);
             } else {
                 /* Table does not contain component which means the sorted
-                 * component is shared. Table does not need to be sorted */
+                 * component is shared. Table does not need to be sorted, but
+                 * the shared value is not monitored, so always merge it. */
+                if (patch) {
+                    dirty = mark_dirty(dirty, count, i);
+                }
                 continue;
             }
         }      
         
         /* Check both if entities have moved (element 0) or if the component
          * we're sorting on has changed (index + 1) */
-        if (is_dirty) {
+        if (query->flags & EcsQuerySortRows) {
+            /* Sorted rows are also missing after changing the sort order */
+            if (is_dirty || !table_data->sorted_rows) {
+                if (sort_key) {
+                    sort_table_rows_by_key(query, table, table_data, index);
+                } else {
+                    sort_table_rows(table, table_data, index, compare);
+                }
+                tables_sorted = true;
+            } else {
+                continue;
+            }
+        } else if (is_dirty) {
             /* Sort the table */
-            sort_table(world, table, index, compare);
+            if (sort_key) {
+                sort_table_by_key(world, query, table, index);
+            } else {
+                sort_table(world, table, index, compare);
+            }
             tables_sorted = true;
+        } else {
+            continue;
+        }
+
+        if (patch) {
+            dirty = mark_dirty(dirty, count, i);
         }
     }
 
     if (tables_sorted || query->match_count != query->prev_match_count) {
-        build_sorted_tables(query);
+        build_sorted_tables(query, dirty);
         query->match_count ++; /* Increase version if tables changed */
     }
+
+    ecs_os_free(dirty);
 }
 
 static
@@ -1885,6 +2603,7 @@ void free_matched_table(
     ecs_os_free(table->sparse_columns);
     ecs_os_free(table->bitset_columns);
     ecs_os_free(table->monitor);
+    ecs_vector_free(table->sorted_rows);
 }
 
 /** Check if a table was matched with the system */
@@ -1970,6 +2689,12 @@ void remove_table(
      * the memory of mt */
     free_matched_table(mt);  
     move_table(query, mt->iter_data.table, index, NULL, tables, empty);
+
+    /* Removing an active table moves another table, so sorted slices that 
+     * point to matched tables need to be rebuilt */
+    if (!empty) {
+        query->match_count ++;
+    }
 }
 
 static
@@ -2508,6 +3233,34 @@ int find_smallest_column(
     return index;
 }
 
+/* When a case covers at least 1/SWITCH_SCAN_RATIO of the rows in a table, it
+ * is cheaper to scan the switch values linearly than to follow the case list,
+ * which visits rows in LIFO order and rarely yields contiguous runs. */
+#define SWITCH_SCAN_RATIO (8)
+
+static
+bool sparse_row_matches(
+    ecs_sparse_column_t *columns,
+    int32_t count,
+    int32_t skip,
+    int32_t row)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        if (i == skip) {
+            /* Already validated this one */
+            continue;
+        }
+
+        ecs_sparse_column_t *column = &columns[i];
+        if (ecs_switch_get(column->sw_column->data, row) != column->sw_case) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static
 int sparse_column_next(
     ecs_table_t *table,
@@ -2530,44 +3283,95 @@ int sparse_column_next(
     ecs_sparse_column_t *columns = ecs_vector_first(
         sparse_columns, ecs_sparse_column_t);
     ecs_sparse_column_t *column = &columns[sparse_smallest];
-    ecs_switch_t *sw, *sw_smallest = column->sw_column->data;
+    ecs_switch_t *sw_smallest = column->sw_column->data;
     ecs_entity_t case_smallest = column->sw_case;
+    int32_t count = ecs_vector_count(sparse_columns);
 
-    /* Find next entity to iterate in sparse column */
-    int32_t first;
     if (first_iteration) {
-        first = ecs_switch_first(sw_smallest, case_smallest);
-    } else {
-        first = ecs_switch_next(sw_smallest, iter->sparse_first);
+        int32_t case_count = ecs_switch_case_count(sw_smallest, case_smallest);
+        iter->sparse_scan = case_count * SWITCH_SCAN_RATIO >= 
+            ecs_table_count(table);
+        iter->sparse_first = 0;
     }
 
-    if (first == -1) {
-        goto done;
-    }    
+    int32_t lo, hi;
 
-    /* Check if entity matches with other sparse columns, if any */
-    int32_t i, count = ecs_vector_count(sparse_columns);
-    do {
-        for (i = 0; i < count; i ++) {
-            if (i == sparse_smallest) {
-                /* Already validated this one */
-                continue;
+    if (iter->sparse_scan) {
+        /* Dense case: find the next run of matching rows in the values array.
+         * sparse_first is the first row that hasn't been visited yet. */
+        uint64_t *values = ecs_vector_first(
+            ecs_switch_values(sw_smallest), uint64_t);
+        int32_t row = iter->sparse_first, table_count = ecs_table_count(table);
+
+        for (; row < table_count; row ++) {
+            if (values[row] == case_smallest && 
+                sparse_row_matches(columns, count, sparse_smallest, row)) 
+            {
+                break;
             }
+        }
+
+        if (row == table_count) {
+            goto done;
+        }
 
-            column = &columns[i];
-            sw = column->sw_column->data;
+        lo = row;
+        for (row ++; row < table_count; row ++) {
+            if (values[row] != case_smallest || 
+                !sparse_row_matches(columns, count, sparse_smallest, row)) 
+            {
+                break;
+            }
+        }
 
-            if (ecs_switch_get(sw, first) != column->sw_case) {
-                first = ecs_switch_next(sw_smallest, first);
-                if (first == -1) {
-                    goto done;
-                }
+        hi = row - 1;
+        iter->sparse_first = row;
+    } else {
+        /* Sparse case: follow the case list. sparse_first is the last list
+         * element that was visited. */
+        int32_t elem;
+        if (first_iteration) {
+            elem = ecs_switch_first(sw_smallest, case_smallest);
+        } else {
+            elem = ecs_switch_next(sw_smallest, iter->sparse_first);
+        }
+
+        while (elem != -1 && 
+            !sparse_row_matches(columns, count, sparse_smallest, elem)) 
+        {
+            elem = ecs_switch_next(sw_smallest, elem);
+        }
+
+        if (elem == -1) {
+            goto done;
+        }
+
+        /* Grow the run for as long as the list visits adjacent rows */
+        lo = hi = elem;
+        int32_t next;
+        while ((next = ecs_switch_next(sw_smallest, elem)) != -1) {
+            if (next != lo - 1 && next != hi + 1) {
+                break;
+            }
+
+            if (!sparse_row_matches(columns, count, sparse_smallest, next)) {
+                break;
             }
+
+            if (next < lo) {
+                lo = next;
+            } else {
+                hi = next;
+            }
+
+            elem = next;
         }
-    } while (i != count);
 
-    cur->first = iter->sparse_first = first;
-    cur->count = 1;
+        iter->sparse_first = elem;
+    }
+
+    cur->first = lo;
+    cur->count = hi - lo + 1;
 
     return 0;
 done:
@@ -2575,12 +3379,105 @@ done:
      * next matched table. */
     iter->sparse_smallest = 0;
     iter->sparse_first = 0;
+    iter->sparse_scan = false;
 
     return -1;
 }
 
 #define BS_MAX ((uint64_t)0xFFFFFFFFFFFFFFFF)
 
+/* Number of bitset words that are combined in one step (256 bits) */
+#define BS_WORDS (4)
+
+/* Index of the lowest set bit. v must not be 0. */
+static
+int32_t bs_ctz(
+    uint64_t v)
+{
+    ecs_assert(v != 0, ECS_INTERNAL_ERROR, NULL);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (int32_t)index;
+#else
+    int32_t index = 0;
+    if (!(v & 0xFFFFFFFF)) { v >>= 32; index += 32; }
+    if (!(v & 0xFFFF)) { v >>= 16; index += 16; }
+    if (!(v & 0xFF)) { v >>= 8; index += 8; }
+    if (!(v & 0xF)) { v >>= 4; index += 4; }
+    if (!(v & 0x3)) { v >>= 2; index += 2; }
+    if (!(v & 0x1)) { index += 1; }
+    return index;
+#endif
+}
+
+/* AND the words of all bitset columns, starting from block. Returns the number
+ * of words written to out, which is at most BS_WORDS. */
+static
+int32_t bitset_and_words(
+    uint64_t **data,
+    int32_t count,
+    int32_t block,
+    int32_t block_count,
+    uint64_t *out)
+{
+    int32_t i, w, n = block_count - block;
+
+    if (n >= BS_WORDS) {
+#if defined(__AVX2__)
+        __m256i v = _mm256_loadu_si256((const __m256i*)&data[0][block]);
+        for (i = 1; i < count; i ++) {
+            v = _mm256_and_si256(v, 
+                _mm256_loadu_si256((const __m256i*)&data[i][block]));
+        }
+        _mm256_storeu_si256((__m256i*)out, v);
+#elif defined(__SSE2__)
+        __m128i lo = _mm_loadu_si128((const __m128i*)&data[0][block]);
+        __m128i hi = _mm_loadu_si128((const __m128i*)&data[0][block + 2]);
+        for (i = 1; i < count; i ++) {
+            lo = _mm_and_si128(lo, 
+                _mm_loadu_si128((const __m128i*)&data[i][block]));
+            hi = _mm_and_si128(hi, 
+                _mm_loadu_si128((const __m128i*)&data[i][block + 2]));
+        }
+        _mm_storeu_si128((__m128i*)out, lo);
+        _mm_storeu_si128((__m128i*)&out[2], hi);
+#elif defined(__ARM_NEON)
+        uint64x2_t lo = vld1q_u64(&data[0][block]);
+        uint64x2_t hi = vld1q_u64(&data[0][block + 2]);
+        for (i = 1; i < count; i ++) {
+            lo = vandq_u64(lo, vld1q_u64(&data[i][block]));
+            hi = vandq_u64(hi, vld1q_u64(&data[i][block + 2]));
+        }
+        vst1q_u64(out, lo);
+        vst1q_u64(&out[2], hi);
+#else
+        for (w = 0; w < BS_WORDS; w ++) {
+            out[w] = data[0][block + w];
+        }
+        for (i = 1; i < count; i ++) {
+            for (w = 0; w < BS_WORDS; w ++) {
+                out[w] &= data[i][block + w];
+            }
+        }
+#endif
+        return BS_WORDS;
+    }
+
+    /* Last words of the bitset */
+    for (w = 0; w < n; w ++) {
+        uint64_t v = data[0][block + w];
+        for (i = 1; i < count; i ++) {
+            v &= data[i][block + w];
+        }
+        out[w] = v;
+    }
+
+    return n;
+}
+
 static
 int bitset_column_next(
     ecs_table_t *table,
@@ -2588,179 +3485,125 @@ int bitset_column_next(
     ecs_query_iter_t *iter,
     ecs_page_cursor_t *cur)
 {
-    /* Precomputed single-bit test */
-    static const uint64_t bitmask[64] = {
-    (uint64_t)1 << 0, (uint64_t)1 << 1, (uint64_t)1 << 2, (uint64_t)1 << 3,
-    (uint64_t)1 << 4, (uint64_t)1 << 5, (uint64_t)1 << 6, (uint64_t)1 << 7,
-    (uint64_t)1 << 8, (uint64_t)1 << 9, (uint64_t)1 << 10, (uint64_t)1 << 11,
-    (uint64_t)1 << 12, (uint64_t)1 << 13, (uint64_t)1 << 14, (uint64_t)1 << 15,
-    (uint64_t)1 << 16, (uint64_t)1 << 17, (uint64_t)1 << 18, (uint64_t)1 << 19,
-    (uint64_t)1 << 20, (uint64_t)1 << 21, (uint64_t)1 << 22, (uint64_t)1 << 23,
-    (uint64_t)1 << 24, (uint64_t)1 << 25, (uint64_t)1 << 26, (uint64_t)1 << 27,  
-    (uint64_t)1 << 28, (uint64_t)1 << 29, (uint64_t)1 << 30, (uint64_t)1 << 31,
-    (uint64_t)1 << 32, (uint64_t)1 << 33, (uint64_t)1 << 34, (uint64_t)1 << 35,  
-    (uint64_t)1 << 36, (uint64_t)1 << 37, (uint64_t)1 << 38, (uint64_t)1 << 39,
-    (uint64_t)1 << 40, (uint64_t)1 << 41, (uint64_t)1 << 42, (uint64_t)1 << 43,
-    (uint64_t)1 << 44, (uint64_t)1 << 45, (uint64_t)1 << 46, (uint64_t)1 << 47,  
-    (uint64_t)1 << 48, (uint64_t)1 << 49, (uint64_t)1 << 50, (uint64_t)1 << 51,
-    (uint64_t)1 << 52, (uint64_t)1 << 53, (uint64_t)1 << 54, (uint64_t)1 << 55,  
-    (uint64_t)1 << 56, (uint64_t)1 << 57, (uint64_t)1 << 58, (uint64_t)1 << 59,
-    (uint64_t)1 << 60, (uint64_t)1 << 61, (uint64_t)1 << 62, (uint64_t)1 << 63
-    };
-
-    /* Precomputed test to verify if remainder of block is set (or not) */
-    static const uint64_t bitmask_remain[64] = {
-    BS_MAX, BS_MAX - (BS_MAX >> 63), BS_MAX - (BS_MAX >> 62),
-    BS_MAX - (BS_MAX >> 61), BS_MAX - (BS_MAX >> 60), BS_MAX - (BS_MAX >> 59),
-    BS_MAX - (BS_MAX >> 58), BS_MAX - (BS_MAX >> 57), BS_MAX - (BS_MAX >> 56), 
-    BS_MAX - (BS_MAX >> 55), BS_MAX - (BS_MAX >> 54), BS_MAX - (BS_MAX >> 53), 
-    BS_MAX - (BS_MAX >> 52), BS_MAX - (BS_MAX >> 51), BS_MAX - (BS_MAX >> 50), 
-    BS_MAX - (BS_MAX >> 49), BS_MAX - (BS_MAX >> 48), BS_MAX - (BS_MAX >> 47), 
-    BS_MAX - (BS_MAX >> 46), BS_MAX - (BS_MAX >> 45), BS_MAX - (BS_MAX >> 44), 
-    BS_MAX - (BS_MAX >> 43), BS_MAX - (BS_MAX >> 42), BS_MAX - (BS_MAX >> 41), 
-    BS_MAX - (BS_MAX >> 40), BS_MAX - (BS_MAX >> 39), BS_MAX - (BS_MAX >> 38), 
-    BS_MAX - (BS_MAX >> 37), BS_MAX - (BS_MAX >> 36), BS_MAX - (BS_MAX >> 35), 
-    BS_MAX - (BS_MAX >> 34), BS_MAX - (BS_MAX >> 33), BS_MAX - (BS_MAX >> 32), 
-    BS_MAX - (BS_MAX >> 31), BS_MAX - (BS_MAX >> 30), BS_MAX - (BS_MAX >> 29), 
-    BS_MAX - (BS_MAX >> 28), BS_MAX - (BS_MAX >> 27), BS_MAX - (BS_MAX >> 26), 
-    BS_MAX - (BS_MAX >> 25), BS_MAX - (BS_MAX >> 24), BS_MAX - (BS_MAX >> 23), 
-    BS_MAX - (BS_MAX >> 22), BS_MAX - (BS_MAX >> 21), BS_MAX - (BS_MAX >> 20), 
-    BS_MAX - (BS_MAX >> 19), BS_MAX - (BS_MAX >> 18), BS_MAX - (BS_MAX >> 17), 
-    BS_MAX - (BS_MAX >> 16), BS_MAX - (BS_MAX >> 15), BS_MAX - (BS_MAX >> 14), 
-    BS_MAX - (BS_MAX >> 13), BS_MAX - (BS_MAX >> 12), BS_MAX - (BS_MAX >> 11), 
-    BS_MAX - (BS_MAX >> 10), BS_MAX - (BS_MAX >> 9), BS_MAX - (BS_MAX >> 8), 
-    BS_MAX - (BS_MAX >> 7), BS_MAX - (BS_MAX >> 6), BS_MAX - (BS_MAX >> 5), 
-    BS_MAX - (BS_MAX >> 4), BS_MAX - (BS_MAX >> 3), BS_MAX - (BS_MAX >> 2),
-    BS_MAX - (BS_MAX >> 1)
-    };
-
     int32_t i, count = ecs_vector_count(bitset_columns);
     ecs_bitset_column_t *columns = ecs_vector_first(
         bitset_columns, ecs_bitset_column_t);
     int32_t bs_offset = table->bs_column_offset;
+    int32_t elem_count = ecs_table_count(table);
 
-    int32_t first = iter->bitset_first;
-    int32_t last = 0;
+    uint64_t *data_stack[BS_WORDS];
+    uint64_t **data = data_stack;
+    if (count > BS_WORDS) {
+        data = ecs_os_malloc(ECS_SIZEOF(uint64_t*) * count);
+    }
 
     for (i = 0; i < count; i ++) {
         ecs_bitset_column_t *column = &columns[i];
         ecs_bs_column_t *bs_column = columns[i].bs_column;
 
         if (!bs_column) {
-            ecs_data_t *data = table->data;
+            ecs_data_t *table_data = table->data;
             int32_t index = column->column_index;
             ecs_assert((index - bs_offset >= 0), ECS_INTERNAL_ERROR, NULL);
-            bs_column = &data->bs_columns[index - bs_offset];
+            bs_column = &table_data->bs_columns[index - bs_offset];
             columns[i].bs_column = bs_column;
         }
-        
-        ecs_bitset_t *bs = &bs_column->data;
-        int32_t bs_elem_count = bs->count;
-        int32_t bs_block = first >> 6;
-        int32_t bs_block_count = ((bs_elem_count - 1) >> 6) + 1;
 
-        if (bs_block >= bs_block_count) {
-            goto done;
+        ecs_bitset_t *bs = &bs_column->data;
+        if (bs->count < elem_count) {
+            elem_count = bs->count;
         }
 
-        uint64_t *data = bs->data;
-        int32_t bs_start = first & 0x3F;
+        data[i] = bs->data;
+    }
 
-        /* Step 1: find the first non-empty block */
-        uint64_t v = data[bs_block];
-        uint64_t remain = bitmask_remain[bs_start];
-        while (!(v & remain)) {
-            /* If no elements are remaining, move to next block */
-            if ((++bs_block) >= bs_block_count) {
-                /* No non-empty blocks left */
-                goto done;
-            }
+    int32_t first = iter->bitset_first;
+    if (first >= elem_count) {
+        goto done;
+    }
 
-            bs_start = 0;
-            remain = BS_MAX; /* Test the full block */
-            v = data[bs_block];
-        }
+    /* Scan the combined bitsets BS_WORDS words at a time */
+    uint64_t words[BS_WORDS];
+    int32_t block_count = ((elem_count - 1) >> 6) + 1;
+    int32_t block = first >> 6, base = block, n = 0, w = 0;
+    uint64_t v;
 
-        /* Step 2: find the first non-empty element in the block */
-        while (!(v & bitmask[bs_start])) {
-            bs_start ++;
+    /* Step 1: find the first enabled element */
+    for (;;) {
+        if (w == n) {
+            if (block >= block_count) {
+                goto done;
+            }
 
-            /* Block was not empty, so bs_start must be smaller than 64 */
-            ecs_assert(bs_start < 64, ECS_INTERNAL_ERROR, NULL);
-        }
-        
-        /* Step 3: Find number of contiguous enabled elements after start */
-        int32_t bs_end = bs_start, bs_block_end = bs_block;
-        
-        remain = bitmask_remain[bs_end];
-        while ((v & remain) == remain) {
-            bs_end = 0;
-            bs_block_end ++;
+            base = block;
+            n = bitset_and_words(data, count, block, block_count, words);
+            block += n;
+            w = 0;
 
-            if (bs_block_end == bs_block_count) {
-                break;
+            if (base == (first >> 6)) {
+                /* Ignore elements before first */
+                words[0] &= BS_MAX << (first & 0x3F);
             }
-
-            v = data[bs_block_end];
-            remain = BS_MAX; /* Test the full block */
         }
 
-        /* Step 4: find remainder of enabled elements in current block */
-        if (bs_block_end != bs_block_count) {
-            while ((v & bitmask[bs_end])) {
-                bs_end ++;
-            }
+        if ((v = words[w])) {
+            break;
         }
 
-        /* Block was not 100% occupied, so bs_start must be smaller than 64 */
-        ecs_assert(bs_end < 64, ECS_INTERNAL_ERROR, NULL);
+        w ++;
+    }
 
-        /* Step 5: translate to element start/end and make sure that each column
-         * range is a subset of the previous one. */
-        first = bs_block * 64 + bs_start;
-        int32_t cur_last = bs_block_end * 64 + bs_end;
-        
-        /* No enabled elements found in table */
-        if (first == cur_last) {
-            goto done;
+    first = (base + w) * 64 + bs_ctz(v);
+    if (first >= elem_count) {
+        goto done;
+    }
+
+    /* Step 2: find the first disabled element after first */
+    int32_t last = elem_count;
+    v = ~words[w] & (BS_MAX << (first & 0x3F));
+    for (;;) {
+        if (v) {
+            last = (base + w) * 64 + bs_ctz(v);
+            break;
         }
 
-        /* If multiple bitsets are evaluated, make sure each subsequent range
-         * is equal or a subset of the previous range */
-        if (i) {
-            /* If the first element of a subsequent bitset is larger than the
-             * previous last value, start over. */
-            if (first >= last) {
-                i = -1;
-                continue;
+        if (++ w == n) {
+            if (block >= block_count) {
+                break;
             }
 
-            /* Make sure the last element of the range doesn't exceed the last
-             * element of the previous range. */
-            if (cur_last > last) {
-                cur_last = last;
-            }
+            base = block;
+            n = bitset_and_words(data, count, block, block_count, words);
+            block += n;
+            w = 0;
         }
-        
-        last = cur_last;
-        int32_t elem_count = last - first;
 
-        /* Make sure last element doesn't exceed total number of elements in 
-         * the table */
-        if (elem_count > bs_elem_count) {
-            elem_count = bs_elem_count;
-        }
-        
-        cur->first = first;
-        cur->count = elem_count;
-        iter->bitset_first = first;
+        v = ~words[w];
     }
-    
+
+    if (last > elem_count) {
+        last = elem_count;
+    }
+
+    if (data != data_stack) {
+        ecs_os_free(data);
+    }
+
+    cur->first = first;
+    cur->count = last - first;
+
     /* Keep track of last processed element for iteration */ 
     iter->bitset_first = last;
 
     return 0;
 done:
+    if (data != data_stack) {
+        ecs_os_free(data);
+    }
+
+    /* No more enabled elements in this table, next table starts at 0 */
+    iter->bitset_first = 0;
+
     return -1;
 }
 
@@ -2803,7 +3646,8 @@ bool ecs_query_next(
     ecs_matched_table_t *tables = ecs_vector_first(
         query->tables, ecs_matched_table_t);
 
-    ecs_assert(!slice || query->compare, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!slice || query->compare || (query->flags & EcsQuerySortKey), 
+        ECS_INTERNAL_ERROR, NULL);
     
     ecs_page_cursor_t cur;
     int32_t table_count = it->table_count;
@@ -2910,28 +3754,56 @@ bool ecs_query_next_worker(
     int32_t current,
     int32_t total)
 {
+    ecs_world_t *world = it->world;
     int32_t per_worker, first, prev_offset = it->offset;
 
+    ecs_get_stage(&world);
+
     do {
         if (!ecs_query_next(it)) {
             return false;
         }
 
-        int32_t count = it->count;
-        per_worker = count / total;
-        first = per_worker * current;
+        /* When columns are aligned, divide the table in units of rows that
+         * start on an aligned address, so that workers don't share cache
+         * lines. Rows before the first aligned row go to the first worker. */
+        int32_t count = it->count, align = 1;
+        if (it->table && it->table->table) {
+            align = ecs_table_row_alignment(world, it->table->table);
+        }
+
+        int32_t head = (align - it->offset % align) % align;
+        if (head > count) {
+            head = count;
+        }
 
-        count -= per_worker * total;
+        int32_t units = (count - head + align - 1) / align;
+        int32_t per_unit = units / total;
+        int32_t unit_first = per_unit * current;
+        int32_t remainder = units - per_unit * total;
 
-        if (count) {
-            if (current < count) {
-                per_worker ++;
-                first += current;
+        if (remainder) {
+            if (current < remainder) {
+                per_unit ++;
+                unit_first += current;
             } else {
-                first += count;
+                unit_first += remainder;
             }
         }
 
+        int32_t last = head + (unit_first + per_unit) * align;
+        if (last > count) {
+            last = count;
+        }
+
+        if (current) {
+            first = head + unit_first * align;
+        } else {
+            first = 0;
+        }
+
+        per_worker = ECS_MAX(0, last - first);
+
         if (!per_worker && !(it->query->flags & EcsQueryNeedsTables)) {
             if (current == 0) {
                 return true;
@@ -2950,11 +3822,13 @@ bool ecs_query_next_worker(
     return true;
 }
 
-void ecs_query_order_by(
+static
+void order_by(
     ecs_world_t *world,
     ecs_query_t *query,
     ecs_entity_t sort_component,
-    ecs_compare_action_t compare)
+    ecs_compare_action_t compare,
+    ecs_flags32_t sort_flags)
 {
     ecs_assert(query != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(!(query->flags & EcsQueryIsOrphaned), ECS_INVALID_PARAMETER, NULL);    
@@ -2963,16 +3837,94 @@ void ecs_query_order_by(
     query->sort_on_component = sort_component;
     query->compare = compare;
 
+    query->flags &= ~(ecs_flags32_t)(EcsQuerySortRows | EcsQuerySortKey);
+    query->flags |= sort_flags;
+
+    /* Rows sorted with the previous sort order are no longer valid */
+    ecs_vector_each(query->tables, ecs_matched_table_t, table_data, {
+        ecs_vector_free(table_data->sorted_rows);
+        table_data->sorted_rows = NULL;
+    });
+
+    ecs_vector_each(query->empty_tables, ecs_matched_table_t, table_data, {
+        ecs_vector_free(table_data->sorted_rows);
+        table_data->sorted_rows = NULL;
+    });
+
     ecs_vector_free(query->table_slices);
     query->table_slices = NULL;
 
     sort_tables(world, query);    
 
     if (!query->table_slices) {
-        build_sorted_tables(query);
+        build_sorted_tables(query, NULL);
     }
 }
 
+void ecs_query_order_by(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_compare_action_t compare)
+{
+    order_by(world, query, sort_component, compare, 0);
+}
+
+void ecs_query_order_by_rows(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_compare_action_t compare)
+{
+    order_by(world, query, sort_component, compare, EcsQuerySortRows);
+}
+
+static
+void order_by_key(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset,
+    ecs_flags32_t sort_flags)
+{
+    ecs_assert(query != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(sort_component != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(offset >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    const EcsComponent *cptr = ecs_get(world, sort_component, EcsComponent);
+    ecs_assert(cptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(offset + key_size(kind) <= cptr->size, 
+        ECS_INVALID_PARAMETER, NULL);
+    (void)cptr;
+
+    query->sort_key_kind = kind;
+    query->sort_key_offset = offset;
+
+    order_by(world, query, sort_component, NULL, sort_flags | EcsQuerySortKey);
+}
+
+void ecs_query_order_by_key(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset)
+{
+    order_by_key(world, query, sort_component, kind, offset, 0);
+}
+
+void ecs_query_order_by_key_rows(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_entity_t sort_component,
+    ecs_sort_key_kind_t kind,
+    ecs_size_t offset)
+{
+    order_by_key(world, query, sort_component, kind, offset, 
+        EcsQuerySortRows);
+}
+
 void ecs_query_group_by(
     ecs_world_t *world,
     ecs_query_t *query,
@@ -2990,7 +3942,10 @@ void ecs_query_group_by(
 
     order_ranked_tables(world, query);
 
-    build_sorted_tables(query);
+    /* Only sorted queries iterate slices */
+    if (query->compare || (query->flags & EcsQuerySortKey)) {
+        build_sorted_tables(query, NULL);
+    }
 }
 
 bool ecs_query_changed(
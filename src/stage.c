@@ -1,7 +1,81 @@
 #include "private_api.h"
 
+#define ARENA_HEADER_SIZE\
+    ECS_ALIGN(ECS_SIZEOF(ecs_arena_chunk_t), ECS_ARENA_ALIGNMENT)
+
+static
+void* arena_alloc(
+    ecs_arena_t *arena,
+    ecs_size_t size)
+{
+    ecs_assert(size > 0, ECS_INTERNAL_ERROR, NULL);
+
+    size = ECS_ALIGN(size, ECS_ARENA_ALIGNMENT);
+    ecs_arena_chunk_t *chunk = arena->cur.chunk;
+
+    if (!chunk || (arena->cur.used + size) > chunk->size) {
+        /* Chunks after the current chunk are not in use. Skip to the next chunk
+         * that is large enough, and free chunks that are too small. */
+        ecs_arena_chunk_t **next = chunk ? &chunk->next : &arena->chunks;
+        while (*next && (*next)->size < size) {
+            ecs_arena_chunk_t *small = *next;
+            *next = small->next;
+            ecs_os_free(small);
+        }
+
+        if (!*next) {
+            ecs_size_t chunk_size = ECS_ARENA_CHUNK_SIZE;
+            if (size > chunk_size) {
+                chunk_size = size;
+            }
+
+            ecs_arena_chunk_t *new_chunk = ecs_os_malloc(
+                ARENA_HEADER_SIZE + chunk_size);
+            ecs_assert(new_chunk != NULL, ECS_OUT_OF_MEMORY, NULL);
+            new_chunk->next = NULL;
+            new_chunk->size = chunk_size;
+            *next = new_chunk;
+        }
+
+        chunk = arena->cur.chunk = *next;
+        arena->cur.used = 0;
+    }
+
+    void *result = ECS_OFFSET(chunk, ARENA_HEADER_SIZE + arena->cur.used);
+    arena->cur.used += size;
+    return result;
+}
+
+static
+void arena_free(
+    ecs_arena_t *arena)
+{
+    ecs_arena_chunk_t *chunk = arena->chunks;
+    while (chunk) {
+        ecs_arena_chunk_t *next = chunk->next;
+        ecs_os_free(chunk);
+        chunk = next;
+    }
+
+    arena->chunks = NULL;
+    arena->cur = (ecs_arena_mark_t){ 0 };
+}
+
+static
+void* defer_alloc(
+    ecs_stage_t *stage,
+    ecs_size_t size)
+{
+    return arena_alloc(&stage->defer_arena, size);
+}
+
 static
 ecs_op_t* new_defer_op(ecs_stage_t *stage) {
+    if (!ecs_vector_count(stage->defer_queue)) {
+        /* Payloads of a queue are released when the queue is flushed */
+        stage->defer_mark = stage->defer_arena.cur;
+    }
+
     ecs_op_t *result = ecs_vector_add(&stage->defer_queue, ecs_op_t);
     ecs_os_memset(result, 0, ECS_SIZEOF(ecs_op_t));
     return result;
@@ -9,6 +83,7 @@ ecs_op_t* new_defer_op(ecs_stage_t *stage) {
 
 static 
 void new_defer_component_ids(
+    ecs_stage_t *stage,
     ecs_op_t *op, 
     ecs_entities_t *components)
 {
@@ -22,7 +97,7 @@ void new_defer_component_ids(
         };
     } else if (components_count) {
         ecs_size_t array_size = components_count * ECS_SIZEOF(ecs_entity_t);
-        op->components.array = ecs_os_malloc(array_size);
+        op->components.array = defer_alloc(stage, array_size);
         ecs_os_memcpy(op->components.array, components->array, array_size);
         op->components.count = components_count;
     } else {
@@ -52,7 +127,7 @@ bool defer_add_remove(
         op->scope = scope;
         op->is._1.entity = entity;
 
-        new_defer_component_ids(op, components);
+        new_defer_component_ids(stage, op, components);
 
         if (op_kind == EcsOpNew) {
             world->new_count ++;
@@ -185,7 +260,9 @@ bool ecs_defer_bulk_new(
     const ecs_entity_t **ids_out)
 {
     if (stage->defer) {
-        ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+        /* Create operation first, so payloads are released with the queue */
+        ecs_op_t *op = new_defer_op(stage);
+        ecs_entity_t *ids = defer_alloc(stage, count * ECS_SIZEOF(ecs_entity_t));
         void **defer_data = NULL;
 
         world->bulk_new_count ++;
@@ -200,14 +277,14 @@ bool ecs_defer_bulk_new(
         if (component_data) {
             int c, c_count = components_ids->count;
             ecs_entity_t *components = components_ids->array;
-            defer_data = ecs_os_malloc(ECS_SIZEOF(void*) * c_count);
+            defer_data = defer_alloc(stage, ECS_SIZEOF(void*) * c_count);
             for (c = 0; c < c_count; c ++) {
                 ecs_entity_t comp = components[c];
                 const EcsComponent *cptr = ecs_component_from_id(world, comp);
                 ecs_assert(cptr != NULL, ECS_INVALID_PARAMETER, NULL);
 
                 ecs_size_t size = cptr->size;
-                void *data = ecs_os_malloc(size * count);
+                void *data = defer_alloc(stage, size * count);
                 defer_data[c] = data;
 
                 ecs_c_info_t *cinfo = NULL;
@@ -233,12 +310,11 @@ bool ecs_defer_bulk_new(
         }
 
         /* Store data in op */
-        ecs_op_t *op = new_defer_op(stage);
         op->kind = EcsOpBulkNew;
         op->is._n.entities = ids;
         op->is._n.bulk_data = defer_data;
         op->is._n.count = count;
-        new_defer_component_ids(op, components_ids);
+        new_defer_component_ids(stage, op, components_ids);
         *ids_out = ids;
 
         return true;
@@ -300,7 +376,7 @@ bool ecs_defer_set(
         op->component = component;
         op->is._1.entity = entity;
         op->is._1.size = size;
-        op->is._1.value = ecs_os_malloc(size);
+        op->is._1.value = defer_alloc(stage, size);
 
         if (!value) {
             value = ecs_get_w_entity(world, entity, component);
@@ -418,5 +494,19 @@ void ecs_stage_deinit(
     (void)world;
     ecs_vector_free(stage->defer_queue);
     ecs_vector_free(stage->defer_merge_queue);
+    arena_free(&stage->defer_arena);
+}
+
+void ecs_stage_defer_release(
+    ecs_stage_t *stage,
+    ecs_arena_mark_t mark)
+{
+    stage->defer_arena.cur = mark;
+}
+
+void ecs_stage_defer_reset(
+    ecs_stage_t *stage)
+{
+    stage->defer_arena.cur = (ecs_arena_mark_t){ 0 };
 }
 
@@ -40,7 +40,8 @@ ecs_data_t* ecs_init_data(
                 if (component->size) {
                     /* This is a regular component column */
                     result->columns[i].size = ecs_to_i16(component->size);
-                    result->columns[i].alignment = ecs_to_i16(component->alignment);
+                    result->columns[i].alignment = ecs_to_i16(ECS_MAX(
+                        component->alignment, world->column_alignment));
                 } else {
                     /* This is a tag */
                 }
@@ -112,7 +113,10 @@ ecs_flags32_t get_component_action_flags(
     }
     if (c_info->on_remove) {
         flags |= EcsTableHasOnRemove;
-    }    
+    }
+    if (c_info->cold) {
+        flags |= EcsTableHasColdParts;
+    }
 
     return flags;  
 }
@@ -406,6 +410,135 @@ void ecs_table_activate(
             });                
         }
     }     
+
+    /* Table became empty, make it a candidate for garbage collection */
+    if (!activate && !query) {
+        ecs_table_gc_enqueue(world, table);
+    }
+}
+
+/* Release memory of an empty table. Columns are freed rather than shrunk, so
+ * that an empty table does not hold on to anything but its column array. The
+ * table is still valid, and allocates again when an entity is added. */
+void ecs_table_reclaim(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    (void)world;
+    ecs_data_t *data = ecs_table_get_data(table);
+    if (!data || !data->entities || ecs_table_data_count(data)) {
+        return;
+    }
+
+    ecs_column_t *columns = data->columns;
+    if (columns) {
+        int32_t c, column_count = table->column_count;
+        for (c = 0; c < column_count; c ++) {
+            ecs_vector_free_t(columns[c].data, columns[c].size, 
+                columns[c].alignment);
+            columns[c].data = NULL;
+        }
+    }
+
+    ecs_vector_free(data->entities);
+    ecs_vector_free(data->record_ptrs);
+    data->entities = NULL;
+    data->record_ptrs = NULL;
+
+    /* Invalidate references to the old column memory */
+    table->alloc_count ++;
+}
+
+/* Reallocate column buffers after the column alignment of the world changed */
+void ecs_table_realign_columns(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_data_t *data = ecs_table_get_data(table);
+    if (!data || !data->columns) {
+        return;
+    }
+
+    ecs_entity_t *components = ecs_vector_first(table->type, ecs_entity_t);
+    ecs_column_t *columns = data->columns;
+    int32_t c, column_count = table->column_count;
+    bool realloc = false;
+
+    for (c = 0; c < column_count; c ++) {
+        ecs_column_t *column = &columns[c];
+        int16_t size = column->size;
+        if (!size) {
+            continue;
+        }
+
+        const EcsComponent *component = ecs_component_from_id(
+            world, components[c]);
+        ecs_assert(component != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        int16_t alignment = ecs_to_i16(ECS_MAX(
+            component->alignment, world->column_alignment));
+        int16_t old_alignment = column->alignment;
+        if (alignment == old_alignment) {
+            continue;
+        }
+
+        ecs_vector_t *old_vec = column->data;
+        if (old_vec) {
+            int32_t count = ecs_vector_count(old_vec);
+            ecs_vector_t *new_vec = ecs_vector_new_w_pool_t(
+                world->pools[EcsPoolColumns], size, alignment, 
+                ecs_vector_size(old_vec));
+            ecs_vector_set_count_t(&new_vec, size, alignment, count);
+            ecs_os_memcpy(ecs_vector_first_t(new_vec, size, alignment),
+                ecs_vector_first_t(old_vec, size, old_alignment), size * count);
+            ecs_vector_free_t(old_vec, size, old_alignment);
+            column->data = new_vec;
+            realloc = true;
+        }
+
+        column->alignment = alignment;
+    }
+
+    if (realloc) {
+        table->alloc_count ++;
+    }
+}
+
+/* Get number of rows after which all columns of a table start at the column
+ * alignment of the world. Slices of a table that start at a multiple of this
+ * number are aligned in every column. */
+int32_t ecs_table_row_alignment(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    int32_t alignment = world->column_alignment;
+    ecs_data_t *data = table->data;
+    if (!alignment || !data || !data->columns) {
+        return 1;
+    }
+
+    ecs_column_t *columns = data->columns;
+    int32_t c, column_count = table->column_count;
+    int32_t result = 1;
+
+    for (c = 0; c < column_count; c ++) {
+        int32_t size = columns[c].size;
+        if (!size) {
+            continue;
+        }
+
+        /* Alignment is a power of two, so the number of rows needed to cover
+         * an aligned block is determined by the lowest set bit of the size */
+        int32_t size_alignment = size & -size;
+        if (size_alignment < alignment) {
+            int32_t rows = alignment / size_alignment;
+            if (rows > result) {
+                result = rows;
+            }
+        }
+    }
+
+    return result;
 }
 
 /* This function is called when a query is matched with a table. A table keeps
@@ -514,6 +647,19 @@ ecs_data_t* ecs_table_get_or_create_data(
     return get_data_intern(table, true);
 }
 
+/* Get the move action for relocating a value, which moves it to memory that
+ * has not been constructed and discards the old value without destructing it.
+ * Returns NULL if the value can be relocated with memcpy. */
+static
+ecs_move_t relocate_action(
+    const ecs_c_info_t * cdata)
+{
+    if (cdata && !cdata->lifecycle.relocatable) {
+        return cdata->lifecycle.move;
+    }
+    return NULL;
+}
+
 static
 void ctor_component(
     ecs_world_t * world,
@@ -596,6 +742,19 @@ void run_remove_actions(
     }
 }
 
+/* Entities are removed from a table. If the table is a chunk that was full, it
+ * can be appended to again. */
+static
+void remove_from_chunk(
+    ecs_table_t *table,
+    int32_t old_count,
+    int32_t size)
+{
+    if ((table->chunk_head || table->chunks) && old_count >= size) {
+        ecs_table_chunk_has_space(table);
+    }
+}
+
 void ecs_table_clear_data(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -612,7 +771,8 @@ void ecs_table_clear_data(
     if (columns) {
         int32_t c, column_count = table->column_count;
         for (c = 0; c < column_count; c ++) {
-            ecs_vector_free(columns[c].data);
+            ecs_vector_free_t(columns[c].data, columns[c].size, 
+                columns[c].alignment);
         }
         ecs_os_free(columns);
         data->columns = NULL;
@@ -658,11 +818,13 @@ void ecs_table_clear_silent(
     }
 
     int32_t count = ecs_vector_count(data->entities);
+    int32_t size = ecs_vector_size(data->entities);
     
     ecs_table_clear_data(world, table, data);
 
     if (count) {
         ecs_table_activate(world, table, 0, false);
+        remove_from_chunk(table, count, size);
     }
 }
 
@@ -716,10 +878,16 @@ void ecs_table_free(
 
     ecs_table_clear_edges(world, table);
 
-    ecs_os_free(table->lo_edges);
-    ecs_map_free(table->hi_edges);
+    ecs_map_free(table->edges);
     ecs_vector_free(table->queries);
-    ecs_vector_free((ecs_vector_t*)table->type);
+    ecs_vector_free(table->chunks);
+    ecs_vector_free(table->chunk_free);
+
+    /* The type of a chunk is owned by the first chunk of the type */
+    if (!table->chunk_head) {
+        ecs_vector_free((ecs_vector_t*)table->type);
+    }
+
     ecs_os_free(table->dirty_state);
     ecs_vector_free(table->monitors);
     ecs_vector_free(table->on_set_all);
@@ -749,10 +917,21 @@ void ecs_table_reset(
     ecs_table_t * table)
 {
     (void)world;
-    ecs_os_free(table->lo_edges);
-    ecs_map_free(table->hi_edges);
-    table->lo_edges = NULL;
-    table->hi_edges = NULL;
+
+    ecs_map_iter_t it = ecs_map_iter(table->edges);
+    ecs_edge_t *edge;
+    while ((edge = ecs_map_next(&it, ecs_edge_t, NULL))) {
+        if (edge->add_map) {
+            ecs_os_free(edge->add_map);
+        }
+        if (edge->remove_map) {
+            ecs_os_free(edge->remove_map);
+        }
+    }
+
+    ecs_map_free(table->edges);
+    table->edges = NULL;
+    ecs_os_memset(table->edge_cache, 0, ECS_SIZEOF(table->edge_cache));
 }
 
 static
@@ -773,7 +952,9 @@ void ecs_table_mark_dirty(
     if (table->dirty_state) {
         int32_t index = ecs_type_index_of(table->type, component);
         ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
-        table->dirty_state[index] ++;
+
+        /* Element 0 is reserved for changes to the entities in the table */
+        table->dirty_state[index + 1] ++;
     }
 }
 
@@ -926,6 +1107,23 @@ void ensure_data(
     }
 }
 
+/* Column storage is allocated from the column pool of the world. A vector
+ * remembers the pool it was allocated from, so only creating it needs the pool.
+ * The capacity is the number of elements that is about to be added. */
+static
+void ensure_column(
+    ecs_world_t *world,
+    ecs_vector_t **vec,
+    ecs_size_t size,
+    int16_t alignment,
+    int32_t elem_count)
+{
+    if (!*vec) {
+        *vec = ecs_vector_new_w_pool_t(
+            world->pools[EcsPoolColumns], size, alignment, elem_count);
+    }
+}
+
 static
 void grow_column(
     ecs_world_t * world,
@@ -936,10 +1134,11 @@ void grow_column(
     int32_t new_size,
     bool construct)
 {
-    ecs_vector_t *vec = column->data;
     int16_t alignment = column->alignment;
-
     int32_t size = column->size;
+    ensure_column(world, &column->data, size, alignment, new_size);
+
+    ecs_vector_t *vec = column->data;
     int32_t count = ecs_vector_count(vec);
     int32_t old_size = ecs_vector_size(vec);
     int32_t new_count = count + to_add;
@@ -948,14 +1147,19 @@ void grow_column(
     ecs_assert(new_size >= new_count, ECS_INTERNAL_ERROR, NULL);
 
     /* If the array could possibly realloc and the component has a move action 
-     * defined, move old elements manually */
+     * defined, move old elements manually. Columns must remain contiguous, as
+     * iterators and the direct access API expose them as a single array. This
+     * makes growing a large table expensive, which applications can prevent
+     * by preallocating tables with ecs_dim_type, or by limiting the size of
+     * tables with ecs_set_table_chunk_size. */
     ecs_move_t move;
-    if (c_info && count && can_realloc && (move = c_info->lifecycle.move)) {
+    if (count && can_realloc && (move = relocate_action(c_info))) {
         ecs_xtor_t ctor = c_info->lifecycle.ctor;
         ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
 
         /* Create new vector */
-        ecs_vector_t *new_vec = ecs_vector_new_t(size, alignment, new_size);
+        ecs_vector_t *new_vec = ecs_vector_new_w_pool_t(
+            world->pools[EcsPoolColumns], size, alignment, new_size);
         ecs_vector_set_count_t(&new_vec, size, alignment, new_count);
 
         void *old_buffer = ecs_vector_first_t(
@@ -975,7 +1179,7 @@ void grow_column(
             c_info->lifecycle.ctx);
 
         /* Free old vector */
-        ecs_vector_free(vec);
+        ecs_vector_free_t(vec, size, alignment);
         column->data = new_vec;
     } else {
         /* If array won't realloc or has no move, simply add new elements */
@@ -1023,6 +1227,8 @@ int32_t grow_data(
         &bs_column_count, &columns, &sw_columns, &bs_columns);    
 
     /* Add record to record ptr array */
+    ensure_column(world, &data->record_ptrs, ECS_SIZEOF(ecs_record_t*), 
+        ECS_ALIGNOF(ecs_record_t*), size);
     ecs_vector_set_size(&data->record_ptrs, ecs_record_t*, size);
     ecs_record_t **r = ecs_vector_addn(&data->record_ptrs, ecs_record_t*, to_add);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -1031,6 +1237,8 @@ int32_t grow_data(
     }
 
     /* Add entity to column with entity ids */
+    ensure_column(world, &data->entities, ECS_SIZEOF(ecs_entity_t), 
+        ECS_ALIGNOF(ecs_entity_t), size);
     ecs_vector_set_size(&data->entities, ecs_entity_t, size);
     ecs_entity_t *e = ecs_vector_addn(&data->entities, ecs_entity_t, to_add);
     ecs_assert(e != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -1093,6 +1301,7 @@ int32_t grow_data(
 
 static
 void fast_append(
+    ecs_world_t *world,
     ecs_column_t *columns,
     int32_t column_count)
 {
@@ -1103,6 +1312,7 @@ void fast_append(
         int16_t size = column->size;
         if (size) {
             int16_t alignment = column->alignment;
+            ensure_column(world, &column->data, size, alignment, 2);
             ecs_vector_add_t(&column->data, size, alignment);
         }
     }
@@ -1135,6 +1345,8 @@ int32_t ecs_table_append(
         &bs_column_count, &columns, &sw_columns, &bs_columns);
 
     /* Grow buffer with entity ids, set new element to new entity */
+    ensure_column(world, &data->entities, ECS_SIZEOF(ecs_entity_t), 
+        ECS_ALIGNOF(ecs_entity_t), 2);
     ecs_entity_t *e = ecs_vector_add(&data->entities, ecs_entity_t);
     ecs_assert(e != NULL, ECS_INTERNAL_ERROR, NULL);
     *e = entity;    
@@ -1144,6 +1356,8 @@ int32_t ecs_table_append(
     table->alloc_count += (count == size);
 
     /* Add record ptr to array with record ptrs */
+    ensure_column(world, &data->record_ptrs, ECS_SIZEOF(ecs_record_t*), 
+        ECS_ALIGNOF(ecs_record_t*), 2);
     ecs_record_t **r = ecs_vector_add(&data->record_ptrs, ecs_record_t*);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
     *r = record;
@@ -1161,7 +1375,7 @@ int32_t ecs_table_append(
 
     /* Fast path: no switch columns, no lifecycle actions */
     if (!(table->flags & EcsTableIsComplex)) {
-        fast_append(columns, column_count);
+        fast_append(world, columns, column_count);
         return count;
     }
 
@@ -1270,6 +1484,7 @@ void ecs_table_delete(
 
     ecs_entity_t *entities = ecs_vector_first(entity_column, ecs_entity_t);
     ecs_entity_t entity_to_move = entities[count];
+    ecs_entity_t entity_to_delete = entities[index];
 
     /* Move last entity id to index */
     entities[index] = entity_to_move;
@@ -1305,6 +1520,8 @@ void ecs_table_delete(
         ecs_table_activate(world, table, NULL, false);
     }
 
+    remove_from_chunk(table, count + 1, ecs_vector_size(entity_column));
+
     /* Move each component value in array to index */
     ecs_column_t *columns = data->columns;
 
@@ -1328,7 +1545,7 @@ void ecs_table_delete(
             void *dst = ecs_vector_get_t(column->data, size, alignment, index);
 
             ecs_move_t move;
-            if (c_info && (count != index) && (move = c_info->lifecycle.move)) {
+            if ((count != index) && (move = relocate_action(c_info))) {
                 void *ctx = c_info->lifecycle.ctx;
                 void *src = ecs_vector_get_t(column->data, size, alignment, count);
                 ecs_entity_t component = c_info->component;
@@ -1353,7 +1570,7 @@ void ecs_table_delete(
                 ecs_vector_remove_last(column->data);                              
             } else {
                 if (destruct && c_info && (dtor = c_info->lifecycle.dtor)) {
-                    dtor(world, c_info->component, &entities[index], dst, 
+                    dtor(world, c_info->component, &entity_to_delete, dst, 
                         ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
                 }
 
@@ -1377,6 +1594,131 @@ void ecs_table_delete(
     }    
 }
 
+ecs_move_map_t* ecs_move_map_new(
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data)
+{
+    int32_t i_new = 0, new_column_count = new_table->column_count;
+    int32_t i_old = 0, old_column_count = old_table->column_count;
+    ecs_entity_t *new_components = ecs_vector_first(
+        new_table->type, ecs_entity_t);
+    ecs_entity_t *old_components = ecs_vector_first(
+        old_table->type, ecs_entity_t);
+
+    ecs_column_t *new_columns = new_data->columns;
+    ecs_column_t *old_columns = old_data->columns;
+
+    /* Allocate for the worst case, which is when no columns match */
+    int32_t max_count = new_column_count + old_column_count;
+    ecs_move_map_t *result = ecs_os_malloc(ECS_SIZEOF(ecs_move_map_t) + 
+        ECS_SIZEOF(int32_t) * max_count * 2);
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    int32_t *moves = ECS_OFFSET(result, ECS_SIZEOF(ecs_move_map_t));
+    int32_t *ctors = &moves[max_count];
+    int32_t *dtors = &ctors[new_column_count];
+    int32_t move_count = 0, ctor_count = 0, dtor_count = 0;
+
+    for (; (i_new < new_column_count) && (i_old < old_column_count);) {
+        ecs_entity_t new_component = new_components[i_new];
+        ecs_entity_t old_component = old_components[i_old];
+
+        if (new_component == old_component) {
+            if (new_columns[i_new].size) {
+                moves[move_count * 2] = i_old;
+                moves[move_count * 2 + 1] = i_new;
+                move_count ++;
+            }
+        } else if (new_component < old_component) {
+            if (new_columns[i_new].size) {
+                ctors[ctor_count ++] = i_new;
+            }
+        } else {
+            if (old_columns[i_old].size) {
+                dtors[dtor_count ++] = i_old;
+            }
+        }
+
+        i_new += new_component <= old_component;
+        i_old += new_component >= old_component;
+    }
+
+    for (; (i_new < new_column_count); i_new ++) {
+        if (new_columns[i_new].size) {
+            ctors[ctor_count ++] = i_new;
+        }
+    }
+
+    for (; (i_old < old_column_count); i_old ++) {
+        if (old_columns[i_old].size) {
+            dtors[dtor_count ++] = i_old;
+        }
+    }
+
+    /* Make ctor and dtor columns follow the moved columns */
+    ecs_os_memmove(&moves[move_count * 2], ctors, 
+        ECS_SIZEOF(int32_t) * ctor_count);
+    ecs_os_memmove(&moves[move_count * 2 + ctor_count], dtors, 
+        ECS_SIZEOF(int32_t) * dtor_count);
+
+    result->move_count = move_count;
+    result->ctor_count = ctor_count;
+    result->dtor_count = dtor_count;
+    result->columns = moves;
+
+    return result;
+}
+
+static
+void move_component(
+    ecs_world_t * world,
+    ecs_c_info_t * cdata,
+    ecs_entity_t component,
+    ecs_entity_t dst_entity,
+    ecs_entity_t src_entity,
+    void * dst,
+    void * src,
+    int16_t size,
+    bool same_entity)
+{
+    if (same_entity) {
+        ecs_move_t move;
+        if ((move = relocate_action(cdata))) {
+            void *ctx = cdata->lifecycle.ctx;
+            ecs_xtor_t ctor = cdata->lifecycle.ctor;
+
+            /* Ctor should always be set if copy is set */
+            ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
+
+            /* Construct a new value, move the value to it */
+            ctor(world, component, &dst_entity, dst, 
+                    ecs_to_size_t(size), 1, ctx);
+
+            move(world, component, &dst_entity, &src_entity, 
+                dst, src, ecs_to_size_t(size), 1, ctx);
+        } else {
+            ecs_os_memcpy(dst, src, size);
+        }
+    } else {
+        ecs_copy_t copy;
+        if (cdata && (copy = cdata->lifecycle.copy)) {
+            void *ctx = cdata->lifecycle.ctx;
+            ecs_xtor_t ctor = cdata->lifecycle.ctor;
+
+            /* Ctor should always be set if copy is set */
+            ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
+            ctor(world, component, &dst_entity, dst, 
+                ecs_to_size_t(size), 1, ctx);
+            copy(world, component, &dst_entity, &src_entity, 
+                dst, src, ecs_to_size_t(size), 1, ctx);
+        } else {
+            ecs_os_memcpy(dst, src, size);
+        }
+    }
+}
+
 static
 void fast_move(
     ecs_table_t * new_table,
@@ -1422,6 +1764,91 @@ void fast_move(
     }
 }
 
+/* Same as fast_move, but uses the column mapping of a table graph edge */
+static
+void fast_move_w_map(
+    ecs_data_t * new_data,
+    int32_t new_index,
+    ecs_data_t * old_data,
+    int32_t old_index,
+    const ecs_move_map_t * map)
+{
+    ecs_column_t *old_columns = old_data->columns;
+    ecs_column_t *new_columns = new_data->columns;
+    const int32_t *moves = map->columns;
+    int32_t i, count = map->move_count;
+
+    for (i = 0; i < count; i ++) {
+        ecs_column_t *old_column = &old_columns[moves[i * 2]];
+        ecs_column_t *new_column = &new_columns[moves[i * 2 + 1]];
+        int16_t size = new_column->size;
+        int16_t alignment = new_column->alignment;
+
+        void *dst = ecs_vector_get_t(new_column->data, size, alignment, new_index);
+        void *src = ecs_vector_get_t(old_column->data, size, alignment, old_index);
+
+        ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_os_memcpy(dst, src, size);
+    }
+}
+
+static
+void move_w_map(
+    ecs_world_t * world,
+    ecs_entity_t dst_entity,
+    ecs_entity_t src_entity,
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    int32_t new_index,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data,
+    int32_t old_index,
+    const ecs_move_map_t * map)
+{
+    bool same_entity = dst_entity == src_entity;
+    ecs_entity_t *new_components = ecs_vector_first(
+        new_table->type, ecs_entity_t);
+    ecs_column_t *old_columns = old_data->columns;
+    ecs_column_t *new_columns = new_data->columns;
+    const int32_t *columns = map->columns;
+    int32_t i, count = map->move_count;
+
+    for (i = 0; i < count; i ++) {
+        int32_t i_old = columns[i * 2];
+        int32_t i_new = columns[i * 2 + 1];
+        ecs_column_t *old_column = &old_columns[i_old];
+        ecs_column_t *new_column = &new_columns[i_new];
+        int16_t size = new_column->size;
+        int16_t alignment = new_column->alignment;
+
+        void *dst = ecs_vector_get_t(new_column->data, size, alignment, new_index);
+        void *src = ecs_vector_get_t(old_column->data, size, alignment, old_index);
+
+        ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        move_component(world, new_table->c_info[i_new], new_components[i_new],
+            dst_entity, src_entity, dst, src, size, same_entity);
+    }
+
+    columns = &columns[count * 2];
+    count = map->ctor_count;
+    for (i = 0; i < count; i ++) {
+        int32_t i_new = columns[i];
+        ctor_component(world, new_table->c_info[i_new],
+            &new_columns[i_new], &dst_entity, new_index, 1);
+    }
+
+    columns = &columns[count];
+    count = map->dtor_count;
+    for (i = 0; i < count; i ++) {
+        int32_t i_old = columns[i];
+        dtor_component(world, old_table->c_info[i_old],
+            &old_columns[i_old], &src_entity, old_index, 1);
+    }
+}
+
 void ecs_table_move(
     ecs_world_t * world,
     ecs_entity_t dst_entity,
@@ -1431,7 +1858,8 @@ void ecs_table_move(
     int32_t new_index,
     ecs_table_t *old_table,
     ecs_data_t *old_data,
-    int32_t old_index)
+    int32_t old_index,
+    const ecs_move_map_t *map)
 {
     ecs_assert(new_table != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(old_table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -1443,7 +1871,12 @@ void ecs_table_move(
     ecs_assert(new_data != NULL, ECS_INTERNAL_ERROR, NULL);
 
     if (!((new_table->flags | old_table->flags) & EcsTableIsComplex)) {
-        fast_move(new_table, new_data, new_index, old_table, old_data, old_index);
+        if (map) {
+            fast_move_w_map(new_data, new_index, old_data, old_index, map);
+        } else {
+            fast_move(new_table, new_data, new_index, 
+                old_table, old_data, old_index);
+        }
         return;
     }
 
@@ -1453,6 +1886,12 @@ void ecs_table_move(
     move_bitset_columns(
         new_table, new_data, new_index, old_table, old_data, old_index, 1);
 
+    if (map) {
+        move_w_map(world, dst_entity, src_entity, new_table, new_data, 
+            new_index, old_table, old_data, old_index, map);
+        return;
+    }
+
     bool same_entity = dst_entity == src_entity;
 
     ecs_type_t new_type = new_table->type;
@@ -1483,41 +1922,8 @@ void ecs_table_move(
                 ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
                 ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
 
-                ecs_c_info_t *cdata = new_table->c_info[i_new];
-                if (same_entity) {
-                    ecs_move_t move;
-                    if (cdata && (move = cdata->lifecycle.move)) {
-                        void *ctx = cdata->lifecycle.ctx;
-                        ecs_xtor_t ctor = cdata->lifecycle.ctor;
-
-                        /* Ctor should always be set if copy is set */
-                        ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
-
-                        /* Construct a new value, move the value to it */
-                        ctor(world, new_component, &dst_entity, dst, 
-                                ecs_to_size_t(size), 1, ctx);
-
-                        move(world, new_component, &dst_entity, &src_entity, 
-                            dst, src, ecs_to_size_t(size), 1, ctx);
-                    } else {
-                        ecs_os_memcpy(dst, src, size);
-                    }
-                } else {
-                    ecs_copy_t copy;
-                    if (cdata && (copy = cdata->lifecycle.copy)) {
-                        void *ctx = cdata->lifecycle.ctx;
-                        ecs_xtor_t ctor = cdata->lifecycle.ctor;
-
-                        /* Ctor should always be set if copy is set */
-                        ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
-                        ctor(world, new_component, &dst_entity, dst, 
-                            ecs_to_size_t(size), 1, ctx);
-                        copy(world, new_component, &dst_entity, &src_entity, 
-                            dst, src, ecs_to_size_t(size), 1, ctx);
-                    } else {
-                        ecs_os_memcpy(dst, src, size);
-                    }
-                }
+                move_component(world, new_table->c_info[i_new], new_component,
+                    dst_entity, src_entity, dst, src, size, same_entity);
             }
         } else {
             if (new_component < old_component) {
@@ -1544,6 +1950,240 @@ void ecs_table_move(
     }
 }
 
+/* Remove a sorted set of rows from a table in a single pass. Holes below the
+ * new table count are filled with the last rows that are kept, so that every
+ * column is traversed once regardless of the number of deleted rows. Values in
+ * the deleted rows must already have been moved or destructed. */
+static
+void delete_rows(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_data_t * data,
+    const int32_t * rows,
+    int32_t count)
+{
+    int32_t src_count = ecs_vector_count(data->entities);
+    int32_t new_count = src_count - count;
+
+    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
+    ecs_record_t **records = ecs_vector_first(data->record_ptrs, ecs_record_t*);
+
+    /* Find which rows fill the holes */
+    int32_t *fill = ecs_os_malloc(ECS_SIZEOF(int32_t) * count * 2);
+    int32_t *holes = &fill[count];
+    int32_t i, fill_count = 0, last = src_count - 1, r = count - 1;
+    for (i = 0; i < count && rows[i] < new_count; i ++) {
+        while (r >= 0 && rows[r] == last) {
+            r --;
+            last --;
+        }
+
+        ecs_assert(last >= new_count, ECS_INTERNAL_ERROR, NULL);
+        holes[fill_count] = rows[i];
+        fill[fill_count ++] = last --;
+    }
+
+    for (i = 0; i < fill_count; i ++) {
+        int32_t hole = holes[i];
+        entities[hole] = entities[fill[i]];
+        records[hole] = records[fill[i]];
+
+        ecs_record_t *record = records[hole];
+        if (record) {
+            if (record->row >= 0) {
+                record->row = hole + 1;
+            } else {
+                record->row = -(hole + 1);
+            }
+            ecs_assert(record->table == table, ECS_INTERNAL_ERROR, NULL);
+        }
+    }
+
+    ecs_c_info_t **c_info_array = table->c_info;
+    ecs_column_t *columns = data->columns;
+    int32_t c, column_count = table->column_count;
+    for (c = 0; c < column_count; c ++) {
+        ecs_column_t *column = &columns[c];
+        int16_t size = column->size;
+        int16_t alignment = column->alignment;
+        if (!size) {
+            continue;
+        }
+
+        void *buffer = ecs_vector_first_t(column->data, size, alignment);
+        ecs_c_info_t *c_info = c_info_array ? c_info_array[c] : NULL;
+        ecs_move_t move = relocate_action(c_info);
+
+        for (i = 0; i < fill_count; i ++) {
+            void *dst = ECS_OFFSET(buffer, size * holes[i]);
+            void *src = ECS_OFFSET(buffer, size * fill[i]);
+            if (move) {
+                /* Deleted element was moved or destructed, so construct it
+                 * before moving the last element into it */
+                ecs_entity_t e = entities[holes[i]];
+                c_info->lifecycle.ctor(world, c_info->component, &e, dst, 
+                    ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
+                move(world, c_info->component, &e, &e, dst, src,
+                    ecs_to_size_t(size), 1, c_info->lifecycle.ctx);
+            } else {
+                ecs_os_memcpy(dst, src, size);
+            }
+        }
+
+        ecs_vector_set_count_t(&column->data, size, alignment, new_count);
+    }
+
+    ecs_vector_set_count(&data->entities, ecs_entity_t, new_count);
+    ecs_vector_set_count(&data->record_ptrs, ecs_record_t*, new_count);
+
+    ecs_os_free(fill);
+
+    /* If the table is monitored indicate that there has been a change */
+    mark_table_dirty(table, 0);
+
+    if (!new_count) {
+        ecs_table_activate(world, table, NULL, false);
+    }
+
+    remove_from_chunk(table, src_count, ecs_vector_size(data->entities));
+}
+
+int32_t ecs_table_move_rows(
+    ecs_world_t * world,
+    ecs_table_t * new_table,
+    ecs_data_t * new_data,
+    ecs_table_t * old_table,
+    ecs_data_t * old_data,
+    const int32_t * rows,
+    int32_t count)
+{
+    ecs_assert(new_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(old_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(new_table != old_table, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(new_data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(old_data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!new_table->sw_column_count && !old_table->sw_column_count,
+        ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!new_table->bs_column_count && !old_table->bs_column_count,
+        ECS_INTERNAL_ERROR, NULL);
+
+    ecs_entity_t *old_entities = ecs_vector_first(
+        old_data->entities, ecs_entity_t);
+    ecs_record_t **old_records = ecs_vector_first(
+        old_data->record_ptrs, ecs_record_t*);
+
+    ecs_entity_t *ids = ecs_os_malloc(ECS_SIZEOF(ecs_entity_t) * count);
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_assert(!i || rows[i] > rows[i - 1], ECS_INTERNAL_ERROR, NULL);
+        ids[i] = old_entities[rows[i]];
+    }
+
+    /* Append all rows at once. This constructs the new elements. */
+    int32_t new_count = ecs_table_data_count(new_data);
+    int32_t new_index = grow_data(
+        world, new_table, new_data, count, new_count + count, ids);
+
+    ecs_record_t **new_records = ecs_vector_first(
+        new_data->record_ptrs, ecs_record_t*);
+    for (i = 0; i < count; i ++) {
+        new_records[new_index + i] = old_records[rows[i]];
+    }
+
+    ecs_type_t new_type = new_table->type;
+    ecs_type_t old_type = old_table->type;
+
+    int32_t i_new = 0, new_column_count = new_table->column_count;
+    int32_t i_old = 0, old_column_count = old_table->column_count;
+    ecs_entity_t *new_components = ecs_vector_first(new_type, ecs_entity_t);
+    ecs_entity_t *old_components = ecs_vector_first(old_type, ecs_entity_t);
+
+    ecs_column_t *old_columns = old_data->columns;
+    ecs_column_t *new_columns = new_data->columns;
+
+    /* Copy values column by column. Consecutive source rows are copied with a
+     * single memcpy or move. */
+    for (; (i_new < new_column_count) && (i_old < old_column_count);) {
+        ecs_entity_t new_component = new_components[i_new];
+        ecs_entity_t old_component = old_components[i_old];
+
+        if (new_component == old_component) {
+            ecs_column_t *new_column = &new_columns[i_new];
+            ecs_column_t *old_column = &old_columns[i_old];
+            int16_t size = new_column->size;
+            int16_t alignment = new_column->alignment;
+
+            if (size) {
+                void *dst = ecs_vector_get_t(
+                    new_column->data, size, alignment, new_index);
+                void *src = ecs_vector_first_t(
+                    old_column->data, size, alignment);
+
+                ecs_c_info_t *cdata = new_table->c_info ? 
+                    new_table->c_info[i_new] : NULL;
+                ecs_move_t move = relocate_action(cdata);
+                if (!move && cdata && cdata->lifecycle.dtor) {
+                    /* Values are relocated with memcpy into elements that were
+                     * constructed when appending, so destruct those first */
+                    cdata->lifecycle.dtor(world, new_component, ids, dst, 
+                        ecs_to_size_t(size), count, cdata->lifecycle.ctx);
+                }
+
+                int32_t start, end;
+                for (start = 0; start < count; start = end) {
+                    for (end = start + 1; end < count; end ++) {
+                        if (rows[end] != rows[end - 1] + 1) {
+                            break;
+                        }
+                    }
+
+                    void *dst_ptr = ECS_OFFSET(dst, size * start);
+                    void *src_ptr = ECS_OFFSET(src, size * rows[start]);
+                    if (move) {
+                        move(world, new_component, &ids[start], &ids[start],
+                            dst_ptr, src_ptr, ecs_to_size_t(size), 
+                            end - start, cdata->lifecycle.ctx);
+                    } else {
+                        ecs_os_memcpy(dst_ptr, src_ptr, size * (end - start));
+                    }
+                }
+            }
+        } else if (new_component > old_component) {
+            /* Components that are not in the new table are destructed. New
+             * components have already been constructed when appending. */
+            ecs_c_info_t *cdata = old_table->c_info ? 
+                old_table->c_info[i_old] : NULL;
+            if (cdata && cdata->lifecycle.dtor && old_columns[i_old].size) {
+                for (i = 0; i < count; i ++) {
+                    dtor_component(world, cdata, &old_columns[i_old], 
+                        &ids[i], rows[i], 1);
+                }
+            }
+        }
+
+        i_new += new_component <= old_component;
+        i_old += new_component >= old_component;
+    }
+
+    for (; (i_old < old_column_count); i_old ++) {
+        ecs_c_info_t *cdata = old_table->c_info ? 
+            old_table->c_info[i_old] : NULL;
+        if (cdata && cdata->lifecycle.dtor && old_columns[i_old].size) {
+            for (i = 0; i < count; i ++) {
+                dtor_component(world, cdata, &old_columns[i_old], 
+                    &ids[i], rows[i], 1);
+            }
+        }
+    }
+
+    ecs_os_free(ids);
+
+    delete_rows(world, old_table, old_data, rows, count);
+
+    return new_index;
+}
+
 int32_t ecs_table_appendn(
     ecs_world_t * world,
     ecs_table_t * table,
@@ -1714,7 +2354,7 @@ void merge_vector(
 
     if (!dst_count) {
         if (dst) {
-            ecs_vector_free(dst);
+            ecs_vector_free_t(dst, size, alignment);
         }
 
         *dst_out = src;
@@ -1732,7 +2372,7 @@ void merge_vector(
         
         ecs_os_memcpy(dst_ptr, src_ptr, size * src_count);
 
-        ecs_vector_free(src);
+        ecs_vector_free_t(src, size, alignment);
         *dst_out = dst;
     }
 }
@@ -1755,7 +2395,7 @@ void merge_column(
 
     if (!dst_count) {
         if (dst) {
-            ecs_vector_free(dst);
+            ecs_vector_free_t(dst, size, alignment);
         }
 
         column->data = src;
@@ -1767,8 +2407,9 @@ void merge_column(
         ecs_vector_set_count_t(&dst, size, alignment, dst_count + src_count);
         column->data = dst;
 
-        /* Construct new values */
-        if (c_info) {
+        /* Construct new values, unless they can be relocated */
+        ecs_move_t move = relocate_action(c_info);
+        if (move) {
             ctor_component(
                 world, c_info, column, entities, dst_count, src_count);
         }
@@ -1779,8 +2420,7 @@ void merge_column(
         dst_ptr = ECS_OFFSET(dst_ptr, size * dst_count);
         
         /* Move values into column */
-        ecs_move_t move;
-        if (c_info && (move = c_info->lifecycle.move)) {
+        if (move) {
             move(world, c_info->component, entities, entities, 
                 dst_ptr, src_ptr, ecs_to_size_t(size), src_count, 
                 c_info->lifecycle.ctx);
@@ -1788,7 +2428,7 @@ void merge_column(
             ecs_os_memcpy(dst_ptr, src_ptr, size * src_count);
         }
 
-        ecs_vector_free(src);
+        ecs_vector_free_t(src, size, alignment);
     }
 }
 
@@ -1860,6 +2500,8 @@ void merge_table_data(
              * enough. */
             if (size) {
                 ecs_column_t *column = &new_columns[i_new];
+                ensure_column(world, &column->data, size, alignment, 
+                    old_count + new_count);
                 ecs_vector_set_count_t(&column->data, size, alignment,
                     old_count + new_count);
 
@@ -1890,7 +2532,7 @@ void merge_table_data(
                 }
 
                 /* Old column does not occur in new table, remove */
-                ecs_vector_free(column->data);
+                ecs_vector_free_t(column->data, size, column->alignment);
                 column->data = NULL;
 
                 i_old ++;
@@ -1908,6 +2550,8 @@ void merge_table_data(
         int16_t alignment = column->alignment;
 
         if (size) {
+            ensure_column(world, &column->data, size, alignment, 
+                old_count + new_count);
             ecs_vector_set_count_t(&column->data, size, alignment,
                 old_count + new_count);
 
@@ -1938,7 +2582,7 @@ void merge_table_data(
         }
 
         /* Old column does not occur in new table, remove */
-        ecs_vector_free(column->data);
+        ecs_vector_free_t(column->data, column->size, column->alignment);
         column->data = NULL;
     }    
 
@@ -1986,6 +2630,11 @@ ecs_data_t* ecs_table_merge(
         }
     }
 
+    /* Named entities may have moved to another scope */
+    if (new_table->flags & EcsTableHasName) {
+        world->name_index_dirty = true;
+    }
+
     ecs_entity_t *old_entities = ecs_vector_first(old_data->entities, ecs_entity_t);
 
     int32_t old_count = ecs_vector_count(old_data->entities);
@@ -2049,6 +2698,10 @@ void ecs_table_replace_data(
         return;
     }
 
+    if (table->flags & EcsTableHasName) {
+        world->name_index_dirty = true;
+    }
+
     int32_t count = ecs_table_count(table);
 
     if (!prev_count && count) {
@@ -95,10 +95,12 @@ int32_t bitset_column_count(
 
 static
 ecs_type_t entities_to_type(
+    ecs_world_t *world,
     ecs_entities_t *entities)
 {
     if (entities->count) {
-        ecs_vector_t *result = NULL;
+        ecs_vector_t *result = ecs_vector_new_w_pool(
+            world->pools[EcsPoolTypes], ecs_entity_t, entities->count);
         ecs_vector_set_count(&result, ecs_entity_t, entities->count);
         ecs_entity_t *array = ecs_vector_first(result, ecs_entity_t);
         ecs_os_memcpy(array, entities->array, ECS_SIZEOF(ecs_entity_t) * entities->count);
@@ -131,22 +133,137 @@ void register_child_table(
     ecs_map_set(world->child_tables, parent, &child_tables);
 }
 
+static
+void unregister_child_table(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_entity_t parent)
+{
+    ecs_vector_t *child_tables = ecs_map_get_ptr(
+            world->child_tables, ecs_vector_t*, parent);
+    
+    ecs_table_t **array = ecs_vector_first(child_tables, ecs_table_t*);
+    int32_t i, count = ecs_vector_count(child_tables);
+    for (i = 0; i < count; i ++) {
+        if (array[i] == table) {
+            break;
+        }
+    }
+
+    /* Table can be missing if the parent is being deleted */
+    if (i == count) {
+        return;
+    }
+
+    /* Don't swap with last element, so tables remain in creation order */
+    ecs_os_memmove(&array[i], &array[i + 1], 
+        ECS_SIZEOF(ecs_table_t*) * (count - i - 1));
+    ecs_vector_remove_last(child_tables);
+}
+
+static
+void register_component_table(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_entity_t component)
+{
+    ecs_vector_t *tables = ecs_map_get_ptr(
+        world->store.component_tables, ecs_vector_t*, component);
+
+    ecs_table_t **el = ecs_vector_add(&tables, ecs_table_t*);
+    *el = table;
+
+    ecs_map_set(world->store.component_tables, component, &tables);
+}
+
+static
+void unregister_component_table(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    ecs_entity_t component)
+{
+    ecs_vector_t *tables = ecs_map_get_ptr(
+        world->store.component_tables, ecs_vector_t*, component);
+
+    ecs_table_t **array = ecs_vector_first(tables, ecs_table_t*);
+    int32_t i, count = ecs_vector_count(tables);
+    for (i = 0; i < count; i ++) {
+        if (array[i] == table) {
+            break;
+        }
+    }
+
+    ecs_assert(i != count, ECS_INTERNAL_ERROR, NULL);
+
+    /* Don't swap with last element, so tables remain in creation order */
+    ecs_os_memmove(&array[i], &array[i + 1], 
+        ECS_SIZEOF(ecs_table_t*) * (count - i - 1));
+    ecs_vector_remove_last(tables);
+}
+
+static
+void register_component_tables(
+    ecs_world_t * world,
+    ecs_table_t * table)
+{
+    ecs_entity_t *entities = ecs_vector_first(table->type, ecs_entity_t);
+    int32_t i, count = ecs_vector_count(table->type);
+
+    for (i = 0; i < count; i ++) {
+        register_component_table(world, table, entities[i]);
+    }
+
+    if (table->flags & EcsTableHasBase) {
+        register_component_table(world, table, ECS_INSTANCEOF);
+    }
+}
+
+static
+void invalidate_edge_cache(
+    ecs_table_t *node)
+{
+    ecs_os_memset(node->edge_cache, 0, ECS_SIZEOF(node->edge_cache));
+}
+
+/* Edges are stored in a map that only contains entries for components that
+ * have been added to or removed from the table. The most recently used edges
+ * are cached inline, so that repeatedly adding/removing the same components
+ * does not require a map lookup. */
 static
 ecs_edge_t* get_edge(
     ecs_table_t *node,
     ecs_entity_t e)
 {
-    if (e < ECS_HI_COMPONENT_ID) {
-        if (!node->lo_edges) {
-            node->lo_edges = ecs_os_calloc(sizeof(ecs_edge_t) * ECS_HI_COMPONENT_ID);
-        }
-        return &node->lo_edges[e];
-    } else {
-        if (!node->hi_edges) {
-            node->hi_edges = ecs_map_new(ecs_edge_t, 1);
-        }
-        return ecs_map_ensure(node->hi_edges, ecs_edge_t, e);
+    ecs_edge_cache_t *cache = &node->edge_cache[e & (ECS_EDGE_CACHE_SIZE - 1)];
+    if (cache->id == e) {
+        return cache->edge;
+    }
+
+    ecs_map_t *edges = node->edges;
+    if (!edges) {
+        edges = node->edges = ecs_map_new(ecs_edge_t, 1);
+    }
+
+    ecs_edge_t *edge = ecs_map_get(edges, ecs_edge_t, e);
+    if (!edge) {
+        /* Inserting may move existing edges, which invalidates the cache */
+        edge = ecs_map_ensure(edges, ecs_edge_t, e);
+        invalidate_edge_cache(node);
     }
+
+    cache->id = e;
+    cache->edge = edge;
+
+    return edge;
+}
+
+static
+void remove_edge(
+    ecs_table_t *node,
+    ecs_entity_t e)
+{
+    ecs_map_remove(node->edges, e);
+    invalidate_edge_cache(node);
 }
 
 static
@@ -157,8 +274,8 @@ void init_edges(
     ecs_entity_t *entities = ecs_vector_first(table->type, ecs_entity_t);
     int32_t count = ecs_vector_count(table->type);
 
-    table->lo_edges = NULL;
-    table->hi_edges = NULL;
+    table->edges = NULL;
+    invalidate_edge_cache(table);
     
     /* Make add edges to own components point to self */
     int32_t i;
@@ -194,6 +311,10 @@ void init_edges(
             table->flags |= EcsTableHasComponentData;
         }
 
+        if (e == ecs_typeid(EcsName)) {
+            table->flags |= EcsTableHasName;
+        }
+
         if (ECS_HAS_ROLE(e, XOR)) {
             table->flags |= EcsTableHasXor;
         }
@@ -233,13 +354,68 @@ void init_edges(
     }
 }
 
+/* Find type of a deleted table with the same components */
+static
+ecs_type_t find_retired_type(
+    ecs_world_t * world,
+    ecs_entities_t * entities,
+    uint64_t hash)
+{
+    ecs_vector_t *types = ecs_map_get_ptr(
+        world->store.retired_types, ecs_vector_t*, hash);
+    if (!types) {
+        return NULL;
+    }
+
+    ecs_type_t *array = ecs_vector_first(types, ecs_type_t);
+    int32_t i, count = ecs_vector_count(types);
+    for (i = 0; i < count; i ++) {
+        ecs_type_t type = array[i];
+        if (ecs_vector_count(type) != entities->count) {
+            continue;
+        }
+
+        if (ecs_os_memcmp(ecs_vector_first(type, ecs_entity_t), 
+            entities->array, ECS_SIZEOF(ecs_entity_t) * entities->count))
+        {
+            continue;
+        }
+
+        ecs_vector_remove_index(types, ecs_type_t, i);
+        if (!ecs_vector_count(types)) {
+            ecs_vector_free(types);
+            ecs_map_remove(world->store.retired_types, hash);
+        }
+
+        return type;
+    }
+
+    return NULL;
+}
+
+static
+ecs_type_t find_or_create_type(
+    ecs_world_t * world,
+    ecs_entities_t * entities,
+    uint64_t hash)
+{
+    ecs_type_t type = NULL;
+    if (entities->count) {
+        type = find_retired_type(world, entities, hash);
+    }
+
+    if (!type) {
+        type = entities_to_type(world, entities);
+    }
+
+    return type;
+}
+
 static
 void init_table(
     ecs_world_t * world,
-    ecs_table_t * table,
-    ecs_entities_t * entities)
+    ecs_table_t * table)
 {
-    table->type = entities_to_type(entities);
     table->c_info = NULL;
     table->data = NULL;
     table->flags = 0;
@@ -250,6 +426,12 @@ void init_table(
     table->on_set_override = NULL;
     table->un_set_all = NULL;
     table->alloc_count = 0;
+    table->gc_frame = 0;
+    table->gc_index = -1;
+    table->chunk_head = NULL;
+    table->chunks = NULL;
+    table->chunk_tail = NULL;
+    table->chunk_free = NULL;
 
     table->queries = NULL;
     table->column_count = data_column_count(world, table);
@@ -267,9 +449,12 @@ ecs_table_t *create_table(
 {
     ecs_table_t *result = ecs_sparse_add(world->store.tables, ecs_table_t);
     result->id = ecs_to_u32(ecs_sparse_last_id(world->store.tables));
+    result->hash = hash;
 
     ecs_assert(result != NULL, ECS_INTERNAL_ERROR, NULL);
-    init_table(world, result, entities);
+    result->type = find_or_create_type(world, entities, hash);
+    init_table(world, result);
+    register_component_tables(world, result);
 
 #ifndef NDEBUG
     char *expr = ecs_type_str(world, result->type);
@@ -283,17 +468,197 @@ ecs_table_t *create_table(
     ecs_table_t **elem = ecs_vector_add(&tables, ecs_table_t*);
     *elem = result;
     ecs_map_set(world->store.table_map, hash, &tables);
+    ecs_map_set(world->store.type_index, (uintptr_t)result->type, &result);
 
     ecs_notify_queries(world, &(ecs_query_event_t) {
         .kind = EcsQueryTableMatch,
         .table = result
     });
 
+    /* Tables are created empty, and may never be populated if they were only
+     * created while traversing to another table */
+    ecs_table_gc_enqueue(world, result);
+
     ecs_log_pop();
 
     return result;
 }
 
+/* Create a table with the same type as head, of which the columns have room
+ * for size entities. Chunks are matched with queries, and show up in the child
+ * and component tables of their type, but are not added to the lookup maps so
+ * that finding a table by type always returns the head. */
+static
+ecs_table_t *create_chunk(
+    ecs_world_t * world,
+    ecs_table_t * head,
+    int32_t size)
+{
+    ecs_table_t *result = ecs_sparse_add(world->store.tables, ecs_table_t);
+    ecs_assert(result != NULL, ECS_INTERNAL_ERROR, NULL);
+    result->id = ecs_to_u32(ecs_sparse_last_id(world->store.tables));
+    result->hash = head->hash;
+    result->type = head->type;
+
+    init_table(world, result);
+    register_component_tables(world, result);
+    result->chunk_head = head;
+
+    ecs_table_t **elem = ecs_vector_add(&head->chunks, ecs_table_t*);
+    *elem = result;
+
+#ifndef NDEBUG
+    char *expr = ecs_type_str(world, result->type);
+    ecs_trace_2("table #[green][%s]#[normal] chunk %d created", 
+        expr, ecs_vector_count(head->chunks));
+    ecs_os_free(expr);
+#endif
+    ecs_log_push();
+
+    /* Allocate columns once, so that they are never reallocated */
+    ecs_data_t *data = ecs_table_get_or_create_data(result);
+    ecs_table_set_size(world, result, data, size);
+
+    ecs_notify_queries(world, &(ecs_query_event_t) {
+        .kind = EcsQueryTableMatch,
+        .table = result
+    });
+
+    ecs_log_pop();
+
+    return result;
+}
+
+static
+bool chunk_has_space(
+    ecs_table_t * chunk,
+    int32_t chunk_size,
+    int32_t count)
+{
+    ecs_data_t *data = ecs_table_get_data(chunk);
+    int32_t size = chunk_size, used = 0;
+    if (data) {
+        ecs_vector_t *entities = data->entities;
+        used = ecs_vector_count(entities);
+        size = ECS_MAX(size, ecs_vector_size(entities));
+    }
+
+    return (used + count) <= size;
+}
+
+/* Make sure columns of a chunk have room for the chunk size */
+static
+ecs_table_t* use_chunk(
+    ecs_world_t * world,
+    ecs_table_t * head,
+    ecs_table_t * chunk,
+    int32_t chunk_size)
+{
+    head->chunk_tail = chunk;
+    if (chunk != head) {
+        /* Columns of an empty chunk may have been reclaimed */
+        ecs_data_t *data = ecs_table_get_or_create_data(chunk);
+        if (ecs_vector_size(data->entities) < chunk_size) {
+            ecs_table_set_size(world, chunk, data, chunk_size);
+        }
+    }
+    return chunk;
+}
+
+ecs_table_t* ecs_table_get_chunk(
+    ecs_world_t * world,
+    ecs_table_t * table,
+    int32_t count)
+{
+    int32_t chunk_size = world->table_chunk_size;
+    if (!chunk_size || !table->type) {
+        return table;
+    }
+
+    ecs_table_t *head = table->chunk_head;
+    if (!head) {
+        head = table;
+    }
+
+    /* Append to the chunk that was last appended to. If it is full, use a
+     * chunk from which entities have been removed before creating one. */
+    ecs_table_t *chunk = head->chunk_tail;
+    if (!chunk) {
+        chunk = head;
+    }
+
+    if (chunk_has_space(chunk, chunk_size, count)) {
+        return use_chunk(world, head, chunk, chunk_size);
+    }
+
+    ecs_table_t **elem;
+    while ((elem = ecs_vector_last(head->chunk_free, ecs_table_t*))) {
+        chunk = *elem;
+        ecs_vector_remove_last(head->chunk_free);
+        if (chunk_has_space(chunk, chunk_size, count)) {
+            return use_chunk(world, head, chunk, chunk_size);
+        }
+    }
+
+    chunk = create_chunk(world, head, ECS_MAX(chunk_size, count));
+    head->chunk_tail = chunk;
+
+    return chunk;
+}
+
+void ecs_table_chunk_has_space(
+    ecs_table_t * table)
+{
+    ecs_table_t *head = table->chunk_head;
+    if (!head) {
+        if (!table->chunks) {
+            return;
+        }
+        head = table;
+    }
+
+    /* The tail is always tried first */
+    ecs_table_t *tail = head->chunk_tail ? head->chunk_tail : head;
+    if (table != tail) {
+        ecs_table_t **elem = ecs_vector_add(&head->chunk_free, ecs_table_t*);
+        *elem = table;
+    }
+}
+
+/* Remove all occurrences of a chunk from a list of chunks */
+static
+bool remove_chunk_from(
+    ecs_vector_t *chunks,
+    ecs_table_t * table)
+{
+    ecs_table_t **array = ecs_vector_first(chunks, ecs_table_t*);
+    int32_t i, count = ecs_vector_count(chunks);
+    bool found = false;
+    for (i = count - 1; i >= 0; i --) {
+        if (array[i] == table) {
+            ecs_vector_remove_index(chunks, ecs_table_t*, i);
+            found = true;
+        }
+    }
+    return found;
+}
+
+void ecs_table_remove_chunk(
+    ecs_table_t * table)
+{
+    ecs_table_t *head = table->chunk_head;
+    ecs_assert(head != NULL, ECS_INTERNAL_ERROR, NULL);
+    bool found = remove_chunk_from(head->chunks, table);
+    ecs_assert(found, ECS_INTERNAL_ERROR, NULL);
+    (void)found;
+
+    remove_chunk_from(head->chunk_free, table);
+
+    if (head->chunk_tail == table) {
+        head->chunk_tail = NULL;
+    }
+}
+
 static
 void add_entity_to_type(
     ecs_type_t type,
@@ -527,6 +892,24 @@ ecs_table_t *find_or_create_table_exclude(
     return result;    
 }
 
+/* Get the component info of a component that is part of a hot/cold pair */
+static
+const ecs_c_info_t* get_split_info(
+    ecs_world_t * world,
+    ecs_entity_t e)
+{
+    if (e & ECS_ROLE_MASK) {
+        return NULL;
+    }
+
+    const ecs_c_info_t *c_info = ecs_get_c_info(world, e);
+    if (c_info && (c_info->cold || c_info->hot)) {
+        return c_info;
+    }
+
+    return NULL;
+}
+
 ecs_table_t* ecs_table_traverse_remove(
     ecs_world_t * world,
     ecs_table_t * node,
@@ -537,12 +920,30 @@ ecs_table_t* ecs_table_traverse_remove(
     ecs_entity_t *entities = to_remove->array;
     node = node ? node : &world->store.root;
 
+    ecs_entity_t cold_array[ECS_MAX_ADD_REMOVE];
+    ecs_entities_t cold = {
+        .array = cold_array,
+        .count = 0
+    };
+
     for (i = 0; i < count; i ++) {
         ecs_entity_t e = entities[i];
 
         /* Removing 0 from an entity is not valid */
         ecs_assert(e != 0, ECS_INVALID_PARAMETER, NULL);
 
+        const ecs_c_info_t *split = NULL;
+        if (node->flags & EcsTableHasColdParts) {
+            split = get_split_info(world, e);
+
+            /* The cold part stays for as long as the entity has the hot part */
+            if (split && split->hot && 
+                ecs_type_index_of(node->type, split->hot) != -1) 
+            {
+                continue;
+            }
+        }
+
         ecs_edge_t *edge = get_edge(node, e);
         ecs_table_t *next = edge->remove;
 
@@ -554,7 +955,12 @@ ecs_table_t* ecs_table_traverse_remove(
                     return NULL;
                 }
 
-                edge->remove = next;
+                /* Only cache the edge if next links back to node, so that the
+                 * edge can be cleared when either table is deleted. Creating a
+                 * table can insert edges, so look up edge again. */
+                if (next == node || get_edge(next, e)->add == node) {
+                    get_edge(node, e)->remove = next;
+                }
             } else {
                 /* If the add edge does not point to self, the table
                  * does not have the entity in to_remove. */
@@ -567,8 +973,19 @@ ecs_table_t* ecs_table_traverse_remove(
             removed->array[removed->count ++] = e; 
         }
 
+        if ((node != next) && split && split->cold) {
+            ecs_assert(cold.count < ECS_MAX_ADD_REMOVE, 
+                ECS_INVALID_PARAMETER, NULL);
+            cold.array[cold.count ++] = split->cold;
+        }
+
         node = next;
-    }    
+    }
+
+    /* Remove the cold parts of removed components */
+    if (cold.count) {
+        node = ecs_table_traverse_remove(world, node, &cold, removed);
+    }
 
     return node;
 }
@@ -638,7 +1055,13 @@ ecs_table_t* ecs_table_traverse_add(
         if (!next) {
             next = find_or_create_table_include(world, node, e);
             ecs_assert(next != NULL, ECS_INTERNAL_ERROR, NULL);
-            edge->add = next;
+
+            /* Only cache the edge if next links back to node, so that the
+             * edge can be cleared when either table is deleted. Creating a
+             * table can insert edges, so look up edge again. */
+            if (next == node || get_edge(next, e)->remove == node) {
+                get_edge(node, e)->add = next;
+            }
         }
 
         bool has_case = ECS_HAS_ROLE(e, CASE);
@@ -648,12 +1071,22 @@ ecs_table_t* ecs_table_traverse_add(
 
         if ((node != next) && ECS_HAS_ROLE(e, INSTANCEOF)) {
             find_owned_components(world, next, ECS_COMPONENT_MASK & e, &owned);
-        }        
+        }
+
+        /* A component with a cold part is never added without it */
+        if ((node != next) && (next->flags & EcsTableHasColdParts)) {
+            const ecs_c_info_t *split = get_split_info(world, e);
+            if (split && split->cold) {
+                ecs_assert(owned.count < ECS_MAX_ADD_REMOVE, 
+                    ECS_INVALID_PARAMETER, NULL);
+                owned.array[owned.count ++] = split->cold;
+            }
+        }
 
         node = next;
     }
 
-    /* In case OWNED components were found, add them as well */
+    /* In case OWNED components or cold parts were found, add them as well */
     if (owned.count) {
         node = ecs_table_traverse_add(world, node, &owned, added);
     }
@@ -661,6 +1094,33 @@ ecs_table_t* ecs_table_traverse_add(
     return node;
 }
 
+ecs_table_t* ecs_table_add_cold_parts(
+    ecs_world_t * world,
+    ecs_table_t * table)
+{
+    if (!(table->flags & EcsTableHasColdParts)) {
+        return table;
+    }
+
+    ecs_entity_t cold_array[ECS_MAX_ADD_REMOVE];
+    ecs_entities_t cold = {
+        .array = cold_array,
+        .count = 0
+    };
+
+    int32_t i, count = table->column_count;
+    for (i = 0; i < count; i ++) {
+        ecs_c_info_t *c_info = table->c_info[i];
+        if (c_info && c_info->cold) {
+            ecs_assert(cold.count < ECS_MAX_ADD_REMOVE, 
+                ECS_INVALID_PARAMETER, NULL);
+            cold.array[cold.count ++] = c_info->cold;
+        }
+    }
+
+    return ecs_table_traverse_add(world, table, &cold, NULL);
+}
+
 static
 int ecs_entity_compare(
     const void *e1,
@@ -812,7 +1272,7 @@ ecs_table_t *find_or_create(
     }
 
     uint64_t hash = 0;
-    ecs_hash(ordered, entities->count * ECS_SIZEOF(ecs_entity_t), &hash);
+    ecs_hash(ordered, type_count * ECS_SIZEOF(ecs_entity_t), &hash);
     ecs_vector_t *table_vec = ecs_map_get_ptr(
         world->store.table_map, ecs_vector_t*, hash);
     if (table_vec) {
@@ -884,6 +1344,14 @@ ecs_table_t* ecs_table_from_type(
     ecs_world_t *world,
     ecs_type_t type)
 {
+    /* Types are usually owned by a table, in which case the table can be
+     * found without hashing the type. */
+    ecs_table_t *table = ecs_map_get_ptr(
+        world->store.type_index, ecs_table_t*, (uintptr_t)type);
+    if (table) {
+        return table;
+    }
+
     ecs_entities_t components = ecs_type_to_entities(type);
     return ecs_table_find_or_create(
         world, &components);
@@ -897,47 +1365,244 @@ void ecs_init_root_table(
         .count = 0
     };
 
-    init_table(world, &world->store.root, &entities);
+    world->store.root.type = find_or_create_type(world, &entities, 0);
+    init_table(world, &world->store.root);
 }
 
-void ecs_table_clear_edges(
+static
+void remove_from_type_index(
     ecs_world_t *world,
     ecs_table_t *table)
 {
-    (void)world;
+    ecs_vector_t *tables = ecs_map_get_ptr(
+        world->store.table_map, ecs_vector_t*, table->hash);
+    ecs_table_t **array = ecs_vector_first(tables, ecs_table_t*);
+    int32_t i, count = ecs_vector_count(tables);
+    for (i = 0; i < count; i ++) {
+        if (array[i] == table) {
+            ecs_vector_remove_index(tables, ecs_table_t*, i);
+            break;
+        }
+    }
 
-    uint32_t i;
+    ecs_assert(i != count, ECS_INTERNAL_ERROR, NULL);
 
-    if (table->lo_edges) {
-        for (i = 0; i < ECS_HI_COMPONENT_ID; i ++) {
-            ecs_edge_t *e = &table->lo_edges[i];
-            ecs_table_t *add = e->add, *remove = e->remove;
-            if (add) {
-                add->lo_edges[i].remove = NULL;
-            }
-            if (remove) {
-                remove->lo_edges[i].add = NULL;
+    if (!ecs_vector_count(tables)) {
+        ecs_vector_free(tables);
+        ecs_map_remove(world->store.table_map, table->hash);
+    }
+
+    ecs_map_remove(world->store.type_index, (uintptr_t)table->type);
+}
+
+void ecs_table_index_remove(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_entity_t *entities = ecs_vector_first(table->type, ecs_entity_t);
+    int32_t i, count = ecs_vector_count(table->type);
+
+    for (i = 0; i < count; i ++) {
+        unregister_component_table(world, table, entities[i]);
+    }
+
+    if (table->flags & EcsTableHasBase) {
+        unregister_component_table(world, table, ECS_INSTANCEOF);
+    }
+
+    /* Chunks are not stored in the type lookup maps */
+    if (!table->chunk_head) {
+        remove_from_type_index(world, table);
+    }
+
+    /* Remove table from parent, or from root tables */
+    if (table->flags & EcsTableHasParent) {
+        ecs_vector_each(table->type, ecs_entity_t, e_ptr, {
+            if (ECS_HAS_ROLE(*e_ptr, CHILDOF)) {
+                unregister_child_table(
+                    world, table, *e_ptr & ECS_COMPONENT_MASK);
             }
+        });
+    } else {
+        unregister_child_table(world, table, 0);
+    }
+}
+
+void ecs_table_retire_type(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_type_t type = table->type;
+    if (!type) {
+        return;
+    }
+
+    if (!world->store.retired_types) {
+        world->store.retired_types = ecs_map_new(ecs_vector_t*, 1);
+    }
+
+    ecs_vector_t *types = ecs_map_get_ptr(
+        world->store.retired_types, ecs_vector_t*, table->hash);
+    ecs_type_t *elem = ecs_vector_add(&types, ecs_type_t);
+    *elem = type;
+    ecs_map_set(world->store.retired_types, table->hash, &types);
+
+    table->type = NULL;
+}
+
+bool ecs_table_index_supports(
+    ecs_entity_t component)
+{
+    if (!(component & ECS_COMPONENT_MASK)) {
+        return false;
+    }
+
+    /* Traits may be matched by wildcard, and cases are matched by the switch
+     * of the table. Tables for these can't be found with a single lookup. */
+    return !(component & ECS_ROLE_MASK) || 
+        ECS_HAS_ROLE(component, CHILDOF) || 
+        ECS_HAS_ROLE(component, INSTANCEOF);
+}
+
+int32_t ecs_table_index_count(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    bool inherited)
+{
+    int32_t count = ecs_vector_count(ecs_map_get_ptr(
+        world->store.component_tables, ecs_vector_t*, component));
+
+    if (inherited) {
+        count += ecs_vector_count(ecs_map_get_ptr(
+            world->store.component_tables, ecs_vector_t*, ECS_INSTANCEOF));
+    }
+
+    return count;
+}
+
+ecs_table_t* ecs_table_index_next(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    bool inherited,
+    int32_t *index,
+    int32_t *base_index)
+{
+    ecs_vector_t *tables = ecs_map_get_ptr(
+        world->store.component_tables, ecs_vector_t*, component);
+    ecs_table_t **array = ecs_vector_first(tables, ecs_table_t*);
+    int32_t count = ecs_vector_count(tables);
+
+    ecs_table_t **base_array = NULL;
+    int32_t base_count = 0;
+
+    if (inherited) {
+        ecs_vector_t *base_tables = ecs_map_get_ptr(
+            world->store.component_tables, ecs_vector_t*, ECS_INSTANCEOF);
+        base_array = ecs_vector_first(base_tables, ecs_table_t*);
+        base_count = ecs_vector_count(base_tables);
+
+        /* Tables with a base that own the component are already visited */
+        while (*base_index < base_count && ecs_type_index_of(
+            base_array[*base_index]->type, component) != -1)
+        {
+            (*base_index) ++;
         }
     }
 
-    ecs_map_iter_t it = ecs_map_iter(table->hi_edges);
+    /* Interleave both lists so that tables are returned in creation order */
+    if (*index < count) {
+        ecs_table_t *table = array[*index];
+        if (*base_index < base_count && base_array[*base_index]->id < table->id) {
+            return base_array[(*base_index) ++];
+        }
+
+        (*index) ++;
+        return table;
+    } else if (*base_index < base_count) {
+        return base_array[(*base_index) ++];
+    }
+
+    return NULL;
+}
+
+static
+void free_move_map(
+    ecs_move_map_t **map)
+{
+    if (*map) {
+        ecs_os_free(*map);
+        *map = NULL;
+    }
+}
+
+const ecs_move_map_t* ecs_table_get_move_map(
+    ecs_table_t *src,
+    ecs_data_t *src_data,
+    ecs_table_t *dst,
+    ecs_data_t *dst_data,
+    ecs_entity_t e,
+    bool add)
+{
+    ecs_edge_t *edge = get_edge(src, e);
+    ecs_move_map_t **map;
+
+    /* Edges point to the first chunk of a type. All chunks of a type have the
+     * same columns, so the map of an edge is valid for each of its chunks. */
+    ecs_table_t *head = dst->chunk_head ? dst->chunk_head : dst;
+
+    if (add) {
+        if (edge->add != head) {
+            return NULL;
+        }
+        map = &edge->add_map;
+    } else {
+        if (edge->remove != head) {
+            return NULL;
+        }
+        map = &edge->remove_map;
+    }
+
+    if (!*map) {
+        *map = ecs_move_map_new(dst, dst_data, src, src_data);
+    }
+
+    return *map;
+}
+
+void ecs_table_clear_edges(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    (void)world;
+
+    ecs_map_iter_t it = ecs_map_iter(table->edges);
     ecs_edge_t *edge;
     ecs_map_key_t component;
     while ((edge = ecs_map_next(&it, ecs_edge_t, &component))) {
         ecs_table_t *add = edge->add, *remove = edge->remove;
-        if (add) {
+
+        free_move_map(&edge->add_map);
+        free_move_map(&edge->remove_map);
+
+        /* Edges that point to self are cleaned up with the table */
+        if (add && add != table) {
             ecs_edge_t *e = get_edge(add, component);
-            e->remove = NULL;
-            if (!e->add) {
-                ecs_map_remove(add->hi_edges, component);
+            if (e->remove == table) {
+                e->remove = NULL;
+                free_move_map(&e->remove_map);
+            }
+            if (!e->add && !e->remove) {
+                remove_edge(add, component);
             }
         }
-        if (remove) {
+        if (remove && remove != table) {
             ecs_edge_t *e = get_edge(remove, component);
-            e->add = NULL;
-            if (!e->remove) {
-                ecs_map_remove(remove->hi_edges, component);
+            if (e->add == table) {
+                e->add = NULL;
+                free_move_map(&e->add_map);
+            }
+            if (!e->add && !e->remove) {
+                remove_edge(remove, component);
             }
         }
     }
@@ -1,14 +1,139 @@
 #include "private_api.h"
 
+/* Vectors with an element alignment larger than what malloc guarantees have an
+ * offset that is larger than the header. The allocation is padded, so that the
+ * header can be placed at an address with that alignment, which also aligns
+ * the elements. The pointer returned by malloc is stored in the unused space
+ * between the header and the elements. */
+static
+bool is_overaligned(
+    int16_t offset)
+{
+    return offset > ECS_VECTOR_HEADER_SIZE;
+}
+
+static
+void** malloc_ptr(
+    ecs_vector_t *vector,
+    int16_t offset)
+{
+    return ECS_OFFSET(vector, offset - ECS_SIZEOF(void*));
+}
+
+/* Vectors that are not allocated from a pool use the OS API */
+static
+void* pool_malloc(
+    ecs_pool_t *pool,
+    ecs_size_t size)
+{
+    if (!pool) {
+        return ecs_os_malloc(size);
+    }
+
+    pool->stats.malloc_count ++;
+    pool->stats.bytes_allocated += size;
+    return pool->allocator.malloc_(pool->allocator.ctx, size);
+}
+
+static
+void* pool_realloc(
+    ecs_pool_t *pool,
+    void *ptr,
+    ecs_size_t size)
+{
+    if (!pool) {
+        return ecs_os_realloc(ptr, size);
+    }
+
+    pool->stats.realloc_count ++;
+    pool->stats.bytes_allocated += size;
+    return pool->allocator.realloc_(pool->allocator.ctx, ptr, size);
+}
+
+static
+void pool_free(
+    ecs_pool_t *pool,
+    void *ptr)
+{
+    if (!pool) {
+        ecs_os_free(ptr);
+    } else {
+        pool->stats.free_count ++;
+        pool->allocator.free_(pool->allocator.ctx, ptr);
+    }
+}
+
+static
+ecs_vector_t* alloc_vector(
+    ecs_pool_t *pool,
+    int16_t offset,
+    ecs_size_t size)
+{
+    ecs_vector_t *result;
+
+    if (!is_overaligned(offset)) {
+        result = pool_malloc(pool, offset + size);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+    } else {
+        void *ptr = pool_malloc(pool, offset * 2 + size);
+        ecs_assert(ptr != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+        uintptr_t align_mask = (uintptr_t)offset - 1;
+        result = (ecs_vector_t*)(((uintptr_t)ptr + align_mask) & ~align_mask);
+        *malloc_ptr(result, offset) = ptr;
+    }
+
+    result->pool = pool;
+#ifndef NDEBUG
+    result->offset = offset;
+#endif
+    return result;
+}
+
+static
+void free_vector(
+    ecs_vector_t *vector,
+    int16_t offset)
+{
+    if (!vector) {
+        return;
+    }
+
+    if (is_overaligned(offset)) {
+        pool_free(vector->pool, *malloc_ptr(vector, offset));
+    } else {
+        pool_free(vector->pool, vector);
+    }
+}
+
 /** Resize the vector buffer */
 static
 ecs_vector_t* resize(
     ecs_vector_t *vector,
+    ecs_size_t elem_size,
     int16_t offset,
-    int32_t size)
+    int32_t elem_count)
 {
-    ecs_vector_t *result = ecs_os_realloc(vector, offset + size);
-    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
+    if (!is_overaligned(offset)) {
+        ecs_vector_t *result = pool_realloc(
+            vector->pool, vector, offset + elem_size * elem_count);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
+        return result;
+    }
+
+    /* Realloc does not preserve alignment, so copy to a new allocation */
+    ecs_vector_t *result = alloc_vector(
+        vector->pool, offset, elem_size * elem_count);
+    int32_t count = vector->count;
+    if (count > elem_count) {
+        count = elem_count;
+    }
+
+    *result = *vector;
+    ecs_os_memcpy(ECS_OFFSET(result, offset), ECS_OFFSET(vector, offset), 
+        elem_size * count);
+    free_vector(vector, offset);
+
     return result;
 }
 
@@ -18,12 +143,19 @@ ecs_vector_t* _ecs_vector_new(
     ecs_size_t elem_size,
     int16_t offset,
     int32_t elem_count)
+{
+    return _ecs_vector_new_w_pool(NULL, elem_size, offset, elem_count);
+}
+
+ecs_vector_t* _ecs_vector_new_w_pool(
+    ecs_pool_t *pool,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
 {
     ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
     
-    ecs_vector_t *result =
-        ecs_os_malloc(offset + elem_size * elem_count);
-    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+    ecs_vector_t *result = alloc_vector(pool, offset, elem_size * elem_count);
 
     result->count = 0;
     result->size = elem_count;
@@ -41,9 +173,7 @@ ecs_vector_t* _ecs_vector_from_array(
 {
     ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
     
-    ecs_vector_t *result =
-        ecs_os_malloc(offset + elem_size * elem_count);
-    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+    ecs_vector_t *result = alloc_vector(NULL, offset, elem_size * elem_count);
 
     ecs_os_memcpy(ECS_OFFSET(result, offset), array, elem_size * elem_count);
 
@@ -58,7 +188,24 @@ ecs_vector_t* _ecs_vector_from_array(
 void ecs_vector_free(
     ecs_vector_t *vector)
 {
-    ecs_os_free(vector);
+    if (vector) {
+        /* The pointer to free is stored in the header of over-aligned vectors,
+         * which can only be found if the offset is known */
+        ecs_assert(!is_overaligned(vector->offset), 
+            ECS_INVALID_PARAMETER, NULL);
+        pool_free(vector->pool, vector);
+    }
+}
+
+void _ecs_vector_free(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    (void)elem_size;
+    ecs_assert(!vector || vector->offset == offset, 
+        ECS_INVALID_PARAMETER, NULL);
+    free_vector(vector, offset);
 }
 
 void ecs_vector_clear(
@@ -89,6 +236,18 @@ void ecs_vector_assert_size(
     }
 }
 
+void ecs_vector_assert_alignment(
+    ecs_vector_t *vector,
+    ecs_size_t elem_alignment)
+{
+    (void)elem_alignment;
+
+    if (vector) {
+        ecs_assert(vector->offset == ECS_VECTOR_OFFSET(elem_alignment), 
+            ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
 void* _ecs_vector_addn(
     ecs_vector_t **array_inout,
     ecs_size_t elem_size,
@@ -122,7 +281,7 @@ void* _ecs_vector_addn(
             }
         }
 
-        vector = resize(vector, offset, max_count * elem_size);
+        vector = resize(vector, elem_size, offset, max_count);
         vector->size = max_count;
         *array_inout = vector;
     }
@@ -150,7 +309,7 @@ void* _ecs_vector_add(
             if (!size) {
                 size = 2;
             }
-            vector = resize(vector, offset, size * elem_size);
+            vector = resize(vector, elem_size, offset, size);
             *array_inout = vector;
             vector->size = size;
         }
@@ -256,7 +415,7 @@ void _ecs_vector_reclaim(
 
     if (count < size) {
         size = count;
-        vector = resize(vector, offset, size * elem_size);
+        vector = resize(vector, elem_size, offset, size);
         vector->size = size;
         *array_inout = vector;
     }
@@ -302,7 +461,7 @@ int32_t _ecs_vector_set_size(
 
         if (result < elem_count) {
             elem_count = ecs_next_pow_of_2(elem_count);
-            vector = resize(vector, offset, elem_count * elem_size);
+            vector = resize(vector, elem_size, offset, elem_count);
             vector->size = elem_count;
             *array_inout = vector;
             result = elem_count;
@@ -473,7 +632,10 @@ ecs_vector_t* _ecs_vector_copy(
         return NULL;
     }
 
-    ecs_vector_t *dst = _ecs_vector_new(elem_size, offset, src->size);
-    ecs_os_memcpy(dst, src, offset + elem_size * src->count);
+    ecs_vector_t *dst = _ecs_vector_new_w_pool(
+        src->pool, elem_size, offset, src->size);
+    ecs_os_memcpy(ECS_OFFSET(dst, offset), ECS_OFFSET(src, offset), 
+        elem_size * src->count);
+    dst->count = src->count;
     return dst;
 }
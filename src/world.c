@@ -27,6 +27,123 @@ ecs_stage_t *ecs_get_stage(
     return NULL;
 }
 
+/* -- Paged array -- */
+
+static
+void paged_init(
+    ecs_paged_t *paged,
+    ecs_size_t elem_size)
+{
+    paged->tables = NULL;
+    paged->table_count = 0;
+    paged->elem_size = elem_size;
+}
+
+static
+void paged_fini(
+    ecs_paged_t *paged)
+{
+    int32_t t, p;
+    for (t = 0; t < paged->table_count; t ++) {
+        void **table = paged->tables[t];
+        if (table) {
+            for (p = 0; p < ECS_PAGE_TABLE_SIZE; p ++) {
+                ecs_os_free(table[p]);
+            }
+            ecs_os_free(table);
+        }
+    }
+
+    ecs_os_free(paged->tables);
+    paged->tables = NULL;
+    paged->table_count = 0;
+}
+
+static
+void* paged_get(
+    const ecs_paged_t *paged,
+    uint64_t index)
+{
+    index &= ECS_ENTITY_MASK;
+
+    uint64_t page_index = index >> ECS_PAGE_BITS;
+    int32_t table_index = (int32_t)(page_index >> ECS_PAGE_TABLE_BITS);
+    if (table_index >= paged->table_count) {
+        return NULL;
+    }
+
+    void **table = paged->tables[table_index];
+    if (!table) {
+        return NULL;
+    }
+
+    void *page = table[page_index & (ECS_PAGE_TABLE_SIZE - 1)];
+    if (!page) {
+        return NULL;
+    }
+
+    int32_t offset = (int32_t)(index & (ECS_PAGE_SIZE - 1));
+    return ECS_OFFSET(page, paged->elem_size * offset);
+}
+
+static
+void* paged_ensure(
+    ecs_paged_t *paged,
+    uint64_t index)
+{
+    void *result = paged_get(paged, index);
+    if (result) {
+        return result;
+    }
+
+    index &= ECS_ENTITY_MASK;
+
+    uint64_t page_index = index >> ECS_PAGE_BITS;
+    int32_t table_index = (int32_t)(page_index >> ECS_PAGE_TABLE_BITS);
+    int32_t count = paged->table_count;
+    if (table_index >= count) {
+        paged->tables = ecs_os_realloc(
+            paged->tables, (table_index + 1) * ECS_SIZEOF(void**));
+        ecs_os_memset(&paged->tables[count], 0, 
+            (table_index + 1 - count) * ECS_SIZEOF(void**));
+        paged->table_count = table_index + 1;
+    }
+
+    void **table = paged->tables[table_index];
+    if (!table) {
+        table = paged->tables[table_index] = ecs_os_calloc(
+            ECS_SIZEOF(void*) * ECS_PAGE_TABLE_SIZE);
+    }
+
+    void **page = &table[page_index & (ECS_PAGE_TABLE_SIZE - 1)];
+    ecs_assert(*page == NULL, ECS_INTERNAL_ERROR, NULL);
+    *page = ecs_os_calloc(paged->elem_size * ECS_PAGE_SIZE);
+
+    int32_t offset = (int32_t)(index & (ECS_PAGE_SIZE - 1));
+    return ECS_OFFSET(*page, paged->elem_size * offset);
+}
+
+/* Call action for each element in allocated pages */
+#define paged_each(paged, T, var, ...)\
+    {\
+        int32_t t_i, p_i;\
+        for (t_i = 0; t_i < (paged)->table_count; t_i ++) {\
+            void **p_t = (paged)->tables[t_i];\
+            if (!p_t) {\
+                continue;\
+            }\
+            for (p_i = 0; p_i < ECS_PAGE_TABLE_SIZE; p_i ++) {\
+                T *var = p_t[p_i];\
+                if (var) {\
+                    int32_t e_i;\
+                    for (e_i = 0; e_i < ECS_PAGE_SIZE; e_i ++, var ++) {\
+                        __VA_ARGS__\
+                    }\
+                }\
+            }\
+        }\
+    }
+
 /* Evaluate component monitor. If a monitored entity changed it will have set a
  * flag in one of the world's component monitors. Queries can register 
  * themselves with component monitors to determine whether they need to rematch
@@ -40,26 +157,33 @@ void eval_component_monitor(
         return;
     }
 
-    ecs_vector_t *eval[ECS_HI_COMPONENT_ID];
-    int32_t eval_count = 0;
+    /* Take ownership of the dirty list, so that components marked while
+     * notifying queries are evaluated next time */
+    ecs_vector_t *dirty = mon->dirty;
+    mon->dirty = NULL;
+    mon->rematch = false;
 
-    int32_t i;
-    for (i = 0; i < ECS_HI_COMPONENT_ID; i ++) {
-        if (mon->dirty_flags[i]) {
-            eval[eval_count ++] = mon->monitors[i];
-            mon->dirty_flags[i] = 0;
-        }
-    }
+    ecs_vector_each(dirty, ecs_entity_t, component, {
+        ecs_monitor_queries_t *m = paged_get(&mon->monitors, *component);
+        ecs_assert(m != NULL, ECS_INTERNAL_ERROR, NULL);
+        m->dirty = false;
+    });
 
-    for (i = 0; i < eval_count; i ++) {
-        ecs_vector_each(eval[i], ecs_query_t*, q_ptr, {
+    ecs_vector_each(dirty, ecs_entity_t, component, {
+        ecs_monitor_queries_t *m = paged_get(&mon->monitors, *component);
+        ecs_vector_each(m->queries, ecs_query_t*, q_ptr, {
             ecs_query_notify(world, *q_ptr, &(ecs_query_event_t) {
                 .kind = EcsQueryTableRematch
             });
         });
+    });
+
+    if (!mon->dirty) {
+        ecs_vector_clear(dirty);
+        mon->dirty = dirty;
+    } else {
+        ecs_vector_free(dirty);
     }
-    
-    mon->rematch = false;
 }
 
 void ecs_component_monitor_mark(
@@ -68,8 +192,11 @@ void ecs_component_monitor_mark(
 {
     /* Only flag if there are actually monitors registered, so that we
      * don't waste cycles evaluating monitors if there's no interest */
-    if (mon->monitors[component]) {
-        mon->dirty_flags[component] = true;
+    ecs_monitor_queries_t *m = paged_get(&mon->monitors, component);
+    if (m && m->queries && !m->dirty) {
+        m->dirty = true;
+        ecs_entity_t *elem = ecs_vector_add(&mon->dirty, ecs_entity_t);
+        *elem = component;
         mon->rematch = true;
     }
 }
@@ -82,23 +209,35 @@ void ecs_component_monitor_register(
     ecs_assert(mon != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(query != NULL, ECS_INTERNAL_ERROR, NULL);
 
-    /* Ignore component ids > ECS_HI_COMPONENT_ID */
-    if(component >= ECS_HI_COMPONENT_ID) {
+    /* Ignore ids with roles */
+    if (component & ECS_ROLE_MASK) {
         return;
-    }    
+    }
 
-    ecs_query_t **q = ecs_vector_add(&mon->monitors[component], ecs_query_t*);
+    ecs_monitor_queries_t *m = paged_ensure(&mon->monitors, component);
+    ecs_query_t **q = ecs_vector_add(&m->queries, ecs_query_t*);
     *q = query;
 }
 
+static
+void ecs_component_monitor_init(
+    ecs_component_monitor_t *mon)
+{
+    paged_init(&mon->monitors, ECS_SIZEOF(ecs_monitor_queries_t));
+    mon->dirty = NULL;
+    mon->rematch = false;
+}
+
 static
 void ecs_component_monitor_free(
     ecs_component_monitor_t *mon)
 {
-    int i;
-    for (i = 0; i < ECS_HI_COMPONENT_ID; i ++) {
-        ecs_vector_free(mon->monitors[i]);
-    }
+    paged_each(&mon->monitors, ecs_monitor_queries_t, m, {
+        ecs_vector_free(m->queries);
+    });
+
+    paged_fini(&mon->monitors);
+    ecs_vector_free(mon->dirty);
 }
 
 static
@@ -114,6 +253,10 @@ void init_store(ecs_world_t *world) {
 
     /* Initialize table map */
     world->store.table_map = ecs_map_new(ecs_vector_t*, 8);
+    world->store.type_index = ecs_map_new(ecs_table_t*, 8);
+
+    /* Initialize component index */
+    world->store.component_tables = ecs_map_new(ecs_vector_t*, 8);
 
     /* Initialize one root table per stage */
     ecs_init_root_table(world);
@@ -125,9 +268,19 @@ void clean_tables(
 {
     int32_t i, count = ecs_sparse_count(world->store.tables);
 
+    /* Free chunks before the tables that own their type */
     for (i = 0; i < count; i ++) {
         ecs_table_t *t = ecs_sparse_get(world->store.tables, ecs_table_t, i);
-        ecs_table_free(world, t);
+        if (t->chunk_head) {
+            ecs_table_free(world, t);
+        }
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *t = ecs_sparse_get(world->store.tables, ecs_table_t, i);
+        if (!t->chunk_head) {
+            ecs_table_free(world, t);
+        }
     }
 
     /* Clear the root table */
@@ -150,6 +303,113 @@ void fini_store(ecs_world_t *world) {
     }
     
     ecs_map_free(world->store.table_map);
+    ecs_map_free(world->store.type_index);
+
+    it = ecs_map_iter(world->store.component_tables);
+    while ((tables = ecs_map_next_ptr(&it, ecs_vector_t*, NULL))) {
+        ecs_vector_free(tables);
+    }
+
+    ecs_map_free(world->store.component_tables);
+
+    it = ecs_map_iter(world->store.retired_types);
+    ecs_vector_t *types;
+    while ((types = ecs_map_next_ptr(&it, ecs_vector_t*, NULL))) {
+        ecs_vector_each(types, ecs_type_t, type_ptr, {
+            ecs_vector_free((ecs_vector_t*)*type_ptr);
+        });
+        ecs_vector_free(types);
+    }
+
+    ecs_map_free(world->store.retired_types);
+    ecs_vector_free(world->gc_queue);
+}
+
+/* Default allocator of memory pools */
+static
+void* os_pool_malloc(
+    void *ctx,
+    ecs_size_t size)
+{
+    (void)ctx;
+    return ecs_os_malloc(size);
+}
+
+static
+void* os_pool_realloc(
+    void *ctx,
+    void *ptr,
+    ecs_size_t size)
+{
+    (void)ctx;
+    return ecs_os_realloc(ptr, size);
+}
+
+static
+void os_pool_free(
+    void *ctx,
+    void *ptr)
+{
+    (void)ctx;
+    ecs_os_free(ptr);
+}
+
+static
+void set_pool_allocator(
+    ecs_pool_t *pool,
+    const ecs_allocator_t *allocator)
+{
+    if (allocator) {
+        ecs_assert(allocator->malloc_ != NULL, ECS_INVALID_PARAMETER, NULL);
+        ecs_assert(allocator->realloc_ != NULL, ECS_INVALID_PARAMETER, NULL);
+        ecs_assert(allocator->free_ != NULL, ECS_INVALID_PARAMETER, NULL);
+        pool->allocator = *allocator;
+    } else {
+        pool->allocator = (ecs_allocator_t){
+            .malloc_ = os_pool_malloc,
+            .realloc_ = os_pool_realloc,
+            .free_ = os_pool_free
+        };
+    }
+}
+
+static
+ecs_pool_t* pool_new(
+    ecs_pool_kind_t kind,
+    const ecs_allocator_t *allocator)
+{
+    ecs_pool_t *result = ecs_os_calloc(ECS_SIZEOF(ecs_pool_t));
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+    result->kind = kind;
+    set_pool_allocator(result, allocator);
+    return result;
+}
+
+static
+void init_pools(
+    ecs_world_t *world)
+{
+    int32_t i;
+    for (i = 0; i < EcsPoolCount; i ++) {
+        world->pools[i] = pool_new((ecs_pool_kind_t)i, NULL);
+    }
+    world->retired_pools = NULL;
+}
+
+/* Pools are freed last, as all table storage must be released first */
+static
+void fini_pools(
+    ecs_world_t *world)
+{
+    int32_t i;
+    for (i = 0; i < EcsPoolCount; i ++) {
+        ecs_os_free(world->pools[i]);
+    }
+
+    ecs_vector_each(world->retired_pools, ecs_pool_t*, pool, {
+        ecs_os_free(*pool);
+    });
+    ecs_vector_free(world->retired_pools);
 }
 
 /* -- Public functions -- */
@@ -176,9 +436,7 @@ ecs_world_t *ecs_mini(void) {
     ecs_assert(world != NULL, ECS_OUT_OF_MEMORY, NULL);
 
     world->magic = ECS_WORLD_MAGIC;
-    memset(&world->c_info, 0, sizeof(ecs_c_info_t) * ECS_HI_COMPONENT_ID); 
-
-    world->t_info = ecs_map_new(ecs_c_info_t, 0);  
+    paged_init(&world->c_info, ECS_SIZEOF(ecs_c_info_t));
     world->fini_actions = NULL; 
 
     world->aliases = NULL;
@@ -186,10 +444,14 @@ ecs_world_t *ecs_mini(void) {
     world->queries = ecs_vector_new(ecs_query_t*, 0);
     world->fini_tasks = ecs_vector_new(ecs_entity_t, 0);
     world->child_tables = NULL;
+    world->name_index = NULL;
+    world->name_entries = NULL;
+    world->name_pending = NULL;
+    world->name_index_dirty = true;
     world->name_prefix = NULL;
 
-    memset(&world->component_monitors, 0, sizeof(world->component_monitors));
-    memset(&world->parent_monitors, 0, sizeof(world->parent_monitors));
+    ecs_component_monitor_init(&world->component_monitors);
+    ecs_component_monitor_init(&world->parent_monitors);
 
     world->type_handles = ecs_map_new(ecs_entity_t, 0);
     world->on_activate_components = ecs_map_new(ecs_on_demand_in_t, 0);
@@ -200,6 +462,7 @@ ecs_world_t *ecs_mini(void) {
     world->workers = NULL;
     world->workers_waiting = 0;
     world->workers_running = 0;
+    world->sync_spin_count = ECS_DEFAULT_SYNC_SPIN_COUNT;
     world->quit_workers = false;
     world->in_progress = false;
     world->is_merging = false;
@@ -226,6 +489,7 @@ ecs_world_t *ecs_mini(void) {
     world->stats.sleep_err = 0;
     world->stats.system_time_total = 0;
     world->stats.merge_time_total = 0;
+    world->stats.sync_wait_time_total = 0;
     world->stats.world_time_total = 0;
     world->stats.frame_count_total = 0;
     world->stats.merge_count_total = 0;
@@ -236,6 +500,15 @@ ecs_world_t *ecs_mini(void) {
 
     world->fps_sleep = 0;
 
+    world->column_alignment = 0;
+    world->cold_part_count = 0;
+    init_pools(world);
+
+    world->gc_reclaim_after = 0;
+    world->gc_delete_after = 0;
+    world->gc_queue = NULL;
+    world->snapshot_count = 0;
+
     world->context = NULL;
 
     world->arg_fps = 0;
@@ -374,6 +647,8 @@ void ecs_set_component_actions_w_entity(
             ECS_INCONSISTENT_COMPONENT_ACTION, NULL);
         ecs_assert(c_info->lifecycle.move == lifecycle->move, 
             ECS_INCONSISTENT_COMPONENT_ACTION, NULL);
+        ecs_assert(c_info->lifecycle.relocatable == lifecycle->relocatable, 
+            ECS_INCONSISTENT_COMPONENT_ACTION, NULL);
     } else {
         c_info->component = component;
         c_info->lifecycle = *lifecycle;
@@ -402,6 +677,48 @@ bool ecs_component_has_actions(
     return (c_info != NULL) && c_info->lifecycle_set;
 }
 
+void ecs_set_component_cold_w_entity(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    ecs_entity_t cold)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(component != cold, ECS_INVALID_PARAMETER, NULL);
+
+#ifndef NDEBUG
+    const EcsComponent *component_ptr = ecs_get(world, component, EcsComponent);
+    const EcsComponent *cold_ptr = ecs_get(world, cold, EcsComponent);
+
+    /* Both parts must be components with data */
+    ecs_assert(component_ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(component_ptr->size != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(cold_ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(cold_ptr->size != 0, ECS_INVALID_PARAMETER, NULL);
+#endif
+
+    ecs_c_info_t *c_info = ecs_get_or_create_c_info(world, component);
+    if (c_info->cold == cold) {
+        return;
+    }
+
+    /* Existing entities with the component would not have the cold part */
+    ecs_assert(!ecs_table_index_count(world, component, false), 
+        ECS_INVALID_OPERATION, NULL);
+
+    /* A component can have one cold part, and a cold part can't be split */
+    ecs_assert(!c_info->cold, ECS_INCONSISTENT_COMPONENT_ACTION, NULL);
+    ecs_assert(!c_info->hot, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_c_info_t *cold_info = ecs_get_or_create_c_info(world, cold);
+    ecs_assert(!cold_info->hot, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(!cold_info->cold, ECS_INVALID_PARAMETER, NULL);
+
+    c_info->cold = cold;
+    cold_info->hot = component;
+    world->cold_part_count ++;
+}
+
 void ecs_atfini(
     ecs_world_t *world,
     ecs_fini_action_t action,
@@ -462,20 +779,12 @@ static
 void fini_component_lifecycle(
     ecs_world_t *world)
 {
-    int32_t i;
-    for (i = 0; i < ECS_HI_COMPONENT_ID; i ++) {
-        ecs_vector_free(world->c_info[i].on_add);
-        ecs_vector_free(world->c_info[i].on_remove);
-    }
-
-    ecs_map_iter_t it = ecs_map_iter(world->t_info);
-    ecs_c_info_t *c_info;
-    while ((c_info = ecs_map_next(&it, ecs_c_info_t, NULL))) {
+    paged_each(&world->c_info, ecs_c_info_t, c_info, {
         ecs_vector_free(c_info->on_add);
         ecs_vector_free(c_info->on_remove);
-    }    
+    });
 
-    ecs_map_free(world->t_info);
+    paged_fini(&world->c_info);
 }
 
 /* Cleanup queries */
@@ -544,6 +853,9 @@ void fini_misc(
     on_demand_in_map_deinit(world->on_enable_components);
     ecs_map_free(world->type_handles);
     ecs_vector_free(world->fini_tasks);
+    ecs_vector_free(world->deferred_writes);
+    ecs_vector_free(world->deferred_write_order);
+    ecs_vector_free(world->deferred_write_slices);
     ecs_component_monitor_free(&world->component_monitors);
     ecs_component_monitor_free(&world->parent_monitors);
 }
@@ -576,11 +888,14 @@ int ecs_fini(
     fini_queries(world);
 
     fini_child_tables(world);
+    ecs_name_index_fini(world);
 
     fini_aliases(world);
 
     fini_misc(world);
 
+    fini_pools(world);
+
     /* In case the application tries to use the memory of the freed world, this
      * will trigger an assert */
     world->magic = 0;
@@ -707,6 +1022,113 @@ void ecs_set_target_fps(
     }
 }
 
+void ecs_set_table_gc(
+    ecs_world_t *world,
+    int32_t reclaim_after,
+    int32_t delete_after)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(reclaim_after >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(delete_after >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    bool was_enabled = world->gc_reclaim_after || world->gc_delete_after;
+
+    world->gc_reclaim_after = reclaim_after;
+    world->gc_delete_after = delete_after;
+
+    /* Tables that became empty while collection was disabled have not been
+     * queued, so add them now. Their empty count starts at this frame. */
+    if (!was_enabled) {
+        int32_t i, count = ecs_sparse_count(world->store.tables);
+        for (i = 0; i < count; i ++) {
+            ecs_table_t *table = ecs_sparse_get(
+                world->store.tables, ecs_table_t, i);
+            if (!ecs_table_count(table)) {
+                ecs_table_gc_enqueue(world, table);
+            }
+        }
+    }
+}
+
+void ecs_set_column_alignment(
+    ecs_world_t *world,
+    int32_t alignment)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(!world->snapshot_count, ECS_INVALID_OPERATION, NULL);
+    ecs_assert(alignment >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(alignment <= ECS_MAX_COLUMN_ALIGNMENT, 
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(!(alignment & (alignment - 1)), ECS_INVALID_PARAMETER, NULL);
+
+    if (world->column_alignment == alignment) {
+        return;
+    }
+
+    world->column_alignment = alignment;
+
+    int32_t i, count = ecs_sparse_count(world->store.tables);
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *table = ecs_sparse_get(
+            world->store.tables, ecs_table_t, i);
+        ecs_table_realign_columns(world, table);
+    }
+}
+
+void ecs_set_table_chunk_size(
+    ecs_world_t *world,
+    int32_t chunk_size)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(chunk_size >= 0, ECS_INVALID_PARAMETER, NULL);
+    world->table_chunk_size = chunk_size;
+}
+
+void ecs_set_allocator(
+    ecs_world_t *world,
+    ecs_pool_kind_t kind,
+    const ecs_allocator_t *allocator)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(kind < EcsPoolCount, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_pool_t *pool = world->pools[kind];
+    ecs_pool_stats_t *stats = &pool->stats;
+
+    /* If memory in the pool is still in use it has to be released with the
+     * current allocator, so keep the pool around and create a new one */
+    if (stats->malloc_count != stats->free_count) {
+        ecs_pool_t **elem = ecs_vector_add(&world->retired_pools, ecs_pool_t*);
+        *elem = pool;
+        world->pools[kind] = pool_new(kind, allocator);
+    } else {
+        set_pool_allocator(pool, allocator);
+    }
+}
+
+void ecs_get_pool_stats(
+    ecs_world_t *world,
+    ecs_pool_kind_t kind,
+    ecs_pool_stats_t *stats)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(kind < EcsPoolCount, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(stats != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    *stats = world->pools[kind]->stats;
+
+    ecs_vector_each(world->retired_pools, ecs_pool_t*, pool_ptr, {
+        ecs_pool_t *pool = *pool_ptr;
+        if (pool->kind == kind) {
+            stats->malloc_count += pool->stats.malloc_count;
+            stats->realloc_count += pool->stats.realloc_count;
+            stats->free_count += pool->stats.free_count;
+            stats->bytes_allocated += pool->stats.bytes_allocated;
+        }
+    });
+}
+
 void* ecs_get_context(
     ecs_world_t *world)
 {
@@ -826,16 +1248,11 @@ ecs_c_info_t * ecs_get_c_info(
     ecs_assert(component != 0, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(!(component & ECS_ROLE_MASK), ECS_INTERNAL_ERROR, NULL);
 
-    if (component < ECS_HI_COMPONENT_ID) {
-        ecs_c_info_t *c_info = &world->c_info[component];
-        if (c_info->component) {
-            ecs_assert(c_info->component == component, ECS_INTERNAL_ERROR, NULL);
-            return c_info;
-        } else {
-            return NULL;
-        }
+    ecs_c_info_t *c_info = paged_get(&world->c_info, component);
+    if (c_info && c_info->component == component) {
+        return c_info;
     } else {
-        return ecs_map_get(world->t_info, ecs_c_info_t, component);
+        return NULL;
     }
 }
 
@@ -845,16 +1262,17 @@ ecs_c_info_t * ecs_get_or_create_c_info(
 {    
     ecs_c_info_t *c_info = ecs_get_c_info(world, component);
     if (!c_info) {
-        if (component < ECS_HI_COMPONENT_ID) {
-            c_info = &world->c_info[component];
-            ecs_assert(c_info->component == 0, ECS_INTERNAL_ERROR, NULL);
-            c_info->component = component;
-        } else {
-            ecs_c_info_t t_info = { 0 };
-            ecs_map_set(world->t_info, component, &t_info);
-            c_info = ecs_map_get(world->t_info, ecs_c_info_t, component);
-            ecs_assert(c_info != NULL, ECS_INTERNAL_ERROR, NULL); 
+        c_info = paged_ensure(&world->c_info, component);
+
+        /* If the id was used by a previous generation of the entity, the
+         * element still holds the data of the deleted component */
+        if (c_info->component) {
+            ecs_vector_free(c_info->on_add);
+            ecs_vector_free(c_info->on_remove);
+            ecs_os_memset(c_info, 0, ECS_SIZEOF(ecs_c_info_t));
         }
+
+        c_info->component = component;
     }
 
     return c_info;
@@ -1049,6 +1467,10 @@ void ecs_frame_end(
         ecs_stage_merge_post_frame(world, stage);
     });        
 
+    if (world->gc_queue) {
+        ecs_run_table_gc(world);
+    }
+
     if (world->locking_enabled) {
         ecs_unlock(world);
 
@@ -1078,6 +1500,115 @@ void ecs_notify_queries(
     }    
 }
 
+void ecs_table_gc_enqueue(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    /* Also set frame when table is already queued, as a table can be emptied
+     * more than once before it is collected */
+    table->gc_frame = world->stats.frame_count_total;
+
+    if (!world->gc_reclaim_after && !world->gc_delete_after) {
+        return;
+    }
+
+    /* The root table is never collected */
+    if (!table->id || table->gc_index != -1 || world->is_fini) {
+        return;
+    }
+
+    table->gc_index = ecs_vector_count(world->gc_queue);
+    ecs_table_t **elem = ecs_vector_add(&world->gc_queue, ecs_table_t*);
+    *elem = table;
+}
+
+static
+void table_gc_dequeue(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    int32_t gc_index = table->gc_index;
+    if (gc_index == -1) {
+        return;
+    }
+
+    ecs_table_t **gc_queue = ecs_vector_first(world->gc_queue, ecs_table_t*);
+    int32_t gc_last = ecs_vector_count(world->gc_queue) - 1;
+    gc_queue[gc_index] = gc_queue[gc_last];
+    gc_queue[gc_index]->gc_index = gc_index;
+    ecs_vector_remove_last(world->gc_queue);
+    table->gc_index = -1;
+}
+
+/* Tables that are used as scope by a stage are cached by the stage, and cannot
+ * be deleted */
+static
+bool table_in_use(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    if (world->stage.scope_table == table || 
+        world->temp_stage.scope_table == table) 
+    {
+        return true;
+    }
+
+    ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
+        if (stage->scope_table == table) {
+            return true;
+        }
+    });
+
+    return false;
+}
+
+int32_t ecs_run_table_gc(
+    ecs_world_t *world)
+{
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_FROM_WORKER, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_OPERATION, NULL);
+
+    /* Snapshots store pointers to tables, so tables cannot be deleted while a
+     * snapshot is alive */
+    if (world->snapshot_count) {
+        return 0;
+    }
+
+    int32_t reclaim_after = world->gc_reclaim_after;
+    int32_t delete_after = world->gc_delete_after;
+    int32_t frame = world->stats.frame_count_total;
+    int32_t deleted = 0;
+
+    /* Iterate backwards, as tables are swapped out of the queue */
+    int32_t i;
+    for (i = ecs_vector_count(world->gc_queue) - 1; i >= 0; i --) {
+        ecs_table_t *table = *ecs_vector_get(world->gc_queue, ecs_table_t*, i);
+        int32_t empty_frames = frame - table->gc_frame;
+
+        if (ecs_table_count(table)) {
+            table_gc_dequeue(world, table);
+        } else if (delete_after && empty_frames >= delete_after) {
+            /* A table that owns the type of its chunks is deleted after the
+             * chunks, which are in the queue when they are empty */
+            if (!table_in_use(world, table) && 
+                !ecs_vector_count(table->chunks)) 
+            {
+                ecs_delete_table(world, table);
+                deleted ++;
+            }
+        } else if (reclaim_after && empty_frames >= reclaim_after) {
+            ecs_table_reclaim(world, table);
+
+            /* Keep table in queue if it still needs to be deleted */
+            if (!delete_after) {
+                table_gc_dequeue(world, table);
+            }
+        }
+    }
+
+    return deleted;
+}
+
 void ecs_delete_table(
     ecs_world_t *world,
     ecs_table_t *table)
@@ -1091,6 +1622,23 @@ void ecs_delete_table(
 
     uint32_t id = table->id;
 
+    /* Remove table from garbage collection queue */
+    table_gc_dequeue(world, table);
+
+    /* Remove table from component index and type lookup maps */
+    ecs_table_index_remove(world, table);
+
+    /* Keep the type around so that if the table is recreated, it gets the same
+     * type handle. Type handles are stored by the application, and are
+     * compared by pointer. The type of a chunk is owned by the first chunk. */
+    if (table->chunk_head) {
+        ecs_table_remove_chunk(table);
+    } else {
+        ecs_assert(!ecs_vector_count(table->chunks), 
+            ECS_INTERNAL_ERROR, NULL);
+        ecs_table_retire_type(world, table);
+    }
+
     /* Free resources associated with table */
     ecs_table_free(world, table);
 
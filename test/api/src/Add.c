@@ -687,3 +687,57 @@ void Add_add_after_remove_xor() {
     ecs_fini(world);
 }
 
+
+void Add_add_remove_tag_w_many_components() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t components[24];
+    int i;
+    for (i = 0; i < 24; i ++) {
+        components[i] = ecs_new_component(
+            world, 0, NULL, sizeof(int32_t), ECS_ALIGNOF(int32_t));
+    }
+
+    ecs_entity_t e[3];
+    int j;
+    for (j = 0; j < 3; j ++) {
+        e[j] = ecs_new(world, 0);
+        for (i = 0; i < 24; i ++) {
+            int32_t v = j * 100 + i;
+            ecs_set_ptr_w_entity(world, e[j], components[i], sizeof(int32_t), &v);
+        }
+    }
+
+    int k;
+    for (k = 0; k < 3; k ++) {
+        for (j = 0; j < 3; j ++) {
+            ecs_add(world, e[j], Tag);
+            test_assert(ecs_has(world, e[j], Tag));
+        }
+
+        for (j = 0; j < 3; j ++) {
+            for (i = 0; i < 24; i ++) {
+                const int32_t *v = ecs_get_w_entity(world, e[j], components[i]);
+                test_assert(v != NULL);
+                test_int(*v, j * 100 + i);
+            }
+        }
+
+        for (j = 0; j < 3; j ++) {
+            ecs_remove(world, e[j], Tag);
+            test_assert(!ecs_has(world, e[j], Tag));
+        }
+
+        for (j = 0; j < 3; j ++) {
+            for (i = 0; i < 24; i ++) {
+                const int32_t *v = ecs_get_w_entity(world, e[j], components[i]);
+                test_assert(v != NULL);
+                test_int(*v, j * 100 + i);
+            }
+        }
+    }
+
+    ecs_fini(world);
+}
@@ -1065,20 +1065,21 @@ void ComponentLifecycle_merge_to_different_table() {
     test_int(copy_position, 0);
     test_int(move_position, 0);
 
-    test_int(ctor_velocity, 3);
+    /* Operations for the same entity are merged in a single move */
+    test_int(ctor_velocity, 1);
     test_int(dtor_velocity, 0);
     test_int(copy_velocity, 0);
-    test_int(move_velocity, 3);
+    test_int(move_velocity, 1);
 
-    test_int(ctor_rotation, 2);
+    test_int(ctor_rotation, 0);
     test_int(dtor_rotation, 1);
     test_int(copy_rotation, 0);
-    test_int(move_rotation, 2);
+    test_int(move_rotation, 0);
 
-    test_int(ctor_mass, 2);
+    test_int(ctor_mass, 1);
     test_int(dtor_mass, 0);
     test_int(copy_mass, 0);
-    test_int(move_mass, 1);
+    test_int(move_mass, 0);
 
     ecs_fini(world);
 }
@@ -1685,3 +1686,392 @@ void ComponentLifecycle_set_lifecycle_after_trigger() {
 
     ecs_fini(world);  
 }
+
+void ComponentLifecycle_merge_batch_to_different_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_set(world, ecs_typeid(Position), EcsComponentLifecycle, {
+        .ctor = ecs_ctor(Position),
+        .dtor = ecs_dtor(Position),
+        .copy = ecs_copy(Position),
+        .move = ecs_move(Position)
+    });
+
+    ecs_set(world, ecs_typeid(Velocity), EcsComponentLifecycle, {
+        .ctor = ecs_ctor(Velocity),
+        .dtor = ecs_dtor(Velocity),
+        .copy = ecs_copy(Velocity),
+        .move = ecs_move(Velocity)
+    });
+
+    ecs_entity_t e[6];
+    int i;
+    for (i = 0; i < 6; i ++) {
+        e[i] = ecs_new(world, Position);
+        ecs_add(world, e[i], Velocity);
+    }
+
+    ctor_position = 0;
+    move_position = 0;
+    ctor_velocity = 0;
+    move_velocity = 0;
+
+    ecs_defer_begin(world);
+    ecs_add(world, e[0], Mass);
+    ecs_remove(world, e[0], Velocity);
+    ecs_add(world, e[2], Mass);
+    ecs_remove(world, e[2], Velocity);
+    ecs_add(world, e[4], Mass);
+    ecs_remove(world, e[4], Velocity);
+    ecs_defer_end(world);
+
+    for (i = 0; i < 6; i ++) {
+        test_assert(ecs_has(world, e[i], Position));
+        test_bool(ecs_has(world, e[i], Velocity), i % 2);
+        test_bool(ecs_has(world, e[i], Mass), !(i % 2));
+    }
+
+    /* Each moved value is moved into a constructed element */
+    test_assert(move_position != 0);
+    test_int(ctor_position, move_position);
+    test_int(dtor_position, 0);
+
+    /* Removed values are destructed once, remaining values are moved to fill
+     * the rows of the entities that were moved out */
+    test_int(dtor_velocity, 3);
+    test_int(ctor_velocity, move_velocity);
+
+    ecs_fini(world);
+}
+
+void ComponentLifecycle_ctor_on_add_hi_id() {
+    ecs_world_t *world = ecs_init();
+
+    /* Use up the low component id range, so Position gets a high id */
+    while (ecs_new_component_id(world) < ECS_HI_COMPONENT_ID) { }
+
+    ECS_COMPONENT(world, Position);
+    test_assert(ecs_typeid(Position) >= ECS_HI_COMPONENT_ID);
+
+    cl_ctx ctx = { { 0 } };
+
+    ecs_set(world, ecs_typeid(Position), EcsComponentLifecycle, {
+        .ctor = comp_ctor,
+        .ctx = &ctx
+    });
+
+    /* Create table for Position, which caches the component info */
+    ecs_entity_t e = ecs_new(world, 0);
+    ecs_add(world, e, Position);
+    test_int(ctx.ctor.invoked, 1);
+    ecs_remove(world, e, Position);
+
+    /* Register component info for many other high ids */
+    cl_ctx ctx_other = { { 0 } };
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_entity_t c = ecs_new_component_id(world);
+        ecs_set(world, c, EcsComponent, {
+            .size = ECS_SIZEOF(Position),
+            .alignment = ECS_ALIGNOF(Position)
+        });
+        ecs_set(world, c, EcsComponentLifecycle, {
+            .ctor = comp_ctor,
+            .ctx = &ctx_other
+        });
+    }
+
+    /* Component info cached by the table must still be valid */
+    ecs_add(world, e, Position);
+    test_int(ctx.ctor.invoked, 2);
+    test_int(ctx.ctor.component, ecs_typeid(Position));
+    test_int(ctx.ctor.entity, e);
+    test_int(ctx_other.ctor.invoked, 0);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void ComponentLifecycle_move_on_add_remove_cached_edge() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    cl_ctx ctx = { { 0 } };
+
+    ecs_set(world, ecs_typeid(Position), EcsComponentLifecycle, {
+        .ctor = comp_ctor,
+        .dtor = comp_dtor,
+        .move = comp_move,
+        .ctx = &ctx
+    });
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_set(world, e1, Position, {1, 2});
+    ecs_set(world, e2, Position, {3, 4});
+
+    ctx = (cl_ctx){ { 0 } };
+
+    /* Second entity moves along the same edges as the first. Moving it also
+     * grows the destination table, which moves the first entity. */
+    ecs_add(world, e1, Tag);
+    ecs_add(world, e2, Tag);
+    test_int(ctx.ctor.invoked, 3);
+    test_int(ctx.move.invoked, 3);
+    test_int(ctx.move.entity, e2);
+    test_int(ctx.dtor.invoked, 0);
+
+    ecs_add(world, e1, Velocity);
+    ecs_add(world, e2, Velocity);
+    ecs_remove(world, e1, Velocity);
+    ecs_remove(world, e2, Velocity);
+    ecs_remove(world, e1, Tag);
+    ecs_remove(world, e2, Tag);
+    test_int(ctx.ctor.invoked, 12);
+    test_int(ctx.move.invoked, 12);
+
+    ctx = (cl_ctx){ { 0 } };
+
+    /* Component with lifecycle is destructed when removed */
+    ecs_add(world, e1, Velocity);
+    ecs_remove(world, e1, Position);
+    test_int(ctx.dtor.invoked, 1);
+    test_int(ctx.dtor.entity, e1);
+    test_int(ctx.move.invoked, 2);
+
+    ecs_add(world, e2, Velocity);
+    ecs_remove(world, e2, Position);
+    test_int(ctx.dtor.invoked, 2);
+    test_int(ctx.dtor.entity, e2);
+    test_int(ctx.move.invoked, 3);
+
+    /* Component with lifecycle is constructed when added */
+    ecs_add(world, e1, Position);
+    ecs_add(world, e2, Position);
+    test_int(ctx.ctor.invoked, 5);
+    test_int(ctx.ctor.entity, e2);
+
+    const Position *p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void ComponentLifecycle_relocatable_no_move() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    cl_ctx ctx = { { 0 } };
+
+    ecs_set(world, ecs_typeid(Position), EcsComponentLifecycle, {
+        .ctor = comp_ctor,
+        .dtor = comp_dtor,
+        .move = comp_move,
+        .ctx = &ctx,
+        .relocatable = true
+    });
+
+    /* Growing the table relocates existing values */
+    ecs_entity_t e[64];
+    int i;
+    for (i = 0; i < 64; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    test_int(ctx.ctor.invoked, 64);
+    test_int(ctx.move.invoked, 0);
+
+    ctx = (cl_ctx){ { 0 } };
+
+    /* Moving between tables relocates the value, and fills the hole with the
+     * last value in the table */
+    ecs_add(world, e[0], Tag);
+    ecs_add(world, e[1], Tag);
+    ecs_remove(world, e[0], Tag);
+    test_int(ctx.ctor.invoked, 0);
+    test_int(ctx.move.invoked, 0);
+    test_int(ctx.dtor.invoked, 0);
+
+    /* Deleting an entity destructs its value and relocates the last value */
+    ecs_delete(world, e[2]);
+    test_int(ctx.ctor.invoked, 0);
+    test_int(ctx.move.invoked, 0);
+    test_int(ctx.dtor.invoked, 1);
+    test_int(ctx.dtor.entity, e[2]);
+
+    for (i = 0; i < 64; i ++) {
+        if (i == 2) {
+            continue;
+        }
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void ComponentLifecycle_relocatable_merge() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    cl_ctx ctx = { { 0 } };
+
+    ecs_set(world, ecs_typeid(Position), EcsComponentLifecycle, {
+        .ctor = comp_ctor,
+        .move = comp_move,
+        .ctx = &ctx,
+        .relocatable = true
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {1, 2});
+    ecs_add(world, e1, Tag);
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {3, 4});
+
+    ctx = (cl_ctx){ { 0 } };
+
+    /* Merges the table of e2 into the (non-empty) table of e1 */
+    ecs_bulk_add_entity(world, Tag, &(ecs_filter_t){
+        .include = ecs_type(Position)
+    });
+
+    test_assert(ecs_has(world, e2, Tag));
+    test_int(ctx.ctor.invoked, 0);
+    test_int(ctx.move.invoked, 0);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 1);
+    test_int(p->y, 2);
+
+    p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 3);
+    test_int(p->y, 4);
+
+    ecs_fini(world);
+}
+
+void ComponentLifecycle_relocatable_deferred_move() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    cl_ctx ctx = { { 0 } };
+
+    ecs_set(world, ecs_typeid(Position), EcsComponentLifecycle, {
+        .ctor = comp_ctor,
+        .dtor = comp_dtor,
+        .move = comp_move,
+        .ctx = &ctx,
+        .relocatable = true
+    });
+
+    ecs_entity_t e[3];
+    int i;
+    for (i = 0; i < 3; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ctx = (cl_ctx){ { 0 } };
+
+    /* Entities with the same source and destination table are moved together,
+     * which relocates their values */
+    ecs_defer_begin(world);
+    for (i = 0; i < 3; i ++) {
+        ecs_add(world, e[i], Tag);
+    }
+    ecs_defer_end(world);
+
+    test_int(ctx.move.invoked, 0);
+    test_int(ctx.ctor.invoked, ctx.dtor.invoked);
+
+    for (i = 0; i < 3; i ++) {
+        test_assert(ecs_has(world, e[i], Tag));
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+static ecs_size_t max_alloc_size = 0;
+static ecs_os_api_realloc_t realloc_orig;
+static ecs_os_api_calloc_t calloc_orig;
+
+static
+void* track_realloc(void *ptr, ecs_size_t size) {
+    if (size > max_alloc_size) {
+        max_alloc_size = size;
+    }
+    return realloc_orig(ptr, size);
+}
+
+static
+void* track_calloc(ecs_size_t size) {
+    if (size > max_alloc_size) {
+        max_alloc_size = size;
+    }
+    return calloc_orig(size);
+}
+
+void ComponentLifecycle_ctor_on_add_hi_entity_range() {
+    ecs_world_t *world = ecs_init();
+
+    /* Use up the low component id range, so that Position gets an id from the
+     * entity range */
+    while (ecs_new_component_id(world) < ECS_HI_COMPONENT_ID) { }
+    ecs_set_entity_range(world, 0x10000000, 0);
+
+    ECS_COMPONENT(world, Position);
+    test_assert(ecs_typeid(Position) >= 0x10000000);
+
+    ecs_entity_t e = ecs_new(world, 0);
+    cl_ctx ctx = { { 0 } };
+
+    /* Track allocations while component info for the high id is stored */
+    realloc_orig = ecs_os_api.realloc_;
+    calloc_orig = ecs_os_api.calloc_;
+    ecs_os_api.realloc_ = track_realloc;
+    ecs_os_api.calloc_ = track_calloc;
+
+    ecs_set(world, ecs_typeid(Position), EcsComponentLifecycle, {
+        .ctor = comp_ctor,
+        .ctx = &ctx
+    });
+
+    ecs_add(world, e, Position);
+
+    ecs_os_api.realloc_ = realloc_orig;
+    ecs_os_api.calloc_ = calloc_orig;
+
+    test_int(ctx.ctor.invoked, 1);
+    test_int(ctx.ctor.component, ecs_typeid(Position));
+
+    /* Memory used to store the component info must not be proportional to
+     * the component id */
+    test_assert(max_alloc_size < 64 * 1024);
+
+    ecs_fini(world);
+}
@@ -1354,3 +1354,478 @@ void DeferredActions_defer_get_mut_trait() {
 
     ecs_fini(world);
 }
+
+void DeferredActions_defer_set_many() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    int i, count = 10000;
+    ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+    for (i = 0; i < count; i ++) {
+        ids[i] = ecs_new(world, 0);
+    }
+
+    int32_t frame;
+    for (frame = 0; frame < 2; frame ++) {
+        ecs_defer_begin(world);
+        for (i = 0; i < count; i ++) {
+            ecs_set(world, ids[i], Position, {i, frame});
+        }
+        if (!frame) {
+            test_assert(!ecs_has(world, ids[0], Position));
+        }
+        ecs_defer_end(world);
+
+        for (i = 0; i < count; i ++) {
+            const Position *p = ecs_get(world, ids[i], Position);
+            test_assert(p != NULL);
+            test_int(p->x, i);
+            test_int(p->y, frame);
+        }
+    }
+
+    ecs_os_free(ids);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_bulk_new_w_large_data() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    /* Data is larger than a single chunk of the stage arena */
+    int i, count = 10000;
+    Position *data = ecs_os_malloc(count * ECS_SIZEOF(Position));
+    for (i = 0; i < count; i ++) {
+        data[i] = (Position){i, i * 2};
+    }
+
+    ecs_entity_t e = ecs_new(world, 0);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+
+    const ecs_entity_t *temp_ids = ecs_bulk_new_w_data(world, count, 
+        &(ecs_entities_t){
+            .array = (ecs_entity_t[]){ecs_typeid(Position)},
+            .count = 1
+        },
+        (void*[]){ data });
+
+    ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+    ecs_os_memcpy(ids, temp_ids, count * ECS_SIZEOF(ecs_entity_t));
+
+    ecs_set(world, e, Position, {30, 40});
+    ecs_defer_end(world);
+
+    for (i = 0; i < count; i ++) {
+        const Position *p = ecs_get(world, ids[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_os_free(ids);
+    ecs_os_free(data);
+
+    ecs_fini(world);
+}
+
+static
+void OnSetPositionSetVelocity(ecs_iter_t *it) {
+    Position *p = ecs_column(it, Position, 1);
+    ECS_COLUMN_COMPONENT(it, Velocity, 2);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_set(it->world, it->entities[i], Velocity, {p[i].x * 2, p[i].y * 2});
+    }
+}
+
+void DeferredActions_defer_set_w_on_set_defer() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, OnSetPositionSetVelocity, EcsOnSet, Position, :Velocity);
+
+    int i, count = 1000;
+    ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+    for (i = 0; i < count; i ++) {
+        ids[i] = ecs_new(world, 0);
+    }
+
+    ecs_defer_begin(world);
+    for (i = 0; i < count; i ++) {
+        ecs_set(world, ids[i], Position, {i, i + 1});
+    }
+    ecs_defer_end(world);
+
+    for (i = 0; i < count; i ++) {
+        const Position *p = ecs_get(world, ids[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i + 1);
+
+        const Velocity *v = ecs_get(world, ids[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i * 2);
+        test_int(v->y, (i + 1) * 2);
+    }
+
+    ecs_os_free(ids);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_coalesce_add_remove_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_entity_t e = ecs_new(world, 0);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e, Position);
+    ecs_add(world, e, Velocity);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_add(world, e, Mass);
+    ecs_set(world, e, Position, {30, 40});
+    test_assert(!ecs_has(world, e, Position));
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+    test_assert(ecs_has(world, e, Mass));
+    test_int(ecs_vector_count(ecs_get_type(world, e)), 3);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_coalesce_remove_add() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_defer_begin(world);
+    ecs_add(world, e, Velocity);
+    ecs_remove(world, e, Position);
+    ecs_set(world, e, Position, {30, 40});
+    ecs_remove(world, e, Velocity);
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+static int32_t coalesce_on_add = 0;
+static int32_t coalesce_on_set = 0;
+
+static
+void CoalesceOnAdd(ecs_iter_t *it) {
+    coalesce_on_add += it->count;
+}
+
+static
+void CoalesceOnSet(ecs_iter_t *it) {
+    ECS_COLUMN(it, Position, p, 1);
+
+    /* Value must be assigned before OnSet is invoked */
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        test_int(p[i].x, coalesce_on_set + 1);
+    }
+
+    coalesce_on_set += it->count;
+}
+
+void DeferredActions_defer_coalesce_w_on_add_on_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_TRIGGER(world, CoalesceOnAdd, EcsOnAdd, Position);
+    ECS_SYSTEM(world, CoalesceOnSet, EcsOnSet, Position);
+
+    ecs_entity_t e = ecs_new(world, 0);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {1, 0});
+    ecs_add(world, e, Velocity);
+    ecs_set(world, e, Position, {2, 0});
+    ecs_defer_end(world);
+
+    test_int(coalesce_on_add, 1);
+    test_int(coalesce_on_set, 2);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 2);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_coalesce_interleaved_entities() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_new(world, 0);
+    ecs_entity_t e2 = ecs_new(world, 0);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {1, 2});
+    ecs_set(world, e2, Velocity, {3, 4});
+    ecs_add(world, e1, Velocity);
+    ecs_delete(world, e2);
+    ecs_set(world, e2, Position, {5, 6});
+    ecs_remove(world, e1, Position);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_has(world, e1, Position));
+    test_assert(ecs_has(world, e1, Velocity));
+    test_assert(!ecs_is_alive(world, e2));
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batch_move() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    int i, count = 100;
+    ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+    for (i = 0; i < count; i ++) {
+        ids[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_defer_begin(world);
+    for (i = 0; i < count; i += 3) {
+        ecs_set(world, ids[i], Velocity, {i, 0});
+    }
+    ecs_defer_end(world);
+
+    for (i = 0; i < count; i ++) {
+        const Position *p = ecs_get(world, ids[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+
+        const Velocity *v = ecs_get(world, ids[i], Velocity);
+        if (i % 3) {
+            test_assert(v == NULL);
+        } else {
+            test_assert(v != NULL);
+            test_int(v->x, i);
+        }
+    }
+
+    test_int(ecs_count(world, Velocity), (count + 2) / 3);
+
+    ecs_os_free(ids);
+
+    ecs_fini(world);
+}
+
+static int32_t batch_on_remove = 0;
+
+static
+void BatchOnRemove(ecs_iter_t *it) {
+    ECS_COLUMN(it, Velocity, v, 1);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        test_int(v[i].x, (int32_t)it->entities[i]);
+    }
+
+    batch_on_remove += it->count;
+}
+
+void DeferredActions_defer_remove_batch_move_w_on_remove() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_TRIGGER(world, BatchOnRemove, EcsOnRemove, Velocity);
+
+    int i, count = 100;
+    ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+    for (i = 0; i < count; i ++) {
+        ids[i] = ecs_set(world, 0, Position, {i, 0});
+        ecs_set(world, ids[i], Velocity, {(int32_t)ids[i], 0});
+    }
+
+    ecs_defer_begin(world);
+    for (i = 0; i < count; i += 2) {
+        ecs_remove(world, ids[i], Velocity);
+    }
+    ecs_defer_end(world);
+
+    test_int(batch_on_remove, count / 2);
+
+    for (i = 0; i < count; i ++) {
+        const Position *p = ecs_get(world, ids[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_bool(ecs_has(world, ids[i], Velocity), i % 2);
+        if (i % 2) {
+            const Velocity *v = ecs_get(world, ids[i], Velocity);
+            test_int(v->x, (int32_t)ids[i]);
+        }
+    }
+
+    ecs_os_free(ids);
+
+    ecs_fini(world);
+}
+
+static int32_t batch_on_add = 0;
+static ecs_entity_t position_id = 0;
+
+static
+void GetPositionOnAdd(ecs_iter_t *it) {
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        const Position *p = ecs_get_w_entity(
+            it->world, it->entities[i], position_id);
+        test_assert(p != NULL);
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+    }
+
+    batch_on_add += it->count;
+}
+
+void DeferredActions_defer_set_add_w_on_add_get_value() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    position_id = ecs_typeid(Position);
+
+    ECS_TRIGGER(world, GetPositionOnAdd, EcsOnAdd, Velocity);
+
+    ecs_entity_t e = ecs_new(world, 0);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_add(world, e, Velocity);
+    ecs_defer_end(world);
+
+    test_int(batch_on_add, 1);
+    test_assert(ecs_has(world, e, Velocity));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+static
+void MonitorPosition(ecs_iter_t *it) {
+    ECS_COLUMN(it, Position, p, 1);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        test_int(p[i].x, 10);
+        test_int(p[i].y, 20);
+    }
+
+    batch_on_add += it->count;
+}
+
+void DeferredActions_defer_set_add_w_monitor_get_value() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, MonitorPosition, EcsMonitor, Position, Velocity);
+
+    ecs_entity_t e = ecs_new(world, 0);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_set(world, e, Velocity, {1, 2});
+    ecs_defer_end(world);
+
+    test_int(batch_on_add, 1);
+
+    const Velocity *v = ecs_get(world, e, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
+
+static
+void UnSetPosition(ecs_iter_t *it) {
+    ECS_COLUMN(it, Position, p, 1);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        test_int(p[i].x, 10);
+        test_int(p[i].y, 20);
+    }
+
+    batch_on_remove += it->count;
+}
+
+void DeferredActions_defer_set_remove_w_un_set_get_value() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, UnSetPosition, EcsUnSet, Position, Velocity);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+    ecs_add(world, e, Velocity);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_remove(world, e, Velocity);
+    ecs_defer_end(world);
+
+    test_int(batch_on_remove, 1);
+    test_assert(!ecs_has(world, e, Velocity));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
@@ -644,3 +644,78 @@ void DirectAccess_get_record_column_empty_table() {
 
     ecs_fini(world);
 }
+
+void DirectAccess_set_column_w_alignment() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_column_alignment(world, 64);
+
+    ecs_table_t *t = ecs_table_from_str(world, "Position");
+    test_assert(t != NULL);
+    test_int(ecs_table_column_alignment(world, t, 0), 64);
+
+    ecs_vector_t *v_e = ecs_vector_new(ecs_entity_t, 2);
+    ecs_vector_add(&v_e, ecs_entity_t)[0] = 0;
+    ecs_vector_add(&v_e, ecs_entity_t)[0] = 0;
+
+    ecs_vector_t *v_r = ecs_vector_new(ecs_record_t*, 2);
+    ecs_vector_set_count(&v_r, ecs_record_t*, 2);
+    ecs_vector_zero(v_r, ecs_record_t*);
+
+    ecs_table_set_entities(t, v_e, v_r);
+
+    ecs_vector_t *v_p = ecs_vector_new_t(ECS_SIZEOF(Position), 64, 2);
+    ((Position*)ecs_vector_add_t(&v_p, ECS_SIZEOF(Position), 64))[0] = 
+        (Position){10, 20};
+    ((Position*)ecs_vector_add_t(&v_p, ECS_SIZEOF(Position), 64))[0] = 
+        (Position){30, 40};
+    ecs_table_set_column(world, t, 0, v_p);
+
+    test_int(ecs_table_count(t), 2);
+    test_assert(ecs_table_get_column(t, 0) == v_p);
+
+    Position *p = ecs_vector_first_t(v_p, ECS_SIZEOF(Position), 64);
+    test_assert(((uintptr_t)p % 64) == 0);
+    test_int(p[1].x, 30);
+    test_int(p[1].y, 40);
+
+    ecs_fini(world);
+}
+
+void DirectAccess_set_column_w_wrong_alignment() {
+    install_test_abort();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_column_alignment(world, 64);
+
+    ecs_table_t *t = ecs_table_from_str(world, "Position");
+    test_assert(t != NULL);
+
+    ecs_vector_t *v_p = ecs_vector_new(Position, 2);
+
+    test_expect_abort();
+
+    ecs_table_set_column(world, t, 0, v_p);
+}
+
+void DirectAccess_free_aligned_column_w_vector_free() {
+    install_test_abort();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_column_alignment(world, 64);
+
+    ecs_vector_t *v_p = ecs_vector_new_t(ECS_SIZEOF(Position), 64, 2);
+
+    /* Over-aligned vectors must be freed with ecs_vector_free_t */
+    test_expect_abort();
+
+    ecs_vector_free(v_p);
+}
@@ -1082,3 +1082,127 @@ void EnabledComponents_sort() {
 
     ecs_fini(world);
 }
+
+void EnabledComponents_query_randomized_5_bitsets() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_COMPONENT(world, Rotation);
+    ECS_COMPONENT(world, Color);
+
+    int32_t i, total_count = 0;
+    for (i = 0; i < 65536; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        ecs_add(world, e, Velocity);
+        ecs_add(world, e, Mass);
+        ecs_add(world, e, Rotation);
+        ecs_add(world, e, Color);
+
+        /* Bias towards enabled so that all 5 are enabled frequently */
+        bool enable_1 = rand() % 4 != 0;
+        ecs_enable_component(world, e, Position, enable_1);
+        bool enable_2 = rand() % 4 != 0;
+        ecs_enable_component(world, e, Velocity, enable_2);
+        bool enable_3 = rand() % 4 != 0;
+        ecs_enable_component(world, e, Mass, enable_3);        
+        bool enable_4 = rand() % 4 != 0;
+        ecs_enable_component(world, e, Rotation, enable_4); 
+        bool enable_5 = rand() % 4 != 0;
+        ecs_enable_component(world, e, Color, enable_5); 
+
+        if (enable_1 && enable_2 && enable_3 && enable_4 && enable_5) {
+            total_count ++;
+        }
+    }
+
+    test_assert(total_count != 0);
+
+    ecs_query_t *q = ecs_query_new(world, 
+        "Position, Velocity, Mass, Rotation, Color");
+    ecs_iter_t it = ecs_query_iter(q);
+
+    int32_t count = 0;
+
+    while (ecs_query_next(&it)) {
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            test_assert(ecs_is_component_enabled(world, it.entities[i], Position));
+            test_assert(ecs_is_component_enabled(world, it.entities[i], Velocity));
+            test_assert(ecs_is_component_enabled(world, it.entities[i], Mass));
+            test_assert(ecs_is_component_enabled(world, it.entities[i], Rotation));
+            test_assert(ecs_is_component_enabled(world, it.entities[i], Color));
+        }
+        count += it.count;
+    }
+
+    test_int(count, total_count);
+
+    ecs_fini(world);
+}
+
+void EnabledComponents_query_long_run() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[1024];
+    int32_t i;
+    for (i = 0; i < 1024; i ++) {
+        e[i] = ecs_new(world, Position);
+        ecs_enable_component(world, e[i], Position, true);
+    }
+
+    /* Leaves a single run that spans multiple blocks of 256 elements */
+    for (i = 0; i < 10; i ++) {
+        ecs_enable_component(world, e[i], Position, false);
+    }
+    for (i = 1000; i < 1024; i ++) {
+        ecs_enable_component(world, e[i], Position, false);
+    }
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 990);
+    test_int(it.entities[0], e[10]);
+    test_int(it.entities[989], e[999]);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void EnabledComponents_query_2_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_add(world, e3, Velocity);
+    ecs_entity_t e4 = ecs_new(world, Position);
+    ecs_add(world, e4, Velocity);
+
+    ecs_enable_component(world, e1, Position, false);
+    ecs_enable_component(world, e2, Position, true);
+    ecs_enable_component(world, e3, Position, true);
+    ecs_enable_component(world, e4, Position, false);
+
+    /* Iteration of the second table must start from its first row */
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], e2);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], e3);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
@@ -523,3 +523,140 @@ void FilterIter_iter_get_tag_column() {
     
     ecs_fini(world);
 }
+
+void FilterIter_iter_inherited_component() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t base = ecs_set(world, 0, Position, {10, 20});
+    ecs_add(world, base, Velocity);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_add_entity(world, e1, ECS_INSTANCEOF | base);
+
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_set(world, e2, Position, {30, 40});
+
+    ecs_iter_t it = ecs_filter_iter(world, &(ecs_filter_t){
+        .include = ecs_type(Position),
+    });
+
+    int entity_count = 0;
+    bool found_e1 = false, found_e2 = false;
+
+    while (ecs_filter_next(&it)) {
+        int i;
+        for (i = 0; i < it.count; i ++) {
+            if (it.entities[i] == e1) {
+                found_e1 = true;
+            } else if (it.entities[i] == e2) {
+                found_e2 = true;
+            }
+        }
+        entity_count += it.count;
+    }
+
+    test_int(entity_count, 3);
+    test_assert(found_e1);
+    test_assert(found_e2);
+    
+    ecs_fini(world);
+}
+
+void FilterIter_iter_rarest_component() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_TAG(world, Tag);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        ecs_add_entity(world, e, ecs_new(world, 0));
+    }
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_add(world, e, Velocity);
+    ecs_add(world, e, Tag);
+
+    ECS_TYPE(world, Type, Position, Tag);
+
+    ecs_iter_t it = ecs_filter_iter(world, &(ecs_filter_t){
+        .include = ecs_type(Type),
+        .exclude = ecs_type(Mass)
+    });
+
+    int table_count = 0;
+    while (ecs_filter_next(&it)) {
+        test_int(it.count, 1);
+        test_assert(it.entities[0] == e);
+        table_count ++;
+    }
+
+    test_int(table_count, 1);
+    
+    ecs_fini(world);
+}
+
+void FilterIter_iter_after_delete_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t child = ecs_new(world, Position);
+    ecs_add_entity(world, child, ECS_CHILDOF | parent);
+
+    ecs_entity_t e = ecs_new(world, Position);
+
+    /* Deletes the table of the child */
+    ecs_delete(world, parent);
+    test_assert(!ecs_is_alive(world, child));
+
+    ecs_iter_t it = ecs_filter_iter(world, &(ecs_filter_t){
+        .include = ecs_type(Position),
+    });
+
+    int table_count = 0;
+    while (ecs_filter_next(&it)) {
+        test_int(it.count, 1);
+        test_assert(it.entities[0] == e);
+        table_count ++;
+    }
+
+    test_int(table_count, 1);
+    
+    ecs_fini(world);
+}
+
+void FilterIter_iter_match_any() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    ecs_new(world, Position);
+    ecs_new(world, Velocity);
+    ecs_new(world, Mass);
+
+    ecs_iter_t it = ecs_filter_iter(world, &(ecs_filter_t){
+        .include = ecs_type(Type),
+        .include_kind = EcsMatchAny
+    });
+
+    int entity_count = 0;
+    while (ecs_filter_next(&it)) {
+        entity_count += it.count;
+    }
+
+    test_int(entity_count, 2);
+    
+    ecs_fini(world);
+}
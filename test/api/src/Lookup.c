@@ -276,3 +276,128 @@ void Lookup_lookup_symbol_null() {
 
     ecs_fini(world);
 }
+
+void Lookup_lookup_child_after_reparent() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, Parent1, 0);
+    ECS_ENTITY(world, Parent2, 0);
+
+    ecs_entity_t e = ecs_set(world, 0, EcsName, {"Child"});
+    ecs_add_entity(world, e, ECS_CHILDOF | Parent1);
+    test_assert(ecs_lookup_child(world, Parent1, "Child") == e);
+    test_assert(ecs_lookup_child(world, Parent2, "Child") == 0);
+
+    ecs_remove_entity(world, e, ECS_CHILDOF | Parent1);
+    ecs_add_entity(world, e, ECS_CHILDOF | Parent2);
+    test_assert(ecs_lookup_child(world, Parent1, "Child") == 0);
+    test_assert(ecs_lookup_child(world, Parent2, "Child") == e);
+    test_assert(ecs_lookup(world, "Child") == 0);
+
+    ecs_remove_entity(world, e, ECS_CHILDOF | Parent2);
+    test_assert(ecs_lookup_child(world, Parent2, "Child") == 0);
+    test_assert(ecs_lookup(world, "Child") == e);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_child_after_rename() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, Parent, 0);
+
+    ecs_entity_t e = ecs_set(world, 0, EcsName, {"Foo"});
+    ecs_add_entity(world, e, ECS_CHILDOF | Parent);
+    test_assert(ecs_lookup_child(world, Parent, "Foo") == e);
+
+    ecs_set(world, e, EcsName, {"Bar"});
+    test_assert(ecs_lookup_child(world, Parent, "Foo") == 0);
+    test_assert(ecs_lookup_child(world, Parent, "Bar") == e);
+
+    EcsName *name = ecs_get_mut(world, e, EcsName, NULL);
+    name->value = "Hello";
+    test_assert(ecs_lookup_child(world, Parent, "Bar") == 0);
+    test_assert(ecs_lookup_child(world, Parent, "Hello") == e);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_child_after_delete() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, Parent, 0);
+
+    ecs_entity_t e = ecs_set(world, 0, EcsName, {"Child"});
+    ecs_add_entity(world, e, ECS_CHILDOF | Parent);
+    test_assert(ecs_lookup_child(world, Parent, "Child") == e);
+
+    ecs_delete(world, e);
+    test_assert(ecs_lookup_child(world, Parent, "Child") == 0);
+
+    ecs_entity_t e2 = ecs_set(world, 0, EcsName, {"Child"});
+    ecs_add_entity(world, e2, ECS_CHILDOF | Parent);
+    test_assert(ecs_lookup_child(world, Parent, "Child") == e2);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_many_children() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, Parent1, 0);
+    ECS_ENTITY(world, Parent2, 0);
+
+    static char names[1000][16];
+    ecs_entity_t children[1000];
+    char name[16];
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        sprintf(names[i], "Child%d", i);
+        children[i] = ecs_set(world, 0, EcsName, {names[i]});
+        ecs_add_entity(world, children[i], 
+            ECS_CHILDOF | ((i % 2) ? Parent1 : Parent2));
+    }
+
+    for (i = 0; i < 1000; i ++) {
+        sprintf(name, "Child%d", i);
+        ecs_entity_t parent = (i % 2) ? Parent1 : Parent2;
+        ecs_entity_t other = (i % 2) ? Parent2 : Parent1;
+        test_assert(ecs_lookup_child(world, parent, name) == children[i]);
+        test_assert(ecs_lookup_child(world, other, name) == 0);
+    }
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_child_w_multiple_parents() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, Parent1, 0);
+    ECS_ENTITY(world, Parent2, 0);
+
+    ecs_entity_t e = ecs_set(world, 0, EcsName, {"Child"});
+    ecs_add_entity(world, e, ECS_CHILDOF | Parent1);
+    ecs_add_entity(world, e, ECS_CHILDOF | Parent2);
+
+    test_assert(ecs_lookup_child(world, Parent1, "Child") == e);
+    test_assert(ecs_lookup_child(world, Parent2, "Child") == e);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_after_clone_delete_original() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t a = ecs_set(world, 0, EcsName, {"Foo"});
+    test_assert(ecs_lookup(world, "Foo") == a);
+
+    /* The clone gets the name through a table move */
+    ecs_entity_t b = ecs_clone(world, 0, a, true);
+    test_assert(b != 0);
+    test_assert(b != a);
+
+    ecs_delete(world, a);
+    test_assert(ecs_lookup(world, "Foo") == b);
+
+    ecs_fini(world);
+}
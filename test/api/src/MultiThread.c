@@ -876,3 +876,536 @@ void MultiThread_reactive_system() {
     ecs_fini(world);
 }
 
+
+void MultiThread_6_thread_chunk_size_1() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+
+    int i, ENTITIES = 100, THREADS = 6;
+    ecs_entity_t *handles = ecs_os_alloca(sizeof(ecs_entity_t) * ENTITIES);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_new(world, Position);
+        ecs_set(world, handles[i], Position, {0});
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_set_job_chunk_size(world, 1);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 1);
+    }
+
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 2);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_4_thread_chunk_size_w_skewed_tables() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+
+    int i, ENTITIES = 1000, TAGS = 10, THREADS = 4;
+    ecs_entity_t *handles = ecs_os_alloca(sizeof(ecs_entity_t) * ENTITIES);
+
+    /* One big table, and a number of tables with a single entity */
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_new(world, Position);
+        ecs_set(world, handles[i], Position, {0});
+        if (i < TAGS) {
+            ecs_add_entity(world, handles[i], ecs_new(world, 0));
+        }
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_set_job_chunk_size(world, 16);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 1);
+    }
+
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 2);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_3_thread_test_combs_100_entity_w_chunk_size() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, TestSubset, 0, Position);
+    ECS_SYSTEM(world, TestAll, EcsOnUpdate, Position, :TestSubset);
+
+    int i, ENTITIES = 100;
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, ENTITIES);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_set(world, ids[i], Position, {1, 2});
+    }
+
+    ecs_set_threads(world, 3);
+    ecs_set_job_chunk_size(world, 7);
+
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        const Position *p = ecs_get(world, ids[i], Position);
+        test_int(p->x, 100 - i);
+    }
+
+    ecs_fini(world);    
+}
+
+static
+void WritePosition(ecs_iter_t *it) {
+    ECS_COLUMN(it, Position, p, 1);
+
+    /* Make sure jobs take long enough to overlap with the other system */
+    ecs_os_sleep(0, 100000 * (it->frame_offset % 7));
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+static
+void ReadPosition(ecs_iter_t *it) {
+    ECS_COLUMN(it, Position, p, 1);
+    ECS_COLUMN(it, Velocity, v, 2);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        v[i].x = p[i].x;
+    }
+}
+
+void MultiThread_4_thread_dependent_systems() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, WritePosition, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, ReadPosition, EcsOnUpdate, [in] Position, [out] Velocity);
+
+    int i, ENTITIES = 100;
+    ecs_entity_t *handles = ecs_os_alloca(sizeof(ecs_entity_t) * ENTITIES);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {i, 0});
+        ecs_set(world, handles[i], Velocity, {0, 0});
+    }
+
+    ecs_set_threads(world, 4);
+    ecs_set_job_chunk_size(world, 1);
+
+    ecs_progress(world, 0);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        const Position *p = ecs_get(world, handles[i], Position);
+        const Velocity *v = ecs_get(world, handles[i], Velocity);
+        test_int(p->x, i + 2);
+        test_int(v->x, i + 2);
+    }
+
+    ecs_fini(world);
+}
+
+static int32_t independent_ran = 0;
+static bool independent_observed = false;
+
+static
+void WaitForIndependent(ecs_iter_t *it) {
+    int i;
+
+    /* Wait until the other system has ran, which can only happen if both
+     * systems are ran at the same time */
+    for (i = 0; i < 1000; i ++) {
+        if (ecs_os_ainc(&independent_ran) > 1) {
+            independent_observed = true;
+            break;
+        }
+        ecs_os_adec(&independent_ran);
+        ecs_os_sleep(0, 1000000);
+    }
+}
+
+static
+void Independent(ecs_iter_t *it) {
+    ecs_os_ainc(&independent_ran);
+}
+
+void MultiThread_2_thread_independent_systems() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, WaitForIndependent, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, Independent, EcsOnUpdate, Velocity);
+
+    ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, 0, Velocity, {0, 0});
+
+    ecs_set_threads(world, 2);
+
+    ecs_progress(world, 0);
+
+    test_bool(independent_observed, true);
+
+    ecs_fini(world);
+}
+
+static
+void test_spin_count(
+    int32_t spin_count)
+{
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+
+    int i, ENTITIES = 100, THREADS = 4, FRAMES = 50;
+    ecs_entity_t *handles = ecs_os_alloca(sizeof(ecs_entity_t) * ENTITIES);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_new(world, Position);
+        ecs_set(world, handles[i], Position, {0});
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_set_sync_spin_count(world, spin_count);
+
+    for (i = 0; i < FRAMES; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, FRAMES);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_4_thread_spin_count_0() {
+    test_spin_count(0);
+}
+
+void MultiThread_4_thread_spin_count_1000000() {
+    test_spin_count(1000000);
+}
+
+void MultiThread_2_thread_sync_wait_time() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, 0, Position, {0});
+    }
+
+    const ecs_world_info_t *stats = ecs_get_world_info(world);
+    test_assert(stats->sync_wait_time_total == 0);
+
+    ecs_set_threads(world, 2);
+    ecs_progress(world, 0);
+
+    /* Wait time is only measured when frame time is measured */
+    test_assert(stats->sync_wait_time_total == 0);
+
+    ecs_measure_frame_time(world, true);
+    ecs_progress(world, 0);
+    test_assert(stats->sync_wait_time_total > 0);
+
+    ecs_fini(world);
+}
+
+static
+void SetVelocity(ecs_iter_t *it) {
+    ECS_COLUMN_COMPONENT(it, Velocity, 2);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_entity_t e = it->entities[i];
+        ecs_set(it->world, e, Velocity, {(float)e, (float)it->world_time});
+    }
+}
+
+void MultiThread_4_thread_parallel_merge_set() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, SetVelocity, EcsOnUpdate, Position, :Velocity);
+
+    int i, ENTITIES = 1000, THREADS = 4;
+    ecs_entity_t *handles = ecs_os_alloca(sizeof(ecs_entity_t) * ENTITIES);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0});
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_set_parallel_merge(world, true);
+
+    ecs_progress(world, 1);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        const Velocity *v = ecs_get(world, handles[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, handles[i]);
+        test_int(v->y, 1);
+    }
+
+    /* Entities now already have the component */
+    ecs_progress(world, 1);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        const Velocity *v = ecs_get(world, handles[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, handles[i]);
+        test_int(v->y, 2);
+    }
+
+    ecs_fini(world);
+}
+
+static
+void SpawnVelocity(ecs_iter_t *it) {
+    ECS_COLUMN_COMPONENT(it, Velocity, 2);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_entity_t e = ecs_new(it->world, 0);
+        ecs_set(it->world, e, Velocity, {(float)it->entities[i], 1});
+    }
+}
+
+void MultiThread_4_thread_parallel_merge_new_w_set() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, SpawnVelocity, EcsOnUpdate, Position, :Velocity);
+
+    int i, ENTITIES = 1000, THREADS = 4;
+    float sum = 0;
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {0});
+        sum += (float)e;
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_set_parallel_merge(world, true);
+
+    ecs_progress(world, 1);
+
+    test_int(ecs_count(world, Velocity), ENTITIES);
+
+    ecs_query_t *q = ecs_query_new(world, "Velocity");
+    ecs_iter_t it = ecs_query_iter(q);
+    float sum_x = 0, sum_y = 0;
+    while (ecs_query_next(&it)) {
+        Velocity *v = ecs_column(&it, Velocity, 1);
+        for (i = 0; i < it.count; i ++) {
+            sum_x += v[i].x;
+            sum_y += v[i].y;
+        }
+    }
+
+    test_flt(sum_x, sum);
+    test_flt(sum_y, ENTITIES);
+
+    ecs_fini(world);
+}
+
+static
+void SetRemoveVelocity(ecs_iter_t *it) {
+    ECS_COLUMN_COMPONENT(it, Velocity, 2);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_entity_t e = it->entities[i];
+        ecs_set(it->world, e, Velocity, {1, 2});
+        if (e % 2) {
+            ecs_remove(it->world, e, Velocity);
+        } else {
+            ecs_delete(it->world, e);
+        }
+    }
+}
+
+void MultiThread_4_thread_parallel_merge_set_remove() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, SetRemoveVelocity, EcsOnUpdate, Position, :Velocity);
+
+    int i, ENTITIES = 1000, THREADS = 4;
+    ecs_entity_t *handles = ecs_os_alloca(sizeof(ecs_entity_t) * ENTITIES);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0});
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_set_parallel_merge(world, true);
+
+    ecs_progress(world, 1);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_entity_t e = handles[i];
+        if (e % 2) {
+            test_assert(ecs_is_alive(world, e));
+            test_assert(!ecs_has(world, e, Velocity));
+        } else {
+            test_assert(!ecs_is_alive(world, e));
+        }
+    }
+
+    ecs_fini(world);
+}
+
+static int32_t on_set_velocity_invoked;
+
+static
+void OnSetVelocity(ecs_iter_t *it) {
+    Velocity *v = ecs_column(it, Velocity, 1);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        test_int(v[i].x, it->entities[i]);
+        on_set_velocity_invoked ++;
+    }
+}
+
+void MultiThread_4_thread_parallel_merge_on_set() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, SetVelocity, EcsOnUpdate, Position, :Velocity);
+    ECS_SYSTEM(world, OnSetVelocity, EcsOnSet, Velocity);
+
+    int i, ENTITIES = 1000, THREADS = 4;
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_set(world, 0, Position, {0});
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_set_parallel_merge(world, true);
+
+    on_set_velocity_invoked = 0;
+    ecs_progress(world, 1);
+    test_int(on_set_velocity_invoked, ENTITIES);
+
+    ecs_progress(world, 1);
+    test_int(on_set_velocity_invoked, ENTITIES * 2);
+
+    ecs_fini(world);
+}
+
+static int32_t unaligned_jobs = 0;
+
+static
+void CheckAligned(ecs_iter_t *it) {
+    Position *p = ecs_column(it, Position, 1);
+
+    if ((uintptr_t)p % 64) {
+        ecs_os_ainc(&unaligned_jobs);
+    }
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+void MultiThread_4_thread_aligned_columns() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, CheckAligned, EcsOnUpdate, Position);
+
+    ecs_set_column_alignment(world, 64);
+
+    ecs_entity_t first = 0, last = 0;
+    int i;
+    for (i = 0; i < 1001; i ++) {
+        last = ecs_set(world, 0, Position, {0, 0});
+        if (!first) {
+            first = last;
+        }
+    }
+
+    /* Chunk size that doesn't fall on an aligned row */
+    ecs_set_threads(world, 4);
+    ecs_set_job_chunk_size(world, 13);
+    ecs_progress(world, 0);
+    ecs_progress(world, 0);
+
+    test_int(unaligned_jobs, 0);
+    test_int(ecs_get(world, first, Position)->x, 2);
+    test_int(ecs_get(world, last, Position)->x, 2);
+
+    ecs_fini(world);
+}
+
+static int32_t activated_invoked = 0;
+
+static
+void AddVelocity(ecs_iter_t *it) {
+    ECS_COLUMN_COMPONENT(it, Velocity, 2);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_add(it->world, it->entities[i], Velocity);
+    }
+}
+
+static
+void Activated(ecs_iter_t *it) {
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_os_ainc(&activated_invoked);
+    }
+}
+
+void MultiThread_2_thread_system_activated_in_frame() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, AddVelocity, EcsOnUpdate, Position, [out] :Velocity);
+    ECS_SYSTEM(world, Activated, EcsPostUpdate, Velocity);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_new(world, Position);
+    }
+
+    ecs_set_threads(world, 2);
+
+    /* Activated only matches entities after the merge of AddVelocity, so it
+     * was not part of the pipeline when jobs were prepared for the frame */
+    ecs_progress(world, 0);
+    test_int(activated_invoked, 100);
+
+    ecs_progress(world, 0);
+    test_int(activated_invoked, 200);
+
+    ecs_fini(world);
+}
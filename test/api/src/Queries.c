@@ -1146,3 +1146,48 @@ void Queries_stresstest_query_free() {
 
     ecs_fini(world);
 }
+
+void Queries_query_match_existing_w_base() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_PREFAB(world, Base, Position);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_add_entity(world, e1, ECS_INSTANCEOF | Base);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_add(world, e2, Position);
+    ecs_new(world, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "ANY:Position, Velocity");
+    test_assert(q != NULL);
+
+    int32_t count = 0;
+    ecs_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        int i;
+        for (i = 0; i < it.count; i ++) {
+            test_assert(it.entities[i] == e1 || it.entities[i] == e2);
+        }
+        count += it.count;
+    }
+
+    test_int(count, 2);
+
+    ecs_query_t *q_owned = ecs_query_new(world, "Position, Velocity");
+    test_assert(q_owned != NULL);
+
+    count = 0;
+    it = ecs_query_iter(q_owned);
+    while (ecs_query_next(&it)) {
+        test_int(it.count, 1);
+        test_assert(it.entities[0] == e2);
+        count += it.count;
+    }
+
+    test_int(count, 1);
+
+    ecs_fini(world);
+}
@@ -840,3 +840,31 @@ void Snapshot_snapshot_w_new_in_onset_in_snapshot_table() {
 
     ecs_fini(world);
 }
+
+void Snapshot_snapshot_hi_id() {
+    ecs_world_t *world = ecs_init();
+
+    /* Use up the low component id range, so Position gets a high id */
+    while (ecs_new_component_id(world) < ECS_HI_COMPONENT_ID) { }
+
+    ECS_COMPONENT(world, Position);
+    test_assert(ecs_typeid(Position) >= ECS_HI_COMPONENT_ID);
+    
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    test_assert(e != 0);
+
+    ecs_snapshot_t *s = ecs_snapshot_take(world);
+
+    Position *p = ecs_get_mut(world, e, Position, NULL);
+    p->x ++;
+    p->y ++;
+
+    ecs_snapshot_restore(world, s);
+
+    test_assert(ecs_has(world, e, Position));
+    p = ecs_get_mut(world, e, Position, NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);    
+
+    ecs_fini(world);
+}
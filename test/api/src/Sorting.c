@@ -71,10 +71,10 @@ void Sorting_sort_by_component_same_value_1() {
     
 
     test_assert(it.entities[0] == e5);
-    test_assert(it.entities[1] == e4);
-    test_assert(it.entities[2] == e3);
-    test_assert(it.entities[3] == e2);
-    test_assert(it.entities[4] == e1);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e4);
+    test_assert(it.entities[3] == e1);
+    test_assert(it.entities[4] == e2);
 
     test_assert(!ecs_query_next(&it));
 
@@ -101,9 +101,9 @@ void Sorting_sort_by_component_same_value_2() {
     test_assert(ecs_query_next(&it));
 
     test_int(it.count, 6);
-    test_assert(it.entities[0] == e4);
-    test_assert(it.entities[1] == e6);
-    test_assert(it.entities[2] == e2);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e6);
     test_assert(it.entities[3] == e1);
     test_assert(it.entities[4] == e3);
     test_assert(it.entities[5] == e5);
@@ -1129,3 +1129,985 @@ void Sorting_sort_shared_component() {
 
     ecs_fini(world);
 }
+
+static
+int32_t collect_sorted(
+    ecs_query_t *q,
+    ecs_entity_t *entities,
+    int32_t *iter_count)
+{
+    int32_t count = 0;
+    *iter_count = 0;
+
+    ecs_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            entities[count ++] = it.entities[i];
+        }
+        (*iter_count) ++;
+    }
+
+    return count;
+}
+
+void Sorting_sort_rows_by_component() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_rows(world, q, ecs_typeid(Position), compare_position);
+
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e2);
+    test_int(ecs_column(&it, Position, 1)->x, 1);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e4);
+    test_int(ecs_column(&it, Position, 1)->x, 2);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e1);
+    test_int(ecs_column(&it, Position, 1)->x, 3);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e5);
+    test_int(ecs_column(&it, Position, 1)->x, 4);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e3);
+    test_int(ecs_column(&it, Position, 1)->x, 5);
+
+    test_assert(!ecs_query_next(&it));
+
+    /* Entities are not moved */
+    ecs_query_t *q_unsorted = ecs_query_new(world, "Position");
+    it = ecs_query_iter(q_unsorted);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 5);
+    test_assert(it.entities[0] == e1);
+    test_assert(it.entities[1] == e2);
+    test_assert(it.entities[2] == e3);
+    test_assert(it.entities[3] == e4);
+    test_assert(it.entities[4] == e5);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_rows_consecutive() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_rows(world, q, ecs_typeid(Position), compare_position);
+
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_assert(it.entities[0] == e1);
+    test_assert(it.entities[1] == e2);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_assert(it.entities[0] == e4);
+    test_assert(it.entities[1] == e5);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e3);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_rows_2_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+    ecs_add(world, e3, Velocity);
+    ecs_add(world, e4, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_rows(world, q, ecs_typeid(Position), compare_position);
+
+    ecs_entity_t entities[5];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 5);
+    test_assert(entities[0] == e2);
+    test_assert(entities[1] == e4);
+    test_assert(entities[2] == e1);
+    test_assert(entities[3] == e5);
+    test_assert(entities[4] == e3);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_rows_after_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_rows(world, q, ecs_typeid(Position), compare_position);
+
+    ecs_entity_t entities[5];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 5);
+    test_assert(entities[0] == e2);
+    test_assert(entities[1] == e4);
+    test_assert(entities[2] == e1);
+    test_assert(entities[3] == e5);
+    test_assert(entities[4] == e3);
+
+    ecs_set(world, e3, Position, {0, 0});
+    ecs_set(world, e2, Position, {6, 0});
+
+    test_int(collect_sorted(q, entities, &iter_count), 5);
+    test_assert(entities[0] == e3);
+    test_assert(entities[1] == e4);
+    test_assert(entities[2] == e1);
+    test_assert(entities[3] == e5);
+    test_assert(entities[4] == e2);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_rows_after_delete() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_rows(world, q, ecs_typeid(Position), compare_position);
+
+    ecs_entity_t entities[6];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 5);
+
+    ecs_delete(world, e4);
+    ecs_entity_t e6 = ecs_set(world, 0, Position, {0, 0});
+
+    test_int(collect_sorted(q, entities, &iter_count), 5);
+    test_assert(entities[0] == e6);
+    test_assert(entities[1] == e2);
+    test_assert(entities[2] == e1);
+    test_assert(entities[3] == e5);
+    test_assert(entities[4] == e3);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_rows_shared_component() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t base_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t base_2 = ecs_set(world, 0, Position, {3, 0});
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {4, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_new_w_entity(world, ECS_INSTANCEOF | base_2);
+    ecs_entity_t e4 = ecs_new_w_entity(world, ECS_INSTANCEOF | base_1);
+
+    ecs_query_t *q = ecs_query_new(world, "ANY:Position");
+    ecs_query_order_by_rows(world, q, ecs_typeid(Position), compare_position);
+
+    ecs_entity_t entities[6];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 6);
+    test_assert(entities[0] == base_1);
+    test_assert(entities[1] == e4);
+    test_assert(entities[2] == e2);
+    test_assert(entities[3] == base_2);
+    test_assert(entities[4] == e3);
+    test_assert(entities[5] == e1);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_rows_1000_entities() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_rows(world, q, ecs_typeid(Position), compare_position);
+
+    ecs_entity_t entities[1000];
+    for (int i = 0; i < 1000; i ++) {
+        int32_t v = rand() % 100;
+        entities[i] = ecs_set(world, 0, Position, {v});
+    }
+
+    for (int i = 0; i < 100; i ++) {
+        int32_t v = rand() % 100;
+        ecs_set(world, entities[rand() % 1000], Position, {v});
+
+        int32_t count = 0, x = 0;
+        ecs_iter_t it = ecs_query_iter(q);
+        while (ecs_query_next(&it)) {
+            Position *p = ecs_column(&it, Position, 1);
+
+            int32_t j;
+            for (j = 0; j < it.count; j ++) {  
+                test_assert(x <= p[j].x);
+                x = p[j].x;
+            }
+
+            count += it.count;
+        }
+
+        test_int(count, 1000);
+    }
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_rows_after_order_by() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {2, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_rows(world, q, ecs_typeid(Position), compare_position);
+
+    ecs_entity_t entities[3];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 3);
+    test_int(iter_count, 2);
+    test_assert(entities[0] == e2);
+    test_assert(entities[1] == e3);
+    test_assert(entities[2] == e1);
+
+    ecs_query_order_by_rows(world, q, 0, compare_entity);
+
+    test_int(collect_sorted(q, entities, &iter_count), 3);
+    test_int(iter_count, 1);
+    test_assert(entities[0] == e1);
+    test_assert(entities[1] == e2);
+    test_assert(entities[2] == e3);
+
+    ecs_fini(world);
+}
+
+typedef struct Layer {
+    int32_t depth;
+    int64_t id;
+    double z;
+} Layer;
+
+void Sorting_sort_key_f32() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {-1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5.5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {-2.5, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_key(world, q, ecs_typeid(Position), 
+        EcsSortKeyF32, offsetof(Position, x));
+
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 5);
+    test_assert(it.entities[0] == e4);
+    test_assert(it.entities[1] == e2);
+    test_assert(it.entities[2] == e5);
+    test_assert(it.entities[3] == e1);
+    test_assert(it.entities[4] == e3);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_offset() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {1, 3});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {2, 1});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {3, 2});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_key(world, q, ecs_typeid(Position), 
+        EcsSortKeyF32, offsetof(Position, y));
+
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e1);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_i32() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Layer);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Layer, {.depth = 300});
+    ecs_entity_t e2 = ecs_set(world, 0, Layer, {.depth = -70000});
+    ecs_entity_t e3 = ecs_set(world, 0, Layer, {.depth = 2});
+    ecs_entity_t e4 = ecs_set(world, 0, Layer, {.depth = -1});
+
+    ecs_query_t *q = ecs_query_new(world, "Layer");
+    ecs_query_order_by_key(world, q, ecs_typeid(Layer), 
+        EcsSortKeyI32, offsetof(Layer, depth));
+
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 4);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e3);
+    test_assert(it.entities[3] == e1);
+
+    Layer *l = ecs_column(&it, Layer, 1);
+    test_int(l[0].depth, -70000);
+    test_int(l[1].depth, -1);
+    test_int(l[2].depth, 2);
+    test_int(l[3].depth, 300);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_i64() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Layer);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Layer, {.id = 1ll << 40});
+    ecs_entity_t e2 = ecs_set(world, 0, Layer, {.id = -(1ll << 40)});
+    ecs_entity_t e3 = ecs_set(world, 0, Layer, {.id = 1});
+    ecs_entity_t e4 = ecs_set(world, 0, Layer, {.id = (1ll << 40) - 1});
+
+    ecs_query_t *q = ecs_query_new(world, "Layer");
+    ecs_query_order_by_key(world, q, ecs_typeid(Layer), 
+        EcsSortKeyI64, offsetof(Layer, id));
+
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 4);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e4);
+    test_assert(it.entities[3] == e1);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_f64() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Layer);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Layer, {.z = 0.5});
+    ecs_entity_t e2 = ecs_set(world, 0, Layer, {.z = -1e10});
+    ecs_entity_t e3 = ecs_set(world, 0, Layer, {.z = 1e10});
+    ecs_entity_t e4 = ecs_set(world, 0, Layer, {.z = -0.5});
+
+    ecs_query_t *q = ecs_query_new(world, "Layer");
+    ecs_query_order_by_key(world, q, ecs_typeid(Layer), 
+        EcsSortKeyF64, offsetof(Layer, z));
+
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 4);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e1);
+    test_assert(it.entities[3] == e3);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_stable() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Layer);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Layer, {.depth = 1});
+    ecs_entity_t e2 = ecs_set(world, 0, Layer, {.depth = 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Layer, {.depth = 1});
+    ecs_entity_t e4 = ecs_set(world, 0, Layer, {.depth = 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Layer, {.depth = 1});
+
+    ecs_query_t *q = ecs_query_new(world, "Layer");
+    ecs_query_order_by_key(world, q, ecs_typeid(Layer), 
+        EcsSortKeyI32, offsetof(Layer, depth));
+
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 5);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e1);
+    test_assert(it.entities[3] == e3);
+    test_assert(it.entities[4] == e5);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_2_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+    ecs_add(world, e3, Velocity);
+    ecs_add(world, e4, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_key(world, q, ecs_typeid(Position), 
+        EcsSortKeyF32, offsetof(Position, x));
+
+    ecs_entity_t entities[5];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 5);
+    test_int(iter_count, 4);
+    test_assert(entities[0] == e2);
+    test_assert(entities[1] == e4);
+    test_assert(entities[2] == e1);
+    test_assert(entities[3] == e5);
+    test_assert(entities[4] == e3);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_shared_component() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t base_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t base_2 = ecs_set(world, 0, Position, {3, 0});
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {4, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_new_w_entity(world, ECS_INSTANCEOF | base_2);
+    ecs_entity_t e4 = ecs_new_w_entity(world, ECS_INSTANCEOF | base_1);
+
+    ecs_query_t *q = ecs_query_new(world, "ANY:Position");
+    ecs_query_order_by_key(world, q, ecs_typeid(Position), 
+        EcsSortKeyF32, offsetof(Position, x));
+
+    ecs_entity_t entities[6];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 6);
+    test_assert(entities[0] == base_1);
+    test_assert(entities[1] == e4);
+    test_assert(entities[2] == e2);
+    test_assert(entities[3] == base_2);
+    test_assert(entities[4] == e3);
+    test_assert(entities[5] == e1);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_after_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {2, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_key(world, q, ecs_typeid(Position), 
+        EcsSortKeyF32, offsetof(Position, x));
+
+    ecs_entity_t entities[3];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 3);
+    test_assert(entities[0] == e2);
+    test_assert(entities[1] == e3);
+    test_assert(entities[2] == e1);
+
+    ecs_set(world, e2, Position, {4, 0});
+
+    test_int(collect_sorted(q, entities, &iter_count), 3);
+    test_assert(entities[0] == e3);
+    test_assert(entities[1] == e1);
+    test_assert(entities[2] == e2);
+
+    test_int(ecs_get(world, e1, Position)->x, 3);
+    test_int(ecs_get(world, e2, Position)->x, 4);
+    test_int(ecs_get(world, e3, Position)->x, 2);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_rows() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {4, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_key_rows(world, q, ecs_typeid(Position), 
+        EcsSortKeyF32, offsetof(Position, x));
+
+    ecs_entity_t entities[4];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 4);
+    test_int(iter_count, 3);
+    test_assert(entities[0] == e2);
+    test_assert(entities[1] == e3);
+    test_assert(entities[2] == e1);
+    test_assert(entities[3] == e4);
+
+    /* Entities are not moved */
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e3);
+
+    ecs_set(world, e1, Position, {0, 0});
+
+    test_int(collect_sorted(q, entities, &iter_count), 4);
+    test_assert(entities[0] == e1);
+    test_assert(entities[1] == e2);
+    test_assert(entities[2] == e3);
+    test_assert(entities[3] == e4);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_1000_entities() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Layer);
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Layer");
+    ecs_query_order_by_key(world, q, ecs_typeid(Layer), 
+        EcsSortKeyI32, offsetof(Layer, depth));
+
+    ecs_entity_t entities[1000];
+    for (int i = 0; i < 1000; i ++) {
+        int32_t v = rand() % 100000 - 50000;
+        entities[i] = ecs_set(world, 0, Layer, {.depth = v, .id = v});
+        if (!(i % 3)) {
+            ecs_add(world, entities[i], Position);
+        }
+    }
+
+    for (int i = 0; i < 100; i ++) {
+        int32_t v = rand() % 100000 - 50000;
+        ecs_set(world, entities[rand() % 1000], Layer, {.depth = v, .id = v});
+
+        int32_t count = 0, depth = INT32_MIN;
+        ecs_iter_t it = ecs_query_iter(q);
+        while (ecs_query_next(&it)) {
+            Layer *l = ecs_column(&it, Layer, 1);
+
+            int32_t j;
+            for (j = 0; j < it.count; j ++) {  
+                test_assert(depth <= l[j].depth);
+                test_int(l[j].depth, l[j].id);
+                depth = l[j].depth;
+            }
+
+            count += it.count;
+        }
+
+        test_int(count, 1000);
+    }
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_after_order_by() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {2, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by_key_rows(world, q, ecs_typeid(Position), 
+        EcsSortKeyF32, offsetof(Position, x));
+
+    ecs_entity_t entities[3];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 3);
+    test_assert(entities[0] == e2);
+    test_assert(entities[1] == e3);
+    test_assert(entities[2] == e1);
+
+    ecs_query_order_by(world, q, 0, compare_entity);
+
+    test_int(collect_sorted(q, entities, &iter_count), 3);
+    test_int(iter_count, 1);
+    test_assert(entities[0] == e1);
+    test_assert(entities[1] == e2);
+    test_assert(entities[2] == e3);
+
+    ecs_fini(world);
+}
+
+/* Values are a permutation of 0..count-1, so sorted output must match index */
+static
+void test_sorted_by_x(
+    ecs_query_t *q,
+    int32_t expect_count)
+{
+    int32_t count = 0;
+    ecs_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_column(&it, Position, 1);
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            test_int(p[i].x, count);
+            count ++;
+        }
+    }
+
+    test_int(count, expect_count);
+}
+
+static
+void swap_x(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    ecs_entity_t e1,
+    ecs_entity_t e2)
+{
+    Position *p1 = ecs_get_mut_w_entity(world, e1, component, NULL);
+    Position *p2 = ecs_get_mut_w_entity(world, e2, component, NULL);
+    float x = p1->x;
+    p1->x = p2->x;
+    p2->x = x;
+    ecs_modified_w_entity(world, e1, component);
+    ecs_modified_w_entity(world, e2, component);
+}
+
+static
+void create_3_tables(
+    ecs_world_t *world,
+    ecs_entity_t *entities,
+    int32_t count)
+{
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        entities[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    /* Shuffle values, and spread entities over tables */
+    for (i = 0; i < count; i ++) {
+        swap_x(world, ecs_typeid(Position), 
+            entities[i], entities[rand() % count]);
+        if (i % 3 == 1) {
+            ecs_add(world, entities[i], Velocity);
+        } else if (i % 3 == 2) {
+            ecs_add(world, entities[i], Mass);
+        }
+    }
+}
+
+void Sorting_sort_swap_values_3_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t entities[300];
+    create_3_tables(world, entities, 300);
+    ecs_entity_t pos = ecs_lookup(world, "Position");
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    ecs_query_order_by(world, q, pos, compare_position);
+    test_sorted_by_x(q, 300);
+
+    for (int i = 0; i < 100; i ++) {
+        swap_x(world, pos, entities[rand() % 300], entities[rand() % 300]);
+        test_sorted_by_x(q, 300);
+    }
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_rows_swap_values_3_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t entities[300];
+    create_3_tables(world, entities, 300);
+    ecs_entity_t pos = ecs_lookup(world, "Position");
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    ecs_query_order_by_rows(world, q, pos, compare_position);
+    test_sorted_by_x(q, 300);
+
+    for (int i = 0; i < 100; i ++) {
+        swap_x(world, pos, entities[rand() % 300], entities[rand() % 300]);
+        test_sorted_by_x(q, 300);
+    }
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_key_swap_values_3_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t entities[300];
+    create_3_tables(world, entities, 300);
+    ecs_entity_t pos = ecs_lookup(world, "Position");
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    ecs_query_order_by_key_rows(world, q, pos, 
+        EcsSortKeyF32, offsetof(Position, x));
+    test_sorted_by_x(q, 300);
+
+    for (int i = 0; i < 100; i ++) {
+        swap_x(world, pos, entities[rand() % 300], entities[rand() % 300]);
+        test_sorted_by_x(q, 300);
+    }
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_move_entities_between_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t entities[300];
+    create_3_tables(world, entities, 300);
+    ecs_entity_t pos = ecs_lookup(world, "Position");
+    ecs_entity_t vel = ecs_lookup(world, "Velocity");
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    ecs_query_order_by(world, q, pos, compare_position);
+    test_sorted_by_x(q, 300);
+
+    for (int i = 0; i < 100; i ++) {
+        ecs_entity_t e = entities[rand() % 300];
+        if (ecs_has_entity(world, e, vel)) {
+            ecs_remove_entity(world, e, vel);
+        } else {
+            ecs_add_entity(world, e, vel);
+        }
+        test_sorted_by_x(q, 300);
+    }
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_append_to_sorted_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t entities[200];
+    for (int i = 0; i < 100; i ++) {
+        entities[i] = ecs_set(world, 0, Position, {(99 - i) * 2, 0});
+    }
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    ecs_query_order_by(world, q, ecs_typeid(Position), compare_position);
+
+    for (int i = 0; i < 100; i ++) {
+        entities[100 + i] = ecs_set(world, 0, Position, {(99 - i) * 2 + 1, 0});
+    }
+
+    test_sorted_by_x(q, 200);
+
+    /* Entities with the same value stay in the order they were added */
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {200, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {50, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {200, 0});
+
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 203);
+    test_assert(it.entities[51] == e2);
+    test_assert(it.entities[201] == e1);
+    test_assert(it.entities[202] == e3);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_rows_append_to_sorted_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 100; i ++) {
+        ecs_set(world, 0, Position, {(99 - i) * 2, 0});
+    }
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    ecs_query_order_by_rows(world, q, ecs_typeid(Position), compare_position);
+    ecs_query_iter(q);
+
+    for (int i = 0; i < 100; i ++) {
+        ecs_set(world, 0, Position, {(99 - i) * 2 + 1, 0});
+    }
+
+    test_sorted_by_x(q, 200);
+
+    ecs_fini(world);
+}
+
+static
+int32_t rank_has_component(
+    ecs_world_t *world,
+    ecs_entity_t rank_component,
+    ecs_type_t type)
+{
+    return ecs_type_has_entity(world, type, rank_component);
+}
+
+void Sorting_sort_swap_values_w_group_by() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t entities[300];
+    create_3_tables(world, entities, 300);
+    ecs_entity_t pos = ecs_lookup(world, "Position");
+    ecs_entity_t vel = ecs_lookup(world, "Velocity");
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    ecs_query_group_by(world, q, vel, rank_has_component);
+    ecs_query_order_by(world, q, pos, compare_position);
+
+    for (int i = 0; i < 100; i ++) {
+        swap_x(world, pos, entities[rand() % 300], entities[rand() % 300]);
+
+        int32_t count = 0;
+        float x = -1;
+        bool has_vel = false;
+        ecs_iter_t it = ecs_query_iter(q);
+        while (ecs_query_next(&it)) {
+            Position *p = ecs_column(&it, Position, 1);
+            bool it_has_vel = ecs_type_has_entity(world, ecs_iter_type(&it), vel);
+            test_assert(!has_vel || it_has_vel);
+            if (it_has_vel != has_vel) {
+                x = -1;
+                has_vel = it_has_vel;
+            }
+
+            for (int32_t j = 0; j < it.count; j ++) {
+                test_assert(p[j].x > x);
+                x = p[j].x;
+                count ++;
+            }
+        }
+
+        test_int(count, 300);
+    }
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_after_set_2nd_column() {
+    ecs_world_t *world = ecs_init();
+
+    /* Register Velocity first, so Position is not the first column */
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {3, 0});
+    ecs_add(world, e1, Velocity);
+    ecs_add(world, e2, Velocity);
+    ecs_add(world, e3, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    ecs_query_order_by(world, q, ecs_typeid(Position), compare_position);
+
+    ecs_entity_t entities[3];
+    int32_t iter_count;
+    test_int(collect_sorted(q, entities, &iter_count), 3);
+    test_assert(entities[0] == e1);
+    test_assert(entities[1] == e2);
+    test_assert(entities[2] == e3);
+
+    ecs_set(world, e1, Position, {4, 0});
+
+    test_int(collect_sorted(q, entities, &iter_count), 3);
+    test_assert(entities[0] == e2);
+    test_assert(entities[1] == e3);
+    test_assert(entities[2] == e1);
+
+    Position *p = ecs_get_mut(world, e3, Position, NULL);
+    p->x = 0;
+    ecs_modified(world, e3, Position);
+
+    test_int(collect_sorted(q, entities, &iter_count), 3);
+    test_assert(entities[0] == e3);
+    test_assert(entities[1] == e2);
+    test_assert(entities[2] == e1);
+
+    ecs_fini(world);
+}
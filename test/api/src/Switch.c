@@ -376,8 +376,8 @@ void Switch_query_1_case_1_type() {
     test_int(ctx.column_count, 1);
     test_null(ctx.param);
 
-    test_int(ctx.e[0], e3);
-    test_int(ctx.e[1], e1);
+    test_int(ctx.e[0], e1);
+    test_int(ctx.e[1], e3);
     test_int(ctx.c[0][0], ECS_CASE | Running);
     test_int(ctx.s[0][0], 0);
 
@@ -415,10 +415,10 @@ void Switch_query_1_case_2_types() {
     test_int(ctx.column_count, 1);
     test_null(ctx.param);
 
-    test_int(ctx.e[0], e3);
-    test_int(ctx.e[1], e1);
-    test_int(ctx.e[2], e7);
-    test_int(ctx.e[3], e5);    
+    test_int(ctx.e[0], e1);
+    test_int(ctx.e[1], e3);
+    test_int(ctx.e[2], e5);
+    test_int(ctx.e[3], e7);
     test_int(ctx.c[0][0], ECS_CASE | Running);
     test_int(ctx.s[0][0], 0);
 
@@ -468,8 +468,8 @@ void Switch_query_2_cases_1_type() {
     test_int(ctx.column_count, 2);
     test_null(ctx.param);
 
-    test_int(ctx.e[0], e4);
-    test_int(ctx.e[1], e1);
+    test_int(ctx.e[0], e1);
+    test_int(ctx.e[1], e4);
     test_int(ctx.c[0][0], ECS_CASE | Running);
     test_int(ctx.c[0][1], ECS_CASE | Front);
     test_int(ctx.s[0][0], 0);
@@ -534,8 +534,8 @@ void Switch_query_2_cases_2_types() {
     test_int(ctx.column_count, 2);
     test_null(ctx.param);
 
-    test_int(ctx.e[0], e4);
-    test_int(ctx.e[1], e1);
+    test_int(ctx.e[0], e1);
+    test_int(ctx.e[1], e4);
     test_int(ctx.e[2], e7);
     test_int(ctx.c[0][0], ECS_CASE | Running);
     test_int(ctx.c[0][1], ECS_CASE | Front);
@@ -567,25 +567,24 @@ void Switch_query_after_remove() {
     /* Verify all queries are correctly matched */
     ecs_iter_t it = ecs_query_iter(q_walking);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e2);
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e1);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e1);
+    test_int(it.entities[1], e2);
     test_assert(!ecs_query_next(&it));
 
     it = ecs_query_iter(q_running);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e5);
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e4);
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e3);    
+    test_int(it.count, 3);
+    test_int(it.entities[0], e3);
+    test_int(it.entities[1], e4);
+    test_int(it.entities[2], e5);
     test_assert(!ecs_query_next(&it));
 
     it = ecs_query_iter(q_jumping);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e7);
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e6);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e6);
+    test_int(it.entities[1], e7);
     test_assert(!ecs_query_next(&it));
 
     ecs_remove_entity(world, e4, ECS_CASE | Running);
@@ -596,24 +595,24 @@ void Switch_query_after_remove() {
     /* Verify queries are still correctly matched, now excluding e4 */
     it = ecs_query_iter(q_walking);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e2);
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e1);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e1);
+    test_int(it.entities[1], e2);
     test_assert(!ecs_query_next(&it));
 
     it = ecs_query_iter(q_running);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e5);
+    test_int(it.count, 1); test_int(it.entities[0], e3);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e3);    
+    test_int(it.count, 1); test_int(it.entities[0], e5);
     test_assert(!ecs_query_next(&it));
 
     it = ecs_query_iter(q_jumping);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e7);
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e6);
-    test_assert(!ecs_query_next(&it));    
+    test_int(it.count, 2);
+    test_int(it.entities[0], e6);
+    test_int(it.entities[1], e7);
+    test_assert(!ecs_query_next(&it));
 
     ecs_add_entity(world, e4, ECS_CASE | Running);
     test_assert(ecs_has_entity(world, e4, ECS_CASE | Running));
@@ -623,25 +622,24 @@ void Switch_query_after_remove() {
     /* Verify e4 is now matched again */
     it = ecs_query_iter(q_walking);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e2);
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e1);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e1);
+    test_int(it.entities[1], e2);
     test_assert(!ecs_query_next(&it));
 
     it = ecs_query_iter(q_running);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e4);      
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e5);
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e3);      
+    test_int(it.count, 3);
+    test_int(it.entities[0], e3);
+    test_int(it.entities[1], e4);
+    test_int(it.entities[2], e5);
     test_assert(!ecs_query_next(&it));
 
     it = ecs_query_iter(q_jumping);
     test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e7);
-    test_assert(ecs_query_next(&it));
-    test_int(it.count, 1); test_int(it.entities[0], e6);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e6);
+    test_int(it.entities[1], e7);
     test_assert(!ecs_query_next(&it));
 
     ecs_fini(world);
@@ -1038,3 +1036,145 @@ void Switch_query_recycled_tags() {
 
     ecs_fini(world);
 }
+
+void Switch_query_dense_case_batch() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Walking);
+    ECS_TAG(world, Running);
+    ECS_TYPE(world, Movement, Walking, Running);
+
+    ecs_entity_t e[64];
+    int i;
+    for (i = 0; i < 64; i ++) {
+        e[i] = ecs_new_w_entity(world, ECS_SWITCH | Movement);
+        ecs_add_entity(world, e[i], ECS_CASE | Walking);
+    }
+
+    ecs_query_t *q = ecs_query_new(world, "CASE | Walking");
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 64);
+    for (i = 0; i < 64; i ++) {
+        test_int(it.entities[i], e[i]);
+    }
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Switch_query_dense_case_runs() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Walking);
+    ECS_TAG(world, Running);
+    ECS_TYPE(world, Movement, Walking, Running);
+
+    /* Alternate cases in blocks of 4 entities */
+    ecs_entity_t e[64];
+    int i;
+    for (i = 0; i < 64; i ++) {
+        e[i] = ecs_new_w_entity(world, ECS_SWITCH | Movement);
+        if ((i / 4) % 2) {
+            ecs_add_entity(world, e[i], ECS_CASE | Running);
+        } else {
+            ecs_add_entity(world, e[i], ECS_CASE | Walking);
+        }
+    }
+
+    ecs_query_t *q = ecs_query_new(world, "CASE | Running");
+    ecs_iter_t it = ecs_query_iter(q);
+    int32_t run = 0;
+    while (ecs_query_next(&it)) {
+        test_int(it.count, 4);
+        for (i = 0; i < 4; i ++) {
+            test_int(it.entities[i], e[run * 8 + 4 + i]);
+        }
+        run ++;
+    }
+
+    test_int(run, 8);
+
+    ecs_fini(world);
+}
+
+void Switch_query_sparse_case_runs() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Walking);
+    ECS_TAG(world, Running);
+    ECS_TYPE(world, Movement, Walking, Running);
+
+    ecs_entity_t e[64];
+    int i;
+    for (i = 0; i < 64; i ++) {
+        e[i] = ecs_new_w_entity(world, ECS_SWITCH | Movement);
+        ecs_add_entity(world, e[i], ECS_CASE | Walking);
+    }
+
+    /* Few enough entities for the query to follow the case list */
+    ecs_add_entity(world, e[10], ECS_CASE | Running);
+    ecs_add_entity(world, e[11], ECS_CASE | Running);
+    ecs_add_entity(world, e[12], ECS_CASE | Running);
+    ecs_add_entity(world, e[40], ECS_CASE | Running);
+
+    ecs_query_t *q = ecs_query_new(world, "CASE | Running");
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], e[40]);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_int(it.entities[0], e[10]);
+    test_int(it.entities[1], e[11]);
+    test_int(it.entities[2], e[12]);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Switch_query_sparse_2_cases_runs() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Walking);
+    ECS_TAG(world, Running);
+    ECS_TYPE(world, Movement, Walking, Running);
+
+    ECS_TAG(world, Front);
+    ECS_TAG(world, Back);
+    ECS_TYPE(world, Direction, Front, Back);
+
+    ecs_entity_t e[64];
+    int i;
+    for (i = 0; i < 64; i ++) {
+        e[i] = ecs_new_w_entity(world, ECS_SWITCH | Movement);
+        ecs_add_entity(world, e[i], ECS_SWITCH | Direction);
+        ecs_add_entity(world, e[i], ECS_CASE | Walking);
+        ecs_add_entity(world, e[i], ECS_CASE | Front);
+    }
+
+    for (i = 20; i < 25; i ++) {
+        ecs_add_entity(world, e[i], ECS_CASE | Running);
+    }
+
+    /* Breaks up the run of Running entities */
+    ecs_add_entity(world, e[22], ECS_CASE | Back);
+
+    ecs_query_t *q = ecs_query_new(world, "CASE | Running, CASE | Front");
+    ecs_iter_t it = ecs_query_iter(q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_int(it.entities[0], e[23]);
+    test_int(it.entities[1], e[24]);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_int(it.entities[0], e[20]);
+    test_int(it.entities[1], e[21]);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
@@ -1320,3 +1320,41 @@ void System_w_FromContainer_realloc_after_match() {
 
     ecs_fini(world);
 }
+
+void System_w_FromContainer_add_component_after_match_hi_id() {
+    ecs_world_t *world = ecs_init();
+
+    /* Use up the low component id range, so components get high ids */
+    while (ecs_new_component_id(world) < ECS_HI_COMPONENT_ID) { }
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Mass);
+
+    test_assert(ecs_typeid(Position) >= ECS_HI_COMPONENT_ID);
+    test_assert(ecs_typeid(Mass) >= ECS_HI_COMPONENT_ID);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position);
+
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, PARENT:Mass, Position);
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_add_entity(world, e_1, ECS_CHILDOF | parent);
+    ecs_add_entity(world, e_2, ECS_CHILDOF | parent);
+
+    ecs_set(world, parent, Mass, {2});
+
+    Probe ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_2);
+    test_int(ctx.c[0][0], ecs_typeid(Mass));
+    test_int(ctx.s[0][0], parent);
+
+    ecs_fini(world);
+}
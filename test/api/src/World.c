@@ -990,3 +990,1353 @@ void World_get_stats() {
 
     ecs_fini(world);
 }
+
+void World_get_stats_table_edges() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_world_stats_t stats = {0};
+    ecs_get_world_stats(world, &stats);
+
+    int32_t t = stats.t;
+    float edge_count = stats.table_edge_count.avg[t];
+    float edge_memory = stats.table_edge_memory.avg[t];
+    test_assert(edge_count > 0);
+    test_assert(edge_memory > 0);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_add(world, e, Velocity);
+    ecs_remove(world, e, Position);
+
+    ecs_get_world_stats(world, &stats);
+    t = stats.t;
+
+    /* Root -> [Position] -> [Position, Velocity] -> [Velocity] adds at least
+     * one edge in each direction per traversal */
+    test_assert(stats.table_edge_count.avg[t] >= edge_count + 6);
+    test_assert(stats.table_edge_memory.avg[t] > edge_memory);
+
+    ecs_fini(world);
+}
+
+void World_get_stats_table_edges_memory() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t tags[32];
+    int i;
+    for (i = 0; i < 32; i ++) {
+        tags[i] = ecs_new_component_id(world);
+    }
+
+    ecs_world_stats_t stats = {0};
+    ecs_get_world_stats(world, &stats);
+    float edge_count = stats.table_edge_count.avg[stats.t];
+    float edge_memory = stats.table_edge_memory.avg[stats.t];
+
+    ecs_entity_t e = ecs_new(world, 0);
+    for (i = 0; i < 32; i ++) {
+        ecs_add_entity(world, e, tags[i]);
+    }
+
+    for (i = 0; i < 32; i ++) {
+        test_assert(ecs_has_entity(world, e, tags[i]));
+    }
+
+    ecs_get_world_stats(world, &stats);
+    float edge_count_delta = stats.table_edge_count.avg[stats.t] - edge_count;
+    float edge_memory_delta = stats.table_edge_memory.avg[stats.t] - edge_memory;
+    test_assert(edge_count_delta > 0);
+    test_assert(edge_memory_delta > 0);
+
+    /* Edges should only take memory for components that have been added to or
+     * removed from a table, not for the entire component id range */
+    test_assert(edge_memory_delta / edge_count_delta < 128);
+
+    ecs_fini(world);
+}
+
+static
+int32_t query_entity_count(
+    ecs_query_t *q)
+{
+    int32_t count = 0;
+    ecs_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        count += it.count;
+    }
+    return count;
+}
+
+static
+int32_t world_table_count(
+    ecs_world_t *world)
+{
+    ecs_world_stats_t stats = {0};
+    ecs_get_world_stats(world, &stats);
+    return (int32_t)stats.table_count.avg[stats.t];
+}
+
+void World_table_gc_disabled() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_add(world, e, Velocity);
+    ecs_delete(world, e);
+
+    int32_t table_count = world_table_count(world);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_progress(world, 1);
+    }
+
+    test_int(ecs_run_table_gc(world), 0);
+    test_int(world_table_count(world), table_count);
+
+    ecs_fini(world);
+}
+
+void World_table_gc_reclaim() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_table_gc(world, 2, 0);
+
+    /* Release memory of tables that were already empty */
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_delete(world, e);
+
+    int64_t free_count = ecs_os_api_free_count;
+    ecs_progress(world, 1);
+    int64_t frame_free_count = ecs_os_api_free_count - free_count;
+
+    /* Table has been empty for 2 frames, entity, record and column vectors of
+     * the table are freed */
+    free_count = ecs_os_api_free_count;
+    ecs_progress(world, 1);
+    test_int(ecs_os_api_free_count - free_count, frame_free_count + 3);
+
+    /* Memory is only released once */
+    free_count = ecs_os_api_free_count;
+    ecs_progress(world, 1);
+    test_int(ecs_os_api_free_count - free_count, frame_free_count);
+
+    /* Table can be used after memory has been released */
+    e = ecs_set(world, 0, Position, {30, 40});
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void World_table_gc_delete() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+
+    /* Delete tables that were already empty */
+    ecs_set_table_gc(world, 0, 3);
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+
+    int32_t table_count = world_table_count(world);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_add(world, e, Velocity);
+    test_int(query_entity_count(q), 1);
+    test_int(world_table_count(world), table_count + 2);
+
+    ecs_delete(world, e);
+
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+    test_int(world_table_count(world), table_count + 2);
+
+    /* [Position] and [Position, Velocity] have been empty for 3 frames */
+    ecs_progress(world, 1);
+    test_int(world_table_count(world), table_count);
+    test_int(query_entity_count(q), 0);
+
+    /* Tables are recreated when they are needed again */
+    e = ecs_new(world, Position);
+    ecs_add(world, e, Velocity);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+    test_int(world_table_count(world), table_count + 2);
+    test_int(query_entity_count(q), 1);
+
+    ecs_remove(world, e, Velocity);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+    test_int(query_entity_count(q), 1);
+
+    ecs_fini(world);
+}
+
+void World_table_gc_delete_non_empty() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_table_gc(world, 0, 2);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_delete(world, e);
+
+    ecs_progress(world, 1);
+
+    /* Table is no longer empty, and should not be deleted */
+    e = ecs_set(world, 0, Position, {10, 20});
+    
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+    test_int(ecs_run_table_gc(world), 0);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void World_table_gc_recreate_same_type() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_add(world, e, Velocity);
+    ecs_type_t type = ecs_get_type(world, e);
+    test_assert(type != NULL);
+    ecs_delete(world, e);
+
+    ecs_set_table_gc(world, 0, 1);
+    ecs_progress(world, 1);
+
+    e = ecs_new(world, Position);
+    ecs_add(world, e, Velocity);
+    test_assert(ecs_get_type(world, e) == type);
+
+    ecs_fini(world);
+}
+
+void World_table_gc_w_snapshot() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_set_table_gc(world, 0, 1);
+
+    ecs_snapshot_t *s = ecs_snapshot_take(world);
+    ecs_delete(world, e);
+    
+    ecs_progress(world, 1);
+    test_int(ecs_run_table_gc(world), 0);
+
+    ecs_snapshot_restore(world, s);
+    test_assert(ecs_has(world, e, Position));
+
+    s = ecs_snapshot_take(world);
+    ecs_delete(world, e);
+    ecs_progress(world, 1);
+    test_int(ecs_run_table_gc(world), 0);
+
+    ecs_snapshot_free(s);
+    test_assert(ecs_run_table_gc(world) != 0);
+
+    ecs_fini(world);
+}
+
+void World_table_gc_child_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t child_1 = ecs_new_w_entity(world, ECS_CHILDOF | parent);
+    ecs_add(world, child_1, Position);
+    ecs_entity_t child_2 = ecs_new_w_entity(world, ECS_CHILDOF | parent);
+
+    ecs_set_table_gc(world, 0, 1);
+    ecs_delete(world, child_1);
+    ecs_progress(world, 1);
+
+    test_assert(ecs_is_alive(world, child_2));
+    test_int(ecs_get_child_count(world, parent), 1);
+
+    ecs_delete(world, parent);
+    test_assert(!ecs_is_alive(world, child_2));
+
+    ecs_fini(world);
+}
+
+static
+bool is_aligned(
+    const void *ptr,
+    uintptr_t alignment)
+{
+    return !((uintptr_t)ptr % alignment);
+}
+
+void World_column_alignment_new_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_column_alignment(world, 64);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_assert(is_aligned(p, 64));
+
+    /* Alignment is preserved when the column grows */
+    ecs_bulk_new(world, Position, 1000);
+    p = ecs_get(world, e, Position);
+    test_assert(is_aligned(p, 64));
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void World_column_alignment_existing_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t entities[100];
+    int i;
+    for (i = 0; i < 100; i ++) {
+        entities[i] = ecs_set(world, 0, Position, {i, i * 2});
+        ecs_set(world, entities[i], Velocity, {i * 3, i * 4});
+    }
+
+    ecs_set_column_alignment(world, 256);
+
+    const Position *p = ecs_get(world, entities[0], Position);
+    const Velocity *v = ecs_get(world, entities[0], Velocity);
+    test_assert(is_aligned(p, 256));
+    test_assert(is_aligned(v, 256));
+
+    for (i = 0; i < 100; i ++) {
+        p = ecs_get(world, entities[i], Position);
+        v = ecs_get(world, entities[i], Velocity);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+        test_int(v->x, i * 3);
+        test_int(v->y, i * 4);
+    }
+
+    /* Reset to natural alignment */
+    ecs_set_column_alignment(world, 0);
+
+    for (i = 0; i < 100; i ++) {
+        p = ecs_get(world, entities[i], Position);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    /* Entities can still be moved between tables */
+    ecs_remove(world, entities[0], Velocity);
+    p = ecs_get(world, entities[0], Position);
+    test_int(p->x, 0);
+    test_int(p->y, 0);
+
+    ecs_fini(world);
+}
+
+void World_column_alignment_worker_slices() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_column_alignment(world, 64);
+    ecs_bulk_new(world, Position, 1001);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+
+    /* Position is 8 bytes, so every slice except the last should be a
+     * multiple of 8 rows */
+    int32_t current, total = 0;
+    for (current = 0; current < 3; current ++) {
+        ecs_iter_t it = ecs_query_iter(q);
+        while (ecs_query_next_worker(&it, current, 3)) {
+            Position *p = ecs_column(&it, Position, 1);
+            test_assert(is_aligned(p, 64));
+            if (it.offset + it.count != 1001) {
+                test_int(it.count % 8, 0);
+            }
+            total += it.count;
+        }
+    }
+
+    test_int(total, 1001);
+
+    ecs_fini(world);
+}
+
+typedef struct test_allocator_t {
+    int32_t malloc_count;
+    int32_t realloc_count;
+    int32_t free_count;
+} test_allocator_t;
+
+static
+void* pool_malloc(
+    void *ctx,
+    ecs_size_t size)
+{
+    test_allocator_t *a = ctx;
+    a->malloc_count ++;
+    return ecs_os_malloc(size);
+}
+
+static
+void* pool_realloc(
+    void *ctx,
+    void *ptr,
+    ecs_size_t size)
+{
+    test_allocator_t *a = ctx;
+    a->realloc_count ++;
+    return ecs_os_realloc(ptr, size);
+}
+
+static
+void pool_free(
+    void *ctx,
+    void *ptr)
+{
+    test_allocator_t *a = ctx;
+    a->free_count ++;
+    ecs_os_free(ptr);
+}
+
+void World_pool_stats() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_pool_stats_t before, after;
+    ecs_get_pool_stats(world, EcsPoolColumns, &before);
+
+    ecs_bulk_new(world, Position, 1000);
+
+    ecs_get_pool_stats(world, EcsPoolColumns, &after);
+    test_assert(after.malloc_count > before.malloc_count);
+    test_assert(after.bytes_allocated >= 
+        before.bytes_allocated + 1000 * ECS_SIZEOF(Position));
+
+    ecs_get_pool_stats(world, EcsPoolTypes, &before);
+    ecs_new(world, Velocity);
+    ecs_get_pool_stats(world, EcsPoolTypes, &after);
+    test_int(after.malloc_count, before.malloc_count + 1);
+
+    ecs_fini(world);
+}
+
+void World_pool_custom_allocator() {
+    test_allocator_t ctx = {0};
+    ecs_allocator_t allocator = {
+        .malloc_ = pool_malloc,
+        .realloc_ = pool_realloc,
+        .free_ = pool_free,
+        .ctx = &ctx
+    };
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_allocator(world, EcsPoolColumns, &allocator);
+
+    ecs_pool_stats_t before, after;
+    ecs_get_pool_stats(world, EcsPoolColumns, &before);
+
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_get_pool_stats(world, EcsPoolColumns, &after);
+
+    test_assert(ctx.malloc_count != 0);
+    test_assert(ctx.realloc_count != 0);
+    test_int(after.malloc_count - before.malloc_count, ctx.malloc_count);
+    test_int(after.realloc_count - before.realloc_count, ctx.realloc_count);
+
+    ecs_fini(world);
+
+    /* Everything allocated by the allocator is freed with the allocator */
+    test_int(ctx.free_count, ctx.malloc_count);
+}
+
+void World_pool_set_allocator_w_existing_data() {
+    test_allocator_t ctx_1 = {0}, ctx_2 = {0};
+    ecs_allocator_t allocator_1 = {
+        .malloc_ = pool_malloc,
+        .realloc_ = pool_realloc,
+        .free_ = pool_free,
+        .ctx = &ctx_1
+    };
+    ecs_allocator_t allocator_2 = allocator_1;
+    allocator_2.ctx = &ctx_2;
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_allocator(world, EcsPoolColumns, &allocator_1);
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    test_assert(ctx_1.malloc_count != 0);
+
+    /* Storage of existing table stays with the first allocator */
+    ecs_set_allocator(world, EcsPoolColumns, &allocator_2);
+    int32_t malloc_count = ctx_1.malloc_count;
+    ecs_bulk_new(world, Position, 100);
+    test_assert(ctx_1.realloc_count != 0);
+    test_int(ctx_1.malloc_count, malloc_count);
+
+    /* New tables use the second allocator */
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {1, 2});
+    test_assert(ctx_2.malloc_count != 0);
+
+    /* Moving an entity moves the storage between allocators */
+    ecs_add(world, e1, Velocity);
+    ecs_add(world, e2, Position);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    /* Restore default allocator */
+    ecs_set_allocator(world, EcsPoolColumns, NULL);
+    malloc_count = ctx_2.malloc_count;
+    ecs_entity_t e3 = ecs_new(world, 0);
+    ecs_add(world, e3, Velocity);
+    ecs_add(world, e3, Position);
+    ecs_add(world, e3, EcsName);
+    test_int(ctx_2.malloc_count, malloc_count);
+
+    ecs_fini(world);
+
+    test_int(ctx_1.free_count, ctx_1.malloc_count);
+    test_int(ctx_2.free_count, ctx_2.malloc_count);
+}
+
+void World_cold_part_add_remove() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_set_component_cold(world, Position, Velocity);
+
+    ecs_entity_t e = ecs_new(world, Mass);
+    ecs_set(world, e, Position, {10, 20});
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+    test_assert(ecs_has(world, e, Mass));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    /* The cold part can't be removed by itself */
+    ecs_set(world, e, Velocity, {1, 2});
+    ecs_remove(world, e, Velocity);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+
+    const Velocity *v = ecs_get(world, e, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_remove(world, e, Position);
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+    test_assert(ecs_has(world, e, Mass));
+
+    /* The cold part can be used without the hot part */
+    ecs_add(world, e, Velocity);
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+
+    ecs_add(world, e, Position);
+    ecs_remove(world, e, Velocity);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+
+    ecs_fini(world);
+}
+
+void World_cold_part_bulk_new() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_set_component_cold(world, Position, Velocity);
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 10);
+    test_assert(ids != NULL);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        test_assert(ecs_has(world, ids[i], Position));
+        test_assert(ecs_has(world, ids[i], Velocity));
+    }
+
+    /* Data is matched with the component ids, not with the table columns */
+    Mass m[3] = {1, 2, 3};
+    Position p[3] = {{10, 20}, {30, 40}, {50, 60}};
+    ids = ecs_bulk_new_w_data(world, 3, &(ecs_entities_t){
+        .array = (ecs_entity_t[]){ecs_typeid(Position), ecs_typeid(Mass)},
+        .count = 2
+    }, (void*[]){p, m});
+    test_assert(ids != NULL);
+
+    for (i = 0; i < 3; i ++) {
+        test_assert(ecs_has(world, ids[i], Velocity));
+
+        const Position *ptr = ecs_get(world, ids[i], Position);
+        test_assert(ptr != NULL);
+        test_int(ptr->x, p[i].x);
+        test_int(ptr->y, p[i].y);
+
+        const Mass *m_ptr = ecs_get(world, ids[i], Mass);
+        test_assert(m_ptr != NULL);
+        test_int(*m_ptr, m[i]);
+    }
+
+    ecs_fini(world);
+}
+
+static
+void HotPart(ecs_iter_t *it) {
+    Position *p = ecs_column(it, Position, 1);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+static
+void HotColdPart(ecs_iter_t *it) {
+    Position *p = ecs_column(it, Position, 1);
+    Velocity *v = ecs_column(it, Velocity, 2);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].y += v[i].y;
+    }
+}
+
+void World_cold_part_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_component_cold(world, Position, Velocity);
+
+    ECS_SYSTEM(world, HotPart, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, HotColdPart, EcsOnUpdate, Position, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_set(world, e2, Velocity, {3, 4});
+
+    /* Hot fields are stored in a separate array from the cold fields */
+    const Position *p1 = ecs_get(world, e1, Position);
+    const Position *p2 = ecs_get(world, e2, Position);
+    test_assert(p2 == &p1[1]);
+
+    ecs_progress(world, 1);
+
+    p1 = ecs_get(world, e1, Position);
+    test_int(p1->x, 11);
+    test_int(p1->y, 22);
+
+    p2 = ecs_get(world, e2, Position);
+    test_int(p2->x, 31);
+    test_int(p2->y, 44);
+
+    ecs_fini(world);
+}
+
+void World_cold_part_after_new() {
+    install_test_abort();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_new(world, Position);
+
+    test_expect_abort();
+
+    ecs_set_component_cold(world, Position, Velocity);
+}
+
+void World_cold_part_deferred() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_component_cold(world, Position, Velocity);
+
+    ecs_entity_t e = ecs_new(world, 0);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_defer_begin(world);
+    ecs_remove(world, e, Velocity);
+    ecs_remove(world, e, Position);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+
+    ecs_fini(world);
+}
+
+static int32_t on_add_hot_invoked;
+
+static
+void OnAddHot(ecs_iter_t *it) {
+    on_add_hot_invoked += it->count;
+}
+
+#define COLD_PART_COUNT (20)
+
+void World_cold_part_deferred_many() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_component_cold(world, Position, Velocity);
+    ECS_TRIGGER(world, OnAddHot, EcsOnAdd, Position);
+
+    ecs_entity_t hot[COLD_PART_COUNT], cold[COLD_PART_COUNT];
+    int32_t i;
+    for (i = 0; i < COLD_PART_COUNT; i ++) {
+        hot[i] = ecs_new_component(world, 0, NULL, 
+            sizeof(int32_t), ECS_ALIGNOF(int32_t));
+        cold[i] = ecs_new_component(world, 0, NULL, 
+            sizeof(int32_t), ECS_ALIGNOF(int32_t));
+        ecs_set_component_cold_w_entity(world, hot[i], cold[i]);
+    }
+
+    on_add_hot_invoked = 0;
+
+    /* Each set adds two ids, which doesn't fit in a single batch */
+    ecs_entity_t e = ecs_new(world, 0);
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    for (i = 0; i < COLD_PART_COUNT; i ++) {
+        ecs_set_ptr_w_entity(world, e, hot[i], sizeof(int32_t), &i);
+    }
+    ecs_defer_end(world);
+
+    test_int(on_add_hot_invoked, 1);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+
+    for (i = 0; i < COLD_PART_COUNT; i ++) {
+        test_assert(ecs_has_entity(world, e, cold[i]));
+        const int32_t *ptr = ecs_get_w_entity(world, e, hot[i]);
+        test_assert(ptr != NULL);
+        test_int(*ptr, i);
+    }
+
+    ecs_defer_begin(world);
+    for (i = 0; i < COLD_PART_COUNT; i ++) {
+        ecs_remove_entity(world, e, hot[i]);
+    }
+    ecs_remove(world, e, Position);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+    for (i = 0; i < COLD_PART_COUNT; i ++) {
+        test_assert(!ecs_has_entity(world, e, hot[i]));
+        test_assert(!ecs_has_entity(world, e, cold[i]));
+    }
+
+    ecs_fini(world);
+}
+
+/* Largest type with cold parts that can be added with a single operation */
+#define COLD_TYPE_COUNT (15)
+
+void World_cold_part_deferred_add_type() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t hot[COLD_TYPE_COUNT], cold[COLD_TYPE_COUNT];
+    ecs_type_t type = NULL;
+    int32_t i;
+    for (i = 0; i < COLD_TYPE_COUNT; i ++) {
+        hot[i] = ecs_new_component(world, 0, NULL, 
+            sizeof(int32_t), ECS_ALIGNOF(int32_t));
+        cold[i] = ecs_new_component(world, 0, NULL, 
+            sizeof(int32_t), ECS_ALIGNOF(int32_t));
+        ecs_set_component_cold_w_entity(world, hot[i], cold[i]);
+        type = ecs_type_add(world, type, hot[i]);
+    }
+
+    /* The type contains the cold parts, which are also counted for their hot
+     * components. A single add doesn't fit in a batch. */
+    ecs_entity_t e = ecs_new(world, 0);
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_add_type(world, e, type);
+    ecs_defer_end(world);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    for (i = 0; i < COLD_TYPE_COUNT; i ++) {
+        test_assert(ecs_has_entity(world, e, hot[i]));
+        test_assert(ecs_has_entity(world, e, cold[i]));
+    }
+
+    ecs_defer_begin(world);
+    ecs_remove_type(world, e, type);
+    ecs_remove(world, e, Position);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_has(world, e, Position));
+
+    for (i = 0; i < COLD_TYPE_COUNT; i ++) {
+        test_assert(!ecs_has_entity(world, e, hot[i]));
+        test_assert(!ecs_has_entity(world, e, cold[i]));
+    }
+
+    ecs_fini(world);
+}
+
+static
+int32_t query_range_count(
+    ecs_query_t *q)
+{
+    int32_t count = 0;
+    ecs_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        count ++;
+    }
+    return count;
+}
+
+void World_table_chunk_new() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+
+    ecs_set_table_chunk_size(world, 4);
+
+    ecs_entity_t e[10];
+    int i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    /* Entities are returned in chunks of at most 4 */
+    int32_t count = 0, ranges = 0;
+    ecs_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_column(&it, Position, 1);
+        test_assert(it.count <= 4);
+        for (i = 0; i < it.count; i ++) {
+            test_assert(it.entities[i] == e[count + i]);
+            test_int(p[i].x, count + i);
+            test_int(p[i].y, (count + i) * 2);
+        }
+        count += it.count;
+        ranges ++;
+    }
+
+    test_int(count, 10);
+    test_int(ranges, 3);
+
+    /* The first chunk is found by type */
+    ecs_table_t *table = ecs_table_from_type(world, ecs_type(Position));
+    test_int(ecs_table_count(table), 4);
+    test_assert(ecs_get_type(world, e[9]) == ecs_get_type(world, e[0]));
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_stable_ptr() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_table_chunk_size(world, 16);
+
+    ecs_entity_t e[17];
+    int i;
+    for (i = 0; i < 17; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    /* Neither the full first chunk nor the new chunk grow */
+    const Position *p_first = ecs_get(world, e[0], Position);
+    const Position *p_last = ecs_get(world, e[16], Position);
+
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    test_assert(ecs_get(world, e[0], Position) == p_first);
+    test_assert(ecs_get(world, e[16], Position) == p_last);
+    test_int(p_first->x, 0);
+    test_int(p_last->x, 16);
+    test_int(p_last->y, 32);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_bulk_new() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+
+    ecs_set_table_chunk_size(world, 4);
+
+    /* Bulk data that does not fit in a chunk is not split up */
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 10);
+    test_assert(ids != NULL);
+    test_int(query_entity_count(q), 10);
+    test_int(query_range_count(q), 1);
+
+    ids = ecs_bulk_new(world, Position, 3);
+    test_assert(ids != NULL);
+    test_int(query_entity_count(q), 13);
+    test_int(query_range_count(q), 2);
+
+    ids = ecs_bulk_new(world, Position, 3);
+    test_assert(ids != NULL);
+    test_int(query_entity_count(q), 16);
+    test_int(query_range_count(q), 3);
+
+    int i;
+    for (i = 0; i < 3; i ++) {
+        test_assert(ecs_has(world, ids[i], Position));
+    }
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_add_remove() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_table_chunk_size(world, 2);
+
+    ecs_entity_t e[5];
+    int i;
+    for (i = 0; i < 5; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    /* Adding a component an entity already has doesn't move it */
+    const Position *p = ecs_get(world, e[4], Position);
+    ecs_add(world, e[4], Position);
+    test_assert(ecs_get(world, e[4], Position) == p);
+
+    for (i = 0; i < 5; i ++) {
+        ecs_set(world, e[i], Velocity, {i, i});
+    }
+
+    for (i = 0; i < 5; i ++) {
+        ecs_remove(world, e[i], Velocity);
+    }
+
+    ecs_type_t type = ecs_get_type(world, e[0]);
+    for (i = 0; i < 5; i ++) {
+        test_assert(ecs_get_type(world, e[i]) == type);
+        p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_delete_reuse() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+
+    ecs_set_table_chunk_size(world, 4);
+
+    ecs_entity_t e[8];
+    int i;
+    for (i = 0; i < 8; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    int32_t table_count = world_table_count(world);
+    test_int(query_range_count(q), 2);
+
+    /* New entities fill up chunks before a chunk is created */
+    ecs_delete(world, e[0]);
+    ecs_delete(world, e[5]);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    test_int(world_table_count(world), table_count);
+    test_int(query_entity_count(q), 8);
+    test_int(query_range_count(q), 2);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    p = ecs_get(world, e2, Position);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_clone() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+
+    ecs_set_table_chunk_size(world, 2);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, 0, Position, {30, 40});
+
+    ecs_entity_t clone = ecs_clone(world, 0, e, true);
+    test_int(query_entity_count(q), 3);
+    test_int(query_range_count(q), 2);
+
+    const Position *p = ecs_get(world, clone, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_deferred() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "Position, Velocity");
+
+    ecs_set_table_chunk_size(world, 4);
+
+    ecs_entity_t e[10];
+    int i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    /* Entities that move from the same chunk are moved together */
+    ecs_defer_begin(world);
+    for (i = 0; i < 10; i ++) {
+        ecs_set(world, e[i], Velocity, {i, i});
+    }
+    ecs_defer_end(world);
+
+    test_int(query_entity_count(q), 10);
+    test_int(query_range_count(q), 3);
+
+    for (i = 0; i < 10; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+        const Velocity *v = ecs_get(world, e[i], Velocity);
+        test_int(v->x, i);
+        test_int(v->y, i);
+    }
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_bulk_add() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "Position, Velocity");
+
+    ecs_set_table_chunk_size(world, 4);
+
+    ecs_entity_t e[6];
+    int i;
+    for (i = 0; i < 6; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_bulk_add_entity(world, ecs_typeid(Velocity), &(ecs_filter_t){
+        .include = ecs_type(Position)
+    });
+
+    test_int(query_entity_count(q), 6);
+    test_int(query_range_count(q), 2);
+
+    for (i = 0; i < 6; i ++) {
+        test_assert(ecs_has(world, e[i], Velocity));
+        const Position *p = ecs_get(world, e[i], Position);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_gc() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+
+    ecs_set_table_gc(world, 0, 1);
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+
+    int32_t table_count = world_table_count(world);
+
+    ecs_set_table_chunk_size(world, 2);
+
+    ecs_entity_t e[5];
+    int i;
+    for (i = 0; i < 5; i ++) {
+        e[i] = ecs_new(world, Position);
+    }
+
+    ecs_type_t type = ecs_get_type(world, e[0]);
+    test_int(world_table_count(world), table_count + 3);
+
+    for (i = 0; i < 5; i ++) {
+        ecs_delete(world, e[i]);
+    }
+
+    /* Chunks are deleted before the first chunk */
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+    test_int(world_table_count(world), table_count);
+    test_int(query_entity_count(q), 0);
+
+    ecs_entity_t ent = ecs_set(world, 0, Position, {10, 20});
+    test_assert(ecs_get_type(world, ent) == type);
+    test_int(query_entity_count(q), 1);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_reclaim() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_table_gc(world, 1, 0);
+    ecs_set_table_chunk_size(world, 2);
+
+    ecs_entity_t e[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_new(world, Position);
+    }
+
+    ecs_delete(world, e[2]);
+    ecs_delete(world, e[3]);
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+
+    /* A chunk with reclaimed columns is allocated once when it is reused */
+    e[2] = ecs_set(world, 0, Position, {10, 20});
+    const Position *p = ecs_get(world, e[2], Position);
+    e[3] = ecs_set(world, 0, Position, {30, 40});
+    test_assert(ecs_get(world, e[2], Position) == p);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_delete_children() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_table_chunk_size(world, 2);
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t e[5];
+    int i;
+    for (i = 0; i < 5; i ++) {
+        e[i] = ecs_new_w_entity(world, ECS_CHILDOF | parent);
+        ecs_set(world, e[i], Position, {i, i * 2});
+    }
+
+    test_int(ecs_get_child_count(world, parent), 5);
+
+    ecs_delete(world, parent);
+
+    for (i = 0; i < 5; i ++) {
+        test_assert(!ecs_is_alive(world, e[i]));
+    }
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_delete_reuse_many() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+
+    ecs_set_table_chunk_size(world, 2);
+
+    ecs_entity_t e[10];
+    int i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    int32_t table_count = world_table_count(world);
+    test_int(query_range_count(q), 5);
+
+    /* Chunks that had entities removed are filled before a chunk is created,
+     * including the first chunk */
+    ecs_delete(world, e[0]);
+    ecs_delete(world, e[5]);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    test_int(world_table_count(world), table_count);
+    test_int(query_entity_count(q), 10);
+
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {50, 60});
+    test_int(world_table_count(world), table_count + 1);
+    test_int(query_entity_count(q), 11);
+    test_int(query_range_count(q), 6);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    p = ecs_get(world, e2, Position);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+    p = ecs_get(world, e3, Position);
+    test_int(p->x, 50);
+    test_int(p->y, 60);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_move_to_chunk() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_table_chunk_size(world, 2);
+
+    ecs_entity_t e[5];
+    int i;
+    for (i = 0; i < 5; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    /* Entities move along the same edge into different chunks */
+    for (i = 0; i < 5; i ++) {
+        ecs_set(world, e[i], Velocity, {i * 3, i * 4});
+    }
+
+    for (i = 0; i < 5; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+
+        const Velocity *v = ecs_get(world, e[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i * 3);
+        test_int(v->y, i * 4);
+    }
+
+    for (i = 0; i < 5; i ++) {
+        ecs_remove(world, e[i], Velocity);
+    }
+
+    for (i = 0; i < 5; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+        test_assert(!ecs_has(world, e[i], Velocity));
+    }
+
+    ecs_fini(world);
+}
@@ -96,6 +96,7 @@ void Add_remove_0_entity(void);
 void Add_add_w_xor(void);
 void Add_add_same_w_xor(void);
 void Add_add_after_remove_xor(void);
+void Add_add_remove_tag_w_many_components(void);
 
 // Testsuite 'Switch'
 void Switch_setup(void);
@@ -131,6 +132,10 @@ void Switch_add_trait_to_entity_w_switch(void);
 void Switch_sort(void);
 void Switch_recycled_tags(void);
 void Switch_query_recycled_tags(void);
+void Switch_query_dense_case_batch(void);
+void Switch_query_dense_case_runs(void);
+void Switch_query_sparse_case_runs(void);
+void Switch_query_sparse_2_cases_runs(void);
 
 // Testsuite 'EnabledComponents'
 void EnabledComponents_is_component_enabled(void);
@@ -170,6 +175,9 @@ void EnabledComponents_query_randomized_3_bitsets(void);
 void EnabledComponents_query_randomized_4_bitsets(void);
 void EnabledComponents_defer_enable(void);
 void EnabledComponents_sort(void);
+void EnabledComponents_query_randomized_5_bitsets(void);
+void EnabledComponents_query_long_run(void);
+void EnabledComponents_query_2_tables(void);
 
 // Testsuite 'Remove'
 void Remove_zero(void);
@@ -449,6 +457,12 @@ void Lookup_define_duplicate_alias(void);
 void Lookup_define_alias_in_scope(void);
 void Lookup_lookup_null(void);
 void Lookup_lookup_symbol_null(void);
+void Lookup_lookup_child_after_reparent(void);
+void Lookup_lookup_child_after_rename(void);
+void Lookup_lookup_child_after_delete(void);
+void Lookup_lookup_many_children(void);
+void Lookup_lookup_child_w_multiple_parents(void);
+void Lookup_lookup_after_clone_delete_original(void);
 
 // Testsuite 'Singleton'
 void Singleton_set(void);
@@ -521,6 +535,13 @@ void ComponentLifecycle_prevent_lifecycle_overwrite(void);
 void ComponentLifecycle_prevent_lifecycle_overwrite_null_callbacks(void);
 void ComponentLifecycle_allow_lifecycle_overwrite_equal_callbacks(void);
 void ComponentLifecycle_set_lifecycle_after_trigger(void);
+void ComponentLifecycle_merge_batch_to_different_table(void);
+void ComponentLifecycle_ctor_on_add_hi_id(void);
+void ComponentLifecycle_move_on_add_remove_cached_edge(void);
+void ComponentLifecycle_relocatable_no_move(void);
+void ComponentLifecycle_relocatable_merge(void);
+void ComponentLifecycle_ctor_on_add_hi_entity_range(void);
+void ComponentLifecycle_relocatable_deferred_move(void);
 
 // Testsuite 'Pipeline'
 void Pipeline_setup(void);
@@ -648,6 +669,34 @@ void Sorting_sort_1000_entities_2_types(void);
 void Sorting_sort_1000_entities_2_types_again(void);
 void Sorting_sort_1000_entities_add_type_after_sort(void);
 void Sorting_sort_shared_component(void);
+void Sorting_sort_rows_by_component(void);
+void Sorting_sort_rows_consecutive(void);
+void Sorting_sort_rows_2_tables(void);
+void Sorting_sort_rows_after_set(void);
+void Sorting_sort_rows_after_delete(void);
+void Sorting_sort_rows_shared_component(void);
+void Sorting_sort_rows_1000_entities(void);
+void Sorting_sort_rows_after_order_by(void);
+void Sorting_sort_key_f32(void);
+void Sorting_sort_key_offset(void);
+void Sorting_sort_key_i32(void);
+void Sorting_sort_key_i64(void);
+void Sorting_sort_key_f64(void);
+void Sorting_sort_key_stable(void);
+void Sorting_sort_key_2_tables(void);
+void Sorting_sort_key_shared_component(void);
+void Sorting_sort_key_after_set(void);
+void Sorting_sort_key_rows(void);
+void Sorting_sort_key_1000_entities(void);
+void Sorting_sort_key_after_order_by(void);
+void Sorting_sort_swap_values_3_tables(void);
+void Sorting_sort_rows_swap_values_3_tables(void);
+void Sorting_sort_key_swap_values_3_tables(void);
+void Sorting_sort_move_entities_between_tables(void);
+void Sorting_sort_append_to_sorted_table(void);
+void Sorting_sort_rows_append_to_sorted_table(void);
+void Sorting_sort_swap_values_w_group_by(void);
+void Sorting_sort_after_set_2nd_column(void);
 
 // Testsuite 'Queries'
 void Queries_query_changed_after_new(void);
@@ -681,6 +730,7 @@ void Queries_orphaned_query(void);
 void Queries_nested_orphaned_query(void);
 void Queries_invalid_access_orphaned_query(void);
 void Queries_stresstest_query_free(void);
+void Queries_query_match_existing_w_base(void);
 
 // Testsuite 'Traits'
 void Traits_type_w_one_trait(void);
@@ -1028,6 +1078,7 @@ void System_w_FromContainer_add_component_after_match_and_rematch_w_entity_type_
 void System_w_FromContainer_adopt_after_match(void);
 void System_w_FromContainer_new_child_after_match(void);
 void System_w_FromContainer_realloc_after_match(void);
+void System_w_FromContainer_add_component_after_match_hi_id(void);
 
 // Testsuite 'System_w_FromId'
 void System_w_FromId_2_column_1_from_id(void);
@@ -1078,6 +1129,41 @@ void World_no_threading(void);
 void World_no_time(void);
 void World_is_entity_enabled(void);
 void World_get_stats(void);
+void World_get_stats_table_edges(void);
+void World_get_stats_table_edges_memory(void);
+void World_table_gc_disabled(void);
+void World_table_gc_reclaim(void);
+void World_table_gc_delete(void);
+void World_table_gc_delete_non_empty(void);
+void World_table_gc_recreate_same_type(void);
+void World_table_gc_w_snapshot(void);
+void World_table_gc_child_table(void);
+void World_column_alignment_new_table(void);
+void World_column_alignment_existing_table(void);
+void World_column_alignment_worker_slices(void);
+void World_pool_stats(void);
+void World_pool_custom_allocator(void);
+void World_pool_set_allocator_w_existing_data(void);
+void World_cold_part_add_remove(void);
+void World_cold_part_bulk_new(void);
+void World_cold_part_system(void);
+void World_cold_part_after_new(void);
+void World_cold_part_deferred(void);
+void World_cold_part_deferred_many(void);
+void World_table_chunk_new(void);
+void World_table_chunk_stable_ptr(void);
+void World_table_chunk_bulk_new(void);
+void World_table_chunk_add_remove(void);
+void World_table_chunk_delete_reuse(void);
+void World_table_chunk_clone(void);
+void World_table_chunk_deferred(void);
+void World_table_chunk_bulk_add(void);
+void World_table_chunk_gc(void);
+void World_table_chunk_reclaim(void);
+void World_table_chunk_delete_children(void);
+void World_cold_part_deferred_add_type(void);
+void World_table_chunk_delete_reuse_many(void);
+void World_table_chunk_move_to_chunk(void);
 
 // Testsuite 'Type'
 void Type_setup(void);
@@ -1235,6 +1321,20 @@ void MultiThread_change_thread_count(void);
 void MultiThread_multithread_quit(void);
 void MultiThread_schedule_w_tasks(void);
 void MultiThread_reactive_system(void);
+void MultiThread_6_thread_chunk_size_1(void);
+void MultiThread_4_thread_chunk_size_w_skewed_tables(void);
+void MultiThread_3_thread_test_combs_100_entity_w_chunk_size(void);
+void MultiThread_4_thread_dependent_systems(void);
+void MultiThread_2_thread_independent_systems(void);
+void MultiThread_4_thread_spin_count_0(void);
+void MultiThread_4_thread_spin_count_1000000(void);
+void MultiThread_2_thread_sync_wait_time(void);
+void MultiThread_4_thread_parallel_merge_set(void);
+void MultiThread_4_thread_parallel_merge_new_w_set(void);
+void MultiThread_4_thread_parallel_merge_set_remove(void);
+void MultiThread_4_thread_parallel_merge_on_set(void);
+void MultiThread_4_thread_aligned_columns(void);
+void MultiThread_2_thread_system_activated_in_frame(void);
 
 // Testsuite 'DeferredActions'
 void DeferredActions_defer_new(void);
@@ -1272,6 +1372,18 @@ void DeferredActions_discard_child(void);
 void DeferredActions_discard_child_w_add(void);
 void DeferredActions_defer_return_value(void);
 void DeferredActions_defer_get_mut_trait(void);
+void DeferredActions_defer_set_many(void);
+void DeferredActions_defer_bulk_new_w_large_data(void);
+void DeferredActions_defer_set_w_on_set_defer(void);
+void DeferredActions_defer_coalesce_add_remove_set(void);
+void DeferredActions_defer_coalesce_remove_add(void);
+void DeferredActions_defer_coalesce_w_on_add_on_set(void);
+void DeferredActions_defer_coalesce_interleaved_entities(void);
+void DeferredActions_defer_add_batch_move(void);
+void DeferredActions_defer_remove_batch_move_w_on_remove(void);
+void DeferredActions_defer_set_add_w_on_add_get_value(void);
+void DeferredActions_defer_set_add_w_monitor_get_value(void);
+void DeferredActions_defer_set_remove_w_un_set_get_value(void);
 
 // Testsuite 'SingleThreadStaging'
 void SingleThreadStaging_setup(void);
@@ -1395,6 +1507,7 @@ void Snapshot_set_after_snapshot(void);
 void Snapshot_restore_recycled(void);
 void Snapshot_snapshot_w_new_in_onset(void);
 void Snapshot_snapshot_w_new_in_onset_in_snapshot_table(void);
+void Snapshot_snapshot_hi_id(void);
 
 // Testsuite 'ReaderWriter'
 void ReaderWriter_simple(void);
@@ -1434,6 +1547,10 @@ void FilterIter_iter_get_component_size(void);
 void FilterIter_iter_get_tag_index(void);
 void FilterIter_iter_get_tag_size(void);
 void FilterIter_iter_get_tag_column(void);
+void FilterIter_iter_inherited_component(void);
+void FilterIter_iter_rarest_component(void);
+void FilterIter_iter_after_delete_table(void);
+void FilterIter_iter_match_any(void);
 
 // Testsuite 'Modules'
 void Modules_setup(void);
@@ -1481,6 +1598,9 @@ void DirectAccess_get_records_empty_table(void);
 void DirectAccess_get_column_empty_table(void);
 void DirectAccess_delete_column_empty_table(void);
 void DirectAccess_get_record_column_empty_table(void);
+void DirectAccess_set_column_w_alignment(void);
+void DirectAccess_set_column_w_wrong_alignment(void);
+void DirectAccess_free_aligned_column_w_vector_free(void);
 
 // Testsuite 'Internals'
 void Internals_setup(void);
@@ -1841,6 +1961,10 @@ bake_test_case Add_testcases[] = {
     {
         "add_after_remove_xor",
         Add_add_after_remove_xor
+    },
+    {
+        "add_remove_tag_w_many_components",
+        Add_add_remove_tag_w_many_components
     }
 };
 
@@ -1972,6 +2096,22 @@ bake_test_case Switch_testcases[] = {
     {
         "query_recycled_tags",
         Switch_query_recycled_tags
+    },
+    {
+        "query_dense_case_batch",
+        Switch_query_dense_case_batch
+    },
+    {
+        "query_dense_case_runs",
+        Switch_query_dense_case_runs
+    },
+    {
+        "query_sparse_case_runs",
+        Switch_query_sparse_case_runs
+    },
+    {
+        "query_sparse_2_cases_runs",
+        Switch_query_sparse_2_cases_runs
     }
 };
 
@@ -2123,6 +2263,18 @@ bake_test_case EnabledComponents_testcases[] = {
     {
         "sort",
         EnabledComponents_sort
+    },
+    {
+        "query_randomized_5_bitsets",
+        EnabledComponents_query_randomized_5_bitsets
+    },
+    {
+        "query_long_run",
+        EnabledComponents_query_long_run
+    },
+    {
+        "query_2_tables",
+        EnabledComponents_query_2_tables
     }
 };
 
@@ -3149,6 +3301,30 @@ bake_test_case Lookup_testcases[] = {
     {
         "lookup_symbol_null",
         Lookup_lookup_symbol_null
+    },
+    {
+        "lookup_child_after_reparent",
+        Lookup_lookup_child_after_reparent
+    },
+    {
+        "lookup_child_after_rename",
+        Lookup_lookup_child_after_rename
+    },
+    {
+        "lookup_child_after_delete",
+        Lookup_lookup_child_after_delete
+    },
+    {
+        "lookup_many_children",
+        Lookup_lookup_many_children
+    },
+    {
+        "lookup_child_w_multiple_parents",
+        Lookup_lookup_child_w_multiple_parents
+    },
+    {
+        "lookup_after_clone_delete_original",
+        Lookup_lookup_after_clone_delete_original
     }
 };
 
@@ -3418,6 +3594,34 @@ bake_test_case ComponentLifecycle_testcases[] = {
     {
         "set_lifecycle_after_trigger",
         ComponentLifecycle_set_lifecycle_after_trigger
+    },
+    {
+        "merge_batch_to_different_table",
+        ComponentLifecycle_merge_batch_to_different_table
+    },
+    {
+        "ctor_on_add_hi_id",
+        ComponentLifecycle_ctor_on_add_hi_id
+    },
+    {
+        "move_on_add_remove_cached_edge",
+        ComponentLifecycle_move_on_add_remove_cached_edge
+    },
+    {
+        "relocatable_no_move",
+        ComponentLifecycle_relocatable_no_move
+    },
+    {
+        "relocatable_merge",
+        ComponentLifecycle_relocatable_merge
+    },
+    {
+        "ctor_on_add_hi_entity_range",
+        ComponentLifecycle_ctor_on_add_hi_entity_range
+    },
+    {
+        "relocatable_deferred_move",
+        ComponentLifecycle_relocatable_deferred_move
     }
 };
 
@@ -3903,6 +4107,118 @@ bake_test_case Sorting_testcases[] = {
     {
         "sort_shared_component",
         Sorting_sort_shared_component
+    },
+    {
+        "sort_rows_by_component",
+        Sorting_sort_rows_by_component
+    },
+    {
+        "sort_rows_consecutive",
+        Sorting_sort_rows_consecutive
+    },
+    {
+        "sort_rows_2_tables",
+        Sorting_sort_rows_2_tables
+    },
+    {
+        "sort_rows_after_set",
+        Sorting_sort_rows_after_set
+    },
+    {
+        "sort_rows_after_delete",
+        Sorting_sort_rows_after_delete
+    },
+    {
+        "sort_rows_shared_component",
+        Sorting_sort_rows_shared_component
+    },
+    {
+        "sort_rows_1000_entities",
+        Sorting_sort_rows_1000_entities
+    },
+    {
+        "sort_rows_after_order_by",
+        Sorting_sort_rows_after_order_by
+    },
+    {
+        "sort_key_f32",
+        Sorting_sort_key_f32
+    },
+    {
+        "sort_key_offset",
+        Sorting_sort_key_offset
+    },
+    {
+        "sort_key_i32",
+        Sorting_sort_key_i32
+    },
+    {
+        "sort_key_i64",
+        Sorting_sort_key_i64
+    },
+    {
+        "sort_key_f64",
+        Sorting_sort_key_f64
+    },
+    {
+        "sort_key_stable",
+        Sorting_sort_key_stable
+    },
+    {
+        "sort_key_2_tables",
+        Sorting_sort_key_2_tables
+    },
+    {
+        "sort_key_shared_component",
+        Sorting_sort_key_shared_component
+    },
+    {
+        "sort_key_after_set",
+        Sorting_sort_key_after_set
+    },
+    {
+        "sort_key_rows",
+        Sorting_sort_key_rows
+    },
+    {
+        "sort_key_1000_entities",
+        Sorting_sort_key_1000_entities
+    },
+    {
+        "sort_key_after_order_by",
+        Sorting_sort_key_after_order_by
+    },
+    {
+        "sort_swap_values_3_tables",
+        Sorting_sort_swap_values_3_tables
+    },
+    {
+        "sort_rows_swap_values_3_tables",
+        Sorting_sort_rows_swap_values_3_tables
+    },
+    {
+        "sort_key_swap_values_3_tables",
+        Sorting_sort_key_swap_values_3_tables
+    },
+    {
+        "sort_move_entities_between_tables",
+        Sorting_sort_move_entities_between_tables
+    },
+    {
+        "sort_append_to_sorted_table",
+        Sorting_sort_append_to_sorted_table
+    },
+    {
+        "sort_rows_append_to_sorted_table",
+        Sorting_sort_rows_append_to_sorted_table
+    },
+    {
+        "sort_swap_values_w_group_by",
+        Sorting_sort_swap_values_w_group_by
+    },
+    {
+        "sort_after_set_2nd_column",
+        Sorting_sort_after_set_2nd_column
     }
 };
 
@@ -4030,6 +4346,10 @@ bake_test_case Queries_testcases[] = {
     {
         "stresstest_query_free",
         Queries_stresstest_query_free
+    },
+    {
+        "query_match_existing_w_base",
+        Queries_query_match_existing_w_base
     }
 };
 
@@ -5323,6 +5643,10 @@ bake_test_case System_w_FromContainer_testcases[] = {
     {
         "realloc_after_match",
         System_w_FromContainer_realloc_after_match
+    },
+    {
+        "add_component_after_match_hi_id",
+        System_w_FromContainer_add_component_after_match_hi_id
     }
 };
 
@@ -5499,6 +5823,146 @@ bake_test_case World_testcases[] = {
     {
         "get_stats",
         World_get_stats
+    },
+    {
+        "get_stats_table_edges",
+        World_get_stats_table_edges
+    },
+    {
+        "get_stats_table_edges_memory",
+        World_get_stats_table_edges_memory
+    },
+    {
+        "table_gc_disabled",
+        World_table_gc_disabled
+    },
+    {
+        "table_gc_reclaim",
+        World_table_gc_reclaim
+    },
+    {
+        "table_gc_delete",
+        World_table_gc_delete
+    },
+    {
+        "table_gc_delete_non_empty",
+        World_table_gc_delete_non_empty
+    },
+    {
+        "table_gc_recreate_same_type",
+        World_table_gc_recreate_same_type
+    },
+    {
+        "table_gc_w_snapshot",
+        World_table_gc_w_snapshot
+    },
+    {
+        "table_gc_child_table",
+        World_table_gc_child_table
+    },
+    {
+        "column_alignment_new_table",
+        World_column_alignment_new_table
+    },
+    {
+        "column_alignment_existing_table",
+        World_column_alignment_existing_table
+    },
+    {
+        "column_alignment_worker_slices",
+        World_column_alignment_worker_slices
+    },
+    {
+        "pool_stats",
+        World_pool_stats
+    },
+    {
+        "pool_custom_allocator",
+        World_pool_custom_allocator
+    },
+    {
+        "pool_set_allocator_w_existing_data",
+        World_pool_set_allocator_w_existing_data
+    },
+    {
+        "cold_part_add_remove",
+        World_cold_part_add_remove
+    },
+    {
+        "cold_part_bulk_new",
+        World_cold_part_bulk_new
+    },
+    {
+        "cold_part_system",
+        World_cold_part_system
+    },
+    {
+        "cold_part_after_new",
+        World_cold_part_after_new
+    },
+    {
+        "cold_part_deferred",
+        World_cold_part_deferred
+    },
+    {
+        "cold_part_deferred_many",
+        World_cold_part_deferred_many
+    },
+    {
+        "table_chunk_new",
+        World_table_chunk_new
+    },
+    {
+        "table_chunk_stable_ptr",
+        World_table_chunk_stable_ptr
+    },
+    {
+        "table_chunk_bulk_new",
+        World_table_chunk_bulk_new
+    },
+    {
+        "table_chunk_add_remove",
+        World_table_chunk_add_remove
+    },
+    {
+        "table_chunk_delete_reuse",
+        World_table_chunk_delete_reuse
+    },
+    {
+        "table_chunk_clone",
+        World_table_chunk_clone
+    },
+    {
+        "table_chunk_deferred",
+        World_table_chunk_deferred
+    },
+    {
+        "table_chunk_bulk_add",
+        World_table_chunk_bulk_add
+    },
+    {
+        "table_chunk_gc",
+        World_table_chunk_gc
+    },
+    {
+        "table_chunk_reclaim",
+        World_table_chunk_reclaim
+    },
+    {
+        "table_chunk_delete_children",
+        World_table_chunk_delete_children
+    },
+    {
+        "cold_part_deferred_add_type",
+        World_cold_part_deferred_add_type
+    },
+    {
+        "table_chunk_delete_reuse_many",
+        World_table_chunk_delete_reuse_many
+    },
+    {
+        "table_chunk_move_to_chunk",
+        World_table_chunk_move_to_chunk
     }
 };
 
@@ -6100,6 +6564,62 @@ bake_test_case MultiThread_testcases[] = {
     {
         "reactive_system",
         MultiThread_reactive_system
+    },
+    {
+        "6_thread_chunk_size_1",
+        MultiThread_6_thread_chunk_size_1
+    },
+    {
+        "4_thread_chunk_size_w_skewed_tables",
+        MultiThread_4_thread_chunk_size_w_skewed_tables
+    },
+    {
+        "3_thread_test_combs_100_entity_w_chunk_size",
+        MultiThread_3_thread_test_combs_100_entity_w_chunk_size
+    },
+    {
+        "4_thread_dependent_systems",
+        MultiThread_4_thread_dependent_systems
+    },
+    {
+        "2_thread_independent_systems",
+        MultiThread_2_thread_independent_systems
+    },
+    {
+        "4_thread_spin_count_0",
+        MultiThread_4_thread_spin_count_0
+    },
+    {
+        "4_thread_spin_count_1000000",
+        MultiThread_4_thread_spin_count_1000000
+    },
+    {
+        "2_thread_sync_wait_time",
+        MultiThread_2_thread_sync_wait_time
+    },
+    {
+        "4_thread_parallel_merge_set",
+        MultiThread_4_thread_parallel_merge_set
+    },
+    {
+        "4_thread_parallel_merge_new_w_set",
+        MultiThread_4_thread_parallel_merge_new_w_set
+    },
+    {
+        "4_thread_parallel_merge_set_remove",
+        MultiThread_4_thread_parallel_merge_set_remove
+    },
+    {
+        "4_thread_parallel_merge_on_set",
+        MultiThread_4_thread_parallel_merge_on_set
+    },
+    {
+        "4_thread_aligned_columns",
+        MultiThread_4_thread_aligned_columns
+    },
+    {
+        "2_thread_system_activated_in_frame",
+        MultiThread_2_thread_system_activated_in_frame
     }
 };
 
@@ -6243,6 +6763,54 @@ bake_test_case DeferredActions_testcases[] = {
     {
         "defer_get_mut_trait",
         DeferredActions_defer_get_mut_trait
+    },
+    {
+        "defer_set_many",
+        DeferredActions_defer_set_many
+    },
+    {
+        "defer_bulk_new_w_large_data",
+        DeferredActions_defer_bulk_new_w_large_data
+    },
+    {
+        "defer_set_w_on_set_defer",
+        DeferredActions_defer_set_w_on_set_defer
+    },
+    {
+        "defer_coalesce_add_remove_set",
+        DeferredActions_defer_coalesce_add_remove_set
+    },
+    {
+        "defer_coalesce_remove_add",
+        DeferredActions_defer_coalesce_remove_add
+    },
+    {
+        "defer_coalesce_w_on_add_on_set",
+        DeferredActions_defer_coalesce_w_on_add_on_set
+    },
+    {
+        "defer_coalesce_interleaved_entities",
+        DeferredActions_defer_coalesce_interleaved_entities
+    },
+    {
+        "defer_add_batch_move",
+        DeferredActions_defer_add_batch_move
+    },
+    {
+        "defer_remove_batch_move_w_on_remove",
+        DeferredActions_defer_remove_batch_move_w_on_remove
+    },
+    {
+        "defer_set_add_w_on_add_get_value",
+        DeferredActions_defer_set_add_w_on_add_get_value
+    },
+    {
+        "defer_set_add_w_monitor_get_value",
+        DeferredActions_defer_set_add_w_monitor_get_value
+    },
+    {
+        "defer_set_remove_w_un_set_get_value",
+        DeferredActions_defer_set_remove_w_un_set_get_value
     }
 };
 
@@ -6703,6 +7271,10 @@ bake_test_case Snapshot_testcases[] = {
     {
         "snapshot_w_new_in_onset_in_snapshot_table",
         Snapshot_snapshot_w_new_in_onset_in_snapshot_table
+    },
+    {
+        "snapshot_hi_id",
+        Snapshot_snapshot_hi_id
     }
 };
 
@@ -6849,6 +7421,22 @@ bake_test_case FilterIter_testcases[] = {
     {
         "iter_get_tag_column",
         FilterIter_iter_get_tag_column
+    },
+    {
+        "iter_inherited_component",
+        FilterIter_iter_inherited_component
+    },
+    {
+        "iter_rarest_component",
+        FilterIter_iter_rarest_component
+    },
+    {
+        "iter_after_delete_table",
+        FilterIter_iter_after_delete_table
+    },
+    {
+        "iter_match_any",
+        FilterIter_iter_match_any
     }
 };
 
@@ -7023,6 +7611,18 @@ bake_test_case DirectAccess_testcases[] = {
     {
         "get_record_column_empty_table",
         DirectAccess_get_record_column_empty_table
+    },
+    {
+        "set_column_w_alignment",
+        DirectAccess_set_column_w_alignment
+    },
+    {
+        "set_column_w_wrong_alignment",
+        DirectAccess_set_column_w_wrong_alignment
+    },
+    {
+        "free_aligned_column_w_vector_free",
+        DirectAccess_free_aligned_column_w_vector_free
     }
 };
 
@@ -7127,21 +7727,21 @@ static bake_test_suite suites[] = {
         "Add",
         NULL,
         NULL,
-        37,
+        38,
         Add_testcases
     },
     {
         "Switch",
         Switch_setup,
         NULL,
-        32,
+        36,
         Switch_testcases
     },
     {
         "EnabledComponents",
         NULL,
         NULL,
-        37,
+        40,
         EnabledComponents_testcases
     },
     {
@@ -7239,7 +7839,7 @@ static bake_test_suite suites[] = {
         "Lookup",
         Lookup_setup,
         NULL,
-        21,
+        27,
         Lookup_testcases
     },
     {
@@ -7260,7 +7860,7 @@ static bake_test_suite suites[] = {
         "ComponentLifecycle",
         ComponentLifecycle_setup,
         NULL,
-        41,
+        48,
         ComponentLifecycle_testcases
     },
     {
@@ -7281,14 +7881,14 @@ static bake_test_suite suites[] = {
         "Sorting",
         NULL,
         NULL,
-        20,
+        48,
         Sorting_testcases
     },
     {
         "Queries",
         NULL,
         NULL,
-        31,
+        32,
         Queries_testcases
     },
     {
@@ -7393,7 +7993,7 @@ static bake_test_suite suites[] = {
         "System_w_FromContainer",
         System_w_FromContainer_setup,
         NULL,
-        20,
+        21,
         System_w_FromContainer_testcases
     },
     {
@@ -7421,7 +8021,7 @@ static bake_test_suite suites[] = {
         "World",
         World_setup,
         NULL,
-        32,
+        67,
         World_testcases
     },
     {
@@ -7442,14 +8042,14 @@ static bake_test_suite suites[] = {
         "MultiThread",
         MultiThread_setup,
         NULL,
-        34,
+        48,
         MultiThread_testcases
     },
     {
         "DeferredActions",
         NULL,
         NULL,
-        35,
+        47,
         DeferredActions_testcases
     },
     {
@@ -7477,7 +8077,7 @@ static bake_test_suite suites[] = {
         "Snapshot",
         NULL,
         NULL,
-        26,
+        27,
         Snapshot_testcases
     },
     {
@@ -7491,7 +8091,7 @@ static bake_test_suite suites[] = {
         "FilterIter",
         NULL,
         NULL,
-        12,
+        16,
         FilterIter_testcases
     },
     {
@@ -7505,7 +8105,7 @@ static bake_test_suite suites[] = {
         "DirectAccess",
         NULL,
         NULL,
-        23,
+        26,
         DirectAccess_testcases
     },
     {
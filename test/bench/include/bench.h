@@ -0,0 +1,39 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/* This generated file contains includes for project dependencies */
+#include <bench/bake_config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Position {
+    float x;
+    float y;
+} Position;
+
+typedef struct Velocity {
+    float x;
+    float y;
+} Velocity;
+
+/* Print time per operation of a benchmark */
+void bench_report(
+    const char *name,
+    const char *variant,
+    double time,
+    int32_t op_count);
+
+/* Benchmarks */
+void bench_parallel_merge(void);
+void bench_component_id(void);
+void bench_table_growth(void);
+void bench_map(void);
+void bench_hash(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
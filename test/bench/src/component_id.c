@@ -0,0 +1,74 @@
+#include <bench.h>
+
+#define PAIRS (200000)
+
+static
+void Ctor(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    const ecs_entity_t *entity_ptr,
+    void *ptr,
+    size_t size,
+    int32_t count,
+    void *ctx)
+{
+    (void)world;
+    (void)component;
+    (void)entity_ptr;
+    (void)size;
+    (void)ctx;
+
+    Position *p = ptr;
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        p[i].x = 0;
+        p[i].y = 0;
+    }
+}
+
+/* Measure adding and removing a component with a constructor. Component info
+ * is looked up by component id for each add. */
+static
+void run(
+    const char *variant,
+    bool hi_id,
+    ecs_entity_t range)
+{
+    ecs_world_t *world = ecs_init();
+
+    if (hi_id) {
+        while (ecs_new_component_id(world) < ECS_HI_COMPONENT_ID) { }
+    }
+
+    if (range) {
+        ecs_set_entity_range(world, range, 0);
+    }
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set(world, ecs_typeid(Position), EcsComponentLifecycle, {
+        .ctor = Ctor
+    });
+
+    ecs_entity_t e = ecs_new(world, 0);
+
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    int32_t i;
+    for (i = 0; i < PAIRS; i ++) {
+        ecs_add(world, e, Position);
+        ecs_remove(world, e, Position);
+    }
+
+    bench_report("component_id add+remove", variant, 
+        ecs_time_measure(&t), PAIRS);
+
+    ecs_fini(world);
+}
+
+void bench_component_id(void) {
+    run("low id", false, 0);
+    run("high id", true, 0);
+    run("high entity range", true, 0x10000000);
+}
@@ -0,0 +1,51 @@
+#include <bench.h>
+
+#define BYTES (256 * 1024 * 1024)
+
+/* Prevents hashes from being optimized out */
+static volatile uint64_t sink;
+
+/* Measure hashing data of a fixed length. Short lengths are typical for type
+ * and name lookups, long lengths show the throughput of the hash. */
+static
+void run(
+    const char *variant,
+    ecs_size_t length)
+{
+    char *data = ecs_os_malloc(length);
+    ecs_size_t i;
+    for (i = 0; i < length; i ++) {
+        data[i] = (char)(i * 31);
+    }
+
+    int32_t count = BYTES / length;
+    uint64_t sum = 0;
+
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    int32_t h;
+    for (h = 0; h < count; h ++) {
+        uint64_t hash;
+        data[0] = (char)h;
+        ecs_hash(data, length, &hash);
+        sum += hash;
+    }
+
+    double time = ecs_time_measure(&t);
+    bench_report("hash", variant, time, count);
+    printf("%-24s %-24s %10.2f MB/s\n", "hash throughput", variant, 
+        (double)BYTES / time / (1024.0 * 1024.0));
+
+    ecs_os_free(data);
+    sink = sum;
+}
+
+void bench_hash(void) {
+    run("8 bytes", 8);
+    run("16 bytes", 16);
+    run("32 bytes", 32);
+    run("64 bytes", 64);
+    run("1 KB", 1024);
+    run("64 KB", 64 * 1024);
+}
@@ -0,0 +1,42 @@
+#include <bench.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct bench_t {
+    const char *id;
+    void (*action)(void);
+} bench_t;
+
+static bench_t benchmarks[] = {
+    {"parallel_merge", bench_parallel_merge},
+    {"component_id", bench_component_id},
+    {"table_growth", bench_table_growth},
+    {"map", bench_map},
+    {"hash", bench_hash}
+};
+
+void bench_report(
+    const char *name,
+    const char *variant,
+    double time,
+    int32_t op_count)
+{
+    printf("%-24s %-24s %10.2f ns/op\n", name, variant, 
+        time * 1000000000.0 / (double)op_count);
+}
+
+int main(int argc, char *argv[]) {
+    bake_set_os_api();
+
+    /* Optionally only run the benchmark passed as argument */
+    const char *filter = argc > 1 ? argv[1] : NULL;
+
+    int i, count = sizeof(benchmarks) / sizeof(bench_t);
+    for (i = 0; i < count; i ++) {
+        if (!filter || !strcmp(filter, benchmarks[i].id)) {
+            benchmarks[i].action();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <bench.h>
+
+#define KEYS (1000000)
+
+/* Prevents lookups from being optimized out */
+static volatile uint64_t sink;
+
+static
+uint64_t next_random(
+    uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/* Measure inserting, looking up and removing keys. Sequential keys are how
+ * entities and tables are typically stored, keys that only differ in their
+ * upper 32 bits are how traits and combined ids are stored. */
+static
+void run(
+    const char *variant,
+    const uint64_t *keys)
+{
+    ecs_map_t *map = ecs_map_new(uint64_t, 0);
+
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    int32_t i;
+    for (i = 0; i < KEYS; i ++) {
+        ecs_map_set(map, keys[i], &keys[i]);
+    }
+
+    bench_report("map insert", variant, ecs_time_measure(&t), KEYS);
+
+    uint64_t sum = 0;
+    for (i = 0; i < KEYS; i ++) {
+        sum += *ecs_map_get(map, uint64_t, keys[i]);
+    }
+
+    bench_report("map lookup", variant, ecs_time_measure(&t), KEYS);
+
+    for (i = 0; i < KEYS; i ++) {
+        ecs_map_remove(map, keys[i]);
+    }
+
+    bench_report("map remove", variant, ecs_time_measure(&t), KEYS);
+
+    ecs_assert(!ecs_map_count(map), ECS_INTERNAL_ERROR, NULL);
+    ecs_map_free(map);
+
+    sink = sum;
+}
+
+void bench_map(void) {
+    uint64_t *keys = ecs_os_malloc(KEYS * ECS_SIZEOF(uint64_t));
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    int32_t i;
+
+    for (i = 0; i < KEYS; i ++) {
+        keys[i] = (uint64_t)i + 1;
+    }
+    run("sequential keys", keys);
+
+    for (i = 0; i < KEYS; i ++) {
+        keys[i] = ((uint64_t)(i + 1) << 32) | 1;
+    }
+    run("upper 32 bit keys", keys);
+
+    for (i = 0; i < KEYS; i ++) {
+        keys[i] = next_random(&state);
+    }
+    run("random keys", keys);
+
+    ecs_os_free(keys);
+}
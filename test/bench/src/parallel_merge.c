@@ -0,0 +1,74 @@
+#include <bench.h>
+#include <stdio.h>
+
+#define ENTITIES (100000)
+#define FRAMES (50)
+
+static
+void SetVelocity(ecs_iter_t *it) {
+    ECS_COLUMN(it, Position, p, 1);
+    ECS_COLUMN_COMPONENT(it, Velocity, 2);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_set(it->world, it->entities[i], Velocity, {p[i].x, p[i].y});
+    }
+}
+
+/* Measure a frame in which every entity sets a component from a system, which
+ * stores one deferred write per entity. All entities already have the 
+ * component, so the merge only copies values. */
+static
+void run(
+    int32_t threads,
+    bool parallel_merge)
+{
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, SetVelocity, EcsOnUpdate, Position, :Velocity);
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, ENTITIES);
+    int i;
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_set(world, ids[i], Position, {(float)i, (float)i});
+        ecs_set(world, ids[i], Velocity, {0, 0});
+    }
+
+    ecs_set_threads(world, threads);
+    ecs_set_parallel_merge(world, parallel_merge);
+    ecs_measure_frame_time(world, true);
+
+    /* Warm up, so that stages have allocated their storage */
+    ecs_progress(world, 1);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    double merge_time = 0;
+
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+    for (i = 0; i < FRAMES; i ++) {
+        FLECS_FLOAT merge_start = info->merge_time_total;
+        ecs_progress(world, 1);
+        merge_time += (double)(info->merge_time_total - merge_start);
+    }
+    double time = ecs_time_measure(&t);
+
+    char variant[64];
+    sprintf(variant, "%s, %d threads", 
+        parallel_merge ? "parallel" : "serial", threads);
+    bench_report("parallel_merge frame", variant, time, ENTITIES * FRAMES);
+    bench_report("parallel_merge merge", variant, merge_time, 
+        ENTITIES * FRAMES);
+
+    ecs_fini(world);
+}
+
+void bench_parallel_merge(void) {
+    int32_t threads;
+    for (threads = 1; threads <= 8; threads *= 2) {
+        run(threads, false);
+        run(threads, true);
+    }
+}
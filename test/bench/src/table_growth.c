@@ -0,0 +1,80 @@
+#include <bench.h>
+
+#define ENTITIES (500000)
+
+static
+void Move(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    const ecs_entity_t *dst_entity,
+    const ecs_entity_t *src_entity,
+    void *dst_ptr,
+    void *src_ptr,
+    size_t size,
+    int32_t count,
+    void *ctx)
+{
+    (void)world;
+    (void)component;
+    (void)dst_entity;
+    (void)src_entity;
+    (void)size;
+    (void)ctx;
+
+    Position *dst = dst_ptr, *src = src_ptr;
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        dst[i] = src[i];
+    }
+}
+
+/* Measure appending entities to a single table, for a component with a move
+ * action. Growing a contiguous table moves all of its entities, which shows up
+ * as the worst time of a single append. */
+static
+void run(
+    const char *variant,
+    int32_t chunk_size)
+{
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set(world, ecs_typeid(Position), EcsComponentLifecycle, {
+        .move = Move
+    });
+
+    ecs_set_table_chunk_size(world, chunk_size);
+
+    /* Create ids upfront, so growing the entity index isn't measured */
+    ecs_entity_t *ids = ecs_os_malloc(ENTITIES * ECS_SIZEOF(ecs_entity_t));
+    int32_t i;
+    for (i = 0; i < ENTITIES; i ++) {
+        ids[i] = ecs_new_id(world);
+    }
+
+    double total = 0, worst = 0;
+
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_time_t t = {0};
+        ecs_time_measure(&t);
+        ecs_add(world, ids[i], Position);
+        double time = ecs_time_measure(&t);
+
+        total += time;
+        if (time > worst) {
+            worst = time;
+        }
+    }
+
+    bench_report("table_growth append", variant, total, ENTITIES);
+    bench_report("table_growth worst", variant, worst, 1);
+
+    ecs_os_free(ids);
+    ecs_fini(world);
+}
+
+void bench_table_growth(void) {
+    run("contiguous", 0);
+    run("chunks of 4096", 4096);
+}
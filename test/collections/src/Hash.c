@@ -0,0 +1,144 @@
+#include <collections.h>
+#include <stdlib.h>
+
+void Hash_setup() {
+    ecs_os_set_api_defaults();
+}
+
+static
+int compare_hash(const void *p1, const void *p2) {
+    uint64_t h1 = *(const uint64_t*)p1;
+    uint64_t h2 = *(const uint64_t*)p2;
+    return (h1 > h2) - (h1 < h2);
+}
+
+/* Every non-empty subset of 17 components, as sorted entity arrays. This 
+ * produces 131071 types of 1 to 17 components. */
+#define SUBSET_BITS (17)
+#define SUBSET_COUNT ((1 << SUBSET_BITS) - 1)
+
+static
+uint64_t* hash_subset_types(void) {
+    uint64_t *hashes = ecs_os_malloc(ECS_SIZEOF(uint64_t) * SUBSET_COUNT);
+    ecs_entity_t type[SUBSET_BITS];
+
+    int32_t i;
+    for (i = 0; i < SUBSET_COUNT; i ++) {
+        int32_t b, count = 0;
+        for (b = 0; b < SUBSET_BITS; b ++) {
+            if ((i + 1) & (1 << b)) {
+                type[count ++] = 256 + b;
+            }
+        }
+
+        ecs_hash(type, count * ECS_SIZEOF(ecs_entity_t), &hashes[i]);
+    }
+
+    return hashes;
+}
+
+/* Largest number of hashes that end up in the same of 2^16 buckets */
+static
+int32_t max_bucket_size(
+    uint64_t *hashes, 
+    int32_t count, 
+    int32_t shift) 
+{
+    int32_t *buckets = ecs_os_calloc(ECS_SIZEOF(int32_t) * 65536);
+    int32_t i, max = 0;
+    for (i = 0; i < count; i ++) {
+        int32_t b = (int32_t)((hashes[i] >> shift) & 0xFFFF);
+        if (++ buckets[b] > max) {
+            max = buckets[b];
+        }
+    }
+    ecs_os_free(buckets);
+    return max;
+}
+
+void Hash_same_input_same_hash() {
+    ecs_entity_t type_1[] = {256, 300, ECS_CHILDOF | 1000};
+    ecs_entity_t type_2[] = {256, 300, ECS_CHILDOF | 1000};
+
+    uint64_t h1, h2;
+    ecs_hash(type_1, ECS_SIZEOF(type_1), &h1);
+    ecs_hash(type_2, ECS_SIZEOF(type_2), &h2);
+    test_assert(h1 == h2);
+}
+
+void Hash_unaligned_input() {
+    char buffer[65];
+    char *str = "the quick brown fox jumps over the lazy dog, and then some more";
+    ecs_os_memcpy(&buffer[1], str, 64);
+
+    /* Hash doesn't depend on the alignment of the data */
+    uint64_t h1, h2;
+    ecs_hash(str, 64, &h1);
+    ecs_hash(&buffer[1], 64, &h2);
+    test_assert(h1 == h2);
+}
+
+void Hash_all_lengths() {
+    char *str = "the quick brown fox jumps over the lazy dog, and then some more"
+        " characters so that inputs longer than 96 bytes are also tested";
+    int32_t len = ecs_os_strlen(str);
+    uint64_t *hashes = ecs_os_malloc(ECS_SIZEOF(uint64_t) * (len + 1));
+
+    int32_t i;
+    for (i = 0; i <= len; i ++) {
+        /* Copy to exact size allocation so out of bounds reads are caught */
+        char *copy = ecs_os_malloc(i ? i : 1);
+        ecs_os_memcpy(copy, str, i);
+        ecs_hash(copy, i, &hashes[i]);
+        ecs_os_free(copy);
+    }
+
+    qsort(hashes, (size_t)len + 1, sizeof(uint64_t), compare_hash);
+    for (i = 0; i < len; i ++) {
+        test_assert(hashes[i] != hashes[i + 1]);
+    }
+
+    ecs_os_free(hashes);
+}
+
+void Hash_no_collisions_for_types() {
+    uint64_t *hashes = hash_subset_types();
+
+    qsort(hashes, SUBSET_COUNT, sizeof(uint64_t), compare_hash);
+
+    int32_t i;
+    for (i = 0; i < SUBSET_COUNT - 1; i ++) {
+        test_assert(hashes[i] != hashes[i + 1]);
+    }
+
+    ecs_os_free(hashes);
+}
+
+void Hash_distribution_for_types() {
+    uint64_t *hashes = hash_subset_types();
+
+    /* With 2 hashes per bucket on average, a uniform hash puts at most 16 in
+     * a single bucket with overwhelming probability. Test both the low bits
+     * (used by the map) and the high bits. */
+    test_assert(max_bucket_size(hashes, SUBSET_COUNT, 0) <= 16);
+    test_assert(max_bucket_size(hashes, SUBSET_COUNT, 24) <= 16);
+    test_assert(max_bucket_size(hashes, SUBSET_COUNT, 48) <= 16);
+
+    ecs_os_free(hashes);
+}
+
+void Hash_distribution_for_child_types() {
+    /* Types that only differ in their parent */
+    int32_t i, count = 65536 * 2;
+    uint64_t *hashes = ecs_os_malloc(ECS_SIZEOF(uint64_t) * count);
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t type[] = {256, 257, 300, ECS_CHILDOF | (ecs_entity_t)(1000 + i)};
+        ecs_hash(type, ECS_SIZEOF(type), &hashes[i]);
+    }
+
+    test_assert(max_bucket_size(hashes, count, 0) <= 16);
+    test_assert(max_bucket_size(hashes, count, 48) <= 16);
+
+    ecs_os_free(hashes);
+}
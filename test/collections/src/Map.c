@@ -18,6 +18,27 @@ void fill_map(
     }
 }
 
+/* Iterate map, returns a mask with a bit set for each key in the map. Elements
+ * are not returned in a specific order. */
+static
+int32_t iter_map(
+    ecs_map_t *map)
+{
+    int32_t result = 0;
+    ecs_map_key_t key;
+    char *value;
+
+    ecs_map_iter_t it = ecs_map_iter(map);
+    while ((value = ecs_map_next_ptr(&it, char*, &key))) {
+        test_assert(key >= 1 && key <= 4);
+        test_assert(!(result & (1 << key)));
+        test_str(value, elems[key - 1].value);
+        result |= 1 << key;
+    }
+
+    return result;
+}
+
 static int32_t malloc_count;
 
 static
@@ -183,12 +204,7 @@ void Map_iter() {
     ecs_map_t *map = ecs_map_new(char*, 16);
     fill_map(map);
 
-    ecs_map_iter_t it = ecs_map_iter(map);
-    test_str(ecs_map_next_ptr(&it, char*, NULL), "hello");
-    test_str(ecs_map_next_ptr(&it, char*, NULL), "world");
-    test_str(ecs_map_next_ptr(&it, char*, NULL), "foo");
-    test_str(ecs_map_next_ptr(&it, char*, NULL), "bar");
-    test_assert(ecs_map_next_ptr(&it, char*, NULL) == NULL);
+    test_int(iter_map(map), (1 << 1) | (1 << 2) | (1 << 3) | (1 << 4));
 
     ecs_map_free(map);
 }
@@ -284,7 +300,7 @@ void Map_grow() {
         ecs_map_set(map, i, &v);
     }
 
-    test_int(malloc_count, 20);
+    test_int(malloc_count, 0);
 
     ecs_map_free(map);
 }
@@ -309,3 +325,75 @@ void Map_ensure() {
 
     ecs_map_free(map);
 }
+
+void Map_set_remove_many() {
+    ecs_map_t *map = ecs_map_new(uint64_t, 0);
+
+    /* Mix of sequential keys and keys that use the upper 32 bits */
+    int i;
+    for (i = 0; i < 10000; i ++) {
+        uint64_t key = (uint64_t)i * 0x100000001ull;
+        ecs_map_set(map, key, &key);
+    }
+
+    test_int(ecs_map_count(map), 10000);
+
+    for (i = 0; i < 10000; i += 2) {
+        ecs_map_remove(map, (uint64_t)i * 0x100000001ull);
+    }
+
+    test_int(ecs_map_count(map), 5000);
+
+    for (i = 0; i < 10000; i ++) {
+        uint64_t key = (uint64_t)i * 0x100000001ull;
+        uint64_t *value = ecs_map_get(map, uint64_t, key);
+        if (i % 2) {
+            test_assert(value != NULL);
+            test_assert(*value == key);
+        } else {
+            test_assert(value == NULL);
+        }
+    }
+
+    ecs_map_free(map);
+}
+
+void Map_colliding_keys() {
+    ecs_map_t *map = ecs_map_new(uint64_t, 0);
+
+    /* Keys that only differ in bits that are not used to find their bucket
+     * end up in a single long chain. */
+    uint64_t i;
+    for (i = 0; i < 1000; i ++) {
+        uint64_t key = i << 48;
+        ecs_map_set(map, key, &i);
+    }
+
+    test_int(ecs_map_count(map), 1000);
+
+    for (i = 0; i < 1000; i += 3) {
+        ecs_map_remove(map, i << 48);
+    }
+
+    for (i = 0; i < 1000; i ++) {
+        uint64_t *value = ecs_map_get(map, uint64_t, i << 48);
+        if (i % 3) {
+            test_assert(value != NULL);
+            test_assert(*value == i);
+        } else {
+            test_assert(value == NULL);
+        }
+    }
+
+    ecs_map_free(map);
+}
+
+void Map_iter_after_remove() {
+    ecs_map_t *map = ecs_map_new(char*, 16);
+    fill_map(map);
+    ecs_map_remove(map, 2);
+
+    test_int(iter_map(map), (1 << 1) | (1 << 3) | (1 << 4));
+
+    ecs_map_free(map);
+}
@@ -298,7 +298,7 @@ void Vector_memory() {
     array = fill_array(array);
 
     ecs_vector_memory(array, int, &allocd, &used);
-    test_int(allocd, 8 * sizeof(int));
+    test_int(allocd, 4 * sizeof(int) + ECS_VECTOR_HEADER_SIZE);
     test_int(used, 4 * sizeof(int));
 
     ecs_vector_free(array);
@@ -70,6 +70,9 @@ void Map_remove_unknown(void);
 void Map_grow(void);
 void Map_set_size_0(void);
 void Map_ensure(void);
+void Map_set_remove_many(void);
+void Map_colliding_keys(void);
+void Map_iter_after_remove(void);
 
 // Testsuite 'Sparse'
 void Sparse_setup(void);
@@ -114,6 +117,15 @@ void Strbuf_reset(void);
 void Strbuf_merge(void);
 void Strbuf_app_buffer(void);
 
+// Testsuite 'Hash'
+void Hash_setup(void);
+void Hash_same_input_same_hash(void);
+void Hash_unaligned_input(void);
+void Hash_all_lengths(void);
+void Hash_no_collisions_for_types(void);
+void Hash_distribution_for_types(void);
+void Hash_distribution_for_child_types(void);
+
 bake_test_case Vector_testcases[] = {
     {
         "free_empty",
@@ -336,6 +348,18 @@ bake_test_case Map_testcases[] = {
     {
         "ensure",
         Map_ensure
+    },
+    {
+        "set_remove_many",
+        Map_set_remove_many
+    },
+    {
+        "colliding_keys",
+        Map_colliding_keys
+    },
+    {
+        "iter_after_remove",
+        Map_iter_after_remove
     }
 };
 
@@ -493,6 +517,33 @@ bake_test_case Strbuf_testcases[] = {
     }
 };
 
+bake_test_case Hash_testcases[] = {
+    {
+        "same_input_same_hash",
+        Hash_same_input_same_hash
+    },
+    {
+        "unaligned_input",
+        Hash_unaligned_input
+    },
+    {
+        "all_lengths",
+        Hash_all_lengths
+    },
+    {
+        "no_collisions_for_types",
+        Hash_no_collisions_for_types
+    },
+    {
+        "distribution_for_types",
+        Hash_distribution_for_types
+    },
+    {
+        "distribution_for_child_types",
+        Hash_distribution_for_child_types
+    }
+};
+
 static bake_test_suite suites[] = {
     {
         "Vector",
@@ -512,7 +563,7 @@ static bake_test_suite suites[] = {
         "Map",
         Map_setup,
         NULL,
-        19,
+        22,
         Map_testcases
     },
     {
@@ -528,10 +579,17 @@ static bake_test_suite suites[] = {
         NULL,
         14,
         Strbuf_testcases
+    },
+    {
+        "Hash",
+        Hash_setup,
+        NULL,
+        6,
+        Hash_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
     ut_init(argv[0]);
-    return bake_test_run("collections", argc, argv, suites, 5);
+    return bake_test_run("collections", argc, argv, suites, 6);
 }
@@ -46,6 +46,41 @@ public:
     std::string value;
 };
 
+class Reloc {
+public:
+    Reloc() {
+        ctor_invoked ++;
+        value = new int(10);
+    }
+
+    ~Reloc() {
+        delete value;
+    }
+
+    Reloc& operator=(const Reloc& obj) {
+        *value = *obj.value;
+        return *this;
+    }
+
+    Reloc& operator=(Reloc&& obj) {
+        move_invoked ++;
+        std::swap(value, obj.value);
+        return *this;
+    }
+
+    int *value;
+
+    static int ctor_invoked;
+    static int move_invoked;
+};
+
+int Reloc::ctor_invoked = 0;
+int Reloc::move_invoked = 0;
+
+namespace flecs {
+template <> struct is_relocatable<Reloc> : std::true_type { };
+}
+
 void ComponentLifecycle_ctor_on_add() {
     flecs::world world;
 
@@ -346,3 +381,32 @@ void ComponentLifecycle_implicit_after_query() {
     test_int(POD::ctor_invoked, 5);
     test_int(POD::move_invoked, 2); 
 }
+
+void ComponentLifecycle_relocatable_trait() {
+    flecs::world world;
+
+    flecs::component<Reloc>(world, "Reloc");
+    flecs::component<Position>(world, "Position");
+
+    flecs::entity e[32];
+    for (int i = 0; i < 32; i ++) {
+        e[i] = flecs::entity(world).add<Reloc>();
+        *e[i].get_mut<Reloc>()->value = i;
+    }
+
+    test_int(Reloc::ctor_invoked, 32);
+    test_int(Reloc::move_invoked, 0);
+
+    /* Moving the entity to another table relocates the value */
+    e[0].add<Position>();
+    e[1].add<Position>();
+    e[0].remove<Position>();
+    test_int(Reloc::ctor_invoked, 32);
+    test_int(Reloc::move_invoked, 0);
+
+    for (int i = 0; i < 32; i ++) {
+        const Reloc *r = e[i].get<Reloc>();
+        test_assert(r != NULL);
+        test_int(*r->value, i);
+    }
+}
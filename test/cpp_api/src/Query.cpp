@@ -584,6 +584,54 @@ void Query_sort_by() {
     });
 }
 
+void Query_sort_by_rows() {
+    flecs::world world;
+
+    world.entity().set<Position>({1, 0});
+    world.entity().set<Position>({6, 0});
+    world.entity().set<Position>({2, 0});
+    world.entity().set<Position>({5, 0});
+    world.entity().set<Position>({4, 0});
+
+    auto q = world.query<Position>();
+
+    q.order_by_rows(compare_position);
+
+    int32_t count = 0;
+    float last = 0;
+    q.each([&](flecs::entity e, Position& p) {
+        test_assert(p.x > last);
+        last = p.x;
+        count ++;
+    });
+
+    test_int(count, 5);
+    test_int(last, 6);
+}
+
+void Query_sort_by_key() {
+    flecs::world world;
+
+    world.entity().set<Position>({1, 0});
+    world.entity().set<Position>({6, 0});
+    world.entity().set<Position>({2, 0});
+    world.entity().set<Position>({5, 0});
+    world.entity().set<Position>({4, 0});
+
+    auto q = world.query<Position>();
+
+    q.order_by_key<Position>(EcsSortKeyF32, offsetof(Position, x));
+
+    q.iter([](flecs::iter it, Position *p) {
+        test_int(it.count(), 5);
+        test_int(p[0].x, 1);
+        test_int(p[1].x, 2);
+        test_int(p[2].x, 4);
+        test_int(p[3].x, 5);
+        test_int(p[4].x, 6);
+    });
+}
+
 void Query_changed() {
     flecs::world world;
 
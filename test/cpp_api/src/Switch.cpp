@@ -73,7 +73,7 @@ void Switch_system_w_case() {
 
     world.progress();
 
-    test_int(invoke_count, 2);
+    test_int(invoke_count, 1);
     test_int(count, 2);
 }
 
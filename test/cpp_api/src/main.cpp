@@ -171,6 +171,8 @@ void Query_shared_tag_w_each(void);
 void Query_sort_by(void);
 void Query_changed(void);
 void Query_orphaned(void);
+void Query_sort_by_rows(void);
+void Query_sort_by_key(void);
 
 // Testsuite 'ComponentLifecycle'
 void ComponentLifecycle_ctor_on_add(void);
@@ -187,6 +189,7 @@ void ComponentLifecycle_pod_component(void);
 void ComponentLifecycle_relocatable_component(void);
 void ComponentLifecycle_implicit_component(void);
 void ComponentLifecycle_implicit_after_query(void);
+void ComponentLifecycle_relocatable_trait(void);
 
 // Testsuite 'Refs'
 void Refs_get_ref(void);
@@ -883,6 +886,14 @@ bake_test_case Query_testcases[] = {
     {
         "orphaned",
         Query_orphaned
+    },
+    {
+        "sort_by_rows",
+        Query_sort_by_rows
+    },
+    {
+        "sort_by_key",
+        Query_sort_by_key
     }
 };
 
@@ -942,6 +953,10 @@ bake_test_case ComponentLifecycle_testcases[] = {
     {
         "implicit_after_query",
         ComponentLifecycle_implicit_after_query
+    },
+    {
+        "relocatable_trait",
+        ComponentLifecycle_relocatable_trait
     }
 };
 
@@ -1292,14 +1307,14 @@ static bake_test_suite suites[] = {
         "Query",
         NULL,
         NULL,
-        20,
+        22,
         Query_testcases
     },
     {
         "ComponentLifecycle",
         NULL,
         NULL,
-        14,
+        15,
         ComponentLifecycle_testcases
     },
     {